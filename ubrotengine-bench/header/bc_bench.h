@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bc_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/bc_encoder.h"
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: BcBench
+/// Compresses an image into every BC format in both qualities and reports the PSNR and the
+/// throughput in blocks per second, on one thread and on the thread pool. Without an input
+/// file a generated test image is used. BC1 compresses an opaque copy of the image.
+///
+/// Usage: bc [--image <png/tga>] [--size <pixels>] [--threads <count>] [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class BcBench
+{
+
+public:
+	BcBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string image;
+		// Width and height of the generated image
+		size_t size{ 1024 };
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+	static auto LoadImage(const std::string& path, io::Image& image) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bench_utils.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/image_decoder.h"
+#include "header/scene_input.h"
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Stopwatch
+/// Measures wall clock time from its construction or the last \c Restart.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Stopwatch
+{
+
+public:
+	Stopwatch();
+
+	void Restart();
+	[[nodiscard]] auto GetMs() const -> double;
+
+private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * Runs \p fn \p repeat times and returns the duration of the fastest run in milliseconds,
+ * the other runs are slowed down by the machine and not by the code.
+ */
+template <class Fn>
+auto MeasureBestMs(size_t repeat, const Fn& fn) -> double
+{
+	double best = std::numeric_limits<double>::max();
+	for (size_t i = 0; i < std::max<size_t>(repeat, 1); i++) {
+		const Stopwatch stopwatch;
+		fn();
+		best = std::min(best, stopwatch.GetMs());
+	}
+	return best;
+}
+
+/**
+ * Returns an RGBA image of smooth gradients with noise and sharp edges, which filters and
+ * compressors handle roughly like photographs, and a smooth alpha gradient. The same seed
+ * gives the same image.
+ */
+auto MakeTestImage(uint32_t width, uint32_t height, uint32_t seed) -> io::Image;
+
+/**
+ * Fills \p input with \p count objects on a square grid with 2 meters between them, in tiles
+ * of 16x16 objects. The models are picked at random from \p models, the same seed gives the
+ * same scene. The users are left as they are.
+ * @return the side length of the grid in meters, it starts at the origin
+ */
+auto MakeObjectGrid(
+	size_t count, const std::vector<uint32_t>& models, uint32_t seed,
+	graphics::SceneInput& input
+) -> float;
+
+/**
+ * Parses a positive number.
+ * @return false if \p value is not a number greater than 0
+ */
+auto ParseCount(const std::string& value, size_t& count) -> bool;
+
+} // namespace bench
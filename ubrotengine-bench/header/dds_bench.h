@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: dds_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: DdsBench
+/// Times the DDS load path without the upload: \c MappedFile opens and maps a file and
+/// \c DdsLoader parses the header and lays out the subresources in the mapped memory. Every
+/// BC format from BC1 to BC7 is written as a single level, a mip chain, a texture array and
+/// a cubemap. Every page of a loaded file is touched once, like the upload does, so GB/s
+/// includes mapping the pages. Reports the time per step, files per second and GB/s.
+///
+/// Usage: dds [--size <pixels>] [--loads <count>] [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class DdsBench
+{
+
+public:
+	DdsBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		// Width and height of the top level
+		size_t size{ 512 };
+		// Loads of every file per run
+		size_t loads{ 200 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: decode_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: DecodeBench
+/// Times the vectorized steps of the image decoder against their scalar references and
+/// reports megapixels per second for both: PNG unfiltering of 3 and 4 byte pixels for every
+/// filter type, the BGRA to RGBA swizzle and the decode of an RLE compressed 32 bit TGA.
+/// The TGA reference expands the packets the same way and swizzles with the scalar loop.
+/// Both results are compared before they are timed. Without SSE2 both columns run the same
+/// scalar code.
+///
+/// Usage: decode [--size <pixels>] [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class DecodeBench
+{
+
+public:
+	DecodeBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		// Width and height of the image
+		size_t size{ 2048 };
+		size_t repeat{ 5 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
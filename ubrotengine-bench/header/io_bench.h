@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: io_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: IoBench
+/// Reads a directory of files with sizes like small assets through the \c AsyncFileReader,
+/// with every available backend and several in-flight limits, and once with blocking reads
+/// on the calling thread for comparison. Reports the throughput and the latency from the
+/// \c Read call to the callback, whose tail shows how long a single asset can be stuck
+/// behind the others. The files stay in the page cache between the runs.
+///
+/// Usage: io [--files <count>] [--in-flight <count>]... [--threads <count>]
+///        [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class IoBench
+{
+
+public:
+	IoBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t files{ 10000 };
+		// 16, 64 and 256 if empty
+		std::vector<size_t> in_flight;
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mips_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/mip_generator.h"
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: MipsBench
+/// Times the generation of full mip chains for square sRGB images, on one thread and on the
+/// thread pool, and reports the time per chain and the base level megapixels per second.
+///
+/// Usage: mips [--size <pixels>]... [--filter box|kaiser] [--threads <count>]
+///        [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MipsBench
+{
+
+public:
+	MipsBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		// 4K and 8K if empty
+		std::vector<size_t> sizes;
+		// Both filters if empty
+		std::vector<io::MipFilter> filters;
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: pack_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/asset_loader.h"
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: PackBench
+/// Packs sets of synthetic RGBA textures with the \c TexturePacker on the null device and
+/// reports the atlas occupancy and the build time. A random draw list, sorted like the
+/// renderer sorts its packets, tells how many shader resource binds the packing saves
+/// compared to one resource per texture.
+///
+/// Usage: pack [--textures <count>] [--draws <count>] [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PackBench
+{
+
+public:
+	PackBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t textures{ 1000 };
+		size_t draws{ 10000 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	/**
+	 * Returns \p count textures with full mip chains, the same seed gives the same set.
+	 * @param large_share every n-th texture is too large for the atlas, 0 for none
+	 */
+	static auto MakeTextures(size_t count, size_t large_share, uint32_t seed)
+		-> std::vector<io::TextureData>;
+};
+
+} // namespace bench
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: passes_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: PassesBench
+/// Renders a grid of objects on the null backend with one view, first with the main pass
+/// only, then with the planar reflection below the objects and then also with the shadow
+/// cascades. Reports the CPU time per frame and the draw packets of every pass, so the extra
+/// cost of a pass can be held against the objects it draws.
+///
+/// Usage: passes [--objects <count>] [--frames <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PassesBench
+{
+
+public:
+	PassesBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t objects{ 20000 };
+		size_t frames{ 100 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
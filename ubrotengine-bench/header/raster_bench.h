@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: raster_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RasterBench
+/// Renders the standard scenes with the software backend, which needs neither a window nor a
+/// GPU. The scenes are built from a tessellated sphere: a grid seen from above, a walk at eye
+/// level through the same grid, and a few spheres that fill the screen. Reports the CPU time
+/// per frame, the triangle setup and raster time of the rasterizer and the triangles per
+/// second. Reflections and shadows are disabled, the backend does not draw them.
+///
+/// Usage: raster [--objects <count>] [--segments <count>] [--frames <count>]
+///               [--width <pixels>] [--height <pixels>] [--save <directory>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RasterBench
+{
+
+public:
+	RasterBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t objects{ 1000 };
+		size_t segments{ 64 };
+		size_t frames{ 10 };
+		size_t width{ 1920 };
+		size_t height{ 1080 };
+		// Writes the last frame of every scene as PNG, if not empty
+		std::string save_directory{};
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: replay_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/frame_capture.h"
+#include "header/renderer.h"
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ReplayBench
+/// Renders the frames of a capture again on a headless backend, like the replay command of
+/// ubrotengine-tools but without a window, so it also runs where Direct3D does not. The
+/// setup records are repeated on the renderer and the renderer is deterministic, so every
+/// replay of a capture draws the same commands. The CPU stage timings and a hash of the
+/// recorded commands of every frame are printed as CSV, the summary hashes all frames.
+///
+/// With --record the capture is written first: a camera walks through a grid of objects,
+/// rendered with the recording backend. The printed hashes are the ones a replay with the
+/// recording backend has to reproduce.
+///
+/// Usage: replay <capture> [--backend null|recording|software] [--loops <count>] [--summary]
+///               [--record <frames>] [--objects <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ReplayBench
+{
+
+public:
+	ReplayBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string capture;
+		// Overrides the backend of the captured settings if set
+		bool override_backend{ false };
+		graphics::RenderBackend backend{ graphics::RenderBackend::Null };
+		// The frames are rendered this many times, the setup only once
+		size_t loops{ 1 };
+		// Only print the totals
+		bool summary{ false };
+		// Writes a capture of this many frames instead of replaying one, if not 0
+		size_t record_frames{ 0 };
+		// Objects on the grid of a recorded capture
+		size_t objects{ 2000 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	/**
+	 * Writes the capture of the options and prints the frames like a replay does.
+	 */
+	static auto Record(const Options& options) -> int;
+
+	/**
+	 * Repeats a setup record, the first settings initialize the renderer.
+	 * @return false if the record is invalid or the renderer could not be initialized
+	 */
+	static auto ApplySetup(
+		const graphics::CaptureEntry& entry, const Options& options,
+		graphics::Renderer& renderer, bool& initialized
+	) -> bool;
+};
+
+} // namespace bench
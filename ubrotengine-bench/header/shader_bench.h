@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShaderBench
+/// Runs the \c ShaderManager on the null device with a stand-in compiler that takes a fixed
+/// time per stage, on a copy of the engine shaders in a temporary directory. Reports the
+/// startup time for several compile thread counts, with an empty and with a filled shader
+/// cache, and then plays frames that draw every variant: once with the variants compiled
+/// in the background and once with a blocking compile on first use, and counts the frames
+/// that took longer than \c ShaderManager::HITCH_MS.
+///
+/// Usage: shaders [--compile-ms <ms>] [--threads <count>]... [--frames <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShaderBench
+{
+
+public:
+	ShaderBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t compile_ms{ 30 };
+		// 1 and 8 if empty
+		std::vector<size_t> threads;
+		size_t frames{ 120 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
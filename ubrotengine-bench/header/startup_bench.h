@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: startup_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: StartupBench
+/// Writes many small OBJ models and PNG textures into a temporary directory and into an
+/// archive, and times reading all of them as well as loading them with the \c AssetManager
+/// on the null device, once from the loose files and once from the archive. The files stay in
+/// the page cache between the runs, so the numbers show the cost of opening files and not
+/// the cost of seeking on a cold disk.
+///
+/// Usage: startup [--assets <count>] [--threads <count>] [--repeat <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class StartupBench
+{
+
+public:
+	StartupBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		// Half of them models, half textures
+		size_t assets{ 10000 };
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+		size_t repeat{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: stream_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: StreamBench
+/// Flies a camera through a field of textured objects and drives the \c MipStreamer with the
+/// screen sizes of the visible ones, loads finish a fixed number of frames after they were
+/// started. Reports the time of the streaming decisions per frame, the loaded and evicted
+/// levels and the share of drawn textures with more than their tail levels in view that
+/// have all the detail they need, for several memory budgets.
+///
+/// Usage: stream [--textures <count>] [--frames <count>] [--budget <MB>]...
+///        [--frame-load <MB>] [--latency <frames>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class StreamBench
+{
+
+public:
+	StreamBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t textures{ 10000 };
+		size_t frames{ 600 };
+		// 128, 512 and 2048 MB if empty
+		std::vector<size_t> budgets_mb;
+		size_t frame_load_mb{ 8 };
+		size_t latency{ 3 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: views_bench.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ViewsBench
+/// Renders a grid of objects on the null backend for 1, 2 and 4 users, once as split screen
+/// views of one frame and once as one independent frame per user, with a single view of the
+/// size of a split screen view. Independent frames repeat the traversal and culling for
+/// every user. Reports the CPU time per frame and its gather and submit stages. Shadows are
+/// disabled, so only the work of the views counts.
+///
+/// Usage: views [--objects <count>] [--frames <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ViewsBench
+{
+
+public:
+	ViewsBench() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		size_t objects{ 20000 };
+		size_t frames{ 100 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+};
+
+} // namespace bench
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: main.cpp
+/// Benchmarks of the engine parts that run without a GPU, one command per measurement.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/bc_bench.h"
+#include "header/dds_bench.h"
+#include "header/decode_bench.h"
+#include "header/io_bench.h"
+#include "header/mips_bench.h"
+#include "header/pack_bench.h"
+#include "header/passes_bench.h"
+#include "header/raster_bench.h"
+#include "header/replay_bench.h"
+#include "header/shader_bench.h"
+#include "header/startup_bench.h"
+#include "header/stream_bench.h"
+#include "header/views_bench.h"
+
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::printf("ubrotengine-bench <command> [arguments]\n\ncommands:\n");
+	bench::BcBench::PrintUsage();
+	bench::DdsBench::PrintUsage();
+	bench::DecodeBench::PrintUsage();
+	bench::IoBench::PrintUsage();
+	bench::MipsBench::PrintUsage();
+	bench::PackBench::PrintUsage();
+	bench::PassesBench::PrintUsage();
+	bench::RasterBench::PrintUsage();
+	bench::ReplayBench::PrintUsage();
+	bench::ShaderBench::PrintUsage();
+	bench::StartupBench::PrintUsage();
+	bench::StreamBench::PrintUsage();
+	bench::ViewsBench::PrintUsage();
+}
+
+} // namespace
+
+
+auto main(int argc, char** argv) -> int
+{
+	if (argc < 2) {
+		PrintUsage();
+		return 1;
+	}
+
+	const std::string command = argv[1];
+	const std::vector<std::string> args(argv + 2, argv + argc);
+
+	if (command == "bc") {
+		return bench::BcBench::Run(args);
+	}
+	if (command == "dds") {
+		return bench::DdsBench::Run(args);
+	}
+	if (command == "decode") {
+		return bench::DecodeBench::Run(args);
+	}
+	if (command == "io") {
+		return bench::IoBench::Run(args);
+	}
+	if (command == "mips") {
+		return bench::MipsBench::Run(args);
+	}
+	if (command == "pack") {
+		return bench::PackBench::Run(args);
+	}
+	if (command == "passes") {
+		return bench::PassesBench::Run(args);
+	}
+	if (command == "raster") {
+		return bench::RasterBench::Run(args);
+	}
+	if (command == "replay") {
+		return bench::ReplayBench::Run(args);
+	}
+	if (command == "shaders") {
+		return bench::ShaderBench::Run(args);
+	}
+	if (command == "startup") {
+		return bench::StartupBench::Run(args);
+	}
+	if (command == "stream") {
+		return bench::StreamBench::Run(args);
+	}
+	if (command == "views") {
+		return bench::ViewsBench::Run(args);
+	}
+
+	PrintUsage();
+	return 1;
+}
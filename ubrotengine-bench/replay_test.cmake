@@ -0,0 +1,36 @@
+# Records a capture with the recording backend, replays it and fails if the replay drew other
+# commands than the recording. Run with:
+#   cmake -DBENCH=<ubrotengine-bench> -DCAPTURE=<file> -P replay_test.cmake
+
+function(run_bench output_variable)
+	execute_process(
+		COMMAND ${BENCH} replay ${CAPTURE} --summary ${ARGN}
+		OUTPUT_VARIABLE output
+		ERROR_VARIABLE output
+		RESULT_VARIABLE result
+	)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "replay ${ARGN} failed:\n${output}")
+	endif()
+	message(STATUS "replay ${ARGN}: ${output}")
+	set(${output_variable} "${output}" PARENT_SCOPE)
+endfunction()
+
+# The hash of the commands of all frames, empty if the summary has none
+function(get_hash output hash_variable)
+	string(REGEX MATCH "commands ([0-9a-f]+)" match "${output}")
+	set(${hash_variable} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+endfunction()
+
+run_bench(recorded --record 30 --objects 500)
+run_bench(replayed --backend recording)
+# The other headless backends have to read the same capture
+run_bench(software --backend software)
+
+get_hash("${recorded}" recorded_hash)
+get_hash("${replayed}" replayed_hash)
+if(recorded_hash STREQUAL "" OR NOT recorded_hash STREQUAL replayed_hash)
+	message(FATAL_ERROR "the replay drew other commands: '${replayed_hash}', "
+		"recorded '${recorded_hash}'")
+endif()
+file(REMOVE ${CAPTURE})
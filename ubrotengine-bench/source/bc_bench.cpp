@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bc_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/bc_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/thread_pool.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+constexpr const char* FORMAT_NAMES[] = { "BC1", "BC3", "BC5", "BC7" };
+
+} // namespace
+
+
+auto BcBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	io::Image image;
+	if (options.image.empty()) {
+		image = MakeTestImage(uint32_t(options.size), uint32_t(options.size), 34);
+	}
+	else if (!LoadImage(options.image, image)) {
+		std::fprintf(stderr, "Could not decode %s\n", options.image.c_str());
+		return 1;
+	}
+
+	// The 1 bit alpha of BC1 is meant for cutouts, it is measured on an opaque copy
+	auto opaque = image;
+	for (size_t i = 3; i < opaque.pixels.size(); i += 4) {
+		opaque.pixels[i] = 255;
+	}
+
+	utils::ThreadPool thread_pool(options.threads > 1 ? options.threads - 1 : 0);
+	const size_t threads = options.threads == 1 ? 1 : thread_pool.GetThreadCount();
+	const std::vector<utils::ThreadPool*> pools = threads > 1
+		? std::vector<utils::ThreadPool*>{ nullptr, &thread_pool }
+		: std::vector<utils::ThreadPool*>{ nullptr };
+
+	std::printf(
+		"BC compression of %ux%u pixels, best of %zu runs\n", image.width, image.height,
+		options.repeat
+	);
+	std::printf(
+		"%8s %8s %8s %10s %10s %14s\n", "format", "quality", "threads", "PSNR dB", "ms",
+		"blocks/s"
+	);
+	for (size_t f = 0; f < size_t(io::BcFormat::NUMBER); f++) {
+		for (const auto quality : { io::BcQuality::Fast, io::BcQuality::High }) {
+			for (auto* pool : pools) {
+				std::vector<uint8_t> blocks;
+				io::BcEncoder::Stats stats;
+				const auto ms = MeasureBestMs(options.repeat, [&]() {
+					const auto format = io::BcFormat(f);
+					stats = io::BcEncoder::Compress(
+						format == io::BcFormat::BC1 ? opaque : image, format, quality, blocks,
+						pool
+					);
+				});
+				std::printf(
+					"%8s %8s %8zu %10.2f %10.1f %14.0f\n", FORMAT_NAMES[f],
+					quality == io::BcQuality::Fast ? "fast" : "high",
+					pool != nullptr ? threads : size_t(1), stats.GetPsnr(), ms,
+					double(stats.blocks) / (ms / 1000.0)
+				);
+			}
+		}
+	}
+	return 0;
+}
+
+
+void BcBench::PrintUsage()
+{
+	std::printf(
+		"bc [options]\n"
+		"  --image <png/tga>         image to compress (default a generated one)\n"
+		"  --size <pixels>           size of the generated image (default 1024)\n"
+		"  --threads <count>         threads of the pool (default all)\n"
+		"  --repeat <count>          runs per measurement, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto BcBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--image" && has_value) {
+			options.image = args[++i];
+		}
+		else if (arg == "--size" && has_value) {
+			if (!ParseCount(args[++i], options.size)) {
+				return false;
+			}
+		}
+		else if (arg == "--threads" && has_value) {
+			if (!ParseCount(args[++i], options.threads)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+auto BcBench::LoadImage(const std::string& path, io::Image& image) -> bool
+{
+	std::ifstream file(path, std::ios::binary);
+	const std::vector<uint8_t> data(
+		(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()
+	);
+	if (file.fail() && !file.eof()) {
+		return false;
+	}
+	const auto extension = std::filesystem::path(path).extension();
+	if (extension == ".png") {
+		return io::ImageDecoder::DecodePng(data.data(), data.size(), image, nullptr);
+	}
+	if (extension == ".tga") {
+		return io::ImageDecoder::DecodeTga(data.data(), data.size(), image, nullptr);
+	}
+	return false;
+}
+
+} // namespace bench
@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bench_utils.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/bench_utils.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace bench
+{
+
+Stopwatch::Stopwatch() :
+	m_start(std::chrono::steady_clock::now())
+{
+}
+
+
+void Stopwatch::Restart()
+{
+	m_start = std::chrono::steady_clock::now();
+}
+
+
+auto Stopwatch::GetMs() const -> double
+{
+	const std::chrono::duration<double, std::milli> elapsed =
+		std::chrono::steady_clock::now() - m_start;
+	return elapsed.count();
+}
+
+
+auto MakeTestImage(uint32_t width, uint32_t height, uint32_t seed) -> io::Image
+{
+	io::Image image;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(size_t(width) * height * 4);
+
+	uint32_t state = seed * 2654435761U + 1;
+	for (uint32_t y = 0; y < height; y++) {
+		auto* row = image.pixels.data() + size_t(y) * width * 4;
+		for (uint32_t x = 0; x < width; x++) {
+			// xorshift noise on top of gradients, with a hard color edge every 61 pixels, alpha is
+			// a smooth gradient
+			state ^= state << 13U;
+			state ^= state >> 17U;
+			state ^= state << 5U;
+			const uint32_t noise = state & 15U;
+			const uint32_t edge = ((x / 61 + y / 61) & 1U) * 64;
+			row[x * 4 + 0] = uint8_t((x * 255 / width + noise + edge) & 255U);
+			row[x * 4 + 1] = uint8_t((y * 255 / height + noise) & 255U);
+			row[x * 4 + 2] = uint8_t(((x + y) * 127 / (width + height) + edge) & 255U);
+			row[x * 4 + 3] = uint8_t(255 - (x + y) * 127 / (width + height));
+		}
+	}
+	return image;
+}
+
+
+auto MakeObjectGrid(
+	size_t count, const std::vector<uint32_t>& models, uint32_t seed,
+	graphics::SceneInput& input
+) -> float
+{
+	constexpr float SPACING = 2.0F;
+	constexpr size_t TILE_SIZE = 16;
+	const auto side = size_t(std::ceil(std::sqrt(double(count))));
+	const auto tiles = (side + TILE_SIZE - 1) / TILE_SIZE;
+
+	input.tile_objects.clear();
+	input.models.clear();
+	input.positions.clear();
+	std::mt19937 random(seed);
+	for (size_t tile = 0; tile < tiles * tiles && input.models.size() < count; tile++) {
+		uint32_t tile_objects{ 0 };
+		for (size_t i = 0; i < TILE_SIZE * TILE_SIZE && input.models.size() < count; i++) {
+			const auto x = tile % tiles * TILE_SIZE + i % TILE_SIZE;
+			const auto z = tile / tiles * TILE_SIZE + i / TILE_SIZE;
+			if (x >= side || z >= side) {
+				continue;
+			}
+			input.models.push_back(models[random() % models.size()]);
+			input.positions.push_back({ float(x) * SPACING, 0.0F, float(z) * SPACING });
+			tile_objects++;
+		}
+		input.tile_objects.push_back(tile_objects);
+	}
+	return float(side) * SPACING;
+}
+
+
+auto ParseCount(const std::string& value, size_t& count) -> bool
+{
+	char* end = nullptr;
+	const auto parsed = std::strtoull(value.c_str(), &end, 10);
+	if (end == value.c_str() || *end != '\0' || parsed == 0) {
+		return false;
+	}
+	count = size_t(parsed);
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: dds_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/dds_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/dds_loader.h"
+#include "header/mapped_file.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+// Every page of a file is touched once, the data of a page is loaded with its first byte
+constexpr size_t PAGE_SIZE = 4096;
+
+struct Format
+{
+	graphics::TextureFormat format;
+	const char* name;
+};
+constexpr Format FORMATS[] = {
+	{ graphics::TextureFormat::BC1_UNORM, "bc1" },
+	{ graphics::TextureFormat::BC2_UNORM, "bc2" },
+	{ graphics::TextureFormat::BC3_UNORM, "bc3" },
+	{ graphics::TextureFormat::BC4_UNORM, "bc4" },
+	{ graphics::TextureFormat::BC5_UNORM, "bc5" },
+	{ graphics::TextureFormat::BC6H_UF16, "bc6h" },
+	{ graphics::TextureFormat::BC7_UNORM, "bc7" }
+};
+
+struct Layout
+{
+	const char* name;
+	// 0 for the full mip chain
+	uint32_t mip_count;
+	uint32_t array_size;
+	bool cubemap;
+};
+constexpr Layout LAYOUTS[] = {
+	{ "single", 1, 1, false },
+	{ "mips", 0, 1, false },
+	{ "array", 0, 8, false },
+	{ "cube", 0, 6, true }
+};
+
+/**
+ * Times of one run over all loads of a file.
+ */
+struct LoadRun
+{
+	double ms{ 0.0 };
+	double open_ms{ 0.0 };
+	double parse_ms{ 0.0 };
+};
+
+/**
+ * Returns the size of all subresources of \p info without padding, as \c DdsLoader::Write
+ * expects them.
+ */
+auto GetDataSize(const io::DdsInfo& info) -> size_t
+{
+	size_t size{ 0 };
+	for (uint32_t mip = 0; mip < info.mip_count; mip++) {
+		uint32_t row_pitch{ 0 };
+		uint32_t row_count{ 0 };
+		io::DdsLoader::GetSurfaceInfo(
+			std::max(info.width >> mip, 1U), std::max(info.height >> mip, 1U), info.format,
+			row_pitch, row_count
+		);
+		size += size_t(row_pitch) * row_count;
+	}
+	return size * info.array_size;
+}
+
+/**
+ * Checks that \p filename parses to \p expected and that its subresources end with the file.
+ */
+auto CheckFile(const std::string& filename, const io::DdsInfo& expected) -> bool
+{
+	io::MappedFile file;
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	if (!file.Open(filename)
+		|| !io::DdsLoader::Parse(file.GetData(), file.GetSize(), info, subresources)) {
+		return false;
+	}
+	if (info.width != expected.width || info.height != expected.height
+		|| info.mip_count != expected.mip_count || info.array_size != expected.array_size
+		|| info.cubemap != expected.cubemap || info.format != expected.format
+		|| subresources.size() != size_t(info.mip_count) * info.array_size) {
+		return false;
+	}
+	const auto last_mip = info.mip_count - 1;
+	uint32_t row_pitch{ 0 };
+	uint32_t row_count{ 0 };
+	io::DdsLoader::GetSurfaceInfo(
+		std::max(info.width >> last_mip, 1U), std::max(info.height >> last_mip, 1U), info.format,
+		row_pitch, row_count
+	);
+	const auto* end = static_cast<const uint8_t*>(subresources.back().data)
+		+ size_t(row_pitch) * row_count;
+	return end == file.GetData() + file.GetSize();
+}
+
+/**
+ * Opens, parses and touches \p filename \p loads times.
+ */
+auto Load(const std::string& filename, size_t loads) -> LoadRun
+{
+	LoadRun run;
+	io::MappedFile file;
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	uint8_t checksum{ 0 };
+	const Stopwatch total;
+	for (size_t i = 0; i < loads; i++) {
+		Stopwatch stopwatch;
+		file.Open(filename);
+		run.open_ms += stopwatch.GetMs();
+
+		stopwatch.Restart();
+		io::DdsLoader::Parse(file.GetData(), file.GetSize(), info, subresources);
+		run.parse_ms += stopwatch.GetMs();
+
+		for (size_t offset = 0; offset < file.GetSize(); offset += PAGE_SIZE) {
+			checksum ^= file.GetData()[offset];
+		}
+		file.Close();
+	}
+	run.ms = total.GetMs();
+	// Keeps the reads of the pages
+	volatile uint8_t sink = checksum;
+	(void)sink;
+	return run;
+}
+
+} // namespace
+
+
+auto DdsBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	const auto directory = fs::temp_directory_path() / "ubrotengine_dds_bench";
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+
+	const auto size = uint32_t(options.size);
+	uint32_t full_chain{ 1 };
+	while ((size >> full_chain) > 0) {
+		full_chain++;
+	}
+
+	std::printf(
+		"%ux%u textures, %zu loads per file, best of %zu runs\n", size, size, options.loads,
+		options.repeat
+	);
+	std::printf(
+		"%6s %8s %8s %10s %10s %10s %10s %8s\n", "format", "layout", "subres", "KB", "open us",
+		"parse us", "files/s", "GB/s"
+	);
+	std::vector<uint8_t> data;
+	std::vector<uint8_t> file;
+	for (const auto& format : FORMATS) {
+		for (const auto& layout : LAYOUTS) {
+			io::DdsInfo info;
+			info.width = size;
+			info.height = size;
+			info.mip_count = layout.mip_count > 0 ? layout.mip_count : full_chain;
+			info.array_size = layout.array_size;
+			info.cubemap = layout.cubemap;
+			info.format = format.format;
+
+			// The content does not matter to the loader
+			data.resize(GetDataSize(info));
+			for (size_t i = 0; i < data.size(); i++) {
+				data[i] = uint8_t(i * 31);
+			}
+			io::DdsLoader::Write(info, data.data(), data.size(), file);
+			const auto filename =
+				(directory / (std::string(format.name) + "_" + layout.name + ".dds")).string();
+			{
+				std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+				stream.write(
+					reinterpret_cast<const char*>(file.data()), std::streamsize(file.size())
+				);
+			}
+			if (!CheckFile(filename, info)) {
+				std::printf("%s is not parsed as it was written\n", filename.c_str());
+				return 1;
+			}
+
+			LoadRun best;
+			best.ms = std::numeric_limits<double>::max();
+			for (size_t i = 0; i < options.repeat; i++) {
+				const auto run = Load(filename, options.loads);
+				if (run.ms < best.ms) {
+					best = run;
+				}
+			}
+			const auto loads = double(options.loads);
+			std::printf(
+				"%6s %8s %8u %10.1f %10.2f %10.2f %10.0f %8.2f\n", format.name, layout.name,
+				info.mip_count * info.array_size, double(file.size()) / 1024.0,
+				best.open_ms * 1000.0 / loads, best.parse_ms * 1000.0 / loads,
+				loads / (best.ms / 1000.0), double(file.size()) * loads / (best.ms * 1e6)
+			);
+		}
+	}
+
+	std::error_code error;
+	fs::remove_all(directory, error);
+	return 0;
+}
+
+
+void DdsBench::PrintUsage()
+{
+	std::printf(
+		"dds [options]\n"
+		"  --size <pixels>           width and height of the top level (default 512)\n"
+		"  --loads <count>           loads of every file per run (default 200)\n"
+		"  --repeat <count>          runs per file, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto DdsBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--size" && has_value) {
+			// The largest texture Direct3D 11 creates
+			if (!ParseCount(args[++i], options.size) || options.size > 16384) {
+				return false;
+			}
+		}
+		else if (arg == "--loads" && has_value) {
+			if (!ParseCount(args[++i], options.loads)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
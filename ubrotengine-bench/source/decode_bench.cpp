@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: decode_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/decode_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/image_decoder.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+const char* const FILTER_NAMES[] = { "none", "sub", "up", "average", "paeth" };
+
+constexpr size_t TGA_HEADER_SIZE = 18;
+// Longest run or raw packet of a TGA
+constexpr size_t TGA_MAX_PACKET = 128;
+
+/**
+ * Returns the pixels of \p image with \p bpp bytes each, the fourth channel is dropped for 3.
+ * The bytes are decoded as if they were filtered, which is as fast as real filtered data.
+ */
+auto GetRows(const io::Image& image, uint32_t bpp) -> std::vector<uint8_t>
+{
+	const size_t pixel_count = size_t(image.width) * image.height;
+	std::vector<uint8_t> rows(pixel_count * bpp);
+	for (size_t i = 0; i < pixel_count; i++) {
+		std::memcpy(rows.data() + i * bpp, image.pixels.data() + i * 4, bpp);
+	}
+	return rows;
+}
+
+/**
+ * Unfilters all rows of \p rows in place with the vectorized or the scalar path.
+ */
+auto Unfilter(
+	std::vector<uint8_t>& rows, uint8_t filter, size_t row_bytes, uint32_t bpp, bool scalar
+) -> bool
+{
+	const auto unfilter = scalar ? io::ImageDecoder::UnfilterRowScalar
+		: io::ImageDecoder::UnfilterRow;
+	for (size_t offset = 0; offset < rows.size(); offset += row_bytes) {
+		const auto* prior = offset > 0 ? rows.data() + offset - row_bytes : nullptr;
+		if (!unfilter(filter, rows.data() + offset, prior, row_bytes, bpp)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Returns \p image as a 32 bit RLE TGA with the origin at the top. The left half of every
+ * row is flat, so the file has long run packets as well as raw packets.
+ */
+auto EncodeTgaRle(const io::Image& image) -> std::vector<uint8_t>
+{
+	std::vector<uint8_t> file(TGA_HEADER_SIZE, 0);
+	file[2] = 10;
+	file[12] = uint8_t(image.width & 0xFFU);
+	file[13] = uint8_t(image.width >> 8U);
+	file[14] = uint8_t(image.height & 0xFFU);
+	file[15] = uint8_t(image.height >> 8U);
+	file[16] = 32;
+	// 8 alpha bits, top origin
+	file[17] = 0x28;
+
+	std::vector<uint8_t> bgra(size_t(image.width) * 4);
+	for (uint32_t y = 0; y < image.height; y++) {
+		io::ImageDecoder::SwizzleBgraScalar(
+			image.pixels.data() + size_t(y) * image.width * 4, bgra.data(), image.width
+		);
+		for (uint32_t x = 0; x < image.width / 2; x++) {
+			std::memcpy(bgra.data() + size_t(x) * 4, bgra.data(), 4);
+		}
+
+		// Packets do not span rows, which the decoder allows but does not need
+		size_t x = 0;
+		while (x < image.width) {
+			size_t run = 1;
+			while (x + run < image.width && run < TGA_MAX_PACKET
+				&& std::memcmp(bgra.data() + x * 4, bgra.data() + (x + run) * 4, 4) == 0) {
+				run++;
+			}
+			if (run > 1) {
+				file.push_back(uint8_t(0x80U | (run - 1)));
+				file.insert(file.end(), bgra.data() + x * 4, bgra.data() + x * 4 + 4);
+				x += run;
+				continue;
+			}
+			// Raw pixels up to the next run of at least two
+			size_t raw = 1;
+			while (x + raw < image.width && raw < TGA_MAX_PACKET
+				&& (x + raw + 1 >= image.width
+					|| std::memcmp(
+						bgra.data() + (x + raw) * 4, bgra.data() + (x + raw + 1) * 4, 4
+					) != 0)) {
+				raw++;
+			}
+			file.push_back(uint8_t(raw - 1));
+			file.insert(file.end(), bgra.data() + x * 4, bgra.data() + (x + raw) * 4);
+			x += raw;
+		}
+	}
+	return file;
+}
+
+/**
+ * Scalar reference of \c ImageDecoder::DecodeTga for the files of \c EncodeTgaRle: the
+ * packets are expanded the same way and the pixels are swizzled with the scalar loop.
+ */
+auto DecodeTgaRleScalar(const std::vector<uint8_t>& file, io::Image& image) -> bool
+{
+	if (file.size() < TGA_HEADER_SIZE) {
+		return false;
+	}
+	image.width = file[12] | uint32_t(file[13]) << 8U;
+	image.height = file[14] | uint32_t(file[15]) << 8U;
+	image.srgb = true;
+	const size_t image_bytes = size_t(image.width) * image.height * 4;
+
+	std::vector<uint8_t> expanded(image_bytes);
+	size_t offset = TGA_HEADER_SIZE;
+	size_t pos = 0;
+	while (pos < image_bytes) {
+		if (offset >= file.size()) {
+			return false;
+		}
+		const auto packet = file[offset++];
+		const size_t bytes = std::min((size_t(packet & 0x7FU) + 1) * 4, image_bytes - pos);
+		const size_t packet_bytes = (packet & 0x80U) != 0 ? 4 : bytes;
+		if (file.size() - offset < packet_bytes) {
+			return false;
+		}
+		if ((packet & 0x80U) != 0) {
+			for (size_t i = 0; i < bytes; i += 4) {
+				std::memcpy(expanded.data() + pos + i, file.data() + offset, 4);
+			}
+		}
+		else {
+			std::memcpy(expanded.data() + pos, file.data() + offset, bytes);
+		}
+		offset += packet_bytes;
+		pos += bytes;
+	}
+
+	image.pixels.resize(image_bytes);
+	io::ImageDecoder::SwizzleBgraScalar(
+		expanded.data(), image.pixels.data(), size_t(image.width) * image.height
+	);
+	return true;
+}
+
+void PrintRow(
+	const char* step, const char* filter, uint32_t bpp, double megapixels, double simd_ms,
+	double scalar_ms
+)
+{
+	std::printf(
+		"%10s %8s %4u %12.1f %12.1f %8.2f\n", step, filter, bpp, megapixels / (simd_ms / 1000.0),
+		megapixels / (scalar_ms / 1000.0), scalar_ms / simd_ms
+	);
+}
+
+} // namespace
+
+
+auto DecodeBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	const auto size = uint32_t(options.size);
+	const auto image = MakeTestImage(size, size, 32);
+	const double megapixels = double(size) * double(size) / 1e6;
+
+	std::printf("%ux%u pixels, best of %zu runs\n", size, size, options.repeat);
+	std::printf(
+		"%10s %8s %4s %12s %12s %8s\n", "step", "filter", "bpp", "sse2 MP/s", "scalar MP/s",
+		"speedup"
+	);
+
+	// Filter type 0 leaves the row as it is and is not timed
+	for (const uint32_t bpp : { 3U, 4U }) {
+		const auto source = GetRows(image, bpp);
+		const size_t row_bytes = size_t(size) * bpp;
+		for (uint8_t filter = 1; filter < 5; filter++) {
+			auto simd = source;
+			auto scalar = source;
+			if (!Unfilter(simd, filter, row_bytes, bpp, false)
+				|| !Unfilter(scalar, filter, row_bytes, bpp, true) || simd != scalar) {
+				std::printf("unfiltering %s differs from the scalar one\n", FILTER_NAMES[filter]);
+				return 1;
+			}
+			// The rows are unfiltered again in place, the values do not change the speed
+			const auto simd_ms = MeasureBestMs(options.repeat, [&]() {
+				Unfilter(simd, filter, row_bytes, bpp, false);
+			});
+			const auto scalar_ms = MeasureBestMs(options.repeat, [&]() {
+				Unfilter(scalar, filter, row_bytes, bpp, true);
+			});
+			PrintRow("unfilter", FILTER_NAMES[filter], bpp, megapixels, simd_ms, scalar_ms);
+		}
+	}
+
+	{
+		const size_t pixel_count = size_t(size) * size;
+		std::vector<uint8_t> simd(pixel_count * 4);
+		std::vector<uint8_t> scalar(pixel_count * 4);
+		const auto simd_ms = MeasureBestMs(options.repeat, [&]() {
+			io::ImageDecoder::SwizzleBgra(image.pixels.data(), simd.data(), pixel_count);
+		});
+		const auto scalar_ms = MeasureBestMs(options.repeat, [&]() {
+			io::ImageDecoder::SwizzleBgraScalar(image.pixels.data(), scalar.data(), pixel_count);
+		});
+		if (simd != scalar) {
+			std::printf("the swizzle differs from the scalar one\n");
+			return 1;
+		}
+		PrintRow("swizzle", "-", 4, megapixels, simd_ms, scalar_ms);
+	}
+
+	{
+		const auto file = EncodeTgaRle(image);
+		io::Image simd;
+		io::Image scalar;
+		if (!io::ImageDecoder::DecodeTga(file.data(), file.size(), simd, nullptr)
+			|| !DecodeTgaRleScalar(file, scalar) || simd.pixels != scalar.pixels) {
+			std::printf("the TGA decode differs from the scalar one\n");
+			return 1;
+		}
+		const auto simd_ms = MeasureBestMs(options.repeat, [&]() {
+			io::ImageDecoder::DecodeTga(file.data(), file.size(), simd, nullptr);
+		});
+		const auto scalar_ms = MeasureBestMs(options.repeat, [&]() {
+			DecodeTgaRleScalar(file, scalar);
+		});
+		PrintRow("tga rle", "-", 4, megapixels, simd_ms, scalar_ms);
+	}
+	return 0;
+}
+
+
+void DecodeBench::PrintUsage()
+{
+	std::printf(
+		"decode [options]\n"
+		"  --size <pixels>           width and height of the image (default 2048)\n"
+		"  --repeat <count>          runs per measurement, the fastest counts (default 5)\n"
+	);
+}
+
+
+auto DecodeBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--size" && has_value) {
+			if (!ParseCount(args[++i], options.size)
+				|| options.size > io::ImageDecoder::MAX_DIMENSION) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: io_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/io_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/async_file_reader.h"
+#include "header/thread_pool.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * Latencies of one run in milliseconds and the duration of the whole run.
+ */
+struct ReadRun
+{
+	std::vector<double> latencies;
+	double ms{ 0.0 };
+	uint64_t bytes{ 0 };
+};
+
+auto GetPercentile(std::vector<double> values, double percentile) -> double
+{
+	if (values.empty()) {
+		return 0.0;
+	}
+	const auto rank = size_t(std::ceil(percentile / 100.0 * double(values.size()))) - 1;
+	const auto nth = values.begin() + std::ptrdiff_t(std::min(rank, values.size() - 1));
+	std::nth_element(values.begin(), nth, values.end());
+	return *nth;
+}
+
+/**
+ * Reads every file on the calling thread, like the loaders did before. The latency of a
+ * file is only its own read, nothing is queued.
+ */
+auto ReadBlocking(const std::vector<std::string>& filenames) -> ReadRun
+{
+	ReadRun run;
+	run.latencies.resize(filenames.size());
+	std::vector<uint8_t> data;
+	const Stopwatch total;
+	for (size_t i = 0; i < filenames.size(); i++) {
+		const Stopwatch stopwatch;
+		std::ifstream file(filenames[i], std::ios::binary | std::ios::ate);
+		data.resize(size_t(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size()));
+		run.bytes += file.good() ? data.size() : 0;
+		run.latencies[i] = stopwatch.GetMs();
+	}
+	run.ms = total.GetMs();
+	return run;
+}
+
+auto ReadAsync(
+	const std::vector<std::string>& filenames, io::IoBackend backend, size_t in_flight,
+	utils::ThreadPool* callback_pool
+) -> ReadRun
+{
+	ReadRun run;
+	run.latencies.resize(filenames.size());
+	std::vector<uint64_t> bytes(filenames.size(), 0);
+	const Stopwatch total;
+	{
+		io::AsyncFileReader reader(callback_pool, in_flight, backend);
+		for (size_t i = 0; i < filenames.size(); i++) {
+			// Every callback writes its own element
+			const Stopwatch queued;
+			reader.Read(filenames[i], [&, i, queued](io::AsyncFileReader::Result&& result) {
+				run.latencies[i] = queued.GetMs();
+				bytes[i] = result.success ? result.data.size() : 0;
+			});
+		}
+		reader.Wait();
+	}
+	run.ms = total.GetMs();
+	for (const auto file_bytes : bytes) {
+		run.bytes += file_bytes;
+	}
+	return run;
+}
+
+} // namespace
+
+
+auto IoBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+	if (options.in_flight.empty()) {
+		options.in_flight = { 16, 64, 256 };
+	}
+	utils::ThreadPool thread_pool(options.threads > 1 ? options.threads - 1 : 0);
+	auto* callback_pool = options.threads == 1 ? nullptr : &thread_pool;
+
+	// Sizes between 1 KB and 256 KB, evenly spread on a log scale like small assets
+	const auto directory = fs::temp_directory_path() / "ubrotengine_io_bench";
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+	std::mt19937 random(38);
+	std::uniform_real_distribution<double> log_size(std::log(1024.0), std::log(262144.0));
+	std::vector<std::string> filenames;
+	uint64_t total_bytes{ 0 };
+	std::vector<char> content;
+	for (size_t i = 0; i < options.files; i++) {
+		content.resize(size_t(std::exp(log_size(random))));
+		std::fill(content.begin(), content.end(), char(i));
+		filenames.push_back((directory / (std::to_string(i) + ".bin")).string());
+		std::ofstream file(filenames.back(), std::ios::binary | std::ios::trunc);
+		file.write(content.data(), std::streamsize(content.size()));
+		if (!file.good()) {
+			std::printf("can not write %s\n", filenames.back().c_str());
+			return 1;
+		}
+		total_bytes += content.size();
+	}
+
+	std::printf(
+		"%zu files, %.1f MB, best of %zu runs\n", options.files, double(total_bytes) / 1e6,
+		options.repeat
+	);
+	std::printf(
+		"%10s %10s %10s %10s %10s %10s %10s %10s\n", "backend", "in flight", "ms", "MB/s",
+		"files/s", "p50 ms", "p99 ms", "max ms"
+	);
+	const auto print_row = [&](
+		const char* backend, const std::string& in_flight, const ReadRun& run
+	) {
+		if (run.bytes != total_bytes) {
+			std::printf("%10s only %zu bytes read\n", backend, size_t(run.bytes));
+			return false;
+		}
+		std::printf(
+			"%10s %10s %10.1f %10.1f %10.0f %10.3f %10.3f %10.3f\n", backend, in_flight.c_str(),
+			run.ms, double(total_bytes) / 1e6 / (run.ms / 1000.0),
+			double(options.files) / (run.ms / 1000.0), GetPercentile(run.latencies, 50.0),
+			GetPercentile(run.latencies, 99.0), GetPercentile(run.latencies, 100.0)
+		);
+		return true;
+	};
+	const auto best_of = [&](const auto& read) {
+		auto best = read();
+		for (size_t i = 1; i < options.repeat; i++) {
+			auto run = read();
+			if (run.ms < best.ms) {
+				best = std::move(run);
+			}
+		}
+		return best;
+	};
+
+	auto blocking = best_of([&]() { return ReadBlocking(filenames); });
+	bool success = print_row("blocking", "1", blocking);
+
+	// The threads backend is always there, io_uring only if the kernel supports it
+	std::vector<io::IoBackend> backends = { io::IoBackend::Threads };
+	if (io::AsyncFileReader(nullptr, 1, io::IoBackend::IoUring).GetBackend()
+		== io::IoBackend::IoUring) {
+		backends.push_back(io::IoBackend::IoUring);
+	}
+	for (const auto backend : backends) {
+		for (const auto in_flight : options.in_flight) {
+			auto run = best_of([&]() {
+				return ReadAsync(filenames, backend, in_flight, callback_pool);
+			});
+			success = print_row(
+				backend == io::IoBackend::IoUring ? "io_uring" : "threads",
+				std::to_string(in_flight), run
+			) && success;
+		}
+	}
+
+	std::error_code error;
+	fs::remove_all(directory, error);
+	return success ? 0 : 1;
+}
+
+
+void IoBench::PrintUsage()
+{
+	std::printf(
+		"io [options]\n"
+		"  --files <count>           files between 1 KB and 256 KB (default 10000)\n"
+		"  --in-flight <count>       reads outstanding at once, repeatable\n"
+		"                            (default 16, 64 and 256)\n"
+		"  --threads <count>         threads that run the callbacks (default all)\n"
+		"  --repeat <count>          runs per measurement, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto IoBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--files" && has_value) {
+			if (!ParseCount(args[++i], options.files)) {
+				return false;
+			}
+		}
+		else if (arg == "--in-flight" && has_value) {
+			size_t in_flight{ 0 };
+			if (!ParseCount(args[++i], in_flight)) {
+				return false;
+			}
+			options.in_flight.push_back(in_flight);
+		}
+		else if (arg == "--threads" && has_value) {
+			if (!ParseCount(args[++i], options.threads)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
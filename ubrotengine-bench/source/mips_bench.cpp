@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mips_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/mips_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/thread_pool.h"
+
+
+namespace bench
+{
+
+auto MipsBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+	if (options.sizes.empty()) {
+		options.sizes = { 4096, 8192 };
+	}
+	if (options.filters.empty()) {
+		options.filters = { io::MipFilter::Box, io::MipFilter::Kaiser };
+	}
+
+	utils::ThreadPool thread_pool(options.threads > 1 ? options.threads - 1 : 0);
+	const size_t threads = options.threads == 1 ? 1 : thread_pool.GetThreadCount();
+
+	std::printf("mip chains of sRGB images, best of %zu runs\n", options.repeat);
+	std::printf("%8s %8s %8s %10s %10s\n", "size", "filter", "threads", "ms", "MP/s");
+	for (const auto size : options.sizes) {
+		const auto image = MakeTestImage(uint32_t(size), uint32_t(size), 33);
+		const double megapixels = double(size) * double(size) / 1e6;
+
+		for (const auto filter : options.filters) {
+			// One thread first, the speedup of the pool is the difference of the two rows
+			const std::vector<utils::ThreadPool*> pools = threads > 1
+				? std::vector<utils::ThreadPool*>{ nullptr, &thread_pool }
+				: std::vector<utils::ThreadPool*>{ nullptr };
+			for (auto* pool : pools) {
+				std::vector<io::Image> mips;
+				const auto ms = MeasureBestMs(options.repeat, [&]() {
+					io::MipGenerator::Generate(image, filter, mips, pool);
+				});
+				std::printf(
+					"%8zu %8s %8zu %10.1f %10.1f\n", size,
+					filter == io::MipFilter::Box ? "box" : "kaiser",
+					pool != nullptr ? threads : size_t(1), ms, megapixels / (ms / 1000.0)
+				);
+			}
+		}
+	}
+	return 0;
+}
+
+
+void MipsBench::PrintUsage()
+{
+	std::printf(
+		"mips [options]\n"
+		"  --size <pixels>           width and height, repeatable (default 4096 and 8192)\n"
+		"  --filter box|kaiser       only this filter (default both)\n"
+		"  --threads <count>         threads of the pool (default all)\n"
+		"  --repeat <count>          runs per measurement, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto MipsBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--size" && has_value) {
+			size_t size{ 0 };
+			if (!ParseCount(args[++i], size)) {
+				return false;
+			}
+			options.sizes.push_back(size);
+		}
+		else if (arg == "--filter" && has_value) {
+			const auto& name = args[++i];
+			if (name != "box" && name != "kaiser") {
+				return false;
+			}
+			options.filters.push_back(name == "box" ? io::MipFilter::Box : io::MipFilter::Kaiser);
+		}
+		else if (arg == "--threads" && has_value) {
+			if (!ParseCount(args[++i], options.threads)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: pack_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/pack_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/mip_generator.h"
+#include "header/null_render_device.h"
+#include "header/texture_packer.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+struct Scene
+{
+	const char* name;
+	// Every n-th texture is too large for the atlas, 0 for none
+	size_t large_share;
+};
+
+const Scene SCENES[] = {
+	{ "small", 0 },
+	{ "mixed", 4 },
+};
+
+/**
+ * Returns the number of switches of \p key along the draws.
+ */
+template <class Key>
+auto CountSwitches(const std::vector<size_t>& draws, const Key& key) -> size_t
+{
+	size_t switches{ 0 };
+	for (size_t i = 0; i < draws.size(); i++) {
+		if (i == 0 || key(draws[i]) != key(draws[i - 1])) {
+			switches++;
+		}
+	}
+	return switches;
+}
+
+} // namespace
+
+
+auto PackBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	std::printf(
+		"%zu textures, %zu draws, best of %zu builds on the null device\n", options.textures,
+		options.draws, options.repeat
+	);
+	std::printf(
+		"%8s %8s %8s %10s %10s %10s %12s %12s\n", "scene", "arrays", "pages", "occupancy",
+		"MB", "build ms", "binds/tex", "binds/array"
+	);
+	for (const auto& scene : SCENES) {
+		double best_ms{ 0.0 };
+		assets::TexturePacker::Stats stats;
+		size_t resource_bytes{ 0 };
+		std::vector<assets::TextureLocation> locations(options.textures);
+
+		for (size_t run = 0; run < std::max<size_t>(options.repeat, 1); run++) {
+			// Build releases the CPU data, so every run needs a new set
+			auto textures = MakeTextures(options.textures, scene.large_share, 35);
+			graphics::NullRenderDevice device;
+			assets::TexturePacker packer;
+			for (auto& texture : textures) {
+				packer.Add(std::move(texture));
+			}
+
+			const Stopwatch stopwatch;
+			if (FAILED(packer.Build(device))) {
+				std::printf("%8s build failed\n", scene.name);
+				return 1;
+			}
+			const auto ms = stopwatch.GetMs();
+			best_ms = run == 0 ? ms : std::min(best_ms, ms);
+
+			stats = packer.GetStats();
+			resource_bytes = device.GetStats().resource_bytes;
+			for (size_t i = 0; i < options.textures; i++) {
+				locations[i] = packer.GetLocation(i);
+			}
+		}
+
+		// Every draw samples one texture, the renderer sorts them by array and then by model
+		std::mt19937 random(46);
+		std::vector<size_t> draws(options.draws);
+		for (auto& texture_idx : draws) {
+			texture_idx = random() % options.textures;
+		}
+		const auto array_of = [&](size_t texture_idx) {
+			return locations[texture_idx].array_idx;
+		};
+		std::sort(draws.begin(), draws.end(), [&](size_t a, size_t b) {
+			return array_of(a) != array_of(b) ? array_of(a) < array_of(b) : a < b;
+		});
+		const auto texture_binds = CountSwitches(draws, [](size_t idx) { return idx; });
+		const auto array_binds = CountSwitches(draws, array_of);
+
+		std::printf(
+			"%8s %8zu %8zu %9.1f%% %10.1f %10.1f %12zu %12zu\n", scene.name, stats.arrays,
+			stats.atlas_pages, stats.atlas_occupancy * 100.0F,
+			double(resource_bytes) / (1024.0 * 1024.0), best_ms, texture_binds, array_binds
+		);
+	}
+	return 0;
+}
+
+
+void PackBench::PrintUsage()
+{
+	std::printf(
+		"pack [options]\n"
+		"  --textures <count>        textures per scene (default 1000)\n"
+		"  --draws <count>           draws of the bind count, each samples one texture\n"
+		"                            (default 10000)\n"
+		"  --repeat <count>          builds per scene, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto PackBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--textures" && has_value) {
+			if (!ParseCount(args[++i], options.textures)) {
+				return false;
+			}
+		}
+		else if (arg == "--draws" && has_value) {
+			if (!ParseCount(args[++i], options.draws)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+auto PackBench::MakeTextures(size_t count, size_t large_share, uint32_t seed)
+	-> std::vector<io::TextureData>
+{
+	// Sizes of icons, decals and detail maps, not all of them powers of two
+	const uint32_t small_sizes[] = { 16, 32, 48, 64, 96, 128, 160, 256 };
+	const uint32_t large_sizes[] = { 384, 512 };
+	std::mt19937 random(seed);
+
+	std::vector<io::TextureData> textures(count);
+	for (size_t i = 0; i < count; i++) {
+		const bool large = large_share != 0 && i % large_share == 0;
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+		if (large) {
+			// Few distinct sizes, so the large textures share arrays
+			width = large_sizes[random() % 2];
+			height = width;
+		}
+		else {
+			width = small_sizes[random() % 8];
+			height = small_sizes[random() % 8];
+		}
+
+		auto& data = textures[i];
+		data.images.push_back(MakeTestImage(width, height, seed + uint32_t(i)));
+		std::vector<io::Image> mips;
+		io::MipGenerator::Generate(data.images[0], io::MipFilter::Box, mips, nullptr);
+		std::move(mips.begin(), mips.end(), std::back_inserter(data.images));
+
+		data.info.width = width;
+		data.info.height = height;
+		data.info.mip_count = uint32_t(data.images.size());
+		data.info.array_size = 1;
+		data.info.format = graphics::TextureFormat::R8G8B8A8_UNORM_SRGB;
+		data.subresources.resize(data.images.size());
+		for (size_t level = 0; level < data.images.size(); level++) {
+			data.subresources[level].data = data.images[level].pixels.data();
+			data.subresources[level].row_pitch = data.images[level].width * 4;
+			data.subresources[level].slice_pitch = 0;
+		}
+	}
+	return textures;
+}
+
+} // namespace bench
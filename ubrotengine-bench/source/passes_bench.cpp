@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: passes_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/passes_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstdio>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/renderer.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+enum class Passes : uint8_t
+{
+	Main = 0,
+	Reflection,
+	Shadows
+};
+
+// The objects stand on the plane y = 0 and reach half a meter below it
+constexpr float REFLECTION_HEIGHT = -1.0F;
+
+} // namespace
+
+
+auto PassesBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	graphics::GraphicSettings settings;
+	settings.window_width = 1920;
+	settings.window_height = 1080;
+	settings.render_backend = graphics::RenderBackend::Null;
+	graphics::Renderer renderer;
+	if (FAILED(renderer.Initialize(nullptr, settings))) {
+		std::printf("the renderer can not be initialized\n");
+		return 1;
+	}
+	const std::vector<uint32_t> models = {
+		uint32_t(renderer.RegisterModelProcedural(assets::Procedural::Cube)),
+		uint32_t(renderer.RegisterModelProcedural(assets::Procedural::Sphere)),
+	};
+	graphics::SceneInput input;
+	const float grid_size = MakeObjectGrid(options.objects, models, 46, input);
+
+	std::printf(
+		"%zu objects, reflection at %.0f%% resolution, average of %zu frames\n",
+		options.objects, settings.reflection_scale * 100.0F, options.frames
+	);
+	std::printf(
+		"%12s %10s %10s %10s %10s %12s %10s\n", "passes", "ms", "gather ms", "submit ms",
+		"main", "reflection", "shadows"
+	);
+	for (const auto passes : { Passes::Main, Passes::Reflection, Passes::Shadows }) {
+		if (passes == Passes::Main) {
+			renderer.DisableReflection();
+		}
+		else {
+			renderer.SetReflectionPlane(REFLECTION_HEIGHT);
+		}
+		if (passes == Passes::Shadows) {
+			renderer.SetLightDirection({ 0.3F, -1.0F, 0.2F });
+		}
+		else {
+			renderer.DisableShadows();
+		}
+
+		double ms{ 0.0 };
+		double gather_ms{ 0.0 };
+		double submit_ms{ 0.0 };
+		size_t main_packets{ 0 };
+		size_t reflection_packets{ 0 };
+		size_t shadow_packets{ 0 };
+		// The first frame creates the targets of the passes and is not measured
+		for (size_t frame = 0; frame <= options.frames; frame++) {
+			// The camera turns a little every frame, so no pass can be reused as it is
+			const float angle = float(frame) * 0.01F;
+			const math::Float3 position = { grid_size / 2.0F, 3.0F, grid_size / 2.0F };
+			input.users = { { position, { std::cos(angle), -0.3F, std::sin(angle) } } };
+			const Stopwatch stopwatch;
+			if (FAILED(renderer.Process(input))) {
+				return 1;
+			}
+			if (frame == 0) {
+				continue;
+			}
+			const auto& stats = renderer.GetFrameStats();
+			ms += stopwatch.GetMs();
+			gather_ms += stats.gather_ms;
+			submit_ms += stats.submit_ms;
+			main_packets += stats.main_draw_packets;
+			reflection_packets += stats.reflection_draw_packets;
+			shadow_packets += stats.shadow_draw_packets;
+		}
+
+		const auto frames = double(options.frames);
+		const char* names[] = { "main", "+reflection", "+shadows" };
+		std::printf(
+			"%12s %10.2f %10.2f %10.2f %10.0f %12.0f %10.0f\n", names[size_t(passes)],
+			ms / frames, gather_ms / frames, submit_ms / frames, double(main_packets) / frames,
+			double(reflection_packets) / frames, double(shadow_packets) / frames
+		);
+	}
+	renderer.Shutdown();
+	return 0;
+}
+
+
+void PassesBench::PrintUsage()
+{
+	std::printf(
+		"passes [options]\n"
+		"  --objects <count>         objects on the grid (default 20000)\n"
+		"  --frames <count>          measured frames per row (default 100)\n"
+	);
+}
+
+
+auto PassesBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--objects" && has_value) {
+			if (!ParseCount(args[++i], options.objects)) {
+				return false;
+			}
+		}
+		else if (arg == "--frames" && has_value) {
+			if (!ParseCount(args[++i], options.frames)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
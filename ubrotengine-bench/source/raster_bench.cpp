@@ -0,0 +1,284 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: raster_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/raster_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/image_encoder.h"
+#include "header/renderer.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+// Leaves a gap between the spheres of the grid, which are 2 m apart
+constexpr float SPHERE_RADIUS = 0.9F;
+// The close up shows the spheres of one 2x2 block
+constexpr size_t CLOSE_UP_OBJECTS = 4;
+
+enum class Scene : uint8_t
+{
+	Overview = 0,
+	Street,
+	CloseUp,
+	NUMBER
+};
+
+const char* const SCENE_NAMES[] = { "overview", "street", "closeup" };
+
+/**
+ * Returns a UV sphere as OBJ text, with texture coordinates and normals. The poles are fans,
+ * so no triangle is degenerate.
+ */
+auto MakeSphereObj(size_t segments) -> std::string
+{
+	constexpr float PI = 3.14159265F;
+	const size_t rings = segments / 2 + 1;
+	std::string text = "# sphere\n";
+	char line[128];
+	for (size_t r = 0; r <= rings; r++) {
+		const float theta = PI * float(r) / float(rings);
+		for (size_t s = 0; s <= segments; s++) {
+			const float phi = 2.0F * PI * float(s) / float(segments);
+			const float normal[3] = {
+				std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)
+			};
+			std::snprintf(
+				line, sizeof(line), "v %.5f %.5f %.5f\nvt %.5f %.5f\nvn %.5f %.5f %.5f\n",
+				normal[0] * SPHERE_RADIUS, normal[1] * SPHERE_RADIUS, normal[2] * SPHERE_RADIUS,
+				float(s) / float(segments), float(r) / float(rings), normal[0], normal[1],
+				normal[2]
+			);
+			text += line;
+		}
+	}
+
+	// Counter-clockwise seen from outside, like the faces of the other models
+	const auto add_triangle = [&](size_t a, size_t b, size_t c) {
+		std::snprintf(
+			line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, c,
+			c, c
+		);
+		text += line;
+	};
+	for (size_t r = 0; r < rings; r++) {
+		for (size_t s = 0; s < segments; s++) {
+			// OBJ indices start at 1
+			const size_t a = r * (segments + 1) + s + 1;
+			const size_t b = a + segments + 1;
+			if (r + 1 < rings) {
+				add_triangle(a, b + 1, b);
+			}
+			if (r > 0) {
+				add_triangle(a, a + 1, b + 1);
+			}
+		}
+	}
+	return text;
+}
+
+/**
+ * Places the camera of \p scene on a grid of side length \p grid_size.
+ */
+auto GetUser(Scene scene, float grid_size) -> graphics::SceneInput::User
+{
+	const float center = grid_size / 2.0F;
+	switch (scene) {
+		case Scene::Overview:
+			// In front of the grid, looking down at its middle
+			return { { center, grid_size * 0.6F, -grid_size * 0.3F }, { 0.0F, -0.6F, 0.8F } };
+		case Scene::Street:
+			// Between two rows in the middle, looking a little across them
+			return {
+				{ std::floor(center / 2.0F) * 2.0F + 1.0F, 1.2F, 1.0F }, { 0.3F, -0.2F, 1.0F }
+			};
+		default:
+			return { { 1.0F, 0.8F, -1.6F }, { 0.0F, -0.3F, 1.0F } };
+	}
+}
+
+/**
+ * Totals of the measured frames, divided by the frame count when printed.
+ */
+struct Totals
+{
+	double ms{ 0.0 };
+	double setup_ms{ 0.0 };
+	double raster_ms{ 0.0 };
+	size_t triangles{ 0 };
+	size_t visible_triangles{ 0 };
+	size_t bin_entries{ 0 };
+};
+
+} // namespace
+
+
+auto RasterBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	// The model is read from a file, like the models of a game
+	const auto directory = fs::temp_directory_path() / "ubrotengine_raster_bench";
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+	const auto model_file = (directory / "sphere.obj").string();
+	{
+		std::ofstream file(model_file, std::ios::binary | std::ios::trunc);
+		file << MakeSphereObj(options.segments);
+	}
+
+	graphics::GraphicSettings settings;
+	settings.window_width = uint32_t(options.width);
+	settings.window_height = uint32_t(options.height);
+	// The overview sees the whole grid
+	settings.screen_depth = 1000.0F;
+	settings.render_backend = graphics::RenderBackend::Software;
+	graphics::Renderer renderer;
+	if (FAILED(renderer.Initialize(nullptr, settings))) {
+		std::printf("the renderer can not be initialized\n");
+		return 1;
+	}
+	renderer.DisableShadows();
+	renderer.DisableReflection();
+	const auto sphere = renderer.RegisterModel(model_file);
+
+	std::printf(
+		"%zu spheres of %zu segments at %zux%zu, average of %zu frames\n", options.objects,
+		options.segments, options.width, options.height, options.frames
+	);
+	std::printf(
+		"%10s %12s %12s %10s %10s %10s %10s %10s\n", "scene", "triangles", "visible", "bins",
+		"ms", "setup ms", "raster ms", "Mtri/s"
+	);
+	for (uint8_t index = 0; index < uint8_t(Scene::NUMBER); index++) {
+		const auto scene = Scene(index);
+		graphics::SceneInput input;
+		const auto objects = scene == Scene::CloseUp ? CLOSE_UP_OBJECTS : options.objects;
+		const float grid_size = MakeObjectGrid(objects, { uint32_t(sphere) }, 49, input);
+		input.users = { GetUser(scene, grid_size) };
+
+		Totals totals;
+		// The first frame creates the buffers and is not measured
+		for (size_t frame = 0; frame <= options.frames; frame++) {
+			Stopwatch stopwatch;
+			if (FAILED(renderer.Process(input))) {
+				return 1;
+			}
+			if (frame == 0) {
+				continue;
+			}
+			const auto& stats = renderer.GetFrameStats();
+			totals.ms += stopwatch.GetMs();
+			totals.setup_ms += stats.software_setup_ms;
+			totals.raster_ms += stats.software_raster_ms;
+			totals.triangles += stats.software_triangles;
+			totals.visible_triangles += stats.software_visible_triangles;
+			totals.bin_entries += stats.software_bin_entries;
+		}
+
+		// Triangles per second of the rasterizer, from the setup and raster time together
+		const auto frames = double(options.frames);
+		const auto raster_ms = totals.setup_ms + totals.raster_ms;
+		std::printf(
+			"%10s %12.0f %12.0f %10.0f %10.2f %10.2f %10.2f %10.2f\n", SCENE_NAMES[index],
+			double(totals.triangles) / frames, double(totals.visible_triangles) / frames,
+			double(totals.bin_entries) / frames, totals.ms / frames, totals.setup_ms / frames,
+			totals.raster_ms / frames,
+			raster_ms > 0.0 ? double(totals.triangles) / raster_ms / 1000.0 : 0.0
+		);
+
+		if (!options.save_directory.empty()) {
+			io::Image image;
+			const auto filename = std::string("raster_") + SCENE_NAMES[index] + ".png";
+			const auto path = (fs::path(options.save_directory) / filename).string();
+			if (!renderer.GetSoftwareFrame(image) || !io::ImageEncoder::WriteFile(path, image)) {
+				std::printf("%s can not be written\n", path.c_str());
+				return 1;
+			}
+		}
+	}
+	renderer.Shutdown();
+
+	std::error_code error;
+	fs::remove_all(directory, error);
+	return 0;
+}
+
+
+void RasterBench::PrintUsage()
+{
+	std::printf(
+		"raster [options]\n"
+		"  --objects <count>         spheres on the grid (default 1000)\n"
+		"  --segments <count>        segments around every sphere (default 64)\n"
+		"  --frames <count>          measured frames per scene (default 10)\n"
+		"  --width <pixels>          width of the frame (default 1920)\n"
+		"  --height <pixels>         height of the frame (default 1080)\n"
+		"  --save <directory>        writes the last frame of every scene as PNG\n"
+	);
+}
+
+
+auto RasterBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--objects" && has_value) {
+			if (!ParseCount(args[++i], options.objects)) {
+				return false;
+			}
+		}
+		else if (arg == "--segments" && has_value) {
+			if (!ParseCount(args[++i], options.segments) || options.segments < 3) {
+				return false;
+			}
+		}
+		else if (arg == "--frames" && has_value) {
+			if (!ParseCount(args[++i], options.frames)) {
+				return false;
+			}
+		}
+		else if (arg == "--width" && has_value) {
+			if (!ParseCount(args[++i], options.width)) {
+				return false;
+			}
+		}
+		else if (arg == "--height" && has_value) {
+			if (!ParseCount(args[++i], options.height)) {
+				return false;
+			}
+		}
+		else if (arg == "--save" && has_value) {
+			options.save_directory = args[++i];
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
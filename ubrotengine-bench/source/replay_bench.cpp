@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: replay_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/replay_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/command_buffer.h"
+#include "header/command_hash.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+constexpr std::array<const char*, size_t(graphics::RenderBackend::NUMBER)> BACKEND_NAMES = {
+	"d3d11", "null", "recording", "software"
+};
+
+/**
+ * Strings and values every type of setup record needs at least, see CaptureHeader.
+ */
+struct Arguments
+{
+	size_t strings;
+	size_t values;
+};
+constexpr std::array<Arguments, size_t(graphics::CaptureRecordType::NUMBER)> SETUP_ARGUMENTS = {
+	Arguments{ 1, 0 }, Arguments{ 1, 0 }, Arguments{ 1, 0 }, Arguments{ 0, 1 },
+	Arguments{ 1, 1 }, Arguments{ 0, 0 }, Arguments{ 0, 1 }, Arguments{ 0, 2 },
+	Arguments{ 0, 0 }
+};
+
+/**
+ * Places the camera of a recorded frame, it walks along the middle of the grid at eye level
+ * and slowly looks around.
+ */
+auto GetUser(size_t frame, float grid_size) -> graphics::SceneInput::User
+{
+	const float angle = 0.05F * float(frame);
+	return {
+		{ grid_size / 2.0F + 1.0F, 1.7F, -4.0F + 0.5F * float(frame) },
+		{ std::sin(angle), -0.1F, std::cos(angle) }
+	};
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: FrameLog
+/// Prints the timings and the command hash of every frame as CSV and adds them up for the
+/// summary. The summary hash covers the commands of all frames in their order.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class FrameLog
+{
+
+public:
+	explicit FrameLog(bool summary) : m_summary(summary)
+	{
+		if (!m_summary) {
+			std::printf(
+				"loop,frame,gather_ms,submit_ms,record_ms,replay_ms,frame_ms,draw_packets,"
+				"visible_objects,commands\n"
+			);
+		}
+	}
+
+	void Add(size_t loop, size_t frame, double frame_ms, const graphics::Renderer& renderer)
+	{
+		// Only the recording backend keeps the commands
+		graphics::CommandHash hash;
+		renderer.GetRecordedCommands().Replay(hash);
+		renderer.GetRecordedCommands().Replay(m_hash);
+
+		const auto& stats = renderer.GetFrameStats();
+		m_frames++;
+		m_frame_ms += frame_ms;
+		m_slowest_ms = std::max(m_slowest_ms, frame_ms);
+		m_gather_ms += stats.gather_ms;
+		m_submit_ms += stats.submit_ms;
+		m_record_ms += stats.record_ms;
+		m_replay_ms += stats.replay_ms;
+		if (!m_summary) {
+			std::printf(
+				"%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%zu,%zu,%016llx\n", loop, frame,
+				stats.gather_ms, stats.submit_ms, stats.record_ms, stats.replay_ms, frame_ms,
+				stats.draw_packets, stats.visible_objects,
+				static_cast<unsigned long long>(hash.GetHash())
+			);
+		}
+	}
+
+	void Print(const std::string& capture) const
+	{
+		const auto frames = double(std::max<size_t>(m_frames, 1));
+		std::fprintf(
+			m_summary ? stdout : stderr,
+			"%s: %zu frames, %.3f ms per frame (gather %.3f, submit %.3f, record %.3f, "
+			"replay %.3f), slowest %.3f ms, commands %016llx\n",
+			capture.c_str(), m_frames, m_frame_ms / frames, m_gather_ms / frames,
+			m_submit_ms / frames, m_record_ms / frames, m_replay_ms / frames, m_slowest_ms,
+			static_cast<unsigned long long>(m_hash.GetHash())
+		);
+	}
+
+private:
+	bool m_summary;
+	graphics::CommandHash m_hash{};
+	size_t m_frames{ 0 };
+	double m_frame_ms{ 0.0 };
+	double m_slowest_ms{ 0.0 };
+	double m_gather_ms{ 0.0 };
+	double m_submit_ms{ 0.0 };
+	double m_record_ms{ 0.0 };
+	double m_replay_ms{ 0.0 };
+};
+
+} // namespace
+
+
+auto ReplayBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+	if (options.record_frames > 0) {
+		return Record(options);
+	}
+
+	graphics::CaptureReader reader;
+	if (!reader.Open(options.capture)) {
+		std::fprintf(stderr, "Could not read %s\n", options.capture.c_str());
+		return 1;
+	}
+
+	graphics::Renderer renderer;
+	bool initialized{ false };
+	graphics::CaptureEntry entry;
+	FrameLog log(options.summary);
+	for (size_t loop = 0; loop < options.loops; loop++) {
+		reader.Rewind();
+		size_t frame{ 0 };
+		while (reader.Next(entry)) {
+			if (entry.type != graphics::CaptureRecordType::Frame) {
+				// The assets of the first loop are still registered
+				if (loop == 0 && !ApplySetup(entry, options, renderer, initialized)) {
+					return 1;
+				}
+				continue;
+			}
+			if (!initialized) {
+				std::fprintf(stderr, "%s starts without settings\n", options.capture.c_str());
+				return 1;
+			}
+
+			const Stopwatch stopwatch;
+			if (FAILED(renderer.Process(entry.frame))) {
+				return 1;
+			}
+			log.Add(loop, frame, stopwatch.GetMs(), renderer);
+			frame++;
+		}
+		if (!reader.AtEnd()) {
+			std::fprintf(
+				stderr, "%s is corrupt after %zu frames\n", options.capture.c_str(), frame
+			);
+			return 1;
+		}
+	}
+	log.Print(options.capture);
+
+	if (initialized) {
+		renderer.Shutdown();
+	}
+	return 0;
+}
+
+
+void ReplayBench::PrintUsage()
+{
+	std::printf(
+		"replay <capture> [options]\n"
+		"  --backend null|recording|software\n"
+		"                            backend to render with (default the captured one)\n"
+		"  --loops <count>           render the frames this many times (default 1)\n"
+		"  --summary                 only print the averages\n"
+		"  --record <frames>         writes a capture of a walk through a grid instead\n"
+		"  --objects <count>         objects on the grid of --record (default 2000)\n"
+	);
+}
+
+
+auto ReplayBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	std::vector<std::string> positional;
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--backend" && has_value) {
+			const auto& value = args[++i];
+			const auto it = std::find(BACKEND_NAMES.begin(), BACKEND_NAMES.end(), value);
+			// Direct3D needs a window, the replay command of the tools has one
+			if (it == BACKEND_NAMES.end() || it == BACKEND_NAMES.begin()) {
+				return false;
+			}
+			options.override_backend = true;
+			options.backend = graphics::RenderBackend(it - BACKEND_NAMES.begin());
+		}
+		else if (arg == "--loops" && has_value) {
+			if (!ParseCount(args[++i], options.loops)) {
+				return false;
+			}
+		}
+		else if (arg == "--summary") {
+			options.summary = true;
+		}
+		else if (arg == "--record" && has_value) {
+			if (!ParseCount(args[++i], options.record_frames)) {
+				return false;
+			}
+		}
+		else if (arg == "--objects" && has_value) {
+			if (!ParseCount(args[++i], options.objects)) {
+				return false;
+			}
+		}
+		else if (arg.rfind("--", 0) == 0) {
+			return false;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() != 1) {
+		return false;
+	}
+	options.capture = positional[0];
+	return true;
+}
+
+
+auto ReplayBench::Record(const Options& options) -> int
+{
+	// The setup records are written in the order the renderer gets them, like the engine does
+	graphics::CaptureWriter writer;
+	graphics::GraphicSettings settings;
+	settings.window_width = 1280;
+	settings.window_height = 720;
+	settings.render_backend = graphics::RenderBackend::Recording;
+	writer.AddSettings(settings);
+	graphics::Renderer renderer;
+	if (FAILED(renderer.Initialize(nullptr, settings))) {
+		std::fprintf(stderr, "Could not initialize the renderer\n");
+		return 1;
+	}
+	renderer.SetDeterministic(true);
+
+	std::vector<uint32_t> models;
+	for (const auto model : { assets::Procedural::Cube, assets::Procedural::Sphere }) {
+		writer.AddProceduralModel(uint8_t(model));
+		models.push_back(uint32_t(renderer.RegisterModelProcedural(model)));
+	}
+	if (!writer.Open(options.capture)) {
+		std::fprintf(stderr, "Could not write %s\n", options.capture.c_str());
+		return 1;
+	}
+
+	graphics::SceneInput input;
+	const float grid_size = MakeObjectGrid(options.objects, models, 50, input);
+	FrameLog log(options.summary);
+	for (size_t frame = 0; frame < options.record_frames; frame++) {
+		input.users = { GetUser(frame, grid_size) };
+		const Stopwatch stopwatch;
+		if (FAILED(renderer.Process(input))) {
+			return 1;
+		}
+		const auto frame_ms = stopwatch.GetMs();
+		if (!writer.AddFrame(input)) {
+			std::fprintf(stderr, "Could not write %s\n", options.capture.c_str());
+			return 1;
+		}
+		log.Add(0, frame, frame_ms, renderer);
+	}
+	writer.Close();
+	log.Print(options.capture);
+
+	renderer.Shutdown();
+	return 0;
+}
+
+
+auto ReplayBench::ApplySetup(
+	const graphics::CaptureEntry& entry, const Options& options, graphics::Renderer& renderer,
+	bool& initialized
+) -> bool
+{
+	using graphics::CaptureRecordType;
+
+	const auto& strings = entry.strings;
+	const auto& values = entry.values;
+	const auto& arguments = SETUP_ARGUMENTS[size_t(entry.type)];
+	if (strings.size() < arguments.strings || values.size() < arguments.values) {
+		std::fprintf(stderr, "Setup record %u misses arguments\n", uint32_t(entry.type));
+		return false;
+	}
+	// Every other call needs the renderer
+	if (!initialized && entry.type != CaptureRecordType::Settings) {
+		std::fprintf(stderr, "Setup record %u comes before the settings\n", uint32_t(entry.type));
+		return false;
+	}
+
+	switch (entry.type)
+	{
+		case CaptureRecordType::Settings: {
+			graphics::GraphicSettings settings;
+			std::istringstream text(strings[0]);
+			text >> settings;
+			settings.fullscreen = FALSE;
+			if (options.override_backend) {
+				settings.render_backend = options.backend;
+			}
+			if (settings.render_backend == graphics::RenderBackend::D3D11) {
+				std::fprintf(stderr, "The capture draws with Direct3D, pick a --backend\n");
+				return false;
+			}
+			if (initialized) {
+				return SUCCEEDED(renderer.Refresh(settings));
+			}
+			if (FAILED(renderer.Initialize(nullptr, settings))) {
+				std::fprintf(stderr, "Could not initialize the renderer\n");
+				return false;
+			}
+			renderer.SetDeterministic(true);
+			initialized = true;
+			return true;
+		}
+		case CaptureRecordType::MountArchive:
+			renderer.MountArchive(strings[0]);
+			return true;
+		case CaptureRecordType::Model:
+			renderer.RegisterModel(strings[0]);
+			return true;
+		case CaptureRecordType::ProceduralModel:
+			if (values[0] >= uint32_t(assets::Procedural::NUMBER)) {
+				std::fprintf(stderr, "Procedural model %u does not exist\n", values[0]);
+				return false;
+			}
+			renderer.RegisterModelProcedural(assets::Procedural(values[0]));
+			return true;
+		case CaptureRecordType::Texture:
+			renderer.RegisterTexture(strings[0], uint8_t(values[0]));
+			return true;
+		case CaptureRecordType::Models:
+			renderer.RegisterModels(strings);
+			return true;
+		case CaptureRecordType::Textures:
+			renderer.RegisterTextures(strings, uint8_t(values[0]));
+			return true;
+		case CaptureRecordType::ModelTexture:
+			renderer.SetModelTexture(size_t(values[0]), size_t(values[1]));
+			return true;
+		default:
+			return true;
+	}
+}
+
+} // namespace bench
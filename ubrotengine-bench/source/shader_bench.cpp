@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shader_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/null_render_device.h"
+#include "header/shader_manager.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+// Frames are paced to 60 Hz, so background compiles can finish while frames are played
+constexpr double FRAME_MS = 1000.0 / 60.0;
+
+using graphics::ShaderManager;
+
+/**
+ * Compiles nothing, it waits like a compiler would and returns the preprocessed text as
+ * bytecode, so every variant gets bytecode of its own.
+ */
+class StandInCompiler
+{
+
+public:
+	explicit StandInCompiler(size_t compile_ms) :
+		m_compile_ms(compile_ms)
+	{
+	}
+
+	auto operator()(
+		const graphics::ShaderCompileDesc& desc, const std::string& source,
+		graphics::ShaderCompileOutput& output
+	) -> HRESULT
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(m_compile_ms));
+		std::string text = desc.entry_point + " " + desc.target;
+		for (const auto& define : desc.defines) {
+			text += " " + define.name + "=" + define.value;
+		}
+		text += "\n" + source;
+		output.bytecode.assign(text.begin(), text.end());
+		compiles++;
+		return S_OK;
+	}
+
+	std::atomic<size_t> compiles{ 0 };
+
+private:
+	size_t m_compile_ms;
+};
+
+/**
+ * Every program of the manifest with every combination of its features.
+ */
+auto GetAllVariants() -> std::vector<std::tuple<graphics::ShaderProg, graphics::FeatureMask>>
+{
+	std::vector<std::tuple<graphics::ShaderProg, graphics::FeatureMask>> variants;
+	for (const auto& entry : graphics::SHADER_MANIFEST) {
+		graphics::FeatureMask mask{ 0 };
+		do {
+			variants.emplace_back(entry.program, mask);
+			mask = (mask - entry.features) & entry.features;
+		} while (mask != 0);
+	}
+	return variants;
+}
+
+} // namespace
+
+
+auto ShaderBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+	if (options.threads.empty()) {
+		options.threads = { 1, 8 };
+	}
+
+	// The manager reads the shaders and keeps its cache relative to the working directory
+	const auto directory = fs::temp_directory_path() / "ubrotengine_shader_bench";
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+	fs::copy(UBROTENGINE_SHADER_SOURCE, directory / "shader", fs::copy_options::recursive);
+	const auto previous_directory = fs::current_path();
+	fs::current_path(directory);
+
+	StandInCompiler compiler(options.compile_ms);
+	const auto make_manager = [&](size_t threads) {
+		return std::make_unique<ShaderManager>(
+			[&](const auto& desc, const auto& source, auto& output) {
+				return compiler(desc, source, output);
+			},
+			threads
+		);
+	};
+	bool success = true;
+
+	std::printf("stand-in compiler with %zu ms per stage\n", options.compile_ms);
+	// The default programs share their files, only their variants with features differ
+	const auto variants = GetAllVariants();
+	std::printf(
+		"%8s %8s %10s %12s %12s\n", "threads", "cache", "compiles", "startup ms",
+		"all ms"
+	);
+	for (const auto threads : options.threads) {
+		fs::remove_all(graphics::ShaderCache::DEFAULT_DIRECTORY);
+		for (const bool filled : { false, true }) {
+			graphics::NullRenderDevice device(true);
+			auto manager = make_manager(threads);
+			const size_t compiles = compiler.compiles;
+			success = SUCCEEDED(manager->Initialize(device, nullptr)) && success;
+
+			// Every variant up front, as if all of them were on the precompile list
+			const Stopwatch stopwatch;
+			for (const auto& [program, features] : variants) {
+				manager->PrecompileVariant(program, features);
+			}
+			success = SUCCEEDED(manager->WaitForVariants()) && success;
+			const auto all_ms = manager->GetVariantStats().startup_ms + stopwatch.GetMs();
+
+			std::printf(
+				"%8zu %8s %10zu %12.1f %12.1f\n", threads, filled ? "filled" : "empty",
+				compiler.compiles - compiles, manager->GetVariantStats().startup_ms, all_ms
+			);
+			manager->Shutdown();
+		}
+	}
+
+	// All variants are drawn from the first frame on, those that are not precompiled are
+	// compiled on their first use
+	const auto threads = options.threads.back();
+	std::printf(
+		"\n%zu frames drawing all %zu variants, %zu compile threads\n", options.frames,
+		variants.size(), threads
+	);
+	std::printf(
+		"%10s %10s %10s %10s %10s %10s\n", "compile", "ready at", "max ms", "hitches",
+		"fallback", "skipped"
+	);
+	for (const bool blocking : { false, true }) {
+		fs::remove_all(graphics::ShaderCache::DEFAULT_DIRECTORY);
+		graphics::NullRenderDevice device(true);
+		auto manager = make_manager(threads);
+		success = SUCCEEDED(manager->Initialize(device, nullptr)) && success;
+
+		double max_ms{ 0.0 };
+		size_t hitches{ 0 };
+		size_t ready_frame{ options.frames };
+		for (size_t frame = 0; frame < options.frames; frame++) {
+			const Stopwatch stopwatch;
+			success = SUCCEEDED(manager->Update()) && success;
+			size_t ready{ 0 };
+			for (const auto& [program, features] : variants) {
+				if (blocking) {
+					// Like the compile on the render thread before the background compiles
+					manager->PrecompileVariant(program, features);
+					success = SUCCEEDED(manager->WaitForVariants()) && success;
+				}
+				// The program without features has the index of its ShaderProg value
+				const auto idx = manager->GetVariant(program, features);
+				const bool fallback = features != 0 && idx == size_t(program);
+				ready += idx != ShaderManager::NO_PROGRAM && !fallback ? 1 : 0;
+			}
+			const auto ms = stopwatch.GetMs();
+			max_ms = std::max(max_ms, ms);
+			hitches += ms > ShaderManager::HITCH_MS ? 1 : 0;
+			if (ready == variants.size() && ready_frame == options.frames) {
+				ready_frame = frame;
+			}
+			if (ms < FRAME_MS) {
+				std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(
+					FRAME_MS - ms
+				));
+			}
+		}
+
+		const auto stats = manager->GetVariantStats();
+		std::printf(
+			"%10s %10zu %10.1f %10zu %10zu %10zu\n", blocking ? "blocking" : "background",
+			ready_frame, max_ms, hitches, stats.fallback_draws, stats.skipped_draws
+		);
+		manager->Shutdown();
+	}
+
+	fs::current_path(previous_directory);
+	std::error_code error;
+	fs::remove_all(directory, error);
+	return success ? 0 : 1;
+}
+
+
+void ShaderBench::PrintUsage()
+{
+	std::printf(
+		"shaders [options]\n"
+		"  --compile-ms <ms>         time the stand-in compiler takes per stage (default 30)\n"
+		"  --threads <count>         compile threads, repeatable (default 1 and 8)\n"
+		"  --frames <count>          frames that draw all variants (default 120)\n"
+	);
+}
+
+
+auto ShaderBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--compile-ms" && has_value) {
+			if (!ParseCount(args[++i], options.compile_ms)) {
+				return false;
+			}
+		}
+		else if (arg == "--threads" && has_value) {
+			size_t threads{ 0 };
+			if (!ParseCount(args[++i], threads)) {
+				return false;
+			}
+			options.threads.push_back(threads);
+		}
+		else if (arg == "--frames" && has_value) {
+			if (!ParseCount(args[++i], options.frames)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
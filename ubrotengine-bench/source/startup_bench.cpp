@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: startup_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/startup_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/asset_archive.h"
+#include "header/asset_manager.h"
+#include "header/image_encoder.h"
+#include "header/null_render_device.h"
+#include "header/thread_pool.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/**
+ * Returns a box with random proportions as OBJ text, with texture coordinates and normals.
+ */
+auto MakeBoxObj(std::mt19937& random) -> std::string
+{
+	std::uniform_real_distribution<float> extent(0.5F, 2.0F);
+	const float size[3] = { extent(random), extent(random), extent(random) };
+	std::string text = "# box\n";
+	char line[96];
+	for (int corner = 0; corner < 8; corner++) {
+		std::snprintf(
+			line, sizeof(line), "v %.4f %.4f %.4f\n", (corner & 1 ? 0.5F : -0.5F) * size[0],
+			(corner & 2 ? 0.5F : -0.5F) * size[1], (corner & 4 ? 0.5F : -0.5F) * size[2]
+		);
+		text += line;
+	}
+	text += "vt 0.0 0.0\nvt 1.0 0.0\nvt 1.0 1.0\nvt 0.0 1.0\n";
+	text += "vn -1 0 0\nvn 1 0 0\nvn 0 -1 0\nvn 0 1 0\nvn 0 0 -1\nvn 0 0 1\n";
+
+	// Corners of every face in counter-clockwise order, seen from outside
+	const int faces[6][4] = {
+		{ 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 },
+		{ 2, 6, 7, 3 }, { 0, 2, 3, 1 }, { 4, 5, 7, 6 },
+	};
+	// Every face is split into two triangles along the diagonal
+	const int TRIANGLES[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+	for (int face = 0; face < 6; face++) {
+		const auto* c = faces[face];
+		for (const auto& tri : TRIANGLES) {
+			std::snprintf(
+				line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\n",
+				c[tri[0]] + 1, tri[0] + 1, face + 1, c[tri[1]] + 1, tri[1] + 1, face + 1,
+				c[tri[2]] + 1, tri[2] + 1, face + 1
+			);
+			text += line;
+		}
+	}
+	return text;
+}
+
+auto WriteFile(const std::string& filename, const void* data, size_t size) -> bool
+{
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	file.write(static_cast<const char*>(data), std::streamsize(size));
+	return file.good();
+}
+
+} // namespace
+
+
+auto StartupBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	utils::ThreadPool thread_pool(options.threads > 1 ? options.threads - 1 : 0);
+	const size_t threads = options.threads == 1 ? 1 : thread_pool.GetThreadCount();
+	auto* pool = threads > 1 ? &thread_pool : nullptr;
+
+	// Archives store lower case paths, the loose files have the same names
+	const auto directory = fs::temp_directory_path() / "ubrotengine_startup_bench";
+	fs::remove_all(directory);
+	fs::create_directories(directory / "models");
+	fs::create_directories(directory / "textures");
+	const auto archive_name = (directory / "assets.pak").string();
+
+	io::ArchiveWriter writer(pool);
+	if (!writer.Open(archive_name)) {
+		std::printf("can not write %s\n", archive_name.c_str());
+		return 1;
+	}
+	std::mt19937 random(37);
+	std::vector<std::string> models;
+	std::vector<std::string> textures;
+	size_t loose_bytes{ 0 };
+	for (size_t i = 0; i < options.assets; i++) {
+		const bool model = i % 2 == 0;
+		char name[32];
+		std::snprintf(name, sizeof(name), model ? "%06zu.obj" : "%06zu.png", i);
+		const auto filename = (directory / (model ? "models" : "textures") / name).string();
+
+		std::vector<uint8_t> content;
+		if (model) {
+			const auto text = MakeBoxObj(random);
+			content.assign(text.begin(), text.end());
+			models.push_back(filename);
+		}
+		else {
+			content = io::ImageEncoder::EncodePng(MakeTestImage(32, 32, uint32_t(i)));
+			textures.push_back(filename);
+		}
+		if (!WriteFile(filename, content.data(), content.size())
+			|| !writer.Add(filename, content.data(), content.size())) {
+			std::printf("can not write %s\n", filename.c_str());
+			return 1;
+		}
+		loose_bytes += content.size();
+	}
+	if (!writer.Finish()) {
+		std::printf("can not write %s\n", archive_name.c_str());
+		return 1;
+	}
+	const auto archive_stats = writer.GetStats();
+
+	std::printf(
+		"%zu models and %zu textures, %.1f MB as files, %.1f MB in %zu archive blocks, "
+		"%zu threads, best of %zu runs\n", models.size(), textures.size(),
+		double(loose_bytes) / 1e6, double(archive_stats.archive_bytes) / 1e6,
+		archive_stats.blocks, threads, options.repeat
+	);
+	std::printf("%8s %8s %10s %10s %10s\n", "source", "work", "ms", "files/s", "MB/s");
+	const auto print_row = [&](bool archive, const char* work, double ms) {
+		std::printf(
+			"%8s %8s %10.1f %10.0f %10.1f\n", archive ? "archive" : "files", work, ms,
+			double(options.assets) / (ms / 1000.0), double(loose_bytes) / 1e6 / (ms / 1000.0)
+		);
+	};
+
+	// Only getting the bytes of every file, on the calling thread
+	std::vector<std::string> filenames = models;
+	filenames.insert(filenames.end(), textures.begin(), textures.end());
+	for (const bool archive : { false, true }) {
+		size_t read_bytes{ 0 };
+		const auto ms = MeasureBestMs(options.repeat, [&]() {
+			io::AssetArchive asset_archive;
+			if (archive && !asset_archive.Open(archive_name)) {
+				return;
+			}
+			read_bytes = 0;
+			std::vector<uint8_t> buffer;
+			for (const auto& filename : filenames) {
+				if (archive) {
+					const uint8_t* data{ nullptr };
+					size_t size{ 0 };
+					read_bytes += asset_archive.Read(filename, buffer, data, size) ? size : 0;
+					continue;
+				}
+				std::ifstream file(filename, std::ios::binary | std::ios::ate);
+				buffer.resize(size_t(file.tellg()));
+				file.seekg(0);
+				file.read(reinterpret_cast<char*>(buffer.data()), std::streamsize(buffer.size()));
+				read_bytes += file.good() ? buffer.size() : 0;
+			}
+		});
+		if (read_bytes != loose_bytes) {
+			std::printf("%8s only %zu bytes read\n", archive ? "archive" : "files", read_bytes);
+			return 1;
+		}
+		print_row(archive, "read", ms);
+	}
+
+	// Parsing, decoding, mip generation and packing on the pool, like the engine starts
+	for (const bool archive : { false, true }) {
+		size_t loaded{ 0 };
+		const auto ms = MeasureBestMs(options.repeat, [&]() {
+			graphics::NullRenderDevice device;
+			assets::AssetManager asset_manager(pool);
+			if (archive && !asset_manager.MountArchive(archive_name)) {
+				return;
+			}
+			const auto model_indices = asset_manager.AddModels(device, models);
+			asset_manager.AddTextures(textures, 4);
+			if (FAILED(asset_manager.PackTextures(device))) {
+				return;
+			}
+			loaded = 0;
+			for (const auto idx : model_indices) {
+				loaded += idx != assets::AssetManager::NO_MODEL ? 1 : 0;
+			}
+			loaded += asset_manager.GetTextureStats().textures;
+		});
+		if (loaded != options.assets) {
+			std::printf("%8s only %zu files loaded\n", archive ? "archive" : "files", loaded);
+			return 1;
+		}
+		print_row(archive, "load", ms);
+	}
+
+	std::error_code error;
+	fs::remove_all(directory, error);
+	return 0;
+}
+
+
+void StartupBench::PrintUsage()
+{
+	std::printf(
+		"startup [options]\n"
+		"  --assets <count>          small files, half models and half textures\n"
+		"                            (default 10000)\n"
+		"  --threads <count>         threads of the pool (default all)\n"
+		"  --repeat <count>          runs per measurement, the fastest counts (default 3)\n"
+	);
+}
+
+
+auto StartupBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--assets" && has_value) {
+			if (!ParseCount(args[++i], options.assets)) {
+				return false;
+			}
+		}
+		else if (arg == "--threads" && has_value) {
+			if (!ParseCount(args[++i], options.threads)) {
+				return false;
+			}
+		}
+		else if (arg == "--repeat" && has_value) {
+			if (!ParseCount(args[++i], options.repeat)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: stream_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/stream_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <utility>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/mip_streamer.h"
+#include "header/texture_streamer.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+constexpr size_t MB = 1024 * 1024;
+
+// The objects lie on a square field, the camera circles around its center
+constexpr float FIELD_SIZE = 1000.0F;
+constexpr float ORBIT_RADIUS = 300.0F;
+constexpr float FAR_PLANE = 500.0F;
+// 90 degrees field of view on a 1920 pixel wide screen
+constexpr float HALF_FOV = 0.785398F;
+constexpr float PIXELS_PER_RADIAN_DISTANCE = 960.0F;
+
+struct Object
+{
+	float x;
+	float y;
+	// Extent in meters
+	float size;
+};
+
+/**
+ * Returns the memory of every level of a BC7 texture, one byte per pixel in 4x4 blocks.
+ */
+auto GetLevelBytes(uint32_t size) -> std::vector<size_t>
+{
+	std::vector<size_t> level_bytes;
+	for (uint32_t level_size = size; ; level_size /= 2) {
+		const size_t blocks = std::max<size_t>((level_size + 3) / 4, 1);
+		level_bytes.push_back(blocks * blocks * 16);
+		if (level_size == 1) {
+			break;
+		}
+	}
+	return level_bytes;
+}
+
+} // namespace
+
+
+auto StreamBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+	if (options.budgets_mb.empty()) {
+		options.budgets_mb = { 128, 512, 2048 };
+	}
+
+	// One BC7 texture per object, the larger textures are rarer
+	const uint32_t texture_sizes[] = { 512, 1024, 1024, 2048, 2048, 4096 };
+	std::mt19937 random(36);
+	std::uniform_real_distribution<float> position(0.0F, FIELD_SIZE);
+	std::uniform_real_distribution<float> extent(2.0F, 16.0F);
+	std::vector<Object> objects(options.textures);
+	std::vector<uint32_t> sizes(options.textures);
+	std::vector<uint32_t> tail_mips(options.textures, 0);
+	size_t full_bytes{ 0 };
+	for (size_t i = 0; i < options.textures; i++) {
+		objects[i] = { position(random), position(random), extent(random) };
+		sizes[i] = texture_sizes[random() % 6];
+		while (sizes[i] >> tail_mips[i] > assets::TextureStreamer::TAIL_SIZE) {
+			tail_mips[i]++;
+		}
+		const auto level_bytes = GetLevelBytes(sizes[i]);
+		for (const auto bytes : level_bytes) {
+			full_bytes += bytes;
+		}
+	}
+
+	std::printf(
+		"%zu BC7 textures (%zu MB with all levels), %zu frames, %zu MB loads per frame, "
+		"loads take %zu frames\n", options.textures, full_bytes / MB, options.frames,
+		options.frame_load_mb, options.latency
+	);
+	std::printf(
+		"%10s %10s %10s %10s %10s %10s %10s\n", "budget MB", "us/frame", "max us", "loaded",
+		"evicted", "peak MB", "sharp"
+	);
+	for (const auto budget_mb : options.budgets_mb) {
+		assets::MipStreamer streamer;
+		streamer.SetBudget(budget_mb * MB);
+		for (size_t i = 0; i < options.textures; i++) {
+			streamer.Add(i, sizes[i], GetLevelBytes(sizes[i]), tail_mips[i]);
+		}
+
+		// Loads that finish at the given frame
+		std::deque<std::pair<size_t, size_t>> in_flight;
+		std::vector<assets::MipStreamer::Change> loads;
+		std::vector<assets::MipStreamer::Change> evictions;
+		std::vector<std::pair<size_t, float>> visible;
+		double total_us{ 0.0 };
+		double max_us{ 0.0 };
+		size_t peak_bytes{ 0 };
+		size_t requests{ 0 };
+		size_t sharp{ 0 };
+
+		for (size_t frame = 0; frame < options.frames; frame++) {
+			while (!in_flight.empty() && in_flight.front().first <= frame) {
+				streamer.Loaded(in_flight.front().second, true);
+				in_flight.pop_front();
+			}
+
+			// One orbit over all frames, looking along the orbit
+			const float angle = 6.2831853F * float(frame) / float(options.frames);
+			const float camera_x = FIELD_SIZE / 2.0F + ORBIT_RADIUS * std::cos(angle);
+			const float camera_y = FIELD_SIZE / 2.0F + ORBIT_RADIUS * std::sin(angle);
+			const float view_angle = angle + 1.5707963F;
+			visible.clear();
+			for (size_t i = 0; i < objects.size(); i++) {
+				const float dx = objects[i].x - camera_x;
+				const float dy = objects[i].y - camera_y;
+				const float distance = std::sqrt(dx * dx + dy * dy);
+				const float offset = std::remainder(std::atan2(dy, dx) - view_angle, 6.2831853F);
+				if (distance < FAR_PLANE && std::abs(offset) < HALF_FOV) {
+					const float pixels = objects[i].size * PIXELS_PER_RADIAN_DISTANCE
+						/ std::max(distance, 1.0F);
+					visible.emplace_back(i, pixels);
+				}
+			}
+
+			// The part the renderer does every frame, culling is not included
+			const Stopwatch stopwatch;
+			streamer.BeginFrame();
+			for (const auto& [texture_idx, pixels] : visible) {
+				streamer.Request(texture_idx, pixels);
+			}
+			streamer.Update(options.frame_load_mb * MB, loads, evictions);
+			const auto us = stopwatch.GetMs() * 1000.0;
+			total_us += us;
+			max_us = std::max(max_us, us);
+
+			for (const auto& load : loads) {
+				in_flight.emplace_back(frame + options.latency, load.texture_idx);
+			}
+			const auto stats = streamer.GetStats();
+			peak_bytes = std::max(peak_bytes, stats.resident_bytes + stats.pending_bytes);
+
+			for (const auto& [texture_idx, pixels] : visible) {
+				const auto desired = assets::MipStreamer::GetDesiredMip(
+					sizes[texture_idx], tail_mips[texture_idx], pixels
+				);
+				// Textures that only need their tail are always sharp
+				if (desired < tail_mips[texture_idx]) {
+					sharp += streamer.GetResidentMip(texture_idx) <= desired ? 1 : 0;
+					requests++;
+				}
+			}
+		}
+
+		const auto stats = streamer.GetStats();
+		std::printf(
+			"%10zu %10.1f %10.1f %10zu %10zu %10zu %9.1f%%\n", budget_mb,
+			total_us / double(std::max<size_t>(options.frames, 1)), max_us, stats.loaded_mips,
+			stats.evicted_mips, peak_bytes / MB,
+			100.0 * double(sharp) / double(std::max<size_t>(requests, 1))
+		);
+	}
+	return 0;
+}
+
+
+void StreamBench::PrintUsage()
+{
+	std::printf(
+		"stream [options]\n"
+		"  --textures <count>        streamed textures, one per object (default 10000)\n"
+		"  --frames <count>          frames of one orbit of the camera (default 600)\n"
+		"  --budget <MB>             texture memory budget, repeatable\n"
+		"                            (default 128, 512 and 2048)\n"
+		"  --frame-load <MB>         loads that may start per frame (default 8)\n"
+		"  --latency <frames>        frames until a load is finished (default 3)\n"
+	);
+}
+
+
+auto StreamBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--textures" && has_value) {
+			if (!ParseCount(args[++i], options.textures)) {
+				return false;
+			}
+		}
+		else if (arg == "--frames" && has_value) {
+			if (!ParseCount(args[++i], options.frames)) {
+				return false;
+			}
+		}
+		else if (arg == "--budget" && has_value) {
+			size_t budget{ 0 };
+			if (!ParseCount(args[++i], budget)) {
+				return false;
+			}
+			options.budgets_mb.push_back(budget);
+		}
+		else if (arg == "--frame-load" && has_value) {
+			if (!ParseCount(args[++i], options.frame_load_mb)) {
+				return false;
+			}
+		}
+		else if (arg == "--latency" && has_value) {
+			if (!ParseCount(args[++i], options.latency)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: views_bench.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/views_bench.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/bench_utils.h"
+#include "header/renderer.h"
+
+
+namespace bench
+{
+
+namespace
+{
+
+/**
+ * Totals of the measured frames, divided by the frame count when printed.
+ */
+struct Totals
+{
+	double ms{ 0.0 };
+	double gather_ms{ 0.0 };
+	double submit_ms{ 0.0 };
+	size_t draw_packets{ 0 };
+	size_t visible_objects{ 0 };
+};
+
+/**
+ * Creates a renderer on the null backend with \p views split screen views and registers
+ * the models of the grid.
+ */
+auto MakeRenderer(
+	uint32_t views, uint32_t width, uint32_t height, std::vector<uint32_t>& models
+) -> std::unique_ptr<graphics::Renderer>
+{
+	graphics::GraphicSettings settings;
+	settings.window_width = width;
+	settings.window_height = height;
+	settings.split_screen_views = views;
+	settings.render_backend = graphics::RenderBackend::Null;
+	auto renderer = std::make_unique<graphics::Renderer>();
+	if (FAILED(renderer->Initialize(nullptr, settings))) {
+		return nullptr;
+	}
+	renderer->DisableShadows();
+	models = {
+		uint32_t(renderer->RegisterModelProcedural(assets::Procedural::Cube)),
+		uint32_t(renderer->RegisterModelProcedural(assets::Procedural::Sphere)),
+	};
+	return renderer;
+}
+
+/**
+ * Players stand close to each other in the middle of the grid and look in different
+ * directions, which turn a little every frame.
+ */
+auto GetUser(size_t user, size_t frame, float grid_size) -> graphics::SceneInput::User
+{
+	const float angle = float(user) * 1.5707963F + float(frame) * 0.01F;
+	const float center = grid_size / 2.0F;
+	const math::Float3 position = { center + float(user) * 3.0F, 2.0F, center };
+	// The second vector is the direction of the view, not a point to look at
+	return { position, { std::cos(angle), -0.2F, std::sin(angle) } };
+}
+
+void AddFrame(const graphics::Renderer& renderer, double ms, Totals& totals)
+{
+	const auto& stats = renderer.GetFrameStats();
+	totals.ms += ms;
+	totals.gather_ms += stats.gather_ms;
+	totals.submit_ms += stats.submit_ms;
+	totals.draw_packets += stats.draw_packets;
+	totals.visible_objects += stats.visible_objects;
+}
+
+} // namespace
+
+
+auto ViewsBench::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	std::printf("%zu objects, average of %zu frames\n", options.objects, options.frames);
+	std::printf(
+		"%6s %12s %10s %10s %10s %10s %10s\n", "views", "frames", "ms", "gather ms",
+		"submit ms", "visible", "packets"
+	);
+	for (const uint32_t views : { 1U, 2U, 4U }) {
+		// One renderer with all views, and one with a single view of the same size for the
+		// independent frames
+		std::vector<uint32_t> models;
+		auto split_screen = MakeRenderer(views, 1920, 1080, models);
+		auto single = MakeRenderer(1, views > 1 ? 960 : 1920, views > 2 ? 540 : 1080, models);
+		if (split_screen == nullptr || single == nullptr) {
+			std::printf("the renderer can not be initialized\n");
+			return 1;
+		}
+		graphics::SceneInput input;
+		const float grid_size = MakeObjectGrid(options.objects, models, 45, input);
+
+		Totals shared;
+		Totals independent;
+		// The first frame creates the buffers and is not measured
+		for (size_t frame = 0; frame <= options.frames; frame++) {
+			input.users.clear();
+			for (size_t user = 0; user < views; user++) {
+				input.users.push_back(GetUser(user, frame, grid_size));
+			}
+			Stopwatch stopwatch;
+			if (FAILED(split_screen->Process(input))) {
+				return 1;
+			}
+			if (frame > 0) {
+				AddFrame(*split_screen, stopwatch.GetMs(), shared);
+			}
+
+			for (size_t user = 0; user < views; user++) {
+				input.users = { GetUser(user, frame, grid_size) };
+				stopwatch.Restart();
+				if (FAILED(single->Process(input))) {
+					return 1;
+				}
+				if (frame > 0) {
+					AddFrame(*single, stopwatch.GetMs(), independent);
+				}
+			}
+		}
+
+		for (const auto* totals : { &shared, &independent }) {
+			const auto frames = double(options.frames);
+			std::printf(
+				"%6u %12s %10.2f %10.2f %10.2f %10.0f %10.0f\n", views,
+				totals == &shared ? "split screen" : "independent", totals->ms / frames,
+				totals->gather_ms / frames, totals->submit_ms / frames,
+				double(totals->visible_objects) / frames, double(totals->draw_packets) / frames
+			);
+		}
+		split_screen->Shutdown();
+		single->Shutdown();
+	}
+	return 0;
+}
+
+
+void ViewsBench::PrintUsage()
+{
+	std::printf(
+		"views [options]\n"
+		"  --objects <count>         objects on the grid (default 20000)\n"
+		"  --frames <count>          measured frames per row (default 100)\n"
+	);
+}
+
+
+auto ViewsBench::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--objects" && has_value) {
+			if (!ParseCount(args[++i], options.objects)) {
+				return false;
+			}
+		}
+		else if (arg == "--frames" && has_value) {
+			if (!ParseCount(args[++i], options.frames)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace bench
@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: asset_archive.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "lz_codec.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+
+namespace io
+{
+
+/**
+ * An archive file consists of, all values little endian:
+ *	- the ArchiveHeader
+ *	- the blocks, each one LZ compressed or stored as it is
+ *	- an ArchiveBlock for every block
+ *	- an ArchiveEntry for every file, sorted by the hash of its path
+ *	- the normalized paths of all files
+ * The files are concatenated into one stream which is cut into blocks of the same size, so
+ * small files share their blocks.
+ */
+struct ArchiveHeader
+{
+	uint32_t magic{ 0 };
+	uint32_t version{ 0 };
+	uint32_t block_size{ 0 };
+	uint32_t block_count{ 0 };
+	uint32_t entry_count{ 0 };
+	uint32_t names_size{ 0 };
+	// Size of the stream of concatenated files
+	uint64_t data_size{ 0 };
+	// Start of the block table, followed by the entries and names
+	uint64_t toc_offset{ 0 };
+};
+
+struct ArchiveBlock
+{
+	uint64_t offset{ 0 };
+	uint32_t packed_size{ 0 };
+	// Not 0 if the block is stored without compression
+	uint32_t stored{ 0 };
+};
+
+struct ArchiveEntry
+{
+	uint64_t hash{ 0 };
+	// Position of the file in the stream
+	uint64_t offset{ 0 };
+	uint64_t size{ 0 };
+	uint32_t name_offset{ 0 };
+	uint32_t name_size{ 0 };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: AssetArchive
+/// Read-only access to the files of an archive, written by an \c ArchiveWriter. The archive
+/// is mapped once and the table of contents is used straight from the mapping, a lookup is
+/// a binary search over the path hashes.
+///
+/// Files that only lie in stored blocks are returned as a pointer into the mapping, the
+/// others are decompressed. The last decompressed block is kept, because small files share
+/// blocks and are mostly read in the order they were packed.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class AssetArchive
+{
+
+public:
+	static constexpr uint32_t MAGIC = 0x4B504255; // "UBPK"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t BLOCK_SIZE = LzCodec::MAX_BLOCK_SIZE;
+
+	AssetArchive() = default;
+	AssetArchive(const AssetArchive& other) = delete;
+	AssetArchive(AssetArchive&& other) noexcept = delete;
+	auto operator=(const AssetArchive& other) -> AssetArchive = delete;
+	auto operator=(AssetArchive&& other) -> AssetArchive& = delete;
+	~AssetArchive() = default;
+
+	/**
+	 * Maps the archive and checks its table of contents.
+	 * @return false if the file can not be mapped or is no valid archive
+	 */
+	auto Open(const std::string& filename) -> bool;
+	void Close();
+
+	/**
+	 * Returns true if the archive has a file with the path, see \c NormalizePath.
+	 */
+	[[nodiscard]] auto Contains(const std::string& path) const -> bool;
+
+	/**
+	 * Returns the content of a file, either in the mapping or decompressed into \p buffer.
+	 * In both cases it stays valid as long as the archive is open and \p buffer is not
+	 * changed. Can be called from several threads.
+	 * @return false if there is no such file or its blocks are corrupt
+	 */
+	auto Read(
+		const std::string& path, std::vector<uint8_t>& buffer, const uint8_t*& data,
+		size_t& size
+	) const -> bool;
+
+	[[nodiscard]] auto GetFileCount() const -> size_t;
+
+	/**
+	 * Returns the path in the form it is stored in archives: lower case, with forward
+	 * slashes and without "." or resolvable ".." parts.
+	 */
+	static auto NormalizePath(const std::string& path) -> std::string;
+
+	/**
+	 * 64 bit FNV-1a hash of a normalized path.
+	 */
+	static auto HashPath(const std::string& normalized_path) -> uint64_t;
+
+private:
+	static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+	[[nodiscard]] auto Find(const std::string& path) const -> const ArchiveEntry*;
+	[[nodiscard]] auto GetBlockSize(uint32_t block) const -> size_t;
+
+	/**
+	 * Writes the content of a block to \p dst, which has room for \c GetBlockSize bytes.
+	 */
+	auto ReadBlock(uint32_t block, uint8_t* dst) const -> bool;
+
+	MappedFile m_file{};
+	const ArchiveHeader* m_header{ nullptr };
+	const ArchiveBlock* m_blocks{ nullptr };
+	const ArchiveEntry* m_entries{ nullptr };
+	const char* m_names{ nullptr };
+
+	mutable std::mutex m_cache_mutex{};
+	mutable std::vector<uint8_t> m_cache{};
+	mutable uint32_t m_cache_block{ NO_BLOCK };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ArchiveWriter
+/// Writes an archive file for \c AssetArchive. Added files are appended to the stream, every
+/// full batch of blocks is compressed in parallel and written right away, so only the table
+/// of contents is kept until the end. Blocks that do not get noticeably smaller, e.g. block
+/// compressed textures, are stored, which lets the reader return them without a copy.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ArchiveWriter
+{
+
+public:
+	struct Stats
+	{
+		size_t files{ 0 };
+		size_t blocks{ 0 };
+		size_t stored_blocks{ 0 };
+		uint64_t data_bytes{ 0 };
+		// Size of the archive file
+		uint64_t archive_bytes{ 0 };
+	};
+
+	/**
+	 * @param thread_pool used to compress the blocks, can be nullptr
+	 */
+	explicit ArchiveWriter(utils::ThreadPool* thread_pool = nullptr);
+	ArchiveWriter(const ArchiveWriter& other) = delete;
+	ArchiveWriter(ArchiveWriter&& other) noexcept = delete;
+	auto operator=(const ArchiveWriter& other) -> ArchiveWriter = delete;
+	auto operator=(ArchiveWriter&& other) -> ArchiveWriter& = delete;
+	~ArchiveWriter() = default;
+
+	auto Open(const std::string& filename) -> bool;
+
+	/**
+	 * Appends a file, \p path is normalized and must be unique within the archive.
+	 * @return false if the path was added before or writing failed
+	 */
+	auto Add(const std::string& path, const uint8_t* data, size_t size) -> bool;
+
+	/**
+	 * Writes the remaining blocks and the table of contents and closes the file.
+	 */
+	auto Finish() -> bool;
+
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	// Blocks that are compressed together
+	static constexpr size_t BATCH_BLOCKS = 64;
+
+	/**
+	 * Compresses and writes all full blocks of the pending data, or all of it if \p last.
+	 */
+	auto WriteBlocks(bool last) -> bool;
+
+	utils::ThreadPool* m_thread_pool{ nullptr };
+	std::ofstream m_stream{};
+
+	std::vector<uint8_t> m_pending{};
+	std::vector<ArchiveBlock> m_blocks{};
+	std::vector<ArchiveEntry> m_entries{};
+	std::string m_names{};
+	std::unordered_set<std::string> m_paths{};
+
+	uint64_t m_data_size{ 0 };
+	uint64_t m_file_offset{ 0 };
+	Stats m_stats{};
+};
+
+} // namespace io
@@ -8,7 +8,7 @@
 // INCLUDES //
 //////////////
 #include <cstdint>
-#include <d3d11.h>
+#include <istream>
 #include <string>
 #include <tuple>
 
@@ -16,6 +16,14 @@
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "asset_archive.h"
+#include "dds_loader.h"
+#include "geometry_buffer.h"
+#include "image_decoder.h"
+#include "mapped_file.h"
+#include "mip_generator.h"
+#include "render_device.h"
+#include "thread_pool.h"
 #include "vertex_types.h"
 
 
@@ -33,56 +41,139 @@ namespace assets {
 namespace io
 {
 namespace gv = graphics::vertices;
+
+/**
+ * CPU side texture data as it is handed to \c CreateTexture2D.
+ */
+struct TextureData
+{
+	DdsInfo info{};
+	// All subresources in Direct3D order, they point into \a file, \a content, \a images
+	// or the archive the texture was read from
+	std::vector<graphics::SubresourceData> subresources{};
+	// Mapping of a DDS file, the texture data is read directly from it
+	std::unique_ptr<MappedFile> file{ nullptr };
+	// DDS file that was decompressed from an archive
+	std::vector<uint8_t> content{};
+	// Decoded PNG or TGA image followed by its mip levels, always RGBA with 8 bit channels
+	std::vector<Image> images{};
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Class name: AssetLoader
+/// Loads models and textures. All functions are stateless, so they can be called from several
+/// threads at once as long as they do not share their output.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class AssetLoader
 {
 
 public:
-	static auto LoadTexture(
-		ID3D11Device* device, const std::string& filename
-	) -> ID3D11ShaderResourceView*;
+	AssetLoader() = delete;
+
+	/**
+	 * Loads a DDS, PNG or TGA texture into CPU memory, e.g. to pack it into a texture array
+	 * or atlas. The format is chosen by the file extension, PNG and TGA files get a full mip
+	 * chain generated on the CPU.
+	 * @param thread_pool used to decode and downsample PNG and TGA files, can be nullptr
+	 * @param archive the file is read from this archive instead of the disk, the archive
+	 *        has to stay open as long as \p data is used
+	 * @return false if the file can not be read or has an unsupported format
+	 */
+	static auto LoadTextureData(
+		const std::string& filename, utils::ThreadPool* thread_pool, TextureData& data,
+		const AssetArchive* archive = nullptr
+	) -> bool;
+
+	/**
+	 * Loads a texture like \c LoadTextureData from a file that was already read, e.g. by an
+	 * \c AsyncFileReader. \p content is moved into \p data if the texture points into it.
+	 */
+	static auto LoadTextureData(
+		const std::string& filename, std::vector<uint8_t>&& content,
+		utils::ThreadPool* thread_pool, TextureData& data
+	) -> bool;
+
+	/**
+	 * Returns true for PNG and TGA files, they are decoded as a whole while DDS files are
+	 * mapped and read by Direct3D as needed.
+	 */
+	static auto IsDecodedTexture(const std::string& filename) -> bool;
 
+	/**
+	 * @param archive the file is read from this archive instead of the disk
+	 */
 	template <class T>
-	auto LoadModel(
-		ID3D11Device* device, const std::string& filename, gv::Model& model
+	static auto LoadModel(
+		graphics::RenderDevice& device, const std::string& filename, gv::Model& model,
+		graphics::GeometryPool& geometry, const AssetArchive* archive = nullptr
 	) -> bool;
 
 	template <class T>
-	auto LoadModelProcedural(
-		ID3D11Device* d3device, gv::Model& model, assets::Procedural pModel
+	static auto LoadModelProcedural(
+		graphics::RenderDevice& device, gv::Model& model, assets::Procedural pModel,
+		graphics::GeometryPool& geometry
+	) -> bool;
+
+	/**
+	 * Parses an OBJ file that was already read, the model is not uploaded yet. Does not
+	 * touch the device, so several models can be parsed in parallel.
+	 */
+	template <class T>
+	static auto ParseModel(
+		const uint8_t* data, size_t size, gv::Model& model, std::vector<T>& vertices,
+		std::vector<uint32_t>& indices
+	) -> bool;
+
+	/**
+	 * Uploads the model data into the shared buffers of \p geometry.
+	 */
+	template <class T>
+	static auto InitializeBuffers(
+		graphics::RenderDevice& device,
+		gv::Model& model,
+		std::vector<T>& vertices,
+		const std::vector<uint32_t>& indices,
+		graphics::GeometryPool& geometry
 	) -> bool;
 
 private:
+	/**
+	 * Decodes or parses a texture file, \p bytes has to stay valid as long as \p data.
+	 */
+	static auto ParseTexture(
+		const std::string& filename, const uint8_t* bytes, size_t size,
+		utils::ThreadPool* thread_pool, TextureData& data
+	) -> bool;
+
 	template <class T>
-	auto LoadModelFromOBJ(
+	static auto LoadModelFromOBJ(
 		const std::string& filename,
+		const AssetArchive* archive,
 		gv::Model& model,
 		std::vector<T>& vertices, 
 		std::vector<uint32_t>& indices
 	) -> bool;
 
+	template <class T>
+	static auto ParseOBJ(
+		std::istream& fin,
+		gv::Model& model,
+		std::vector<T>& vertices,
+		std::vector<uint32_t>& indices
+	) -> bool;
+
 	static auto ReadFileCounts(
-		const std::string& filename
+		std::istream& fin
 	) -> std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>;
 
 	template <class T>
-	auto LoadData(
-		const std::string& filename,
+	static auto LoadData(
+		std::istream& fin,
 		const std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>& counts,
 		std::vector<T>& vertices, 
 		std::vector<uint32_t>& indices
 	) -> bool;
 
-	template <class T>
-	auto InitializeBuffers(
-		ID3D11Device* d3device,
-		gv::Model& model,
-		std::vector<T>& vertices,
-		const std::vector<uint32_t>& indices
-	) -> bool;
-
 };
 
 } // namespace io
@@ -8,6 +8,7 @@
 // INCLUDES //
 //////////////
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,11 @@
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "asset_loader.h"
+#include "async_file_reader.h"
+#include "geometry_buffer.h"
+#include "residency_manager.h"
+#include "texture_packer.h"
+#include "texture_streamer.h"
 #include "vertex_types.h"
 
 
@@ -28,27 +34,218 @@ class AssetManager
 {
 
 public:
+	/**
+	 * @param thread_pool used to decode textures, can be nullptr
+	 */
+	explicit AssetManager(utils::ThreadPool* thread_pool = nullptr);
+
+	// Archive stuff
+	/**
+	 * Mounts an archive, models and textures whose path is in an archive are read from it
+	 * instead of the disk. Archives that are mounted later take precedence.
+	 * @return false if the archive can not be opened
+	 */
+	auto MountArchive(const std::string& filename) -> bool;
+
 	// Model stuff
-	auto AddModel(ID3D11Device* device, const std::string& filename) -> size_t;
-	auto AddModelProcedural(ID3D11Device* device, Procedural idx) -> size_t;
+	static constexpr size_t NO_MODEL = SIZE_MAX;
+
+	/**
+	 * Loads a model, a model that can not be loaded is not stored and reported once.
+	 * @return the model index or \c NO_MODEL if the model can not be loaded
+	 */
+	auto AddModel(graphics::RenderDevice& device, const std::string& filename) -> size_t;
+	auto AddModelProcedural(graphics::RenderDevice& device, Procedural idx) -> size_t;
+
+	/**
+	 * Adds several models like \c AddModel. The files are read asynchronously and each one
+	 * is parsed on the thread pool as soon as it arrived, only the upload happens in order
+	 * on the calling thread.
+	 * @return the model indices in the order of \p filenames, \c NO_MODEL for the files
+	 * that can not be loaded
+	 */
+	auto AddModels(graphics::RenderDevice& device, const std::vector<std::string>& filenames)
+		-> std::vector<size_t>;
 
 	auto GetModel(size_t model_index) -> const graphics::vertices::Model&;
+	[[nodiscard]] auto GetModelCount() const -> size_t;
+
+	/**
+	 * Returns the shared vertex buffer which holds all models with the given vertex stride.
+	 */
+	auto GetVertexBuffer(uint32_t stride) const -> graphics::RenderDevice::Handle;
+	/**
+	 * Returns the shared index buffer which holds the indices of all models.
+	 */
+	auto GetIndexBuffer() const -> graphics::RenderDevice::Handle;
+
+	/**
+	 * Keeps a CPU copy of the shared geometry buffers for backends that draw on the CPU.
+	 * Has to be called before the first model is added.
+	 */
+	void KeepGeometryOnCpu();
+	/**
+	 * Returns the CPU copy of the vertex buffer for \p stride, see \c KeepGeometryOnCpu.
+	 */
+	auto GetVertexData(uint32_t stride) const -> const uint8_t*;
+	auto GetIndexData() const -> const uint32_t*;
+
+	/**
+	 * Compacts the shared geometry buffers by moving at most \p max_bytes and updates the
+	 * ranges of the moved models.
+	 * @return number of bytes that were moved
+	 */
+	auto DefragmentGeometry(graphics::RenderDevice& device, size_t max_bytes) -> size_t;
+	auto GetGeometryStats() const -> graphics::GeometryPool::Stats;
+
+	// Residency stuff
+	/**
+	 * Sets the GPU memory that all resident models may use together.
+	 */
+	void SetModelBudget(size_t bytes);
+
+	/**
+	 * Starts a new frame for the residency tracking and the texture streaming.
+	 */
+	void BeginFrame();
+
+	/**
+	 * Marks the model as drawn in this frame and reloads it if it was evicted. Has to be
+	 * called before the model is drawn.
+	 * @return false if the model could not be reloaded
+	 */
+	auto UseModel(graphics::RenderDevice& device, size_t model_index) -> bool;
+
+	/**
+	 * Evicts the least recently drawn models until the model budget is met.
+	 */
+	void EnforceModelBudget();
+
+	auto GetResidencyStats() const -> ResidencyManager::Stats;
 
 	// Texture stuff
-	auto AddTexture(
-		ID3D11Device* device, const std::string& filename, uint8_t components
-	) -> size_t;
+	static constexpr size_t NO_TEXTURE = SIZE_MAX;
+
+	/**
+	 * Loads a texture into CPU memory, it is uploaded by the next \c PackTextures. Large DDS
+	 * textures are streamed instead, they start with their smallest levels on the next
+	 * \c StreamTextures.
+	 */
+	auto AddTexture(const std::string& filename, uint8_t components) -> size_t;
+
+	/**
+	 * Adds several textures like \c AddTexture. PNG and TGA files are read asynchronously
+	 * and decoded as soon as they arrived, DDS files are only mapped as before.
+	 * @return the texture indices in the order of \p filenames
+	 */
+	auto AddTextures(const std::vector<std::string>& filenames, uint8_t components)
+		-> std::vector<size_t>;
+
+	/**
+	 * Uploads all textures added since the last call, packed into texture arrays.
+	 */
+	auto PackTextures(graphics::RenderDevice& device) -> HRESULT;
+	[[nodiscard]] auto HasPendingTextures() const -> bool;
 
-	auto GetTexture(size_t textureIndex) -> ID3D11ShaderResourceView*;
+	/**
+	 * Returns the array the texture was packed into, use \c GetTextureLocation for the
+	 * slice and UV transform.
+	 */
+	auto GetTexture(size_t textureIndex) -> graphics::RenderDevice::Handle;
+	auto GetTextureLocation(size_t texture_index) const -> const TextureLocation&;
+	auto GetTextureArray(uint32_t array_index) const -> graphics::RenderDevice::Handle;
+	auto GetTextureStats() const -> TexturePacker::Stats;
+
+	// Texture streaming stuff
+	/**
+	 * Sets the GPU memory that all streamed textures may use together.
+	 */
+	void SetTextureBudget(size_t bytes);
+
+	/**
+	 * Reports that the texture is drawn in this frame.
+	 * @param screen_pixels number of pixels the texture covers along its larger axis
+	 */
+	void RequestTexture(size_t texture_index, float screen_pixels);
+
+	/**
+	 * Uploads the streamed levels that finished loading and starts loading the levels that
+	 * were requested, evicting others if the budget requires it.
+	 * @param max_load_bytes bytes that may start loading in this frame
+	 */
+	auto StreamTextures(graphics::RenderDevice& device, size_t max_load_bytes) -> HRESULT;
+
+	/**
+	 * Blocks until the levels that started loading in the last \c StreamTextures arrived,
+	 * so they are uploaded by the next one no matter how long the loads took.
+	 */
+	void WaitForTextureLoads();
+	auto GetStreamingStats() const -> MipStreamer::Stats;
+
+	/**
+	 * Sets the texture the model is drawn with, \c NO_TEXTURE removes it. Ignored for
+	 * \c NO_MODEL.
+	 */
+	void SetModelTexture(size_t model_index, size_t texture_index);
+	auto GetModelTexture(size_t model_index) const -> size_t;
 
 private:
+	/**
+	 * Where a model was loaded from, so it can be reloaded after it was evicted.
+	 */
+	struct ModelSource
+	{
+		std::string filename;
+		Procedural procedural{ Procedural::NUMBER };
+	};
+
+	auto LoadModel(
+		graphics::RenderDevice& device, const ModelSource& source, graphics::vertices::Model& model
+	) -> bool;
+
+	/**
+	 * Reports a model that can not be loaded, once per file.
+	 */
+	void ReportFailedModel(const std::string& filename);
+
+	/**
+	 * Adds a loaded model to the storage system and returns its index.
+	 */
+	auto StoreModel(ModelSource&& source, graphics::vertices::Model&& model) -> size_t;
+
+	/**
+	 * Hands a loaded texture to the packer or the streamer and returns its index.
+	 */
+	auto StoreTexture(const std::string& filename, io::TextureData&& data) -> size_t;
+
+	/**
+	 * Returns the archive the file is read from, nullptr if it is read from the disk.
+	 */
+	auto FindArchive(const std::string& filename) const -> const io::AssetArchive*;
+
+	static auto GetModelBytes(const graphics::vertices::Model& model) -> size_t;
+
+	// Declared first, textures and the streamer may point into the mappings
+	std::vector<std::unique_ptr<io::AssetArchive>> m_archives{};
+
 	std::vector<graphics::vertices::Model> models;
-	std::vector<ID3D11ShaderResourceView*> textures;
+	TexturePacker m_textures{};
+	TextureStreamer m_texture_streamer{};
+	std::vector<size_t> m_model_textures{};
 
 	std::map<std::string, size_t> model_idx;
+	std::set<std::string> m_failed_models{};
 	std::map<std::string, size_t> texture_idx;
 
-	std::unique_ptr<io::AssetLoader> m_asset_loader{ nullptr };
+	utils::ThreadPool* m_thread_pool{ nullptr };
+	// Runs its callbacks on the thread pool, so it is initialized after the pointer
+	io::AsyncFileReader m_file_reader;
+
+	graphics::GeometryPool m_geometry{};
+
+	std::vector<ModelSource> m_model_sources{};
+	ResidencyManager m_residency{};
+	std::vector<size_t> m_evicted{};
 
 };
 
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: async_file_reader.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "thread_pool.h"
+
+
+namespace io
+{
+
+enum class IoBackend : uint8_t
+{
+	// io_uring if the system supports it, otherwise threads
+	Auto = 0,
+	IoUring,
+	Threads
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: AsyncFileReader
+/// Reads whole files without blocking the caller. Reads are queued with \c Read and handed to
+/// the backend in batches, at most \a max_in_flight of them are outstanding at once, so
+/// \c Read blocks once the limit is reached. The callback of a read gets the file content
+/// and runs on the callback pool, which lets the parsing of one file overlap with the reads
+/// of the next ones.
+///
+/// On Linux the files are opened, read and closed through an io_uring by a single thread,
+/// elsewhere (or if the kernel lacks io_uring) a few threads do blocking reads.
+/// If the ring breaks later, the reads in it fail and the reader goes on with threads.
+///
+/// \c Read, \c Submit and \c Wait have to be called from one thread, callbacks must not call
+/// them.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class AsyncFileReader
+{
+
+public:
+	struct Result
+	{
+		std::string filename;
+		std::vector<uint8_t> data;
+		bool success{ false };
+	};
+
+	using Callback = std::function<void(Result&& result)>;
+
+	struct Stats
+	{
+		// Totals since the reader was created
+		size_t requests{ 0 };
+		size_t failed{ 0 };
+		uint64_t bytes{ 0 };
+		// Largest number of reads that were outstanding at once
+		size_t peak_in_flight{ 0 };
+	};
+
+	static constexpr size_t DEFAULT_IN_FLIGHT = 64;
+
+	/**
+	 * @param callback_pool runs the callbacks, if nullptr they run on the I/O thread
+	 * @param max_in_flight reads that may be outstanding at once
+	 * @param backend falls back to threads if io_uring is requested but not available
+	 */
+	explicit AsyncFileReader(
+		utils::ThreadPool* callback_pool = nullptr, size_t max_in_flight = DEFAULT_IN_FLIGHT,
+		IoBackend backend = IoBackend::Auto
+	);
+	AsyncFileReader(const AsyncFileReader& other) = delete;
+	AsyncFileReader(AsyncFileReader&& other) noexcept = delete;
+	auto operator=(const AsyncFileReader& other) -> AsyncFileReader = delete;
+	auto operator=(AsyncFileReader&& other) -> AsyncFileReader& = delete;
+	/**
+	 * Waits for all reads and their callbacks.
+	 */
+	~AsyncFileReader();
+
+	/**
+	 * Queues a read, it starts with the next \c Submit or once a full batch is queued.
+	 */
+	void Read(const std::string& filename, Callback callback);
+
+	/**
+	 * Hands all queued reads to the backend, blocks while the in-flight limit is reached.
+	 */
+	void Submit();
+
+	/**
+	 * Submits the queued reads and blocks until all reads are done and their callbacks
+	 * returned.
+	 */
+	void Wait();
+
+	/**
+	 * Returns the backend that is used, never \c IoBackend::Auto.
+	 */
+	[[nodiscard]] auto GetBackend() const -> IoBackend;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	// Threads doing blocking reads if there is no io_uring
+	static constexpr size_t IO_THREADS = 4;
+
+	struct Request
+	{
+		std::string filename;
+		Callback callback;
+	};
+
+	// io_uring state, only defined where io_uring is supported
+	struct Ring;
+
+	/**
+	 * Reads a file with blocking calls, used by the thread backend.
+	 */
+	static auto ReadFile(const std::string& filename, std::vector<uint8_t>& data) -> bool;
+
+	/**
+	 * Reads a file on the I/O threads and finishes it.
+	 */
+	void ReadBlocking(Request&& request);
+
+	/**
+	 * Runs the callback of a finished read on the callback pool.
+	 */
+	void Finish(Request&& request, Result&& result);
+
+	/**
+	 * Loop of the io_uring thread, starts queued reads and processes completions.
+	 */
+	void RunRing();
+
+	/**
+	 * Called by the io_uring thread if the ring can not be entered anymore. Fails the reads
+	 * in the ring and moves the queued ones and all later reads to the I/O threads.
+	 */
+	void FailRing();
+
+	utils::ThreadPool* m_callback_pool{ nullptr };
+	size_t m_max_in_flight{ DEFAULT_IN_FLIGHT };
+	// Turns from io_uring to threads if the ring breaks, guarded by the mutex
+	IoBackend m_backend{ IoBackend::Threads };
+
+	// Queued by Read, only used by the calling thread
+	std::vector<Request> m_batch{};
+
+	mutable std::mutex m_mutex{};
+	std::condition_variable m_done_cv{};
+	std::condition_variable m_queue_cv{};
+	// Submitted reads the io_uring thread did not start yet
+	std::deque<Request> m_queue{};
+	size_t m_in_flight{ 0 };
+	bool m_stop{ false };
+	Stats m_stats{};
+
+	std::unique_ptr<Ring> m_ring{ nullptr };
+	std::thread m_ring_thread{};
+	std::unique_ptr<utils::ThreadPool> m_io_threads{ nullptr };
+};
+
+} // namespace io
@@ -0,0 +1,111 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bc_encoder.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "image_decoder.h"
+#include "render_types.h"
+#include "thread_pool.h"
+
+
+namespace io
+{
+
+enum class BcFormat : uint8_t
+{
+	// RGB with 1 bit alpha, 8 bytes per block
+	BC1 = 0,
+	// RGB plus interpolated alpha, 16 bytes per block
+	BC3,
+	// Two independent channels (red and green), meant for normal maps, 16 bytes per block
+	BC5,
+	// RGBA with several block modes, 16 bytes per block
+	BC7,
+	NUMBER
+};
+
+enum class BcQuality : uint8_t
+{
+	// Bounding box endpoints
+	Fast = 0,
+	// Cluster fit for BC1 colors, refined endpoints and a mode search for BC7
+	High
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: BcEncoder
+/// Compresses RGBA images into block-compressed formats. The image is split into 4x4 blocks
+/// which are encoded independently, rows of blocks are spread across the thread pool.
+///
+/// BC7 blocks use mode 6 (one subset with alpha) and, in high quality for opaque blocks,
+/// mode 1 (two subsets) with a search over all 64 partitions.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class BcEncoder
+{
+
+public:
+	/**
+	 * Accumulated squared error between the input and the decoded blocks.
+	 */
+	struct Stats
+	{
+		uint64_t blocks{ 0 };
+		// Number of compared channel values, only the channels the format stores count
+		uint64_t samples{ 0 };
+		double squared_error{ 0.0 };
+
+		/**
+		 * Returns the peak signal to noise ratio in dB, infinity for a lossless result.
+		 */
+		[[nodiscard]] auto GetPsnr() const -> double;
+	};
+
+	BcEncoder() = delete;
+
+	/**
+	 * Returns the size of one encoded 4x4 block in bytes.
+	 */
+	static auto GetBlockBytes(BcFormat format) -> uint32_t;
+
+	/**
+	 * Returns the format the encoded blocks have to be sampled with.
+	 */
+	static auto GetTextureFormat(BcFormat format, bool srgb) -> graphics::TextureFormat;
+
+	/**
+	 * Encodes the whole image, partial blocks at the right and bottom border repeat the
+	 * last row and column.
+	 * @param blocks receives the blocks row by row
+	 * @param thread_pool used to encode the block rows, can be nullptr
+	 */
+	static auto Compress(
+		const Image& image, BcFormat format, BcQuality quality, std::vector<uint8_t>& blocks,
+		utils::ThreadPool* thread_pool
+	) -> Stats;
+
+	/**
+	 * Encodes a single block.
+	 * @param pixels the 16 RGBA pixels of the block, row by row
+	 * @param block receives \c GetBlockBytes(format) bytes
+	 * @return squared error of the decoded block over the channels the format stores
+	 */
+	static auto EncodeBlock(
+		const std::array<uint8_t, 64>& pixels, BcFormat format, BcQuality quality,
+		uint8_t* block
+	) -> double;
+};
+
+} // namespace io
@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: camera.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Camera
+/// A virtual camera with a position, a look direction and a projection. The matrices and
+/// frustum planes derived from them are cached and only computed again in \c Update if one of
+/// the inputs changed since the last frame, setting the same values again does not count as a
+/// change.
+///
+/// Caches that depend on the view, e.g. culling results or shadow maps, can compare
+/// \c GetVersion with the version they were built for, or check \c HasChanged each frame.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Camera
+{
+
+public:
+	enum class Plane : uint8_t
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		NUMBER
+	};
+
+	/**
+	 * Normalized planes (a, b, c, d) with the normals facing inwards, so a point p is inside
+	 * the frustum if a * p.x + b * p.y + c * p.z + d >= 0 for every plane.
+	 */
+	using Planes = std::array<math::Float4, size_t(Plane::NUMBER)>;
+
+	Camera();
+	Camera(const Camera& other) = delete;
+	Camera(Camera&& other) noexcept = delete;
+	auto operator=(const Camera& other) -> Camera = delete;
+	auto operator=(Camera&& other) -> Camera& = delete;
+	~Camera() = default;
+
+	/**
+	 * @param direction the direction the camera looks into, it does not have to be normalized
+	 *        but must not be zero
+	 */
+	void SetView(const math::Float3& position, const math::Float3& direction);
+	void SetProjection(const math::Float4x4& projection);
+
+	/**
+	 * Makes this camera the mirror image of \p camera at the horizontal plane y = \p height,
+	 * with the same projection. The mirrored camera looks at the scene from below the plane,
+	 * so everything it sees below the plane has to be clipped.
+	 */
+	void SetReflection(const Camera& camera, float height);
+
+	/**
+	 * Computes the cached values again if an input changed, called once per frame before
+	 * any of them is used.
+	 * @return true if the camera changed since the last call
+	 */
+	auto Update() -> bool;
+
+	/**
+	 * Returns whether the last \c Update changed the camera.
+	 */
+	[[nodiscard]] auto HasChanged() const -> bool;
+	/**
+	 * Returns a number that increases with every change, starting at 1 after the first
+	 * \c Update.
+	 */
+	[[nodiscard]] auto GetVersion() const -> uint64_t;
+
+	[[nodiscard]] auto GetPosition() const -> const math::Float3&;
+	[[nodiscard]] auto GetDirection() const -> const math::Float3&;
+
+	[[nodiscard]] auto GetViewMatrix() const -> const math::Float4x4&;
+	[[nodiscard]] auto GetProjectionMatrix() const -> const math::Float4x4&;
+	[[nodiscard]] auto GetViewProjectionMatrix() const -> const math::Float4x4&;
+	/**
+	 * The transposed matrices are the layout the shader constant buffers expect.
+	 */
+	[[nodiscard]] auto GetViewMatrixTransposed() const -> const math::Float4x4&;
+	[[nodiscard]] auto GetViewProjectionMatrixTransposed() const -> const math::Float4x4&;
+	/**
+	 * Transforms from view space back to world space.
+	 */
+	[[nodiscard]] auto GetInverseViewMatrix() const -> const math::Float4x4&;
+	/**
+	 * Transforms from clip space back to world space, e.g. to get the frustum corners.
+	 */
+	[[nodiscard]] auto GetInverseViewProjectionMatrix() const -> const math::Float4x4&;
+
+	[[nodiscard]] auto GetFrustumPlanes() const -> const Planes&;
+
+	/**
+	 * Returns false if the sphere is completely outside of one of the frustum planes.
+	 * Spheres close to a corner of the frustum may pass although they are outside.
+	 */
+	[[nodiscard]] auto IsSphereVisible(const math::Float3& center, float radius) const
+		-> bool;
+
+	/**
+	 * Computes the view of the camera mirrored at a horizontal plane, it is not cached. This
+	 * is the view matrix a camera gets from \c SetReflection.
+	 * @param height the height at which the reflecting objects are positioned
+	 */
+	[[nodiscard]] auto ComputeReflectionMatrix(float height) const -> math::Float4x4;
+
+	/**
+	 * Computes the view matrix using \c math::LookToLH. The up vector is the y axis, or
+	 * the z axis if the camera looks straight up or down.
+	 */
+	static auto ComputeViewMatrix(
+		const math::Float3& position, const math::Float3& direction
+	) -> math::Float4x4;
+
+private:
+
+	void Recompute();
+
+	math::Float4x4 m_view_matrix;
+	math::Float4x4 m_projection_matrix;
+	math::Float4x4 m_view_projection_matrix;
+	math::Float4x4 m_view_matrix_transposed;
+	math::Float4x4 m_view_projection_matrix_transposed;
+	math::Float4x4 m_inverse_view_matrix;
+	math::Float4x4 m_inverse_view_projection_matrix;
+
+	math::Float3 m_position{ 0.0F, 0.0F, 0.0F };
+	math::Float3 m_direction{ 0.0F, 0.0F, 1.0F };
+	Planes m_planes{};
+
+	// Set by the setters, cleared by Update
+	bool m_dirty{ true };
+	bool m_changed{ false };
+	uint64_t m_version{ 0 };
+};
+
+} // namespace graphics
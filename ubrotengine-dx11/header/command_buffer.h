@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: command_buffer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+
+enum class CommandOp : uint8_t
+{
+	SetProgram = 0,
+	SetModel,
+	SetWorldMatrix,
+	SetTexture,
+	DrawIndexed,
+	SetView,
+	ClearView,
+	NUMBER
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: CommandBuffer
+/// Backend independent list of draw commands. Each command is stored as a one byte opcode
+/// followed by its packed arguments. Commands are grouped into records, where every record
+/// is self-contained (it sets all state it needs) and carries a sort key. This allows
+/// several buffers to be recorded in parallel and merged by sort key afterwards.
+///
+/// A buffer is replayed against any backend type that provides the methods
+///		- SetProgram(uint32_t program_idx)
+///		- SetModel(uint32_t model_idx)
+///		- SetWorldMatrix(const math::Float4x4& world)
+///		- SetTexture(uint32_t texture_idx)
+///		- DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex)
+///		- SetView(uint32_t view_idx)
+///		- ClearView(uint32_t view_idx)
+/// The backend is a template parameter, so no virtual calls are involved.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CommandBuffer
+{
+
+public:
+	struct Record
+	{
+		uint64_t sort_key;
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	/**
+	 * Position of a record inside a set of command buffers, as produced by \c Merge.
+	 */
+	struct RecordRef
+	{
+		uint32_t buffer_idx;
+		uint32_t record_idx;
+	};
+
+	/**
+	 * Removes all commands but keeps the allocated memory.
+	 */
+	void Clear();
+
+	void BeginRecord(uint64_t sort_key);
+	void EndRecord();
+
+	void SetProgram(uint32_t program_idx);
+	void SetModel(uint32_t model_idx);
+	void SetWorldMatrix(const math::Float4x4& world);
+	void SetTexture(uint32_t texture_idx);
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex);
+	void SetView(uint32_t view_idx);
+	/**
+	 * Resets the color and depth of the targets of a view, views that share targets are
+	 * cleared together.
+	 */
+	void ClearView(uint32_t view_idx);
+
+	[[nodiscard]] auto GetRecords() const -> const std::vector<Record>&;
+	[[nodiscard]] auto GetByteSize() const -> size_t;
+
+	/**
+	 * Decodes all commands of one record and forwards them to \p backend.
+	 */
+	template <class Backend>
+	void Replay(const Record& record, Backend& backend) const;
+
+	/**
+	 * Replays all records of this buffer in the order they were recorded.
+	 */
+	template <class Backend>
+	void Replay(Backend& backend) const;
+
+	/**
+	 * Merges the records of all \p buffers into one list which is ordered by sort key.
+	 * Every buffer has to be sorted by itself already. Records with equal keys keep the
+	 * order of the buffers.
+	 * @param buffers the buffers to merge
+	 * @param merged receives the merged record order, previous content is discarded
+	 */
+	static void Merge(
+		const std::vector<CommandBuffer>& buffers, std::vector<RecordRef>& merged
+	);
+
+	/**
+	 * Replays the records of \p buffers in the given merged order.
+	 */
+	template <class Backend>
+	static void Replay(
+		const std::vector<CommandBuffer>& buffers,
+		const std::vector<RecordRef>& merged,
+		Backend& backend
+	);
+
+private:
+	template <class T>
+	void Write(const T& value);
+
+	template <class T>
+	auto Read(size_t& offset) const -> T;
+
+	std::vector<uint8_t> m_data{};
+	std::vector<Record> m_records{};
+};
+
+
+template <class T>
+void CommandBuffer::Write(const T& value)
+{
+	const auto offset = m_data.size();
+	m_data.resize(offset + sizeof(T));
+	std::memcpy(m_data.data() + offset, &value, sizeof(T));
+}
+
+
+template <class T>
+auto CommandBuffer::Read(size_t& offset) const -> T
+{
+	T value;
+	std::memcpy(&value, m_data.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return value;
+}
+
+
+template <class Backend>
+void CommandBuffer::Replay(const Record& record, Backend& backend) const
+{
+	size_t offset = record.offset;
+	const size_t end = size_t(record.offset) + record.size;
+
+	while (offset < end) {
+		const auto op = Read<CommandOp>(offset);
+		switch (op)
+		{
+			case CommandOp::SetProgram:
+				backend.SetProgram(Read<uint32_t>(offset));
+				break;
+			case CommandOp::SetModel:
+				backend.SetModel(Read<uint32_t>(offset));
+				break;
+			case CommandOp::SetWorldMatrix:
+				backend.SetWorldMatrix(Read<math::Float4x4>(offset));
+				break;
+			case CommandOp::SetTexture:
+				backend.SetTexture(Read<uint32_t>(offset));
+				break;
+			case CommandOp::DrawIndexed:
+			{
+				const auto index_count = Read<uint32_t>(offset);
+				const auto start_index = Read<uint32_t>(offset);
+				const auto base_vertex = Read<int32_t>(offset);
+				backend.DrawIndexed(index_count, start_index, base_vertex);
+				break;
+			}
+			case CommandOp::SetView:
+				backend.SetView(Read<uint32_t>(offset));
+				break;
+			case CommandOp::ClearView:
+				backend.ClearView(Read<uint32_t>(offset));
+				break;
+			default:
+				// Corrupt buffer, stop decoding this record
+				return;
+		}
+	}
+}
+
+
+template <class Backend>
+void CommandBuffer::Replay(Backend& backend) const
+{
+	for (const auto& record : m_records) {
+		Replay(record, backend);
+	}
+}
+
+
+template <class Backend>
+void CommandBuffer::Replay(
+	const std::vector<CommandBuffer>& buffers,
+	const std::vector<RecordRef>& merged,
+	Backend& backend
+)
+{
+	for (const auto& ref : merged) {
+		const auto& buffer = buffers[ref.buffer_idx];
+		buffer.Replay(buffer.m_records[ref.record_idx], backend);
+	}
+}
+
+} // namespace graphics
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: command_hash.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: CommandHash
+/// Replay backend that hashes the commands with 64 bit FNV-1a, see \c CommandBuffer. Two
+/// replays of a frame capture give the same hash for a frame if they drew the same commands.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CommandHash
+{
+
+public:
+	CommandHash() = default;
+	CommandHash(const CommandHash& other) = delete;
+	CommandHash(CommandHash&& other) noexcept = delete;
+	auto operator=(const CommandHash& other) -> CommandHash = delete;
+	auto operator=(CommandHash&& other) -> CommandHash& = delete;
+	~CommandHash() = default;
+
+	void SetProgram(uint32_t program_idx)
+	{
+		Add(1, &program_idx, sizeof(program_idx));
+	}
+
+	void SetModel(uint32_t model_idx)
+	{
+		Add(2, &model_idx, sizeof(model_idx));
+	}
+
+	void SetWorldMatrix(const math::Float4x4& world)
+	{
+		Add(3, &world, sizeof(world));
+	}
+
+	void SetTexture(uint32_t texture_idx)
+	{
+		Add(4, &texture_idx, sizeof(texture_idx));
+	}
+
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex)
+	{
+		const std::array<uint32_t, 3> args = { index_count, start_index, uint32_t(base_vertex) };
+		Add(5, args.data(), sizeof(args));
+	}
+
+	void SetView(uint32_t view_idx)
+	{
+		Add(6, &view_idx, sizeof(view_idx));
+	}
+
+	void ClearView(uint32_t view_idx)
+	{
+		Add(7, &view_idx, sizeof(view_idx));
+	}
+
+	[[nodiscard]] auto GetHash() const -> uint64_t
+	{
+		return m_hash;
+	}
+
+private:
+	void Add(uint8_t opcode, const void* data, size_t size)
+	{
+		constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+		m_hash = (m_hash ^ opcode) * FNV_PRIME;
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++) {
+			m_hash = (m_hash ^ bytes[i]) * FNV_PRIME;
+		}
+	}
+
+	uint64_t m_hash{ 0xCBF29CE484222325ULL };
+};
+
+} // namespace graphics
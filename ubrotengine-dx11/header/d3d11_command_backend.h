@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11_command_backend.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <d3d11.h>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "asset_manager.h"
+#include "d3d11_render_device.h"
+#include "math_types.h"
+#include "render_view.h"
+#include "shader_manager.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D11CommandBackend
+/// Replays a \c CommandBuffer against a Direct3D 11 device context. The context can either be
+/// the immediate context or a deferred one. Since all models live in shared geometry buffers,
+/// the vertex buffer only has to be rebound if the vertex stride changes and the index buffer
+/// is bound once. Textures are packed into texture arrays, the array is only rebound if
+/// it changes and otherwise just the slice and UV transform are updated. Shader stages are
+/// shared between programs, so a program switch only binds the stages that differ.
+///
+/// Every view has its own camera, viewport and render target, \c SetView switches them.
+/// Consecutive records of the same view do not set the viewport again, and views that share
+/// their targets (e.g. split screen views of the back buffer) do not rebind them. A view of
+/// a depth array only writes depth, e.g. a shadow map.
+///
+/// The handles of the shared buffers, textures and shader stages are resolved through the
+/// \c D3D11RenderDevice that created them.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class D3D11CommandBackend
+{
+
+public:
+	/**
+	 * @param views the views the commands refer to by index, they have to outlive the backend
+	 */
+	D3D11CommandBackend(
+		const D3D11RenderDevice& device,
+		ID3D11DeviceContext* device_context,
+		ShaderManager& shader_manager,
+		assets::AssetManager& asset_manager,
+		const std::vector<RenderView>& views
+	);
+	D3D11CommandBackend(const D3D11CommandBackend& other) = delete;
+	D3D11CommandBackend(D3D11CommandBackend&& other) noexcept = delete;
+	auto operator=(const D3D11CommandBackend& other) -> D3D11CommandBackend = delete;
+	auto operator=(D3D11CommandBackend&& other) -> D3D11CommandBackend& = delete;
+	~D3D11CommandBackend() = default;
+
+	void SetProgram(uint32_t program_idx);
+	void SetModel(uint32_t model_idx);
+	void SetWorldMatrix(const math::Float4x4& world);
+	void SetTexture(uint32_t texture_idx);
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex);
+	void SetView(uint32_t view_idx);
+	void ClearView(uint32_t view_idx);
+
+	/**
+	 * Returns the first error that occurred while replaying, or \c S_OK.
+	 */
+	[[nodiscard]] auto GetResult() const -> HRESULT;
+
+	/**
+	 * Returns the number of vertex and index buffer binds that were issued.
+	 */
+	[[nodiscard]] auto GetBufferBinds() const -> size_t;
+
+	/**
+	 * Returns the number of buffer binds the same commands would have needed with one
+	 * vertex and index buffer per model (two binds for every model switch).
+	 */
+	[[nodiscard]] auto GetBufferBindsPerModel() const -> size_t;
+
+	/**
+	 * Returns the number of texture array binds that were issued.
+	 */
+	[[nodiscard]] auto GetTextureBinds() const -> size_t;
+
+	/**
+	 * Returns the number of texture binds the same commands would have needed with one
+	 * shader resource per texture (one bind for every texture switch).
+	 */
+	[[nodiscard]] auto GetTextureBindsPerTexture() const -> size_t;
+
+	/**
+	 * Returns the number of shader and input layout binds that were issued.
+	 */
+	[[nodiscard]] auto GetShaderBinds() const -> size_t;
+
+	/**
+	 * Returns the number of shader binds the same commands would have needed if every draw
+	 * bound the layout and all stages of its program.
+	 */
+	[[nodiscard]] auto GetShaderBindsPerDraw() const -> size_t;
+
+private:
+	/**
+	 * Binds the layout and the stages of the program that differ from the bound ones.
+	 */
+	void BindProgram();
+
+	const D3D11RenderDevice& m_device;
+	ID3D11DeviceContext* m_device_context;
+	ShaderManager& m_shader_manager;
+	assets::AssetManager& m_asset_manager;
+	const std::vector<RenderView>& m_views;
+
+	uint32_t m_view_idx{ UINT32_MAX };
+	ID3D11RenderTargetView* m_render_target{ nullptr };
+	ID3D11DepthStencilView* m_depth_stencil{ nullptr };
+	math::Float4x4 m_view_matrix{};
+	math::Float4x4 m_projection_matrix{};
+	math::Float4x4 m_world_matrix{};
+
+	ShaderProgram* m_program{ nullptr };
+	ShaderProgram::BindState m_bind_state{};
+	const vertices::Model* m_model{ nullptr };
+	uint32_t m_model_idx{ UINT32_MAX };
+
+	ID3D11Buffer* m_vertex_buffer{ nullptr };
+	ID3D11Buffer* m_index_buffer{ nullptr };
+
+	size_t m_buffer_binds{ 0 };
+	size_t m_model_switches{ 0 };
+
+	uint32_t m_texture_idx{ UINT32_MAX };
+	uint32_t m_texture_array{ UINT32_MAX };
+	size_t m_texture_binds{ 0 };
+	size_t m_texture_switches{ 0 };
+
+	HRESULT m_result{ S_OK };
+};
+
+} // namespace graphics
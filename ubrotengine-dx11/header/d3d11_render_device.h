@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11_render_device.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <d3d11.h>
+#include <memory>
+#include <vector>
+#include <wrl\client.h>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "direct3d.h"
+#include "render_device.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: D3D11RenderDevice
+/// Creates the resources with Direct3D 11 on the hardware adapter, presents into the window
+/// through the swap chain of \c Direct3D. Only \c D3D11CommandBackend and the renderer see
+/// the Direct3D objects behind the handles, through the getters below.
+///
+/// Deferred contexts and their command lists are kept here as well, one per recording
+/// thread.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class D3D11RenderDevice final : public RenderDevice
+{
+
+public:
+	D3D11RenderDevice() = default;
+	D3D11RenderDevice(const D3D11RenderDevice& other) = delete;
+	D3D11RenderDevice(D3D11RenderDevice&& other) noexcept = delete;
+	auto operator=(const D3D11RenderDevice& other) -> D3D11RenderDevice = delete;
+	auto operator=(D3D11RenderDevice&& other) -> D3D11RenderDevice& = delete;
+	~D3D11RenderDevice() override = default;
+
+	auto Initialize(const HWND& hwnd, const GraphicSettings& settings) -> HRESULT override;
+	void Shutdown() override;
+	auto Refresh(const GraphicSettings& settings) -> HRESULT override;
+	void Present() override;
+
+	auto CreateBuffer(BufferUsage usage, uint32_t size, Handle& handle) -> HRESULT override;
+	void UpdateBuffer(Handle buffer, uint32_t offset, const void* data, uint32_t size) override;
+	void CopyBuffer(
+		Handle dst, uint32_t dst_offset, Handle src, uint32_t src_offset, uint32_t size
+	) override;
+	auto CreateTexture(
+		const TextureDesc& desc, const std::vector<SubresourceData>& subresources,
+		bool as_array, Handle& handle
+	) -> HRESULT override;
+	auto CreateRenderTarget(uint32_t width, uint32_t height, Handle& handle)
+		-> HRESULT override;
+	auto CreateDepthArray(uint32_t size, uint32_t slices, Handle& handle) -> HRESULT override;
+	auto CreateShader(ShaderStage stage, const std::vector<uint8_t>& bytecode, Handle& handle)
+		-> HRESULT override;
+	auto CreateInputLayout(
+		const std::vector<VertexElement>& elements, const std::vector<uint8_t>& bytecode,
+		Handle& handle
+	) -> HRESULT override;
+	void Release(Handle handle) override;
+
+	[[nodiscard]] auto GetBackBuffer() const -> Handle override;
+	[[nodiscard]] auto UsesBytecode() const -> bool override;
+	[[nodiscard]] auto GetVideoMemory() const -> size_t override;
+	[[nodiscard]] auto GetSupportedResolutions() const
+		-> const std::vector<std::tuple<uint16_t, uint16_t>>& override;
+
+	[[nodiscard]] auto GetDevice() const -> ID3D11Device*;
+	[[nodiscard]] auto GetDeviceContext() const -> ID3D11DeviceContext*;
+
+	[[nodiscard]] auto GetBuffer(Handle handle) const -> ID3D11Buffer*;
+	/**
+	 * Returns the view shaders sample a texture, render target or depth array through.
+	 */
+	[[nodiscard]] auto GetShaderResourceView(Handle handle) const -> ID3D11ShaderResourceView*;
+	/**
+	 * Returns the color view of a render target, \c nullptr for a depth array.
+	 */
+	[[nodiscard]] auto GetRenderTargetView(Handle handle) const -> ID3D11RenderTargetView*;
+	/**
+	 * Returns the depth view of a render target or of one slice of a depth array.
+	 */
+	[[nodiscard]] auto GetDepthStencilView(Handle handle, uint32_t slice = 0) const
+		-> ID3D11DepthStencilView*;
+
+	/**
+	 * Binds a shader or an input layout to its stage.
+	 */
+	void BindShader(ID3D11DeviceContext* device_context, Handle handle) const;
+
+	/**
+	 * Clears the stage a shader or an input layout is bound to.
+	 */
+	void UnbindShader(ID3D11DeviceContext* device_context, Handle handle) const;
+
+	/**
+	 * See \c Direct3D::ApplyRenderState.
+	 */
+	void ApplyRenderState(ID3D11DeviceContext* device_context);
+	[[nodiscard]] auto SupportsCommandLists() const -> bool;
+	void TurnZBufferOn();
+	void TurnZBufferOff();
+
+	/**
+	 * Creates \p count deferred contexts, none if one of them fails.
+	 */
+	auto CreateDeferredContexts(size_t count) -> HRESULT;
+	[[nodiscard]] auto GetDeferredContextCount() const -> size_t;
+	[[nodiscard]] auto GetDeferredContext(size_t idx) const -> ID3D11DeviceContext*;
+
+	/**
+	 * Ends the recording of a deferred context, its commands run with the next
+	 * \c ExecuteCommandLists.
+	 */
+	auto FinishCommandList(size_t idx) -> HRESULT;
+
+	/**
+	 * Executes the finished command lists in the order of their contexts.
+	 */
+	void ExecuteCommandLists();
+
+private:
+	enum class Kind : uint8_t
+	{
+		Free = 0,
+		Buffer,
+		Texture,
+		RenderTarget,
+		DepthArray,
+		VertexShader,
+		PixelShader,
+		InputLayout
+	};
+
+	struct Resource
+	{
+		Kind kind{ Kind::Free };
+		// Buffer, shader or input layout, the views keep the textures alive
+		Microsoft::WRL::ComPtr<ID3D11DeviceChild> object{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shader_resource_view{ nullptr };
+		Microsoft::WRL::ComPtr<ID3D11RenderTargetView> render_target_view{ nullptr };
+		std::vector<Microsoft::WRL::ComPtr<ID3D11DepthStencilView>> depth_stencil_views{};
+	};
+
+	auto Store(Resource&& resource) -> Handle;
+
+	/**
+	 * Points the back buffer handle to the current views of \c Direct3D.
+	 */
+	void UpdateBackBuffer();
+
+	std::unique_ptr<Direct3D> m_direct3d{ nullptr };
+
+	std::vector<Resource> m_resources{};
+	std::vector<Handle> m_free_handles{};
+	Handle m_back_buffer{ NO_RESOURCE };
+
+	std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext>> m_deferred_contexts{};
+	std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>> m_command_lists{};
+};
+
+} // namespace graphics
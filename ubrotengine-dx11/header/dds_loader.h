@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: dds_loader.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_types.h"
+
+
+namespace io
+{
+
+/**
+ * Description of a 2D texture stored in a DDS file, the same that creates the texture.
+ */
+using DdsInfo = graphics::TextureDesc;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: DdsLoader
+/// Reads DDS files with 2D textures, texture arrays and cubemaps including their mip chains.
+/// Supported are the block-compressed formats BC1 to BC7 as well as common uncompressed
+/// formats. The data is never converted: the subresources point directly into the file
+/// memory and are handed to \c RenderDevice::CreateTexture as they are.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class DdsLoader
+{
+
+public:
+	DdsLoader() = delete;
+
+	/**
+	 * Parses the header and computes the location and pitch of every subresource. The order
+	 * of \p subresources is the Direct3D order (mip levels of the first slice, then of the
+	 * second slice and so on), which equals the order in the file.
+	 * @param data the content of the file, has to outlive \p subresources
+	 * @param size the size of the file in bytes
+	 * @return false if the file is not a valid DDS file or uses an unsupported layout
+	 */
+	static auto Parse(
+		const uint8_t* data, size_t size, DdsInfo& info,
+		std::vector<graphics::SubresourceData>& subresources
+	) -> bool;
+
+	/**
+	 * Computes the memory layout of one mip level.
+	 * @param row_pitch receives the bytes per row (per row of 4x4 blocks for BC formats)
+	 * @param row_count receives the number of rows (block rows for BC formats)
+	 * @return false if the format is not supported
+	 */
+	static auto GetSurfaceInfo(
+		uint32_t width, uint32_t height, graphics::TextureFormat format,
+		uint32_t& row_pitch, uint32_t& row_count
+	) -> bool;
+
+	/**
+	 * Writes a DDS file with a DX10 header, the counterpart of \c Parse.
+	 * @param data all subresources in Direct3D order without padding between rows
+	 * @param file receives the complete file
+	 */
+	static void Write(
+		const DdsInfo& info, const uint8_t* data, size_t size, std::vector<uint8_t>& file
+	);
+
+private:
+	/**
+	 * Returns the size of a 4x4 block for BC formats or 0 for other formats.
+	 */
+	static auto GetBlockBytes(graphics::TextureFormat format) -> uint32_t;
+	static auto GetBitsPerPixel(graphics::TextureFormat format) -> uint32_t;
+};
+
+} // namespace io
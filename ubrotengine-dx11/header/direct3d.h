@@ -118,6 +118,7 @@ public:
 	 * @return card_name
 	 */
 	[[nodiscard]] auto GetVideoCardName() const -> std::wstring;
+	[[nodiscard]] auto GetRenderTargetView() const -> ID3D11RenderTargetView*;
 	[[nodiscard]] auto GetDepthStencilView() const -> ID3D11DepthStencilView*;
 
 	auto GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&;
@@ -128,6 +129,20 @@ public:
 	 */
 	void SetBackBufferRenderTarget();
 
+	/**
+	 * Binds the back buffer, the depth buffer, the enabled z-buffer state, the default
+	 * raster state and the viewport to \p device_context. Deferred contexts start without
+	 * any state, so this has to be called before recording draws into them.
+	 * @param device_context immediate or deferred context
+	 */
+	void ApplyRenderState(ID3D11DeviceContext* device_context);
+
+	/**
+	 * Returns whether the driver natively supports command lists, i.e. whether recording
+	 * into deferred contexts is faster than using the immediate context alone.
+	 */
+	[[nodiscard]] auto SupportsCommandLists() const -> bool;
+
 	/* Utility functions for settings */
 	void TurnZBufferOn();
 	void TurnZBufferOff();
@@ -142,6 +157,18 @@ public:
 	void ResetViewport();
 
 private:
+	/**
+	 * Creates the device on the first adapter with a swap chain for \p hwnd and the render
+	 * target view of its back buffer, and collects the display modes of the first output.
+	 */
+	auto CreateDeviceAndSwapChain(const HWND& hwnd, const GraphicSettings& settings)
+		-> HRESULT;
+
+	/**
+	 * Resizes the swap chain and creates the render target view of its new back buffer.
+	 */
+	auto ResizeSwapChain(const GraphicSettings& settings) -> HRESULT;
+
 	[[nodiscard]] auto CreateSwapChainDesc(
 		const HWND & hwnd,
 		uint16_t window_width, uint16_t window_height
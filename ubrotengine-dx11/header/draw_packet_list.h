@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: draw_packet_list.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: DrawPacketList
+/// Flat per-frame list of everything that has to be drawn. The list is filled by the gather
+/// stage of the renderer and consumed by the submit stage. All packet attributes are stored
+/// as separate arrays (SoA) so that each stage only touches the data it needs. The list is
+/// cleared but never shrunk, such that it can be reused across frames without reallocating.
+///
+/// All views of a frame share one list, so an object that is visible in several views
+/// stores its world matrix once. The view is the most significant part of the sort key,
+/// after sorting the packets of each view form one contiguous range, its draw list.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class DrawPacketList
+{
+
+public:
+	// The sort key has room for this many views
+	static constexpr size_t MAX_VIEWS = 16;
+	// Programs, texture arrays and models the sort key tells apart. Larger indices are
+	// clamped to the last value of their field, their packets still draw correctly but are
+	// no longer grouped by that part of the key.
+	static constexpr size_t MAX_SORT_PROGRAMS = 256;
+	static constexpr size_t MAX_SORT_TEXTURE_ARRAYS = 256;
+	static constexpr size_t MAX_SORT_MODELS = 65536;
+
+	DrawPacketList() = default;
+	DrawPacketList(const DrawPacketList& other) = delete;
+	DrawPacketList(DrawPacketList&& other) noexcept = delete;
+	auto operator=(const DrawPacketList& other) -> DrawPacketList = delete;
+	auto operator=(DrawPacketList&& other) -> DrawPacketList& = delete;
+	~DrawPacketList() = default;
+
+	/**
+	 * Builds a sort key which orders packets by view, then by shader program, then by texture
+	 * array, then by model and then front to back by the given view depth.
+	 * @param view_order position of the view in the frame, the views are drawn in this order,
+	 *        below \c MAX_VIEWS
+	 * @param program_idx index of the shader program, see \c MAX_SORT_PROGRAMS
+	 * @param texture_array_idx texture array the model samples, see \c TextureLocation and
+	 *        \c MAX_SORT_TEXTURE_ARRAYS
+	 * @param model_idx index of the model in the asset manager, see \c MAX_SORT_MODELS
+	 * @param depth distance to the camera (only positive values are meaningful)
+	 * @return sort key where a smaller value is drawn first
+	 */
+	static auto MakeSortKey(
+		size_t view_order, size_t program_idx, uint32_t texture_array_idx, size_t model_idx,
+		float depth
+	) -> uint64_t;
+
+	/**
+	 * Removes all packets and matrices but keeps the allocated memory.
+	 */
+	void Clear();
+
+	void Reserve(size_t packet_count);
+
+	/**
+	 * Stores a world matrix and returns its index, which can be used by one or more packets.
+	 */
+	auto AddWorldMatrix(const math::Float4x4& world_matrix) -> uint32_t;
+
+	/**
+	 * Appends a packet and returns its index.
+	 */
+	auto Add(
+		uint8_t view_idx, size_t model_idx, size_t program_idx, uint32_t matrix_idx,
+		uint64_t sort_key
+	) -> size_t;
+
+	/**
+	 * Sorts the draw order by the packet sort keys. The packet arrays themselves are not
+	 * moved, only \a m_order is rearranged.
+	 */
+	void Sort();
+
+	[[nodiscard]] auto Size() const -> size_t;
+	[[nodiscard]] auto Empty() const -> bool;
+
+	/**
+	 * Returns the packet indices in the order in which they should be submitted.
+	 * Only valid after \c Sort was called.
+	 */
+	[[nodiscard]] auto GetOrder() const -> const std::vector<uint32_t>&;
+
+	[[nodiscard]] auto GetViewIndices() const -> const std::vector<uint8_t>&;
+	[[nodiscard]] auto GetModelIndices() const -> const std::vector<size_t>&;
+	[[nodiscard]] auto GetProgramIndices() const -> const std::vector<size_t>&;
+	[[nodiscard]] auto GetMatrixIndices() const -> const std::vector<uint32_t>&;
+	[[nodiscard]] auto GetSortKeys() const -> const std::vector<uint64_t>&;
+	[[nodiscard]] auto GetWorldMatrix(uint32_t matrix_idx) const -> const math::Float4x4&;
+	[[nodiscard]] auto GetWorldMatrices() const -> const std::vector<math::Float4x4>&;
+
+private:
+	std::vector<uint8_t> m_view_idx{};
+	std::vector<size_t> m_model_idx{};
+	std::vector<size_t> m_program_idx{};
+	std::vector<uint32_t> m_matrix_idx{};
+	std::vector<uint64_t> m_sort_key{};
+
+	std::vector<math::Float4x4> m_world_matrices{};
+	std::vector<uint32_t> m_order{};
+
+};
+
+} // namespace graphics
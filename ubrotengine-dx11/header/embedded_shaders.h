@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: embedded_shaders.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "shader_cache.h"
+
+
+namespace graphics
+{
+
+/**
+ * Bytecode that was compiled ahead of time and built into the binary. The strings are the
+ * parts of the \c ShaderCompileDesc it was compiled from, see \c EmbeddedShaderTable::GetKey.
+ */
+struct EmbeddedShader
+{
+	// File name without the directory
+	const char* name;
+	const char* entry_point;
+	const char* target;
+	// "NAME=VALUE;" for every define, in the order they were passed
+	const char* defines;
+	const uint8_t* bytecode;
+	size_t size;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: EmbeddedShaderTable
+/// Finds embedded bytecode for a compile description, so a shader that was compiled by the
+/// \c shaders tool needs neither its source file nor the compiler. Only the file name is part
+/// of the key, the directory the shaders are loaded from does not matter.
+///
+/// The table only points to the shaders, they have to outlive it. Usually they are the
+/// constant arrays of a generated header.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class EmbeddedShaderTable
+{
+
+public:
+	EmbeddedShaderTable() = default;
+	EmbeddedShaderTable(const EmbeddedShader* shaders, size_t count);
+	EmbeddedShaderTable(const EmbeddedShaderTable& other) = delete;
+	EmbeddedShaderTable(EmbeddedShaderTable&& other) noexcept = delete;
+	auto operator=(const EmbeddedShaderTable& other) -> EmbeddedShaderTable = delete;
+	auto operator=(EmbeddedShaderTable&& other) -> EmbeddedShaderTable& = delete;
+	~EmbeddedShaderTable() = default;
+
+	/**
+	 * Returns the shader compiled from \p desc or a nullptr if none was embedded.
+	 * The compile flags are not compared, the tool compiles with the flags of the engine.
+	 */
+	[[nodiscard]] auto Find(const ShaderCompileDesc& desc) const -> const EmbeddedShader*;
+
+	[[nodiscard]] auto GetSize() const -> size_t;
+
+	static auto GetKey(const ShaderCompileDesc& desc) -> std::string;
+	static auto GetKey(const EmbeddedShader& shader) -> std::string;
+	/**
+	 * Joins the defines the way they are stored in \c EmbeddedShader::defines.
+	 */
+	static auto JoinDefines(const std::vector<ShaderDefine>& defines) -> std::string;
+
+private:
+	std::unordered_map<std::string, const EmbeddedShader*> m_shaders{};
+};
+
+} // namespace graphics
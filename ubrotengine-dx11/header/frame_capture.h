@@ -0,0 +1,229 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: frame_capture.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "graphic_settings.h"
+#include "lz_codec.h"
+#include "mapped_file.h"
+#include "scene_input.h"
+
+
+namespace graphics
+{
+
+/**
+ * A capture file consists of, all values little endian:
+ *	- the CaptureHeader
+ *	- one record after another, each one a CaptureRecord followed by its payload
+ * Setup records repeat the calls of the \c Engine that change the settings or register
+ * assets, in the order they were made. Their payload is a count and the strings (each one a
+ * length and its characters) followed by a count and the 32 bit values:
+ *	- Settings: the settings as written by their operator<<
+ *	- MountArchive, Model: the filename
+ *	- ProceduralModel: the procedural number
+ *	- Texture: the filename and the components
+ *	- Models: the filenames
+ *	- Textures: the filenames and the components
+ *	- ModelTexture: the model and the texture index
+ * The payload of a frame record is a CaptureFrame, the packed size of every block and the
+ * blocks. Unpacked, the frame is the number of users, tiles and objects followed by the
+ * arrays of the \c SceneInput. If the previous frame had the same size it is XORed with it
+ * first, so everything that did not move packs down to almost nothing.
+ */
+struct CaptureHeader
+{
+	uint32_t magic{ 0 };
+	uint32_t version{ 0 };
+};
+
+enum class CaptureRecordType : uint32_t
+{
+	Settings = 0,
+	MountArchive,
+	Model,
+	ProceduralModel,
+	Texture,
+	Models,
+	Textures,
+	ModelTexture,
+	Frame,
+	NUMBER
+};
+
+struct CaptureRecord
+{
+	CaptureRecordType type{ CaptureRecordType::NUMBER };
+	// Size of the payload that follows
+	uint32_t size{ 0 };
+};
+
+struct CaptureFrame
+{
+	uint32_t unpacked_size{ 0 };
+	// Not 0 if the frame is XORed with the previous one
+	uint32_t delta{ 0 };
+	uint32_t block_count{ 0 };
+};
+
+/**
+ * A record read by \c CaptureReader. Setup records fill the strings and values, frame
+ * records the frame.
+ */
+struct CaptureEntry
+{
+	CaptureRecordType type{ CaptureRecordType::NUMBER };
+	std::vector<std::string> strings{};
+	std::vector<uint32_t> values{};
+	SceneInput frame{};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: CaptureWriter
+/// Writes the inputs of every frame and the asset registrations into a capture file, which
+/// \c CaptureReader reads for an offline replay. The writer sees every setup call from
+/// startup on and keeps their records, so a capture that starts in the middle of a session
+/// still registers the same assets in the same order and gets the same indices.
+///
+/// Frames are packed with the \c LzCodec in blocks of \c BLOCK_SIZE on the calling thread.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CaptureWriter
+{
+
+public:
+	static constexpr uint32_t MAGIC = 0x50434255; // "UBCP"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr size_t BLOCK_SIZE = io::LzCodec::MAX_BLOCK_SIZE;
+
+	struct Stats
+	{
+		size_t frames{ 0 };
+		// Size of the frames before packing
+		uint64_t frame_bytes{ 0 };
+		// Size of the capture file
+		uint64_t file_bytes{ 0 };
+	};
+
+	CaptureWriter() = default;
+	CaptureWriter(const CaptureWriter& other) = delete;
+	CaptureWriter(CaptureWriter&& other) noexcept = delete;
+	auto operator=(const CaptureWriter& other) -> CaptureWriter = delete;
+	auto operator=(CaptureWriter&& other) -> CaptureWriter& = delete;
+	~CaptureWriter() = default;
+
+	/**
+	 * Starts a capture, a running one is closed first. The file starts with all setup
+	 * records so far.
+	 */
+	auto Open(const std::string& filename) -> bool;
+	void Close();
+	[[nodiscard]] auto IsOpen() const -> bool;
+
+	/**
+	 * Setup records are kept and, during a capture, written right away.
+	 */
+	void AddSettings(const GraphicSettings& settings);
+	void AddArchive(const std::string& filename);
+	void AddModel(const std::string& filename);
+	void AddProceduralModel(uint8_t num);
+	void AddTexture(const std::string& filename, uint8_t components);
+	void AddModels(const std::vector<std::string>& filenames);
+	void AddTextures(const std::vector<std::string>& filenames, uint8_t components);
+	void AddModelTexture(size_t model_idx, size_t texture_idx);
+
+	/**
+	 * Writes a frame, ignored if no capture is running.
+	 * @return false if writing failed
+	 */
+	auto AddFrame(const SceneInput& input) -> bool;
+
+	/**
+	 * Returns the counters of the current or last capture.
+	 */
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	void AddSetup(
+		CaptureRecordType type, const std::vector<std::string>& strings,
+		const std::vector<uint32_t>& values
+	);
+
+	std::ofstream m_stream{};
+
+	// All setup records since startup, as they are written into the file
+	std::vector<uint8_t> m_setup{};
+
+	// Reused by every frame
+	std::vector<uint8_t> m_frame{};
+	std::vector<uint8_t> m_previous_frame{};
+	std::vector<uint8_t> m_packed{};
+	std::vector<uint32_t> m_block_sizes{};
+
+	Stats m_stats{};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: CaptureReader
+/// Reads the records of a capture file written by \c CaptureWriter one after another. The
+/// file is mapped, so only the frame that is read is unpacked.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CaptureReader
+{
+
+public:
+	CaptureReader() = default;
+	CaptureReader(const CaptureReader& other) = delete;
+	CaptureReader(CaptureReader&& other) noexcept = delete;
+	auto operator=(const CaptureReader& other) -> CaptureReader = delete;
+	auto operator=(CaptureReader&& other) -> CaptureReader& = delete;
+	~CaptureReader() = default;
+
+	/**
+	 * Maps the capture and checks its header.
+	 * @return false if the file can not be mapped or is no capture of this version
+	 */
+	auto Open(const std::string& filename) -> bool;
+	void Close();
+
+	/**
+	 * Reads the next record into \p entry.
+	 * @return false at the end of the file or if the record is corrupt, see \c AtEnd
+	 */
+	auto Next(CaptureEntry& entry) -> bool;
+
+	/**
+	 * Starts reading from the first record again.
+	 */
+	void Rewind();
+
+	/**
+	 * Returns true if all records were read.
+	 */
+	[[nodiscard]] auto AtEnd() const -> bool;
+
+private:
+	auto ReadSetup(const uint8_t* data, size_t size, CaptureEntry& entry) const -> bool;
+	auto ReadFrame(const uint8_t* data, size_t size, SceneInput& frame) -> bool;
+
+	io::MappedFile m_file{};
+	size_t m_offset{ 0 };
+
+	std::vector<uint8_t> m_frame{};
+	std::vector<uint8_t> m_previous_frame{};
+};
+
+} // namespace graphics
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: frame_stats.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstddef>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "draw_packet_list.h"
+#include "shadow_cascades.h"
+
+
+namespace graphics
+{
+
+/**
+ * CPU timings and counters of the last rendered frame. Times are in milliseconds.
+ */
+struct FrameStats
+{
+	// Copying the inputs out of the scene, 0 for frames rendered from a SceneInput
+	double read_ms{ 0.0 };
+	double gather_ms{ 0.0 };
+	double submit_ms{ 0.0 };
+	// Parts of the submit stage
+	double record_ms{ 0.0 };
+	double replay_ms{ 0.0 };
+
+	size_t draw_packets{ 0 };
+	size_t command_threads{ 0 };
+	size_t command_bytes{ 0 };
+	bool deferred_contexts{ false };
+	// Whether a camera moved or its projection changed this frame, see Camera
+	bool camera_changed{ false };
+
+	// Split screen views, objects that were gathered once and tested against all of them,
+	// and the objects that were visible in at least one view, see ViewCuller
+	size_t views{ 0 };
+	size_t gathered_objects{ 0 };
+	size_t visible_objects{ 0 };
+	// Draw packets of each view, their sum is draw_packets. The planar reflection is the view
+	// after the split screen views.
+	std::array<size_t, DrawPacketList::MAX_VIEWS> view_draw_packets{};
+	// Draw packets of the split screen views together and of the planar reflection, see
+	// Renderer::SetReflectionPlane
+	size_t main_draw_packets{ 0 };
+	size_t reflection_draw_packets{ 0 };
+	// Objects that cast a shadow into each cascade, and the draw packets of the cascades
+	// that were rendered, see ShadowCascades. The views of the cascades follow the planar
+	// reflection. Cached cascades that were reused or rendered again are totals since startup.
+	std::array<size_t, ShadowCascades::CASCADE_COUNT> shadow_casters{};
+	size_t shadow_draw_packets{ 0 };
+	size_t shadow_rendered_cascades{ 0 };
+	size_t shadow_cache_hits{ 0 };
+	size_t shadow_cache_misses{ 0 };
+
+	// Vertex and index buffer binds issued during replay, and the number of binds the
+	// same frame would have needed with separate buffers per model
+	size_t buffer_binds{ 0 };
+	size_t buffer_binds_per_model{ 0 };
+
+	// Texture array binds issued during replay, and the number of binds the same frame
+	// would have needed with one shader resource per texture
+	size_t texture_binds{ 0 };
+	size_t texture_binds_per_texture{ 0 };
+
+	// Shader and input layout binds issued during replay, and the number of binds the same
+	// frame would have needed if every draw bound its whole program
+	size_t shader_binds{ 0 };
+	size_t shader_binds_per_draw{ 0 };
+
+	// Triangles of the software backend, the ones that were binned after culling and
+	// clipping, their tile bin entries and the draws it could not draw, see
+	// SoftwareRasterizer. The setup and raster times are parts of the replay stage.
+	size_t software_triangles{ 0 };
+	size_t software_visible_triangles{ 0 };
+	size_t software_bin_entries{ 0 };
+	size_t software_skipped_draws{ 0 };
+	double software_setup_ms{ 0.0 };
+	double software_raster_ms{ 0.0 };
+
+	// Shader objects on the device, and the objects saved by sharing them between programs,
+	// see ShaderRegistry
+	size_t shader_objects{ 0 };
+	size_t shared_shader_objects{ 0 };
+	// Shader program variants, see ShaderManager. Draws that used a fallback or were skipped
+	// while their variant compiled, and updates that stalled a frame, are totals since startup
+	size_t shader_variants{ 0 };
+	size_t pending_shader_variants{ 0 };
+	size_t shader_fallback_draws{ 0 };
+	size_t shader_skipped_draws{ 0 };
+	size_t shader_hitches{ 0 };
+
+	// Texture packing, see TexturePacker
+	size_t textures{ 0 };
+	size_t texture_arrays{ 0 };
+	size_t atlas_pages{ 0 };
+	float atlas_occupancy{ 0.0F };
+
+	// Shared geometry buffers, see GeometryPool
+	size_t geometry_bytes{ 0 };
+	size_t geometry_capacity_bytes{ 0 };
+	float geometry_fragmentation{ 0.0F };
+	size_t defrag_bytes{ 0 };
+
+	// Model residency, the evicted and reloaded counts are totals since startup
+	size_t model_budget_bytes{ 0 };
+	size_t resident_model_bytes{ 0 };
+	size_t resident_models{ 0 };
+	size_t evicted_models{ 0 };
+	size_t reloaded_models{ 0 };
+
+	// Texture mip streaming, the loaded and evicted counts are totals since startup
+	size_t texture_budget_bytes{ 0 };
+	size_t resident_texture_bytes{ 0 };
+	size_t pending_texture_bytes{ 0 };
+	size_t streamed_textures{ 0 };
+	size_t loaded_mips{ 0 };
+	size_t evicted_mips{ 0 };
+};
+
+} // namespace graphics
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: geometry_buffer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_device.h"
+#include "tlsf_allocator.h"
+#include "vertex_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: GeometryBuffer
+/// A single large GPU buffer whose elements are handed out as ranges by a \c TlsfAllocator.
+/// When no free range is large enough, a buffer with twice the capacity is created and the
+/// old content is copied over on the GPU. Freed ranges fragment the buffer over time, which
+/// \c Defragment compacts a bounded amount at a time.
+///
+/// The buffer can keep a CPU copy that mirrors the GPU content at the same offsets, for
+/// backends that read the geometry on the CPU.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class GeometryBuffer
+{
+
+public:
+	using Handle = utils::TlsfAllocator::Handle;
+
+	/**
+	 * @param usage either \c BufferUsage::Vertex or \c BufferUsage::Index
+	 * @param element_size size of one vertex or index in bytes
+	 */
+	GeometryBuffer(BufferUsage usage, uint32_t element_size);
+
+	/**
+	 * Allocates a range of \p element_count elements and copies \p data into it.
+	 * @param user_data value reported with the range when it is moved by \c Defragment
+	 * @param handle receives the handle of the range
+	 */
+	auto Allocate(
+		RenderDevice& device, const void* data, uint32_t element_count, uint32_t user_data,
+		Handle& handle
+	) -> HRESULT;
+
+	void Free(Handle handle);
+
+	/**
+	 * Moves up to \p max_elements elements towards the start of the buffer, such that free
+	 * ranges are merged at the end.
+	 * @param moves receives the moved ranges, the caller has to update their users
+	 */
+	void Defragment(
+		RenderDevice& device, uint32_t max_elements,
+		std::vector<utils::TlsfAllocator::Move>& moves
+	);
+
+	/**
+	 * Releases the GPU buffer, all ranges are freed.
+	 */
+	void Release(RenderDevice& device);
+
+	[[nodiscard]] auto GetBuffer() const -> RenderDevice::Handle;
+	[[nodiscard]] auto GetElementSize() const -> uint32_t;
+	[[nodiscard]] auto GetOffset(Handle handle) const -> uint32_t;
+	[[nodiscard]] auto GetStats() const -> utils::TlsfAllocator::Stats;
+
+	void SetUserData(Handle handle, uint32_t user_data);
+
+	/**
+	 * Mirrors all later writes in a CPU copy, has to be called before the first allocation.
+	 */
+	void KeepCpuCopy();
+
+	/**
+	 * Returns the CPU copy of the buffer or \c nullptr if none is kept.
+	 */
+	[[nodiscard]] auto GetCpuCopy() const -> const uint8_t*;
+
+private:
+	auto Grow(RenderDevice& device, uint32_t min_capacity) -> HRESULT;
+
+	RenderDevice::Handle m_buffer{ RenderDevice::NO_RESOURCE };
+	std::vector<uint8_t> m_cpu_copy{};
+	bool m_keep_cpu_copy{ false };
+	utils::TlsfAllocator m_allocator{};
+
+	BufferUsage m_usage;
+	uint32_t m_element_size;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: GeometryPool
+/// Owns one shared vertex buffer per vertex stride and one shared index buffer (32 bit).
+/// Models are stored as ranges inside these buffers, so drawing different models only
+/// requires rebinding buffers if their vertex stride differs.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class GeometryPool
+{
+
+public:
+	/**
+	 * Memory usage of all buffers of the pool.
+	 */
+	struct Stats
+	{
+		size_t capacity_bytes{ 0 };
+		size_t used_bytes{ 0 };
+		size_t largest_free_bytes{ 0 };
+		size_t free_blocks{ 0 };
+
+		/**
+		 * Share of the free memory which is not part of the largest free range of its
+		 * buffer, 0 means that no buffer is fragmented.
+		 */
+		float fragmentation{ 0.0F };
+	};
+
+	/**
+	 * Uploads the vertices and indices and stores the resulting ranges and the bounding
+	 * radius of the vertices in \p model.
+	 */
+	template <class T>
+	auto Add(
+		RenderDevice& device,
+		vertices::Model& model,
+		const std::vector<T>& vertices,
+		const std::vector<uint32_t>& indices
+	) -> HRESULT;
+
+	/**
+	 * Releases the ranges of \p model.
+	 */
+	void Remove(vertices::Model& model);
+
+	/**
+	 * Sets the value that \c Defragment reports as owner of the ranges of \p model.
+	 */
+	void SetOwner(const vertices::Model& model, uint32_t owner);
+
+	/**
+	 * Compacts all buffers by moving at most \p max_bytes in total and updates
+	 * \p models, which are indexed by the owner set with \c SetOwner.
+	 * @return number of bytes that were moved
+	 */
+	auto Defragment(
+		RenderDevice& device, size_t max_bytes, std::vector<vertices::Model>& models
+	) -> size_t;
+
+	/**
+	 * Releases all buffers, the ranges of all models are invalid afterwards.
+	 */
+	void Release(RenderDevice& device);
+
+	/**
+	 * Returns the shared vertex buffer for \p stride or \c NO_RESOURCE if no model with this
+	 * stride was added yet.
+	 */
+	[[nodiscard]] auto GetVertexBuffer(uint32_t stride) const -> RenderDevice::Handle;
+	[[nodiscard]] auto GetIndexBuffer() const -> RenderDevice::Handle;
+
+	/**
+	 * Keeps a CPU copy of every buffer, so the geometry can be read back with
+	 * \c GetVertexData and \c GetIndexData. Has to be called before the first model is added.
+	 */
+	void KeepCpuCopies();
+
+	/**
+	 * Returns the CPU copy of the vertex buffer for \p stride, a model's vertices start at
+	 * its \c baseVertex. \c nullptr if no copies are kept or no model has the stride.
+	 */
+	[[nodiscard]] auto GetVertexData(uint32_t stride) const -> const uint8_t*;
+	[[nodiscard]] auto GetIndexData() const -> const uint32_t*;
+
+	/**
+	 * Returns the number of GPU buffers in use (all vertex buffers plus the index buffer).
+	 */
+	[[nodiscard]] auto GetBufferCount() const -> size_t;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	std::map<uint32_t, GeometryBuffer> m_vertex_buffers{};
+	GeometryBuffer m_index_buffer{ BufferUsage::Index, sizeof(uint32_t) };
+	bool m_keep_cpu_copies{ false };
+
+	std::vector<utils::TlsfAllocator::Move> m_moves{};
+};
+
+} // namespace graphics
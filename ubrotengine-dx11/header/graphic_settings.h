@@ -7,17 +7,35 @@
 //////////////
 // INCLUDES //
 //////////////
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "platform.h"
 
 
 namespace graphics
 {
 
+/**
+ * Where the renderer sends its commands. Every backend runs the same CPU stages.
+ */
+enum class RenderBackend : uint32_t
+{
+	// Draws with Direct3D into the window
+	D3D11 = 0,
+	// Discards the commands, runs without a window or a GPU
+	Null,
+	// Like Null, but logs every command of a frame, see Renderer::GetRecordedCommands
+	Recording,
+	// Draws on the CPU into an image, see Renderer::GetSoftwareFrame
+	Software,
+	NUMBER
+};
+
 struct GraphicSettings
 {
 	BOOL fullscreen{ TRUE };
@@ -29,6 +47,21 @@ struct GraphicSettings
 	uint16_t window_width{ 1920 };
 	uint16_t window_height{ 1080 };
 
+	// GPU memory for models in MB, 0 derives it from the video memory of the adapter
+	uint32_t model_memory_mb{ 0 };
+	// GPU memory for streamed textures in MB, 0 derives it from the video memory
+	uint32_t texture_memory_mb{ 0 };
+
+	// Users that share the window, each one gets a part of the screen
+	uint32_t split_screen_views{ 1 };
+	// Resolution of the planar reflection relative to a view, in (0, 1]
+	float reflection_scale{ 0.5F };
+	// Width and height of each shadow cascade in texels
+	uint32_t shadow_map_size{ 2048 };
+
+	// Selected once when the renderer is initialized
+	RenderBackend render_backend{ RenderBackend::D3D11 };
+
 	GraphicSettings() = default;
 	GraphicSettings(const GraphicSettings& other) = delete;
 	GraphicSettings(GraphicSettings&& other) noexcept = delete;
@@ -42,7 +75,10 @@ struct GraphicSettings
 	{
 		return os << settings.fullscreen << ' ' << settings.v_sync
 			<< ' ' << settings.screen_near << ' ' << settings.screen_depth
-			<< ' ' << settings.window_width << ' ' << settings.window_height;
+			<< ' ' << settings.window_width << ' ' << settings.window_height
+			<< ' ' << settings.model_memory_mb << ' ' << settings.texture_memory_mb
+			<< ' ' << settings.split_screen_views << ' ' << settings.reflection_scale
+			<< ' ' << settings.shadow_map_size << ' ' << uint32_t(settings.render_backend);
 	};
 
 	friend std::istream& operator>>(std::istream& os, graphics::GraphicSettings& settings)
@@ -53,6 +89,16 @@ struct GraphicSettings
 		os >> settings.screen_depth;
 		os >> settings.window_width;
 		os >> settings.window_height;
+		os >> settings.model_memory_mb;
+		os >> settings.texture_memory_mb;
+		os >> settings.split_screen_views;
+		os >> settings.reflection_scale;
+		os >> settings.shadow_map_size;
+		uint32_t backend{ 0 };
+		os >> backend;
+		settings.render_backend = backend < uint32_t(RenderBackend::NUMBER)
+			? RenderBackend(backend)
+			: RenderBackend::D3D11;
 		return os;
 	};
 };
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: image_decoder.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "thread_pool.h"
+
+
+namespace io
+{
+
+/**
+ * Decoded image with 8 bit RGBA pixels, rows are tightly packed and start at the top.
+ */
+struct Image
+{
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	std::vector<uint8_t> pixels{};
+	// True if the color channels are sRGB encoded and should be sampled as *_SRGB format
+	bool srgb{ true };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ImageDecoder
+/// Decodes PNG and TGA files into RGBA images that can be uploaded as
+/// \c TextureFormat::R8G8B8A8_UNORM or \c TextureFormat::R8G8B8A8_UNORM_SRGB.
+///
+/// PNG row unfiltering depends on the previous row and therefore runs on one thread, it is
+/// vectorized per pixel for 3 and 4 byte pixels. The conversion to RGBA is independent per
+/// row and is split across the thread pool if one is given.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ImageDecoder
+{
+
+public:
+	// Largest width and height that is decoded, the same as for DDS textures
+	static constexpr uint32_t MAX_DIMENSION = 16384;
+
+	ImageDecoder() = delete;
+
+	/**
+	 * Decodes a non-interlaced PNG of any color type and bit depth. Critical chunks with a
+	 * wrong CRC fail the decode, ancillary ones are ignored.
+	 * @param thread_pool used for the color conversion, can be nullptr
+	 * @return false if the file is corrupt or uses an unsupported feature
+	 */
+	static auto DecodePng(
+		const uint8_t* data, size_t size, Image& image, utils::ThreadPool* thread_pool
+	) -> bool;
+
+	/**
+	 * Decodes an uncompressed or RLE compressed TGA with true color (24/32 bit),
+	 * grayscale (8 bit) or color mapped (8 bit indices) pixels.
+	 * @param thread_pool used for the color conversion, can be nullptr
+	 * @return false if the file is corrupt or uses an unsupported feature
+	 */
+	static auto DecodeTga(
+		const uint8_t* data, size_t size, Image& image, utils::ThreadPool* thread_pool
+	) -> bool;
+
+	/**
+	 * Reverses the PNG filter of one row in place.
+	 * @param filter filter type stored in front of the row (0 to 4)
+	 * @param row the filtered row, without the filter type byte
+	 * @param prior the already unfiltered previous row or nullptr for the first row
+	 * @param row_bytes size of the row in bytes
+	 * @param bpp bytes per complete pixel, rounded up to 1
+	 * @return false for an unknown filter type
+	 */
+	static auto UnfilterRow(
+		uint8_t filter, uint8_t* row, const uint8_t* prior, size_t row_bytes, uint32_t bpp
+	) -> bool;
+
+	/**
+	 * Scalar version of \c UnfilterRow, which is used for all pixel sizes that have no
+	 * vectorized path.
+	 */
+	static auto UnfilterRowScalar(
+		uint8_t filter, uint8_t* row, const uint8_t* prior, size_t row_bytes, uint32_t bpp
+	) -> bool;
+
+	/**
+	 * Reorders BGRA to RGBA, \p src and \p dst may be the same.
+	 */
+	static void SwizzleBgra(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+	/**
+	 * Scalar version of \c SwizzleBgra, which also handles the pixels behind the last vector.
+	 */
+	static void SwizzleBgraScalar(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+	/**
+	 * Expands 8 bit gray values to opaque RGBA.
+	 */
+	static void ExpandGray(const uint8_t* src, uint8_t* dst, size_t pixel_count);
+
+private:
+	/**
+	 * Runs \p fn(begin, end) over all rows, split across the thread pool if there is one.
+	 */
+	template <class Fn>
+	static void ForRows(utils::ThreadPool* thread_pool, uint32_t row_count, const Fn& fn);
+};
+
+} // namespace io
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: image_encoder.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "image_decoder.h"
+
+
+namespace io
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ImageEncoder
+/// Encodes RGBA images as PNG or binary PPM, e.g. to store frames for comparisons.
+///
+/// PNG rows use the Sub filter, which turns flat colors and gradients into runs of equal
+/// bytes. The filtered rows are compressed into a single DEFLATE block with the fixed
+/// Huffman codes and a greedy LZ77 match search, which is fast and good enough for rendered
+/// frames, but not as small as a dynamic Huffman encoder would get them.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ImageEncoder
+{
+
+public:
+	ImageEncoder() = delete;
+
+	/**
+	 * Encodes an 8 bit RGBA PNG.
+	 */
+	static auto EncodePng(const Image& image) -> std::vector<uint8_t>;
+
+	/**
+	 * Encodes a binary (P6) PPM, the alpha channel is dropped.
+	 */
+	static auto EncodePpm(const Image& image) -> std::vector<uint8_t>;
+
+	/**
+	 * Writes the image as PPM if the file ends with .ppm and as PNG otherwise.
+	 * @return false if the file can not be written
+	 */
+	static auto WriteFile(const std::string& filename, const Image& image) -> bool;
+
+	/**
+	 * Compresses \p size bytes from \p src into a zlib stream (RFC 1950), which is appended
+	 * to \p dst.
+	 */
+	static void Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst);
+};
+
+} // namespace io
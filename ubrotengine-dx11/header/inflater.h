@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: inflater.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: Inflater
+/// Decompressor for DEFLATE streams (RFC 1951), optionally wrapped in a zlib header
+/// (RFC 1950) as used by PNG. Huffman codes of up to \c FAST_BITS bits are decoded with a
+/// single table lookup, longer codes fall back to canonical decoding.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class Inflater
+{
+
+public:
+	Inflater() = delete;
+
+	/**
+	 * Decompresses \p size bytes from \p src and appends the result to \p dst.
+	 * @param zlib true if the stream starts with a zlib header and ends with an adler32
+	 *        checksum, which is verified
+	 * @return false if the stream is corrupt or truncated
+	 */
+	static auto Decompress(
+		const uint8_t* src, size_t size, std::vector<uint8_t>& dst, bool zlib
+	) -> bool;
+};
+
+} // namespace io
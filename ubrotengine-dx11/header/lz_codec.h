@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: lz_codec.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: LzCodec
+/// Byte oriented LZ77 compression in the style of LZ4, meant for blocks of up to 64 KiB.
+/// A block is a list of sequences, each one a token byte (literal length in the upper and
+/// match length in the lower 4 bits, 15 continues with 255 bytes), the literals, a 16 bit
+/// little endian match offset and is closed by a sequence with only literals.
+///
+/// There is no entropy coding, decoding is a loop of copies. The decoder copies literals and
+/// matches in 16 byte SIMD chunks and may write up to 15 bytes past a copy while it is far
+/// from the end of the output, only the last bytes are copied one by one.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class LzCodec
+{
+
+public:
+	// Inputs larger than this would need offsets that do not fit into 16 bits
+	static constexpr size_t MAX_BLOCK_SIZE = 64 * 1024;
+
+	LzCodec() = delete;
+
+	/**
+	 * Compresses \p size bytes from \p src and appends the block to \p dst.
+	 * @param size at most MAX_BLOCK_SIZE
+	 */
+	static void Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst);
+
+	/**
+	 * Decompresses a block of \p size bytes into exactly \p dst_size bytes at \p dst.
+	 * @return false if the block is corrupt or does not decode to \p dst_size bytes
+	 */
+	static auto Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size)
+		-> bool;
+
+	/**
+	 * Returns the largest possible size of a compressed block with \p size input bytes.
+	 */
+	[[nodiscard]] static auto GetBound(size_t size) -> size_t;
+};
+
+} // namespace io
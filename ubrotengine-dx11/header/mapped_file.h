@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mapped_file.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: MappedFile
+/// Read-only memory mapping of a whole file. The data stays valid until the file is closed
+/// or the object is destroyed. Pages are loaded by the OS on first access, so nothing is
+/// read or copied up front.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) noexcept = delete;
+	auto operator=(const MappedFile& other) -> MappedFile = delete;
+	auto operator=(MappedFile&& other) -> MappedFile& = delete;
+	~MappedFile();
+
+	/**
+	 * Maps the file, a previously opened file is closed first.
+	 * @return false if the file does not exist, is empty or can not be mapped
+	 */
+	auto Open(const std::string& filename) -> bool;
+	void Close();
+
+	[[nodiscard]] auto GetData() const -> const uint8_t*;
+	[[nodiscard]] auto GetSize() const -> size_t;
+
+private:
+#ifdef _WIN32
+	HANDLE m_file{ INVALID_HANDLE_VALUE };
+	HANDLE m_mapping{ nullptr };
+#else
+	int m_file{ -1 };
+#endif
+	const uint8_t* m_data{ nullptr };
+	size_t m_size{ 0 };
+};
+
+} // namespace io
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: math_types.h
+/// Vectors and matrices of the engine. The conventions are the ones of DirectXMath: positions
+/// are row vectors that are multiplied from the left (p * M), matrices are stored row major
+/// and the projections are left handed with a depth range of [0, 1]. A \c Float4x4 has the
+/// memory layout of \c XMFLOAT4X4, so the Direct3D code can load it without a conversion.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstddef>
+
+
+namespace math
+{
+
+constexpr float PI = 3.141592654F;
+
+struct Float2
+{
+	float x;
+	float y;
+
+	Float2() = default;
+	constexpr Float2(float x, float y) : x(x), y(y) {}
+};
+
+struct Float3
+{
+	float x;
+	float y;
+	float z;
+
+	Float3() = default;
+	constexpr Float3(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+struct Float4
+{
+	float x;
+	float y;
+	float z;
+	float w;
+
+	Float4() = default;
+	constexpr Float4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+struct Float4x4
+{
+	// Indexed by row and column
+	std::array<std::array<float, 4>, 4> m;
+};
+
+auto operator+(const Float3& a, const Float3& b) -> Float3;
+auto operator-(const Float3& a, const Float3& b) -> Float3;
+auto operator*(const Float3& a, float s) -> Float3;
+auto operator+(const Float4& a, const Float4& b) -> Float4;
+auto operator-(const Float4& a, const Float4& b) -> Float4;
+
+auto Dot(const Float3& a, const Float3& b) -> float;
+auto Cross(const Float3& a, const Float3& b) -> Float3;
+auto Length(const Float3& v) -> float;
+/**
+ * Returns \p v unchanged if its length is zero.
+ */
+auto Normalize(const Float3& v) -> Float3;
+
+/**
+ * Divides the plane (a, b, c, d) by the length of its normal (a, b, c).
+ */
+auto PlaneNormalize(const Float4& plane) -> Float4;
+
+auto Identity() -> Float4x4;
+/**
+ * Returns a * b, which transforms with \p a first.
+ */
+auto Multiply(const Float4x4& a, const Float4x4& b) -> Float4x4;
+auto Transpose(const Float4x4& matrix) -> Float4x4;
+/**
+ * The result is not finite if the matrix is singular.
+ */
+auto Inverse(const Float4x4& matrix) -> Float4x4;
+
+auto Row(const Float4x4& matrix, size_t row) -> Float4;
+auto Column(const Float4x4& matrix, size_t column) -> Float4;
+
+/**
+ * Transforms the point (v, 1) and divides by the resulting w.
+ */
+auto TransformCoord(const Float3& v, const Float4x4& matrix) -> Float3;
+
+auto Translation(float x, float y, float z) -> Float4x4;
+/**
+ * Same as \c XMMatrixLookToLH, \p direction and \p up do not have to be normalized.
+ */
+auto LookToLH(const Float3& eye, const Float3& direction, const Float3& up) -> Float4x4;
+auto PerspectiveFovLH(float fov_y, float aspect_ratio, float near_z, float far_z) -> Float4x4;
+auto OrthographicLH(float width, float height, float near_z, float far_z) -> Float4x4;
+
+} // namespace math
@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mip_generator.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "image_decoder.h"
+#include "thread_pool.h"
+
+
+namespace io
+{
+
+enum class MipFilter : uint8_t
+{
+	// Averages 2x2 pixels, fast but blurs and aliases slightly
+	Box = 0,
+	// Kaiser windowed sinc with 8 taps per axis, keeps more detail
+	Kaiser
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: MipGenerator
+/// Builds mip chains for RGBA images on the CPU. Filtering happens in linear space, sRGB
+/// images are converted before and after, alpha is always treated as linear.
+///
+/// Every level is computed from the previous one and split into row tiles which are
+/// filtered in parallel. The filters keep one pixel in an SSE register and process a whole
+/// source row at a time.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MipGenerator
+{
+
+public:
+	MipGenerator() = delete;
+
+	/**
+	 * Returns the number of levels of a full mip chain, including the base level.
+	 */
+	static auto GetMipCount(uint32_t width, uint32_t height) -> uint32_t;
+
+	/**
+	 * Generates all levels below \p image down to 1x1.
+	 * @param mips receives the levels without the base level, from largest to smallest
+	 * @param thread_pool used to filter the row tiles, can be nullptr
+	 */
+	static void Generate(
+		const Image& image, MipFilter filter, std::vector<Image>& mips,
+		utils::ThreadPool* thread_pool
+	);
+
+	/**
+	 * Halves the size of \p src, odd sizes are rounded down and clamp at the border.
+	 */
+	static void Downsample(
+		const Image& src, Image& dst, MipFilter filter, utils::ThreadPool* thread_pool
+	);
+
+private:
+	static void DownsampleBox(const Image& src, Image& dst, size_t begin, size_t end);
+	static void DownsampleKaiser(const Image& src, Image& dst, size_t begin, size_t end);
+};
+
+} // namespace io
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mip_streamer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: MipStreamer
+/// Decides which mip levels of streamed textures are resident. Every texture keeps its small
+/// tail levels, the more detailed levels are requested by the renderer through the screen
+/// size the texture covers and loaded in order of how much detail is missing: the load
+/// priority of a texture is the magnification of its most detailed resident level.
+///
+/// Loads are limited per frame and by a memory budget. If a load does not fit into the
+/// budget, the least valuable resident levels of other textures are evicted, but only if
+/// they would still be less magnified after the eviction than the loading texture is now,
+/// which keeps textures from evicting each other back and forth. Textures that were not
+/// requested in the current frame are evicted first.
+///
+/// The streamer only does the bookkeeping, reading the data and creating the textures is up
+/// to the owner. It does not depend on a device.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class MipStreamer
+{
+
+public:
+	struct Stats
+	{
+		std::size_t budget_bytes{ 0 };
+		std::size_t resident_bytes{ 0 };
+		// Memory reserved for loads that have not finished yet
+		std::size_t pending_bytes{ 0 };
+		std::size_t textures{ 0 };
+		// Totals since the streamer was created
+		std::size_t loaded_mips{ 0 };
+		std::size_t evicted_mips{ 0 };
+	};
+
+	/**
+	 * New most detailed resident level of a texture.
+	 */
+	struct Change
+	{
+		std::size_t texture_idx;
+		uint32_t top_mip;
+	};
+
+	/**
+	 * Registers a texture, only its tail levels count as resident.
+	 * @param size width or height of the base level, whichever is larger
+	 * @param level_bytes GPU memory of every mip level, from the base level to the smallest
+	 * @param tail_mip most detailed level that always stays resident
+	 */
+	void Add(
+		std::size_t texture_idx, uint32_t size, std::vector<std::size_t> level_bytes,
+		uint32_t tail_mip
+	);
+
+	void SetBudget(std::size_t bytes);
+
+	/**
+	 * Starts a new frame, requests of the previous frame are forgotten.
+	 */
+	void BeginFrame();
+
+	/**
+	 * Reports that the texture is drawn in this frame, multiple requests keep the largest.
+	 * @param screen_pixels number of pixels the texture covers along its larger axis
+	 */
+	void Request(std::size_t texture_idx, float screen_pixels);
+
+	/**
+	 * Chooses the levels to load and to evict in this frame.
+	 * @param max_load_bytes no more loads start once this many bytes are requested, but a
+	 *        load always gets at least one level so that large levels are not starved
+	 * @param loads receives the textures to load up to the given level, all levels down to
+	 *        the resident ones have to be loaded and reported with \c Loaded
+	 * @param evictions receives the textures whose levels above the given one have to be
+	 *        freed, this already happened for the bookkeeping. They have to be applied
+	 *        before the loads.
+	 */
+	void Update(
+		std::size_t max_load_bytes, std::vector<Change>& loads, std::vector<Change>& evictions
+	);
+
+	/**
+	 * Finishes a load returned by \c Update.
+	 * @param success false if the levels could not be loaded, their memory is released
+	 */
+	void Loaded(std::size_t texture_idx, bool success);
+
+	/**
+	 * Returns the most detailed level that is needed to draw a texture of the given size
+	 * on \p screen_pixels pixels without magnification.
+	 */
+	static auto GetDesiredMip(uint32_t size, uint32_t tail_mip, float screen_pixels)
+		-> uint32_t;
+
+	[[nodiscard]] auto GetResidentMip(std::size_t texture_idx) const -> uint32_t;
+	[[nodiscard]] auto IsLoading(std::size_t texture_idx) const -> bool;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	struct Entry
+	{
+		std::vector<std::size_t> level_bytes{};
+		uint32_t size{ 0 };
+		uint32_t tail_mip{ 0 };
+		uint32_t resident_mip{ 0 };
+		uint32_t loading_mip{ NONE };
+		// Request of the frame \a last_frame
+		float screen_pixels{ 0.0F };
+		uint64_t last_frame{ 0 };
+		bool evicted{ false };
+		bool added{ false };
+	};
+
+	/**
+	 * Magnification of the level \p mip of the texture, 0 if it was not requested.
+	 */
+	[[nodiscard]] auto GetMagnification(const Entry& entry, uint32_t mip) const -> float;
+
+	/**
+	 * Returns the memory of the levels [\p first, \p last) of the texture.
+	 */
+	static auto GetBytes(const Entry& entry, uint32_t first, uint32_t last) -> std::size_t;
+
+	/**
+	 * Evicts the least valuable levels until \p bytes more fit into the budget. Only levels
+	 * whose magnification after the eviction is below \p max_magnification are evicted.
+	 * @return false if not enough memory could be freed
+	 */
+	auto MakeRoom(std::size_t bytes, float max_magnification) -> bool;
+
+	std::vector<Entry> m_entries{};
+	// Scratch memory of Update
+	std::vector<uint32_t> m_candidates{};
+
+	uint64_t m_frame{ 0 };
+	Stats m_stats{ SIZE_MAX };
+};
+
+} // namespace assets
@@ -0,0 +1,46 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: null_command_backend.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: NullCommandBackend
+/// Replay backend that discards every command, see \c CommandBuffer. The CPU stages of the
+/// renderer can be timed with it without a GPU and without the cost of a driver.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class NullCommandBackend
+{
+
+public:
+	NullCommandBackend() = default;
+	NullCommandBackend(const NullCommandBackend& other) = delete;
+	NullCommandBackend(NullCommandBackend&& other) noexcept = delete;
+	auto operator=(const NullCommandBackend& other) -> NullCommandBackend = delete;
+	auto operator=(NullCommandBackend&& other) -> NullCommandBackend& = delete;
+	~NullCommandBackend() = default;
+
+	void SetProgram(uint32_t program_idx);
+	void SetModel(uint32_t model_idx);
+	void SetWorldMatrix(const math::Float4x4& world);
+	void SetTexture(uint32_t texture_idx);
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex);
+	void SetView(uint32_t view_idx);
+	void ClearView(uint32_t view_idx);
+};
+
+} // namespace graphics
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: null_render_device.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_device.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: NullRenderDevice
+/// Device of the backends that do not draw on the GPU. Resources are only handles with the
+/// number of bytes they would occupy, data is neither copied nor kept and shaders are not
+/// validated. The counters tell what a GPU device would have allocated and transferred.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class NullRenderDevice final : public RenderDevice
+{
+
+public:
+	struct Stats
+	{
+		// Resources that exist right now and the GPU memory they would occupy
+		size_t resources{ 0 };
+		size_t resource_bytes{ 0 };
+		// Totals since startup
+		size_t created{ 0 };
+		size_t uploaded_bytes{ 0 };
+		size_t copied_bytes{ 0 };
+	};
+
+	/**
+	 * @param uses_bytecode makes shader programs compile their bytecode as for a GPU device,
+	 *        e.g. to measure compile times with a stand-in compiler
+	 */
+	explicit NullRenderDevice(bool uses_bytecode = false);
+	NullRenderDevice(const NullRenderDevice& other) = delete;
+	NullRenderDevice(NullRenderDevice&& other) noexcept = delete;
+	auto operator=(const NullRenderDevice& other) -> NullRenderDevice = delete;
+	auto operator=(NullRenderDevice&& other) -> NullRenderDevice& = delete;
+	~NullRenderDevice() override = default;
+
+	/**
+	 * \p hwnd is not used, only the window size of \p settings sizes the back buffer.
+	 */
+	auto Initialize(const HWND& hwnd, const GraphicSettings& settings) -> HRESULT override;
+	void Shutdown() override;
+	auto Refresh(const GraphicSettings& settings) -> HRESULT override;
+	void Present() override;
+
+	auto CreateBuffer(BufferUsage usage, uint32_t size, Handle& handle) -> HRESULT override;
+	void UpdateBuffer(Handle buffer, uint32_t offset, const void* data, uint32_t size) override;
+	void CopyBuffer(
+		Handle dst, uint32_t dst_offset, Handle src, uint32_t src_offset, uint32_t size
+	) override;
+	auto CreateTexture(
+		const TextureDesc& desc, const std::vector<SubresourceData>& subresources,
+		bool as_array, Handle& handle
+	) -> HRESULT override;
+	auto CreateRenderTarget(uint32_t width, uint32_t height, Handle& handle)
+		-> HRESULT override;
+	auto CreateDepthArray(uint32_t size, uint32_t slices, Handle& handle) -> HRESULT override;
+	auto CreateShader(ShaderStage stage, const std::vector<uint8_t>& bytecode, Handle& handle)
+		-> HRESULT override;
+	auto CreateInputLayout(
+		const std::vector<VertexElement>& elements, const std::vector<uint8_t>& bytecode,
+		Handle& handle
+	) -> HRESULT override;
+	void Release(Handle handle) override;
+
+	[[nodiscard]] auto GetBackBuffer() const -> Handle override;
+	[[nodiscard]] auto UsesBytecode() const -> bool override;
+	[[nodiscard]] auto GetVideoMemory() const -> size_t override;
+	[[nodiscard]] auto GetSupportedResolutions() const
+		-> const std::vector<std::tuple<uint16_t, uint16_t>>& override;
+
+	/**
+	 * Returns the size of a resource in bytes, 0 for handles that were released.
+	 */
+	[[nodiscard]] auto GetResourceBytes(Handle handle) const -> size_t;
+	[[nodiscard]] auto GetStats() const -> const Stats&;
+
+private:
+	/**
+	 * Hands out a handle for a resource of \p bytes, released handles are reused.
+	 */
+	auto Allocate(size_t bytes) -> Handle;
+
+	// Bytes of every handle, released handles keep NO_BYTES
+	static constexpr size_t NO_BYTES = SIZE_MAX;
+	std::vector<size_t> m_resource_bytes{};
+	std::vector<Handle> m_free_handles{};
+	Handle m_back_buffer{ NO_RESOURCE };
+
+	std::vector<std::tuple<uint16_t, uint16_t>> m_resolutions{};
+	Stats m_stats{};
+	bool m_uses_bytecode{ false };
+};
+
+} // namespace graphics
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: platform.h
+/// The Windows types and macros that the code without Direct3D uses. Windows builds take them
+/// from the Windows headers. The other platforms only build the parts of the engine that do
+/// not need a device (see CMakeLists.txt) and get minimal definitions with the same meaning.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+#include <cstdio>
+#endif
+
+
+#ifndef _WIN32
+using HRESULT = int32_t;
+using BOOL = int;
+using UINT = unsigned int;
+using WCHAR = wchar_t;
+using LPCWSTR = const wchar_t*;
+// Never points to a window, the handle only keeps the interfaces equal
+using HWND = struct HWND__*;
+
+constexpr BOOL TRUE = 1;
+constexpr BOOL FALSE = 0;
+
+constexpr HRESULT S_OK = 0;
+constexpr HRESULT S_FALSE = 1;
+constexpr HRESULT E_NOTIMPL = HRESULT(0x80004001U);
+constexpr HRESULT E_FAIL = HRESULT(0x80004005U);
+constexpr HRESULT E_OUTOFMEMORY = HRESULT(0x8007000EU);
+constexpr HRESULT E_INVALIDARG = HRESULT(0x80070057U);
+
+constexpr auto SUCCEEDED(HRESULT result) -> bool
+{
+	return result >= 0;
+}
+
+constexpr auto FAILED(HRESULT result) -> bool
+{
+	return result < 0;
+}
+
+#define UNREFERENCED_PARAMETER(P) (void)(P)
+
+inline void OutputDebugStringA(const char* text)
+{
+	std::fputs(text, stderr);
+}
+#endif
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: recording_command_backend.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+#include "command_buffer.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RecordingCommandBackend
+/// Replay backend that draws nothing but logs every command with its arguments into a
+/// \c CommandBuffer, in the order the GPU would have received them. The log uses the packed
+/// format of the command buffer, so it is compact, can be compared between two runs and can
+/// be replayed against any other backend later on.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RecordingCommandBackend
+{
+
+public:
+	/**
+	 * @param log receives the commands, it has to outlive the backend. The caller groups
+	 *        them into records, e.g. one per frame.
+	 */
+	explicit RecordingCommandBackend(CommandBuffer& log);
+	RecordingCommandBackend(const RecordingCommandBackend& other) = delete;
+	RecordingCommandBackend(RecordingCommandBackend&& other) noexcept = delete;
+	auto operator=(const RecordingCommandBackend& other) -> RecordingCommandBackend = delete;
+	auto operator=(RecordingCommandBackend&& other) -> RecordingCommandBackend& = delete;
+	~RecordingCommandBackend() = default;
+
+	void SetProgram(uint32_t program_idx);
+	void SetModel(uint32_t model_idx);
+	void SetWorldMatrix(const math::Float4x4& world);
+	void SetTexture(uint32_t texture_idx);
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex);
+	void SetView(uint32_t view_idx);
+	void ClearView(uint32_t view_idx);
+
+private:
+	CommandBuffer& m_log;
+};
+
+} // namespace graphics
@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_device.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "graphic_settings.h"
+#include "platform.h"
+#include "render_types.h"
+
+
+namespace graphics
+{
+
+enum class BufferUsage : uint8_t
+{
+	Vertex = 0,
+	Index,
+	// Written by the CPU before every draw that uses it
+	Constant,
+	NUMBER
+};
+
+enum class ShaderStage : uint8_t
+{
+	Vertex = 0,
+	Pixel,
+	NUMBER
+};
+
+/**
+ * One attribute of a vertex, all attributes are read from the first vertex buffer.
+ */
+struct VertexElement
+{
+	// Places the element right after the previous one
+	static constexpr uint32_t APPEND_ALIGNED = UINT32_MAX;
+
+	const char* semantic{ nullptr };
+	uint32_t semantic_index{ 0 };
+	TextureFormat format{ TextureFormat::UNKNOWN };
+	uint32_t offset{ APPEND_ALIGNED };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderDevice
+/// Creates and owns the GPU resources of the renderer: geometry and constant buffers,
+/// textures, render targets, shaders and input layouts. Everything outside of the device
+/// only holds handles, so the asset and shader code is the same for every backend.
+///
+/// \c D3D11RenderDevice creates the resources with Direct3D 11. \c NullRenderDevice only
+/// hands out handles for the backends that do not draw on the GPU, it needs neither a
+/// window nor a GPU nor Windows.
+///
+/// Resources live until they are released or the device is destroyed, so the device has
+/// to outlive every object that holds one of its handles.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RenderDevice
+{
+
+public:
+	using Handle = uint32_t;
+	static constexpr Handle NO_RESOURCE = UINT32_MAX;
+
+	RenderDevice() = default;
+	RenderDevice(const RenderDevice& other) = delete;
+	RenderDevice(RenderDevice&& other) noexcept = delete;
+	auto operator=(const RenderDevice& other) -> RenderDevice = delete;
+	auto operator=(RenderDevice&& other) -> RenderDevice& = delete;
+	virtual ~RenderDevice() = default;
+
+	/**
+	 * Creates the device and the back buffer and its depth buffer in the size of the window.
+	 */
+	virtual auto Initialize(const HWND& hwnd, const GraphicSettings& settings) -> HRESULT = 0;
+	virtual void Shutdown() = 0;
+
+	/**
+	 * Applies changed settings, the back buffer handle stays the same.
+	 */
+	virtual auto Refresh(const GraphicSettings& settings) -> HRESULT = 0;
+
+	/**
+	 * Shows the back buffer, called once at the end of every frame.
+	 */
+	virtual void Present() = 0;
+
+	/**
+	 * Creates a buffer of \p size bytes without content.
+	 */
+	virtual auto CreateBuffer(BufferUsage usage, uint32_t size, Handle& handle) -> HRESULT = 0;
+
+	/**
+	 * Writes \p size bytes at \p offset, the rest of the buffer stays untouched.
+	 */
+	virtual void UpdateBuffer(Handle buffer, uint32_t offset, const void* data, uint32_t size)
+		= 0;
+
+	/**
+	 * Copies a range between two buffers or inside of one, the ranges must not overlap.
+	 */
+	virtual void CopyBuffer(
+		Handle dst, uint32_t dst_offset, Handle src, uint32_t src_offset, uint32_t size
+	) = 0;
+
+	/**
+	 * Creates an immutable texture that shaders sample.
+	 * @param subresources all mips of all slices in Direct3D order
+	 * @param as_array makes shaders see an array even if the texture has a single slice
+	 */
+	virtual auto CreateTexture(
+		const TextureDesc& desc, const std::vector<SubresourceData>& subresources,
+		bool as_array, Handle& handle
+	) -> HRESULT = 0;
+
+	/**
+	 * Creates a color target with a depth buffer of the same size, shaders can sample the
+	 * color.
+	 */
+	virtual auto CreateRenderTarget(uint32_t width, uint32_t height, Handle& handle)
+		-> HRESULT = 0;
+
+	/**
+	 * Creates \p slices square depth targets in one array, shaders can sample the depth.
+	 */
+	virtual auto CreateDepthArray(uint32_t size, uint32_t slices, Handle& handle)
+		-> HRESULT = 0;
+
+	virtual auto CreateShader(
+		ShaderStage stage, const std::vector<uint8_t>& bytecode, Handle& handle
+	) -> HRESULT = 0;
+
+	/**
+	 * @param bytecode vertex shader the elements are validated against
+	 */
+	virtual auto CreateInputLayout(
+		const std::vector<VertexElement>& elements, const std::vector<uint8_t>& bytecode,
+		Handle& handle
+	) -> HRESULT = 0;
+
+	/**
+	 * Destroys a resource, \c NO_RESOURCE is ignored. Handles are reused afterwards.
+	 */
+	virtual void Release(Handle handle) = 0;
+
+	/**
+	 * Returns the render target of the window with its depth buffer.
+	 */
+	[[nodiscard]] virtual auto GetBackBuffer() const -> Handle = 0;
+
+	/**
+	 * Returns whether shaders are created from compiled bytecode. Devices that never run
+	 * a shader take any bytecode, so shader programs can be created without compiling.
+	 */
+	[[nodiscard]] virtual auto UsesBytecode() const -> bool = 0;
+
+	/**
+	 * Returns the dedicated video memory in MB, 0 if the device has none.
+	 */
+	[[nodiscard]] virtual auto GetVideoMemory() const -> size_t = 0;
+
+	[[nodiscard]] virtual auto GetSupportedResolutions() const
+		-> const std::vector<std::tuple<uint16_t, uint16_t>>& = 0;
+};
+
+} // namespace graphics
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_target.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_device.h"
+#include "render_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: RenderTarget
+/// An offscreen color texture with its own depth buffer. A pass renders into the target and
+/// later passes sample its color, both through the handle of \c GetTarget.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class RenderTarget
+{
+
+public:
+	RenderTarget() = default;
+	RenderTarget(const RenderTarget& other) = delete;
+	RenderTarget(RenderTarget&& other) noexcept = delete;
+	auto operator=(const RenderTarget& other) -> RenderTarget = delete;
+	auto operator=(RenderTarget&& other) -> RenderTarget& = delete;
+	~RenderTarget() = default;
+
+	/**
+	 * Creates the textures, a previous size is released first.
+	 */
+	auto Initialize(RenderDevice& device, uint32_t width, uint32_t height) -> HRESULT;
+
+	[[nodiscard]] auto GetTarget() const -> RenderDevice::Handle;
+
+	/**
+	 * Returns a viewport that covers the whole target.
+	 */
+	[[nodiscard]] auto GetViewport() const -> const Viewport&;
+
+private:
+	RenderDevice::Handle m_target{ RenderDevice::NO_RESOURCE };
+
+	Viewport m_viewport{};
+};
+
+} // namespace graphics
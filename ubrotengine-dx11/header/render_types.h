@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_types.h
+/// Descriptions of GPU data that do not depend on a graphics API. They mirror their Direct3D 11
+/// counterparts value for value and field for field, so the Direct3D code converts them with a
+/// cast while the code without a device never includes a Direct3D header.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+/**
+ * The texture and vertex formats the engine reads or writes, the values are the ones of
+ * \c DXGI_FORMAT, which DDS files store as well.
+ */
+enum class TextureFormat : uint32_t
+{
+	UNKNOWN = 0,
+	R32G32B32A32_FLOAT = 2,
+	R32G32B32_FLOAT = 6,
+	R16G16B16A16_FLOAT = 10,
+	R16G16B16A16_SNORM = 13,
+	R8G8B8A8_UNORM = 28,
+	R8G8B8A8_UNORM_SRGB = 29,
+	R8G8B8A8_SNORM = 31,
+	R32_FLOAT = 41,
+	R32_UINT = 42,
+	R8G8_UNORM = 49,
+	R8_UNORM = 61,
+	BC1_UNORM = 71,
+	BC1_UNORM_SRGB = 72,
+	BC2_UNORM = 74,
+	BC2_UNORM_SRGB = 75,
+	BC3_UNORM = 77,
+	BC3_UNORM_SRGB = 78,
+	BC4_UNORM = 80,
+	BC4_SNORM = 81,
+	BC5_UNORM = 83,
+	BC5_SNORM = 84,
+	B8G8R8A8_UNORM = 87,
+	B8G8R8A8_UNORM_SRGB = 91,
+	BC6H_UF16 = 95,
+	BC6H_SF16 = 96,
+	BC7_UNORM = 98,
+	BC7_UNORM_SRGB = 99
+};
+
+/**
+ * Initial data of one subresource (a mip level of a slice), same layout as
+ * \c D3D11_SUBRESOURCE_DATA.
+ */
+struct SubresourceData
+{
+	const void* data{ nullptr };
+	// Bytes per row, per row of 4x4 blocks for BC formats
+	uint32_t row_pitch{ 0 };
+	// Only used by volume textures
+	uint32_t slice_pitch{ 0 };
+};
+
+/**
+ * Description of a 2D texture, its array or its cubemaps.
+ */
+struct TextureDesc
+{
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	uint32_t mip_count{ 0 };
+	// Number of 2D slices, for cubemaps this includes all six faces of every cube
+	uint32_t array_size{ 0 };
+	TextureFormat format{ TextureFormat::UNKNOWN };
+	bool cubemap{ false };
+};
+
+/**
+ * Area of a render target that a view draws into, same layout as \c D3D11_VIEWPORT.
+ */
+struct Viewport
+{
+	float x{ 0.0F };
+	float y{ 0.0F };
+	float width{ 0.0F };
+	float height{ 0.0F };
+	float min_depth{ 0.0F };
+	float max_depth{ 1.0F };
+};
+
+} // namespace graphics
@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_view.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "camera.h"
+#include "render_device.h"
+#include "render_types.h"
+
+
+namespace graphics
+{
+
+/**
+ * Camera, viewport and target of a view that the commands of a \c CommandBuffer refer to
+ * by index. The target is a render target of the device, e.g. its back buffer, or a depth
+ * array of which only \a depth_slice is written.
+ */
+struct RenderView
+{
+	const Camera* camera{ nullptr };
+	Viewport viewport{};
+	RenderDevice::Handle target{ RenderDevice::NO_RESOURCE };
+	uint32_t depth_slice{ 0 };
+	std::array<float, 4> clear_color{ 0.0F, 0.0F, 0.0F, 1.0F };
+};
+
+} // namespace graphics
@@ -3,40 +3,38 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
-#ifdef UBROTENGINEDX11_EXPORTS
-#define UBROTENGINE_DX11_API __declspec(dllexport)
-#else
-#define UBROTENGINE_DX11_API __declspec(dllimport)
-#endif
-
-
-/////////////
-// LINKING //
-/////////////
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-
 
 //////////////
 // INCLUDES //
 //////////////
-#include <d3d11.h>
-#include <directxmath.h>
 //#include <DirectXCollision.h>
 #include <cstdint>
+#include <memory>
 
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "asset_manager.h"
-#include "direct3d.h"
+#include "camera.h"
+#include "command_buffer.h"
+#include "draw_packet_list.h"
+#include "frame_stats.h"
+#include "math_types.h"
+#include "null_command_backend.h"
+#include "recording_command_backend.h"
+#include "render_device.h"
+#include "render_target.h"
+#include "render_view.h"
+#include "scene_input.h"
 #include "shader_manager.h"
+#include "shadow_cascades.h"
+#include "shadow_map.h"
+#include "software_command_backend.h"
+#include "software_rasterizer.h"
+#include "thread_pool.h"
 #include "vertex_types.h"
-#include "view_matrix_handler.h"
-
-#include "header/scene_manager.h"
+#include "view_culler.h"
 
 
 /////////////
@@ -46,17 +44,46 @@ const bool VSYNC_ENABLED = false;
 const bool FULL_SCREEN = false;
 const float SCREEN_DEPTH = 100.0F;
 const float SCREEN_NEAR = 1.0F;
+// Upper bound of geometry that is moved per frame to defragment the shared buffers
+const size_t GEOMETRY_DEFRAG_BYTES = 1 << 20;
+// Share of the dedicated video memory models may use if the settings do not set a budget
+const float MODEL_MEMORY_SHARE = 0.5F;
+// Share of the dedicated video memory streamed textures may use if the settings do not set a
+// budget
+const float TEXTURE_MEMORY_SHARE = 0.25F;
+// Upper bound of streamed texture levels that start loading per frame
+const size_t TEXTURE_STREAM_BYTES = 8 << 20;
+// Scene objects have no size yet, their textures are assumed to cover this many world units
+const float TEXTURE_WORLD_SIZE = 1.0F;
+// Upper bound of users that share the window, the screen is split into at most four parts
+const uint32_t MAX_SPLIT_SCREEN_VIEWS = 4;
+// Resolution of the planar reflection relative to a view if the settings hold none
+const float DEFAULT_REFLECTION_SCALE = 0.5F;
+// The planar reflection requests its textures this many mip levels coarser than the views
+const float REFLECTION_MIP_BIAS = 1.0F;
+// Size of a shadow cascade in texels if the settings hold none
+const uint32_t DEFAULT_SHADOW_MAP_SIZE = 2048;
+// Shadows end at this distance from the camera, the cascades split the depth range up to it
+const float SHADOW_DISTANCE = 60.0F;
+// Objects up to this far outside a cascade towards the light still cast a shadow into it
+const float SHADOW_CASTER_RANGE = 50.0F;
 //extern float SCREEN_DEPTH;
 //extern float SCREEN_NEAR;
 
 namespace graphics
 {
 
+class D3D11RenderDevice;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Class name: Renderer
 /// The renderer is used to initiate rendering of all entities in the scene and supports
 /// the following entity types:
 ///		- Colored
+///
+/// All resources are created through a \c RenderDevice. Only the D3D11 backend uses a
+/// \c D3D11RenderDevice, which exists on Windows only, the other backends use a
+/// \c NullRenderDevice and need neither a window nor a GPU.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class Renderer
 {
@@ -75,42 +102,259 @@ public:
 
 	auto Refresh(const GraphicSettings& settings) -> HRESULT;
 
+	/**
+	 * Mounts an asset archive, registered models and textures are read from it if it has
+	 * their path.
+	 */
+	auto MountArchive(const std::string& filename) -> bool;
+
 	//auto RegisterShader(HWND hwnd, int shader_type) -> bool;
 	auto RegisterModel(const std::string& filename) -> size_t;
 	auto RegisterModelProcedural(assets::Procedural num) -> size_t;
 	auto RegisterTexture(const std::string& filename, uint8_t components) -> size_t;
+	/**
+	 * Registers several models or textures at once, their files are read asynchronously.
+	 */
+	auto RegisterModels(const std::vector<std::string>& filenames) -> std::vector<size_t>;
+	auto RegisterTextures(const std::vector<std::string>& filenames, uint8_t components)
+		-> std::vector<size_t>;
+
+	/**
+	 * Sets the texture a model is drawn with.
+	 */
+	void SetModelTexture(size_t model_idx, size_t texture_idx);
 
 	auto GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&;
 
 	/**
-	 * Prepares the backbuffer and subsequently calls \c RenderScene.
-	 * @param scene
+	 * Renders the scene mirrored at the horizontal plane y = \p height into the reflection
+	 * texture before every frame, seen from the camera of the first user. Only objects that
+	 * are at least partly above the plane are drawn.
+	 */
+	void SetReflectionPlane(float height);
+	void DisableReflection();
+
+	/**
+	 * Returns the texture of the planar reflection, it is sized by the reflection scale of
+	 * the settings.
+	 */
+	[[nodiscard]] auto GetReflectionTexture() const -> RenderDevice::Handle;
+
+	/**
+	 * Returns the mirrored camera the reflection is rendered with, e.g. to project the
+	 * texture onto the reflecting surface.
+	 */
+	[[nodiscard]] auto GetReflectionCamera() const -> const Camera&;
+
+	/**
+	 * Renders cascaded shadow maps of a directional light before every frame, fitted to the
+	 * camera of the first user. The far cascades are cached and only rendered again if the
+	 * light moves or the objects inside them change.
+	 * @param direction the direction the light shines into, must not be zero
+	 */
+	void SetLightDirection(const math::Float3& direction);
+	void DisableShadows();
+
+	/**
+	 * Returns the depth texture array with one slice per cascade.
+	 */
+	[[nodiscard]] auto GetShadowMap() const -> RenderDevice::Handle;
+
+	/**
+	 * Returns the cascades, their cameras and splits are needed to sample the shadow map.
+	 */
+	[[nodiscard]] auto GetShadowCascades() const -> const ShadowCascades&;
+
+	/**
+	 * Renders a frame from the inputs that were copied out of a scene and presents it, see
+	 * \c Engine::RenderScene. Users beyond the inputs keep their cameras.
+	 * @param read_ms the time it took to copy the inputs, reported in the frame stats
+	 */
+	auto Process(const SceneInput& input, double read_ms = 0.0) -> HRESULT;
+
+	/**
+	 * Returns the number of split screen views, only that many users are read from a scene.
+	 */
+	[[nodiscard]] auto GetViewCount() const -> size_t;
+
+	/**
+	 * Returns the number of registered models, objects with a model index beyond it can not
+	 * be drawn.
+	 */
+	[[nodiscard]] auto GetModelCount() const -> size_t;
+
+	/**
+	 * A deterministic renderer waits for the shader variants and texture levels that were
+	 * requested in the previous frame before every frame, instead of using whatever
+	 * finished in the background. The same inputs then always draw the same packets, which
+	 * replays of frame captures rely on. The waits are not part of the stage timings.
+	 */
+	void SetDeterministic(bool deterministic);
+
+	/**
+	 * Returns the timings and counters of the last processed frame.
+	 */
+	[[nodiscard]] auto GetFrameStats() const -> const FrameStats&;
+
+	/**
+	 * Returns the commands of the last processed frame in submit order, only filled by the
+	 * recording backend, see \c RenderBackend.
+	 */
+	[[nodiscard]] auto GetRecordedCommands() const -> const CommandBuffer&;
+
+	/**
+	 * Copies the last processed frame of the software backend into \p image.
+	 * @return false if another backend is used
 	 */
-	auto Process(const Scene &scene) -> HRESULT;
+	auto GetSoftwareFrame(io::Image& image) const -> bool;
 
 private:
 	/**
-	 * Iterates over all tiles and all entities of the scence and then renders them accordingly.
-	 * To inrease performance, only entities in the field of view are rendered (frustum culling).
-	 * @param scene The scene to render
-	 * @param camera The camera to use for rendering (holds necessary matrices)
+	 * Renders the scene in two separate stages: \c GatherScene builds the draw packet list
+	 * and \c SubmitScene hands it to the GPU. Both stages are timed individually.
+	 * @param input The inputs of the scene to render
+	 */
+	auto RenderScene(const SceneInput& input) -> HRESULT;
+
+	/**
+	 * Sets the model memory budget from the settings or, if none is set, from the video
+	 * memory of the adapter.
+	 */
+	void UpdateModelBudget(const GraphicSettings& settings);
+
+	/**
+	 * Sets the texture streaming budget like \c UpdateModelBudget and derives the scale
+	 * which turns a view depth into the screen size of a texture from the resolution and
+	 * the projection.
+	 */
+	void UpdateTextureStreaming(const GraphicSettings& settings);
+
+	/**
+	 * Creates one camera per split screen view and divides the window between them, two
+	 * views side by side and up to four views into quarters. Every view gets a projection
+	 * that matches the aspect ratio of its part of the screen. The planar reflection is
+	 * added after them with its own render target, scaled down from the size of a view,
+	 * followed by one depth only view per shadow cascade.
+	 */
+	auto UpdateViews(const GraphicSettings& settings) -> HRESULT;
+
+	/**
+	 * Iterates once over all tiles and all entities of the scene and tests their bounding
+	 * spheres against the frusta of all views, including the planar reflection, in one pass.
+	 * The same spheres are culled against the shadow cascades in parallel. Every entity that
+	 * is visible in at least one view or casts a shadow into a cascade that has to be
+	 * rendered stores its world matrix once and one draw packet per view or cascade (model,
+	 * shader program, world matrix and sort key) in \a m_draw_packets. Evicted models
+	 * that are needed again are reloaded and models exceeding the budget are evicted
+	 * afterwards, apart from that no device calls are made in this stage. Textured entities
+	 * request the mip levels they need from the texture streaming.
+	 * @param input The inputs of the scene to gather the packets from
+	 */
+	void GatherScene(const SceneInput& input);
+
+	/**
+	 * Records the gathered draw packets in parallel into \a m_command_buffers and replays
+	 * them either on the immediate context or, if the driver supports it, on one deferred
+	 * context per recording thread. The headless backends replay on the calling thread.
+	 */
+	auto SubmitScene() -> HRESULT;
+
+	/**
+	 * Splits the sorted draw packets into one contiguous range per command buffer and records
+	 * the draw commands for each range on a different thread. The packets are sorted by view
+	 * first, so the views share the threads instead of being recorded one after another.
+	 */
+	void RecordCommands();
+
+	/**
+	 * Records the clears of all targets that are drawn this frame into \a m_frame_commands,
+	 * they are replayed before the draws.
+	 */
+	void RecordClears();
+
+	/**
+	 * Merges all command buffers like \c ReplayImmediate and discards the commands.
+	 */
+	auto ReplayNull() -> HRESULT;
+
+	/**
+	 * Merges all command buffers like \c ReplayImmediate and logs the commands into
+	 * \a m_recorded_commands.
+	 */
+	auto ReplayRecording() -> HRESULT;
+
+	/**
+	 * Merges all command buffers like \c ReplayImmediate and draws them on the CPU into
+	 * \a m_software_target.
+	 */
+	auto ReplaySoftware() -> HRESULT;
+
+#ifdef _WIN32
+	/**
+	 * Merges all command buffers by sort key and replays them on the immediate context.
 	 */
-	auto RenderScene(const Scene &scene) -> HRESULT;
+	auto ReplayImmediate() -> HRESULT;
 
 	/**
-	* Activates the vertex and index buffers for the input assembler of the GPU which enables
-	* this model to be rendered by shaders. This function also sets the topology used to
-	* render the model, which is a triangle list (\c IASetPrimitiveTopology).
-	* @param deviceContext
-	*/
-	template <class T>
-	static void RenderModel(ID3D11DeviceContext* device_context, const vertices::Model &model);
+	 * Replays every command buffer on its own deferred context in parallel and executes the
+	 * resulting command lists on the immediate context in sort order.
+	 */
+	auto ReplayDeferred() -> HRESULT;
+#endif
 
 //private:
-	std::unique_ptr<Direct3D> m_direct3d{ nullptr };
+	// Where the commands are replayed, Direct3D is only drawn to by the D3D11 backend
+	RenderBackend m_backend{ RenderBackend::D3D11 };
+	// Declared first, so it outlives everything that holds one of its handles
+	std::unique_ptr<RenderDevice> m_device{ nullptr };
+	// The same device if the D3D11 backend is used, nullptr otherwise
+	D3D11RenderDevice* m_d3d11_device{ nullptr };
 	std::unique_ptr<ShaderManager> m_shader_manager{ nullptr };
 	std::unique_ptr<assets::AssetManager> m_asset_manager{ nullptr };
-	std::unique_ptr<ViewMatrixHandler> m_view_matrix_handler{ nullptr };
+	// One camera and viewport per split screen view
+	std::vector<std::unique_ptr<Camera>> m_cameras{};
+	std::vector<RenderView> m_views{};
+
+	// Planar reflection, drawn as an extra view into its own target
+	std::unique_ptr<Camera> m_reflection_camera{ nullptr };
+	std::unique_ptr<RenderTarget> m_reflection_target{ nullptr };
+	float m_reflection_scale{ DEFAULT_REFLECTION_SCALE };
+	float m_reflection_height{ 0.0F };
+	bool m_reflection_enabled{ false };
+
+	// Cascaded shadow maps, drawn as one extra view per cascade
+	ShadowCascades m_shadow_cascades{};
+	std::unique_ptr<ShadowMap> m_shadow_map{ nullptr };
+	bool m_shadows_enabled{ false };
+
+	// Projection range of the views
+	float m_screen_near{ SCREEN_NEAR };
+	float m_screen_depth{ SCREEN_DEPTH };
+
+	std::unique_ptr<utils::ThreadPool> m_thread_pool{ nullptr };
+	bool m_deterministic{ false };
+
+	// Scratch memory of the gather stage, kept across frames
+	ViewCuller m_culler{};
+	std::vector<uint32_t> m_gathered_matrices{};
+	std::vector<size_t> m_gathered_programs{};
+
+	DrawPacketList m_draw_packets{};
+	std::vector<CommandBuffer> m_command_buffers{};
+	// Clears of the frame, replayed before the draws
+	CommandBuffer m_frame_commands{};
+	CommandBuffer m_recorded_commands{};
+	std::vector<CommandBuffer::RecordRef> m_merged_commands{};
+
+	// Only used by the software backend, the split screen views share its image like they
+	// share the back buffer
+	std::unique_ptr<SoftwareRasterizer> m_software_target{ nullptr };
+	std::vector<SoftwareCommandBackend::View> m_software_views{};
+
+	// Screen size in pixels of a texture at a view depth of one
+	float m_texture_pixel_scale{ 0.0F };
+
+	FrameStats m_frame_stats{};
 };
 
 } // namespace graphics
\ No newline at end of file
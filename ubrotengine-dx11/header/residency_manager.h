@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: residency_manager.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ResidencyManager
+/// Decides which models are kept in GPU memory. Every resident model is part of a list that
+/// is ordered by the frame it was last drawn in. When the resident models exceed the budget,
+/// the least recently drawn ones are selected for eviction. Models drawn in the current frame
+/// are never evicted, even if that means the budget is exceeded.
+///
+/// The manager only does the bookkeeping, loading and freeing the GPU memory is up to the
+/// owner. It does not depend on a device.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ResidencyManager
+{
+
+public:
+	struct Stats
+	{
+		size_t budget_bytes{ 0 };
+		size_t resident_bytes{ 0 };
+		size_t resident_models{ 0 };
+		// Totals since the manager was created
+		size_t evicted_models{ 0 };
+		size_t reloaded_models{ 0 };
+	};
+
+	/**
+	 * Registers a model that was just loaded, it counts as drawn in the current frame.
+	 * @param model_idx index of the model in the asset manager
+	 * @param bytes GPU memory used by the model
+	 */
+	void Add(size_t model_idx, size_t bytes);
+
+	/**
+	 * Starts a new frame, models touched after this call are protected from eviction.
+	 */
+	void BeginFrame();
+
+	/**
+	 * Marks the model as drawn in the current frame.
+	 * @return false if the model is not resident and has to be reloaded
+	 */
+	auto Touch(size_t model_idx) -> bool;
+
+	/**
+	 * Marks an evicted model as resident again.
+	 */
+	void Reloaded(size_t model_idx, size_t bytes);
+
+	/**
+	 * Selects the least recently drawn models until the resident bytes fit into the budget
+	 * and marks them as evicted.
+	 * @param evicted receives the models whose GPU memory has to be freed
+	 */
+	void SelectEvictions(std::vector<size_t>& evicted);
+
+	void SetBudget(size_t bytes);
+
+	[[nodiscard]] auto IsResident(size_t model_idx) const -> bool;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	struct Entry
+	{
+		size_t bytes{ 0 };
+		uint64_t last_frame{ 0 };
+		// Neighbours in the LRU list, the head is the most recently drawn model
+		uint32_t prev{ NONE };
+		uint32_t next{ NONE };
+		bool resident{ false };
+	};
+
+	void PushFront(uint32_t model_idx);
+	void Unlink(uint32_t model_idx);
+
+	std::vector<Entry> m_entries{};
+	uint32_t m_head{ NONE };
+	uint32_t m_tail{ NONE };
+
+	uint64_t m_frame{ 0 };
+	Stats m_stats{ SIZE_MAX };
+};
+
+} // namespace assets
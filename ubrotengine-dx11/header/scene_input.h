@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: scene_input.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "math_types.h"
+
+
+namespace graphics
+{
+
+/**
+ * Everything the renderer reads from a \c Scene in one frame. The engine copies it out of
+ * the scene before rendering, so a frame can be captured and rendered again without the
+ * scene, see \c CaptureWriter.
+ */
+struct SceneInput
+{
+	struct User
+	{
+		math::Float3 position{ 0.0F, 0.0F, 0.0F };
+		math::Float3 look_at{ 0.0F, 0.0F, 1.0F };
+	};
+
+	// One user per split screen view
+	std::vector<User> users{};
+	// Number of objects of every tile, in the order of the scene. The objects of all tiles
+	// follow each other in the same order.
+	std::vector<uint32_t> tile_objects{};
+	std::vector<uint32_t> models{};
+	std::vector<math::Float3> positions{};
+
+	/**
+	 * Keeps the memory, so reading the next frame does not allocate.
+	 */
+	void Clear()
+	{
+		users.clear();
+		tile_objects.clear();
+		models.clear();
+		positions.clear();
+	}
+};
+
+} // namespace graphics
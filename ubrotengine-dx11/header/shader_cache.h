@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_cache.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "platform.h"
+
+
+namespace graphics
+{
+
+struct ShaderDefine
+{
+	std::string name;
+	std::string value;
+};
+
+/**
+ * Everything that decides the bytecode of a shader besides the content of its files.
+ */
+struct ShaderCompileDesc
+{
+	std::filesystem::path path{};
+	std::string entry_point{};
+	// Shader model, e.g. "vs_5_0"
+	std::string target{};
+	std::vector<ShaderDefine> defines{};
+	// D3DCOMPILE_* flags
+	uint32_t flags{ 0 };
+};
+
+struct ShaderCompileOutput
+{
+	std::vector<uint8_t> bytecode{};
+	// Every file the compiler included, a change to one of them invalidates the bytecode
+	std::vector<std::filesystem::path> includes{};
+	std::string errors{};
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShaderCache
+/// Keeps compiled shader bytecode on disk, so a shader is only compiled again once its source
+/// changed. An entry is found by a hash of the source text and the compile description, and
+/// stores the hashes of all included files, which are checked before the entry is used.
+///
+/// The compiler is a parameter, so the lookup and invalidation also work without Direct3D.
+/// \c Get can be called from several threads.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShaderCache
+{
+
+public:
+	/**
+	 * Compiles \p source, which is the content of \p desc.path.
+	 */
+	using Compiler = std::function<HRESULT(
+		const ShaderCompileDesc& desc, const std::string& source, ShaderCompileOutput& output
+	)>;
+
+	struct Stats
+	{
+		size_t hits{ 0 };
+		size_t misses{ 0 };
+		// Entries that were found but outdated, they are also counted as misses
+		size_t invalidated{ 0 };
+		size_t failed{ 0 };
+	};
+
+	static constexpr uint32_t MAGIC = 0x43534255; // "UBSC"
+	// Has to be increased whenever the entry format or the key changes
+	static constexpr uint32_t VERSION = 1;
+	static constexpr const wchar_t* DEFAULT_DIRECTORY = L"shader_cache";
+
+	/**
+	 * @param directory where the entries are kept, it is created if needed
+	 * @param compiler compiles on a miss, defaults to \c CompileD3D
+	 */
+	explicit ShaderCache(
+		std::filesystem::path directory = DEFAULT_DIRECTORY, Compiler compiler = nullptr
+	);
+	ShaderCache(const ShaderCache& other) = delete;
+	ShaderCache(ShaderCache&& other) noexcept = delete;
+	auto operator=(const ShaderCache& other) -> ShaderCache = delete;
+	auto operator=(ShaderCache&& other) -> ShaderCache& = delete;
+	~ShaderCache() = default;
+
+	/**
+	 * Returns the bytecode of a shader, from the cache if it is up to date and compiled
+	 * otherwise. A failed compile is not cached.
+	 * @param errors compiler messages, empty if the source file can not be read
+	 */
+	auto Get(const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors)
+		-> HRESULT;
+
+	/**
+	 * Removes all entries from the disk.
+	 */
+	void Clear();
+
+	[[nodiscard]] auto GetStats() const -> Stats;
+	[[nodiscard]] auto GetDirectory() const -> const std::filesystem::path&;
+
+	/**
+	 * Compiles with \c D3DCompile, includes are resolved relative to the including file.
+	 * Fails with \c E_NOTIMPL on platforms other than Windows.
+	 */
+	static auto CompileD3D(
+		const ShaderCompileDesc& desc, const std::string& source, ShaderCompileOutput& output
+	) -> HRESULT;
+
+private:
+	struct Key
+	{
+		// Names the entry file
+		uint64_t hash{ 0 };
+		// Second hash of the same data, tells apart two keys whose first hash collides
+		uint64_t check{ 0 };
+	};
+
+	static auto ComputeKey(const ShaderCompileDesc& desc, const std::string& source) -> Key;
+	static auto HashFile(const std::filesystem::path& path, uint64_t& hash) -> bool;
+
+	[[nodiscard]] auto GetEntryPath(const Key& key) const -> std::filesystem::path;
+
+	/**
+	 * Reads an entry and checks its includes.
+	 * @param outdated set if the entry exists but can not be used anymore
+	 */
+	auto Load(const Key& key, std::vector<uint8_t>& bytecode, bool& outdated) const -> bool;
+	auto Store(const Key& key, const ShaderCompileOutput& output) -> bool;
+
+	std::filesystem::path m_directory{};
+	Compiler m_compiler{};
+
+	mutable std::mutex m_mutex{};
+	Stats m_stats{};
+	// Makes the names of temporary files unique
+	uint32_t m_store_count{ 0 };
+};
+
+} // namespace graphics
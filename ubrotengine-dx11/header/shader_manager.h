@@ -8,56 +8,225 @@
 // INCLUDES //
 //////////////
 #include <array>
+#include <deque>
+#include <mutex>
+#include <string>
 #include <tuple>
+#include <vector>
 
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "embedded_shaders.h"
+#include "shader_manifest.h"
 #include "shader_program.h"
+#include "thread_pool.h"
 
 
 namespace graphics
 {
-	enum class ShaderProg : uint8_t
+	/**
+	 * Files of a shader program and the features its shaders implement.
+	 */
+	struct ShaderProgramDesc
 	{
-		SimShader = 0,
-		ColShader,
-		TexShader,
-		LigShader,
-		NomShader,
-		TesShader,
-		NUMBER
+		std::wstring vs_path{};
+		std::wstring fs_path{};
+		std::wstring layout_path{};
+		// Bits outside of this mask are ignored, so they do not create variants
+		FeatureMask features{ 0 };
 	};
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Class name: ShaderManager
+/// Every program of \c ShaderProg is declared once, its variants are the combinations of the
+/// features it supports. A variant is compiled the first time it is asked for, or up front
+/// if it is on the precompile list, and gets a program index of its own. The variants of a
+/// program are looked up in a table indexed by the feature mask.
+///
+/// Compiling runs on worker threads, only the device objects are created on the render
+/// thread in \c Update. Until a variant is ready its draws use the program without
+/// features, or \c FALLBACK_PROGRAM if that one is not ready either.
+///
+/// Release builds of the DLL include the generated embedded_shader_data.h and create the
+/// default programs from its bytecode instead, without reading or compiling any shader file.
+///
+/// The index of a program without features equals its \c ShaderProg value.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class ShaderManager
 {
 
 public:
-	ShaderManager() = default;
+	static constexpr size_t VARIANT_COUNT = size_t(1) << size_t(ShaderFeature::NUMBER);
+	static constexpr size_t NO_PROGRAM = SIZE_MAX;
+	static constexpr ShaderProg FALLBACK_PROGRAM = ShaderProg::SimShader;
+	// An update that takes longer stalls the frame noticeably
+	static constexpr double HITCH_MS = 4.0;
+
+	struct VariantStats
+	{
+		size_t variants{ 0 };
+		size_t pending{ 0 };
+		// Totals since startup
+		size_t embedded{ 0 };
+		size_t failed{ 0 };
+		size_t fallback_draws{ 0 };
+		size_t skipped_draws{ 0 };
+		size_t hitches{ 0 };
+		double longest_update_ms{ 0.0 };
+		double startup_ms{ 0.0 };
+	};
+
+	/**
+	 * @param compiler compiles on a cache miss, defaults to \c ShaderCache::CompileD3D
+	 * @param compile_threads number of worker threads, 0 uses the hardware concurrency
+	 */
+	explicit ShaderManager(ShaderCache::Compiler compiler = nullptr, size_t compile_threads = 0);
 	ShaderManager(const ShaderManager &other) = delete;
 	ShaderManager(ShaderManager&& other) noexcept = delete;
 	auto operator=(const ShaderManager& other) -> ShaderManager = delete;
 	auto operator=(ShaderManager&& other) -> ShaderManager& = delete;
 	~ShaderManager() = default;
 
-	auto Initialize(ID3D11Device* device, HWND hwnd) -> HRESULT;
+	/**
+	 * Declares the default programs and compiles the variants of the precompile list in
+	 * parallel. A device that does not use bytecode gets its programs without compiling.
+	 */
+	auto Initialize(RenderDevice& device, HWND hwnd) -> HRESULT;
 	/**
 	 * Shuts down by calling shut down for every member (where possible) and freeing allocated
 	 * memory.
 	 */
 	void Shutdown();
 
+	/**
+	 * Sets the files of a program, its variants are compiled again on their next use.
+	 */
+	void DeclareShaderProgram(ShaderProg program, ShaderProgramDesc desc);
+
+	/**
+	 * Starts compiling a variant if it is neither compiled nor pending.
+	 */
+	void PrecompileVariant(ShaderProg program, FeatureMask features);
+
+	/**
+	 * Blocks until all pending variants are compiled and creates them.
+	 * @return the first error of a variant that failed
+	 */
+	auto WaitForVariants() -> HRESULT;
+
+	/**
+	 * Creates the variants whose compile finished since the last call, called once per
+	 * frame by the render thread.
+	 */
+	auto Update() -> HRESULT;
+
+	/**
+	 * Returns the index of the program variant with the features. On the first call the
+	 * variant starts compiling and a fallback is returned until it is ready, a variant that
+	 * does not compile keeps using the fallback. Embedded variants are returned right away.
+	 * @return \c NO_PROGRAM if no fallback is ready either, the draw has to be skipped
+	 */
+	auto GetVariant(ShaderProg program, FeatureMask features) -> size_t;
+
 	auto AddCustomShaderProgram() -> std::tuple<size_t, ShaderProgram&>;
 	auto GetShaderProgram(size_t shader_prog_idx) -> ShaderProgram&;
 	void RemoveShaderProgram(size_t program_idx);
 
+	[[nodiscard]] auto GetShaderRegistry() const -> const ShaderRegistry&;
+	[[nodiscard]] auto GetShaderStats() const -> ShaderRegistry::Stats;
+	[[nodiscard]] auto GetVariantStats() const -> VariantStats;
+
 private:
-	std::array<std::tuple<ShaderProgram, unsigned int>, uint8_t(ShaderProg::NUMBER)> m_default_shader_progs{};
-	std::vector<std::tuple<ShaderProgram, unsigned int>> m_custom_shader_progs{};
+	static constexpr uint32_t NOT_COMPILED = UINT32_MAX;
+	static constexpr uint32_t PENDING_VARIANT = UINT32_MAX - 1;
+	static constexpr uint32_t FAILED_VARIANT = UINT32_MAX - 2;
+
+	struct ProgramVariants
+	{
+		ShaderProgramDesc desc{};
+		// Program index of every feature mask, or one of the markers above
+		std::array<uint32_t, VARIANT_COUNT> variants{};
+		// Increased with every declaration, compiles of older files are dropped
+		uint32_t generation{ 0 };
+	};
+
+	/**
+	 * Bytecode of a variant, filled on a worker thread.
+	 */
+	struct CompiledVariant
+	{
+		ShaderProg program{ ShaderProg::SimShader };
+		FeatureMask features{ 0 };
+		uint32_t generation{ 0 };
+		HRESULT result{ S_OK };
+		std::vector<uint8_t> vs_bytecode{};
+		std::vector<uint8_t> fs_bytecode{};
+		std::vector<uint8_t> layout_bytecode{};
+		// Compiler messages and file of the stage that failed
+		std::string errors{};
+		std::wstring error_path{};
+	};
+
+	// Vertex shader, fragment shader and layout
+	using StageDescs = std::array<ShaderCompileDesc, 3>;
+
+	/**
+	 * Creates the variant right away if its bytecode is embedded or the device does not use
+	 * bytecode, starts a compile otherwise.
+	 */
+	void StartCompile(ShaderProg program, FeatureMask features);
+
+	static auto GetStageDescs(
+		const ShaderProgramDesc& desc, const std::vector<ShaderDefine>& defines
+	) -> StageDescs;
+
+	/**
+	 * Copies the embedded bytecode of all stages into \p compiled.
+	 * @return false if a stage is not embedded
+	 */
+	auto LoadEmbedded(const StageDescs& stages, CompiledVariant& compiled) const -> bool;
+
+	/**
+	 * Compiles the stages of a variant, runs on a compile thread.
+	 */
+	void CompileVariant(const StageDescs& stages, CompiledVariant& compiled);
+
+	auto CreateFinishedVariants() -> HRESULT;
+
+	/**
+	 * Creates the device objects of a compiled variant.
+	 */
+	auto CreateVariant(const CompiledVariant& compiled) -> HRESULT;
+
+	/**
+	 * Returns the program that is drawn while a variant is not ready.
+	 */
+	auto GetFallback(ShaderProg program) -> size_t;
+
+	// Declared first, so it outlives the programs that hold handles to it
+	ShaderRegistry m_shader_registry{};
+
+	// Variants and custom programs, a deque keeps the returned references valid
+	std::deque<std::tuple<ShaderProgram, unsigned int>> m_shader_progs{};
+	std::array<ProgramVariants, size_t(ShaderProg::NUMBER)> m_variants{};
+	VariantStats m_stats{};
+
+	// Bytecode built into release builds, empty if the shaders were not embedded
+	EmbeddedShaderTable m_embedded_shaders{};
+	// Bytecode of the default programs, kept across launches
+	ShaderCache m_shader_cache{};
+
+	// Kept for variants compiled after the initialization
+	RenderDevice* m_device{ nullptr };
+	HWND m_hwnd{ nullptr };
+
+	std::mutex m_finished_mutex{};
+	std::vector<CompiledVariant> m_finished{};
+
+	// Destroyed first, so no compile writes to the members above after they are gone
+	utils::ThreadPool m_compile_threads;
 
 };
 
@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_manifest.h
+/// The default shader programs and their features. Shared by the engine, which compiles or
+/// looks up their variants, and the tools, which embed the bytecode of all variants.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "shader_cache.h"
+
+
+namespace graphics
+{
+	enum class ShaderProg : uint8_t
+	{
+		SimShader = 0,
+		ColShader,
+		TexShader,
+		LigShader,
+		NomShader,
+		TesShader,
+		NUMBER
+	};
+
+	/**
+	 * Optional parts of a shader program, each one is a bit of a \c FeatureMask and a define
+	 * in the shader source.
+	 */
+	enum class ShaderFeature : uint8_t
+	{
+		Instancing = 0,
+		QuantizedInput,
+		AlphaTest,
+		NUMBER
+	};
+
+	using FeatureMask = uint32_t;
+
+	constexpr auto FeatureBit(ShaderFeature feature) -> FeatureMask
+	{
+		return FeatureMask(1) << uint8_t(feature);
+	}
+
+	// Defines of the feature bits, in the order of ShaderFeature
+	constexpr std::array<const char*, size_t(ShaderFeature::NUMBER)> FEATURE_DEFINES = {
+		"INSTANCING",
+		"QUANTIZED_INPUT",
+		"ALPHA_TEST",
+	};
+
+	/**
+	 * Returns the defines a variant is compiled with, always in the same order.
+	 */
+	inline auto GetFeatureDefines(FeatureMask features) -> std::vector<ShaderDefine>
+	{
+		std::vector<ShaderDefine> defines;
+		for (size_t bit = 0; bit < FEATURE_DEFINES.size(); bit++) {
+			if ((features & FeatureBit(ShaderFeature(bit))) != 0) {
+				defines.push_back({ FEATURE_DEFINES[bit], "1" });
+			}
+		}
+		return defines;
+	}
+
+	/**
+	 * Files of a default program, relative to the shader directory.
+	 */
+	struct ShaderManifestEntry
+	{
+		ShaderProg program;
+		const wchar_t* vs_file;
+		const wchar_t* fs_file;
+		const wchar_t* layout_file;
+		// Features the shaders implement, every combination of them is a variant
+		FeatureMask features;
+	};
+
+	// The remaining programs have no shader files yet
+	constexpr std::array<ShaderManifestEntry, 2> SHADER_MANIFEST = { {
+		{
+			ShaderProg::SimShader, L"color.vs", L"color.fs", L"layout.vs",
+			FeatureBit(ShaderFeature::AlphaTest)
+		},
+		{
+			ShaderProg::ColShader, L"color.vs", L"color.fs", L"layout.vs",
+			FeatureBit(ShaderFeature::AlphaTest)
+		},
+	} };
+
+} // namespace graphics
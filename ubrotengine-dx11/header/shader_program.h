@@ -7,20 +7,25 @@
 //////////////
 // INCLUDES //
 //////////////
-#include <d3d11.h>
-#include <directxmath.h>
+#include <array>
 #include <memory>
-#include <wrl\client.h>
+#include <vector>
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "math_types.h"
+#include "render_device.h"
+#include "shader_cache.h"
+#include "shader_registry.h"
 
 
 namespace graphics
 {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // Class name: ShaderProgram
+/// The shader stages, input layout and constant buffers a draw is issued with. The program
+/// only holds handles, the backend that draws binds the objects behind them.
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class ShaderProgram
 {
@@ -38,111 +43,170 @@ public:
 	};
 
 private:
-	struct Shader {
-		virtual auto Create(ID3D11Device* device, ID3D10Blob* shader_buffer) -> HRESULT = 0;
-		virtual void Set(ID3D11DeviceContext* device_context) = 0;
-		virtual ~Shader() = default;
-	};
-
-	struct PixelShader : Shader {
+	// The shader objects are owned by the registry, the stages only describe how to get them
+	struct PixelShader {
 		inline static const char* const entry_point = "FragmentShader";
 		inline static const char* const type = "ps_5_0";
+		static constexpr ShaderType stage = ShaderType::FragmentShader;
 
-		auto Create(ID3D11Device *device, ID3D10Blob *shader_buffer) -> HRESULT override {
-			return device->CreatePixelShader(
-				shader_buffer->GetBufferPointer(),
-				shader_buffer->GetBufferSize(),
-				nullptr,
-				m_pixel_shader.GetAddressOf()
-			);
-		}
-
-		void Set(ID3D11DeviceContext *device_context) override {
-			device_context->PSSetShader(m_pixel_shader.Get(), nullptr, 0);
+		static auto Acquire(
+			ShaderRegistry& registry, RenderDevice& device, const std::vector<uint8_t>& bytecode,
+			ShaderRegistry::Handle& handle
+		) -> HRESULT {
+			return registry.AcquirePixelShader(device, bytecode, handle);
 		}
-
-	private:
-		Microsoft::WRL::ComPtr<ID3D11PixelShader> m_pixel_shader{ nullptr };
 	};
 
-	struct VertexShader : Shader {
+	struct VertexShader {
 		inline static const char* const entry_point = "MVertexShader";
 		inline static const char* const type = "vs_5_0";
+		static constexpr ShaderType stage = ShaderType::VertexShader;
 
-		auto Create(ID3D11Device *device, ID3D10Blob *shader_buffer) -> HRESULT override {
-			return device->CreateVertexShader(
-				shader_buffer->GetBufferPointer(),
-				shader_buffer->GetBufferSize(),
-				nullptr,
-				m_vertex_shader.GetAddressOf()
-			);
+		static auto Acquire(
+			ShaderRegistry& registry, RenderDevice& device, const std::vector<uint8_t>& bytecode,
+			ShaderRegistry::Handle& handle
+		) -> HRESULT {
+			return registry.AcquireVertexShader(device, bytecode, handle);
 		}
+	};
 
-		void Set(ID3D11DeviceContext *device_context) override {
-			device_context->VSSetShader(m_vertex_shader.Get(), nullptr, 0);
-		}
+public:
+	/**
+	 * Shader objects that are bound to one device context. Programs that share a stage find
+	 * it already bound and skip binding it again.
+	 */
+	struct BindState
+	{
+		BindState();
 
-	private:
-		Microsoft::WRL::ComPtr<ID3D11VertexShader> m_vertex_shader{ nullptr };
+		ShaderRegistry::Handle layout{ ShaderRegistry::NO_HANDLE };
+		std::array<ShaderRegistry::Handle, size_t(ShaderType::NUMBER)> shaders{};
+		// Layout and shader binds that were issued, and the binds without the filtering
+		size_t binds{ 0 };
+		size_t unfiltered_binds{ 0 };
 	};
 
-public:
 	/**
 	 * Holds matrices necessary for rendering, which are passed to the shader as a uniform.
 	 */
 	struct MatrixBufferType
 	{
-		DirectX::XMMATRIX world;
-		DirectX::XMMATRIX view;
-		DirectX::XMMATRIX projection;
+		math::Float4x4 world;
+		math::Float4x4 view;
+		math::Float4x4 projection;
+	};
+
+	/**
+	 * Location of the bound texture inside its texture array, passed to the shaders in
+	 * register b1.
+	 */
+	struct TextureBufferType
+	{
+		math::Float4 uv_transform;
+		uint32_t slice;
+		uint32_t padding[3];
 	};
 
-	ShaderProgram() = default;
+	ShaderProgram();
 	ShaderProgram(const ShaderProgram&other) = delete;
-	ShaderProgram(ShaderProgram&& other) noexcept = default;
+	ShaderProgram(ShaderProgram&& other) noexcept;
 	auto operator=(const ShaderProgram& other) ->ShaderProgram = delete;
 	auto operator=(ShaderProgram&& other) ->ShaderProgram & = delete;
 	~ShaderProgram() = default;
 
 	void Shutdown();
 
+	/**
+	 * @param cache the bytecode is taken from it and only compiled if it is outdated
+	 * @param registry holds the shader object, which is shared with programs that use the
+	 *        same bytecode
+	 * @param defines preprocessor defines of the variant, see \c ShaderFeature
+	 */
 	auto AddShader(
-		ID3D11Device *device, HWND hwnd, ShaderType shader_type, LPCWSTR path
+		RenderDevice& device, HWND hwnd, ShaderType shader_type, LPCWSTR path,
+		ShaderCache& cache, ShaderRegistry& registry,
+		const std::vector<ShaderDefine>& defines = {}
 	) -> HRESULT;
 	
 	auto AddLayout(
-		ID3D11Device* device, HWND hwnd, LPCWSTR vs_shader_path
+		RenderDevice& device, HWND hwnd, LPCWSTR vs_shader_path, ShaderCache& cache,
+		ShaderRegistry& registry, const std::vector<ShaderDefine>& defines = {}
 	) -> HRESULT;
 
-	auto AddBuffer(ID3D11Device* device) -> HRESULT;
-
-	auto XM_CALLCONV Render(
-		ID3D11DeviceContext *deviceContext,
-		const DirectX::FXMMATRIX& worldMatrix,
-		const DirectX::CXMMATRIX& viewMatrix,
-		const DirectX::CXMMATRIX& projectionMatrix,
-		unsigned int indexCount
+	/**
+	 * Same as above with bytecode that was compiled before, e.g. on another thread.
+	 */
+	auto AddShader(
+		RenderDevice& device, ShaderType shader_type, const std::vector<uint8_t>& bytecode,
+		ShaderRegistry& registry
 	) -> HRESULT;
+	auto AddLayout(
+		RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
+	) -> HRESULT;
+
+	/**
+	 * Returns how the shader of a stage is compiled, only the vertex and pixel stage are
+	 * supported.
+	 */
+	static auto GetCompileDesc(
+		ShaderType shader_type, LPCWSTR path, const std::vector<ShaderDefine>& defines
+	) -> ShaderCompileDesc;
+	static auto GetLayoutCompileDesc(
+		LPCWSTR vs_shader_path, const std::vector<ShaderDefine>& defines
+	) -> ShaderCompileDesc;
+
+	/**
+	 * Shows a failed compile to the user, the compiler messages are written to a file.
+	 * @param errors compiler messages, empty if the file is missing
+	 */
+	static void ReportCompileError(HWND hwnd, const std::string& errors, LPCWSTR path);
+
+	/**
+	 * Creates the constant buffers, \c MatrixBufferType in register b0 and
+	 * \c TextureBufferType in register b1.
+	 */
+	auto AddBuffer(RenderDevice& device) -> HRESULT;
+
+	/**
+	 * Returns the registry handles of the input layout and of the shader of every stage,
+	 * \c ShaderRegistry::NO_HANDLE for the stages the program does not use.
+	 */
+	[[nodiscard]] auto GetLayout() const -> ShaderRegistry::Handle;
+	[[nodiscard]] auto GetShaders() const
+		-> const std::array<ShaderRegistry::Handle, size_t(ShaderType::NUMBER)>&;
+
+	[[nodiscard]] auto GetMatrixBuffer() const -> RenderDevice::Handle;
+	[[nodiscard]] auto GetTextureBuffer() const -> RenderDevice::Handle;
 
 private:
 	template <typename T>
 	auto CreateShader(
-		ID3D11Device* device, HWND hwnd, LPCWSTR shader_path
+		RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
 	) -> HRESULT;
 
-	void RenderShader(ID3D11DeviceContext* deviceContext, unsigned int indexCount);
+	/**
+	 * Gets the bytecode from the cache and reports compile errors to the user.
+	 */
+	static auto GetBytecode(
+		HWND hwnd, ShaderCache& cache, const ShaderCompileDesc& desc,
+		std::vector<uint8_t>& bytecode
+	) -> HRESULT;
 
 	static void OutputShaderErrorMessage(
-		ID3D10Blob *errorMessage,
+		const std::string& errorMessage,
 		HWND hwnd,
 		const WCHAR *shaderFilename
 	);
 
-	Microsoft::WRL::ComPtr<ID3D11InputLayout> m_layout{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11Buffer> m_matrix_buffer{ nullptr };
+	// Creates and releases the constant buffers and the registry objects
+	RenderDevice* m_device{ nullptr };
+	RenderDevice::Handle m_matrix_buffer{ RenderDevice::NO_RESOURCE };
+	RenderDevice::Handle m_texture_buffer{ RenderDevice::NO_RESOURCE };
 
-	// This needs to be a vector of pointer because we use inheratence for the shader
-	std::vector<std::unique_ptr<Shader>> m_shaders;
+	// Handles into the registry, one shader per stage
+	ShaderRegistry* m_registry{ nullptr };
+	ShaderRegistry::Handle m_layout{ ShaderRegistry::NO_HANDLE };
+	std::array<ShaderRegistry::Handle, size_t(ShaderType::NUMBER)> m_shaders{};
 
 };
 
@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_registry.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_device.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShaderRegistry
+/// Owns the shader and input layout objects of all shader programs. An object is found by
+/// the hash of its bytecode, so programs that use the same stage get the same object and
+/// only hold a handle to it. Objects are reference counted and released with their last
+/// handle, freed handles are reused.
+///
+/// Since equal stages share one handle, comparing handles is enough to skip a redundant
+/// bind, see \c ShaderProgram::BindState. The objects are created by a \c RenderDevice,
+/// \c GetDeviceHandle returns the device handle of a registry handle.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShaderRegistry
+{
+
+public:
+	using Handle = uint32_t;
+	static constexpr Handle NO_HANDLE = UINT32_MAX;
+
+	struct Stats
+	{
+		// Objects that exist right now
+		size_t objects{ 0 };
+		// Handles that are held right now, each one would be an object without sharing
+		size_t references{ 0 };
+		// Totals since startup
+		size_t created{ 0 };
+		size_t shared{ 0 };
+	};
+
+	ShaderRegistry() = default;
+	ShaderRegistry(const ShaderRegistry& other) = delete;
+	ShaderRegistry(ShaderRegistry&& other) noexcept = delete;
+	auto operator=(const ShaderRegistry& other) -> ShaderRegistry = delete;
+	auto operator=(ShaderRegistry&& other) -> ShaderRegistry& = delete;
+	~ShaderRegistry() = default;
+
+	/**
+	 * Returns a handle to the vertex shader with the bytecode, it is created if no program
+	 * holds one yet.
+	 */
+	auto AcquireVertexShader(
+		RenderDevice& device, const std::vector<uint8_t>& bytecode, Handle& handle
+	) -> HRESULT;
+	auto AcquirePixelShader(
+		RenderDevice& device, const std::vector<uint8_t>& bytecode, Handle& handle
+	) -> HRESULT;
+
+	/**
+	 * Returns a handle to an input layout, layouts are shared if both the elements and the
+	 * vertex shader bytecode they are validated against are equal.
+	 */
+	auto AcquireLayout(
+		RenderDevice& device, const std::vector<VertexElement>& elements,
+		const std::vector<uint8_t>& bytecode, Handle& handle
+	) -> HRESULT;
+
+	/**
+	 * Gives up a handle, the object is released once no handle to it is left.
+	 */
+	void Release(RenderDevice& device, Handle handle);
+
+	/**
+	 * Returns the device handle of the shader or input layout.
+	 */
+	[[nodiscard]] auto GetDeviceHandle(Handle handle) const -> RenderDevice::Handle;
+
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+private:
+	enum class Kind : uint8_t
+	{
+		VertexShader = 0,
+		PixelShader,
+		InputLayout
+	};
+
+	struct Entry
+	{
+		Kind kind{ Kind::VertexShader };
+		uint64_t hash{ 0 };
+		// Everything the object was created from, compared to rule out hash collisions
+		std::vector<uint8_t> key{};
+		RenderDevice::Handle object{ RenderDevice::NO_RESOURCE };
+		uint32_t references{ 0 };
+	};
+
+	/**
+	 * Returns the handle of an existing object with the key or creates one with \p create,
+	 * which receives the device handle to fill.
+	 */
+	template <class F>
+	auto Acquire(Kind kind, std::vector<uint8_t>&& key, Handle& handle, F&& create) -> HRESULT;
+
+	std::vector<Entry> m_entries{};
+	std::vector<Handle> m_free_handles{};
+	std::unordered_multimap<uint64_t, Handle> m_lookup{};
+	Stats m_stats{};
+};
+
+} // namespace graphics
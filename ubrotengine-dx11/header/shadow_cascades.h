@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shadow_cascades.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "camera.h"
+#include "math_types.h"
+#include "thread_pool.h"
+#include "view_culler.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShadowCascades
+/// Places the cascades of a directional light shadow map. The depth range of the camera is
+/// split into one slice per cascade, near cascades cover short slices at a high density and
+/// far cascades long ones. Every cascade is an orthographic \c Camera looking along the light,
+/// fitted around the bounding sphere of its slice. Since the size of a sphere does not change
+/// when the camera turns, and the cascade is moved in steps of whole texels, the shadow edges
+/// do not shimmer when the camera moves.
+///
+/// The far cascades are cached. They are fitted with a margin and keep their placement while
+/// their slice stays inside, so they only have to be rendered again if the light moves, the
+/// slice leaves the margin or the casters inside them change.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadowCascades
+{
+
+public:
+	static constexpr size_t CASCADE_COUNT = 4;
+	// Cascades from this one on are cached
+	static constexpr size_t FIRST_CACHED_CASCADE = 2;
+	// Cached cascades cover this multiple of the radius of their slice
+	static constexpr float CACHE_MARGIN = 1.25F;
+	// Blend between uniform (0) and logarithmic (1) split distances
+	static constexpr float SPLIT_LAMBDA = 0.75F;
+
+	struct Stats
+	{
+		// Objects that cast a shadow into each cascade this frame
+		std::array<size_t, CASCADE_COUNT> casters{};
+		// Cascades that have to be rendered this frame
+		size_t rendered_cascades{ 0 };
+		// Cached cascades that could be reused or had to be rendered, totals since startup
+		size_t cache_hits{ 0 };
+		size_t cache_misses{ 0 };
+	};
+
+	ShadowCascades() = default;
+	ShadowCascades(const ShadowCascades& other) = delete;
+	ShadowCascades(ShadowCascades&& other) noexcept = delete;
+	auto operator=(const ShadowCascades& other) -> ShadowCascades = delete;
+	auto operator=(ShadowCascades&& other) -> ShadowCascades& = delete;
+	~ShadowCascades() = default;
+
+	/**
+	 * @param resolution width and height of the shadow map of one cascade in texels
+	 * @param distance the shadows end at this distance from the camera
+	 * @param caster_range objects up to this far from a cascade towards the light still cast
+	 *        a shadow into it
+	 */
+	void SetShadowMap(uint32_t resolution, float distance, float caster_range);
+
+	/**
+	 * @param direction the direction the light shines into, it does not have to be
+	 *        normalized but must not be zero
+	 */
+	void SetLightDirection(const math::Float3& direction);
+
+	/**
+	 * Splits the depth range of \p camera and fits the cascades to the slices.
+	 * @param near_z near plane of the camera's projection
+	 * @param far_z far plane of the camera's projection
+	 */
+	void Update(const Camera& camera, float near_z, float far_z);
+
+	/**
+	 * Collects the casters of every cascade from the spheres of \p culler, one cascade per
+	 * task, and decides which cascades have to be rendered.
+	 * @param keys one value per sphere that changes with its geometry, e.g. its model index
+	 */
+	void Cull(
+		const ViewCuller& culler, const std::vector<uint32_t>& keys, utils::ThreadPool& pool
+	);
+
+	[[nodiscard]] auto GetCamera(size_t cascade) const -> const Camera&;
+	/**
+	 * Returns the distance from the camera at which the cascade ends.
+	 */
+	[[nodiscard]] auto GetSplit(size_t cascade) const -> float;
+	/**
+	 * Returns the indices of the spheres that cast a shadow into the cascade.
+	 */
+	[[nodiscard]] auto GetCasters(size_t cascade) const -> const std::vector<uint32_t>&;
+	/**
+	 * Returns whether the cascade has to be rendered this frame, otherwise its shadow map
+	 * still holds the right content.
+	 */
+	[[nodiscard]] auto NeedsRender(size_t cascade) const -> bool;
+	[[nodiscard]] auto GetStats() const -> const Stats&;
+
+	/**
+	 * Returns the distance at which every cascade ends, a blend of uniform and logarithmic
+	 * splits. The last one is \p far_z.
+	 */
+	static auto ComputeSplits(float near_z, float far_z, float lambda)
+		-> std::array<float, CASCADE_COUNT>;
+
+private:
+	struct Cascade
+	{
+		// Region the cascade covers, the camera sits in front of it towards the light
+		math::Float3 center{ 0.0F, 0.0F, 0.0F };
+		float radius{ 0.0F };
+		uint64_t caster_hash{ 0 };
+		// Set once the cached content matches the placement
+		bool valid{ false };
+		bool moved{ false };
+		bool needs_render{ true };
+	};
+
+	/**
+	 * Moves the center in steps of whole texels of a map covering 2 * \p radius.
+	 */
+	[[nodiscard]] auto SnapToTexels(const math::Float3& center, float radius) const
+		-> math::Float3;
+
+	/**
+	 * Places the camera of a cascade in front of its region.
+	 */
+	void PlaceCamera(size_t cascade);
+
+	std::array<Camera, CASCADE_COUNT> m_cameras{};
+	std::array<Cascade, CASCADE_COUNT> m_cascades{};
+	std::array<std::vector<uint32_t>, CASCADE_COUNT> m_casters{};
+	std::array<float, CASCADE_COUNT> m_splits{};
+
+	math::Float3 m_light_direction{ 0.0F, -1.0F, 0.0F };
+	uint32_t m_resolution{ 2048 };
+	float m_distance{ 100.0F };
+	float m_caster_range{ 100.0F };
+
+	Stats m_stats{};
+};
+
+} // namespace graphics
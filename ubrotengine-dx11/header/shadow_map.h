@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shadow_map.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_device.h"
+#include "render_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShadowMap
+/// Depth texture array with one slice per shadow cascade. Every slice is rendered without a
+/// color target, shaders sample all slices at once.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadowMap
+{
+
+public:
+	ShadowMap() = default;
+	ShadowMap(const ShadowMap& other) = delete;
+	ShadowMap(ShadowMap&& other) noexcept = delete;
+	auto operator=(const ShadowMap& other) -> ShadowMap = delete;
+	auto operator=(ShadowMap&& other) -> ShadowMap& = delete;
+	~ShadowMap() = default;
+
+	/**
+	 * Creates the texture, a previous size is released first.
+	 * @param size width and height of a slice in texels
+	 */
+	auto Initialize(RenderDevice& device, uint32_t size, uint32_t slice_count) -> HRESULT;
+
+	[[nodiscard]] auto GetTarget() const -> RenderDevice::Handle;
+
+	/**
+	 * Returns a viewport that covers a whole slice.
+	 */
+	[[nodiscard]] auto GetViewport() const -> const Viewport&;
+
+private:
+	RenderDevice::Handle m_target{ RenderDevice::NO_RESOURCE };
+
+	Viewport m_viewport{};
+};
+
+} // namespace graphics
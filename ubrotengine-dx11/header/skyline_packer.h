@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: skyline_packer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: SkylinePacker
+/// Places rectangles into a fixed size area without overlap. Only the upper outline of the
+/// placed rectangles (the skyline) is stored as a list of horizontal segments, a new
+/// rectangle is put where its top edge ends up lowest (bottom-left rule), ties go to the
+/// segment that leaves the least wasted area below the rectangle.
+///
+/// The packer is offline in the sense that rectangles are never removed, inserting them
+/// sorted by decreasing height gives the best results.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class SkylinePacker
+{
+
+public:
+	SkylinePacker() = default;
+	SkylinePacker(uint32_t width, uint32_t height);
+
+	/**
+	 * Removes all rectangles and sets the size of the area.
+	 */
+	void Reset(uint32_t width, uint32_t height);
+
+	/**
+	 * Finds a place for a \p width x \p height rectangle and marks it as used.
+	 * @param x, y receive the top left corner of the rectangle
+	 * @return false if the rectangle does not fit anymore
+	 */
+	auto Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) -> bool;
+
+	[[nodiscard]] auto GetWidth() const -> uint32_t;
+	[[nodiscard]] auto GetHeight() const -> uint32_t;
+
+	/**
+	 * Returns the summed area of all inserted rectangles.
+	 */
+	[[nodiscard]] auto GetUsedArea() const -> uint64_t;
+
+	/**
+	 * Returns the height of the highest skyline segment.
+	 */
+	[[nodiscard]] auto GetUsedHeight() const -> uint32_t;
+
+	/**
+	 * Returns the share of the area below the highest segment that is covered by rectangles.
+	 */
+	[[nodiscard]] auto GetOccupancy() const -> float;
+
+private:
+	struct Segment
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+	};
+
+	/**
+	 * Computes the height a rectangle would be placed at if its left edge starts at the
+	 * segment \p idx, and the area left unused below it.
+	 * @return false if the rectangle does not fit there
+	 */
+	auto Fit(std::size_t idx, uint32_t width, uint32_t height, uint32_t& y, uint64_t& waste) const
+		-> bool;
+
+	void Place(std::size_t idx, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+	uint32_t m_width{ 0 };
+	uint32_t m_height{ 0 };
+	uint64_t m_used_area{ 0 };
+
+	std::vector<Segment> m_skyline{};
+};
+
+} // namespace utils
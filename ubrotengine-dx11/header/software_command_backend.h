@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: software_command_backend.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_types.h"
+#include "asset_manager.h"
+#include "camera.h"
+#include "math_types.h"
+#include "software_rasterizer.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareCommandBackend
+/// Replays a \c CommandBuffer with a \c SoftwareRasterizer, see \c CommandBuffer. The draws
+/// read the CPU copies of the shared geometry buffers (\c AssetManager::KeepGeometryOnCpu)
+/// at the same offsets and with the same matrices as \c D3D11CommandBackend.
+///
+/// Every program is drawn like color.vs/color.fs, textures are ignored. Draws of views
+/// without a target, e.g. the reflection and the shadow cascades, and of models whose
+/// vertices are not \c vertices::ColVertex are skipped.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class SoftwareCommandBackend
+{
+
+public:
+	struct View
+	{
+		const Camera* camera{ nullptr };
+		Viewport viewport{};
+		SoftwareRasterizer* target{ nullptr };
+		std::array<float, 4> clear_color{ 0.0F, 0.0F, 0.0F, 1.0F };
+	};
+
+	/**
+	 * @param views the views the commands refer to by index, they have to outlive the backend
+	 */
+	SoftwareCommandBackend(assets::AssetManager& asset_manager, const std::vector<View>& views);
+	SoftwareCommandBackend(const SoftwareCommandBackend& other) = delete;
+	SoftwareCommandBackend(SoftwareCommandBackend&& other) noexcept = delete;
+	auto operator=(const SoftwareCommandBackend& other) -> SoftwareCommandBackend = delete;
+	auto operator=(SoftwareCommandBackend&& other) -> SoftwareCommandBackend& = delete;
+	~SoftwareCommandBackend() = default;
+
+	void SetProgram(uint32_t program_idx);
+	void SetModel(uint32_t model_idx);
+	void SetWorldMatrix(const math::Float4x4& world);
+	void SetTexture(uint32_t texture_idx);
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex);
+	void SetView(uint32_t view_idx);
+	void ClearView(uint32_t view_idx);
+
+	/**
+	 * Returns the number of draws that could not be drawn on the CPU.
+	 */
+	[[nodiscard]] auto GetSkippedDraws() const -> size_t;
+
+private:
+	assets::AssetManager& m_asset_manager;
+	const std::vector<View>& m_views;
+
+	SoftwareRasterizer* m_target{ nullptr };
+	math::Float4x4 m_view_projection{};
+	math::Float4x4 m_world_matrix{};
+	const vertices::Model* m_model{ nullptr };
+	uint32_t m_view_idx{ UINT32_MAX };
+	uint32_t m_model_idx{ UINT32_MAX };
+
+	size_t m_skipped_draws{ 0 };
+};
+
+} // namespace graphics
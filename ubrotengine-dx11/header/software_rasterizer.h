@@ -0,0 +1,216 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: software_rasterizer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "render_types.h"
+#include "image_decoder.h"
+#include "math_types.h"
+#include "thread_pool.h"
+#include "vertex_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: SoftwareRasterizer
+/// Draws colored triangles into an RGBA color buffer with a depth buffer on the CPU. It
+/// matches the color.vs/color.fs programs with the rasterizer state of \c Direct3D: back
+/// faces (counter clockwise on screen) are culled, the depth test passes if the depth is
+/// less than the stored one, and colors are interpolated perspective correct.
+///
+/// \c DrawIndexed transforms the vertices four at a time with SSE2, clips triangles that
+/// cross the near plane or leave the guard band, and bins the remaining ones into the screen
+/// tiles their bounding box touches. \c Flush rasterizes the tiles in parallel, each one
+/// walks its triangles in submission order, so the result does not depend on the number of
+/// threads. Coverage is tested with the edge functions of the triangle for eight pixels at
+/// a time, with the top-left fill rule of Direct3D, so triangles that share an edge neither
+/// overlap nor leave gaps.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class SoftwareRasterizer
+{
+
+public:
+	static constexpr int32_t TILE_SIZE = 64;
+	// Vertices further outside of the viewport are clipped, closer ones are only rasterized
+	static constexpr float GUARD_BAND_PIXELS = 4096.0F;
+	// Screen positions are snapped to this fraction of a pixel, like on the GPU
+	static constexpr float SUBPIXEL_STEPS = 256.0F;
+
+	/**
+	 * Counters since the last \c ResetStats.
+	 */
+	struct Stats
+	{
+		size_t triangles{ 0 };
+		// Triangles that were binned, after culling and clipping
+		size_t visible_triangles{ 0 };
+		size_t clipped_triangles{ 0 };
+		// Sum of the tiles each visible triangle was binned into
+		size_t bin_entries{ 0 };
+		double setup_ms{ 0.0 };
+		double raster_ms{ 0.0 };
+	};
+
+	/**
+	 * @param thread_pool rasterizes the tiles, can be nullptr
+	 */
+	explicit SoftwareRasterizer(utils::ThreadPool* thread_pool = nullptr);
+	SoftwareRasterizer(const SoftwareRasterizer& other) = delete;
+	SoftwareRasterizer(SoftwareRasterizer&& other) noexcept = delete;
+	auto operator=(const SoftwareRasterizer& other) -> SoftwareRasterizer = delete;
+	auto operator=(SoftwareRasterizer&& other) -> SoftwareRasterizer& = delete;
+	~SoftwareRasterizer() = default;
+
+	/**
+	 * Resizes the color and depth buffer, their content is lost.
+	 */
+	void Resize(uint32_t width, uint32_t height);
+
+	/**
+	 * Sets the viewport of the following draws, pixels outside of it are not touched.
+	 */
+	void SetViewport(const Viewport& viewport);
+
+	/**
+	 * Fills the whole color buffer with \p color and the depth buffer with \p depth.
+	 * Draws that were not flushed yet are rasterized first.
+	 */
+	void Clear(const std::array<float, 4>& color, float depth);
+
+	/**
+	 * Transforms the vertices and bins the triangles of an indexed triangle list.
+	 * @param vertices first vertex of the model, the indices are relative to it
+	 * @param vertex_count number of vertices the indices may refer to
+	 * @param transform world, view and projection matrix, positions are row vectors
+	 */
+	void DrawIndexed(
+		const vertices::ColVertex* vertices, uint32_t vertex_count,
+		const uint32_t* indices, uint32_t index_count,
+		const math::Float4x4& transform
+	);
+
+	/**
+	 * Rasterizes all binned triangles.
+	 */
+	void Flush();
+
+	/**
+	 * Copies the color buffer into \p image, draws that were not flushed are missing.
+	 */
+	void ReadImage(io::Image& image) const;
+
+	[[nodiscard]] auto GetWidth() const -> uint32_t;
+	[[nodiscard]] auto GetHeight() const -> uint32_t;
+	[[nodiscard]] auto GetStats() const -> const Stats&;
+	void ResetStats();
+
+private:
+	/**
+	 * Position in clip space and color of a vertex.
+	 */
+	struct ClipVertex
+	{
+		std::array<float, 4> position;
+		std::array<float, 4> color;
+	};
+
+	/**
+	 * Snapped screen position, depth, 1/w and color of a vertex.
+	 */
+	struct ScreenVertex
+	{
+		float x, y, z, inv_w;
+		std::array<float, 4> color;
+	};
+
+	// Depth, 1/w and the color channels multiplied with 1/w
+	static constexpr size_t ATTRIBUTE_COUNT = 6;
+
+	/**
+	 * Triangle that was set up for rasterization. Edge k is the one opposite to vertex k,
+	 * its function a * x + b * y + c is positive inside, zero on the edge and equals the
+	 * doubled area at vertex k.
+	 */
+	struct Triangle
+	{
+		std::array<float, 3> a;
+		std::array<float, 3> b;
+		std::array<double, 3> c;
+		// Pixels on an edge are covered if it is a top or left edge
+		std::array<bool, 3> top_left;
+		float inv_area;
+		// Pixel bounds, already clamped to the viewport
+		int32_t min_x, min_y, max_x, max_y;
+		// Attributes at vertex 0 and their differences from vertex 0 to vertex 1 and 2
+		std::array<float, ATTRIBUTE_COUNT> attributes;
+		std::array<float, ATTRIBUTE_COUNT> delta1;
+		std::array<float, ATTRIBUTE_COUNT> delta2;
+	};
+
+	/**
+	 * Transforms \p count vertices into \c m_clip, \c m_screen and \c m_outcodes.
+	 */
+	void TransformVertices(
+		const vertices::ColVertex* vertices, uint32_t count, const math::Float4x4& transform
+	);
+
+	/**
+	 * Clips a triangle against the planes of \p outcodes and sets up the pieces.
+	 */
+	void ClipTriangle(const std::array<ClipVertex, 3>& triangle, uint32_t outcodes);
+
+	[[nodiscard]] auto Project(const ClipVertex& vertex) const -> ScreenVertex;
+
+	/**
+	 * Culls back faces and bins the triangle into the tiles its bounds touch.
+	 */
+	void SetupTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2);
+
+	void RasterizeTile(size_t tile);
+
+	utils::ThreadPool* m_thread_pool;
+
+	uint32_t m_width{ 0 };
+	uint32_t m_height{ 0 };
+	// Rows are padded to whole blocks of eight pixels
+	uint32_t m_pitch{ 0 };
+	std::vector<uint32_t> m_color{};
+	std::vector<float> m_depth{};
+
+	// Viewport in pixels (inclusive) and the transform from clip space to the screen
+	Viewport m_viewport{};
+	int32_t m_viewport_min_x{ 0 };
+	int32_t m_viewport_min_y{ 0 };
+	int32_t m_viewport_max_x{ -1 };
+	int32_t m_viewport_max_y{ -1 };
+	std::array<float, 2> m_guard_band{};
+
+	// Per draw, indexed like the vertices
+	std::vector<math::Float4> m_clip{};
+	std::vector<ScreenVertex> m_screen{};
+	std::vector<uint8_t> m_outcodes{};
+
+	// Triangles of all draws since the last flush and the triangles of every tile
+	std::vector<Triangle> m_triangles{};
+	std::vector<std::vector<uint32_t>> m_bins{};
+	std::vector<size_t> m_active_tiles{};
+	uint32_t m_tiles_x{ 0 };
+	uint32_t m_tiles_y{ 0 };
+
+	Stats m_stats{};
+};
+
+} // namespace graphics
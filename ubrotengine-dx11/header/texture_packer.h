@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: texture_packer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "asset_loader.h"
+#include "math_types.h"
+#include "render_device.h"
+#include "skyline_packer.h"
+
+
+namespace assets
+{
+
+/**
+ * Where a texture ended up after packing. Shaders sample the array \a array_idx at the
+ * given slice and transform the model UVs with \a uv_transform.
+ */
+struct TextureLocation
+{
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	uint32_t array_idx{ NONE };
+	uint32_t slice{ 0 };
+	// Scale (x, y) and offset (z, w) of the UVs, only atlas textures use a part of the slice
+	math::Float4 uv_transform{ 1.0F, 1.0F, 0.0F, 0.0F };
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: TexturePacker
+/// Combines textures into as few texture arrays as possible, so that switching between them
+/// does not need a new shader resource binding:
+///		- Textures with the same format, size and mip count become slices of one array.
+///		- Small RGBA textures are packed into atlas pages with a \c SkylinePacker, the pages
+///		  are slices of one array per format. Each texture gets a padding of repeated border
+///		  pixels so that filtering does not bleed into its neighbours, which is only enough
+///		  for the first ATLAS_MIP_COUNT mip levels, so atlas arrays have a short mip chain.
+///		- DDS arrays and cubemaps are kept as they are.
+///		- Textures added with \c AddUnpacked get their own array, which can be replaced.
+///
+/// Textures are queued with \c Add and the arrays are created with \c Build, textures that
+/// are added afterwards go into new arrays on the next \c Build.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class TexturePacker
+{
+
+public:
+	struct Stats
+	{
+		size_t textures{ 0 };
+		size_t arrays{ 0 };
+		size_t atlas_textures{ 0 };
+		size_t atlas_pages{ 0 };
+		// Share of the atlas page area covered by texture pixels (without padding)
+		float atlas_occupancy{ 0.0F };
+	};
+
+	TexturePacker() = default;
+	TexturePacker(const TexturePacker& other) = delete;
+	TexturePacker(TexturePacker&& other) noexcept = delete;
+	auto operator=(const TexturePacker& other) -> TexturePacker = delete;
+	auto operator=(TexturePacker&& other) -> TexturePacker& = delete;
+	~TexturePacker() = default;
+
+	/**
+	 * Queues a texture for the next \c Build. A texture without subresources (e.g. one that
+	 * failed to load) keeps an empty location.
+	 * @return index of the texture
+	 */
+	auto Add(io::TextureData&& data) -> size_t;
+
+	/**
+	 * Reserves an index for a texture that is not packed, its array is set with
+	 * \c SetUnpacked.
+	 */
+	auto AddUnpacked() -> size_t;
+
+	/**
+	 * Sets or replaces the array of a texture that is not packed, e.g. when a streamed
+	 * texture got new mip levels. The location keeps its array index, the replaced array is
+	 * released.
+	 */
+	void SetUnpacked(
+		graphics::RenderDevice& device, size_t texture_idx,
+		graphics::RenderDevice::Handle texture
+	);
+
+	/**
+	 * Returns true if textures were added since the last \c Build.
+	 */
+	[[nodiscard]] auto HasPending() const -> bool;
+
+	/**
+	 * Creates the arrays for all queued textures and releases their CPU data.
+	 * @return the first error, the other arrays are still created
+	 */
+	auto Build(graphics::RenderDevice& device) -> HRESULT;
+
+	/**
+	 * Returns the location of a texture, it is empty until the texture was built.
+	 */
+	[[nodiscard]] auto GetLocation(size_t texture_idx) const -> const TextureLocation&;
+	[[nodiscard]] auto GetArray(uint32_t array_idx) const -> graphics::RenderDevice::Handle;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+	/**
+	 * Maps a UV of the original texture to the UV inside its slice.
+	 */
+	static auto RemapUv(const TextureLocation& location, const math::Float2& uv)
+		-> math::Float2;
+
+private:
+	// Atlas pages are at most this size, textures up to ATLAS_MAX_TEXTURE_SIZE are packed
+	static constexpr uint32_t ATLAS_PAGE_SIZE = 2048;
+	static constexpr uint32_t ATLAS_MAX_TEXTURE_SIZE = 256;
+	static constexpr uint32_t ATLAS_MIP_COUNT = 3;
+	// Slices of one array, D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+	static constexpr size_t MAX_SLICES = 2048;
+	// Border around each texture, at the smallest mip it is still one pixel wide. It is also
+	// the alignment of the textures, so their mips start at whole pixels.
+	static constexpr uint32_t ATLAS_PADDING = 1 << (ATLAS_MIP_COUNT - 1);
+
+	struct Pending
+	{
+		size_t texture_idx;
+		io::TextureData data;
+	};
+
+	[[nodiscard]] static auto IsAtlasCandidate(const io::TextureData& data) -> bool;
+
+	/**
+	 * Packs all \p entries, which share one format, into the pages of a new array.
+	 */
+	auto BuildAtlas(graphics::RenderDevice& device, const std::vector<Pending*>& entries)
+		-> HRESULT;
+
+	/**
+	 * Puts all \p entries, which share format, size and mip count, into a new array.
+	 */
+	auto BuildArray(graphics::RenderDevice& device, const std::vector<Pending*>& entries)
+		-> HRESULT;
+
+	std::vector<Pending> m_pending{};
+	std::vector<TextureLocation> m_locations{};
+	std::vector<graphics::RenderDevice::Handle> m_arrays{};
+
+	size_t m_atlas_textures{ 0 };
+	size_t m_atlas_pages{ 0 };
+	uint64_t m_atlas_used_area{ 0 };
+	uint64_t m_atlas_page_area{ 0 };
+};
+
+} // namespace assets
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: texture_streamer.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "asset_loader.h"
+#include "mip_streamer.h"
+#include "texture_packer.h"
+#include "thread_pool.h"
+
+
+namespace assets
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: TextureStreamer
+/// Streams the mip levels of large DDS textures. A texture starts with its levels up to
+/// TAIL_SIZE, the \c MipStreamer decides which more detailed levels are loaded or evicted.
+/// Loads copy the levels out of the file or archive on a background I/O thread, so page faults
+/// never stall the render thread, and the texture is recreated with the new levels once the
+/// copy is done.
+///
+/// Streamed textures are not packed, every texture has its own array in the
+/// \c TexturePacker which is replaced whenever its levels change.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class TextureStreamer
+{
+
+public:
+	// Levels up to this size are always resident
+	static constexpr uint32_t TAIL_SIZE = 64;
+
+	TextureStreamer() = default;
+	TextureStreamer(const TextureStreamer& other) = delete;
+	TextureStreamer(TextureStreamer&& other) noexcept = delete;
+	auto operator=(const TextureStreamer& other) -> TextureStreamer = delete;
+	auto operator=(TextureStreamer&& other) -> TextureStreamer& = delete;
+	~TextureStreamer() = default;
+
+	/**
+	 * Returns true for single DDS textures whose mip chain reaches down to TAIL_SIZE.
+	 */
+	static auto IsStreamable(const io::TextureData& data) -> bool;
+
+	/**
+	 * Registers a texture, its tail levels are created by the next \c Update.
+	 * @param texture_idx index of the texture in the packer, see \c TexturePacker::AddUnpacked
+	 */
+	void Add(size_t texture_idx, io::TextureData&& data);
+
+	void SetBudget(size_t bytes);
+	void BeginFrame();
+
+	/**
+	 * Reports that the texture is drawn in this frame, ignored for textures that are not
+	 * streamed.
+	 * @param screen_pixels number of pixels the texture covers along its larger axis
+	 */
+	void Request(size_t texture_idx, float screen_pixels);
+
+	/**
+	 * Creates the textures of finished loads, evicts levels and starts new loads.
+	 * @param max_load_bytes bytes that may start loading in this frame
+	 */
+	auto Update(
+		graphics::RenderDevice& device, TexturePacker& textures, size_t max_load_bytes
+	) -> HRESULT;
+
+	/**
+	 * Blocks until the loads started by the last \c Update are copied, the next \c Update
+	 * creates their textures.
+	 */
+	void WaitForLoads();
+
+	[[nodiscard]] auto GetStats() const -> MipStreamer::Stats;
+
+private:
+	struct Source
+	{
+		io::TextureData data{};
+		// Memory of each level in the file, without any padding
+		std::vector<size_t> level_bytes{};
+	};
+
+	/**
+	 * Levels that were copied by the I/O thread.
+	 */
+	struct Load
+	{
+		size_t texture_idx{ 0 };
+		uint32_t top_mip{ 0 };
+		std::vector<uint8_t> staging{};
+		std::vector<graphics::SubresourceData> subresources{};
+	};
+
+	/**
+	 * Copies the levels [\p top_mip, \p resident_mip) into a load, the other levels are
+	 * already in memory and are taken from the mapping. Runs on the I/O thread.
+	 */
+	void ReadLevels(
+		const Source& source, size_t texture_idx, uint32_t top_mip, uint32_t resident_mip
+	);
+
+	/**
+	 * Creates the texture with the levels starting at \p top_mip and replaces the previous
+	 * one in the packer.
+	 * @param subresources data of the levels, starting with \p top_mip
+	 */
+	static auto CreateTexture(
+		graphics::RenderDevice& device, TexturePacker& textures, const Source& source,
+		size_t texture_idx, uint32_t top_mip, const graphics::SubresourceData* subresources
+	) -> HRESULT;
+
+	// Indexed by texture, empty for textures that are not streamed. The sources never move,
+	// so the I/O thread can read them while new textures are added.
+	std::vector<std::unique_ptr<Source>> m_sources{};
+	std::vector<size_t> m_new_textures{};
+
+	MipStreamer m_mips{};
+	std::vector<MipStreamer::Change> m_loads{};
+	std::vector<MipStreamer::Change> m_evictions{};
+
+	std::mutex m_finished_mutex{};
+	std::vector<Load> m_finished{};
+
+	// Destroyed first, so all queued reads are done before the sources go away
+	utils::ThreadPool m_io_thread{ 1 };
+};
+
+} // namespace assets
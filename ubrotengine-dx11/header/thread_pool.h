@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: thread_pool.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ThreadPool
+/// Fixed number of worker threads which execute queued jobs. The thread calling
+/// \c ParallelFor takes part in the work, so it is safe to call it from inside a job.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ThreadPool
+{
+
+public:
+	/**
+	 * Starts the worker threads.
+	 * @param worker_count number of workers, 0 uses the hardware concurrency minus the
+	 *        calling thread
+	 */
+	explicit ThreadPool(size_t worker_count = 0);
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool(ThreadPool&& other) noexcept = delete;
+	auto operator=(const ThreadPool& other) -> ThreadPool = delete;
+	auto operator=(ThreadPool&& other) -> ThreadPool& = delete;
+	~ThreadPool();
+
+	/**
+	 * Queues a job which is executed by one of the workers at some later point.
+	 */
+	void Submit(std::function<void()> job);
+
+	/**
+	 * Splits the range [0, \p count) into \p chunk_count contiguous chunks and calls
+	 * \p fn(begin, end, chunk_idx) for each of them. Blocks until all chunks are done.
+	 */
+	void ParallelFor(
+		size_t count, size_t chunk_count,
+		const std::function<void(size_t, size_t, size_t)>& fn
+	);
+
+	/**
+	 * Blocks until all queued jobs have been executed.
+	 */
+	void Wait();
+
+	/**
+	 * Returns the number of threads that take part in \c ParallelFor (workers + caller).
+	 */
+	[[nodiscard]] auto GetThreadCount() const -> size_t;
+
+private:
+	void WorkerLoop();
+	auto TryRunJob() -> bool;
+
+	std::vector<std::thread> m_workers{};
+	std::deque<std::function<void()>> m_jobs{};
+
+	std::mutex m_mutex{};
+	std::condition_variable m_job_cv{};
+	std::condition_variable m_done_cv{};
+
+	size_t m_active{ 0 };
+	bool m_stop{ false };
+};
+
+} // namespace utils
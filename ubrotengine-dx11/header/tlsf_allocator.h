@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsf_allocator.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: TlsfAllocator
+/// Two-level segregated-fit allocator for ranges of an external memory block, e.g. a GPU
+/// buffer. The allocator only manages offsets and never touches the memory itself, all units
+/// are elements of the managed block. Allocating and freeing are O(1): free blocks are kept in
+/// size classes (first level: power of two, second level: linear subdivision) which are found
+/// with two bit scans, and freed blocks are merged with their free neighbours immediately.
+///
+/// Allocations are referred to by handles which stay valid when the allocation is moved by
+/// \c PlanDefrag, only its offset changes.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class TlsfAllocator
+{
+
+public:
+	using Handle = uint32_t;
+	static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+	struct Stats
+	{
+		uint32_t capacity{ 0 };
+		uint32_t used{ 0 };
+		uint32_t allocations{ 0 };
+		uint32_t free_blocks{ 0 };
+		uint32_t largest_free_block{ 0 };
+
+		/**
+		 * Returns 0 if all free space is one contiguous block and approaches 1 the more
+		 * the free space is split up.
+		 */
+		[[nodiscard]] auto GetFragmentation() const -> float;
+	};
+
+	/**
+	 * Relocation of one allocation as planned by \c PlanDefrag. The memory has to be copied
+	 * from \a src_offset to \a dst_offset before the allocation is used again. Source and
+	 * destination ranges never overlap.
+	 */
+	struct Move
+	{
+		Handle handle;
+		uint32_t user_data;
+		uint32_t src_offset;
+		uint32_t dst_offset;
+		uint32_t size;
+	};
+
+	explicit TlsfAllocator(uint32_t capacity = 0);
+	TlsfAllocator(const TlsfAllocator& other) = default;
+	TlsfAllocator(TlsfAllocator&& other) noexcept = default;
+	auto operator=(const TlsfAllocator& other) -> TlsfAllocator& = default;
+	auto operator=(TlsfAllocator&& other) noexcept -> TlsfAllocator& = default;
+	~TlsfAllocator() = default;
+
+	/**
+	 * Allocates \p size elements.
+	 * @param user_data arbitrary value which is reported together with the allocation
+	 * @return handle of the allocation or \c INVALID_HANDLE if no free block is large enough
+	 */
+	auto Allocate(uint32_t size, uint32_t user_data = 0) -> Handle;
+
+	void Free(Handle handle);
+
+	/**
+	 * Enlarges the managed block to \p capacity elements, existing allocations are kept.
+	 * Shrinking is not supported.
+	 */
+	void Grow(uint32_t capacity);
+
+	/**
+	 * Moves allocations from the end of the managed block into free blocks below them, until
+	 * \p max_size elements were moved. The allocator state is updated immediately, the
+	 * caller has to carry out the returned moves in order.
+	 * @param max_size upper bound for the summed size of all moves
+	 * @param moves receives the planned moves, previous content is discarded
+	 * @return number of elements that have to be moved
+	 */
+	auto PlanDefrag(uint32_t max_size, std::vector<Move>& moves) -> uint32_t;
+
+	[[nodiscard]] auto GetOffset(Handle handle) const -> uint32_t;
+	[[nodiscard]] auto GetSize(Handle handle) const -> uint32_t;
+	[[nodiscard]] auto GetUserData(Handle handle) const -> uint32_t;
+	[[nodiscard]] auto GetCapacity() const -> uint32_t;
+	[[nodiscard]] auto GetStats() const -> Stats;
+
+	void SetUserData(Handle handle, uint32_t user_data);
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+	static constexpr uint32_t SL_BITS = 4;
+	static constexpr uint32_t SL_COUNT = 1U << SL_BITS;
+	static constexpr uint32_t FL_COUNT = 32 - SL_BITS + 1;
+
+	struct Block
+	{
+		uint32_t offset{ 0 };
+		uint32_t size{ 0 };
+		// Neighbours in memory order
+		uint32_t prev_phys{ NONE };
+		uint32_t next_phys{ NONE };
+		// Neighbours in the free list of the size class, only used by free blocks
+		uint32_t prev_free{ NONE };
+		uint32_t next_free{ NONE };
+		// Handle of the allocation, NONE for free blocks
+		Handle handle{ NONE };
+		uint32_t user_data{ 0 };
+	};
+
+	static void Mapping(uint32_t size, uint32_t& fl, uint32_t& sl);
+
+	auto FindFreeBlock(uint32_t size) const -> uint32_t;
+	void InsertFree(uint32_t block_idx);
+	void RemoveFree(uint32_t block_idx);
+
+	/**
+	 * Cuts the free block \p block_idx down to \p size and marks it as used. The remainder
+	 * becomes a new free block.
+	 */
+	auto UseBlock(uint32_t block_idx, uint32_t size, uint32_t user_data) -> Handle;
+	/**
+	 * Marks \p block_idx as free and merges it with its free neighbours.
+	 */
+	void ReleaseBlock(uint32_t block_idx);
+	void MergeInto(uint32_t block_idx, uint32_t next_idx);
+
+	auto NewBlock() -> uint32_t;
+	void DeleteBlock(uint32_t block_idx);
+
+	std::vector<Block> m_blocks{};
+	std::vector<uint32_t> m_unused_blocks{};
+	// Maps handles to block indices, handles survive moves while blocks do not
+	std::vector<uint32_t> m_handles{};
+	std::vector<Handle> m_unused_handles{};
+
+	uint32_t m_fl_bitmap{ 0 };
+	std::array<uint32_t, FL_COUNT> m_sl_bitmap{};
+	std::array<std::array<uint32_t, SL_COUNT>, FL_COUNT> m_free_heads{};
+
+	uint32_t m_first_block{ NONE };
+	uint32_t m_last_block{ NONE };
+
+	uint32_t m_capacity{ 0 };
+	uint32_t m_used{ 0 };
+	uint32_t m_allocations{ 0 };
+	uint32_t m_free_blocks{ 0 };
+};
+
+} // namespace utils
@@ -21,6 +21,7 @@
 ///////////////////////
 #include "header/scene_manager.h"
 
+#include "../header/frame_capture.h"
 #include "../header/renderer.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,7 +41,8 @@ public:
 	auto operator=(Engine&& other) -> Engine& = default;
 	UBROTENGINE_DX11_API ~Engine() = default;
 
-	// Initialize a Renderer
+	// Initialize a Renderer, the settings select its backend. Headless backends do not use
+	// the window.
 	UBROTENGINE_DX11_API auto RendererInit(const HWND& hwnd, const GraphicSettings& settings) -> HRESULT;
 
 	UBROTENGINE_DX11_API void Shutdown();
@@ -51,6 +53,9 @@ public:
 	//	HWND hwnd, int shader_type
 	//) -> bool;
 
+	// Models and textures are read from mounted archives before looking on the disk
+	UBROTENGINE_DX11_API auto MountArchive(const std::string& filename) -> bool;
+
 	UBROTENGINE_DX11_API auto RegisterModel(const std::string& filename) -> size_t;
 
 	UBROTENGINE_DX11_API auto RegisterModelProcedural(uint8_t num) -> size_t;
@@ -60,6 +65,18 @@ public:
 		const std::string& filename, uint8_t components
 	) -> size_t;
 
+	// Registers several files at once, they are read asynchronously and parsed in parallel
+	UBROTENGINE_DX11_API auto RegisterModels(
+		const std::vector<std::string>& filenames
+	) -> std::vector<size_t>;
+
+	UBROTENGINE_DX11_API auto RegisterTextures(
+		const std::vector<std::string>& filenames, uint8_t components
+	) -> std::vector<size_t>;
+
+	// Sets the texture a registered model is drawn with
+	UBROTENGINE_DX11_API void SetModelTexture(size_t model_idx, size_t texture_idx);
+
 	UBROTENGINE_DX11_API auto GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&;
 
 	// Initialize a Renderer
@@ -67,8 +84,41 @@ public:
 		const Scene& scene
 	) -> HRESULT;
 
+	// Renders a frame from inputs that were copied out of a scene, e.g. read from a capture
+	UBROTENGINE_DX11_API auto RenderScene(const SceneInput& input) -> HRESULT;
+
+	// Writes the settings, all asset registrations so far and the inputs of every following
+	// frame into a file, which "ubrotengine-tools replay" renders again without the game
+	UBROTENGINE_DX11_API auto BeginCapture(const std::string& filename) -> bool;
+
+	UBROTENGINE_DX11_API void EndCapture();
+
+	UBROTENGINE_DX11_API auto GetCaptureStats() const -> CaptureWriter::Stats;
+
+	// Waits for background work of the previous frame before every frame, so the same
+	// inputs always draw the same commands, see Renderer::SetDeterministic
+	UBROTENGINE_DX11_API void SetDeterministic(bool deterministic);
+
+	// CPU timings and counters of the last rendered frame
+	UBROTENGINE_DX11_API auto GetFrameStats() const -> const FrameStats&;
+
+	// Commands of the last rendered frame, only logged by the recording backend
+	UBROTENGINE_DX11_API auto GetRecordedCommands() const -> const CommandBuffer&;
+
+	// Writes the last frame of the software backend as PNG, or as PPM if the filename ends
+	// with .ppm. Returns false for other backends or if the file can not be written.
+	UBROTENGINE_DX11_API auto SaveSoftwareFrame(const std::string& filename) const -> bool;
+
 private:
+	// Copies the users of the views and all objects with a registered model into
+	// m_scene_input, iterating once over all tiles of the scene
+	void ReadScene(const Scene& scene);
+
 	std::unique_ptr<Renderer> m_renderer;
+	// Inputs of the last scene, kept across frames
+	SceneInput m_scene_input{};
+	// Sees every setup call, so a capture can start at any frame
+	std::unique_ptr<CaptureWriter> m_capture{ std::make_unique<CaptureWriter>() };
 };
 
 extern UBROTENGINE_DX11_API auto createEngine() -> std::unique_ptr<Engine>;
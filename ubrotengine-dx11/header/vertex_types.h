@@ -7,14 +7,14 @@
 //////////////
 // INCLUDES //
 //////////////
-#include <DirectXMath.h>
-#include <d3d11.h>
-#include <wrl\client.h>
+#include <cstdint>
 
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "math_types.h"
+#include "shader_manifest.h"
 
 
 namespace graphics
@@ -23,14 +23,31 @@ namespace graphics
 namespace vertices
 {
 
-namespace dx = DirectX;
+/**
+* Handle value of a model range that is not allocated.
+*/
+constexpr uint32_t NO_ALLOCATION = UINT32_MAX;
 
+/**
+* Range of a model inside the shared vertex and index buffers of the asset manager.
+* It is drawn with \c DrawIndexed(indexCount, firstIndex, baseVertex) after binding the
+* vertex buffer that belongs to \a vertexStride.
+*/
 struct Model
 {
-	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer{ nullptr };
+	unsigned int vertexStride{ 0 };
+	unsigned int baseVertex{ 0 };
+	unsigned int firstIndex{ 0 };
 	unsigned int vertexCount{ 0 };
 	unsigned int indexCount{ 0 };
+	// Allocator handles of the ranges, they stay valid when the ranges are moved
+	uint32_t vertexAllocation{ NO_ALLOCATION };
+	uint32_t indexAllocation{ NO_ALLOCATION };
+	// Distance of the farthest vertex from the model origin, kept while the model is evicted
+	float boundingRadius{ 0.0F };
+	// Shader variant the model is drawn with, chosen from its vertices when it is uploaded
+	ShaderProg shaderProgram{ ShaderProg::SimShader };
+	FeatureMask shaderFeatures{ 0 };
 };
 
 struct Vector2
@@ -58,52 +75,52 @@ struct Face
 /*
 struct SilVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT3 normal;
+	math::Float3 position;
+	math::Float3 normal;
 };*/
 
 struct SimVertex
 {
-	dx::XMFLOAT3 position;
+	math::Float3 position;
 };
 /**
 * Container for colored vertices with a 3D position an a RGBA-color component
 */
 struct ColVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT4 color;
+	math::Float3 position;
+	math::Float4 color;
 };
 
 struct TexVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT2 uv;
+	math::Float3 position;
+	math::Float2 uv;
 };
 
 struct LigVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT2 uv;
-	dx::XMFLOAT3 normal;
+	math::Float3 position;
+	math::Float2 uv;
+	math::Float3 normal;
 };
 
 struct NomVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT2 uv;
-	dx::XMFLOAT3 normal;
-	dx::XMFLOAT3 tangent;
-	dx::XMFLOAT3 binormal;
+	math::Float3 position;
+	math::Float2 uv;
+	math::Float3 normal;
+	math::Float3 tangent;
+	math::Float3 binormal;
 };
 
 struct TesVertex
 {
-	dx::XMFLOAT3 position;
-	dx::XMFLOAT2 uv;
-	dx::XMFLOAT3 normal;
-	dx::XMFLOAT3 tangent;
-	dx::XMFLOAT3 binormal;
+	math::Float3 position;
+	math::Float2 uv;
+	math::Float3 normal;
+	math::Float3 tangent;
+	math::Float3 binormal;
 };
 
 template <typename... Ts>
@@ -129,12 +146,12 @@ template <typename... Ts>
 /*
 static void Create(
 	SimVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -148,12 +165,12 @@ static void Create(
 /*
 static void Create(
 	ColVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -165,12 +182,12 @@ static void Create(
 }*/
 
 static auto Create(
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 ) -> ColVertex
 {
 	ColVertex vert{};
@@ -186,12 +203,12 @@ static auto Create(
 /*
 static void Create(
 	TexVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -205,12 +222,12 @@ static void Create(
 
 static void Create(
 	LigVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -224,12 +241,12 @@ static void Create(
 
 static void Create(
 	NomVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -243,12 +260,12 @@ static void Create(
 
 static void Create(
 	TesVertex &vert,
-	dx::XMFLOAT3 pos,
-	dx::XMFLOAT4 color,
-	dx::XMFLOAT2 uv,
-	dx::XMFLOAT3 normal,
-	dx::XMFLOAT3 tangent,
-	dx::XMFLOAT3 binormal
+	math::Float3 pos,
+	math::Float4 color,
+	math::Float2 uv,
+	math::Float3 normal,
+	math::Float3 tangent,
+	math::Float3 binormal
 )
 {
 	vert.position = pos;
@@ -267,16 +284,16 @@ template
 	class T,
 	typename std::enable_if<std::is_same<T, LigVertex>::value, LigVertex>::type* = nullptr
 >
-T Create(DirectX::XMFLOAT3 pos, ...)
+T Create(math::Float3 pos, ...)
 {
 	va_list args;
 	va_start(args, pos);
 	auto vertex = T();
 	vertex.position = pos;
 
-	va_arg(args, DirectX::XMFLOAT4);
-	vertex.uv = va_arg(args, DirectX::XMFLOAT2);
-	vertex.normal = va_arg(args, DirectX::XMFLOAT3);
+	va_arg(args, math::Float4);
+	vertex.uv = va_arg(args, math::Float2);
+	vertex.normal = va_arg(args, math::Float3);
 	va_end(args);
 
 	return vertex;
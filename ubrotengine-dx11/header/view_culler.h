@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: view_culler.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "camera.h"
+#include "math_types.h"
+
+
+namespace graphics
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ViewCuller
+/// Tests bounding spheres against the frusta of several views at once. The spheres are
+/// collected first and then tested in one pass, four spheres at a time with SSE2, against
+/// the planes of every view. The result is one bit mask per sphere with bit v set if the
+/// sphere is visible in view v. A view can have one extra clip plane, e.g. the mirror plane of
+/// a reflection, objects completely behind it are culled as well.
+///
+/// The spheres are stored as separate arrays (SoA) and the memory is kept across frames.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ViewCuller
+{
+
+public:
+	using ViewMask = uint8_t;
+	static constexpr size_t MAX_VIEWS = sizeof(ViewMask) * 8;
+	// Plane that every point is in front of
+	static constexpr math::Float4 NO_CLIP_PLANE{ 0.0F, 0.0F, 0.0F, 1.0F };
+
+	// The frustum planes of a view followed by its clip plane
+	using ViewPlanes = std::array<math::Float4, size_t(Camera::Plane::NUMBER) + 1>;
+
+	ViewCuller() = default;
+	ViewCuller(const ViewCuller& other) = delete;
+	ViewCuller(ViewCuller&& other) noexcept = delete;
+	auto operator=(const ViewCuller& other) -> ViewCuller = delete;
+	auto operator=(ViewCuller&& other) -> ViewCuller& = delete;
+	~ViewCuller() = default;
+
+	/**
+	 * Removes all views and spheres but keeps the allocated memory.
+	 */
+	void Clear();
+
+	/**
+	 * Copies the frustum planes of a camera, so it has to be updated before.
+	 * @param clip_plane normalized plane (a, b, c, d), spheres completely on its negative side
+	 *        are culled
+	 * @return the index of the view, which is its bit in the masks
+	 */
+	auto AddView(const Camera& camera, const math::Float4& clip_plane = NO_CLIP_PLANE)
+		-> size_t;
+
+	/**
+	 * Returns the frustum planes of a camera followed by the clip plane.
+	 */
+	static auto GetPlanes(
+		const Camera& camera, const math::Float4& clip_plane = NO_CLIP_PLANE
+	) -> ViewPlanes;
+
+	/**
+	 * Appends a sphere and returns its index.
+	 */
+	auto AddSphere(const math::Float3& center, float radius) -> uint32_t;
+
+	/**
+	 * Tests all spheres against all views and fills the masks.
+	 */
+	void Cull();
+
+	/**
+	 * Tests all spheres against planes that are not one of the views, e.g. the frustum of a
+	 * shadow cascade, and appends the indices of the visible ones to \p visible. It does not
+	 * change the culler, so several calls may run in parallel.
+	 */
+	void CullPlanes(const ViewPlanes& planes, std::vector<uint32_t>& visible) const;
+
+	[[nodiscard]] auto GetViewCount() const -> size_t;
+	[[nodiscard]] auto GetSphereCount() const -> size_t;
+
+	/**
+	 * Returns the center and, as w, the radius of a sphere.
+	 */
+	[[nodiscard]] auto GetSphere(uint32_t sphere_idx) const -> math::Float4;
+
+	/**
+	 * Returns one mask per sphere, only valid after \c Cull was called.
+	 */
+	[[nodiscard]] auto GetMasks() const -> const std::vector<ViewMask>&;
+
+private:
+	// Spheres are tested in groups of this size, the arrays are padded to a multiple of it
+	static constexpr size_t LANES = 4;
+
+	std::vector<ViewPlanes> m_planes{};
+
+	std::vector<float> m_x{};
+	std::vector<float> m_y{};
+	std::vector<float> m_z{};
+	std::vector<float> m_radius{};
+	std::vector<ViewMask> m_masks{};
+	size_t m_sphere_count{ 0 };
+};
+
+} // namespace graphics
@@ -18,5 +18,9 @@ struct PixelInputType
 ////////////////////////////////////////////////////////////////////////////////
 float4 FragmentShader(PixelInputType input, float4 Pos : SV_Position) : SV_TARGET
 {
+#ifdef ALPHA_TEST
+	// Fragments below the cutoff are discarded instead of blended
+	clip(input.color.a - 0.5f);
+#endif
 	return input.color;
 }
\ No newline at end of file
@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: asset_archive.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/asset_archive.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+// The table of contents is used straight from the mapping, so its layout is fixed
+static_assert(sizeof(ArchiveHeader) == 40);
+static_assert(sizeof(ArchiveBlock) == 16);
+static_assert(sizeof(ArchiveEntry) == 32);
+
+// Alignment of the table of contents in the file
+constexpr uint64_t TOC_ALIGNMENT = 8;
+
+template <class T>
+void WriteRaw(std::ofstream& stream, const T* data, size_t count)
+{
+	stream.write(reinterpret_cast<const char*>(data), std::streamsize(sizeof(T) * count));
+}
+
+} // namespace
+
+
+auto AssetArchive::Open(const std::string& filename) -> bool
+{
+	Close();
+	if (!m_file.Open(filename) || m_file.GetSize() < sizeof(ArchiveHeader)) {
+		Close();
+		return false;
+	}
+
+	const auto* base = m_file.GetData();
+	const auto file_size = uint64_t(m_file.GetSize());
+	const auto* header = reinterpret_cast<const ArchiveHeader*>(base);
+
+	const auto toc_size = uint64_t(header->block_count) * sizeof(ArchiveBlock)
+		+ uint64_t(header->entry_count) * sizeof(ArchiveEntry) + header->names_size;
+	const auto block_count = (header->data_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	if (header->magic != MAGIC || header->version != VERSION || header->block_size != BLOCK_SIZE
+		|| header->block_count != block_count || header->toc_offset % TOC_ALIGNMENT != 0
+		|| header->toc_offset > file_size || toc_size > file_size - header->toc_offset) {
+		Close();
+		return false;
+	}
+
+	m_header = header;
+	m_blocks = reinterpret_cast<const ArchiveBlock*>(base + header->toc_offset);
+	m_entries = reinterpret_cast<const ArchiveEntry*>(m_blocks + header->block_count);
+	m_names = reinterpret_cast<const char*>(m_entries + header->entry_count);
+
+	// Everything that is read later is checked once, so lookups can trust the table
+	for (uint32_t i = 0; i < header->block_count; i++) {
+		const auto& block = m_blocks[i];
+		const bool valid = block.offset <= header->toc_offset
+			&& block.packed_size <= header->toc_offset - block.offset
+			&& (block.stored == 0 || block.packed_size == GetBlockSize(i));
+		if (!valid) {
+			Close();
+			return false;
+		}
+	}
+	for (uint32_t i = 0; i < header->entry_count; i++) {
+		const auto& entry = m_entries[i];
+		const bool valid = entry.offset <= header->data_size
+			&& entry.size <= header->data_size - entry.offset
+			&& entry.name_offset <= header->names_size
+			&& entry.name_size <= header->names_size - entry.name_offset
+			&& (i == 0 || m_entries[i - 1].hash <= entry.hash);
+		if (!valid) {
+			Close();
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void AssetArchive::Close()
+{
+	m_file.Close();
+	m_header = nullptr;
+	m_blocks = nullptr;
+	m_entries = nullptr;
+	m_names = nullptr;
+
+	std::lock_guard<std::mutex> lock(m_cache_mutex);
+	m_cache_block = NO_BLOCK;
+}
+
+
+auto AssetArchive::Contains(const std::string& path) const -> bool
+{
+	return Find(path) != nullptr;
+}
+
+
+auto AssetArchive::Read(
+	const std::string& path, std::vector<uint8_t>& buffer, const uint8_t*& data, size_t& size
+) const -> bool
+{
+	const auto* entry = Find(path);
+	if (entry == nullptr) {
+		return false;
+	}
+
+	size = size_t(entry->size);
+	if (size == 0) {
+		data = m_file.GetData();
+		return true;
+	}
+
+	const auto first = uint32_t(entry->offset / BLOCK_SIZE);
+	const auto last = uint32_t((entry->offset + entry->size - 1) / BLOCK_SIZE);
+
+	// Stored blocks that follow each other are a copy of the stream, no need to copy again
+	bool in_place{ true };
+	for (auto block = first; block <= last && in_place; block++) {
+		const auto& info = m_blocks[block];
+		in_place = info.stored != 0
+			&& (block == first || info.offset == m_blocks[block - 1].offset + BLOCK_SIZE);
+	}
+	if (in_place) {
+		data = m_file.GetData() + m_blocks[first].offset + entry->offset % BLOCK_SIZE;
+		return true;
+	}
+
+	buffer.resize(size);
+	for (auto block = first; block <= last; block++) {
+		const auto block_start = uint64_t(block) * BLOCK_SIZE;
+		const auto block_size = GetBlockSize(block);
+		const auto begin = std::max(entry->offset, block_start);
+		const auto end = std::min(entry->offset + entry->size, block_start + block_size);
+		uint8_t* dst = buffer.data() + (begin - entry->offset);
+
+		// Blocks that are fully covered are decompressed in place
+		if (end - begin == block_size) {
+			if (!ReadBlock(block, dst)) {
+				return false;
+			}
+			continue;
+		}
+		if (m_blocks[block].stored != 0) {
+			std::memcpy(
+				dst, m_file.GetData() + m_blocks[block].offset + (begin - block_start), end - begin
+			);
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(m_cache_mutex);
+		if (m_cache_block != block) {
+			m_cache.resize(BLOCK_SIZE);
+			m_cache_block = ReadBlock(block, m_cache.data()) ? block : NO_BLOCK;
+			if (m_cache_block == NO_BLOCK) {
+				return false;
+			}
+		}
+		std::memcpy(dst, m_cache.data() + (begin - block_start), end - begin);
+	}
+	data = buffer.data();
+	return true;
+}
+
+
+auto AssetArchive::GetFileCount() const -> size_t
+{
+	return m_header != nullptr ? m_header->entry_count : 0;
+}
+
+
+auto AssetArchive::NormalizePath(const std::string& path) -> std::string
+{
+	std::vector<std::string> parts;
+	std::string part;
+	const auto add_part = [&parts, &part]() {
+		if (part == ".." && !parts.empty() && parts.back() != "..") {
+			parts.pop_back();
+		}
+		else if (!part.empty() && part != ".") {
+			parts.push_back(part);
+		}
+		part.clear();
+	};
+
+	for (const auto c : path) {
+		if (c == '/' || c == '\\') {
+			add_part();
+		}
+		else {
+			part.push_back(char(std::tolower(static_cast<unsigned char>(c))));
+		}
+	}
+	add_part();
+
+	std::string normalized = !path.empty() && (path[0] == '/' || path[0] == '\\') ? "/" : "";
+	for (size_t i = 0; i < parts.size(); i++) {
+		normalized += i > 0 ? "/" + parts[i] : parts[i];
+	}
+	return normalized;
+}
+
+
+auto AssetArchive::HashPath(const std::string& normalized_path) -> uint64_t
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (const auto c : normalized_path) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+auto AssetArchive::Find(const std::string& path) const -> const ArchiveEntry*
+{
+	if (m_header == nullptr) {
+		return nullptr;
+	}
+
+	const auto normalized = NormalizePath(path);
+	const auto hash = HashPath(normalized);
+	const auto* end = m_entries + m_header->entry_count;
+	auto* it = std::lower_bound(m_entries, end, hash, [](const ArchiveEntry& entry, uint64_t h) {
+		return entry.hash < h;
+	});
+
+	// Different paths with the same hash are told apart by their names
+	for (; it != end && it->hash == hash; it++) {
+		const std::string_view name(m_names + it->name_offset, it->name_size);
+		if (name == normalized) {
+			return it;
+		}
+	}
+	return nullptr;
+}
+
+
+auto AssetArchive::GetBlockSize(uint32_t block) const -> size_t
+{
+	const auto remaining = m_header->data_size - uint64_t(block) * BLOCK_SIZE;
+	return size_t(std::min<uint64_t>(BLOCK_SIZE, remaining));
+}
+
+
+auto AssetArchive::ReadBlock(uint32_t block, uint8_t* dst) const -> bool
+{
+	const auto& info = m_blocks[block];
+	const auto* src = m_file.GetData() + info.offset;
+	if (info.stored != 0) {
+		std::memcpy(dst, src, info.packed_size);
+		return true;
+	}
+	return LzCodec::Decompress(src, info.packed_size, dst, GetBlockSize(block));
+}
+
+
+ArchiveWriter::ArchiveWriter(utils::ThreadPool* thread_pool) :
+	m_thread_pool(thread_pool)
+{
+}
+
+
+auto ArchiveWriter::Open(const std::string& filename) -> bool
+{
+	m_stream.open(filename, std::ios::binary | std::ios::trunc);
+
+	// The header is written again once the table of contents is known
+	const ArchiveHeader header;
+	WriteRaw(m_stream, &header, 1);
+	m_file_offset = sizeof(ArchiveHeader);
+	return !m_stream.fail();
+}
+
+
+auto ArchiveWriter::Add(const std::string& path, const uint8_t* data, size_t size) -> bool
+{
+	auto normalized = AssetArchive::NormalizePath(path);
+	if (!m_paths.insert(normalized).second) {
+		return false;
+	}
+
+	ArchiveEntry entry;
+	entry.hash = AssetArchive::HashPath(normalized);
+	entry.offset = m_data_size;
+	entry.size = size;
+	entry.name_offset = uint32_t(m_names.size());
+	entry.name_size = uint32_t(normalized.size());
+	m_entries.push_back(entry);
+	m_names += normalized;
+
+	m_pending.insert(m_pending.end(), data, data + size);
+	m_data_size += size;
+	m_stats.files++;
+	m_stats.data_bytes += size;
+
+	if (m_pending.size() >= BATCH_BLOCKS * AssetArchive::BLOCK_SIZE) {
+		return WriteBlocks(false);
+	}
+	return !m_stream.fail();
+}
+
+
+auto ArchiveWriter::Finish() -> bool
+{
+	if (!WriteBlocks(true)) {
+		return false;
+	}
+
+	// The reader uses the table in place, so it has to be aligned
+	const std::array<uint8_t, TOC_ALIGNMENT> zeros{};
+	const auto padding = (TOC_ALIGNMENT - m_file_offset % TOC_ALIGNMENT) % TOC_ALIGNMENT;
+	WriteRaw(m_stream, zeros.data(), size_t(padding));
+	m_file_offset += padding;
+
+	std::sort(m_entries.begin(), m_entries.end(), [](const ArchiveEntry& a, const ArchiveEntry& b) {
+		return a.hash < b.hash;
+	});
+
+	ArchiveHeader header;
+	header.magic = AssetArchive::MAGIC;
+	header.version = AssetArchive::VERSION;
+	header.block_size = uint32_t(AssetArchive::BLOCK_SIZE);
+	header.block_count = uint32_t(m_blocks.size());
+	header.entry_count = uint32_t(m_entries.size());
+	header.names_size = uint32_t(m_names.size());
+	header.data_size = m_data_size;
+	header.toc_offset = m_file_offset;
+
+	WriteRaw(m_stream, m_blocks.data(), m_blocks.size());
+	WriteRaw(m_stream, m_entries.data(), m_entries.size());
+	WriteRaw(m_stream, m_names.data(), m_names.size());
+	m_stats.archive_bytes = m_file_offset + m_blocks.size() * sizeof(ArchiveBlock)
+		+ m_entries.size() * sizeof(ArchiveEntry) + m_names.size();
+
+	m_stream.seekp(0);
+	WriteRaw(m_stream, &header, 1);
+	m_stream.close();
+	return !m_stream.fail();
+}
+
+
+auto ArchiveWriter::GetStats() const -> Stats
+{
+	return m_stats;
+}
+
+
+auto ArchiveWriter::WriteBlocks(bool last) -> bool
+{
+	static constexpr size_t BLOCK_SIZE = AssetArchive::BLOCK_SIZE;
+	const auto count = last
+		? (m_pending.size() + BLOCK_SIZE - 1) / BLOCK_SIZE
+		: m_pending.size() / BLOCK_SIZE;
+
+	std::vector<std::vector<uint8_t>> packed(count);
+	const auto compress = [this, &packed](size_t begin, size_t end, size_t) {
+		for (auto i = begin; i < end; i++) {
+			const auto size = std::min(BLOCK_SIZE, m_pending.size() - i * BLOCK_SIZE);
+			LzCodec::Compress(m_pending.data() + i * BLOCK_SIZE, size, packed[i]);
+		}
+	};
+	if (m_thread_pool != nullptr) {
+		m_thread_pool->ParallelFor(count, m_thread_pool->GetThreadCount(), compress);
+	}
+	else {
+		compress(0, count, 0);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		const auto* raw = m_pending.data() + i * BLOCK_SIZE;
+		const auto size = std::min(BLOCK_SIZE, m_pending.size() - i * BLOCK_SIZE);
+
+		ArchiveBlock block;
+		block.offset = m_file_offset;
+		// Saving less than a sixteenth is not worth the decompression
+		if (packed[i].size() + size / 16 >= size) {
+			block.packed_size = uint32_t(size);
+			block.stored = 1;
+			WriteRaw(m_stream, raw, size);
+			m_stats.stored_blocks++;
+		}
+		else {
+			block.packed_size = uint32_t(packed[i].size());
+			WriteRaw(m_stream, packed[i].data(), packed[i].size());
+		}
+		m_file_offset += block.packed_size;
+		m_blocks.push_back(block);
+		m_stats.blocks++;
+	}
+
+	const auto written = std::min(m_pending.size(), count * BLOCK_SIZE);
+	m_pending.erase(m_pending.begin(), m_pending.begin() + ptrdiff_t(written));
+	return !m_stream.fail();
+}
+
+} // namespace io
@@ -3,7 +3,11 @@
 //////////////
 // INCLUDES //
 //////////////
+#include <algorithm>
+#include <cctype>
 #include <fstream>
+#include <iterator>
+#include <streambuf>
 
 #include <stdio.h>
 #include <errno.h>
@@ -12,43 +16,173 @@
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
-//#include "DDSTextureLoader.h"
+#include "../header/dds_loader.h"
+#include "../header/image_decoder.h"
+#include "../header/mapped_file.h"
+#include "../header/mip_generator.h"
 #include "../header/model_factory.h"
 
 
 namespace io
 {
 
-namespace dx = DirectX;
+// Filter for the mip chains of textures that come without mips
+constexpr MipFilter TEXTURE_MIP_FILTER = MipFilter::Kaiser;
 
-auto AssetLoader::LoadTexture(
-	ID3D11Device* device, const std::string& filename
-) -> ID3D11ShaderResourceView*
+namespace
 {
-	UNREFERENCED_PARAMETER(device);
-	UNREFERENCED_PARAMETER(filename);
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
-	/*
-	// Be careful to specify a format when creating the dds file!
-	auto result = DirectX::CreateDDSTextureFromFile(
-		d3device,
-		L"D:/07_Projekte/UBrotEngineX/UBrotEngineX/data/assets/textures/Pebbles.dds",
-		nullptr,
-		srv.GetAddressOf()
-	);
 
-	if (FAILED(result)) {
-		//throw std::runtime_error("");
+/**
+ * Stream buffer over memory it does not own, e.g. a file read from an archive.
+ */
+class MemoryBuffer : public std::streambuf
+{
+
+public:
+	MemoryBuffer(const uint8_t* data, size_t size)
+	{
+		auto* begin = reinterpret_cast<char*>(const_cast<uint8_t*>(data));
+		setg(begin, begin, begin + size);
+	}
+
+protected:
+	auto seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		-> pos_type override
+	{
+		const char* base = dir == std::ios_base::beg ? eback()
+			: dir == std::ios_base::cur ? gptr() : egptr();
+		const auto pos = base - eback() + offset;
+		if ((which & std::ios_base::in) == 0 || pos < 0 || pos > egptr() - eback()) {
+			return pos_type(off_type(-1));
+		}
+		setg(eback(), eback() + pos, egptr());
+		return pos_type(pos);
+	}
+
+	auto seekpos(pos_type pos, std::ios_base::openmode which) -> pos_type override
+	{
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+};
+
+/**
+ * Returns the extension including the dot in lower case.
+ */
+auto GetExtension(const std::string& filename) -> std::string
+{
+	auto extension = filename.substr(std::min(filename.find_last_of('.'), filename.size()));
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+		return char(std::tolower(static_cast<unsigned char>(c)));
+	});
+	return extension;
+}
+
+/**
+ * Colored vertices are drawn with the color program, vertices that are not fully opaque
+ * need its alpha tested variant.
+ */
+void SelectShader(const std::vector<gv::ColVertex>& vertices, gv::Model& model)
+{
+	model.shaderProgram = graphics::ShaderProg::ColShader;
+	const bool translucent = std::any_of(vertices.begin(), vertices.end(), [](const auto& v) {
+		return v.color.w < 1.0F;
+	});
+	model.shaderFeatures = translucent
+		? graphics::FeatureBit(graphics::ShaderFeature::AlphaTest) : 0;
+}
+
+} // namespace
+
+
+auto AssetLoader::LoadTextureData(
+	const std::string& filename, utils::ThreadPool* thread_pool, TextureData& data,
+	const AssetArchive* archive
+) -> bool
+{
+	const uint8_t* bytes{ nullptr };
+	size_t size{ 0 };
+	if (archive != nullptr) {
+		if (!archive->Read(filename, data.content, bytes, size)) {
+			return false;
+		}
+	}
+	else {
+		// The file is only mapped, Direct3D reads DDS data straight from the mapping
+		data.file = std::make_unique<MappedFile>();
+		if (!data.file->Open(filename)) {
+			return false;
+		}
+		bytes = data.file->GetData();
+		size = data.file->GetSize();
 	}
-	*/
-	return srv.Detach();
+	return ParseTexture(filename, bytes, size, thread_pool, data);
+}
+
+
+auto AssetLoader::LoadTextureData(
+	const std::string& filename, std::vector<uint8_t>&& content, utils::ThreadPool* thread_pool,
+	TextureData& data
+) -> bool
+{
+	// Moving keeps the pointer to the content valid
+	data.content = std::move(content);
+	return ParseTexture(filename, data.content.data(), data.content.size(), thread_pool, data);
+}
+
+
+auto AssetLoader::IsDecodedTexture(const std::string& filename) -> bool
+{
+	const auto extension = GetExtension(filename);
+	return extension == ".png" || extension == ".tga";
+}
+
+
+auto AssetLoader::ParseTexture(
+	const std::string& filename, const uint8_t* bytes, size_t size,
+	utils::ThreadPool* thread_pool, TextureData& data
+) -> bool
+{
+	if (!IsDecodedTexture(filename)) {
+		return DdsLoader::Parse(bytes, size, data.info, data.subresources);
+	}
+
+	data.images.resize(1);
+	auto& image = data.images[0];
+	const bool decoded = GetExtension(filename) == ".png"
+		? ImageDecoder::DecodePng(bytes, size, image, thread_pool)
+		: ImageDecoder::DecodeTga(bytes, size, image, thread_pool);
+	// The decoded image does not reference the file anymore
+	data.file.reset();
+	std::vector<uint8_t>().swap(data.content);
+	if (!decoded) {
+		return false;
+	}
+
+	std::vector<Image> mips;
+	MipGenerator::Generate(image, TEXTURE_MIP_FILTER, mips, thread_pool);
+	std::move(mips.begin(), mips.end(), std::back_inserter(data.images));
+
+	data.info.width = data.images[0].width;
+	data.info.height = data.images[0].height;
+	data.info.mip_count = uint32_t(data.images.size());
+	data.info.array_size = 1;
+	data.info.format = data.images[0].srgb
+		? graphics::TextureFormat::R8G8B8A8_UNORM_SRGB : graphics::TextureFormat::R8G8B8A8_UNORM;
+
+	data.subresources.resize(data.images.size());
+	for (size_t level = 0; level < data.images.size(); level++) {
+		data.subresources[level].data = data.images[level].pixels.data();
+		data.subresources[level].row_pitch = data.images[level].width * 4;
+		data.subresources[level].slice_pitch = 0;
+	}
+	return true;
 }
 
 
 template <class T>
 auto AssetLoader::LoadModel(
-	ID3D11Device* d3device, const std::string& filename, gv::Model &model
+	graphics::RenderDevice& device, const std::string& filename, gv::Model &model,
+	graphics::GeometryPool& geometry, const AssetArchive* archive
 ) -> bool
 {
 	// Vertex array
@@ -56,16 +190,17 @@ auto AssetLoader::LoadModel(
 	// Indices array
 	std::vector<uint32_t> indices{};
 
-	if (!LoadModelFromOBJ<T>(filename, model, vertices, indices)) {
+	if (!LoadModelFromOBJ<T>(filename, archive, model, vertices, indices)) {
 		return false;
 	}
-	return InitializeBuffers(d3device, model, vertices, indices);
+	return InitializeBuffers(device, model, vertices, indices, geometry);
 }
 
 
 template <class T>
 auto AssetLoader::LoadModelProcedural(
-	ID3D11Device* d3device, gv::Model& model, assets::Procedural pModel
+	graphics::RenderDevice& device, gv::Model& model, assets::Procedural pModel,
+	graphics::GeometryPool& geometry
 ) -> bool
 {
 	// Vertices array
@@ -85,28 +220,72 @@ auto AssetLoader::LoadModelProcedural(
 			ModelFactory::GenerateTriangle<T>(model, vertices, indices);
 			break;
 	}
-	return InitializeBuffers(d3device, model, vertices, indices);
+	return InitializeBuffers(device, model, vertices, indices, geometry);
 }
 
 
 template <class T>
 auto AssetLoader::LoadModelFromOBJ(
 	const std::string& filename,
+	const AssetArchive* archive,
 	gv::Model &model,
 	std::vector<T>& vertices,
 	std::vector<uint32_t>& indices
 ) -> bool
+{
+	// Files in an archive are parsed from memory, both passes read the same stream
+	std::vector<uint8_t> buffer;
+	const uint8_t* data{ nullptr };
+	size_t size{ 0 };
+	if (archive != nullptr && !archive->Read(filename, buffer, data, size)) {
+		return false;
+	}
+	MemoryBuffer memory(data, size);
+	std::istream memory_stream(&memory);
+	std::ifstream file_stream;
+	if (archive == nullptr) {
+		file_stream.open(filename);
+		if (file_stream.fail()) {
+			return false;
+		}
+	}
+	std::istream& fin = archive != nullptr ? memory_stream : file_stream;
+	return ParseOBJ(fin, model, vertices, indices);
+}
+
+
+template <class T>
+auto AssetLoader::ParseModel(
+	const uint8_t* data, size_t size, gv::Model& model, std::vector<T>& vertices,
+	std::vector<uint32_t>& indices
+) -> bool
+{
+	MemoryBuffer memory(data, size);
+	std::istream fin(&memory);
+	return ParseOBJ(fin, model, vertices, indices);
+}
+
+
+template <class T>
+auto AssetLoader::ParseOBJ(
+	std::istream& fin,
+	gv::Model& model,
+	std::vector<T>& vertices,
+	std::vector<uint32_t>& indices
+) -> bool
 {
 	// Read in the number of vertices, tex coords, normals, and faces so that the data
 	// can be initialized with the exact sizes needed.
-	auto counts = ReadFileCounts(filename);
+	auto counts = ReadFileCounts(fin);
 	auto face_count{ std::get<3>(counts) };
 	if (std::get<0>(counts) == 0 || face_count == 0) {
 		return false;
 	}
 
+	fin.clear();
+	fin.seekg(0);
 	auto result = LoadData<T>(
-		filename, counts, vertices, indices
+		fin, counts, vertices, indices
 	);
 	if (!result) {
 		return false;
@@ -120,7 +299,7 @@ auto AssetLoader::LoadModelFromOBJ(
 
 
 auto AssetLoader::ReadFileCounts(
-	const std::string& filename
+	std::istream& fin
 ) -> std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>
 {
 	// Initialize the counts.
@@ -129,14 +308,6 @@ auto AssetLoader::ReadFileCounts(
 	uint32_t normal_count{ 0 };
 	uint32_t face_count{ 0 };
 
-	// Open the file.
-	std::ifstream fin(filename);
-
-	// Check if it was successful in opening the file.
-	if (fin.fail()) {
-		return std::make_tuple(0, 0, 0, 0);
-	}
-
 	// Read from the file and continue to read until the end of the file is reached.
 	char input{};
 	fin.get(input);
@@ -170,16 +341,13 @@ auto AssetLoader::ReadFileCounts(
 		fin.get(input);
 	}
 
-	// Close the file.
-	fin.close();
-
 	return std::make_tuple(vertex_count, texture_count, normal_count, face_count);
 }
 
 
 template <class T>
 auto AssetLoader::LoadData(
-	const std::string& filename,
+	std::istream& fin,
 	const std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>& counts,
 	std::vector<T>& vertices,
 	std::vector<uint32_t>& indices
@@ -198,14 +366,6 @@ auto AssetLoader::LoadData(
 	int normalIndex{ 0 };
 	int faceIndex{ 0 };
 
-	// Open the file.
-	std::ifstream fin(filename);
-
-	// Check if it was successful in opening the file.
-	if (fin.fail()) {
-		return false;
-	}
-
 	// Read in the vertices, texture coordinates, and normals into the data structures.
 	// Important: Convert to left hand coordinate system
 	constexpr bool INVERT = true;
@@ -274,12 +434,9 @@ auto AssetLoader::LoadData(
 		fin.get(input);
 	}
 
-	// Close the file.
-	fin.close();
-
 	// TODO(rwarnking) currently not in use
-	dx::XMFLOAT3 min = dx::XMFLOAT3(0.0F, 0.0F, 0.0F);
-	dx::XMFLOAT3 max = dx::XMFLOAT3(0.0F, 0.0F, 0.0F);
+	math::Float3 min = math::Float3(0.0F, 0.0F, 0.0F);
+	math::Float3 max = math::Float3(0.0F, 0.0F, 0.0F);
 
 	// Create the vertex/index array.
 	vertices.resize(face_count * 3);
@@ -298,12 +455,12 @@ auto AssetLoader::LoadData(
 		float green = positions[vIndex].y;
 		float blue = positions[vIndex].z;
 		vertices[j] = gv::Create(
-			dx::XMFLOAT3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
-			dx::XMFLOAT4(red, green, blue, 1.0F),
-			dx::XMFLOAT2(texcoords[tIndex].x, texcoords[tIndex].y),
-			dx::XMFLOAT3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
-			dx::XMFLOAT3(),
-			dx::XMFLOAT3()
+			math::Float3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
+			math::Float4(red, green, blue, 1.0F),
+			math::Float2(texcoords[tIndex].x, texcoords[tIndex].y),
+			math::Float3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
+			math::Float3(),
+			math::Float3()
 		);
 
 		vIndex = faces[i].vIndex2 - 1;
@@ -311,12 +468,12 @@ auto AssetLoader::LoadData(
 		nIndex = faces[i].nIndex2 - 1;
 
 		vertices[j + 1] = gv::Create(
-			dx::XMFLOAT3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
-			dx::XMFLOAT4(red, green, blue, 1.0F),
-			dx::XMFLOAT2(texcoords[tIndex].x, texcoords[tIndex].y),
-			dx::XMFLOAT3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
-			dx::XMFLOAT3(),
-			dx::XMFLOAT3()
+			math::Float3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
+			math::Float4(red, green, blue, 1.0F),
+			math::Float2(texcoords[tIndex].x, texcoords[tIndex].y),
+			math::Float3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
+			math::Float3(),
+			math::Float3()
 		);
 
 		vIndex = faces[i].vIndex3 - 1;
@@ -324,12 +481,12 @@ auto AssetLoader::LoadData(
 		nIndex = faces[i].nIndex3 - 1;
 
 		vertices[j + 2] = gv::Create(
-			dx::XMFLOAT3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
-			dx::XMFLOAT4(red, green, blue, 1.0F),
-			dx::XMFLOAT2(texcoords[tIndex].x, texcoords[tIndex].y),
-			dx::XMFLOAT3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
-			dx::XMFLOAT3(),
-			dx::XMFLOAT3()
+			math::Float3(positions[vIndex].x, positions[vIndex].y, positions[vIndex].z),
+			math::Float4(red, green, blue, 1.0F),
+			math::Float2(texcoords[tIndex].x, texcoords[tIndex].y),
+			math::Float3(normals[nIndex].x, normals[nIndex].y, normals[nIndex].z),
+			math::Float3(),
+			math::Float3()
 		);
 
 		indices[j] = j;
@@ -366,63 +523,26 @@ auto AssetLoader::LoadData(
 
 template <class T>
 auto AssetLoader::InitializeBuffers(
-	ID3D11Device* d3device,
+	graphics::RenderDevice& device,
 	gv::Model& model,
 	std::vector<T>& vertices,
-	const std::vector<uint32_t>& indices
+	const std::vector<uint32_t>& indices,
+	graphics::GeometryPool& geometry
 ) -> bool
 {
-	D3D11_BUFFER_DESC vertexBufferDesc;
-	D3D11_BUFFER_DESC indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData;
-	D3D11_SUBRESOURCE_DATA indexData;
-	HRESULT result{ S_OK };
-
-	// Initialize a static vertex buffer description
-	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth = sizeof(T) * model.vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = 0;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Initialize the subresource structure and pass the vertex data
-	vertexData.pSysMem = vertices.data();
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Create the vertex buffer and store it in m_vertexBuffer
-	result = d3device->CreateBuffer(
-		&vertexBufferDesc,
-		&vertexData,
-		model.vertexBuffer.GetAddressOf()
-	);
-	if (FAILED(result)) {
-		return false;
-	}
+	SelectShader(vertices, model);
 
-	// Initialize a static index buffer description
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(uint32_t) * model.indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Initialize the subresource structure and pass the index data
-	indexData.pSysMem = indices.data();
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-
-	// Create the index buffer and store it in m_indexBuffer
-	result = d3device->CreateBuffer(&indexBufferDesc, &indexData, model.indexBuffer.GetAddressOf());
+	// The model is not given its own buffers, instead its vertices and indices are appended
+	// to the shared buffers and the model only stores the resulting ranges.
+	auto result = geometry.Add<T>(device, model, vertices, indices);
 	return !FAILED(result);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 template bool
 AssetLoader::LoadModel<gv::ColVertex>(
-	ID3D11Device* d3device, const std::string& fn, gv::Model &model
+	graphics::RenderDevice& device, const std::string& fn, gv::Model &model,
+	graphics::GeometryPool& geometry, const AssetArchive* archive
 );
 /*
 template bool
@@ -439,7 +559,20 @@ LoadModel<gv::TesVertex>(std::string fn, gv::Model &model, assets::Procedural pM
 
 template bool
 AssetLoader::LoadModelProcedural<gv::ColVertex>(
-	ID3D11Device* d3device, gv::Model& model, assets::Procedural pModel
+	graphics::RenderDevice& device, gv::Model& model, assets::Procedural pModel,
+	graphics::GeometryPool& geometry
+);
+
+template bool
+AssetLoader::ParseModel<gv::ColVertex>(
+	const uint8_t* data, size_t size, gv::Model& model, std::vector<gv::ColVertex>& vertices,
+	std::vector<uint32_t>& indices
+);
+
+template bool
+AssetLoader::InitializeBuffers<gv::ColVertex>(
+	graphics::RenderDevice& device, gv::Model& model, std::vector<gv::ColVertex>& vertices,
+	const std::vector<uint32_t>& indices, graphics::GeometryPool& geometry
 );
 
 } // namespace io
@@ -19,6 +19,24 @@ namespace assets
 
 namespace gv = graphics::vertices;
 
+AssetManager::AssetManager(utils::ThreadPool* thread_pool) :
+	m_thread_pool(thread_pool),
+	m_file_reader(thread_pool)
+{
+}
+
+
+auto AssetManager::MountArchive(const std::string& filename) -> bool
+{
+	auto archive = std::make_unique<io::AssetArchive>();
+	if (!archive->Open(filename)) {
+		return false;
+	}
+	m_archives.push_back(std::move(archive));
+	return true;
+}
+
+
 auto AssetManager::GetModel(size_t model_index) -> const gv::Model&
 {
 #if _DEBUG
@@ -28,7 +46,56 @@ auto AssetManager::GetModel(size_t model_index) -> const gv::Model&
 }
 
 
-auto AssetManager::AddModel(ID3D11Device* device, const std::string& filename) -> std::size_t
+auto AssetManager::GetModelCount() const -> size_t
+{
+	return models.size();
+}
+
+
+auto AssetManager::GetVertexBuffer(uint32_t stride) const -> graphics::RenderDevice::Handle
+{
+	return m_geometry.GetVertexBuffer(stride);
+}
+
+
+auto AssetManager::GetIndexBuffer() const -> graphics::RenderDevice::Handle
+{
+	return m_geometry.GetIndexBuffer();
+}
+
+
+void AssetManager::KeepGeometryOnCpu()
+{
+	m_geometry.KeepCpuCopies();
+}
+
+
+auto AssetManager::GetVertexData(uint32_t stride) const -> const uint8_t*
+{
+	return m_geometry.GetVertexData(stride);
+}
+
+
+auto AssetManager::GetIndexData() const -> const uint32_t*
+{
+	return m_geometry.GetIndexData();
+}
+
+
+auto AssetManager::DefragmentGeometry(graphics::RenderDevice& device, size_t max_bytes) -> size_t
+{
+	return m_geometry.Defragment(device, max_bytes, models);
+}
+
+
+auto AssetManager::GetGeometryStats() const -> graphics::GeometryPool::Stats
+{
+	return m_geometry.GetStats();
+}
+
+
+auto AssetManager::AddModel(graphics::RenderDevice& device, const std::string& filename)
+	-> std::size_t
 {
 	auto it = model_idx.find(filename);
 	if (it != model_idx.end()) {
@@ -36,20 +103,17 @@ auto AssetManager::AddModel(ID3D11Device* device, const std::string& filename) -
 	}
 
 	// Load the model from the file
+	auto source = ModelSource{ filename };
 	auto model = graphics::vertices::Model();
-	auto res = m_asset_loader->LoadModel<graphics::vertices::ColVertex>(device, filename, model);
-	// TODO(rwarnking) what to do when the model can not be loaded
-	assert(res);
-	
-	// Add the model to the storage system
-	auto pos = models.size();
-	models.push_back(std::move(model));
-	model_idx.insert({ filename, pos });
-	return pos;
+	if (!LoadModel(device, source, model)) {
+		ReportFailedModel(filename);
+		return NO_MODEL;
+	}
+	return StoreModel(std::move(source), std::move(model));
 }
 
 
-auto AssetManager::AddModelProcedural(ID3D11Device* device, Procedural idx) -> std::size_t
+auto AssetManager::AddModelProcedural(graphics::RenderDevice& device, Procedural idx) -> std::size_t
 {
 	// TODO(rwarnking) test if this works
 	std::string filename = std::to_string(uint8_t(idx));
@@ -58,22 +122,204 @@ auto AssetManager::AddModelProcedural(ID3D11Device* device, Procedural idx) -> s
 		return it->second;
 	}
 
+	auto source = ModelSource{ filename, idx };
 	auto model = graphics::vertices::Model();
-	m_asset_loader->LoadModelProcedural<graphics::vertices::ColVertex>(
-		device, model, idx
+	if (!LoadModel(device, source, model)) {
+		ReportFailedModel(filename);
+		return NO_MODEL;
+	}
+	return StoreModel(std::move(source), std::move(model));
+}
+
+
+auto AssetManager::AddModels(
+	graphics::RenderDevice& device, const std::vector<std::string>& filenames
+) -> std::vector<size_t>
+{
+	struct PendingModel
+	{
+		std::string filename;
+		const io::AssetArchive* archive{ nullptr };
+		gv::Model model{};
+		std::vector<gv::ColVertex> vertices{};
+		std::vector<uint32_t> indices{};
+		bool parsed{ false };
+	};
+
+	// Collect the new files first, the callbacks keep pointers into the list
+	std::vector<PendingModel> pending;
+	std::map<std::string, size_t> pending_idx;
+	for (const auto& filename : filenames) {
+		if (!model_idx.contains(filename) && !pending_idx.contains(filename)) {
+			pending_idx.insert({ filename, pending.size() });
+			pending.push_back({ filename, FindArchive(filename) });
+		}
+	}
+
+	std::vector<size_t> archived;
+	for (size_t i = 0; i < pending.size(); i++) {
+		auto& entry = pending[i];
+		if (entry.archive != nullptr) {
+			archived.push_back(i);
+			continue;
+		}
+		m_file_reader.Read(entry.filename, [&entry](io::AsyncFileReader::Result&& result) {
+			entry.parsed = result.success && io::AssetLoader::ParseModel(
+				result.data.data(), result.data.size(), entry.model, entry.vertices,
+				entry.indices
+			);
+		});
+	}
+	m_file_reader.Submit();
+
+	// Archived files are parsed while the loose ones are still read
+	const auto parse_archived = [this, &pending, &archived](size_t begin, size_t end, size_t) {
+		std::vector<uint8_t> buffer;
+		for (size_t i = begin; i < end; i++) {
+			auto& entry = pending[archived[i]];
+			const uint8_t* data{ nullptr };
+			size_t size{ 0 };
+			entry.parsed = entry.archive->Read(entry.filename, buffer, data, size)
+				&& io::AssetLoader::ParseModel(
+					data, size, entry.model, entry.vertices, entry.indices
+				);
+		}
+	};
+	if (m_thread_pool != nullptr) {
+		const auto chunks = m_thread_pool->GetThreadCount();
+		m_thread_pool->ParallelFor(archived.size(), chunks, parse_archived);
+	}
+	else {
+		parse_archived(0, archived.size(), 0);
+	}
+	m_file_reader.Wait();
+
+	// Direct3D uploads stay on this thread and in order, so the indices are deterministic
+	for (auto& entry : pending) {
+		const auto res = entry.parsed && io::AssetLoader::InitializeBuffers(
+			device, entry.model, entry.vertices, entry.indices, m_geometry
+		);
+		std::vector<gv::ColVertex>().swap(entry.vertices);
+		std::vector<uint32_t>().swap(entry.indices);
+		if (!res) {
+			ReportFailedModel(entry.filename);
+			continue;
+		}
+		StoreModel(ModelSource{ entry.filename }, std::move(entry.model));
+	}
+
+	std::vector<size_t> indices;
+	indices.reserve(filenames.size());
+	for (const auto& filename : filenames) {
+		const auto it = model_idx.find(filename);
+		indices.push_back(it != model_idx.end() ? it->second : NO_MODEL);
+	}
+	return indices;
+}
+
+
+void AssetManager::SetModelBudget(size_t bytes)
+{
+	m_residency.SetBudget(bytes);
+}
+
+
+void AssetManager::BeginFrame()
+{
+	m_residency.BeginFrame();
+	m_texture_streamer.BeginFrame();
+}
+
+
+auto AssetManager::UseModel(graphics::RenderDevice& device, size_t model_index) -> bool
+{
+	if (m_residency.Touch(model_index)) {
+		return true;
+	}
+
+	// The model was evicted, load it again from where it came from
+	auto model = graphics::vertices::Model();
+	if (!LoadModel(device, m_model_sources[model_index], model)) {
+		return false;
+	}
+	m_geometry.SetOwner(model, uint32_t(model_index));
+	m_residency.Reloaded(model_index, GetModelBytes(model));
+	models[model_index] = model;
+	return true;
+}
+
+
+void AssetManager::EnforceModelBudget()
+{
+	m_residency.SelectEvictions(m_evicted);
+	for (const auto idx : m_evicted) {
+		m_geometry.Remove(models[idx]);
+	}
+}
+
+
+auto AssetManager::GetResidencyStats() const -> ResidencyManager::Stats
+{
+	return m_residency.GetStats();
+}
+
+
+auto AssetManager::LoadModel(
+	graphics::RenderDevice& device, const ModelSource& source, graphics::vertices::Model& model
+) -> bool
+{
+	if (source.procedural != Procedural::NUMBER) {
+		return io::AssetLoader::LoadModelProcedural<graphics::vertices::ColVertex>(
+			device, model, source.procedural, m_geometry
+		);
+	}
+	return io::AssetLoader::LoadModel<graphics::vertices::ColVertex>(
+		device, source.filename, model, m_geometry, FindArchive(source.filename)
 	);
+}
+
+
+void AssetManager::ReportFailedModel(const std::string& filename)
+{
+	if (m_failed_models.insert(filename).second) {
+		const auto message = "Could not load the model " + filename + "\n";
+		OutputDebugStringA(message.c_str());
+	}
+}
+
 
+auto AssetManager::StoreModel(ModelSource&& source, gv::Model&& model) -> size_t
+{
 	// Add the model to the storage system
 	auto pos = models.size();
+	m_geometry.SetOwner(model, uint32_t(pos));
+	m_residency.Add(pos, GetModelBytes(model));
+	model_idx.insert({ source.filename, pos });
 	models.push_back(std::move(model));
-	model_idx.insert({ filename, pos });
+	m_model_sources.push_back(std::move(source));
 	return pos;
 }
 
 
-auto AssetManager::AddTexture(
-	ID3D11Device* device, const std::string& filename, uint8_t components
-) -> size_t
+auto AssetManager::FindArchive(const std::string& filename) const -> const io::AssetArchive*
+{
+	for (auto it = m_archives.rbegin(); it != m_archives.rend(); it++) {
+		if ((*it)->Contains(filename)) {
+			return it->get();
+		}
+	}
+	return nullptr;
+}
+
+
+auto AssetManager::GetModelBytes(const graphics::vertices::Model& model) -> size_t
+{
+	return size_t(model.vertexCount) * model.vertexStride
+		+ size_t(model.indexCount) * sizeof(uint32_t);
+}
+
+
+auto AssetManager::AddTexture(const std::string& filename, uint8_t components) -> size_t
 {
 	UNREFERENCED_PARAMETER(components);
 
@@ -82,17 +328,171 @@ auto AssetManager::AddTexture(
 		return it->second;
 	}
 
-	auto *texture = m_asset_loader->LoadTexture(device, filename);
-	auto pos = textures.size();
-	textures.push_back(texture);
+	// A texture that can not be loaded keeps its index but is never bound
+	io::TextureData data;
+	const auto* archive = FindArchive(filename);
+	if (!io::AssetLoader::LoadTextureData(filename, m_thread_pool, data, archive)) {
+		data = io::TextureData();
+	}
+	return StoreTexture(filename, std::move(data));
+}
+
+
+auto AssetManager::AddTextures(const std::vector<std::string>& filenames, uint8_t components)
+	-> std::vector<size_t>
+{
+	UNREFERENCED_PARAMETER(components);
+
+	struct PendingTexture
+	{
+		std::string filename;
+		io::TextureData data{};
+		bool loaded{ false };
+	};
+
+	std::vector<PendingTexture> pending;
+	std::map<std::string, size_t> pending_idx;
+	for (const auto& filename : filenames) {
+		if (!texture_idx.contains(filename) && !pending_idx.contains(filename)) {
+			pending_idx.insert({ filename, pending.size() });
+			pending.push_back({ filename });
+		}
+	}
+
+	// Only loose images are worth reading ahead, DDS files and archives are mapped
+	std::vector<PendingTexture*> mapped;
+	for (auto& entry : pending) {
+		if (FindArchive(entry.filename) != nullptr
+			|| !io::AssetLoader::IsDecodedTexture(entry.filename)) {
+			mapped.push_back(&entry);
+			continue;
+		}
+		m_file_reader.Read(entry.filename, [this, &entry](io::AsyncFileReader::Result&& result) {
+			entry.loaded = result.success && io::AssetLoader::LoadTextureData(
+				entry.filename, std::move(result.data), m_thread_pool, entry.data
+			);
+		});
+	}
+	m_file_reader.Submit();
+
+	for (auto* entry : mapped) {
+		entry->loaded = io::AssetLoader::LoadTextureData(
+			entry->filename, m_thread_pool, entry->data, FindArchive(entry->filename)
+		);
+	}
+	m_file_reader.Wait();
+
+	// A texture that can not be loaded keeps its index but is never bound
+	for (auto& entry : pending) {
+		StoreTexture(entry.filename, entry.loaded ? std::move(entry.data) : io::TextureData());
+	}
+
+	std::vector<size_t> indices;
+	indices.reserve(filenames.size());
+	for (const auto& filename : filenames) {
+		indices.push_back(texture_idx.at(filename));
+	}
+	return indices;
+}
+
+
+auto AssetManager::StoreTexture(const std::string& filename, io::TextureData&& data) -> size_t
+{
+	size_t pos{ 0 };
+	if (TextureStreamer::IsStreamable(data)) {
+		pos = m_textures.AddUnpacked();
+		m_texture_streamer.Add(pos, std::move(data));
+	}
+	else {
+		pos = m_textures.Add(std::move(data));
+	}
 	texture_idx.insert({ filename, pos });
 	return pos;
 }
 
 
-auto AssetManager::GetTexture(size_t textureIndex) -> ID3D11ShaderResourceView*
+auto AssetManager::PackTextures(graphics::RenderDevice& device) -> HRESULT
+{
+	return m_textures.Build(device);
+}
+
+
+auto AssetManager::HasPendingTextures() const -> bool
+{
+	return m_textures.HasPending();
+}
+
+
+auto AssetManager::GetTexture(size_t textureIndex) -> graphics::RenderDevice::Handle
+{
+	return m_textures.GetArray(m_textures.GetLocation(textureIndex).array_idx);
+}
+
+
+auto AssetManager::GetTextureLocation(size_t texture_index) const -> const TextureLocation&
+{
+	return m_textures.GetLocation(texture_index);
+}
+
+
+auto AssetManager::GetTextureArray(uint32_t array_index) const
+	-> graphics::RenderDevice::Handle
+{
+	return m_textures.GetArray(array_index);
+}
+
+
+auto AssetManager::GetTextureStats() const -> TexturePacker::Stats
+{
+	return m_textures.GetStats();
+}
+
+
+void AssetManager::SetTextureBudget(size_t bytes)
+{
+	m_texture_streamer.SetBudget(bytes);
+}
+
+
+void AssetManager::RequestTexture(size_t texture_index, float screen_pixels)
+{
+	m_texture_streamer.Request(texture_index, screen_pixels);
+}
+
+
+auto AssetManager::StreamTextures(graphics::RenderDevice& device, size_t max_load_bytes) -> HRESULT
+{
+	return m_texture_streamer.Update(device, m_textures, max_load_bytes);
+}
+
+
+void AssetManager::WaitForTextureLoads()
+{
+	m_texture_streamer.WaitForLoads();
+}
+
+
+auto AssetManager::GetStreamingStats() const -> MipStreamer::Stats
+{
+	return m_texture_streamer.GetStats();
+}
+
+
+void AssetManager::SetModelTexture(size_t model_index, size_t texture_index)
+{
+	if (model_index == NO_MODEL) {
+		return;
+	}
+	if (model_index >= m_model_textures.size()) {
+		m_model_textures.resize(model_index + 1, NO_TEXTURE);
+	}
+	m_model_textures[model_index] = texture_index;
+}
+
+
+auto AssetManager::GetModelTexture(size_t model_index) const -> size_t
 {
-	return textures[textureIndex];
+	return model_index < m_model_textures.size() ? m_model_textures[model_index] : NO_TEXTURE;
 }
 
 } // namespace assets
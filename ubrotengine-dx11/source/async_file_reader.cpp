@@ -0,0 +1,594 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: async_file_reader.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/async_file_reader.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_FILE_READER_IO_URING 1
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+#ifdef ASYNC_FILE_READER_IO_URING
+/**
+ * Submission and completion queues shared with the kernel and one slot per read in flight.
+ * A read goes through open, as many reads as needed and close, each one a single request
+ * whose user data is the slot index.
+ */
+struct AsyncFileReader::Ring
+{
+	enum class Stage : uint8_t
+	{
+		Open = 0,
+		Read,
+		Close
+	};
+
+	struct Slot
+	{
+		Request request{};
+		Result result{};
+		int fd{ -1 };
+		uint64_t offset{ 0 };
+		Stage stage{ Stage::Open };
+	};
+
+	Ring() = default;
+	Ring(const Ring& other) = delete;
+	Ring(Ring&& other) noexcept = delete;
+	auto operator=(const Ring& other) -> Ring = delete;
+	auto operator=(Ring&& other) -> Ring& = delete;
+	~Ring();
+
+	/**
+	 * Sets up the queues with room for \p entries requests.
+	 * @return false if io_uring or one of the used operations is not supported
+	 */
+	auto Create(uint32_t entries) -> bool;
+
+	/**
+	 * Returns the next free submission entry, the queue never fills up because every slot
+	 * has at most one request in the kernel.
+	 */
+	auto PushEntry() -> io_uring_sqe*;
+
+	/**
+	 * Submits the pushed entries and waits for \p min_complete completions. If the kernel
+	 * can not take the entries right now, it returns once completions are there to drain.
+	 * @return false if the ring can not be used anymore
+	 */
+	auto Enter(uint32_t min_complete) -> bool;
+
+	int ring_fd{ -1 };
+	void* sq_ptr{ MAP_FAILED };
+	size_t sq_size{ 0 };
+	void* cq_ptr{ MAP_FAILED };
+	size_t cq_size{ 0 };
+	io_uring_sqe* sqes{ nullptr };
+	size_t sqes_size{ 0 };
+
+	uint32_t* sq_tail{ nullptr };
+	// Tail including the entries that are not published yet
+	uint32_t local_tail{ 0 };
+	uint32_t sq_mask{ 0 };
+	uint32_t* sq_array{ nullptr };
+	uint32_t* cq_head{ nullptr };
+	uint32_t* cq_tail{ nullptr };
+	uint32_t cq_mask{ 0 };
+	io_uring_cqe* cqes{ nullptr };
+	uint32_t to_submit{ 0 };
+
+	std::vector<Slot> slots{};
+	std::vector<uint32_t> free_slots{};
+};
+
+
+AsyncFileReader::Ring::~Ring()
+{
+	if (sqes != nullptr) {
+		munmap(sqes, sqes_size);
+	}
+	if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+		munmap(cq_ptr, cq_size);
+	}
+	if (sq_ptr != MAP_FAILED) {
+		munmap(sq_ptr, sq_size);
+	}
+	if (ring_fd >= 0) {
+		close(ring_fd);
+	}
+}
+
+
+auto AsyncFileReader::Ring::Create(uint32_t entries) -> bool
+{
+	io_uring_params params{};
+	ring_fd = int(syscall(__NR_io_uring_setup, entries, &params));
+	if (ring_fd < 0) {
+		return false;
+	}
+
+	// Kernels before 5.6 can not open, read and close through the ring
+	constexpr uint32_t PROBE_OPS = 256;
+	std::vector<uint8_t> probe_memory(
+		sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)
+	);
+	auto* probe = reinterpret_cast<io_uring_probe*>(probe_memory.data());
+	if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+		return false;
+	}
+	for (const auto op : { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE }) {
+		if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+			return false;
+		}
+	}
+
+	sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap) {
+		sq_size = std::max(sq_size, cq_size);
+		cq_size = sq_size;
+	}
+
+	sq_ptr = mmap(
+		nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+		IORING_OFF_SQ_RING
+	);
+	if (sq_ptr == MAP_FAILED) {
+		return false;
+	}
+	cq_ptr = single_mmap ? sq_ptr : mmap(
+		nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+		IORING_OFF_CQ_RING
+	);
+	if (cq_ptr == MAP_FAILED) {
+		return false;
+	}
+	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	auto* sqes_ptr = mmap(
+		nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+		IORING_OFF_SQES
+	);
+	if (sqes_ptr == MAP_FAILED) {
+		return false;
+	}
+	sqes = static_cast<io_uring_sqe*>(sqes_ptr);
+
+	auto* sq = static_cast<uint8_t*>(sq_ptr);
+	auto* cq = static_cast<uint8_t*>(cq_ptr);
+	sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+	sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+	sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+	cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+	cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+	cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+	cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	local_tail = *sq_tail;
+	return true;
+}
+
+
+auto AsyncFileReader::Ring::PushEntry() -> io_uring_sqe*
+{
+	// The kernel only sees the entry once Enter publishes the new tail, so the caller can
+	// fill it in the meantime
+	const auto index = local_tail++ & sq_mask;
+	auto* sqe = &sqes[index];
+	*sqe = io_uring_sqe{};
+	sq_array[index] = index;
+	to_submit++;
+	return sqe;
+}
+
+
+auto AsyncFileReader::Ring::Enter(uint32_t min_complete) -> bool
+{
+	// Waits between submissions the kernel refused, while no completion frees its resources
+	constexpr auto MIN_BACKOFF = std::chrono::microseconds(50);
+	constexpr auto MAX_BACKOFF = std::chrono::microseconds(2000);
+
+	std::atomic_ref<uint32_t>(*sq_tail).store(local_tail, std::memory_order_release);
+
+	auto backoff = MIN_BACKOFF;
+	while (true) {
+		const auto result = syscall(
+			__NR_io_uring_enter, ring_fd, to_submit, min_complete, IORING_ENTER_GETEVENTS,
+			nullptr, 0
+		);
+		if (result >= 0) {
+			to_submit -= uint32_t(result);
+			return true;
+		}
+		// The kernel is short of resources or the completion queue is full. Completions that
+		// are there are drained by the caller before entering again, otherwise the requests
+		// in flight get some time to finish.
+		if (errno == EAGAIN || errno == EBUSY) {
+			const auto head = std::atomic_ref<uint32_t>(*cq_head).load(std::memory_order_relaxed);
+			const auto tail = std::atomic_ref<uint32_t>(*cq_tail).load(std::memory_order_acquire);
+			if (head != tail) {
+				return true;
+			}
+			std::this_thread::sleep_for(backoff);
+			backoff = std::min(backoff * 2, MAX_BACKOFF);
+			continue;
+		}
+		if (errno != EINTR) {
+			return false;
+		}
+	}
+}
+#else
+struct AsyncFileReader::Ring
+{
+};
+#endif
+
+
+AsyncFileReader::AsyncFileReader(
+	utils::ThreadPool* callback_pool, size_t max_in_flight, IoBackend backend
+) :
+	m_callback_pool(callback_pool),
+	m_max_in_flight(std::max<size_t>(max_in_flight, 1))
+{
+#ifdef ASYNC_FILE_READER_IO_URING
+	if (backend != IoBackend::Threads) {
+		auto ring = std::make_unique<Ring>();
+		if (ring->Create(uint32_t(m_max_in_flight))) {
+			ring->slots.resize(m_max_in_flight);
+			for (auto i = uint32_t(m_max_in_flight); i > 0; i--) {
+				ring->free_slots.push_back(i - 1);
+			}
+			m_ring = std::move(ring);
+			m_backend = IoBackend::IoUring;
+			m_ring_thread = std::thread([this]() { RunRing(); });
+			return;
+		}
+	}
+#else
+	UNREFERENCED_PARAMETER(backend);
+#endif
+	m_io_threads = std::make_unique<utils::ThreadPool>(std::min(IO_THREADS, m_max_in_flight));
+}
+
+
+AsyncFileReader::~AsyncFileReader()
+{
+	Wait();
+	if (m_ring_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_queue_cv.notify_one();
+		m_ring_thread.join();
+	}
+}
+
+
+void AsyncFileReader::Read(const std::string& filename, Callback callback)
+{
+	m_batch.push_back({ filename, std::move(callback) });
+	if (m_batch.size() >= m_max_in_flight) {
+		Submit();
+	}
+}
+
+
+void AsyncFileReader::Submit()
+{
+	size_t next{ 0 };
+	while (next < m_batch.size()) {
+		// Admit as many reads as the limit allows and hand them over together
+		size_t count{ 0 };
+		bool use_ring{ false };
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done_cv.wait(lock, [this]() { return m_in_flight < m_max_in_flight; });
+			count = std::min(m_batch.size() - next, m_max_in_flight - m_in_flight);
+			m_in_flight += count;
+			m_stats.requests += count;
+			m_stats.peak_in_flight = std::max(m_stats.peak_in_flight, m_in_flight);
+			use_ring = m_backend == IoBackend::IoUring;
+			if (use_ring) {
+				for (size_t i = 0; i < count; i++) {
+					m_queue.push_back(std::move(m_batch[next + i]));
+				}
+			}
+		}
+
+		if (use_ring) {
+			m_queue_cv.notify_one();
+		}
+		else {
+			for (size_t i = 0; i < count; i++) {
+				ReadBlocking(std::move(m_batch[next + i]));
+			}
+		}
+		next += count;
+	}
+	m_batch.clear();
+}
+
+
+void AsyncFileReader::Wait()
+{
+	Submit();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done_cv.wait(lock, [this]() { return m_in_flight == 0; });
+}
+
+
+auto AsyncFileReader::GetBackend() const -> IoBackend
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_backend;
+}
+
+
+auto AsyncFileReader::GetStats() const -> Stats
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+
+auto AsyncFileReader::ReadFile(const std::string& filename, std::vector<uint8_t>& data) -> bool
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (file.fail()) {
+		return false;
+	}
+	const auto size = std::streamoff(file.tellg());
+	if (size < 0) {
+		return false;
+	}
+	data.resize(size_t(size));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), std::streamsize(size));
+	return !file.fail();
+}
+
+
+void AsyncFileReader::ReadBlocking(Request&& request)
+{
+	m_io_threads->Submit([this, request = std::move(request)]() mutable {
+		Result result;
+		result.filename = request.filename;
+		result.success = ReadFile(request.filename, result.data);
+		Finish(std::move(request), std::move(result));
+	});
+}
+
+
+void AsyncFileReader::Finish(Request&& request, Result&& result)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.failed += result.success ? 0 : 1;
+		m_stats.bytes += result.data.size();
+	}
+
+	// The read only counts as done once its callback returned, that also bounds the memory
+	// of the results waiting for a callback thread
+	auto job = [this, callback = std::move(request.callback),
+		result = std::move(result)]() mutable {
+		callback(std::move(result));
+		// Notified under the lock, the reader may be destroyed as soon as the waiter sees
+		// the count drop
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_in_flight--;
+		m_done_cv.notify_all();
+	};
+	if (m_callback_pool != nullptr) {
+		m_callback_pool->Submit(std::move(job));
+	}
+	else {
+		job();
+	}
+}
+
+
+#ifdef ASYNC_FILE_READER_IO_URING
+void AsyncFileReader::RunRing()
+{
+	auto& ring = *m_ring;
+	size_t active{ 0 };
+
+	const auto prepare = [&ring](uint32_t slot_idx) {
+		auto& slot = ring.slots[slot_idx];
+		auto* sqe = ring.PushEntry();
+		sqe->user_data = slot_idx;
+		switch (slot.stage)
+		{
+			case Ring::Stage::Open:
+				sqe->opcode = IORING_OP_OPENAT;
+				sqe->fd = AT_FDCWD;
+				sqe->addr = reinterpret_cast<uintptr_t>(slot.request.filename.c_str());
+				sqe->open_flags = O_RDONLY | O_CLOEXEC;
+				break;
+			case Ring::Stage::Read:
+			{
+				// A single read is limited to 2 GiB, larger files take several
+				const auto remaining = slot.result.data.size() - slot.offset;
+				sqe->opcode = IORING_OP_READ;
+				sqe->fd = slot.fd;
+				sqe->addr = reinterpret_cast<uintptr_t>(slot.result.data.data() + slot.offset);
+				sqe->len = uint32_t(std::min<uint64_t>(remaining, 1U << 30));
+				sqe->off = slot.offset;
+				break;
+			}
+			case Ring::Stage::Close:
+				sqe->opcode = IORING_OP_CLOSE;
+				sqe->fd = slot.fd;
+				break;
+		}
+	};
+
+	// Hands the result to the callback, the file is closed afterwards
+	const auto finish = [this, &ring, &prepare](uint32_t slot_idx, bool success) {
+		auto& slot = ring.slots[slot_idx];
+		slot.result.filename = slot.request.filename;
+		slot.result.success = success;
+		if (!success) {
+			slot.result.data.clear();
+		}
+		Finish(std::move(slot.request), std::move(slot.result));
+		slot.request = Request();
+		slot.result = Result();
+		slot.stage = Ring::Stage::Close;
+		prepare(slot_idx);
+	};
+
+	const auto advance = [&](uint32_t slot_idx, int32_t res) {
+		auto& slot = ring.slots[slot_idx];
+		switch (slot.stage)
+		{
+			case Ring::Stage::Open:
+			{
+				struct stat file_stat {};
+				if (res < 0) {
+					Finish(std::move(slot.request), Result{ slot.request.filename, {}, false });
+					slot = Ring::Slot();
+					ring.free_slots.push_back(slot_idx);
+					active--;
+					break;
+				}
+				slot.fd = res;
+				// The inode was just loaded by the open, so this does not wait for the disk
+				if (fstat(slot.fd, &file_stat) != 0) {
+					finish(slot_idx, false);
+					break;
+				}
+				slot.result.data.resize(size_t(file_stat.st_size));
+				slot.offset = 0;
+				slot.stage = Ring::Stage::Read;
+				if (slot.result.data.empty()) {
+					finish(slot_idx, true);
+					break;
+				}
+				prepare(slot_idx);
+				break;
+			}
+			case Ring::Stage::Read:
+				// Reading nothing means the file got shorter since it was opened
+				if (res <= 0) {
+					finish(slot_idx, false);
+					break;
+				}
+				slot.offset += uint64_t(res);
+				if (slot.offset < slot.result.data.size()) {
+					prepare(slot_idx);
+					break;
+				}
+				finish(slot_idx, true);
+				break;
+			case Ring::Stage::Close:
+				slot = Ring::Slot();
+				ring.free_slots.push_back(slot_idx);
+				active--;
+				break;
+		}
+	};
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (active == 0) {
+				m_queue_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+				if (m_queue.empty()) {
+					return;
+				}
+			}
+			while (!m_queue.empty() && !ring.free_slots.empty()) {
+				const auto slot_idx = ring.free_slots.back();
+				ring.free_slots.pop_back();
+				ring.slots[slot_idx].request = std::move(m_queue.front());
+				m_queue.pop_front();
+				prepare(slot_idx);
+				active++;
+			}
+		}
+
+		if (!ring.Enter(1)) {
+			FailRing();
+			return;
+		}
+
+		std::atomic_ref<uint32_t> cq_tail(*ring.cq_tail);
+		std::atomic_ref<uint32_t> cq_head(*ring.cq_head);
+		auto head = cq_head.load(std::memory_order_relaxed);
+		const auto tail = cq_tail.load(std::memory_order_acquire);
+		for (; head != tail; head++) {
+			const auto& cqe = ring.cqes[head & ring.cq_mask];
+			const auto slot_idx = uint32_t(cqe.user_data);
+			const auto res = cqe.res;
+			advance(slot_idx, res);
+		}
+		cq_head.store(head, std::memory_order_release);
+	}
+}
+
+
+void AsyncFileReader::FailRing()
+{
+	auto& ring = *m_ring;
+	std::deque<Request> queued;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_io_threads = std::make_unique<utils::ThreadPool>(std::min(IO_THREADS, m_max_in_flight));
+		m_backend = IoBackend::Threads;
+		queued.swap(m_queue);
+	}
+
+	// Reads in the ring fail. Their slots keep the buffers, which requests the kernel already
+	// took may still write to until the ring is destroyed.
+	for (auto& slot : ring.slots) {
+		if (slot.request.callback) {
+			Finish(std::move(slot.request), Result{ slot.request.filename, {}, false });
+		}
+		if (slot.fd >= 0) {
+			close(slot.fd);
+			slot.fd = -1;
+		}
+	}
+	for (auto& request : queued) {
+		ReadBlocking(std::move(request));
+	}
+}
+#else
+void AsyncFileReader::RunRing()
+{
+}
+
+
+void AsyncFileReader::FailRing()
+{
+}
+#endif
+
+} // namespace io
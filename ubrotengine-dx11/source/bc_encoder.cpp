@@ -0,0 +1,1233 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: bc_encoder.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/bc_encoder.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define BC_ENCODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+using Block = std::array<uint8_t, 64>;
+using Vec4 = std::array<float, 4>;
+using Color = std::array<int32_t, 4>;
+
+constexpr uint32_t BLOCK_PIXELS = 16;
+
+// Block rows per parallel task
+constexpr uint32_t MIN_ROWS_PER_TASK = 4;
+
+// Number of BC7 mode 1 partitions that get a full encode after the quick estimate
+constexpr size_t BC7_PARTITION_CANDIDATES = 4;
+
+// Interpolation weights of BC7 with 2, 3 and 4 bit indices (in 1/64)
+constexpr std::array<int32_t, 8> BC7_WEIGHTS3 = { 0, 9, 18, 27, 37, 46, 55, 64 };
+constexpr std::array<int32_t, 16> BC7_WEIGHTS4 = {
+	0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+// Two subset partitions of BC7, bit i is the subset of pixel i
+constexpr std::array<uint16_t, 64> BC7_PARTITIONS2 = {
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+	0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+	0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+	0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+	0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+
+// Pixel whose index has an implicit zero high bit in the second subset
+constexpr std::array<uint8_t, 64> BC7_ANCHORS2 = {
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+	15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+	6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+};
+
+/**
+ * Layout of the BC7 modes used by the encoder.
+ */
+struct Bc7Mode
+{
+	uint32_t number;
+	uint32_t color_bits;
+	// 0 if the mode has no alpha, which then decodes as 255
+	uint32_t alpha_bits;
+	bool shared_pbit;
+	uint32_t index_bits;
+};
+
+constexpr Bc7Mode BC7_MODE1 = { 1, 6, 0, true, 3 };
+constexpr Bc7Mode BC7_MODE6 = { 6, 7, 7, false, 4 };
+// Mode 1 with finer endpoints, only used to rank the partitions
+constexpr Bc7Mode BC7_MODE1_ESTIMATE = { 1, 7, 0, false, 3 };
+
+/**
+ * Quantized endpoints of one BC7 subset without their p-bits.
+ */
+struct Bc7Endpoints
+{
+	std::array<std::array<uint8_t, 4>, 2> values{};
+	std::array<uint8_t, 2> pbits{};
+};
+
+/**
+ * Writes values into a 128 bit block starting with the least significant bit.
+ */
+class BitWriter
+{
+
+public:
+	explicit BitWriter(uint8_t* block) : m_block(block)
+	{
+		std::memset(m_block, 0, 16);
+	}
+
+	void Write(uint32_t value, uint32_t bits)
+	{
+		for (uint32_t i = 0; i < bits; i++, m_position++) {
+			if (((value >> i) & 1U) != 0) {
+				m_block[m_position >> 3U] |= uint8_t(1U << (m_position & 7U));
+			}
+		}
+	}
+
+private:
+	uint8_t* m_block;
+	uint32_t m_position{ 0 };
+};
+
+auto GetChannelCount(BcFormat format) -> uint32_t
+{
+	return format == BcFormat::BC5 ? 2 : 4;
+}
+
+auto Square(int32_t x) -> int64_t
+{
+	return int64_t(x) * x;
+}
+
+/**
+ * Returns the per channel minimum and maximum of all pixels.
+ */
+void GetBounds(const Block& pixels, std::array<uint8_t, 4>& lo, std::array<uint8_t, 4>& hi)
+{
+#ifdef BC_ENCODER_SSE2
+	const auto* src = reinterpret_cast<const __m128i*>(pixels.data());
+	const auto a = _mm_loadu_si128(src);
+	const auto b = _mm_loadu_si128(src + 1);
+	const auto c = _mm_loadu_si128(src + 2);
+	const auto d = _mm_loadu_si128(src + 3);
+	auto min = _mm_min_epu8(_mm_min_epu8(a, b), _mm_min_epu8(c, d));
+	auto max = _mm_max_epu8(_mm_max_epu8(a, b), _mm_max_epu8(c, d));
+	min = _mm_min_epu8(min, _mm_srli_si128(min, 8));
+	max = _mm_max_epu8(max, _mm_srli_si128(max, 8));
+	min = _mm_min_epu8(min, _mm_srli_si128(min, 4));
+	max = _mm_max_epu8(max, _mm_srli_si128(max, 4));
+	const int32_t min_value = _mm_cvtsi128_si32(min);
+	const int32_t max_value = _mm_cvtsi128_si32(max);
+	std::memcpy(lo.data(), &min_value, 4);
+	std::memcpy(hi.data(), &max_value, 4);
+#else
+	lo.fill(255);
+	hi.fill(0);
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		for (uint32_t c = 0; c < 4; c++) {
+			lo[c] = std::min(lo[c], pixels[i * 4 + c]);
+			hi[c] = std::max(hi[c], pixels[i * 4 + c]);
+		}
+	}
+#endif
+}
+
+/**
+ * Picks the diagonal of the bounding box that follows the pixels. Channels that correlate
+ * negatively with the channel of the largest range get their bounds swapped.
+ */
+void FixDiagonal(const Block& pixels, uint32_t channels, Vec4& lo, Vec4& hi)
+{
+	uint32_t ref = 0;
+	for (uint32_t c = 1; c < channels; c++) {
+		if (hi[c] - lo[c] > hi[ref] - lo[ref]) {
+			ref = c;
+		}
+	}
+
+	Vec4 center{};
+	for (uint32_t c = 0; c < 4; c++) {
+		center[c] = (lo[c] + hi[c]) * 0.5F;
+	}
+	for (uint32_t c = 0; c < channels; c++) {
+		if (c == ref) {
+			continue;
+		}
+		float covariance = 0.0F;
+		for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+			covariance += (pixels[i * 4 + c] - center[c]) * (pixels[i * 4 + ref] - center[ref]);
+		}
+		if (covariance < 0.0F) {
+			std::swap(lo[c], hi[c]);
+		}
+	}
+}
+
+/**
+ * Fits a line through the given pixels and returns its extent as two endpoints.
+ */
+void GetPrincipalEndpoints(
+	const Block& pixels, const uint8_t* members, uint32_t count, uint32_t channels,
+	Vec4& lo, Vec4& hi
+)
+{
+	Vec4 mean{};
+	for (uint32_t m = 0; m < count; m++) {
+		for (uint32_t c = 0; c < channels; c++) {
+			mean[c] += pixels[members[m] * 4 + c];
+		}
+	}
+	for (uint32_t c = 0; c < channels; c++) {
+		mean[c] /= float(count);
+	}
+
+	std::array<std::array<float, 4>, 4> covariance{};
+	for (uint32_t m = 0; m < count; m++) {
+		Vec4 d{};
+		for (uint32_t c = 0; c < channels; c++) {
+			d[c] = pixels[members[m] * 4 + c] - mean[c];
+		}
+		for (uint32_t r = 0; r < channels; r++) {
+			for (uint32_t c = 0; c < channels; c++) {
+				covariance[r][c] += d[r] * d[c];
+			}
+		}
+	}
+
+	// Power iteration for the eigenvector of the largest eigenvalue
+	Vec4 axis{ 1.0F, 1.0F, 1.0F, 1.0F };
+	for (uint32_t iteration = 0; iteration < 8; iteration++) {
+		Vec4 next{};
+		float largest = 0.0F;
+		for (uint32_t r = 0; r < channels; r++) {
+			for (uint32_t c = 0; c < channels; c++) {
+				next[r] += covariance[r][c] * axis[c];
+			}
+			largest = std::max(largest, std::abs(next[r]));
+		}
+		if (largest <= 0.0F) {
+			break;
+		}
+		for (uint32_t c = 0; c < channels; c++) {
+			axis[c] = next[c] / largest;
+		}
+	}
+
+	float length = 0.0F;
+	for (uint32_t c = 0; c < channels; c++) {
+		length += axis[c] * axis[c];
+	}
+
+	float t_min = 0.0F;
+	float t_max = 0.0F;
+	if (length > 0.0F) {
+		for (uint32_t m = 0; m < count; m++) {
+			float t = 0.0F;
+			for (uint32_t c = 0; c < channels; c++) {
+				t += (pixels[members[m] * 4 + c] - mean[c]) * axis[c];
+			}
+			t /= length;
+			t_min = std::min(t_min, t);
+			t_max = std::max(t_max, t);
+		}
+	}
+
+	for (uint32_t c = 0; c < 4; c++) {
+		lo[c] = c < channels ? std::clamp(mean[c] + axis[c] * t_min, 0.0F, 255.0F) : 255.0F;
+		hi[c] = c < channels ? std::clamp(mean[c] + axis[c] * t_max, 0.0F, 255.0F) : 255.0F;
+	}
+}
+
+/**
+ * Solves for the two endpoints that best reproduce the pixels with fixed interpolation
+ * weights (0 selects \p lo, 1 selects \p hi).
+ * @return false if all weights are equal and the system has no unique solution
+ */
+auto SolveEndpoints(
+	const Block& pixels, const uint8_t* members, const float* weights, uint32_t count,
+	uint32_t channels, Vec4& lo, Vec4& hi
+) -> bool
+{
+	float aa = 0.0F;
+	float bb = 0.0F;
+	float ab = 0.0F;
+	Vec4 ax{};
+	Vec4 bx{};
+	for (uint32_t m = 0; m < count; m++) {
+		const float b = weights[m];
+		const float a = 1.0F - b;
+		aa += a * a;
+		bb += b * b;
+		ab += a * b;
+		for (uint32_t c = 0; c < channels; c++) {
+			ax[c] += a * pixels[members[m] * 4 + c];
+			bx[c] += b * pixels[members[m] * 4 + c];
+		}
+	}
+
+	const float det = aa * bb - ab * ab;
+	if (std::abs(det) < 1e-6F) {
+		return false;
+	}
+	for (uint32_t c = 0; c < channels; c++) {
+		lo[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0F, 255.0F);
+		hi[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0F, 255.0F);
+	}
+	return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// BC1
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+auto Pack565(const Vec4& color) -> uint16_t
+{
+	// The values are clamped to be positive, so truncation after adding 0.5 rounds
+	const auto r = uint32_t(std::clamp(color[0], 0.0F, 255.0F) * (31.0F / 255.0F) + 0.5F);
+	const auto g = uint32_t(std::clamp(color[1], 0.0F, 255.0F) * (63.0F / 255.0F) + 0.5F);
+	const auto b = uint32_t(std::clamp(color[2], 0.0F, 255.0F) * (31.0F / 255.0F) + 0.5F);
+	return uint16_t((r << 11U) | (g << 5U) | b);
+}
+
+auto Unpack565(uint16_t color) -> Color
+{
+	const int32_t r = (color >> 11U) & 31U;
+	const int32_t g = (color >> 5U) & 63U;
+	const int32_t b = color & 31U;
+	return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 255 };
+}
+
+/**
+ * Builds the four colors a decoder derives from the endpoints.
+ * @param four_color true for the color part of BC2/BC3, which ignores the endpoint order
+ * @return true if the palette has three colors and transparent black
+ */
+auto BuildBc1Palette(
+	uint16_t c0, uint16_t c1, bool four_color, std::array<Color, 4>& palette
+) -> bool
+{
+	const auto a = Unpack565(c0);
+	const auto b = Unpack565(c1);
+	palette[0] = a;
+	palette[1] = b;
+	if (four_color || c0 > c1) {
+		for (uint32_t c = 0; c < 3; c++) {
+			palette[2][c] = (2 * a[c] + b[c]) / 3;
+			palette[3][c] = (a[c] + 2 * b[c]) / 3;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = 255;
+		return false;
+	}
+	for (uint32_t c = 0; c < 3; c++) {
+		palette[2][c] = (a[c] + b[c]) / 2;
+	}
+	palette[2][3] = 255;
+	palette[3] = { 0, 0, 0, 0 };
+	return true;
+}
+
+/**
+ * Chooses the closest palette color for every pixel.
+ * @return squared error of RGB, plus alpha unless \p four_color is set
+ */
+auto AssignBc1Indices(
+	const Block& pixels, uint16_t c0, uint16_t c1, bool four_color, uint32_t& indices
+) -> int64_t
+{
+	std::array<Color, 4> palette{};
+	const bool three_color = BuildBc1Palette(c0, c1, four_color, palette);
+
+	int64_t error = 0;
+	indices = 0;
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		const auto* p = pixels.data() + i * 4;
+		uint32_t best = 3;
+		if (!three_color || p[3] >= 128) {
+			int64_t best_error = std::numeric_limits<int64_t>::max();
+			for (uint32_t k = 0; k < (three_color ? 3U : 4U); k++) {
+				const auto e = Square(palette[k][0] - p[0]) + Square(palette[k][1] - p[1])
+					+ Square(palette[k][2] - p[2]);
+				if (e < best_error) {
+					best_error = e;
+					best = k;
+				}
+			}
+		}
+		error += Square(palette[best][0] - p[0]) + Square(palette[best][1] - p[1])
+			+ Square(palette[best][2] - p[2]);
+		if (!four_color) {
+			error += Square(palette[best][3] - p[3]);
+		}
+		indices |= best << (2 * i);
+	}
+	return error;
+}
+
+/**
+ * Cluster fit: orders the pixels along the principal axis and tries every split into four
+ * consecutive clusters, solving for the least squares endpoints of each split.
+ */
+void ClusterFitBc1(const Block& pixels, Vec4& a, Vec4& b)
+{
+	std::array<uint8_t, BLOCK_PIXELS> members{};
+	std::iota(members.begin(), members.end(), uint8_t(0));
+	Vec4 lo{};
+	Vec4 hi{};
+	GetPrincipalEndpoints(pixels, members.data(), BLOCK_PIXELS, 3, lo, hi);
+
+	Vec4 axis{};
+	for (uint32_t c = 0; c < 3; c++) {
+		axis[c] = hi[c] - lo[c];
+	}
+	std::array<float, BLOCK_PIXELS> projection{};
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		projection[i] = pixels[i * 4] * axis[0] + pixels[i * 4 + 1] * axis[1]
+			+ pixels[i * 4 + 2] * axis[2];
+	}
+	std::sort(members.begin(), members.end(), [&projection](uint8_t l, uint8_t r) {
+		return projection[l] < projection[r];
+	});
+
+	// prefix[i] is the sum of the first i pixels in axis order
+	std::array<Vec4, BLOCK_PIXELS + 1> prefix{};
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		for (uint32_t c = 0; c < 3; c++) {
+			prefix[i + 1][c] = prefix[i][c] + pixels[members[i] * 4 + c];
+		}
+	}
+	const auto range_sum = [&prefix](uint32_t begin, uint32_t end, uint32_t c) {
+		return prefix[end][c] - prefix[begin][c];
+	};
+
+	constexpr float third = 1.0F / 3.0F;
+	constexpr float two_thirds = 2.0F / 3.0F;
+	float best_error = std::numeric_limits<float>::max();
+	a = hi;
+	b = lo;
+
+	// Pixels [0, i) decode to b, [i, j) to 2/3 b + 1/3 a, [j, k) to 1/3 b + 2/3 a, the rest
+	// to a
+	for (uint32_t i = 0; i <= BLOCK_PIXELS; i++) {
+		for (uint32_t j = i; j <= BLOCK_PIXELS; j++) {
+			for (uint32_t k = j; k <= BLOCK_PIXELS; k++) {
+				const float n1 = float(j - i);
+				const float n2 = float(k - j);
+				const float n3 = float(BLOCK_PIXELS - k);
+				const float alpha2 = n1 * third * third + n2 * two_thirds * two_thirds + n3;
+				const float beta2 = float(i) + n1 * two_thirds * two_thirds
+					+ n2 * third * third;
+				const float alpha_beta = (n1 + n2) * third * two_thirds;
+				const float det = alpha2 * beta2 - alpha_beta * alpha_beta;
+				if (det < 1e-4F) {
+					continue;
+				}
+
+				Vec4 ca{};
+				Vec4 cb{};
+				std::array<float, 3> ax{};
+				std::array<float, 3> bx{};
+				for (uint32_t c = 0; c < 3; c++) {
+					ax[c] = range_sum(i, j, c) * third + range_sum(j, k, c) * two_thirds
+						+ range_sum(k, BLOCK_PIXELS, c);
+					bx[c] = range_sum(0, i, c) + range_sum(i, j, c) * two_thirds
+						+ range_sum(j, k, c) * third;
+					ca[c] = (ax[c] * beta2 - bx[c] * alpha_beta) / det;
+					cb[c] = (bx[c] * alpha2 - ax[c] * alpha_beta) / det;
+				}
+
+				// Error of the quantized endpoints without the constant sum of squares
+				const auto qa = Unpack565(Pack565(ca));
+				const auto qb = Unpack565(Pack565(cb));
+				float error = 0.0F;
+				for (uint32_t c = 0; c < 3; c++) {
+					error += qa[c] * qa[c] * alpha2 + qb[c] * qb[c] * beta2
+						+ 2.0F * (qa[c] * qb[c] * alpha_beta - qa[c] * ax[c] - qb[c] * bx[c]);
+				}
+				if (error < best_error) {
+					best_error = error;
+					a = ca;
+					b = cb;
+				}
+			}
+		}
+	}
+}
+
+void WriteBc1(uint8_t* block, uint16_t c0, uint16_t c1, uint32_t indices)
+{
+	block[0] = uint8_t(c0 & 0xFFU);
+	block[1] = uint8_t(c0 >> 8U);
+	block[2] = uint8_t(c1 & 0xFFU);
+	block[3] = uint8_t(c1 >> 8U);
+	std::memcpy(block + 4, &indices, 4);
+}
+
+/**
+ * Encodes the color part of BC1, BC2 and BC3.
+ * @param four_color true for BC3, which always interpolates two colors and has no
+ *        transparent index
+ */
+auto EncodeBc1Color(
+	const Block& pixels, BcQuality quality, bool four_color, uint8_t* block
+) -> int64_t
+{
+	uint32_t indices = 0;
+
+	bool transparent = false;
+	for (uint32_t i = 0; i < BLOCK_PIXELS && !four_color; i++) {
+		transparent = transparent || pixels[i * 4 + 3] < 128;
+	}
+	if (transparent) {
+		// Three color mode (c0 <= c1), the endpoints only cover the opaque pixels
+		Vec4 lo{ 255.0F, 255.0F, 255.0F, 0.0F };
+		Vec4 hi{};
+		bool any_opaque = false;
+		for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+			if (pixels[i * 4 + 3] >= 128) {
+				any_opaque = true;
+				for (uint32_t c = 0; c < 3; c++) {
+					lo[c] = std::min(lo[c], float(pixels[i * 4 + c]));
+					hi[c] = std::max(hi[c], float(pixels[i * 4 + c]));
+				}
+			}
+		}
+		auto c0 = any_opaque ? Pack565(lo) : uint16_t(0);
+		auto c1 = any_opaque ? Pack565(hi) : uint16_t(0);
+		if (c0 > c1) {
+			std::swap(c0, c1);
+		}
+		const auto error = AssignBc1Indices(pixels, c0, c1, false, indices);
+		WriteBc1(block, c0, c1, indices);
+		return error;
+	}
+
+	std::array<uint8_t, 4> lo8{};
+	std::array<uint8_t, 4> hi8{};
+	GetBounds(pixels, lo8, hi8);
+	Vec4 lo{};
+	Vec4 hi{};
+	for (uint32_t c = 0; c < 3; c++) {
+		// Move the endpoints inwards, the extremes are rarely hit exactly
+		const float inset = (hi8[c] - lo8[c]) / 16.0F;
+		lo[c] = lo8[c] + inset;
+		hi[c] = hi8[c] - inset;
+	}
+	FixDiagonal(pixels, 3, lo, hi);
+
+	auto c0 = Pack565(hi);
+	auto c1 = Pack565(lo);
+	if (c0 < c1) {
+		std::swap(c0, c1);
+	}
+	auto error = AssignBc1Indices(pixels, c0, c1, four_color, indices);
+
+	if (quality == BcQuality::High && error > 0) {
+		Vec4 a{};
+		Vec4 b{};
+		ClusterFitBc1(pixels, a, b);
+		auto f0 = Pack565(a);
+		auto f1 = Pack565(b);
+		if (f0 < f1) {
+			std::swap(f0, f1);
+		}
+		uint32_t fit_indices = 0;
+		const auto fit_error = AssignBc1Indices(pixels, f0, f1, four_color, fit_indices);
+		if (fit_error < error) {
+			error = fit_error;
+			c0 = f0;
+			c1 = f1;
+			indices = fit_indices;
+		}
+	}
+
+	WriteBc1(block, c0, c1, indices);
+	return error;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// BC4 (alpha of BC3, channels of BC5)
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+void BuildBc4Palette(int32_t e0, int32_t e1, std::array<int32_t, 8>& palette)
+{
+	palette[0] = e0;
+	palette[1] = e1;
+	if (e0 > e1) {
+		for (int32_t i = 2; i < 8; i++) {
+			palette[i] = ((8 - i) * e0 + (i - 1) * e1) / 7;
+		}
+		return;
+	}
+	for (int32_t i = 2; i < 6; i++) {
+		palette[i] = ((6 - i) * e0 + (i - 1) * e1) / 5;
+	}
+	palette[6] = 0;
+	palette[7] = 255;
+}
+
+auto AssignBc4Indices(
+	const std::array<uint8_t, 16>& values, int32_t e0, int32_t e1,
+	std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	std::array<int32_t, 8> palette{};
+	BuildBc4Palette(e0, e1, palette);
+
+	int64_t error = 0;
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		auto best_error = std::numeric_limits<int64_t>::max();
+		for (uint8_t k = 0; k < 8; k++) {
+			const auto e = Square(palette[k] - values[i]);
+			if (e < best_error) {
+				best_error = e;
+				indices[i] = k;
+			}
+		}
+		error += best_error;
+	}
+	return error;
+}
+
+auto EncodeBc4(const std::array<uint8_t, 16>& values, BcQuality quality, uint8_t* block)
+	-> int64_t
+{
+	const auto [min, max] = std::minmax_element(values.begin(), values.end());
+
+	int32_t e0 = *max;
+	int32_t e1 = *min;
+	std::array<uint8_t, 16> indices{};
+	auto error = AssignBc4Indices(values, e0, e1, indices);
+
+	if (quality == BcQuality::High && error > 0) {
+		const auto try_endpoints = [&](int32_t t0, int32_t t1) {
+			std::array<uint8_t, 16> candidate{};
+			const auto e = AssignBc4Indices(values, t0, t1, candidate);
+			if (e < error) {
+				error = e;
+				e0 = t0;
+				e1 = t1;
+				indices = candidate;
+			}
+		};
+
+		// Six value mode, 0 and 255 are available without spending interpolation steps
+		int32_t inner_min = 255;
+		int32_t inner_max = 0;
+		for (auto v : values) {
+			if (v != 0 && v != 255) {
+				inner_min = std::min(inner_min, int32_t(v));
+				inner_max = std::max(inner_max, int32_t(v));
+			}
+		}
+		if (inner_min <= inner_max) {
+			try_endpoints(inner_min, inner_max);
+		}
+
+		// Least squares refinement of the eight value mode
+		for (uint32_t iteration = 0; iteration < 2 && e0 > e1; iteration++) {
+			float aa = 0.0F;
+			float bb = 0.0F;
+			float ab = 0.0F;
+			float ax = 0.0F;
+			float bx = 0.0F;
+			for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+				const float b = indices[i] == 0 ? 0.0F
+					: indices[i] == 1 ? 1.0F : float(indices[i] - 1) / 7.0F;
+				const float a = 1.0F - b;
+				aa += a * a;
+				bb += b * b;
+				ab += a * b;
+				ax += a * values[i];
+				bx += b * values[i];
+			}
+			const float det = aa * bb - ab * ab;
+			if (std::abs(det) < 1e-6F) {
+				break;
+			}
+			auto t0 = int32_t(std::lround(std::clamp((ax * bb - bx * ab) / det, 0.0F, 255.0F)));
+			auto t1 = int32_t(std::lround(std::clamp((bx * aa - ax * ab) / det, 0.0F, 255.0F)));
+			if (t0 < t1) {
+				std::swap(t0, t1);
+			}
+			try_endpoints(t0, t1);
+		}
+	}
+
+	block[0] = uint8_t(e0);
+	block[1] = uint8_t(e1);
+	uint64_t bits = 0;
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		bits |= uint64_t(indices[i]) << (3 * i);
+	}
+	for (uint32_t i = 0; i < 6; i++) {
+		block[2 + i] = uint8_t(bits >> (8 * i));
+	}
+	return error;
+}
+
+auto EncodeBc4Channel(const Block& pixels, uint32_t channel, BcQuality quality, uint8_t* block)
+	-> int64_t
+{
+	std::array<uint8_t, 16> values{};
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		values[i] = pixels[i * 4 + channel];
+	}
+	return EncodeBc4(values, quality, block);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// BC7
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+auto ExpandBc7(uint32_t value, uint32_t pbit, uint32_t bits) -> int32_t
+{
+	const uint32_t full = (value << 1U) | pbit;
+	const uint32_t n = bits + 1;
+	return int32_t(n >= 8 ? full : (full << (8 - n)) | (full >> (2 * n - 8)));
+}
+
+auto QuantizeBc7(float value, uint32_t pbit, uint32_t bits) -> uint8_t
+{
+	const float full = value * float((1U << (bits + 1)) - 1) / 255.0F;
+	const auto q = std::lround((full - float(pbit)) * 0.5F);
+	return uint8_t(std::clamp<long>(q, 0, (1L << bits) - 1));
+}
+
+/**
+ * Returns the decoded 8 bit color of one endpoint.
+ */
+auto GetBc7Endpoint(const Bc7Endpoints& endpoints, uint32_t side, const Bc7Mode& mode) -> Color
+{
+	Color color{};
+	for (uint32_t c = 0; c < 3; c++) {
+		color[c] = ExpandBc7(endpoints.values[side][c], endpoints.pbits[side], mode.color_bits);
+	}
+	color[3] = mode.alpha_bits == 0
+		? 255 : ExpandBc7(endpoints.values[side][3], endpoints.pbits[side], mode.alpha_bits);
+	return color;
+}
+
+auto QuantizeBc7Endpoints(
+	const Vec4& lo, const Vec4& hi, uint32_t p0, uint32_t p1, const Bc7Mode& mode
+) -> Bc7Endpoints
+{
+	Bc7Endpoints endpoints{};
+	endpoints.pbits = { uint8_t(p0), uint8_t(p1) };
+	for (uint32_t c = 0; c < 4; c++) {
+		const auto bits = c < 3 ? mode.color_bits : mode.alpha_bits;
+		if (bits > 0) {
+			endpoints.values[0][c] = QuantizeBc7(lo[c], p0, bits);
+			endpoints.values[1][c] = QuantizeBc7(hi[c], p1, bits);
+		}
+	}
+	return endpoints;
+}
+
+/**
+ * Chooses the closest interpolated color for every member pixel.
+ * @param indices indexed by pixel, only the members are written
+ */
+auto AssignBc7Indices(
+	const Block& pixels, const uint8_t* members, uint32_t count,
+	const Bc7Endpoints& endpoints, const Bc7Mode& mode, std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	const auto e0 = GetBc7Endpoint(endpoints, 0, mode);
+	const auto e1 = GetBc7Endpoint(endpoints, 1, mode);
+	const uint32_t palette_size = 1U << mode.index_bits;
+	const auto* weights = mode.index_bits == 3 ? BC7_WEIGHTS3.data() : BC7_WEIGHTS4.data();
+
+	std::array<Color, 16> palette{};
+	for (uint32_t k = 0; k < palette_size; k++) {
+		for (uint32_t c = 0; c < 4; c++) {
+			palette[k][c] = ((64 - weights[k]) * e0[c] + weights[k] * e1[c] + 32) >> 6;
+		}
+	}
+
+	int64_t error = 0;
+	for (uint32_t m = 0; m < count; m++) {
+		const auto* p = pixels.data() + members[m] * 4;
+		auto best_error = std::numeric_limits<int64_t>::max();
+		for (uint32_t k = 0; k < palette_size; k++) {
+			const auto e = Square(palette[k][0] - p[0]) + Square(palette[k][1] - p[1])
+				+ Square(palette[k][2] - p[2]) + Square(palette[k][3] - p[3]);
+			if (e < best_error) {
+				best_error = e;
+				indices[members[m]] = uint8_t(k);
+			}
+		}
+		error += best_error;
+	}
+	return error;
+}
+
+/**
+ * Quantizes the endpoints of one subset and assigns the indices.
+ * @param search_pbits true to evaluate every p-bit combination, otherwise the p-bits that
+ *        reproduce the endpoints best are taken
+ */
+auto FitBc7Subset(
+	const Block& pixels, const uint8_t* members, uint32_t count, const Bc7Mode& mode,
+	const Vec4& lo, const Vec4& hi, bool search_pbits, Bc7Endpoints& endpoints,
+	std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	const uint32_t combinations = mode.shared_pbit ? 2 : 4;
+	const auto get_pbits = [&mode](uint32_t combination) {
+		return mode.shared_pbit
+			? std::pair<uint32_t, uint32_t>{ combination, combination }
+			: std::pair<uint32_t, uint32_t>{ combination & 1U, combination >> 1U };
+	};
+
+	if (!search_pbits) {
+		// Endpoint error only
+		uint32_t best = 0;
+		int64_t best_error = std::numeric_limits<int64_t>::max();
+		for (uint32_t combination = 0; combination < combinations; combination++) {
+			const auto [p0, p1] = get_pbits(combination);
+			const auto candidate = QuantizeBc7Endpoints(lo, hi, p0, p1, mode);
+			const auto a = GetBc7Endpoint(candidate, 0, mode);
+			const auto b = GetBc7Endpoint(candidate, 1, mode);
+			int64_t error = 0;
+			for (uint32_t c = 0; c < 4; c++) {
+				error += Square(a[c] - int32_t(std::lround(lo[c])))
+					+ Square(b[c] - int32_t(std::lround(hi[c])));
+			}
+			if (error < best_error) {
+				best_error = error;
+				best = combination;
+			}
+		}
+		const auto [p0, p1] = get_pbits(best);
+		endpoints = QuantizeBc7Endpoints(lo, hi, p0, p1, mode);
+		return AssignBc7Indices(pixels, members, count, endpoints, mode, indices);
+	}
+
+	int64_t best_error = std::numeric_limits<int64_t>::max();
+	std::array<uint8_t, 16> candidate_indices = indices;
+	for (uint32_t combination = 0; combination < combinations; combination++) {
+		const auto [p0, p1] = get_pbits(combination);
+		const auto candidate = QuantizeBc7Endpoints(lo, hi, p0, p1, mode);
+		const auto error = AssignBc7Indices(
+			pixels, members, count, candidate, mode, candidate_indices
+		);
+		if (error < best_error) {
+			best_error = error;
+			endpoints = candidate;
+			for (uint32_t m = 0; m < count; m++) {
+				indices[members[m]] = candidate_indices[members[m]];
+			}
+		}
+	}
+	return best_error;
+}
+
+/**
+ * Refits the endpoints of a subset to its current indices and keeps them if they are
+ * better.
+ */
+auto RefineBc7Subset(
+	const Block& pixels, const uint8_t* members, uint32_t count, const Bc7Mode& mode,
+	int64_t error, Bc7Endpoints& endpoints, std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	const auto* weights = mode.index_bits == 3 ? BC7_WEIGHTS3.data() : BC7_WEIGHTS4.data();
+	const uint32_t channels = mode.alpha_bits == 0 ? 3 : 4;
+
+	for (uint32_t iteration = 0; iteration < 2 && error > 0; iteration++) {
+		std::array<float, 16> t{};
+		for (uint32_t m = 0; m < count; m++) {
+			t[m] = float(weights[indices[members[m]]]) / 64.0F;
+		}
+		Vec4 lo{ 255.0F, 255.0F, 255.0F, 255.0F };
+		Vec4 hi{ 255.0F, 255.0F, 255.0F, 255.0F };
+		if (!SolveEndpoints(pixels, members, t.data(), count, channels, lo, hi)) {
+			break;
+		}
+
+		Bc7Endpoints candidate{};
+		auto candidate_indices = indices;
+		const auto candidate_error = FitBc7Subset(
+			pixels, members, count, mode, lo, hi, true, candidate, candidate_indices
+		);
+		if (candidate_error >= error) {
+			break;
+		}
+		error = candidate_error;
+		endpoints = candidate;
+		indices = candidate_indices;
+	}
+	return error;
+}
+
+/**
+ * Swaps the endpoints of a subset if the index of its anchor pixel has the high bit set,
+ * which the format stores implicitly as zero.
+ */
+void FixBc7Anchor(
+	const uint8_t* members, uint32_t count, uint32_t anchor, const Bc7Mode& mode,
+	Bc7Endpoints& endpoints, std::array<uint8_t, 16>& indices
+)
+{
+	const uint32_t high = 1U << (mode.index_bits - 1);
+	if (indices[anchor] < high) {
+		return;
+	}
+	std::swap(endpoints.values[0], endpoints.values[1]);
+	std::swap(endpoints.pbits[0], endpoints.pbits[1]);
+	const uint32_t max_index = (1U << mode.index_bits) - 1;
+	for (uint32_t m = 0; m < count; m++) {
+		indices[members[m]] = uint8_t(max_index - indices[members[m]]);
+	}
+}
+
+auto EncodeBc7Mode6(
+	const Block& pixels, BcQuality quality, Bc7Endpoints& endpoints,
+	std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	std::array<uint8_t, BLOCK_PIXELS> members{};
+	std::iota(members.begin(), members.end(), uint8_t(0));
+
+	std::array<uint8_t, 4> lo8{};
+	std::array<uint8_t, 4> hi8{};
+	GetBounds(pixels, lo8, hi8);
+	Vec4 lo{};
+	Vec4 hi{};
+	for (uint32_t c = 0; c < 4; c++) {
+		lo[c] = lo8[c];
+		hi[c] = hi8[c];
+	}
+	FixDiagonal(pixels, 4, lo, hi);
+
+	const bool high = quality == BcQuality::High;
+	auto error = FitBc7Subset(
+		pixels, members.data(), BLOCK_PIXELS, BC7_MODE6, lo, hi, high, endpoints, indices
+	);
+	if (!high || error == 0) {
+		return error;
+	}
+
+	Vec4 pca_lo{};
+	Vec4 pca_hi{};
+	GetPrincipalEndpoints(pixels, members.data(), BLOCK_PIXELS, 4, pca_lo, pca_hi);
+	Bc7Endpoints pca_endpoints{};
+	auto pca_indices = indices;
+	const auto pca_error = FitBc7Subset(
+		pixels, members.data(), BLOCK_PIXELS, BC7_MODE6, pca_lo, pca_hi, true, pca_endpoints,
+		pca_indices
+	);
+	if (pca_error < error) {
+		error = pca_error;
+		endpoints = pca_endpoints;
+		indices = pca_indices;
+	}
+	return RefineBc7Subset(
+		pixels, members.data(), BLOCK_PIXELS, BC7_MODE6, error, endpoints, indices
+	);
+}
+
+/**
+ * Splits the pixels into the two subsets of a partition.
+ */
+void GetBc7Subsets(
+	uint32_t partition, std::array<std::array<uint8_t, 16>, 2>& members,
+	std::array<uint32_t, 2>& counts
+)
+{
+	counts = { 0, 0 };
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		const auto subset = (BC7_PARTITIONS2[partition] >> i) & 1U;
+		members[subset][counts[subset]++] = uint8_t(i);
+	}
+}
+
+auto EncodeBc7Mode1(
+	const Block& pixels, uint32_t& partition, std::array<Bc7Endpoints, 2>& endpoints,
+	std::array<uint8_t, 16>& indices
+) -> int64_t
+{
+	std::array<std::array<uint8_t, 16>, 2> members{};
+	std::array<uint32_t, 2> counts{};
+
+	// Quick estimate with unquantized endpoints for every partition
+	std::array<std::pair<int64_t, uint32_t>, 64> estimates{};
+	for (uint32_t p = 0; p < 64; p++) {
+		GetBc7Subsets(p, members, counts);
+		int64_t error = 0;
+		for (uint32_t s = 0; s < 2; s++) {
+			Vec4 lo{};
+			Vec4 hi{};
+			GetPrincipalEndpoints(pixels, members[s].data(), counts[s], 3, lo, hi);
+			const auto rough = QuantizeBc7Endpoints(lo, hi, 0, 0, BC7_MODE1_ESTIMATE);
+			error += AssignBc7Indices(
+				pixels, members[s].data(), counts[s], rough, BC7_MODE1_ESTIMATE, indices
+			);
+		}
+		estimates[p] = { error, p };
+	}
+	std::partial_sort(
+		estimates.begin(), estimates.begin() + BC7_PARTITION_CANDIDATES, estimates.end()
+	);
+
+	int64_t best_error = std::numeric_limits<int64_t>::max();
+	for (size_t candidate = 0; candidate < BC7_PARTITION_CANDIDATES; candidate++) {
+		const auto p = estimates[candidate].second;
+		GetBc7Subsets(p, members, counts);
+
+		std::array<Bc7Endpoints, 2> candidate_endpoints{};
+		std::array<uint8_t, 16> candidate_indices{};
+		int64_t error = 0;
+		for (uint32_t s = 0; s < 2; s++) {
+			Vec4 lo{};
+			Vec4 hi{};
+			GetPrincipalEndpoints(pixels, members[s].data(), counts[s], 3, lo, hi);
+			auto subset_error = FitBc7Subset(
+				pixels, members[s].data(), counts[s], BC7_MODE1, lo, hi, true,
+				candidate_endpoints[s], candidate_indices
+			);
+			error += RefineBc7Subset(
+				pixels, members[s].data(), counts[s], BC7_MODE1, subset_error,
+				candidate_endpoints[s], candidate_indices
+			);
+		}
+		if (error < best_error) {
+			best_error = error;
+			partition = p;
+			endpoints = candidate_endpoints;
+			indices = candidate_indices;
+		}
+	}
+	return best_error;
+}
+
+void WriteBc7Mode6(uint8_t* block, Bc7Endpoints endpoints, std::array<uint8_t, 16> indices)
+{
+	std::array<uint8_t, BLOCK_PIXELS> members{};
+	std::iota(members.begin(), members.end(), uint8_t(0));
+	FixBc7Anchor(members.data(), BLOCK_PIXELS, 0, BC7_MODE6, endpoints, indices);
+
+	BitWriter writer(block);
+	writer.Write(1U << 6U, 7);
+	for (uint32_t c = 0; c < 4; c++) {
+		writer.Write(endpoints.values[0][c], 7);
+		writer.Write(endpoints.values[1][c], 7);
+	}
+	writer.Write(endpoints.pbits[0], 1);
+	writer.Write(endpoints.pbits[1], 1);
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		writer.Write(indices[i], i == 0 ? 3 : 4);
+	}
+}
+
+void WriteBc7Mode1(
+	uint8_t* block, uint32_t partition, std::array<Bc7Endpoints, 2> endpoints,
+	std::array<uint8_t, 16> indices
+)
+{
+	std::array<std::array<uint8_t, 16>, 2> members{};
+	std::array<uint32_t, 2> counts{};
+	GetBc7Subsets(partition, members, counts);
+	const std::array<uint32_t, 2> anchors = { 0, BC7_ANCHORS2[partition] };
+	for (uint32_t s = 0; s < 2; s++) {
+		FixBc7Anchor(members[s].data(), counts[s], anchors[s], BC7_MODE1, endpoints[s], indices);
+	}
+
+	BitWriter writer(block);
+	writer.Write(1U << 1U, 2);
+	writer.Write(partition, 6);
+	for (uint32_t c = 0; c < 3; c++) {
+		for (uint32_t s = 0; s < 2; s++) {
+			writer.Write(endpoints[s].values[0][c], 6);
+			writer.Write(endpoints[s].values[1][c], 6);
+		}
+	}
+	writer.Write(endpoints[0].pbits[0], 1);
+	writer.Write(endpoints[1].pbits[0], 1);
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		writer.Write(indices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+	}
+}
+
+auto EncodeBc7(const Block& pixels, BcQuality quality, uint8_t* block) -> int64_t
+{
+	Bc7Endpoints endpoints{};
+	std::array<uint8_t, 16> indices{};
+	const auto error = EncodeBc7Mode6(pixels, quality, endpoints, indices);
+
+	bool opaque = true;
+	for (uint32_t i = 0; i < BLOCK_PIXELS; i++) {
+		opaque = opaque && pixels[i * 4 + 3] == 255;
+	}
+	if (quality == BcQuality::High && opaque && error > 0) {
+		uint32_t partition = 0;
+		std::array<Bc7Endpoints, 2> subset_endpoints{};
+		std::array<uint8_t, 16> subset_indices{};
+		const auto subset_error = EncodeBc7Mode1(
+			pixels, partition, subset_endpoints, subset_indices
+		);
+		if (subset_error < error) {
+			WriteBc7Mode1(block, partition, subset_endpoints, subset_indices);
+			return subset_error;
+		}
+	}
+
+	WriteBc7Mode6(block, endpoints, indices);
+	return error;
+}
+
+} // namespace
+
+
+auto BcEncoder::Stats::GetPsnr() const -> double
+{
+	if (squared_error <= 0.0 || samples == 0) {
+		return std::numeric_limits<double>::infinity();
+	}
+	const double mse = squared_error / double(samples);
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+
+auto BcEncoder::GetBlockBytes(BcFormat format) -> uint32_t
+{
+	return format == BcFormat::BC1 ? 8 : 16;
+}
+
+
+auto BcEncoder::GetTextureFormat(BcFormat format, bool srgb) -> graphics::TextureFormat
+{
+	using Format = graphics::TextureFormat;
+
+	switch (format)
+	{
+		case BcFormat::BC1:
+			return srgb ? Format::BC1_UNORM_SRGB : Format::BC1_UNORM;
+		case BcFormat::BC3:
+			return srgb ? Format::BC3_UNORM_SRGB : Format::BC3_UNORM;
+		case BcFormat::BC5:
+			return Format::BC5_UNORM;
+		case BcFormat::BC7:
+			return srgb ? Format::BC7_UNORM_SRGB : Format::BC7_UNORM;
+		default:
+			return Format::UNKNOWN;
+	}
+}
+
+
+auto BcEncoder::Compress(
+	const Image& image, BcFormat format, BcQuality quality, std::vector<uint8_t>& blocks,
+	utils::ThreadPool* thread_pool
+) -> Stats
+{
+	const uint32_t blocks_x = (image.width + 3) / 4;
+	const uint32_t blocks_y = (image.height + 3) / 4;
+	const uint32_t block_bytes = GetBlockBytes(format);
+	blocks.resize(size_t(blocks_x) * blocks_y * block_bytes);
+
+	const auto encode_rows = [&](size_t begin, size_t end) {
+		double error = 0.0;
+		Block pixels{};
+		for (size_t by = begin; by < end; by++) {
+			for (uint32_t bx = 0; bx < blocks_x; bx++) {
+				for (uint32_t y = 0; y < 4; y++) {
+					const auto sy = std::min(uint32_t(by) * 4 + y, image.height - 1);
+					for (uint32_t x = 0; x < 4; x++) {
+						const auto sx = std::min(bx * 4 + x, image.width - 1);
+						std::memcpy(
+							pixels.data() + (y * 4 + x) * 4,
+							image.pixels.data() + (size_t(sy) * image.width + sx) * 4, 4
+						);
+					}
+				}
+				auto* block = blocks.data() + (by * blocks_x + bx) * block_bytes;
+				error += EncodeBlock(pixels, format, quality, block);
+			}
+		}
+		return error;
+	};
+
+	Stats stats;
+	stats.blocks = uint64_t(blocks_x) * blocks_y;
+	stats.samples = stats.blocks * BLOCK_PIXELS * GetChannelCount(format);
+
+	if (thread_pool == nullptr || blocks_y < 2 * MIN_ROWS_PER_TASK) {
+		stats.squared_error = encode_rows(0, blocks_y);
+		return stats;
+	}
+
+	const auto chunk_count = std::min(
+		thread_pool->GetThreadCount() * 4, size_t(blocks_y / MIN_ROWS_PER_TASK)
+	);
+	std::vector<double> errors(chunk_count, 0.0);
+	thread_pool->ParallelFor(
+		blocks_y, chunk_count,
+		[&](size_t begin, size_t end, size_t chunk) { errors[chunk] = encode_rows(begin, end); }
+	);
+	stats.squared_error = std::accumulate(errors.begin(), errors.end(), 0.0);
+	return stats;
+}
+
+
+auto BcEncoder::EncodeBlock(
+	const std::array<uint8_t, 64>& pixels, BcFormat format, BcQuality quality, uint8_t* block
+) -> double
+{
+	switch (format)
+	{
+		case BcFormat::BC1:
+			return double(EncodeBc1Color(pixels, quality, false, block));
+		case BcFormat::BC3:
+			return double(
+				EncodeBc4Channel(pixels, 3, quality, block)
+				+ EncodeBc1Color(pixels, quality, true, block + 8)
+			);
+		case BcFormat::BC5:
+			return double(
+				EncodeBc4Channel(pixels, 0, quality, block)
+				+ EncodeBc4Channel(pixels, 1, quality, block + 8)
+			);
+		case BcFormat::BC7:
+			return double(EncodeBc7(pixels, quality, block));
+		default:
+			return 0.0;
+	}
+}
+
+} // namespace io
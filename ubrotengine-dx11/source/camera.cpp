@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: camera.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/camera.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+auto Equal(const math::Float3& a, const math::Float3& b) -> bool
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+/**
+ * Mirrors a position at the plane y = height, a direction is mirrored with a height of zero.
+ */
+auto MirrorY(const math::Float3& value, float height) -> math::Float3
+{
+	const float H_MUL = 2.0F;
+	return { value.x, height * H_MUL - value.y, value.z };
+}
+
+} // namespace
+
+
+Camera::Camera() :
+	m_view_matrix(math::Identity()),
+	m_projection_matrix(math::Identity()),
+	m_view_projection_matrix(math::Identity()),
+	m_view_matrix_transposed(math::Identity()),
+	m_view_projection_matrix_transposed(math::Identity()),
+	m_inverse_view_matrix(math::Identity()),
+	m_inverse_view_projection_matrix(math::Identity())
+{
+}
+
+
+void Camera::SetView(const math::Float3& position, const math::Float3& direction)
+{
+	if (Equal(position, m_position) && Equal(direction, m_direction)) {
+		return;
+	}
+	m_position = position;
+	m_direction = direction;
+	m_dirty = true;
+}
+
+
+void Camera::SetProjection(const math::Float4x4& projection)
+{
+	if (std::memcmp(&projection, &m_projection_matrix, sizeof(math::Float4x4)) == 0) {
+		return;
+	}
+	m_projection_matrix = projection;
+	m_dirty = true;
+}
+
+
+void Camera::SetReflection(const Camera& camera, float height)
+{
+	SetView(MirrorY(camera.m_position, height), MirrorY(camera.m_direction, 0.0F));
+	SetProjection(camera.m_projection_matrix);
+}
+
+
+auto Camera::Update() -> bool
+{
+	m_changed = m_dirty;
+	if (m_dirty) {
+		Recompute();
+		m_dirty = false;
+		m_version++;
+	}
+	return m_changed;
+}
+
+
+auto Camera::HasChanged() const -> bool
+{
+	return m_changed;
+}
+
+
+auto Camera::GetVersion() const -> uint64_t
+{
+	return m_version;
+}
+
+
+auto Camera::GetPosition() const -> const math::Float3&
+{
+	return m_position;
+}
+
+
+auto Camera::GetDirection() const -> const math::Float3&
+{
+	return m_direction;
+}
+
+
+auto Camera::GetViewMatrix() const -> const math::Float4x4&
+{
+	return m_view_matrix;
+}
+
+
+auto Camera::GetProjectionMatrix() const -> const math::Float4x4&
+{
+	return m_projection_matrix;
+}
+
+
+auto Camera::GetViewProjectionMatrix() const -> const math::Float4x4&
+{
+	return m_view_projection_matrix;
+}
+
+
+auto Camera::GetViewMatrixTransposed() const -> const math::Float4x4&
+{
+	return m_view_matrix_transposed;
+}
+
+
+auto Camera::GetViewProjectionMatrixTransposed() const -> const math::Float4x4&
+{
+	return m_view_projection_matrix_transposed;
+}
+
+
+auto Camera::GetInverseViewMatrix() const -> const math::Float4x4&
+{
+	return m_inverse_view_matrix;
+}
+
+
+auto Camera::GetInverseViewProjectionMatrix() const -> const math::Float4x4&
+{
+	return m_inverse_view_projection_matrix;
+}
+
+
+auto Camera::GetFrustumPlanes() const -> const Planes&
+{
+	return m_planes;
+}
+
+
+auto Camera::IsSphereVisible(const math::Float3& center, float radius) const -> bool
+{
+	for (const auto& plane : m_planes) {
+		const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z
+			+ plane.w;
+		if (distance < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+auto Camera::ComputeReflectionMatrix(float height) const -> math::Float4x4
+{
+	// The position is mirrored at the height of the reflecting object and the camera looks
+	// up as much as it looked down before
+	return ComputeViewMatrix(MirrorY(m_position, height), MirrorY(m_direction, 0.0F));
+}
+
+
+auto Camera::ComputeViewMatrix(
+	const math::Float3& position, const math::Float3& direction
+) -> math::Float4x4
+{
+	// The up vector must not be parallel to the direction
+	constexpr float VERTICAL = 0.999F;
+	const float length = std::sqrt(
+		direction.x * direction.x + direction.y * direction.y + direction.z * direction.z
+	);
+	const bool vertical = std::abs(direction.y) > VERTICAL * length;
+	const math::Float3 up(0.0F, vertical ? 0.0F : 1.0F, vertical ? 1.0F : 0.0F);
+	return math::LookToLH(position, direction, up);
+}
+
+
+void Camera::Recompute()
+{
+	m_view_matrix = ComputeViewMatrix(m_position, m_direction);
+	m_view_projection_matrix = math::Multiply(m_view_matrix, m_projection_matrix);
+	m_view_matrix_transposed = math::Transpose(m_view_matrix);
+	m_view_projection_matrix_transposed = math::Transpose(m_view_projection_matrix);
+	m_inverse_view_matrix = math::Inverse(m_view_matrix);
+	m_inverse_view_projection_matrix = math::Inverse(m_view_projection_matrix);
+
+	// A clip space point is inside if -w <= x <= w, -w <= y <= w and 0 <= z <= w, each
+	// coordinate is the dot product with a column of the view projection
+	std::array<math::Float4, 4> columns;
+	for (size_t i = 0; i < columns.size(); i++) {
+		columns[i] = math::Column(m_view_projection_matrix, i);
+	}
+	const Planes planes = {
+		columns[3] + columns[0],
+		columns[3] - columns[0],
+		columns[3] + columns[1],
+		columns[3] - columns[1],
+		columns[2],
+		columns[3] - columns[2],
+	};
+	for (size_t i = 0; i < planes.size(); i++) {
+		m_planes[i] = math::PlaneNormalize(planes[i]);
+	}
+}
+
+} // namespace graphics
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: command_buffer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/command_buffer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cassert>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+void CommandBuffer::Clear()
+{
+	m_data.clear();
+	m_records.clear();
+}
+
+
+void CommandBuffer::BeginRecord(uint64_t sort_key)
+{
+	m_records.push_back({ sort_key, uint32_t(m_data.size()), 0 });
+}
+
+
+void CommandBuffer::EndRecord()
+{
+	assert(!m_records.empty() && "EndRecord without BeginRecord");
+	auto& record = m_records.back();
+	record.size = uint32_t(m_data.size()) - record.offset;
+}
+
+
+void CommandBuffer::SetProgram(uint32_t program_idx)
+{
+	Write(CommandOp::SetProgram);
+	Write(program_idx);
+}
+
+
+void CommandBuffer::SetModel(uint32_t model_idx)
+{
+	Write(CommandOp::SetModel);
+	Write(model_idx);
+}
+
+
+void CommandBuffer::SetWorldMatrix(const math::Float4x4& world)
+{
+	Write(CommandOp::SetWorldMatrix);
+	Write(world);
+}
+
+
+void CommandBuffer::SetTexture(uint32_t texture_idx)
+{
+	Write(CommandOp::SetTexture);
+	Write(texture_idx);
+}
+
+
+void CommandBuffer::DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex)
+{
+	Write(CommandOp::DrawIndexed);
+	Write(index_count);
+	Write(start_index);
+	Write(base_vertex);
+}
+
+
+void CommandBuffer::SetView(uint32_t view_idx)
+{
+	Write(CommandOp::SetView);
+	Write(view_idx);
+}
+
+
+void CommandBuffer::ClearView(uint32_t view_idx)
+{
+	Write(CommandOp::ClearView);
+	Write(view_idx);
+}
+
+
+auto CommandBuffer::GetRecords() const -> const std::vector<Record>&
+{
+	return m_records;
+}
+
+
+auto CommandBuffer::GetByteSize() const -> size_t
+{
+	return m_data.size();
+}
+
+
+void CommandBuffer::Merge(
+	const std::vector<CommandBuffer>& buffers, std::vector<RecordRef>& merged
+)
+{
+	merged.clear();
+
+	size_t total{ 0 };
+	for (const auto& buffer : buffers) {
+		total += buffer.m_records.size();
+	}
+	merged.reserve(total);
+
+	// k-way merge, the number of buffers equals the number of threads and is small, so a
+	// linear search for the smallest head is cheaper than maintaining a heap.
+	std::vector<uint32_t> heads(buffers.size(), 0);
+	while (merged.size() < total) {
+		uint32_t best = 0;
+		uint64_t best_key = UINT64_MAX;
+		bool found = false;
+		for (uint32_t b = 0; b < buffers.size(); b++) {
+			const auto& records = buffers[b].m_records;
+			if (heads[b] < records.size() && (!found || records[heads[b]].sort_key < best_key)) {
+				best = b;
+				best_key = records[heads[b]].sort_key;
+				found = true;
+			}
+		}
+		merged.push_back({ best, heads[best]++ });
+	}
+}
+
+} // namespace graphics
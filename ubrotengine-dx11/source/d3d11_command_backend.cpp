@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11_command_backend.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/d3d11_command_backend.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+D3D11CommandBackend::D3D11CommandBackend(
+	const D3D11RenderDevice& device,
+	ID3D11DeviceContext* device_context,
+	ShaderManager& shader_manager,
+	assets::AssetManager& asset_manager,
+	const std::vector<RenderView>& views
+) :
+	m_device{ device },
+	m_device_context{ device_context },
+	m_shader_manager{ shader_manager },
+	m_asset_manager{ asset_manager },
+	m_views{ views }
+{
+	// All models are triangle lists, so the topology only has to be set once
+	m_device_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+
+void D3D11CommandBackend::SetProgram(uint32_t program_idx)
+{
+	auto* program = &m_shader_manager.GetShaderProgram(program_idx);
+	if (program != m_program) {
+		m_program = program;
+		// Every program has its own texture buffer which has to be filled again
+		m_texture_idx = UINT32_MAX;
+	}
+}
+
+
+void D3D11CommandBackend::SetModel(uint32_t model_idx)
+{
+	if (model_idx == m_model_idx) {
+		return;
+	}
+	m_model_idx = model_idx;
+	m_model = &m_asset_manager.GetModel(model_idx);
+	m_model_switches++;
+
+	// Models with the same vertex stride share one vertex buffer
+	auto* vertex_buffer = m_device.GetBuffer(
+		m_asset_manager.GetVertexBuffer(m_model->vertexStride)
+	);
+	if (vertex_buffer != m_vertex_buffer) {
+		unsigned int stride = m_model->vertexStride;
+		unsigned int offset = 0;
+		m_device_context->IASetVertexBuffers(0, 1, &vertex_buffer, &stride, &offset);
+		m_vertex_buffer = vertex_buffer;
+		m_buffer_binds++;
+	}
+
+	// All models share the index buffer
+	auto* index_buffer = m_device.GetBuffer(m_asset_manager.GetIndexBuffer());
+	if (index_buffer != m_index_buffer) {
+		m_device_context->IASetIndexBuffer(index_buffer, DXGI_FORMAT_R32_UINT, 0);
+		m_index_buffer = index_buffer;
+		m_buffer_binds++;
+	}
+}
+
+
+void D3D11CommandBackend::SetWorldMatrix(const math::Float4x4& world)
+{
+	m_world_matrix = world;
+}
+
+
+void D3D11CommandBackend::SetTexture(uint32_t texture_idx)
+{
+	if (texture_idx == m_texture_idx || m_program == nullptr || FAILED(m_result)) {
+		return;
+	}
+	m_texture_idx = texture_idx;
+	m_texture_switches++;
+
+	const auto& location = m_asset_manager.GetTextureLocation(texture_idx);
+	if (location.array_idx == assets::TextureLocation::NONE) {
+		return;
+	}
+
+	// Textures in the same array only differ in slice and UV transform
+	if (location.array_idx != m_texture_array) {
+		auto* srv = m_device.GetShaderResourceView(
+			m_asset_manager.GetTextureArray(location.array_idx)
+		);
+		m_device_context->PSSetShaderResources(0, 1, &srv);
+		m_texture_array = location.array_idx;
+		m_texture_binds++;
+	}
+
+	auto* texture_buffer = m_device.GetBuffer(m_program->GetTextureBuffer());
+	D3D11_MAPPED_SUBRESOURCE mapped_resource;
+	m_result = m_device_context->Map(
+		texture_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource
+	);
+	if (FAILED(m_result)) {
+		return;
+	}
+
+	auto* data = static_cast<ShaderProgram::TextureBufferType*>(mapped_resource.pData);
+	data->uv_transform = location.uv_transform;
+	data->slice = location.slice;
+
+	m_device_context->Unmap(texture_buffer, 0);
+
+	// The vertex shader remaps the UVs, the pixel shader selects the slice
+	constexpr unsigned int buffer_number = 1;
+	m_device_context->VSSetConstantBuffers(buffer_number, 1, &texture_buffer);
+	m_device_context->PSSetConstantBuffers(buffer_number, 1, &texture_buffer);
+}
+
+
+void D3D11CommandBackend::DrawIndexed(
+	uint32_t index_count, uint32_t start_index, int32_t base_vertex
+)
+{
+	if (m_program == nullptr || FAILED(m_result)) {
+		return;
+	}
+
+	auto* matrix_buffer = m_device.GetBuffer(m_program->GetMatrixBuffer());
+	D3D11_MAPPED_SUBRESOURCE mapped_resource;
+	m_result = m_device_context->Map(
+		matrix_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource
+	);
+	if (FAILED(m_result)) {
+		return;
+	}
+
+	// Matrices must be transposed (because DirectX 11)
+	auto* data = static_cast<ShaderProgram::MatrixBufferType*>(mapped_resource.pData);
+	data->world = math::Transpose(m_world_matrix);
+	data->view = math::Transpose(m_view_matrix);
+	data->projection = math::Transpose(m_projection_matrix);
+
+	m_device_context->Unmap(matrix_buffer, 0);
+	m_device_context->VSSetConstantBuffers(0, 1, &matrix_buffer);
+
+	BindProgram();
+	m_device_context->DrawIndexed(index_count, start_index, base_vertex);
+}
+
+
+void D3D11CommandBackend::SetView(uint32_t view_idx)
+{
+	if (view_idx == m_view_idx || view_idx >= m_views.size()) {
+		return;
+	}
+	// The targets that are bound before the first view are unknown
+	const bool first_view = m_view_idx == UINT32_MAX;
+	m_view_idx = view_idx;
+
+	const auto& view = m_views[view_idx];
+	auto* render_target = m_device.GetRenderTargetView(view.target);
+	auto* depth_stencil = m_device.GetDepthStencilView(view.target, view.depth_slice);
+	if (first_view || render_target != m_render_target || depth_stencil != m_depth_stencil) {
+		m_device_context->OMSetRenderTargets(1, &render_target, depth_stencil);
+		m_render_target = render_target;
+		m_depth_stencil = depth_stencil;
+	}
+	// Viewport has the layout of D3D11_VIEWPORT
+	m_device_context->RSSetViewports(
+		1, reinterpret_cast<const D3D11_VIEWPORT*>(&view.viewport)
+	);
+	m_view_matrix = view.camera->GetViewMatrix();
+	m_projection_matrix = view.camera->GetProjectionMatrix();
+}
+
+
+void D3D11CommandBackend::ClearView(uint32_t view_idx)
+{
+	if (view_idx >= m_views.size()) {
+		return;
+	}
+	const auto& view = m_views[view_idx];
+	auto* render_target = m_device.GetRenderTargetView(view.target);
+	if (render_target != nullptr) {
+		m_device_context->ClearRenderTargetView(render_target, view.clear_color.data());
+	}
+	auto* depth_stencil = m_device.GetDepthStencilView(view.target, view.depth_slice);
+	if (depth_stencil != nullptr) {
+		m_device_context->ClearDepthStencilView(depth_stencil, D3D11_CLEAR_DEPTH, 1.0F, 0);
+	}
+}
+
+
+void D3D11CommandBackend::BindProgram()
+{
+	const auto& registry = m_shader_manager.GetShaderRegistry();
+	auto& state = m_bind_state;
+
+	// Equal objects have equal handles, so only stages that really change are bound
+	const auto layout = m_program->GetLayout();
+	if (layout != ShaderRegistry::NO_HANDLE) {
+		state.unfiltered_binds++;
+		if (layout != state.layout) {
+			m_device.BindShader(m_device_context, registry.GetDeviceHandle(layout));
+			state.layout = layout;
+			state.binds++;
+		}
+	}
+
+	const auto& shaders = m_program->GetShaders();
+	for (size_t stage = 0; stage < shaders.size(); stage++) {
+		const auto handle = shaders[stage];
+		if (handle == ShaderRegistry::NO_HANDLE) {
+			// A stage of the previous program that this one does not use
+			if (state.shaders[stage] != ShaderRegistry::NO_HANDLE) {
+				m_device.UnbindShader(
+					m_device_context, registry.GetDeviceHandle(state.shaders[stage])
+				);
+				state.shaders[stage] = ShaderRegistry::NO_HANDLE;
+				state.binds++;
+			}
+			continue;
+		}
+		state.unfiltered_binds++;
+		if (handle != state.shaders[stage]) {
+			m_device.BindShader(m_device_context, registry.GetDeviceHandle(handle));
+			state.shaders[stage] = handle;
+			state.binds++;
+		}
+	}
+}
+
+
+auto D3D11CommandBackend::GetResult() const -> HRESULT
+{
+	return m_result;
+}
+
+
+auto D3D11CommandBackend::GetBufferBinds() const -> size_t
+{
+	return m_buffer_binds;
+}
+
+
+auto D3D11CommandBackend::GetBufferBindsPerModel() const -> size_t
+{
+	return m_model_switches * 2;
+}
+
+
+auto D3D11CommandBackend::GetTextureBinds() const -> size_t
+{
+	return m_texture_binds;
+}
+
+
+auto D3D11CommandBackend::GetTextureBindsPerTexture() const -> size_t
+{
+	return m_texture_switches;
+}
+
+
+auto D3D11CommandBackend::GetShaderBinds() const -> size_t
+{
+	return m_bind_state.binds;
+}
+
+
+auto D3D11CommandBackend::GetShaderBindsPerDraw() const -> size_t
+{
+	return m_bind_state.unfiltered_binds;
+}
+
+} // namespace graphics
@@ -0,0 +1,621 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: d3d11_render_device.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/d3d11_render_device.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <array>
+#include <cstddef>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+// The neutral descriptions are handed to Direct3D with a cast
+static_assert(sizeof(SubresourceData) == sizeof(D3D11_SUBRESOURCE_DATA));
+static_assert(
+	offsetof(SubresourceData, row_pitch) == offsetof(D3D11_SUBRESOURCE_DATA, SysMemPitch)
+);
+static_assert(sizeof(Viewport) == sizeof(D3D11_VIEWPORT));
+static_assert(VertexElement::APPEND_ALIGNED == D3D11_APPEND_ALIGNED_ELEMENT);
+
+constexpr std::array<UINT, size_t(BufferUsage::NUMBER)> BIND_FLAGS = {
+	D3D11_BIND_VERTEX_BUFFER, D3D11_BIND_INDEX_BUFFER, D3D11_BIND_CONSTANT_BUFFER
+};
+
+auto MakeBox(uint32_t offset, uint32_t size) -> D3D11_BOX
+{
+	D3D11_BOX box{};
+	box.left = offset;
+	box.right = offset + size;
+	box.top = 0;
+	box.bottom = 1;
+	box.front = 0;
+	box.back = 1;
+	return box;
+}
+
+} // namespace
+
+
+auto D3D11RenderDevice::Initialize(const HWND& hwnd, const GraphicSettings& settings)
+	-> HRESULT
+{
+	m_direct3d = std::make_unique<Direct3D>();
+	const auto result = m_direct3d->Initialize(hwnd, settings);
+	if (FAILED(result)) {
+		return result;
+	}
+	UpdateBackBuffer();
+	return result;
+}
+
+
+void D3D11RenderDevice::Shutdown()
+{
+	m_command_lists.clear();
+	m_deferred_contexts.clear();
+	m_direct3d->Shutdown();
+}
+
+
+auto D3D11RenderDevice::Refresh(const GraphicSettings& settings) -> HRESULT
+{
+	// The swap chain can only be resized once no view of its back buffer is left
+	auto& back_buffer = m_resources[m_back_buffer];
+	back_buffer.render_target_view.Reset();
+	back_buffer.depth_stencil_views.clear();
+
+	const auto result = m_direct3d->Refresh(settings);
+	UpdateBackBuffer();
+	return result;
+}
+
+
+void D3D11RenderDevice::Present()
+{
+	m_direct3d->EndScene();
+}
+
+
+auto D3D11RenderDevice::CreateBuffer(BufferUsage usage, uint32_t size, Handle& handle) -> HRESULT
+{
+	// Constant buffers are written by the CPU before every draw
+	const bool dynamic = usage == BufferUsage::Constant;
+
+	D3D11_BUFFER_DESC buffer_desc;
+	buffer_desc.Usage = dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+	buffer_desc.ByteWidth = size;
+	buffer_desc.BindFlags = BIND_FLAGS[size_t(usage)];
+	buffer_desc.CPUAccessFlags = dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+	buffer_desc.MiscFlags = 0;
+	buffer_desc.StructureByteStride = 0;
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer{ nullptr };
+	auto result = m_direct3d->GetDevice()->CreateBuffer(
+		&buffer_desc, nullptr, buffer.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	Resource resource;
+	resource.kind = Kind::Buffer;
+	resource.object = buffer;
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+void D3D11RenderDevice::UpdateBuffer(
+	Handle buffer, uint32_t offset, const void* data, uint32_t size
+)
+{
+	// Only the range is written, the rest of the buffer stays untouched
+	const auto box = MakeBox(offset, size);
+	m_direct3d->GetDeviceContext()->UpdateSubresource(GetBuffer(buffer), 0, &box, data, 0, 0);
+}
+
+
+void D3D11RenderDevice::CopyBuffer(
+	Handle dst, uint32_t dst_offset, Handle src, uint32_t src_offset, uint32_t size
+)
+{
+	const auto box = MakeBox(src_offset, size);
+	m_direct3d->GetDeviceContext()->CopySubresourceRegion(
+		GetBuffer(dst), 0, dst_offset, 0, 0, GetBuffer(src), 0, &box
+	);
+}
+
+
+auto D3D11RenderDevice::CreateTexture(
+	const TextureDesc& desc, const std::vector<SubresourceData>& subresources,
+	bool as_array, Handle& handle
+) -> HRESULT
+{
+	if (subresources.size() != size_t(desc.mip_count) * desc.array_size) {
+		return E_INVALIDARG;
+	}
+
+	D3D11_TEXTURE2D_DESC texture_desc;
+	texture_desc.Width = desc.width;
+	texture_desc.Height = desc.height;
+	texture_desc.MipLevels = desc.mip_count;
+	texture_desc.ArraySize = desc.array_size;
+	texture_desc.Format = DXGI_FORMAT(desc.format);
+	texture_desc.SampleDesc.Count = 1;
+	texture_desc.SampleDesc.Quality = 0;
+	texture_desc.Usage = D3D11_USAGE_IMMUTABLE;
+	texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	texture_desc.CPUAccessFlags = 0;
+	texture_desc.MiscFlags = desc.cubemap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+	auto* device = m_direct3d->GetDevice();
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture{ nullptr };
+	auto result = device->CreateTexture2D(
+		&texture_desc, reinterpret_cast<const D3D11_SUBRESOURCE_DATA*>(subresources.data()),
+		texture.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc{};
+	srv_desc.Format = DXGI_FORMAT(desc.format);
+	if (desc.cubemap && desc.array_size > 6) {
+		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+		srv_desc.TextureCubeArray.MostDetailedMip = 0;
+		srv_desc.TextureCubeArray.MipLevels = desc.mip_count;
+		srv_desc.TextureCubeArray.First2DArrayFace = 0;
+		srv_desc.TextureCubeArray.NumCubes = desc.array_size / 6;
+	}
+	else if (desc.cubemap) {
+		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		srv_desc.TextureCube.MostDetailedMip = 0;
+		srv_desc.TextureCube.MipLevels = desc.mip_count;
+	}
+	else if (desc.array_size > 1 || as_array) {
+		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		srv_desc.Texture2DArray.MostDetailedMip = 0;
+		srv_desc.Texture2DArray.MipLevels = desc.mip_count;
+		srv_desc.Texture2DArray.FirstArraySlice = 0;
+		srv_desc.Texture2DArray.ArraySize = desc.array_size;
+	}
+	else {
+		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srv_desc.Texture2D.MostDetailedMip = 0;
+		srv_desc.Texture2D.MipLevels = desc.mip_count;
+	}
+
+	Resource resource;
+	resource.kind = Kind::Texture;
+	result = device->CreateShaderResourceView(
+		texture.Get(), &srv_desc, resource.shader_resource_view.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+auto D3D11RenderDevice::CreateRenderTarget(uint32_t width, uint32_t height, Handle& handle)
+	-> HRESULT
+{
+	auto* device = m_direct3d->GetDevice();
+	Resource resource;
+	resource.kind = Kind::RenderTarget;
+
+	// Same color format as the back buffer, so the passes can share shader programs
+	D3D11_TEXTURE2D_DESC color_desc{};
+	color_desc.Width = width;
+	color_desc.Height = height;
+	color_desc.MipLevels = 1;
+	color_desc.ArraySize = 1;
+	color_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	color_desc.SampleDesc.Count = 1;
+	color_desc.Usage = D3D11_USAGE_DEFAULT;
+	color_desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> color{ nullptr };
+	auto result = device->CreateTexture2D(&color_desc, nullptr, color.GetAddressOf());
+	if (FAILED(result)) {
+		return result;
+	}
+	result = device->CreateRenderTargetView(
+		color.Get(), nullptr, resource.render_target_view.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+	result = device->CreateShaderResourceView(
+		color.Get(), nullptr, resource.shader_resource_view.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	auto depth_desc = color_desc;
+	depth_desc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	depth_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> depth{ nullptr };
+	result = device->CreateTexture2D(&depth_desc, nullptr, depth.GetAddressOf());
+	if (FAILED(result)) {
+		return result;
+	}
+	resource.depth_stencil_views.resize(1);
+	result = device->CreateDepthStencilView(
+		depth.Get(), nullptr, resource.depth_stencil_views[0].GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+auto D3D11RenderDevice::CreateDepthArray(uint32_t size, uint32_t slices, Handle& handle)
+	-> HRESULT
+{
+	auto* device = m_direct3d->GetDevice();
+	Resource resource;
+	resource.kind = Kind::DepthArray;
+
+	// Typeless, so the same memory can be written as depth and read as a color channel
+	D3D11_TEXTURE2D_DESC texture_desc{};
+	texture_desc.Width = size;
+	texture_desc.Height = size;
+	texture_desc.MipLevels = 1;
+	texture_desc.ArraySize = slices;
+	texture_desc.Format = DXGI_FORMAT_R24G8_TYPELESS;
+	texture_desc.SampleDesc.Count = 1;
+	texture_desc.Usage = D3D11_USAGE_DEFAULT;
+	texture_desc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> texture{ nullptr };
+	auto result = device->CreateTexture2D(&texture_desc, nullptr, texture.GetAddressOf());
+	if (FAILED(result)) {
+		return result;
+	}
+
+	resource.depth_stencil_views.resize(slices);
+	for (uint32_t slice = 0; slice < slices; slice++) {
+		D3D11_DEPTH_STENCIL_VIEW_DESC view_desc{};
+		view_desc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+		view_desc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		view_desc.Texture2DArray.FirstArraySlice = slice;
+		view_desc.Texture2DArray.ArraySize = 1;
+		result = device->CreateDepthStencilView(
+			texture.Get(), &view_desc, resource.depth_stencil_views[slice].GetAddressOf()
+		);
+		if (FAILED(result)) {
+			return result;
+		}
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC resource_desc{};
+	resource_desc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+	resource_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	resource_desc.Texture2DArray.MipLevels = 1;
+	resource_desc.Texture2DArray.ArraySize = slices;
+	result = device->CreateShaderResourceView(
+		texture.Get(), &resource_desc, resource.shader_resource_view.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+auto D3D11RenderDevice::CreateShader(
+	ShaderStage stage, const std::vector<uint8_t>& bytecode, Handle& handle
+) -> HRESULT
+{
+	auto* device = m_direct3d->GetDevice();
+	Resource resource;
+	auto result{ S_OK };
+	switch (stage)
+	{
+		case ShaderStage::Vertex: {
+			Microsoft::WRL::ComPtr<ID3D11VertexShader> shader;
+			result = device->CreateVertexShader(
+				bytecode.data(), bytecode.size(), nullptr, shader.GetAddressOf()
+			);
+			resource.kind = Kind::VertexShader;
+			resource.object = shader;
+			break;
+		}
+		case ShaderStage::Pixel: {
+			Microsoft::WRL::ComPtr<ID3D11PixelShader> shader;
+			result = device->CreatePixelShader(
+				bytecode.data(), bytecode.size(), nullptr, shader.GetAddressOf()
+			);
+			resource.kind = Kind::PixelShader;
+			resource.object = shader;
+			break;
+		}
+		default:
+			return E_INVALIDARG;
+	}
+	if (FAILED(result)) {
+		return result;
+	}
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+auto D3D11RenderDevice::CreateInputLayout(
+	const std::vector<VertexElement>& elements, const std::vector<uint8_t>& bytecode,
+	Handle& handle
+) -> HRESULT
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> descs(elements.size());
+	for (size_t i = 0; i < elements.size(); i++) {
+		auto& desc = descs[i];
+		desc.SemanticName = elements[i].semantic;
+		desc.SemanticIndex = elements[i].semantic_index;
+		desc.Format = DXGI_FORMAT(elements[i].format);
+		desc.InputSlot = 0;
+		desc.AlignedByteOffset = elements[i].offset;
+		desc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+		desc.InstanceDataStepRate = 0;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> layout;
+	auto result = m_direct3d->GetDevice()->CreateInputLayout(
+		descs.data(), UINT(descs.size()), bytecode.data(), bytecode.size(),
+		layout.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	Resource resource;
+	resource.kind = Kind::InputLayout;
+	resource.object = layout;
+	handle = Store(std::move(resource));
+	return result;
+}
+
+
+void D3D11RenderDevice::Release(Handle handle)
+{
+	if (handle >= m_resources.size() || m_resources[handle].kind == Kind::Free
+		|| handle == m_back_buffer) {
+		return;
+	}
+	m_resources[handle] = Resource();
+	m_free_handles.push_back(handle);
+}
+
+
+auto D3D11RenderDevice::GetBackBuffer() const -> Handle
+{
+	return m_back_buffer;
+}
+
+
+auto D3D11RenderDevice::UsesBytecode() const -> bool
+{
+	return true;
+}
+
+
+auto D3D11RenderDevice::GetVideoMemory() const -> size_t
+{
+	return m_direct3d->GetVideoCardMemory();
+}
+
+
+auto D3D11RenderDevice::GetSupportedResolutions() const
+	-> const std::vector<std::tuple<uint16_t, uint16_t>>&
+{
+	return m_direct3d->GetSupportedResolutions();
+}
+
+
+auto D3D11RenderDevice::GetDevice() const -> ID3D11Device*
+{
+	return m_direct3d->GetDevice();
+}
+
+
+auto D3D11RenderDevice::GetDeviceContext() const -> ID3D11DeviceContext*
+{
+	return m_direct3d->GetDeviceContext();
+}
+
+
+auto D3D11RenderDevice::GetBuffer(Handle handle) const -> ID3D11Buffer*
+{
+	if (handle >= m_resources.size() || m_resources[handle].kind != Kind::Buffer) {
+		return nullptr;
+	}
+	return static_cast<ID3D11Buffer*>(m_resources[handle].object.Get());
+}
+
+
+auto D3D11RenderDevice::GetShaderResourceView(Handle handle) const
+	-> ID3D11ShaderResourceView*
+{
+	if (handle >= m_resources.size()) {
+		return nullptr;
+	}
+	return m_resources[handle].shader_resource_view.Get();
+}
+
+
+auto D3D11RenderDevice::GetRenderTargetView(Handle handle) const -> ID3D11RenderTargetView*
+{
+	if (handle >= m_resources.size()) {
+		return nullptr;
+	}
+	return m_resources[handle].render_target_view.Get();
+}
+
+
+auto D3D11RenderDevice::GetDepthStencilView(Handle handle, uint32_t slice) const
+	-> ID3D11DepthStencilView*
+{
+	if (handle >= m_resources.size() || slice >= m_resources[handle].depth_stencil_views.size()) {
+		return nullptr;
+	}
+	return m_resources[handle].depth_stencil_views[slice].Get();
+}
+
+
+void D3D11RenderDevice::BindShader(ID3D11DeviceContext* device_context, Handle handle) const
+{
+	auto* object = m_resources[handle].object.Get();
+	switch (m_resources[handle].kind)
+	{
+		case Kind::VertexShader:
+			device_context->VSSetShader(static_cast<ID3D11VertexShader*>(object), nullptr, 0);
+			break;
+		case Kind::PixelShader:
+			device_context->PSSetShader(static_cast<ID3D11PixelShader*>(object), nullptr, 0);
+			break;
+		case Kind::InputLayout:
+			device_context->IASetInputLayout(static_cast<ID3D11InputLayout*>(object));
+			break;
+		default:
+			break;
+	}
+}
+
+
+void D3D11RenderDevice::UnbindShader(ID3D11DeviceContext* device_context, Handle handle) const
+{
+	switch (m_resources[handle].kind)
+	{
+		case Kind::VertexShader:
+			device_context->VSSetShader(nullptr, nullptr, 0);
+			break;
+		case Kind::PixelShader:
+			device_context->PSSetShader(nullptr, nullptr, 0);
+			break;
+		case Kind::InputLayout:
+			device_context->IASetInputLayout(nullptr);
+			break;
+		default:
+			break;
+	}
+}
+
+
+void D3D11RenderDevice::ApplyRenderState(ID3D11DeviceContext* device_context)
+{
+	m_direct3d->ApplyRenderState(device_context);
+}
+
+
+auto D3D11RenderDevice::SupportsCommandLists() const -> bool
+{
+	return m_direct3d->SupportsCommandLists();
+}
+
+
+void D3D11RenderDevice::TurnZBufferOn()
+{
+	m_direct3d->TurnZBufferOn();
+}
+
+
+void D3D11RenderDevice::TurnZBufferOff()
+{
+	m_direct3d->TurnZBufferOff();
+}
+
+
+auto D3D11RenderDevice::CreateDeferredContexts(size_t count) -> HRESULT
+{
+	m_deferred_contexts.resize(count);
+	m_command_lists.resize(count);
+	for (auto& context : m_deferred_contexts) {
+		const auto result = m_direct3d->GetDevice()->CreateDeferredContext(
+			0, context.ReleaseAndGetAddressOf()
+		);
+		if (FAILED(result)) {
+			m_deferred_contexts.clear();
+			m_command_lists.clear();
+			return result;
+		}
+	}
+	return S_OK;
+}
+
+
+auto D3D11RenderDevice::GetDeferredContextCount() const -> size_t
+{
+	return m_deferred_contexts.size();
+}
+
+
+auto D3D11RenderDevice::GetDeferredContext(size_t idx) const -> ID3D11DeviceContext*
+{
+	return m_deferred_contexts[idx].Get();
+}
+
+
+auto D3D11RenderDevice::FinishCommandList(size_t idx) -> HRESULT
+{
+	return m_deferred_contexts[idx]->FinishCommandList(
+		FALSE, m_command_lists[idx].ReleaseAndGetAddressOf()
+	);
+}
+
+
+void D3D11RenderDevice::ExecuteCommandLists()
+{
+	auto* immediate_context = m_direct3d->GetDeviceContext();
+	for (auto& command_list : m_command_lists) {
+		if (command_list != nullptr) {
+			immediate_context->ExecuteCommandList(command_list.Get(), FALSE);
+			command_list.Reset();
+		}
+	}
+}
+
+
+auto D3D11RenderDevice::Store(Resource&& resource) -> Handle
+{
+	if (!m_free_handles.empty()) {
+		const auto handle = m_free_handles.back();
+		m_free_handles.pop_back();
+		m_resources[handle] = std::move(resource);
+		return handle;
+	}
+	m_resources.push_back(std::move(resource));
+	return Handle(m_resources.size() - 1);
+}
+
+
+void D3D11RenderDevice::UpdateBackBuffer()
+{
+	if (m_back_buffer == NO_RESOURCE) {
+		Resource resource;
+		resource.kind = Kind::RenderTarget;
+		m_back_buffer = Store(std::move(resource));
+	}
+	auto& back_buffer = m_resources[m_back_buffer];
+	back_buffer.render_target_view = m_direct3d->GetRenderTargetView();
+	back_buffer.depth_stencil_views = { m_direct3d->GetDepthStencilView() };
+}
+
+} // namespace graphics
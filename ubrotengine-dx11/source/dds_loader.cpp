@@ -0,0 +1,378 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: dds_loader.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/dds_loader.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+using Format = graphics::TextureFormat;
+
+// Layout of the file header, see the DDS programming guide
+struct DdsPixelFormat
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t four_cc;
+	uint32_t rgb_bit_count;
+	uint32_t r_mask;
+	uint32_t g_mask;
+	uint32_t b_mask;
+	uint32_t a_mask;
+};
+
+struct DdsHeader
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitch_or_linear_size;
+	uint32_t depth;
+	uint32_t mip_map_count;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixel_format;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+
+struct DdsHeaderDx10
+{
+	uint32_t dxgi_format;
+	uint32_t resource_dimension;
+	uint32_t misc_flag;
+	uint32_t array_size;
+	uint32_t misc_flags2;
+};
+
+static_assert(sizeof(DdsPixelFormat) == 32, "DDS pixel format has to be 32 bytes");
+static_assert(sizeof(DdsHeader) == 124, "DDS header has to be 124 bytes");
+static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header has to be 20 bytes");
+
+constexpr auto MakeFourCC(char a, char b, char c, char d) -> uint32_t
+{
+	return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8U)
+		| (uint32_t(uint8_t(c)) << 16U) | (uint32_t(uint8_t(d)) << 24U);
+}
+
+constexpr uint32_t DDS_MAGIC = MakeFourCC('D', 'D', 'S', ' ');
+
+constexpr uint32_t DDSD_CAPS = 0x1;
+constexpr uint32_t DDSD_HEIGHT = 0x2;
+constexpr uint32_t DDSD_WIDTH = 0x4;
+constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDPF_RGB = 0x40;
+constexpr uint32_t DDSD_DEPTH = 0x800000;
+constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+constexpr uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+constexpr uint32_t DX10_DIMENSION_TEXTURE2D = 3;
+constexpr uint32_t DX10_MISC_TEXTURECUBE = 0x4;
+
+constexpr uint32_t MAX_MIP_COUNT = 15;
+constexpr uint32_t MAX_ARRAY_SIZE = 2048;
+constexpr uint32_t MAX_DIMENSION = 16384;
+
+/**
+ * Maps the pixel format of a legacy header (without DX10 extension) to a texture format.
+ */
+auto GetLegacyFormat(const DdsPixelFormat& pf) -> Format
+{
+	if ((pf.flags & DDPF_FOURCC) != 0) {
+		switch (pf.four_cc)
+		{
+			case MakeFourCC('D', 'X', 'T', '1'):
+				return Format::BC1_UNORM;
+			case MakeFourCC('D', 'X', 'T', '2'):
+			case MakeFourCC('D', 'X', 'T', '3'):
+				return Format::BC2_UNORM;
+			case MakeFourCC('D', 'X', 'T', '4'):
+			case MakeFourCC('D', 'X', 'T', '5'):
+				return Format::BC3_UNORM;
+			case MakeFourCC('A', 'T', 'I', '1'):
+			case MakeFourCC('B', 'C', '4', 'U'):
+				return Format::BC4_UNORM;
+			case MakeFourCC('B', 'C', '4', 'S'):
+				return Format::BC4_SNORM;
+			case MakeFourCC('A', 'T', 'I', '2'):
+			case MakeFourCC('B', 'C', '5', 'U'):
+				return Format::BC5_UNORM;
+			case MakeFourCC('B', 'C', '5', 'S'):
+				return Format::BC5_SNORM;
+			default:
+				return Format::UNKNOWN;
+		}
+	}
+
+	if ((pf.flags & DDPF_RGB) != 0 && pf.rgb_bit_count == 32) {
+		if (pf.r_mask == 0x000000FF && pf.g_mask == 0x0000FF00 && pf.b_mask == 0x00FF0000) {
+			return Format::R8G8B8A8_UNORM;
+		}
+		if (pf.r_mask == 0x00FF0000 && pf.g_mask == 0x0000FF00 && pf.b_mask == 0x000000FF) {
+			return Format::B8G8R8A8_UNORM;
+		}
+	}
+	return Format::UNKNOWN;
+}
+
+/**
+ * Returns the number of levels of a full mip chain down to 1x1.
+ */
+auto GetMaxMipCount(uint32_t width, uint32_t height) -> uint32_t
+{
+	uint32_t count{ 1 };
+	for (auto extent = std::max(width, height); extent > 1; extent /= 2) {
+		count++;
+	}
+	return count;
+}
+
+} // namespace
+
+
+auto DdsLoader::Parse(
+	const uint8_t* data, size_t size, DdsInfo& info,
+	std::vector<graphics::SubresourceData>& subresources
+) -> bool
+{
+	subresources.clear();
+
+	if (data == nullptr || size < sizeof(uint32_t) + sizeof(DdsHeader)) {
+		return false;
+	}
+
+	uint32_t magic{ 0 };
+	std::memcpy(&magic, data, sizeof(magic));
+	DdsHeader header{};
+	std::memcpy(&header, data + sizeof(magic), sizeof(header));
+	if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader)
+		|| header.pixel_format.size != sizeof(DdsPixelFormat)) {
+		return false;
+	}
+
+	size_t offset = sizeof(magic) + sizeof(header);
+
+	// Volume textures are not supported
+	if ((header.flags & DDSD_DEPTH) != 0 || (header.caps2 & DDSCAPS2_VOLUME) != 0) {
+		return false;
+	}
+
+	info.width = header.width;
+	info.height = header.height;
+	// The count is only valid if its flag is set, a file without the flag has one level
+	info.mip_count = (header.flags & DDSD_MIPMAPCOUNT) != 0
+		? std::max(header.mip_map_count, 1U) : 1U;
+	info.array_size = 1;
+	info.cubemap = false;
+
+	if ((header.pixel_format.flags & DDPF_FOURCC) != 0
+		&& header.pixel_format.four_cc == MakeFourCC('D', 'X', '1', '0')) {
+		if (size < offset + sizeof(DdsHeaderDx10)) {
+			return false;
+		}
+		DdsHeaderDx10 header_dx10{};
+		std::memcpy(&header_dx10, data + offset, sizeof(header_dx10));
+		offset += sizeof(header_dx10);
+
+		if (header_dx10.resource_dimension != DX10_DIMENSION_TEXTURE2D) {
+			return false;
+		}
+		info.format = Format(header_dx10.dxgi_format);
+		info.array_size = header_dx10.array_size;
+		if ((header_dx10.misc_flag & DX10_MISC_TEXTURECUBE) != 0) {
+			info.cubemap = true;
+			info.array_size *= 6;
+		}
+	}
+	else {
+		info.format = GetLegacyFormat(header.pixel_format);
+		if ((header.caps2 & DDSCAPS2_CUBEMAP) != 0) {
+			// Partial cubemaps can not be represented in Direct3D 11
+			if ((header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES) {
+				return false;
+			}
+			info.cubemap = true;
+			info.array_size = 6;
+		}
+	}
+
+	if (info.width == 0 || info.height == 0 || info.width > MAX_DIMENSION
+		|| info.height > MAX_DIMENSION || info.mip_count > MAX_MIP_COUNT
+		|| info.mip_count > GetMaxMipCount(info.width, info.height)
+		|| info.array_size == 0 || info.array_size > MAX_ARRAY_SIZE * 6) {
+		return false;
+	}
+
+	// The file stores all mips of the first slice, then all mips of the next slice
+	subresources.reserve(size_t(info.mip_count) * info.array_size);
+	for (uint32_t slice = 0; slice < info.array_size; slice++) {
+		uint32_t width = info.width;
+		uint32_t height = info.height;
+
+		for (uint32_t mip = 0; mip < info.mip_count; mip++) {
+			uint32_t row_pitch{ 0 };
+			uint32_t row_count{ 0 };
+			if (!GetSurfaceInfo(width, height, info.format, row_pitch, row_count)) {
+				subresources.clear();
+				return false;
+			}
+
+			const auto slice_pitch = uint64_t(row_pitch) * row_count;
+			if (offset + slice_pitch > size) {
+				subresources.clear();
+				return false;
+			}
+
+			subresources.push_back({ data + offset, row_pitch, uint32_t(slice_pitch) });
+
+			offset += size_t(slice_pitch);
+			width = std::max(width / 2, 1U);
+			height = std::max(height / 2, 1U);
+		}
+	}
+	return true;
+}
+
+
+auto DdsLoader::GetSurfaceInfo(
+	uint32_t width, uint32_t height, Format format, uint32_t& row_pitch, uint32_t& row_count
+) -> bool
+{
+	const auto block_bytes = GetBlockBytes(format);
+	if (block_bytes > 0) {
+		row_pitch = std::max(1U, (width + 3) / 4) * block_bytes;
+		row_count = std::max(1U, (height + 3) / 4);
+		return true;
+	}
+
+	const auto bits_per_pixel = GetBitsPerPixel(format);
+	if (bits_per_pixel > 0) {
+		row_pitch = (width * bits_per_pixel + 7) / 8;
+		row_count = height;
+		return true;
+	}
+	return false;
+}
+
+
+void DdsLoader::Write(
+	const DdsInfo& info, const uint8_t* data, size_t size, std::vector<uint8_t>& file
+)
+{
+	DdsHeader header{};
+	header.size = sizeof(DdsHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+		| DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = info.height;
+	header.width = info.width;
+	header.mip_map_count = info.mip_count;
+	header.pixel_format.size = sizeof(DdsPixelFormat);
+	header.pixel_format.flags = DDPF_FOURCC;
+	header.pixel_format.four_cc = MakeFourCC('D', 'X', '1', '0');
+	header.caps = DDSCAPS_TEXTURE | (info.mip_count > 1 ? DDSCAPS_MIPMAP | DDSCAPS_COMPLEX : 0);
+
+	uint32_t row_pitch = 0;
+	uint32_t row_count = 0;
+	if (GetSurfaceInfo(info.width, info.height, info.format, row_pitch, row_count)) {
+		header.pitch_or_linear_size = row_pitch * row_count;
+	}
+
+	DdsHeaderDx10 header_dx10{};
+	header_dx10.dxgi_format = uint32_t(info.format);
+	header_dx10.resource_dimension = DX10_DIMENSION_TEXTURE2D;
+	header_dx10.misc_flag = info.cubemap ? DX10_MISC_TEXTURECUBE : 0;
+	header_dx10.array_size = info.cubemap ? info.array_size / 6 : info.array_size;
+
+	file.resize(sizeof(DDS_MAGIC) + sizeof(header) + sizeof(header_dx10) + size);
+	auto* dst = file.data();
+	std::memcpy(dst, &DDS_MAGIC, sizeof(DDS_MAGIC));
+	dst += sizeof(DDS_MAGIC);
+	std::memcpy(dst, &header, sizeof(header));
+	dst += sizeof(header);
+	std::memcpy(dst, &header_dx10, sizeof(header_dx10));
+	dst += sizeof(header_dx10);
+	if (size > 0) {
+		std::memcpy(dst, data, size);
+	}
+}
+
+
+auto DdsLoader::GetBlockBytes(Format format) -> uint32_t
+{
+	switch (format)
+	{
+		case Format::BC1_UNORM:
+		case Format::BC1_UNORM_SRGB:
+		case Format::BC4_UNORM:
+		case Format::BC4_SNORM:
+			return 8;
+		case Format::BC2_UNORM:
+		case Format::BC2_UNORM_SRGB:
+		case Format::BC3_UNORM:
+		case Format::BC3_UNORM_SRGB:
+		case Format::BC5_UNORM:
+		case Format::BC5_SNORM:
+		case Format::BC6H_UF16:
+		case Format::BC6H_SF16:
+		case Format::BC7_UNORM:
+		case Format::BC7_UNORM_SRGB:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+
+auto DdsLoader::GetBitsPerPixel(Format format) -> uint32_t
+{
+	switch (format)
+	{
+		case Format::R32G32B32A32_FLOAT:
+			return 128;
+		case Format::R16G16B16A16_FLOAT:
+		case Format::R16G16B16A16_SNORM:
+			return 64;
+		case Format::R8G8B8A8_UNORM:
+		case Format::R8G8B8A8_UNORM_SRGB:
+		case Format::R8G8B8A8_SNORM:
+		case Format::B8G8R8A8_UNORM:
+		case Format::B8G8R8A8_UNORM_SRGB:
+		case Format::R32_FLOAT:
+			return 32;
+		case Format::R8G8_UNORM:
+			return 16;
+		case Format::R8_UNORM:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+} // namespace io
@@ -49,152 +49,11 @@ auto Direct3D::Initialize(const HWND& hwnd, const GraphicSettings& settings) ->
 
 	m_vsyncEnabled = settings.v_sync;
 
-	///////////////////////////////////
-	// Videocard/Display information //
-	///////////////////////////////////
-	// In the first steps, the refresh rate of the monitor is determined by getting and then
-	// querying the adapter for the refresh rate numerator and denominator corresponding to
-	// the desired window dimensions.
-
-	// Create a factory which can be used to create other DXGI objects
-	Microsoft::WRL::ComPtr<IDXGIFactory> factory{ nullptr };
-	result = CreateDXGIFactory(__uuidof(IDXGIFactory), reinterpret_cast<void**>(factory.GetAddressOf()));
-	if (FAILED(result)) {
-		return result;
-	}
-
-	// Construct an adapter for the graphics card currently in use
-	Microsoft::WRL::ComPtr<IDXGIAdapter> adapter{ nullptr };
-	result = factory->EnumAdapters(0, adapter.GetAddressOf());
-	if (FAILED(result)) {
-		return result;
-	}
-
-	// Determine the primary monitor
-	Microsoft::WRL::ComPtr<IDXGIOutput> adapter_output{ nullptr };
-	result = adapter->EnumOutputs(0, adapter_output.GetAddressOf());
-	if (FAILED(result)) {
-		return result;
-	}
-
-
-	// https://docs.microsoft.com/en-us/windows/win32/api/dxgi1_2/nf-dxgi1_2-idxgioutput1-getdisplaymodelist1
-	// Enumerate all display modes which satisfy the given parameters and
-	// store their number numModes
-	unsigned int numModes = 0;
-	result = adapter_output->GetDisplayModeList(
-		DXGI_FORMAT_R8G8B8A8_UNORM,
-		DXGI_ENUM_MODES_INTERLACED,
-		&numModes,
-		nullptr
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	// Construct an array where all display modes can be stored
-	std::vector<DXGI_MODE_DESC> display_mode_list;
-	display_mode_list.resize(numModes);
-	m_resolutions.reserve(numModes);
-
-	// Same function as above, this time we store the display modes in displayModeList
-	result = adapter_output->GetDisplayModeList(
-		DXGI_FORMAT_R8G8B8A8_UNORM,
-		DXGI_ENUM_MODES_INTERLACED,
-		&numModes,
-		display_mode_list.data()
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	for (auto& mode : display_mode_list)
-	{
-		m_resolutions.emplace_back(uint16_t(mode.Width), uint16_t(mode.Height));
-	}
-
-	// For the first start we search for the closest matching mode, since we can not know
-	// what exactly the logic has chosen as resolution
-	DXGI_MODE_DESC tmp_display_mode_desc{};
-	tmp_display_mode_desc.Width = settings.window_width;
-	tmp_display_mode_desc.Height = settings.window_height;
-	adapter_output->FindClosestMatchingMode(&tmp_display_mode_desc, &m_display_mode_desc, nullptr);
-	
-
-	// Query the graphics card description and store it in adapterDesc
-	DXGI_ADAPTER_DESC adapterDesc;
-	result = adapter->GetDesc(&adapterDesc);
-	if (FAILED(result)) {
-		return result;
-	}
-	
-	// in binary it needs to be 1024
-	// https://www.gamedev.net/forums/topic/681964-how-do-i-detect-the-available-video-memory/
-	constexpr unsigned int B_PER_KB = 1024;
-	constexpr unsigned int KB_PER_MB = 1024;
-	// Store the memory size of the graphics card
-	m_videoCardMemory = adapterDesc.DedicatedVideoMemory / B_PER_KB / KB_PER_MB;
-	// Copy the graphics card description
-	m_videoCardDescription = std::wstring(adapterDesc.Description);
-	
-	// Not in use since the syntaxhighlighting does not work if used
-	// #include <span>
-	// m_videoCardDescription = std::wstring(std::span{ adapterDesc.Description }.data());
-	
-	////////////////////////////////////
-	// Setup swapchain and backbuffer //
-	////////////////////////////////////
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> back_buffer_ptr{ nullptr };
-	// Specify the DirectX version to be used (11)
-	D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-
-	auto swap_chain_desc = CreateSwapChainDesc(
-		hwnd, settings.window_width, settings.window_height
-	);
-	
-
-	UINT creation_flags = 0;
-	// TODO(rwarnking) how to use this
-#if defined(_DEBUG)
-	// If the project is in a debug build, enable the debug layer.
-	creation_flags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-	// Create the swap chain, Direct3D device and Direct3D device context using the swap chain
-	// description. The latter serve as interfaces for all DirectX functions.
-	result = D3D11CreateDeviceAndSwapChain(
-		nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
-		creation_flags, &featureLevel, 1,
-		D3D11_SDK_VERSION, &swap_chain_desc, m_swapChain.GetAddressOf(),
-		m_device.GetAddressOf(), nullptr, m_deviceContext.GetAddressOf()
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	result = m_swapChain->SetFullscreenState(settings.fullscreen, nullptr);
+	result = CreateDeviceAndSwapChain(hwnd, settings);
 	if (FAILED(result)) {
 		return result;
 	}
 
-	// Set the swap chain's backbuffer
-	result = m_swapChain->GetBuffer(
-		0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(back_buffer_ptr.GetAddressOf())
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	// Create the necessary render target view
-	result = m_device->CreateRenderTargetView(
-		back_buffer_ptr.Get(),
-		nullptr,
-		m_renderTargetView.GetAddressOf()
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-	
 
 	///////////////////////////
 	// Depth buffer creation //
@@ -329,15 +188,14 @@ auto Direct3D::Initialize(const HWND& hwnd, const GraphicSettings& settings) ->
 	///////////////////////
 	// Set the viewport which is needed so that Direct3D can map the clip space coordinates
 	// to render target space coordinates.
-	D3D11_VIEWPORT viewport;
-	viewport.Width = float(settings.window_width);
-	viewport.Height = float(settings.window_height);
-	viewport.MinDepth = 0.0F;
-	viewport.MaxDepth = 1.0F;
-	viewport.TopLeftX = 0.0F;
-	viewport.TopLeftY = 0.0F;
+	m_viewport.Width = float(settings.window_width);
+	m_viewport.Height = float(settings.window_height);
+	m_viewport.MinDepth = 0.0F;
+	m_viewport.MaxDepth = 1.0F;
+	m_viewport.TopLeftX = 0.0F;
+	m_viewport.TopLeftY = 0.0F;
 
-	m_deviceContext->RSSetViewports(1, &viewport);
+	m_deviceContext->RSSetViewports(1, &m_viewport);
 
 
 	/////////////////////
@@ -367,65 +225,7 @@ auto Direct3D::Refresh(const GraphicSettings& settings) -> HRESULT
 	m_vsyncEnabled = settings.v_sync;
 	ReleaseBackBuffer();
 
-	///////////////////////////////////
-	// Swapchain + backbuffer update //
-	///////////////////////////////////
-	Microsoft::WRL::ComPtr<ID3D11Texture2D> back_buffer_ptr{ nullptr };
-
-	// Here we expect the logic to use the GetSupportedResolutions function
-	// such that it is not necessary to check if there is a valid display_mode,
-	// since all of the resolutions in the list should be valid
-	DXGI_MODE_DESC zero_refresh_rate = m_display_mode_desc;
-	zero_refresh_rate.Width = settings.window_width;
-	zero_refresh_rate.Height = settings.window_height;
-	zero_refresh_rate.RefreshRate.Numerator = 0;
-	zero_refresh_rate.RefreshRate.Denominator = 0;
-
-	// Adjust to fullscreen if necessary
-	// https://bell0bytes.eu/fullscreen/
-	// TODO(rwarnking) explanation why this is not needed in fullscreen mode
-	if (!settings.fullscreen) {
-		result = m_swapChain->ResizeTarget(&zero_refresh_rate);
-		if (FAILED(result)) {
-			return result;
-		}
-	}
-
-	result = m_swapChain->SetFullscreenState(settings.fullscreen, nullptr);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	if (!settings.fullscreen) {
-		result = m_swapChain->ResizeTarget(&zero_refresh_rate);
-		if (FAILED(result)) {
-			return result;
-		}
-	}
-
-	result = m_swapChain->ResizeBuffers(
-		0, settings.window_width, settings.window_height, 
-		DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-
-	// Set the swap chain's backbuffer
-	result = m_swapChain->GetBuffer(
-		0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(back_buffer_ptr.GetAddressOf())
-	);
-	if (FAILED(result)) {
-		return result;
-	}
-
-	// Create the necessary render target view
-	result = m_device->CreateRenderTargetView(
-		back_buffer_ptr.Get(),
-		nullptr,
-		m_renderTargetView.GetAddressOf()
-	);
+	result = ResizeSwapChain(settings);
 	if (FAILED(result)) {
 		return result;
 	}
@@ -469,15 +269,14 @@ auto Direct3D::Refresh(const GraphicSettings& settings) -> HRESULT
 	//////////////////
 	// Set viewport //
 	//////////////////
-	D3D11_VIEWPORT viewport;
-	viewport.Width = float(settings.window_width);
-	viewport.Height = float(settings.window_height);
-	viewport.MinDepth = 0.0F;
-	viewport.MaxDepth = 1.0F;
-	viewport.TopLeftX = 0.0F;
-	viewport.TopLeftY = 0.0F;
+	m_viewport.Width = float(settings.window_width);
+	m_viewport.Height = float(settings.window_height);
+	m_viewport.MinDepth = 0.0F;
+	m_viewport.MaxDepth = 1.0F;
+	m_viewport.TopLeftX = 0.0F;
+	m_viewport.TopLeftY = 0.0F;
 
-	m_deviceContext->RSSetViewports(1, &viewport);
+	m_deviceContext->RSSetViewports(1, &m_viewport);
 
 	CalculateMatrices(
 		settings.screen_near, settings.screen_depth, settings.window_width, settings.window_height
@@ -513,6 +312,234 @@ void Direct3D::EndScene() const
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // CREATORs
 ///////////////////////////////////////////////////////////////////////////////////////////////////
+auto Direct3D::CreateDeviceAndSwapChain(const HWND& hwnd, const GraphicSettings& settings)
+	-> HRESULT
+{
+	HRESULT result{ S_OK };
+
+
+	///////////////////////////////////
+	// Videocard/Display information //
+	///////////////////////////////////
+	// In the first steps, the refresh rate of the monitor is determined by getting and then
+	// querying the adapter for the refresh rate numerator and denominator corresponding to
+	// the desired window dimensions.
+
+	// Create a factory which can be used to create other DXGI objects
+	Microsoft::WRL::ComPtr<IDXGIFactory> factory{ nullptr };
+	result = CreateDXGIFactory(__uuidof(IDXGIFactory), reinterpret_cast<void**>(factory.GetAddressOf()));
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Construct an adapter for the graphics card currently in use
+	Microsoft::WRL::ComPtr<IDXGIAdapter> adapter{ nullptr };
+	result = factory->EnumAdapters(0, adapter.GetAddressOf());
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Determine the primary monitor
+	Microsoft::WRL::ComPtr<IDXGIOutput> adapter_output{ nullptr };
+	result = adapter->EnumOutputs(0, adapter_output.GetAddressOf());
+	if (FAILED(result)) {
+		return result;
+	}
+
+
+	// https://docs.microsoft.com/en-us/windows/win32/api/dxgi1_2/nf-dxgi1_2-idxgioutput1-getdisplaymodelist1
+	// Enumerate all display modes which satisfy the given parameters and
+	// store their number numModes
+	unsigned int numModes = 0;
+	result = adapter_output->GetDisplayModeList(
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		DXGI_ENUM_MODES_INTERLACED,
+		&numModes,
+		nullptr
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Construct an array where all display modes can be stored
+	std::vector<DXGI_MODE_DESC> display_mode_list;
+	display_mode_list.resize(numModes);
+	m_resolutions.reserve(numModes);
+
+	// Same function as above, this time we store the display modes in displayModeList
+	result = adapter_output->GetDisplayModeList(
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		DXGI_ENUM_MODES_INTERLACED,
+		&numModes,
+		display_mode_list.data()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	for (auto& mode : display_mode_list)
+	{
+		m_resolutions.emplace_back(uint16_t(mode.Width), uint16_t(mode.Height));
+	}
+
+	// For the first start we search for the closest matching mode, since we can not know
+	// what exactly the logic has chosen as resolution
+	DXGI_MODE_DESC tmp_display_mode_desc{};
+	tmp_display_mode_desc.Width = settings.window_width;
+	tmp_display_mode_desc.Height = settings.window_height;
+	adapter_output->FindClosestMatchingMode(&tmp_display_mode_desc, &m_display_mode_desc, nullptr);
+	
+
+	// Query the graphics card description and store it in adapterDesc
+	DXGI_ADAPTER_DESC adapterDesc;
+	result = adapter->GetDesc(&adapterDesc);
+	if (FAILED(result)) {
+		return result;
+	}
+	
+	// in binary it needs to be 1024
+	// https://www.gamedev.net/forums/topic/681964-how-do-i-detect-the-available-video-memory/
+	constexpr unsigned int B_PER_KB = 1024;
+	constexpr unsigned int KB_PER_MB = 1024;
+	// Store the memory size of the graphics card
+	m_videoCardMemory = adapterDesc.DedicatedVideoMemory / B_PER_KB / KB_PER_MB;
+	// Copy the graphics card description
+	m_videoCardDescription = std::wstring(adapterDesc.Description);
+	
+	// Not in use since the syntaxhighlighting does not work if used
+	// #include <span>
+	// m_videoCardDescription = std::wstring(std::span{ adapterDesc.Description }.data());
+	
+	////////////////////////////////////
+	// Setup swapchain and backbuffer //
+	////////////////////////////////////
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> back_buffer_ptr{ nullptr };
+	// Specify the DirectX version to be used (11)
+	D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+	auto swap_chain_desc = CreateSwapChainDesc(
+		hwnd, settings.window_width, settings.window_height
+	);
+	
+
+	UINT creation_flags = 0;
+	// TODO(rwarnking) how to use this
+#if defined(_DEBUG)
+	// If the project is in a debug build, enable the debug layer.
+	creation_flags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+	// Create the swap chain, Direct3D device and Direct3D device context using the swap chain
+	// description. The latter serve as interfaces for all DirectX functions.
+	result = D3D11CreateDeviceAndSwapChain(
+		nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
+		creation_flags, &featureLevel, 1,
+		D3D11_SDK_VERSION, &swap_chain_desc, m_swapChain.GetAddressOf(),
+		m_device.GetAddressOf(), nullptr, m_deviceContext.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	result = m_swapChain->SetFullscreenState(settings.fullscreen, nullptr);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Set the swap chain's backbuffer
+	result = m_swapChain->GetBuffer(
+		0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(back_buffer_ptr.GetAddressOf())
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Create the necessary render target view
+	result = m_device->CreateRenderTargetView(
+		back_buffer_ptr.Get(),
+		nullptr,
+		m_renderTargetView.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	return result;
+}
+
+
+auto Direct3D::ResizeSwapChain(const GraphicSettings& settings) -> HRESULT
+{
+	HRESULT result{ S_OK };
+
+
+	///////////////////////////////////
+	// Swapchain + backbuffer update //
+	///////////////////////////////////
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> back_buffer_ptr{ nullptr };
+
+	// Here we expect the logic to use the GetSupportedResolutions function
+	// such that it is not necessary to check if there is a valid display_mode,
+	// since all of the resolutions in the list should be valid
+	DXGI_MODE_DESC zero_refresh_rate = m_display_mode_desc;
+	zero_refresh_rate.Width = settings.window_width;
+	zero_refresh_rate.Height = settings.window_height;
+	zero_refresh_rate.RefreshRate.Numerator = 0;
+	zero_refresh_rate.RefreshRate.Denominator = 0;
+
+	// Adjust to fullscreen if necessary
+	// https://bell0bytes.eu/fullscreen/
+	// TODO(rwarnking) explanation why this is not needed in fullscreen mode
+	if (!settings.fullscreen) {
+		result = m_swapChain->ResizeTarget(&zero_refresh_rate);
+		if (FAILED(result)) {
+			return result;
+		}
+	}
+
+	result = m_swapChain->SetFullscreenState(settings.fullscreen, nullptr);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	if (!settings.fullscreen) {
+		result = m_swapChain->ResizeTarget(&zero_refresh_rate);
+		if (FAILED(result)) {
+			return result;
+		}
+	}
+
+	result = m_swapChain->ResizeBuffers(
+		0, settings.window_width, settings.window_height, 
+		DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+
+	// Set the swap chain's backbuffer
+	result = m_swapChain->GetBuffer(
+		0, __uuidof(ID3D11Texture2D), reinterpret_cast<LPVOID*>(back_buffer_ptr.GetAddressOf())
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Create the necessary render target view
+	result = m_device->CreateRenderTargetView(
+		back_buffer_ptr.Get(),
+		nullptr,
+		m_renderTargetView.GetAddressOf()
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	return result;
+}
+
+
 auto Direct3D::CreateSwapChainDesc(
 	const HWND& hwnd,
 	const uint16_t window_width, const uint16_t window_height
@@ -772,12 +799,28 @@ auto Direct3D::GetVideoCardMemory() const -> size_t
 }
 
 
+auto Direct3D::GetRenderTargetView() const -> ID3D11RenderTargetView*
+{
+	return m_renderTargetView.Get();
+}
+
+
 auto Direct3D::GetDepthStencilView() const -> ID3D11DepthStencilView*
 {
 	return m_depthStencilView.Get();
 }
 
 
+auto Direct3D::SupportsCommandLists() const -> bool
+{
+	D3D11_FEATURE_DATA_THREADING threading{};
+	auto result = m_device->CheckFeatureSupport(
+		D3D11_FEATURE_THREADING, &threading, sizeof(threading)
+	);
+	return SUCCEEDED(result) && threading.DriverCommandLists == TRUE;
+}
+
+
 auto Direct3D::GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&
 {
 	return m_resolutions;
@@ -793,6 +836,15 @@ void Direct3D::SetBackBufferRenderTarget()
 }
 
 
+void Direct3D::ApplyRenderState(ID3D11DeviceContext* device_context)
+{
+	device_context->OMSetRenderTargets(1, m_renderTargetView.GetAddressOf(), m_depthStencilView.Get());
+	device_context->OMSetDepthStencilState(m_depthStencilState.Get(), 1);
+	device_context->RSSetState(m_rasterState.Get());
+	device_context->RSSetViewports(1, &m_viewport);
+}
+
+
 void Direct3D::TurnZBufferOn()
 {
 	m_deviceContext->OMSetDepthStencilState(m_depthStencilState.Get(), 1);
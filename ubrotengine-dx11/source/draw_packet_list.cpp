@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: draw_packet_list.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/draw_packet_list.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+auto DrawPacketList::MakeSortKey(
+	size_t view_order, size_t program_idx, uint32_t texture_array_idx, size_t model_idx,
+	float depth
+) -> uint64_t
+{
+	// Layout: [view 4 bit][program 8 bit][texture array 8 bit][model 16 bit][depth 28 bit]
+	// Positive floats keep their order when compared as unsigned integers, their sign bit is
+	// zero and the depth drops the lowest mantissa bits. Packets without a texture (array
+	// index NONE) end up behind the textured ones, like any other index that does not fit.
+	constexpr uint64_t PROGRAM_MAX = MAX_SORT_PROGRAMS - 1;
+	constexpr uint64_t TEXTURE_MAX = MAX_SORT_TEXTURE_ARRAYS - 1;
+	constexpr uint64_t MODEL_MAX = MAX_SORT_MODELS - 1;
+	constexpr uint64_t VIEW_SHIFT = 60;
+	constexpr uint64_t PROGRAM_SHIFT = 52;
+	constexpr uint64_t TEXTURE_SHIFT = 44;
+	constexpr uint64_t MODEL_SHIFT = 28;
+	constexpr uint32_t DEPTH_SHIFT = 3;
+
+	// The view decides the draw list, it must never share a value with another view
+	assert(view_order < MAX_VIEWS && "MakeSortKey view out of range");
+
+	uint32_t depth_bits{ 0 };
+	if (depth > 0.0F) {
+		std::memcpy(&depth_bits, &depth, sizeof(depth_bits));
+	}
+
+	// Clamped instead of masked, so a large index can not alias a small one
+	return (std::min(uint64_t(view_order), uint64_t(MAX_VIEWS - 1)) << VIEW_SHIFT)
+		| (std::min(uint64_t(program_idx), PROGRAM_MAX) << PROGRAM_SHIFT)
+		| (std::min(uint64_t(texture_array_idx), TEXTURE_MAX) << TEXTURE_SHIFT)
+		| (std::min(uint64_t(model_idx), MODEL_MAX) << MODEL_SHIFT)
+		| uint64_t(depth_bits >> DEPTH_SHIFT);
+}
+
+
+void DrawPacketList::Clear()
+{
+	m_view_idx.clear();
+	m_model_idx.clear();
+	m_program_idx.clear();
+	m_matrix_idx.clear();
+	m_sort_key.clear();
+	m_world_matrices.clear();
+	m_order.clear();
+}
+
+
+void DrawPacketList::Reserve(size_t packet_count)
+{
+	m_view_idx.reserve(packet_count);
+	m_model_idx.reserve(packet_count);
+	m_program_idx.reserve(packet_count);
+	m_matrix_idx.reserve(packet_count);
+	m_sort_key.reserve(packet_count);
+	m_world_matrices.reserve(packet_count);
+	m_order.reserve(packet_count);
+}
+
+
+auto DrawPacketList::AddWorldMatrix(const math::Float4x4& world_matrix) -> uint32_t
+{
+	auto pos = uint32_t(m_world_matrices.size());
+	m_world_matrices.push_back(world_matrix);
+	return pos;
+}
+
+
+auto DrawPacketList::Add(
+	uint8_t view_idx, size_t model_idx, size_t program_idx, uint32_t matrix_idx,
+	uint64_t sort_key
+) -> size_t
+{
+	auto pos = m_model_idx.size();
+	m_view_idx.push_back(view_idx);
+	m_model_idx.push_back(model_idx);
+	m_program_idx.push_back(program_idx);
+	m_matrix_idx.push_back(matrix_idx);
+	m_sort_key.push_back(sort_key);
+	return pos;
+}
+
+
+void DrawPacketList::Sort()
+{
+	m_order.resize(m_sort_key.size());
+	std::iota(m_order.begin(), m_order.end(), 0);
+	std::sort(
+		m_order.begin(), m_order.end(),
+		[this](uint32_t a, uint32_t b) { return m_sort_key[a] < m_sort_key[b]; }
+	);
+}
+
+
+auto DrawPacketList::Size() const -> size_t
+{
+	return m_model_idx.size();
+}
+
+
+auto DrawPacketList::Empty() const -> bool
+{
+	return m_model_idx.empty();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto DrawPacketList::GetOrder() const -> const std::vector<uint32_t>&
+{
+	return m_order;
+}
+
+
+auto DrawPacketList::GetViewIndices() const -> const std::vector<uint8_t>&
+{
+	return m_view_idx;
+}
+
+
+auto DrawPacketList::GetModelIndices() const -> const std::vector<size_t>&
+{
+	return m_model_idx;
+}
+
+
+auto DrawPacketList::GetProgramIndices() const -> const std::vector<size_t>&
+{
+	return m_program_idx;
+}
+
+
+auto DrawPacketList::GetMatrixIndices() const -> const std::vector<uint32_t>&
+{
+	return m_matrix_idx;
+}
+
+
+auto DrawPacketList::GetSortKeys() const -> const std::vector<uint64_t>&
+{
+	return m_sort_key;
+}
+
+
+auto DrawPacketList::GetWorldMatrix(uint32_t matrix_idx) const -> const math::Float4x4&
+{
+	return m_world_matrices[matrix_idx];
+}
+
+
+auto DrawPacketList::GetWorldMatrices() const -> const std::vector<math::Float4x4>&
+{
+	return m_world_matrices;
+}
+
+} // namespace graphics
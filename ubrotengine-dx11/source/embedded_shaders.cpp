@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: embedded_shaders.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/embedded_shaders.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+/**
+ * The parts are separated by a character that appears in none of them.
+ */
+auto MakeKey(
+	const std::string& name, const std::string& entry_point, const std::string& target,
+	const std::string& defines
+) -> std::string
+{
+	return name + '|' + entry_point + '|' + target + '|' + defines;
+}
+
+} // namespace
+
+
+EmbeddedShaderTable::EmbeddedShaderTable(const EmbeddedShader* shaders, size_t count)
+{
+	m_shaders.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		m_shaders.insert({ GetKey(shaders[i]), &shaders[i] });
+	}
+}
+
+
+auto EmbeddedShaderTable::Find(const ShaderCompileDesc& desc) const -> const EmbeddedShader*
+{
+	if (m_shaders.empty()) {
+		return nullptr;
+	}
+	const auto it = m_shaders.find(GetKey(desc));
+	return it != m_shaders.end() ? it->second : nullptr;
+}
+
+
+auto EmbeddedShaderTable::GetSize() const -> size_t
+{
+	return m_shaders.size();
+}
+
+
+auto EmbeddedShaderTable::GetKey(const ShaderCompileDesc& desc) -> std::string
+{
+	const auto name = desc.path.filename().u8string();
+	return MakeKey(
+		{ name.begin(), name.end() }, desc.entry_point, desc.target, JoinDefines(desc.defines)
+	);
+}
+
+
+auto EmbeddedShaderTable::GetKey(const EmbeddedShader& shader) -> std::string
+{
+	return MakeKey(shader.name, shader.entry_point, shader.target, shader.defines);
+}
+
+
+auto EmbeddedShaderTable::JoinDefines(const std::vector<ShaderDefine>& defines) -> std::string
+{
+	std::string joined;
+	for (const auto& define : defines) {
+		joined += define.name + '=' + define.value + ';';
+	}
+	return joined;
+}
+
+} // namespace graphics
@@ -0,0 +1,438 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: frame_capture.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/frame_capture.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+// Records and frames are copied as they are, so their layout is fixed
+static_assert(sizeof(CaptureHeader) == 8);
+static_assert(sizeof(CaptureRecord) == 8);
+static_assert(sizeof(CaptureFrame) == 12);
+static_assert(sizeof(SceneInput::User) == 24);
+static_assert(sizeof(math::Float3) == 12);
+
+// Users, tiles and objects
+constexpr size_t FRAME_COUNTS = 3;
+
+template <class T>
+void WriteRaw(std::ofstream& stream, const T* data, size_t count)
+{
+	stream.write(reinterpret_cast<const char*>(data), std::streamsize(sizeof(T) * count));
+}
+
+template <class T>
+void Append(std::vector<uint8_t>& dst, const T* data, size_t count)
+{
+	if (count == 0) {
+		return;
+	}
+	const auto old = dst.size();
+	dst.resize(old + sizeof(T) * count);
+	std::memcpy(dst.data() + old, data, sizeof(T) * count);
+}
+
+/**
+ * Copies \p count values to \p dst and moves \p data behind them.
+ * @return false if fewer bytes than that are left before \p end
+ */
+template <class T>
+auto Take(const uint8_t*& data, const uint8_t* end, T* dst, size_t count) -> bool
+{
+	const auto size = sizeof(T) * count;
+	if (size_t(end - data) < size) {
+		return false;
+	}
+	if (size > 0) {
+		std::memcpy(dst, data, size);
+	}
+	data += size;
+	return true;
+}
+
+} // namespace
+
+
+auto CaptureWriter::Open(const std::string& filename) -> bool
+{
+	Close();
+	m_stream.open(filename, std::ios::binary | std::ios::trunc);
+
+	CaptureHeader header;
+	header.magic = MAGIC;
+	header.version = VERSION;
+	WriteRaw(m_stream, &header, 1);
+	WriteRaw(m_stream, m_setup.data(), m_setup.size());
+
+	// The first frame has nothing to be XORed with
+	m_previous_frame.clear();
+	m_stats = Stats{};
+	m_stats.file_bytes = sizeof(CaptureHeader) + m_setup.size();
+	if (m_stream.fail()) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+
+void CaptureWriter::Close()
+{
+	if (m_stream.is_open()) {
+		m_stream.close();
+	}
+	m_stream.clear();
+}
+
+
+auto CaptureWriter::IsOpen() const -> bool
+{
+	return m_stream.is_open();
+}
+
+
+void CaptureWriter::AddSettings(const GraphicSettings& settings)
+{
+	// Floats are written with all digits, so the replay gets exactly the same projections
+	std::ostringstream text;
+	text.precision(std::numeric_limits<float>::max_digits10);
+	text << settings;
+	AddSetup(CaptureRecordType::Settings, { text.str() }, {});
+}
+
+
+void CaptureWriter::AddArchive(const std::string& filename)
+{
+	AddSetup(CaptureRecordType::MountArchive, { filename }, {});
+}
+
+
+void CaptureWriter::AddModel(const std::string& filename)
+{
+	AddSetup(CaptureRecordType::Model, { filename }, {});
+}
+
+
+void CaptureWriter::AddProceduralModel(uint8_t num)
+{
+	AddSetup(CaptureRecordType::ProceduralModel, {}, { num });
+}
+
+
+void CaptureWriter::AddTexture(const std::string& filename, uint8_t components)
+{
+	AddSetup(CaptureRecordType::Texture, { filename }, { components });
+}
+
+
+void CaptureWriter::AddModels(const std::vector<std::string>& filenames)
+{
+	AddSetup(CaptureRecordType::Models, filenames, {});
+}
+
+
+void CaptureWriter::AddTextures(const std::vector<std::string>& filenames, uint8_t components)
+{
+	AddSetup(CaptureRecordType::Textures, filenames, { components });
+}
+
+
+void CaptureWriter::AddModelTexture(size_t model_idx, size_t texture_idx)
+{
+	AddSetup(CaptureRecordType::ModelTexture, {}, { uint32_t(model_idx), uint32_t(texture_idx) });
+}
+
+
+auto CaptureWriter::AddFrame(const SceneInput& input) -> bool
+{
+	if (!IsOpen()) {
+		return true;
+	}
+
+	m_frame.clear();
+	const std::array<uint32_t, FRAME_COUNTS> counts = {
+		uint32_t(input.users.size()), uint32_t(input.tile_objects.size()),
+		uint32_t(input.models.size())
+	};
+	Append(m_frame, counts.data(), counts.size());
+	Append(m_frame, input.users.data(), input.users.size());
+	Append(m_frame, input.tile_objects.data(), input.tile_objects.size());
+	Append(m_frame, input.models.data(), input.models.size());
+	Append(m_frame, input.positions.data(), input.positions.size());
+
+	CaptureFrame frame;
+	frame.unpacked_size = uint32_t(m_frame.size());
+	frame.delta = m_previous_frame.size() == m_frame.size() ? 1 : 0;
+	frame.block_count = uint32_t((m_frame.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+
+	// The previous frame is not needed any more, so it is turned into the difference
+	const uint8_t* source = m_frame.data();
+	if (frame.delta != 0) {
+		for (size_t i = 0; i < m_frame.size(); i++) {
+			m_previous_frame[i] ^= m_frame[i];
+		}
+		source = m_previous_frame.data();
+	}
+
+	m_packed.clear();
+	m_block_sizes.clear();
+	for (size_t b = 0; b < frame.block_count; b++) {
+		const auto* block = source + b * BLOCK_SIZE;
+		const auto block_size = std::min(BLOCK_SIZE, m_frame.size() - b * BLOCK_SIZE);
+		const auto start = m_packed.size();
+		io::LzCodec::Compress(block, block_size, m_packed);
+
+		// Blocks that do not get smaller are stored, the reader tells them apart by their size
+		if (m_packed.size() - start >= block_size) {
+			m_packed.resize(start);
+			m_packed.insert(m_packed.end(), block, block + block_size);
+		}
+		m_block_sizes.push_back(uint32_t(m_packed.size() - start));
+	}
+
+	CaptureRecord record;
+	record.type = CaptureRecordType::Frame;
+	record.size = uint32_t(
+		sizeof(CaptureFrame) + m_block_sizes.size() * sizeof(uint32_t) + m_packed.size()
+	);
+	WriteRaw(m_stream, &record, 1);
+	WriteRaw(m_stream, &frame, 1);
+	WriteRaw(m_stream, m_block_sizes.data(), m_block_sizes.size());
+	WriteRaw(m_stream, m_packed.data(), m_packed.size());
+	m_previous_frame.swap(m_frame);
+
+	m_stats.frames++;
+	m_stats.frame_bytes += frame.unpacked_size;
+	m_stats.file_bytes += sizeof(CaptureRecord) + record.size;
+	return !m_stream.fail();
+}
+
+
+auto CaptureWriter::GetStats() const -> Stats
+{
+	return m_stats;
+}
+
+
+void CaptureWriter::AddSetup(
+	CaptureRecordType type, const std::vector<std::string>& strings,
+	const std::vector<uint32_t>& values
+)
+{
+	// The size is filled in once the payload is appended
+	const auto start = m_setup.size();
+	CaptureRecord record;
+	record.type = type;
+	Append(m_setup, &record, 1);
+
+	const auto string_count = uint32_t(strings.size());
+	Append(m_setup, &string_count, 1);
+	for (const auto& string : strings) {
+		const auto length = uint32_t(string.size());
+		Append(m_setup, &length, 1);
+		Append(m_setup, string.data(), string.size());
+	}
+	const auto value_count = uint32_t(values.size());
+	Append(m_setup, &value_count, 1);
+	Append(m_setup, values.data(), values.size());
+
+	record.size = uint32_t(m_setup.size() - start - sizeof(CaptureRecord));
+	std::memcpy(m_setup.data() + start, &record, sizeof(CaptureRecord));
+
+	if (IsOpen()) {
+		WriteRaw(m_stream, m_setup.data() + start, m_setup.size() - start);
+		m_stats.file_bytes += m_setup.size() - start;
+	}
+}
+
+
+auto CaptureReader::Open(const std::string& filename) -> bool
+{
+	Close();
+	if (!m_file.Open(filename) || m_file.GetSize() < sizeof(CaptureHeader)) {
+		Close();
+		return false;
+	}
+
+	CaptureHeader header;
+	std::memcpy(&header, m_file.GetData(), sizeof(CaptureHeader));
+	if (header.magic != CaptureWriter::MAGIC || header.version != CaptureWriter::VERSION) {
+		Close();
+		return false;
+	}
+	Rewind();
+	return true;
+}
+
+
+void CaptureReader::Close()
+{
+	m_file.Close();
+	m_offset = 0;
+	m_previous_frame.clear();
+}
+
+
+auto CaptureReader::Next(CaptureEntry& entry) -> bool
+{
+	const auto size = m_file.GetSize();
+	if (m_offset + sizeof(CaptureRecord) > size) {
+		return false;
+	}
+
+	CaptureRecord record;
+	std::memcpy(&record, m_file.GetData() + m_offset, sizeof(CaptureRecord));
+	const auto* payload = m_file.GetData() + m_offset + sizeof(CaptureRecord);
+	if (record.size > size - m_offset - sizeof(CaptureRecord)
+		|| record.type >= CaptureRecordType::NUMBER) {
+		return false;
+	}
+
+	entry.type = record.type;
+	const bool valid = record.type == CaptureRecordType::Frame
+		? ReadFrame(payload, record.size, entry.frame)
+		: ReadSetup(payload, record.size, entry);
+	if (!valid) {
+		return false;
+	}
+	m_offset += sizeof(CaptureRecord) + record.size;
+	return true;
+}
+
+
+void CaptureReader::Rewind()
+{
+	m_offset = sizeof(CaptureHeader);
+	m_previous_frame.clear();
+}
+
+
+auto CaptureReader::AtEnd() const -> bool
+{
+	return m_offset >= m_file.GetSize();
+}
+
+
+auto CaptureReader::ReadSetup(const uint8_t* data, size_t size, CaptureEntry& entry) const
+	-> bool
+{
+	const auto* end = data + size;
+
+	// Counts are checked against the remaining bytes before anything is allocated
+	uint32_t count{ 0 };
+	if (!Take(data, end, &count, 1) || size_t(end - data) < count * sizeof(uint32_t)) {
+		return false;
+	}
+	entry.strings.resize(count);
+	for (auto& string : entry.strings) {
+		uint32_t length{ 0 };
+		if (!Take(data, end, &length, 1) || size_t(end - data) < length) {
+			return false;
+		}
+		string.assign(reinterpret_cast<const char*>(data), length);
+		data += length;
+	}
+
+	if (!Take(data, end, &count, 1) || size_t(end - data) != count * sizeof(uint32_t)) {
+		return false;
+	}
+	entry.values.resize(count);
+	return Take(data, end, entry.values.data(), count);
+}
+
+
+auto CaptureReader::ReadFrame(const uint8_t* data, size_t size, SceneInput& frame) -> bool
+{
+	static constexpr size_t BLOCK_SIZE = CaptureWriter::BLOCK_SIZE;
+	const auto* end = data + size;
+
+	CaptureFrame header;
+	if (!Take(data, end, &header, 1)) {
+		return false;
+	}
+	const auto unpacked_size = size_t(header.unpacked_size);
+	if (header.block_count != (unpacked_size + BLOCK_SIZE - 1) / BLOCK_SIZE
+		|| (header.delta != 0 && m_previous_frame.size() != unpacked_size)) {
+		return false;
+	}
+
+	const auto* sizes = data;
+	if (size_t(end - data) < header.block_count * sizeof(uint32_t)) {
+		return false;
+	}
+	data += header.block_count * sizeof(uint32_t);
+
+	m_frame.resize(unpacked_size);
+	for (size_t b = 0; b < header.block_count; b++) {
+		uint32_t packed_size{ 0 };
+		std::memcpy(&packed_size, sizes + b * sizeof(uint32_t), sizeof(uint32_t));
+		const auto block_size = std::min(BLOCK_SIZE, unpacked_size - b * BLOCK_SIZE);
+		auto* block = m_frame.data() + b * BLOCK_SIZE;
+		if (size_t(end - data) < packed_size) {
+			return false;
+		}
+		if (packed_size == block_size) {
+			std::memcpy(block, data, block_size);
+		}
+		else if (!io::LzCodec::Decompress(data, packed_size, block, block_size)) {
+			return false;
+		}
+		data += packed_size;
+	}
+	if (data != end) {
+		return false;
+	}
+
+	if (header.delta != 0) {
+		for (size_t i = 0; i < unpacked_size; i++) {
+			m_frame[i] ^= m_previous_frame[i];
+		}
+	}
+
+	const auto* raw = m_frame.data();
+	const auto* raw_end = raw + m_frame.size();
+	std::array<uint32_t, FRAME_COUNTS> counts{};
+	if (!Take(raw, raw_end, counts.data(), counts.size())) {
+		return false;
+	}
+	const auto expected_size = sizeof(counts) + uint64_t(counts[0]) * sizeof(SceneInput::User)
+		+ uint64_t(counts[1]) * sizeof(uint32_t)
+		+ uint64_t(counts[2]) * (sizeof(uint32_t) + sizeof(math::Float3));
+	if (expected_size != unpacked_size) {
+		return false;
+	}
+	frame.users.resize(counts[0]);
+	frame.tile_objects.resize(counts[1]);
+	frame.models.resize(counts[2]);
+	frame.positions.resize(counts[2]);
+	Take(raw, raw_end, frame.users.data(), frame.users.size());
+	Take(raw, raw_end, frame.tile_objects.data(), frame.tile_objects.size());
+	Take(raw, raw_end, frame.models.data(), frame.models.size());
+	Take(raw, raw_end, frame.positions.data(), frame.positions.size());
+
+	// The next frame may be XORed with this one
+	m_previous_frame.swap(m_frame);
+	return true;
+}
+
+} // namespace graphics
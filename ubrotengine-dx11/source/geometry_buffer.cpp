@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: geometry_buffer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/geometry_buffer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+GeometryBuffer::GeometryBuffer(BufferUsage usage, uint32_t element_size) :
+	m_usage{ usage },
+	m_element_size{ element_size }
+{
+}
+
+
+auto GeometryBuffer::Allocate(
+	RenderDevice& device, const void* data, uint32_t element_count, uint32_t user_data,
+	Handle& handle
+) -> HRESULT
+{
+	auto result{ S_OK };
+
+	handle = m_allocator.Allocate(element_count, user_data);
+	if (handle == utils::TlsfAllocator::INVALID_HANDLE) {
+		result = Grow(device, m_allocator.GetCapacity() + element_count);
+		if (FAILED(result)) {
+			return result;
+		}
+		handle = m_allocator.Allocate(element_count, user_data);
+		if (handle == utils::TlsfAllocator::INVALID_HANDLE) {
+			return E_OUTOFMEMORY;
+		}
+	}
+
+	// Only the new range is written, the rest of the buffer stays untouched
+	const auto offset = m_allocator.GetOffset(handle) * m_element_size;
+	const auto size = element_count * m_element_size;
+	device.UpdateBuffer(m_buffer, offset, data, size);
+	if (m_keep_cpu_copy) {
+		std::memcpy(m_cpu_copy.data() + offset, data, size);
+	}
+
+	return result;
+}
+
+
+void GeometryBuffer::Free(Handle handle)
+{
+	m_allocator.Free(handle);
+}
+
+
+void GeometryBuffer::Defragment(
+	RenderDevice& device, uint32_t max_elements, std::vector<utils::TlsfAllocator::Move>& moves
+)
+{
+	if (m_allocator.PlanDefrag(max_elements, moves) == 0) {
+		return;
+	}
+
+	// The moves are executed in planning order, a later move can use the space freed by an
+	// earlier one. Source and destination of a single move never overlap.
+	for (const auto& move : moves) {
+		const auto src = move.src_offset * m_element_size;
+		const auto dst = move.dst_offset * m_element_size;
+		const auto size = move.size * m_element_size;
+		device.CopyBuffer(m_buffer, dst, m_buffer, src, size);
+		if (m_keep_cpu_copy) {
+			std::memmove(m_cpu_copy.data() + dst, m_cpu_copy.data() + src, size);
+		}
+	}
+}
+
+
+auto GeometryBuffer::Grow(RenderDevice& device, uint32_t min_capacity) -> HRESULT
+{
+	// Start with room for 64k elements and double from there to keep reallocations rare
+	constexpr uint32_t MIN_ELEMENTS = 1U << 16U;
+	const auto old_capacity = m_allocator.GetCapacity();
+	uint32_t capacity = std::max(old_capacity * 2, MIN_ELEMENTS);
+	while (capacity < min_capacity) {
+		capacity *= 2;
+	}
+
+	RenderDevice::Handle buffer{ RenderDevice::NO_RESOURCE };
+	auto result = device.CreateBuffer(m_usage, capacity * m_element_size, buffer);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// Ranges can be anywhere in the old buffer, so all of it is copied
+	if (m_buffer != RenderDevice::NO_RESOURCE) {
+		device.CopyBuffer(buffer, 0, m_buffer, 0, old_capacity * m_element_size);
+		device.Release(m_buffer);
+	}
+
+	m_buffer = buffer;
+	m_allocator.Grow(capacity);
+	if (m_keep_cpu_copy) {
+		m_cpu_copy.resize(size_t(capacity) * m_element_size);
+	}
+	return result;
+}
+
+
+void GeometryBuffer::Release(RenderDevice& device)
+{
+	device.Release(m_buffer);
+	m_buffer = RenderDevice::NO_RESOURCE;
+	m_allocator = utils::TlsfAllocator{};
+	m_cpu_copy.clear();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto GeometryBuffer::GetBuffer() const -> RenderDevice::Handle
+{
+	return m_buffer;
+}
+
+
+auto GeometryBuffer::GetElementSize() const -> uint32_t
+{
+	return m_element_size;
+}
+
+
+auto GeometryBuffer::GetOffset(Handle handle) const -> uint32_t
+{
+	return m_allocator.GetOffset(handle);
+}
+
+
+auto GeometryBuffer::GetStats() const -> utils::TlsfAllocator::Stats
+{
+	return m_allocator.GetStats();
+}
+
+
+auto GeometryBuffer::GetCpuCopy() const -> const uint8_t*
+{
+	return m_keep_cpu_copy ? m_cpu_copy.data() : nullptr;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void GeometryBuffer::SetUserData(Handle handle, uint32_t user_data)
+{
+	m_allocator.SetUserData(handle, user_data);
+}
+
+
+void GeometryBuffer::KeepCpuCopy()
+{
+	m_keep_cpu_copy = true;
+	m_cpu_copy.resize(size_t(m_allocator.GetCapacity()) * m_element_size);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GeometryPool
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template <class T>
+auto GeometryPool::Add(
+	RenderDevice& device,
+	vertices::Model& model,
+	const std::vector<T>& vertices,
+	const std::vector<uint32_t>& indices
+) -> HRESULT
+{
+	constexpr auto stride = uint32_t(sizeof(T));
+	auto [it, inserted] = m_vertex_buffers.try_emplace(stride, BufferUsage::Vertex, stride);
+	if (inserted && m_keep_cpu_copies) {
+		it->second.KeepCpuCopy();
+	}
+
+	GeometryBuffer::Handle vertex_handle{ 0 };
+	auto result = it->second.Allocate(
+		device, vertices.data(), uint32_t(vertices.size()), 0, vertex_handle
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	GeometryBuffer::Handle index_handle{ 0 };
+	result = m_index_buffer.Allocate(
+		device, indices.data(), uint32_t(indices.size()), 0, index_handle
+	);
+	if (FAILED(result)) {
+		it->second.Free(vertex_handle);
+		return result;
+	}
+
+	model.vertexStride = stride;
+	model.baseVertex = it->second.GetOffset(vertex_handle);
+	model.firstIndex = m_index_buffer.GetOffset(index_handle);
+	model.vertexCount = uint32_t(vertices.size());
+	model.indexCount = uint32_t(indices.size());
+	model.vertexAllocation = vertex_handle;
+	model.indexAllocation = index_handle;
+
+	float radius_squared{ 0.0F };
+	for (const auto& vertex : vertices) {
+		const auto& p = vertex.position;
+		radius_squared = std::max(radius_squared, p.x * p.x + p.y * p.y + p.z * p.z);
+	}
+	model.boundingRadius = std::sqrt(radius_squared);
+	return result;
+}
+
+
+void GeometryPool::Remove(vertices::Model& model)
+{
+	auto it = m_vertex_buffers.find(model.vertexStride);
+	if (it != m_vertex_buffers.end() && model.vertexAllocation != vertices::NO_ALLOCATION) {
+		it->second.Free(model.vertexAllocation);
+	}
+	if (model.indexAllocation != vertices::NO_ALLOCATION) {
+		m_index_buffer.Free(model.indexAllocation);
+	}
+	model.vertexAllocation = vertices::NO_ALLOCATION;
+	model.indexAllocation = vertices::NO_ALLOCATION;
+	model.vertexCount = 0;
+	model.indexCount = 0;
+}
+
+
+void GeometryPool::SetOwner(const vertices::Model& model, uint32_t owner)
+{
+	auto it = m_vertex_buffers.find(model.vertexStride);
+	if (it != m_vertex_buffers.end() && model.vertexAllocation != vertices::NO_ALLOCATION) {
+		it->second.SetUserData(model.vertexAllocation, owner);
+	}
+	if (model.indexAllocation != vertices::NO_ALLOCATION) {
+		m_index_buffer.SetUserData(model.indexAllocation, owner);
+	}
+}
+
+
+auto GeometryPool::Defragment(
+	RenderDevice& device, size_t max_bytes, std::vector<vertices::Model>& models
+) -> size_t
+{
+	size_t moved_bytes{ 0 };
+
+	for (auto& [stride, buffer] : m_vertex_buffers) {
+		const auto budget = uint32_t(std::min<size_t>((max_bytes - moved_bytes) / stride, UINT32_MAX));
+		buffer.Defragment(device, budget, m_moves);
+		for (const auto& move : m_moves) {
+			models[move.user_data].baseVertex = move.dst_offset;
+			moved_bytes += size_t(move.size) * stride;
+		}
+	}
+
+	const auto element_size = m_index_buffer.GetElementSize();
+	const auto budget = uint32_t(std::min<size_t>((max_bytes - moved_bytes) / element_size, UINT32_MAX));
+	m_index_buffer.Defragment(device, budget, m_moves);
+	for (const auto& move : m_moves) {
+		models[move.user_data].firstIndex = move.dst_offset;
+		moved_bytes += size_t(move.size) * element_size;
+	}
+
+	return moved_bytes;
+}
+
+
+void GeometryPool::KeepCpuCopies()
+{
+	m_keep_cpu_copies = true;
+	m_index_buffer.KeepCpuCopy();
+	for (auto& [stride, buffer] : m_vertex_buffers) {
+		buffer.KeepCpuCopy();
+	}
+}
+
+
+void GeometryPool::Release(RenderDevice& device)
+{
+	for (auto& [stride, buffer] : m_vertex_buffers) {
+		buffer.Release(device);
+	}
+	m_vertex_buffers.clear();
+	m_index_buffer.Release(device);
+	if (m_keep_cpu_copies) {
+		m_index_buffer.KeepCpuCopy();
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto GeometryPool::GetVertexBuffer(uint32_t stride) const -> RenderDevice::Handle
+{
+	auto it = m_vertex_buffers.find(stride);
+	if (it == m_vertex_buffers.end()) {
+		return RenderDevice::NO_RESOURCE;
+	}
+	return it->second.GetBuffer();
+}
+
+
+auto GeometryPool::GetIndexBuffer() const -> RenderDevice::Handle
+{
+	return m_index_buffer.GetBuffer();
+}
+
+
+auto GeometryPool::GetVertexData(uint32_t stride) const -> const uint8_t*
+{
+	auto it = m_vertex_buffers.find(stride);
+	if (it == m_vertex_buffers.end()) {
+		return nullptr;
+	}
+	return it->second.GetCpuCopy();
+}
+
+
+auto GeometryPool::GetIndexData() const -> const uint32_t*
+{
+	return reinterpret_cast<const uint32_t*>(m_index_buffer.GetCpuCopy());
+}
+
+
+auto GeometryPool::GetBufferCount() const -> size_t
+{
+	const bool has_index_buffer = m_index_buffer.GetBuffer() != RenderDevice::NO_RESOURCE;
+	return m_vertex_buffers.size() + (has_index_buffer ? 1 : 0);
+}
+
+
+auto GeometryPool::GetStats() const -> Stats
+{
+	Stats stats;
+	size_t free_bytes{ 0 };
+
+	auto add = [&](const GeometryBuffer& buffer) {
+		const auto buffer_stats = buffer.GetStats();
+		const size_t size = buffer.GetElementSize();
+		stats.capacity_bytes += buffer_stats.capacity * size;
+		stats.used_bytes += buffer_stats.used * size;
+		stats.largest_free_bytes += buffer_stats.largest_free_block * size;
+		stats.free_blocks += buffer_stats.free_blocks;
+		free_bytes += (buffer_stats.capacity - buffer_stats.used) * size;
+	};
+	for (const auto& [stride, buffer] : m_vertex_buffers) {
+		add(buffer);
+	}
+	add(m_index_buffer);
+
+	if (free_bytes > 0) {
+		stats.fragmentation = 1.0F - float(stats.largest_free_bytes) / float(free_bytes);
+	}
+	return stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template HRESULT
+GeometryPool::Add<vertices::ColVertex>(
+	RenderDevice& device,
+	vertices::Model& model,
+	const std::vector<vertices::ColVertex>& vertices,
+	const std::vector<uint32_t>& indices
+);
+
+} // namespace graphics
@@ -0,0 +1,829 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: image_decoder.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/image_decoder.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define IMAGE_DECODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/inflater.h"
+
+
+namespace io
+{
+
+namespace
+{
+
+// Rows per parallel task, smaller images are converted on the calling thread
+constexpr uint32_t MIN_ROWS_PER_TASK = 64;
+
+constexpr std::array<uint8_t, 8> PNG_SIGNATURE = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+enum PngColorType : uint8_t
+{
+	Gray = 0,
+	Rgb = 2,
+	Palette = 3,
+	GrayAlpha = 4,
+	Rgba = 6
+};
+
+auto ReadBE32(const uint8_t* data) -> uint32_t
+{
+	return (uint32_t(data[0]) << 24U) | (uint32_t(data[1]) << 16U)
+		| (uint32_t(data[2]) << 8U) | uint32_t(data[3]);
+}
+
+constexpr auto CRC_TABLE = [] {
+	std::array<uint32_t, 256> table{};
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 1U) != 0 ? 0xEDB88320U ^ (crc >> 1U) : crc >> 1U;
+		}
+		table[i] = crc;
+	}
+	return table;
+}();
+
+/**
+ * CRC of a PNG chunk, it covers the type and the data.
+ */
+auto Crc32(const uint8_t* data, size_t size) -> uint32_t
+{
+	uint32_t crc = ~0U;
+	for (size_t i = 0; i < size; i++) {
+		crc = CRC_TABLE[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8U);
+	}
+	return ~crc;
+}
+
+auto ReadBE16(const uint8_t* data) -> uint32_t
+{
+	return (uint32_t(data[0]) << 8U) | uint32_t(data[1]);
+}
+
+auto ReadLE16(const uint8_t* data) -> uint32_t
+{
+	return uint32_t(data[0]) | (uint32_t(data[1]) << 8U);
+}
+
+auto GetChannelCount(uint8_t color_type) -> uint32_t
+{
+	switch (color_type)
+	{
+		case Gray:
+		case Palette:
+			return 1;
+		case GrayAlpha:
+			return 2;
+		case Rgb:
+			return 3;
+		case Rgba:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Repeats the pixel of an RLE run packet. The pixel size is a template parameter, so the
+ * copies compile to single moves instead of a call per pixel.
+ */
+template <uint32_t BYTES>
+void FillRun(uint8_t* dst, const uint8_t* pixel, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i += BYTES) {
+		std::memcpy(dst + i, pixel, BYTES);
+	}
+}
+
+auto PaethPredictor(int32_t a, int32_t b, int32_t c) -> uint8_t
+{
+	const int32_t pa = std::abs(b - c);
+	const int32_t pb = std::abs(a - c);
+	const int32_t pc = std::abs(a + b - 2 * c);
+	if (pa <= pb && pa <= pc) {
+		return uint8_t(a);
+	}
+	return uint8_t(pb <= pc ? b : c);
+}
+
+#ifdef IMAGE_DECODER_SSE2
+/**
+ * A 3 byte memcpy into an integer goes through the stack, and the 4 byte read of it waits
+ * for the stores to retire. The bytes are assembled in registers instead.
+ */
+template <uint32_t BPP>
+auto LoadPixel(const uint8_t* src) -> __m128i
+{
+	if constexpr (BPP == 3) {
+		const uint32_t value = src[0] | uint32_t(src[1]) << 8U | uint32_t(src[2]) << 16U;
+		return _mm_cvtsi32_si128(int32_t(value));
+	}
+	else {
+		int32_t value{ 0 };
+		std::memcpy(&value, src, BPP);
+		return _mm_cvtsi32_si128(value);
+	}
+}
+
+template <uint32_t BPP>
+void StorePixel(uint8_t* dst, __m128i pixel)
+{
+	const auto value = uint32_t(_mm_cvtsi128_si32(pixel));
+	if constexpr (BPP == 3) {
+		dst[0] = uint8_t(value);
+		dst[1] = uint8_t(value >> 8U);
+		dst[2] = uint8_t(value >> 16U);
+	}
+	else {
+		std::memcpy(dst, &value, BPP);
+	}
+}
+
+auto Abs16(__m128i x) -> __m128i
+{
+	return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+auto Select(__m128i mask, __m128i a, __m128i b) -> __m128i
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Unfilters one row of 3 or 4 byte pixels. The dependency on the left neighbour makes
+ * it impossible to process several pixels at once, instead all channels of a pixel are
+ * handled in one register. The pixel size is a template parameter so that the loads
+ * and stores compile to single moves.
+ */
+template <uint32_t BPP>
+void UnfilterRowSse2(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t row_bytes)
+{
+	const auto zero = _mm_setzero_si128();
+	__m128i a = zero;
+
+	switch (filter)
+	{
+		case 1:
+			for (size_t i = 0; i < row_bytes; i += BPP) {
+				a = _mm_add_epi8(a, LoadPixel<BPP>(row + i));
+				StorePixel<BPP>(row + i, a);
+			}
+			break;
+		case 3:
+		{
+			const auto one = _mm_set1_epi8(1);
+			for (size_t i = 0; i < row_bytes; i += BPP) {
+				const auto b = LoadPixel<BPP>(prior + i);
+				// avg_epu8 rounds up, the filter rounds down
+				const auto avg = _mm_sub_epi8(
+					_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one)
+				);
+				a = _mm_add_epi8(LoadPixel<BPP>(row + i), avg);
+				StorePixel<BPP>(row + i, a);
+			}
+			break;
+		}
+		case 4:
+		{
+			// Work on 16 bit lanes so that the predictor distances do not overflow
+			__m128i b = zero;
+			for (size_t i = 0; i < row_bytes; i += BPP) {
+				const auto c = b;
+				b = _mm_unpacklo_epi8(LoadPixel<BPP>(prior + i), zero);
+				const auto d = _mm_unpacklo_epi8(LoadPixel<BPP>(row + i), zero);
+
+				auto pa = _mm_sub_epi16(b, c);
+				auto pb = _mm_sub_epi16(a, c);
+				auto pc = _mm_add_epi16(pa, pb);
+				pa = Abs16(pa);
+				pb = Abs16(pb);
+				pc = Abs16(pc);
+
+				const auto smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+				const auto nearest = Select(
+					_mm_cmpeq_epi16(smallest, pa), a,
+					Select(_mm_cmpeq_epi16(smallest, pb), b, c)
+				);
+
+				// The upper bytes of the lanes are zero, so a byte add wraps correctly
+				a = _mm_add_epi8(d, nearest);
+				StorePixel<BPP>(row + i, _mm_packus_epi16(a, a));
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+#endif
+
+/**
+ * Converts one PNG row with 8 bit samples to RGBA.
+ */
+void ConvertPngRow(
+	const uint8_t* src, uint8_t* dst, uint32_t width, uint8_t color_type,
+	const std::array<uint8_t, 1024>& palette
+)
+{
+	switch (color_type)
+	{
+		case Gray:
+			ImageDecoder::ExpandGray(src, dst, width);
+			break;
+		case GrayAlpha:
+			for (uint32_t x = 0; x < width; x++) {
+				dst[x * 4 + 0] = src[x * 2];
+				dst[x * 4 + 1] = src[x * 2];
+				dst[x * 4 + 2] = src[x * 2];
+				dst[x * 4 + 3] = src[x * 2 + 1];
+			}
+			break;
+		case Rgb:
+			for (uint32_t x = 0; x < width; x++) {
+				const auto* pixel = src + size_t(x) * 3;
+				dst[x * 4 + 0] = pixel[0];
+				dst[x * 4 + 1] = pixel[1];
+				dst[x * 4 + 2] = pixel[2];
+				dst[x * 4 + 3] = 255;
+			}
+			break;
+		case Palette:
+			for (uint32_t x = 0; x < width; x++) {
+				std::memcpy(dst + size_t(x) * 4, palette.data() + size_t(src[x]) * 4, 4);
+			}
+			break;
+		default:
+			std::memcpy(dst, src, size_t(width) * 4);
+			break;
+	}
+}
+
+/**
+ * Returns sample \p i of a row that was not normalized yet.
+ */
+auto ReadSample(const uint8_t* src, size_t i, uint8_t bit_depth) -> uint32_t
+{
+	if (bit_depth == 16) {
+		return ReadBE16(src + i * 2);
+	}
+	if (bit_depth == 8) {
+		return src[i];
+	}
+	const uint32_t per_byte = 8U / bit_depth;
+	const auto shift = 8U - bit_depth * (uint32_t(i % per_byte) + 1);
+	return (uint32_t(src[i / per_byte]) >> shift) & ((1U << bit_depth) - 1);
+}
+
+/**
+ * Makes the pixels of a gray or RGB row transparent that equal the tRNS color key. The
+ * samples are compared at the bit depth of the file, before they are normalized to 8 bit.
+ */
+void ApplyColorKey(
+	const uint8_t* src, uint8_t* dst, uint32_t width, uint32_t channels, uint8_t bit_depth,
+	const std::array<uint32_t, 3>& color_key
+)
+{
+	for (uint32_t x = 0; x < width; x++) {
+		bool transparent = true;
+		for (uint32_t c = 0; c < channels && transparent; c++) {
+			transparent = ReadSample(src, size_t(x) * channels + c, bit_depth) == color_key[c];
+		}
+		if (transparent) {
+			dst[x * 4 + 3] = 0;
+		}
+	}
+}
+
+/**
+ * Converts samples of 1, 2, 4 or 16 bit to 8 bit. Sub-byte gray values are scaled to the
+ * full range, palette indices are kept.
+ */
+void NormalizeSamples(
+	const uint8_t* src, uint8_t* dst, size_t sample_count, uint8_t bit_depth, bool scale
+)
+{
+	if (bit_depth == 16) {
+		for (size_t i = 0; i < sample_count; i++) {
+			dst[i] = src[i * 2];
+		}
+		return;
+	}
+
+	const uint32_t mask = (1U << bit_depth) - 1;
+	const uint32_t factor = scale ? 255 / mask : 1;
+	const uint32_t per_byte = 8 / bit_depth;
+	for (size_t i = 0; i < sample_count; i++) {
+		const auto shift = 8 - bit_depth * (uint32_t(i % per_byte) + 1);
+		dst[i] = uint8_t(((src[i / per_byte] >> shift) & mask) * factor);
+	}
+}
+
+} // namespace
+
+
+template <class Fn>
+void ImageDecoder::ForRows(utils::ThreadPool* thread_pool, uint32_t row_count, const Fn& fn)
+{
+	if (thread_pool == nullptr || row_count < 2 * MIN_ROWS_PER_TASK) {
+		fn(0, size_t(row_count));
+		return;
+	}
+	const auto chunk_count = std::min(
+		thread_pool->GetThreadCount(), size_t(row_count / MIN_ROWS_PER_TASK)
+	);
+	thread_pool->ParallelFor(
+		row_count, chunk_count,
+		[&fn](size_t begin, size_t end, size_t /*chunk*/) { fn(begin, end); }
+	);
+}
+
+
+auto ImageDecoder::DecodePng(
+	const uint8_t* data, size_t size, Image& image, utils::ThreadPool* thread_pool
+) -> bool
+{
+	if (size < PNG_SIGNATURE.size()
+		|| std::memcmp(data, PNG_SIGNATURE.data(), PNG_SIGNATURE.size()) != 0) {
+		return false;
+	}
+
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+	uint8_t bit_depth{ 0 };
+	uint8_t color_type{ 0 };
+	bool has_gamma{ false };
+	bool has_srgb{ false };
+	uint32_t gamma{ 0 };
+
+	std::array<uint8_t, 1024> palette{};
+	bool has_color_key{ false };
+	std::array<uint32_t, 3> color_key{};
+
+	// Most encoders split the compressed data into several IDAT chunks, which have to be
+	// joined before they can be decompressed
+	std::vector<uint8_t> compressed;
+
+	size_t offset = PNG_SIGNATURE.size();
+	bool found_end = false;
+	while (!found_end) {
+		if (size - offset < 12) {
+			return false;
+		}
+		const auto length = ReadBE32(data + offset);
+		const auto* type = data + offset + 4;
+		const auto* chunk = data + offset + 8;
+		if (size - offset - 12 < length) {
+			return false;
+		}
+		offset += size_t(length) + 12;
+
+		// A damaged ancillary chunk only loses its information, bit 5 of the first letter
+		// is clear for critical chunks
+		if (Crc32(type, size_t(length) + 4) != ReadBE32(chunk + length)) {
+			if ((type[0] & 0x20U) == 0) {
+				return false;
+			}
+			continue;
+		}
+
+		if (std::memcmp(type, "IHDR", 4) == 0) {
+			if (length != 13) {
+				return false;
+			}
+			width = ReadBE32(chunk);
+			height = ReadBE32(chunk + 4);
+			// Checked before anything is allocated for the image
+			if (width > MAX_DIMENSION || height > MAX_DIMENSION) {
+				return false;
+			}
+			bit_depth = chunk[8];
+			color_type = chunk[9];
+			// Compression and filter method have to be 0, interlacing is not supported
+			if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0) {
+				return false;
+			}
+		}
+		else if (std::memcmp(type, "PLTE", 4) == 0) {
+			for (uint32_t i = 0; i < length / 3 && i < 256; i++) {
+				palette[i * 4 + 0] = chunk[i * 3 + 0];
+				palette[i * 4 + 1] = chunk[i * 3 + 1];
+				palette[i * 4 + 2] = chunk[i * 3 + 2];
+				palette[i * 4 + 3] = 255;
+			}
+		}
+		else if (std::memcmp(type, "tRNS", 4) == 0) {
+			if (color_type == Palette) {
+				for (uint32_t i = 0; i < length && i < 256; i++) {
+					palette[i * 4 + 3] = chunk[i];
+				}
+			}
+			else if (color_type == Gray && length >= 2) {
+				// Color keys are always stored with 16 bits
+				has_color_key = true;
+				color_key[0] = ReadBE16(chunk);
+			}
+			else if (color_type == Rgb && length >= 6) {
+				has_color_key = true;
+				color_key = { ReadBE16(chunk), ReadBE16(chunk + 2), ReadBE16(chunk + 4) };
+			}
+		}
+		else if (std::memcmp(type, "gAMA", 4) == 0 && length == 4) {
+			has_gamma = true;
+			gamma = ReadBE32(chunk);
+		}
+		else if (std::memcmp(type, "sRGB", 4) == 0) {
+			has_srgb = true;
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), chunk, chunk + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0) {
+			found_end = true;
+		}
+	}
+
+	const auto channels = GetChannelCount(color_type);
+	const bool valid_depth = (bit_depth == 8)
+		|| (bit_depth == 16 && color_type != Palette)
+		|| ((bit_depth == 1 || bit_depth == 2 || bit_depth == 4)
+			&& (color_type == Gray || color_type == Palette));
+	if (width == 0 || height == 0 || channels == 0 || !valid_depth || compressed.empty()) {
+		return false;
+	}
+
+	const auto bits_per_pixel = uint64_t(channels) * bit_depth;
+	const auto row_bytes = size_t((uint64_t(width) * bits_per_pixel + 7) / 8);
+	const auto bpp = uint32_t(std::max<uint64_t>(bits_per_pixel / 8, 1));
+
+	// Every row is prefixed with its filter type
+	std::vector<uint8_t> raw;
+	raw.reserve((row_bytes + 1) * height);
+	if (!Inflater::Decompress(compressed.data(), compressed.size(), raw, true)
+		|| raw.size() < (row_bytes + 1) * height) {
+		return false;
+	}
+
+	const uint8_t* prior = nullptr;
+	for (uint32_t y = 0; y < height; y++) {
+		auto* row = raw.data() + y * (row_bytes + 1);
+		if (!UnfilterRow(row[0], row + 1, prior, row_bytes, bpp)) {
+			return false;
+		}
+		prior = row + 1;
+	}
+
+	// Without any color information the image is assumed to be sRGB, only an explicit
+	// linear gamma (1.0) marks it as linear data
+	constexpr uint32_t LINEAR_GAMMA = 100000;
+	image.srgb = has_srgb || !has_gamma || gamma != LINEAR_GAMMA;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(size_t(width) * height * 4);
+
+	const bool normalize = bit_depth != 8;
+	ForRows(thread_pool, height, [&](size_t begin, size_t end) {
+		std::vector<uint8_t> samples(normalize ? size_t(width) * channels : 0);
+		for (size_t y = begin; y < end; y++) {
+			const auto* raw_row = raw.data() + y * (row_bytes + 1) + 1;
+			const auto* src = raw_row;
+			if (normalize) {
+				NormalizeSamples(
+					src, samples.data(), samples.size(), bit_depth, color_type != Palette
+				);
+				src = samples.data();
+			}
+			auto* dst = image.pixels.data() + y * width * 4;
+			ConvertPngRow(src, dst, width, color_type, palette);
+			if (has_color_key) {
+				ApplyColorKey(raw_row, dst, width, channels, bit_depth, color_key);
+			}
+		}
+	});
+	return true;
+}
+
+
+auto ImageDecoder::DecodeTga(
+	const uint8_t* data, size_t size, Image& image, utils::ThreadPool* thread_pool
+) -> bool
+{
+	constexpr size_t HEADER_SIZE = 18;
+	if (size < HEADER_SIZE) {
+		return false;
+	}
+
+	const auto id_length = data[0];
+	const auto color_map_type = data[1];
+	const auto image_type = data[2];
+	const auto color_map_first = ReadLE16(data + 3);
+	const auto color_map_length = ReadLE16(data + 5);
+	const auto color_map_bits = data[7];
+	const auto width = ReadLE16(data + 12);
+	const auto height = ReadLE16(data + 14);
+	const auto pixel_bits = data[16];
+	const auto descriptor = data[17];
+
+	// 1/9: color mapped, 2/10: true color, 3/11: gray, the higher numbers are RLE encoded
+	const bool rle = image_type >= 9;
+	const auto base_type = uint8_t(rle ? image_type - 8 : image_type);
+	const bool mapped = base_type == 1;
+	if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION
+		|| base_type < 1 || base_type > 3
+		|| (mapped && (color_map_type != 1 || pixel_bits != 8
+			|| (color_map_bits != 24 && color_map_bits != 32)))
+		|| (base_type == 2 && pixel_bits != 24 && pixel_bits != 32)
+		|| (base_type == 3 && pixel_bits != 8)) {
+		return false;
+	}
+
+	size_t offset = HEADER_SIZE + id_length;
+	const size_t color_map_bytes = color_map_type == 1
+		? size_t(color_map_length) * ((color_map_bits + 7) / 8) : 0;
+	if (size < offset + color_map_bytes) {
+		return false;
+	}
+
+	// Color map entries are BGR(A), they are converted to RGBA once
+	std::array<uint8_t, 1024> palette{};
+	if (mapped) {
+		const uint32_t entry_bytes = color_map_bits / 8;
+		for (uint32_t i = 0; i < color_map_length && color_map_first + i < 256; i++) {
+			const auto* entry = data + offset + size_t(i) * entry_bytes;
+			auto* dst = palette.data() + size_t(color_map_first + i) * 4;
+			dst[0] = entry[2];
+			dst[1] = entry[1];
+			dst[2] = entry[0];
+			dst[3] = entry_bytes == 4 ? entry[3] : 255;
+		}
+	}
+	offset += color_map_bytes;
+
+	const uint32_t pixel_bytes = pixel_bits / 8;
+	const size_t image_bytes = size_t(width) * height * pixel_bytes;
+
+	// RLE packets can span rows, so they are expanded up front on one thread
+	const uint8_t* pixels = data + offset;
+	std::vector<uint8_t> expanded;
+	if (rle) {
+		expanded.resize(image_bytes);
+		size_t pos = 0;
+		while (pos < image_bytes) {
+			if (offset >= size) {
+				return false;
+			}
+			const auto packet = data[offset++];
+			const size_t count = size_t(packet & 0x7FU) + 1;
+			const size_t bytes = std::min(count * pixel_bytes, image_bytes - pos);
+			if ((packet & 0x80U) != 0) {
+				if (size - offset < pixel_bytes) {
+					return false;
+				}
+				// The header check leaves 1, 3 and 4 byte pixels
+				auto* dst = expanded.data() + pos;
+				switch (pixel_bytes)
+				{
+					case 1:
+						std::memset(dst, data[offset], bytes);
+						break;
+					case 3:
+						FillRun<3>(dst, data + offset, bytes);
+						break;
+					default:
+						FillRun<4>(dst, data + offset, bytes);
+						break;
+				}
+				offset += pixel_bytes;
+			}
+			else {
+				if (size - offset < bytes) {
+					return false;
+				}
+				std::memcpy(expanded.data() + pos, data + offset, bytes);
+				offset += bytes;
+			}
+			pos += bytes;
+		}
+		pixels = expanded.data();
+	}
+	else if (size - offset < image_bytes) {
+		return false;
+	}
+
+	image.width = width;
+	image.height = height;
+	image.srgb = true;
+	image.pixels.resize(size_t(width) * height * 4);
+
+	// Without alpha bits in the descriptor the fourth channel carries no alpha
+	const bool opaque = pixel_bits == 32 && (descriptor & 0x0FU) == 0;
+	// Rows are stored bottom up unless the origin is at the top
+	const bool top_origin = (descriptor & 0x20U) != 0;
+	const size_t src_pitch = size_t(width) * pixel_bytes;
+
+	ForRows(thread_pool, height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			const auto src_y = top_origin ? y : height - 1 - y;
+			const auto* src = pixels + src_y * src_pitch;
+			auto* dst = image.pixels.data() + y * width * 4;
+
+			if (mapped) {
+				for (uint32_t x = 0; x < width; x++) {
+					std::memcpy(dst + size_t(x) * 4, palette.data() + size_t(src[x]) * 4, 4);
+				}
+			}
+			else if (pixel_bits == 8) {
+				ExpandGray(src, dst, width);
+			}
+			else if (pixel_bits == 32) {
+				SwizzleBgra(src, dst, width);
+				if (opaque) {
+					for (uint32_t x = 0; x < width; x++) {
+						dst[x * 4 + 3] = 255;
+					}
+				}
+			}
+			else {
+				for (uint32_t x = 0; x < width; x++) {
+					dst[x * 4 + 0] = src[x * 3 + 2];
+					dst[x * 4 + 1] = src[x * 3 + 1];
+					dst[x * 4 + 2] = src[x * 3 + 0];
+					dst[x * 4 + 3] = 255;
+				}
+			}
+		}
+	});
+	return true;
+}
+
+
+auto ImageDecoder::UnfilterRow(
+	uint8_t filter, uint8_t* row, const uint8_t* prior, size_t row_bytes, uint32_t bpp
+) -> bool
+{
+	if (filter > 4) {
+		return false;
+	}
+	// Without a previous row all filters that use it see zeros
+	std::vector<uint8_t> zeros;
+	if (prior == nullptr && filter >= 2) {
+		zeros.resize(row_bytes, 0);
+		prior = zeros.data();
+	}
+
+	switch (filter)
+	{
+		case 0:
+			return true;
+		case 2:
+		{
+			size_t i = 0;
+#ifdef IMAGE_DECODER_SSE2
+			for (; i + 16 <= row_bytes; i += 16) {
+				const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+				const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+			}
+#endif
+			for (; i < row_bytes; i++) {
+				row[i] = uint8_t(row[i] + prior[i]);
+			}
+			return true;
+		}
+		default:
+#ifdef IMAGE_DECODER_SSE2
+			if (bpp == 3 && row_bytes % 3 == 0) {
+				UnfilterRowSse2<3>(filter, row, prior, row_bytes);
+				return true;
+			}
+			if (bpp == 4 && row_bytes % 4 == 0) {
+				UnfilterRowSse2<4>(filter, row, prior, row_bytes);
+				return true;
+			}
+#endif
+			return UnfilterRowScalar(filter, row, prior, row_bytes, bpp);
+	}
+}
+
+
+auto ImageDecoder::UnfilterRowScalar(
+	uint8_t filter, uint8_t* row, const uint8_t* prior, size_t row_bytes, uint32_t bpp
+) -> bool
+{
+	std::vector<uint8_t> zeros;
+	if (prior == nullptr) {
+		zeros.resize(row_bytes, 0);
+		prior = zeros.data();
+	}
+
+	switch (filter)
+	{
+		case 0:
+			break;
+		case 1:
+			for (size_t i = bpp; i < row_bytes; i++) {
+				row[i] = uint8_t(row[i] + row[i - bpp]);
+			}
+			break;
+		case 2:
+			for (size_t i = 0; i < row_bytes; i++) {
+				row[i] = uint8_t(row[i] + prior[i]);
+			}
+			break;
+		case 3:
+			for (size_t i = 0; i < row_bytes; i++) {
+				const uint32_t a = i >= bpp ? row[i - bpp] : 0;
+				row[i] = uint8_t(row[i] + ((a + prior[i]) >> 1U));
+			}
+			break;
+		case 4:
+			for (size_t i = 0; i < row_bytes; i++) {
+				const int32_t a = i >= bpp ? row[i - bpp] : 0;
+				const int32_t c = i >= bpp ? prior[i - bpp] : 0;
+				row[i] = uint8_t(row[i] + PaethPredictor(a, prior[i], c));
+			}
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+
+void ImageDecoder::SwizzleBgra(const uint8_t* src, uint8_t* dst, size_t pixel_count)
+{
+	size_t i = 0;
+#ifdef IMAGE_DECODER_SSE2
+	// Keep G and A, exchange the bytes of B and R inside every 32 bit pixel
+	const auto mask_ga = _mm_set1_epi32(int32_t(0xFF00FF00U));
+	const auto mask_low = _mm_set1_epi32(0x000000FF);
+	for (; i + 4 <= pixel_count; i += 4) {
+		const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		const auto ga = _mm_and_si128(x, mask_ga);
+		const auto r = _mm_and_si128(_mm_srli_epi32(x, 16), mask_low);
+		const auto b = _mm_slli_epi32(_mm_and_si128(x, mask_low), 16);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(ga, _mm_or_si128(r, b))
+		);
+	}
+#endif
+	SwizzleBgraScalar(src + i * 4, dst + i * 4, pixel_count - i);
+}
+
+
+void ImageDecoder::SwizzleBgraScalar(const uint8_t* src, uint8_t* dst, size_t pixel_count)
+{
+	for (size_t i = 0; i < pixel_count; i++) {
+		const auto b = src[i * 4 + 0];
+		const auto r = src[i * 4 + 2];
+		dst[i * 4 + 0] = r;
+		dst[i * 4 + 1] = src[i * 4 + 1];
+		dst[i * 4 + 2] = b;
+		dst[i * 4 + 3] = src[i * 4 + 3];
+	}
+}
+
+
+void ImageDecoder::ExpandGray(const uint8_t* src, uint8_t* dst, size_t pixel_count)
+{
+	size_t i = 0;
+#ifdef IMAGE_DECODER_SSE2
+	const auto alpha = _mm_set1_epi32(int32_t(0xFF000000U));
+	for (; i + 16 <= pixel_count; i += 16) {
+		const auto g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const auto gg_lo = _mm_unpacklo_epi8(g, g);
+		const auto gg_hi = _mm_unpackhi_epi8(g, g);
+		auto* out = reinterpret_cast<__m128i*>(dst + i * 4);
+		_mm_storeu_si128(out + 0, _mm_or_si128(_mm_unpacklo_epi16(gg_lo, gg_lo), alpha));
+		_mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(gg_lo, gg_lo), alpha));
+		_mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(gg_hi, gg_hi), alpha));
+		_mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(gg_hi, gg_hi), alpha));
+	}
+#endif
+	for (; i < pixel_count; i++) {
+		dst[i * 4 + 0] = src[i];
+		dst[i * 4 + 1] = src[i];
+		dst[i * 4 + 2] = src[i];
+		dst[i * 4 + 3] = 255;
+	}
+}
+
+} // namespace io
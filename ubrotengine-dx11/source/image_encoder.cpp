@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: image_encoder.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/image_encoder.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+constexpr std::array<uint8_t, 8> PNG_SIGNATURE = { 137, 80, 78, 71, 13, 10, 26, 10 };
+constexpr uint8_t PNG_FILTER_SUB = 1;
+constexpr uint32_t RGBA_BYTES = 4;
+
+// Window and match limits of DEFLATE
+constexpr size_t WINDOW_SIZE = 32768;
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = 258;
+constexpr uint32_t HASH_BITS = 15;
+constexpr uint32_t END_OF_BLOCK = 256;
+
+constexpr std::array<uint16_t, 29> LENGTH_BASE = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::array<uint8_t, 29> LENGTH_EXTRA = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::array<uint16_t, 30> DIST_BASE = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::array<uint8_t, 30> DIST_EXTRA = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+constexpr auto CRC_TABLE = [] {
+	std::array<uint32_t, 256> table{};
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 1U) != 0 ? 0xEDB88320U ^ (crc >> 1U) : crc >> 1U;
+		}
+		table[i] = crc;
+	}
+	return table;
+}();
+
+auto Crc32(const uint8_t* data, size_t size, uint32_t crc) -> uint32_t
+{
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = CRC_TABLE[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8U);
+	}
+	return ~crc;
+}
+
+auto Adler32(const uint8_t* data, size_t size) -> uint32_t
+{
+	// Largest block for which the sums can not overflow
+	constexpr size_t NMAX = 5552;
+	constexpr uint32_t MOD = 65521;
+
+	uint32_t a = 1;
+	uint32_t b = 0;
+	while (size > 0) {
+		const auto block = size < NMAX ? size : NMAX;
+		for (size_t i = 0; i < block; i++) {
+			a += data[i];
+			b += a;
+		}
+		a %= MOD;
+		b %= MOD;
+		data += block;
+		size -= block;
+	}
+	return (b << 16U) | a;
+}
+
+void WriteBE32(std::vector<uint8_t>& dst, uint32_t value)
+{
+	dst.push_back(uint8_t(value >> 24U));
+	dst.push_back(uint8_t(value >> 16U));
+	dst.push_back(uint8_t(value >> 8U));
+	dst.push_back(uint8_t(value));
+}
+
+void WriteChunk(
+	std::vector<uint8_t>& dst, const char* type, const uint8_t* data, size_t size
+)
+{
+	WriteBE32(dst, uint32_t(size));
+	const auto start = dst.size();
+	dst.insert(dst.end(), type, type + 4);
+	dst.insert(dst.end(), data, data + size);
+	WriteBE32(dst, Crc32(dst.data() + start, dst.size() - start, 0));
+}
+
+/**
+ * Writes bits starting at the least significant bit of each byte, as DEFLATE expects.
+ */
+class BitWriter
+{
+
+public:
+	explicit BitWriter(std::vector<uint8_t>& dst) :
+		m_dst(dst)
+	{
+	}
+
+	void Write(uint32_t value, uint32_t count)
+	{
+		m_buffer |= uint64_t(value) << m_count;
+		m_count += count;
+		while (m_count >= 8) {
+			m_dst.push_back(uint8_t(m_buffer));
+			m_buffer >>= 8U;
+			m_count -= 8;
+		}
+	}
+
+	/**
+	 * Huffman codes are stored starting at their most significant bit.
+	 */
+	void WriteCode(uint32_t code, uint32_t length)
+	{
+		uint32_t reversed = 0;
+		for (uint32_t i = 0; i < length; i++) {
+			reversed |= ((code >> i) & 1U) << (length - 1 - i);
+		}
+		Write(reversed, length);
+	}
+
+	void Flush()
+	{
+		if (m_count > 0) {
+			m_dst.push_back(uint8_t(m_buffer));
+		}
+		m_buffer = 0;
+		m_count = 0;
+	}
+
+private:
+	std::vector<uint8_t>& m_dst;
+	uint64_t m_buffer{ 0 };
+	uint32_t m_count{ 0 };
+};
+
+/**
+ * Writes a literal/length symbol with the fixed Huffman code.
+ */
+void WriteFixedSymbol(BitWriter& writer, uint32_t symbol)
+{
+	if (symbol < 144) {
+		writer.WriteCode(0x30 + symbol, 8);
+	}
+	else if (symbol < 256) {
+		writer.WriteCode(0x190 + symbol - 144, 9);
+	}
+	else if (symbol < 280) {
+		writer.WriteCode(symbol - 256, 7);
+	}
+	else {
+		writer.WriteCode(0xC0 + symbol - 280, 8);
+	}
+}
+
+void WriteMatch(BitWriter& writer, uint32_t length, uint32_t distance)
+{
+	uint32_t code = 0;
+	while (code + 1 < LENGTH_BASE.size() && LENGTH_BASE[code + 1] <= length) {
+		code++;
+	}
+	WriteFixedSymbol(writer, 257 + code);
+	writer.Write(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+	code = 0;
+	while (code + 1 < DIST_BASE.size() && DIST_BASE[code + 1] <= distance) {
+		code++;
+	}
+	writer.WriteCode(code, 5);
+	writer.Write(distance - DIST_BASE[code], DIST_EXTRA[code]);
+}
+
+auto Hash(const uint8_t* data) -> uint32_t
+{
+	const auto value = uint32_t(data[0]) | (uint32_t(data[1]) << 8U) | (uint32_t(data[2]) << 16U);
+	return (value * 2654435761U) >> (32U - HASH_BITS);
+}
+
+} // namespace
+
+
+auto ImageEncoder::EncodePng(const Image& image) -> std::vector<uint8_t>
+{
+	const size_t row_bytes = size_t(image.width) * RGBA_BYTES;
+
+	// Sub filter: every byte minus the same channel of the pixel to its left
+	std::vector<uint8_t> filtered((row_bytes + 1) * image.height);
+	for (uint32_t y = 0; y < image.height; y++) {
+		const auto* row = image.pixels.data() + y * row_bytes;
+		auto* out = filtered.data() + y * (row_bytes + 1);
+		out[0] = PNG_FILTER_SUB;
+		std::memcpy(out + 1, row, std::min<size_t>(row_bytes, RGBA_BYTES));
+		for (size_t i = RGBA_BYTES; i < row_bytes; i++) {
+			out[1 + i] = uint8_t(row[i] - row[i - RGBA_BYTES]);
+		}
+	}
+
+	std::vector<uint8_t> png(PNG_SIGNATURE.begin(), PNG_SIGNATURE.end());
+
+	// Width, height, 8 bit depth, RGBA, deflate, adaptive filtering, not interlaced
+	std::vector<uint8_t> header;
+	WriteBE32(header, image.width);
+	WriteBE32(header, image.height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+	WriteChunk(png, "IHDR", header.data(), header.size());
+
+	std::vector<uint8_t> compressed;
+	Compress(filtered.data(), filtered.size(), compressed);
+	WriteChunk(png, "IDAT", compressed.data(), compressed.size());
+	WriteChunk(png, "IEND", nullptr, 0);
+	return png;
+}
+
+
+auto ImageEncoder::EncodePpm(const Image& image) -> std::vector<uint8_t>
+{
+	const auto header = "P6\n" + std::to_string(image.width) + " "
+		+ std::to_string(image.height) + "\n255\n";
+	const size_t pixel_count = size_t(image.width) * image.height;
+
+	std::vector<uint8_t> ppm(header.begin(), header.end());
+	ppm.reserve(ppm.size() + pixel_count * 3);
+	for (size_t i = 0; i < pixel_count; i++) {
+		const auto* pixel = image.pixels.data() + i * RGBA_BYTES;
+		ppm.insert(ppm.end(), pixel, pixel + 3);
+	}
+	return ppm;
+}
+
+
+auto ImageEncoder::WriteFile(const std::string& filename, const Image& image) -> bool
+{
+	const bool ppm = filename.size() >= 4
+		&& (filename.compare(filename.size() - 4, 4, ".ppm") == 0
+			|| filename.compare(filename.size() - 4, 4, ".PPM") == 0);
+	const auto data = ppm ? EncodePpm(image) : EncodePng(image);
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+	return !file.fail();
+}
+
+
+void ImageEncoder::Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst)
+{
+	// CMF/FLG: deflate with a 32k window, fastest compression level
+	dst.push_back(0x78);
+	dst.push_back(0x01);
+
+	BitWriter writer(dst);
+	// A single final block with the fixed codes
+	writer.Write(1, 1);
+	writer.Write(1, 2);
+
+	// Last position of every hash of three bytes, the chain of older ones is not kept
+	std::vector<int64_t> head(size_t(1) << HASH_BITS, -1);
+	size_t pos = 0;
+	while (pos < size) {
+		size_t length = 0;
+		size_t distance = 0;
+		if (pos + MIN_MATCH <= size) {
+			const auto hash = Hash(src + pos);
+			const auto candidate = head[hash];
+			head[hash] = int64_t(pos);
+			if (candidate >= 0 && pos - size_t(candidate) <= WINDOW_SIZE) {
+				const auto max_length = std::min(MAX_MATCH, size - pos);
+				const auto* a = src + candidate;
+				const auto* b = src + pos;
+				while (length < max_length && a[length] == b[length]) {
+					length++;
+				}
+				distance = pos - size_t(candidate);
+			}
+		}
+
+		if (length >= MIN_MATCH) {
+			WriteMatch(writer, uint32_t(length), uint32_t(distance));
+			// The skipped positions are still hashed, so later matches can start there
+			for (size_t i = pos + 1; i < pos + length && i + MIN_MATCH <= size; i++) {
+				head[Hash(src + i)] = int64_t(i);
+			}
+			pos += length;
+		}
+		else {
+			WriteFixedSymbol(writer, src[pos]);
+			pos++;
+		}
+	}
+	WriteFixedSymbol(writer, END_OF_BLOCK);
+	writer.Flush();
+
+	WriteBE32(dst, Adler32(src, size));
+}
+
+} // namespace io
@@ -0,0 +1,452 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: inflater.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/inflater.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+constexpr uint32_t MAX_BITS = 15;
+constexpr uint32_t FAST_BITS = 10;
+constexpr uint32_t MAX_LITLEN_CODES = 288;
+constexpr uint32_t MAX_DIST_CODES = 32;
+
+constexpr std::array<uint16_t, 29> LENGTH_BASE = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::array<uint8_t, 29> LENGTH_EXTRA = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::array<uint16_t, 30> DIST_BASE = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::array<uint8_t, 30> DIST_EXTRA = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+// Order in which the code length code lengths are stored
+constexpr std::array<uint8_t, 19> CODE_LENGTH_ORDER = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/**
+ * Canonical Huffman code with a lookup table for short codes. A table entry stores the
+ * code length in the upper 4 bits and the symbol in the lower 12 bits, 0 means the code is
+ * longer than FAST_BITS.
+ */
+struct Huffman
+{
+	std::array<uint16_t, MAX_BITS + 1> counts{};
+	std::array<uint16_t, MAX_LITLEN_CODES> symbols{};
+	std::array<uint16_t, 1U << FAST_BITS> fast{};
+
+	auto Build(const uint8_t* lengths, uint32_t count) -> bool
+	{
+		counts.fill(0);
+		fast.fill(0);
+		for (uint32_t i = 0; i < count; i++) {
+			counts[lengths[i]]++;
+		}
+		counts[0] = 0;
+
+		// Reject over-subscribed codes, incomplete codes are allowed by the format
+		int32_t left = 1;
+		for (uint32_t len = 1; len <= MAX_BITS; len++) {
+			left = (left << 1) - counts[len];
+			if (left < 0) {
+				return false;
+			}
+		}
+
+		std::array<uint16_t, MAX_BITS + 2> offsets{};
+		for (uint32_t len = 1; len <= MAX_BITS; len++) {
+			offsets[len + 1] = offsets[len] + counts[len];
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			if (lengths[i] != 0) {
+				symbols[offsets[lengths[i]]++] = uint16_t(i);
+			}
+		}
+
+		// Fill the lookup table, codes are stored bit reversed in the stream
+		uint32_t code = 0;
+		uint32_t index = 0;
+		for (uint32_t len = 1; len <= FAST_BITS; len++) {
+			for (uint32_t n = 0; n < counts[len]; n++, code++, index++) {
+				uint32_t reversed = 0;
+				for (uint32_t bit = 0; bit < len; bit++) {
+					reversed |= ((code >> bit) & 1U) << (len - 1 - bit);
+				}
+				const auto entry = uint16_t((len << 12U) | symbols[index]);
+				for (uint32_t i = reversed; i < fast.size(); i += 1U << len) {
+					fast[i] = entry;
+				}
+			}
+			code <<= 1U;
+		}
+		return true;
+	}
+};
+
+class BitReader
+{
+
+public:
+	BitReader(const uint8_t* data, size_t size) :
+		m_data{ data },
+		m_end{ data + size }
+	{
+	}
+
+	auto Peek(uint32_t count) -> uint32_t
+	{
+		Refill();
+		return uint32_t(m_bits & ((uint64_t(1) << count) - 1));
+	}
+
+	void Consume(uint32_t count)
+	{
+		m_bits >>= count;
+		m_count -= count;
+	}
+
+	auto Read(uint32_t count) -> uint32_t
+	{
+		const auto value = Peek(count);
+		Consume(count);
+		return value;
+	}
+
+	/**
+	 * Drops the bits up to the next byte boundary.
+	 */
+	void AlignToByte()
+	{
+		Consume(m_count % 8);
+	}
+
+	/**
+	 * Returns the byte position of the next unread bit, only valid after \c AlignToByte.
+	 */
+	auto GetBytePosition() const -> const uint8_t*
+	{
+		// Padding bytes are in the buffer but were never read from the input
+		const auto buffered = m_count / 8;
+		const auto padded = std::min(m_overrun / 8, buffered);
+		return m_data - (buffered - padded);
+	}
+
+	void SetBytePosition(const uint8_t* position)
+	{
+		m_data = position;
+		m_bits = 0;
+		m_count = 0;
+		m_overrun = 0;
+	}
+
+	auto GetEnd() const -> const uint8_t*
+	{
+		return m_end;
+	}
+
+	/**
+	 * Returns true if more bits were consumed than the input contains.
+	 */
+	auto IsOverrun() const -> bool
+	{
+		return m_overrun > m_count;
+	}
+
+private:
+	void Refill()
+	{
+		while (m_count <= 56) {
+			uint64_t byte{ 0 };
+			if (m_data < m_end) {
+				byte = *m_data++;
+			}
+			else {
+				// Pad with zeros, reading them is detected by IsOverrun
+				m_overrun += 8;
+			}
+			m_bits |= byte << m_count;
+			m_count += 8;
+		}
+	}
+
+	const uint8_t* m_data;
+	const uint8_t* m_end;
+	uint64_t m_bits{ 0 };
+	uint32_t m_count{ 0 };
+	uint32_t m_overrun{ 0 };
+};
+
+auto DecodeSymbol(BitReader& reader, const Huffman& huffman) -> int32_t
+{
+	const auto entry = huffman.fast[reader.Peek(MAX_BITS) & ((1U << FAST_BITS) - 1)];
+	if (entry != 0) {
+		reader.Consume(entry >> 12U);
+		return entry & 0xFFF;
+	}
+
+	// Canonical decoding for long codes, one bit at a time
+	const auto bits = reader.Peek(MAX_BITS);
+	int32_t code = 0;
+	int32_t first = 0;
+	int32_t index = 0;
+	for (uint32_t len = 1; len <= MAX_BITS; len++) {
+		code |= int32_t((bits >> (len - 1)) & 1U);
+		const int32_t count = huffman.counts[len];
+		if (code - count < first) {
+			reader.Consume(len);
+			return huffman.symbols[index + (code - first)];
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+auto BuildFixed(Huffman& litlen, Huffman& dist) -> bool
+{
+	std::array<uint8_t, MAX_LITLEN_CODES> lengths{};
+	std::memset(lengths.data(), 8, 144);
+	std::memset(lengths.data() + 144, 9, 112);
+	std::memset(lengths.data() + 256, 7, 24);
+	std::memset(lengths.data() + 280, 8, 8);
+	if (!litlen.Build(lengths.data(), MAX_LITLEN_CODES)) {
+		return false;
+	}
+	std::memset(lengths.data(), 5, MAX_DIST_CODES);
+	return dist.Build(lengths.data(), MAX_DIST_CODES);
+}
+
+auto BuildDynamic(BitReader& reader, Huffman& litlen, Huffman& dist) -> bool
+{
+	const auto litlen_count = reader.Read(5) + 257;
+	const auto dist_count = reader.Read(5) + 1;
+	const auto code_length_count = reader.Read(4) + 4;
+	if (litlen_count > 286 || dist_count > 30) {
+		return false;
+	}
+
+	std::array<uint8_t, 19> code_lengths{};
+	for (uint32_t i = 0; i < code_length_count; i++) {
+		code_lengths[CODE_LENGTH_ORDER[i]] = uint8_t(reader.Read(3));
+	}
+	Huffman code_length_huffman;
+	if (!code_length_huffman.Build(code_lengths.data(), 19)) {
+		return false;
+	}
+
+	// Literal/length and distance code lengths share one run length encoded sequence
+	std::array<uint8_t, MAX_LITLEN_CODES + MAX_DIST_CODES> lengths{};
+	uint32_t index = 0;
+	while (index < litlen_count + dist_count) {
+		const auto symbol = DecodeSymbol(reader, code_length_huffman);
+		if (symbol < 0) {
+			return false;
+		}
+		if (symbol < 16) {
+			lengths[index++] = uint8_t(symbol);
+			continue;
+		}
+
+		uint8_t value = 0;
+		uint32_t repeat = 0;
+		if (symbol == 16) {
+			if (index == 0) {
+				return false;
+			}
+			value = lengths[index - 1];
+			repeat = 3 + reader.Read(2);
+		}
+		else if (symbol == 17) {
+			repeat = 3 + reader.Read(3);
+		}
+		else {
+			repeat = 11 + reader.Read(7);
+		}
+		if (index + repeat > litlen_count + dist_count) {
+			return false;
+		}
+		std::memset(lengths.data() + index, value, repeat);
+		index += repeat;
+	}
+
+	// A block without end of block code can not be decoded
+	if (lengths[256] == 0) {
+		return false;
+	}
+	return litlen.Build(lengths.data(), litlen_count)
+		&& dist.Build(lengths.data() + litlen_count, dist_count);
+}
+
+auto InflateBlock(
+	BitReader& reader, const Huffman& litlen, const Huffman& dist, std::vector<uint8_t>& dst,
+	size_t dst_start
+) -> bool
+{
+	while (true) {
+		const auto symbol = DecodeSymbol(reader, litlen);
+		if (symbol < 0 || reader.IsOverrun()) {
+			return false;
+		}
+		if (symbol < 256) {
+			dst.push_back(uint8_t(symbol));
+			continue;
+		}
+		if (symbol == 256) {
+			return true;
+		}
+
+		const auto length_idx = uint32_t(symbol - 257);
+		if (length_idx >= LENGTH_BASE.size()) {
+			return false;
+		}
+		const auto length = LENGTH_BASE[length_idx] + reader.Read(LENGTH_EXTRA[length_idx]);
+
+		const auto dist_symbol = DecodeSymbol(reader, dist);
+		if (dist_symbol < 0 || dist_symbol >= int32_t(DIST_BASE.size())) {
+			return false;
+		}
+		const auto distance = DIST_BASE[dist_symbol] + reader.Read(DIST_EXTRA[dist_symbol]);
+		if (distance > dst.size() - dst_start) {
+			return false;
+		}
+
+		// Copies may overlap their own output, so the bytes are copied one by one unless
+		// the distance allows a block copy
+		const auto pos = dst.size();
+		dst.resize(pos + length);
+		auto* out = dst.data() + pos;
+		const auto* from = out - distance;
+		if (distance >= length) {
+			std::memcpy(out, from, length);
+		}
+		else {
+			for (uint32_t i = 0; i < length; i++) {
+				out[i] = from[i];
+			}
+		}
+	}
+}
+
+auto Adler32(const uint8_t* data, size_t size) -> uint32_t
+{
+	// Largest block for which the sums can not overflow
+	constexpr size_t NMAX = 5552;
+	constexpr uint32_t MOD = 65521;
+
+	uint32_t a = 1;
+	uint32_t b = 0;
+	while (size > 0) {
+		const auto block = size < NMAX ? size : NMAX;
+		for (size_t i = 0; i < block; i++) {
+			a += data[i];
+			b += a;
+		}
+		a %= MOD;
+		b %= MOD;
+		data += block;
+		size -= block;
+	}
+	return (b << 16U) | a;
+}
+
+} // namespace
+
+
+auto Inflater::Decompress(
+	const uint8_t* src, size_t size, std::vector<uint8_t>& dst, bool zlib
+) -> bool
+{
+	const size_t dst_start = dst.size();
+
+	if (zlib) {
+		// CMF/FLG: deflate with window <= 32k, no preset dictionary, valid check bits
+		if (size < 6 || (src[0] & 0x0F) != 8 || (src[0] >> 4) > 7 || (src[1] & 0x20) != 0
+			|| ((uint32_t(src[0]) << 8U) | src[1]) % 31 != 0) {
+			return false;
+		}
+		src += 2;
+		size -= 2;
+	}
+
+	BitReader reader(src, size);
+	Huffman litlen;
+	Huffman dist;
+
+	bool last = false;
+	while (!last) {
+		last = reader.Read(1) == 1;
+		const auto type = reader.Read(2);
+
+		if (type == 0) {
+			// Stored block
+			reader.AlignToByte();
+			const auto* position = reader.GetBytePosition();
+			if (reader.GetEnd() - position < 4) {
+				return false;
+			}
+			const auto length = uint32_t(position[0]) | (uint32_t(position[1]) << 8U);
+			const auto inverse = uint32_t(position[2]) | (uint32_t(position[3]) << 8U);
+			position += 4;
+			if ((length ^ 0xFFFFU) != inverse || size_t(reader.GetEnd() - position) < length) {
+				return false;
+			}
+			dst.insert(dst.end(), position, position + length);
+			reader.SetBytePosition(position + length);
+		}
+		else if (type == 1) {
+			if (!BuildFixed(litlen, dist) || !InflateBlock(reader, litlen, dist, dst, dst_start)) {
+				return false;
+			}
+		}
+		else if (type == 2) {
+			if (!BuildDynamic(reader, litlen, dist)
+				|| !InflateBlock(reader, litlen, dist, dst, dst_start)) {
+				return false;
+			}
+		}
+		else {
+			return false;
+		}
+	}
+
+	if (zlib) {
+		reader.AlignToByte();
+		const auto* position = reader.GetBytePosition();
+		if (reader.GetEnd() - position < 4) {
+			return false;
+		}
+		const auto expected = (uint32_t(position[0]) << 24U) | (uint32_t(position[1]) << 16U)
+			| (uint32_t(position[2]) << 8U) | uint32_t(position[3]);
+		return expected == Adler32(dst.data() + dst_start, dst.size() - dst_start);
+	}
+	return true;
+}
+
+} // namespace io
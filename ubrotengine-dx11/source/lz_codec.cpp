@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: lz_codec.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/lz_codec.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define LZ_CODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+constexpr size_t MIN_MATCH = 4;
+// The block always ends with literals, no match may reach into the last bytes
+constexpr size_t LAST_LITERALS = 5;
+// No match starts in the last bytes, so reading a whole word at a candidate is safe
+constexpr size_t MATCH_START_LIMIT = 12;
+constexpr uint32_t HASH_BITS = 14;
+// Bytes that are copied at once by the decoder
+constexpr size_t CHUNK = 16;
+
+auto Read32(const uint8_t* src) -> uint32_t
+{
+	uint32_t value{ 0 };
+	std::memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+auto Read64(const uint8_t* src) -> uint64_t
+{
+	uint64_t value{ 0 };
+	std::memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+auto Hash(uint32_t sequence) -> uint32_t
+{
+	return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+/**
+ * Returns the number of equal bytes at \p a and \p b, comparing at most up to \p a_end.
+ */
+auto CountEqual(const uint8_t* a, const uint8_t* b, const uint8_t* a_end) -> size_t
+{
+	const uint8_t* const start = a;
+	while (a + sizeof(uint64_t) <= a_end) {
+		const auto diff = Read64(a) ^ Read64(b);
+		if (diff != 0) {
+			// Words are read little endian, the lowest set bit is the first difference
+			return size_t(a - start) + size_t(std::countr_zero(diff) / 8);
+		}
+		a += sizeof(uint64_t);
+		b += sizeof(uint64_t);
+	}
+	while (a < a_end && *a == *b) {
+		a++;
+		b++;
+	}
+	return size_t(a - start);
+}
+
+/**
+ * Writes the part of a length that does not fit into its token nibble.
+ */
+void WriteLength(std::vector<uint8_t>& dst, size_t length)
+{
+	for (; length >= 255; length -= 255) {
+		dst.push_back(255);
+	}
+	dst.push_back(uint8_t(length));
+}
+
+/**
+ * Appends a sequence, a \p match_length of 0 writes the closing sequence without a match.
+ */
+void WriteSequence(
+	std::vector<uint8_t>& dst, const uint8_t* literals, size_t literal_count, size_t offset,
+	size_t match_length
+)
+{
+	const auto match_code = match_length > 0 ? match_length - MIN_MATCH : 0;
+	const auto token = std::min<size_t>(literal_count, 15) << 4 | std::min<size_t>(match_code, 15);
+	dst.push_back(uint8_t(token));
+	if (literal_count >= 15) {
+		WriteLength(dst, literal_count - 15);
+	}
+	dst.insert(dst.end(), literals, literals + literal_count);
+
+	if (match_length == 0) {
+		return;
+	}
+	dst.push_back(uint8_t(offset));
+	dst.push_back(uint8_t(offset >> 8));
+	if (match_code >= 15) {
+		WriteLength(dst, match_code - 15);
+	}
+}
+
+auto ReadLength(const uint8_t*& src, const uint8_t* src_end, size_t& length) -> bool
+{
+	uint8_t byte{ 0 };
+	do {
+		if (src == src_end) {
+			return false;
+		}
+		byte = *src++;
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+void Copy16(uint8_t* dst, const uint8_t* src)
+{
+#ifdef LZ_CODEC_SSE2
+	_mm_storeu_si128(
+		reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))
+	);
+#else
+	std::memcpy(dst, src, CHUNK);
+#endif
+}
+
+/**
+ * Copies \p size bytes in whole chunks, so up to CHUNK - 1 bytes after \p dst + \p size are
+ * overwritten. The source has to be in another buffer or at least CHUNK bytes before the
+ * destination.
+ */
+void WildCopy(uint8_t* dst, const uint8_t* src, size_t size)
+{
+	const uint8_t* const end = dst + size;
+	do {
+		Copy16(dst, src);
+		dst += CHUNK;
+		src += CHUNK;
+	} while (dst < end);
+}
+
+} // namespace
+
+
+void LzCodec::Compress(const uint8_t* src, size_t size, std::vector<uint8_t>& dst)
+{
+	assert(size <= MAX_BLOCK_SIZE);
+	dst.reserve(dst.size() + GetBound(size));
+
+	// Last position of each hashed word, blocks are small enough for 16 bit positions
+	std::array<uint16_t, size_t(1) << HASH_BITS> table{};
+	size_t anchor{ 0 };
+
+	if (size > MATCH_START_LIMIT) {
+		const size_t start_limit = size - MATCH_START_LIMIT;
+		const uint8_t* const match_end = src + size - LAST_LITERALS;
+
+		size_t pos{ 0 };
+		while (pos <= start_limit) {
+			const auto sequence = Read32(src + pos);
+			auto& slot = table[Hash(sequence)];
+			size_t ref = slot;
+			slot = uint16_t(pos);
+
+			if (ref >= pos || Read32(src + ref) != sequence) {
+				// Skip faster through data that does not compress
+				pos += 1 + ((pos - anchor) >> 6);
+				continue;
+			}
+
+			const auto offset = pos - ref;
+			const auto end = pos + MIN_MATCH
+				+ CountEqual(src + pos + MIN_MATCH, src + ref + MIN_MATCH, match_end);
+			// The match may also start earlier, as long as it does not cross the literals
+			while (pos > anchor && ref > 0 && src[pos - 1] == src[ref - 1]) {
+				pos--;
+				ref--;
+			}
+
+			WriteSequence(dst, src + anchor, pos - anchor, offset, end - pos);
+			pos = end;
+			anchor = end;
+
+			// Remember a position inside the match, repeated data is found again sooner
+			if (pos - 2 <= start_limit) {
+				table[Hash(Read32(src + pos - 2))] = uint16_t(pos - 2);
+			}
+		}
+	}
+
+	WriteSequence(dst, src + anchor, size - anchor, 0, 0);
+}
+
+
+auto LzCodec::Decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t dst_size)
+	-> bool
+{
+	const uint8_t* const src_end = src + size;
+	uint8_t* out = dst;
+	uint8_t* const dst_end = dst + dst_size;
+
+	while (src < src_end) {
+		const uint32_t token = *src++;
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(src, src_end, literals)) {
+			return false;
+		}
+		const auto src_left = size_t(src_end - src);
+		const auto dst_left = size_t(dst_end - out);
+		if (src_left < literals || dst_left < literals) {
+			return false;
+		}
+		if (src_left >= literals + CHUNK && dst_left >= literals + CHUNK) {
+			WildCopy(out, src, literals);
+		}
+		else if (literals > 0) {
+			std::memcpy(out, src, literals);
+		}
+		src += literals;
+		out += literals;
+
+		// Only the closing sequence has no match
+		if (src == src_end) {
+			break;
+		}
+		if (src_end - src < 2) {
+			return false;
+		}
+		const size_t offset = size_t(src[0]) | size_t(src[1]) << 8;
+		src += 2;
+		if (offset == 0 || offset > size_t(out - dst)) {
+			return false;
+		}
+
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(src, src_end, length)) {
+			return false;
+		}
+		length += MIN_MATCH;
+		if (size_t(dst_end - out) < length) {
+			return false;
+		}
+
+		const uint8_t* match = out - offset;
+		if (size_t(dst_end - out) < length + CHUNK) {
+			// Close to the end every byte is written exactly once
+			for (size_t i = 0; i < length; i++) {
+				out[i] = match[i];
+			}
+		}
+		else if (offset >= CHUNK) {
+			WildCopy(out, match, length);
+		}
+		else {
+			// A short offset repeats a pattern. Once the first bytes are written, the same
+			// pattern is also found a multiple of its length back that is at least one chunk.
+			const auto period = (CHUNK + offset - 1) / offset * offset;
+			const auto head = std::min(length, period);
+			for (size_t i = 0; i < head; i++) {
+				out[i] = match[i];
+			}
+			if (length > head) {
+				WildCopy(out + head, out + head - period, length - head);
+			}
+		}
+		out += length;
+	}
+
+	return out == dst_end;
+}
+
+
+auto LzCodec::GetBound(size_t size) -> size_t
+{
+	return size + size / 255 + 16;
+}
+
+} // namespace io
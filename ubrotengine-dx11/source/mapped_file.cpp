@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mapped_file.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/mapped_file.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+
+#ifdef _WIN32
+auto MappedFile::Open(const std::string& filename) -> bool
+{
+	Close();
+
+	m_file = CreateFileA(
+		filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+	);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		Close();
+		return false;
+	}
+	m_size = size_t(size.QuadPart);
+	return true;
+}
+
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+	m_data = nullptr;
+	m_size = 0;
+}
+#else
+auto MappedFile::Open(const std::string& filename) -> bool
+{
+	Close();
+
+	m_file = open(filename.c_str(), O_RDONLY);
+	if (m_file < 0) {
+		return false;
+	}
+
+	struct stat file_stat {};
+	if (fstat(m_file, &file_stat) != 0 || file_stat.st_size == 0) {
+		Close();
+		return false;
+	}
+
+	auto* data = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	m_data = static_cast<const uint8_t*>(data);
+	m_size = size_t(file_stat.st_size);
+	return true;
+}
+
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr) {
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+	if (m_file >= 0) {
+		close(m_file);
+	}
+	m_file = -1;
+	m_data = nullptr;
+	m_size = 0;
+}
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto MappedFile::GetData() const -> const uint8_t*
+{
+	return m_data;
+}
+
+
+auto MappedFile::GetSize() const -> size_t
+{
+	return m_size;
+}
+
+} // namespace io
@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: math_types.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/math_types.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cmath>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace math
+{
+
+auto operator+(const Float3& a, const Float3& b) -> Float3
+{
+	return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+
+auto operator-(const Float3& a, const Float3& b) -> Float3
+{
+	return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+
+auto operator*(const Float3& a, float s) -> Float3
+{
+	return { a.x * s, a.y * s, a.z * s };
+}
+
+
+auto operator+(const Float4& a, const Float4& b) -> Float4
+{
+	return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+}
+
+
+auto operator-(const Float4& a, const Float4& b) -> Float4
+{
+	return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+}
+
+
+auto Dot(const Float3& a, const Float3& b) -> float
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+
+auto Cross(const Float3& a, const Float3& b) -> Float3
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+
+auto Length(const Float3& v) -> float
+{
+	return std::sqrt(Dot(v, v));
+}
+
+
+auto Normalize(const Float3& v) -> Float3
+{
+	const float length = Length(v);
+	return length > 0.0F ? v * (1.0F / length) : v;
+}
+
+
+auto PlaneNormalize(const Float4& plane) -> Float4
+{
+	const float length = Length({ plane.x, plane.y, plane.z });
+	if (length <= 0.0F) {
+		return plane;
+	}
+	const float s = 1.0F / length;
+	return { plane.x * s, plane.y * s, plane.z * s, plane.w * s };
+}
+
+
+auto Identity() -> Float4x4
+{
+	Float4x4 result{};
+	for (size_t i = 0; i < 4; i++) {
+		result.m[i][i] = 1.0F;
+	}
+	return result;
+}
+
+
+auto Multiply(const Float4x4& a, const Float4x4& b) -> Float4x4
+{
+	Float4x4 result;
+	for (size_t r = 0; r < 4; r++) {
+		for (size_t c = 0; c < 4; c++) {
+			result.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c]
+				+ a.m[r][2] * b.m[2][c] + a.m[r][3] * b.m[3][c];
+		}
+	}
+	return result;
+}
+
+
+auto Transpose(const Float4x4& matrix) -> Float4x4
+{
+	Float4x4 result;
+	for (size_t r = 0; r < 4; r++) {
+		for (size_t c = 0; c < 4; c++) {
+			result.m[r][c] = matrix.m[c][r];
+		}
+	}
+	return result;
+}
+
+
+auto Inverse(const Float4x4& matrix) -> Float4x4
+{
+	const auto& m = matrix.m;
+
+	// Determinants of the 2x2 sub matrices of the upper and the lower two rows
+	const float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+	const float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+	const float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+	const float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+	const float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+	const float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+	const float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+	const float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+	const float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+	const float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+	const float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+	const float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+	const float inv_det = 1.0F / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+	Float4x4 result;
+	auto& r = result.m;
+	r[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_det;
+	r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv_det;
+	r[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_det;
+	r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv_det;
+
+	r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv_det;
+	r[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_det;
+	r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv_det;
+	r[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_det;
+
+	r[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_det;
+	r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv_det;
+	r[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_det;
+	r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv_det;
+
+	r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv_det;
+	r[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_det;
+	r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv_det;
+	r[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_det;
+	return result;
+}
+
+
+auto Row(const Float4x4& matrix, size_t row) -> Float4
+{
+	const auto& r = matrix.m[row];
+	return { r[0], r[1], r[2], r[3] };
+}
+
+
+auto Column(const Float4x4& matrix, size_t column) -> Float4
+{
+	const auto& m = matrix.m;
+	return { m[0][column], m[1][column], m[2][column], m[3][column] };
+}
+
+
+auto TransformCoord(const Float3& v, const Float4x4& matrix) -> Float3
+{
+	const auto& m = matrix.m;
+	const float x = v.x * m[0][0] + v.y * m[1][0] + v.z * m[2][0] + m[3][0];
+	const float y = v.x * m[0][1] + v.y * m[1][1] + v.z * m[2][1] + m[3][1];
+	const float z = v.x * m[0][2] + v.y * m[1][2] + v.z * m[2][2] + m[3][2];
+	const float w = v.x * m[0][3] + v.y * m[1][3] + v.z * m[2][3] + m[3][3];
+	return { x / w, y / w, z / w };
+}
+
+
+auto Translation(float x, float y, float z) -> Float4x4
+{
+	auto result = Identity();
+	result.m[3] = { x, y, z, 1.0F };
+	return result;
+}
+
+
+auto LookToLH(const Float3& eye, const Float3& direction, const Float3& up) -> Float4x4
+{
+	// The axes of the view space in world space
+	const auto axis_z = Normalize(direction);
+	const auto axis_x = Normalize(Cross(up, axis_z));
+	const auto axis_y = Cross(axis_z, axis_x);
+
+	Float4x4 result;
+	result.m[0] = { axis_x.x, axis_y.x, axis_z.x, 0.0F };
+	result.m[1] = { axis_x.y, axis_y.y, axis_z.y, 0.0F };
+	result.m[2] = { axis_x.z, axis_y.z, axis_z.z, 0.0F };
+	result.m[3] = { -Dot(axis_x, eye), -Dot(axis_y, eye), -Dot(axis_z, eye), 1.0F };
+	return result;
+}
+
+
+auto PerspectiveFovLH(float fov_y, float aspect_ratio, float near_z, float far_z) -> Float4x4
+{
+	const float height = 1.0F / std::tan(fov_y * 0.5F);
+	const float width = height / aspect_ratio;
+	const float range = far_z / (far_z - near_z);
+
+	Float4x4 result{};
+	result.m[0][0] = width;
+	result.m[1][1] = height;
+	result.m[2][2] = range;
+	result.m[2][3] = 1.0F;
+	result.m[3][2] = -range * near_z;
+	return result;
+}
+
+
+auto OrthographicLH(float width, float height, float near_z, float far_z) -> Float4x4
+{
+	const float range = 1.0F / (far_z - near_z);
+
+	Float4x4 result{};
+	result.m[0][0] = 2.0F / width;
+	result.m[1][1] = 2.0F / height;
+	result.m[2][2] = range;
+	result.m[3][2] = -range * near_z;
+	result.m[3][3] = 1.0F;
+	return result;
+}
+
+} // namespace math
@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mip_generator.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/mip_generator.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace io
+{
+
+namespace
+{
+
+// Output rows per parallel task, smaller levels are filtered on the calling thread
+constexpr uint32_t MIN_ROWS_PER_TASK = 32;
+
+// Resolution of the linear to sRGB table
+constexpr uint32_t SRGB_TABLE_SIZE = 4096;
+
+// Kaiser kernel, the taps cover source pixels 2x - 3 to 2x + 4 for output pixel x
+constexpr int32_t KAISER_TAPS = 8;
+constexpr int32_t KAISER_OFFSET = 3;
+constexpr double KAISER_ALPHA = 4.0;
+constexpr double KAISER_WIDTH = 2.0;
+
+struct ColorTables
+{
+	std::array<float, 256> srgb_to_linear{};
+	std::array<float, 256> unorm_to_float{};
+	std::array<uint8_t, SRGB_TABLE_SIZE> linear_to_srgb{};
+	std::array<float, KAISER_TAPS> kaiser{};
+};
+
+// Zeroth order modified Bessel function of the first kind
+auto BesselI0(double x) -> double
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int32_t k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+auto BuildTables() -> ColorTables
+{
+	ColorTables tables;
+	for (uint32_t i = 0; i < 256; i++) {
+		const double c = i / 255.0;
+		tables.unorm_to_float[i] = float(c);
+		tables.srgb_to_linear[i] = float(
+			c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4)
+		);
+	}
+	for (uint32_t i = 0; i < SRGB_TABLE_SIZE; i++) {
+		const double l = double(i) / (SRGB_TABLE_SIZE - 1);
+		const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+		tables.linear_to_srgb[i] = uint8_t(std::lround(std::clamp(c, 0.0, 1.0) * 255.0));
+	}
+
+	// The output pixel center lies between the source pixels 2x and 2x + 1, the distance
+	// is measured in output pixels
+	const double pi = std::acos(-1.0);
+	double total = 0.0;
+	std::array<double, KAISER_TAPS> weights{};
+	for (int32_t i = 0; i < KAISER_TAPS; i++) {
+		const double d = (i - KAISER_OFFSET - 0.5) / 2.0;
+		const double sinc = std::sin(pi * d) / (pi * d);
+		const double r = d / KAISER_WIDTH;
+		const double window = BesselI0(KAISER_ALPHA * std::sqrt(std::max(0.0, 1.0 - r * r)))
+			/ BesselI0(KAISER_ALPHA);
+		weights[i] = sinc * window;
+		total += weights[i];
+	}
+	for (int32_t i = 0; i < KAISER_TAPS; i++) {
+		tables.kaiser[i] = float(weights[i] / total);
+	}
+	return tables;
+}
+
+auto GetTables() -> const ColorTables&
+{
+	static const ColorTables tables = BuildTables();
+	return tables;
+}
+
+#ifdef MIP_GENERATOR_SSE2
+using Pixel = __m128;
+
+auto Zero() -> Pixel
+{
+	return _mm_setzero_ps();
+}
+
+auto Load(const float* src) -> Pixel
+{
+	return _mm_loadu_ps(src);
+}
+
+void Store(float* dst, Pixel pixel)
+{
+	_mm_storeu_ps(dst, pixel);
+}
+
+auto Add(Pixel a, Pixel b) -> Pixel
+{
+	return _mm_add_ps(a, b);
+}
+
+auto Scale(Pixel a, float factor) -> Pixel
+{
+	return _mm_mul_ps(a, _mm_set1_ps(factor));
+}
+#else
+struct Pixel
+{
+	std::array<float, 4> v{};
+};
+
+auto Zero() -> Pixel
+{
+	return {};
+}
+
+auto Load(const float* src) -> Pixel
+{
+	return { { src[0], src[1], src[2], src[3] } };
+}
+
+void Store(float* dst, Pixel pixel)
+{
+	std::copy(pixel.v.begin(), pixel.v.end(), dst);
+}
+
+auto Add(Pixel a, Pixel b) -> Pixel
+{
+	return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } };
+}
+
+auto Scale(Pixel a, float factor) -> Pixel
+{
+	return { { a.v[0] * factor, a.v[1] * factor, a.v[2] * factor, a.v[3] * factor } };
+}
+#endif
+
+/**
+ * Converts one row of RGBA8 pixels to linear floats.
+ */
+void DecodeRow(const uint8_t* src, float* dst, uint32_t width, bool srgb)
+{
+	const auto& tables = GetTables();
+	const auto& color = srgb ? tables.srgb_to_linear : tables.unorm_to_float;
+	const auto& alpha = tables.unorm_to_float;
+	for (uint32_t x = 0; x < width; x++) {
+		dst[0] = color[src[0]];
+		dst[1] = color[src[1]];
+		dst[2] = color[src[2]];
+		dst[3] = alpha[src[3]];
+		src += 4;
+		dst += 4;
+	}
+}
+
+/**
+ * Converts one row of linear floats back to RGBA8 pixels.
+ */
+void EncodeRow(const float* src, uint8_t* dst, uint32_t width, bool srgb)
+{
+	const auto& to_srgb = GetTables().linear_to_srgb;
+	const float color_scale = srgb ? float(SRGB_TABLE_SIZE - 1) : 255.0F;
+
+#ifdef MIP_GENERATOR_SSE2
+	const auto zero = _mm_setzero_ps();
+	const auto one = _mm_set1_ps(1.0F);
+	const auto scale = _mm_setr_ps(color_scale, color_scale, color_scale, 255.0F);
+	for (uint32_t x = 0; x < width; x++) {
+		auto pixel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), zero), one);
+		// Rounds to nearest
+		const auto values = _mm_cvtps_epi32(_mm_mul_ps(pixel, scale));
+		if (srgb) {
+			alignas(16) std::array<int32_t, 4> v{};
+			_mm_store_si128(reinterpret_cast<__m128i*>(v.data()), values);
+			dst[0] = to_srgb[v[0]];
+			dst[1] = to_srgb[v[1]];
+			dst[2] = to_srgb[v[2]];
+			dst[3] = uint8_t(v[3]);
+		}
+		else {
+			const auto packed = _mm_packs_epi32(values, values);
+			const int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+			std::memcpy(dst, &bytes, 4);
+		}
+		src += 4;
+		dst += 4;
+	}
+#else
+	for (uint32_t x = 0; x < width; x++) {
+		for (uint32_t c = 0; c < 3; c++) {
+			const auto v = std::lround(std::clamp(src[c], 0.0F, 1.0F) * color_scale);
+			dst[c] = srgb ? to_srgb[v] : uint8_t(v);
+		}
+		dst[3] = uint8_t(std::lround(std::clamp(src[3], 0.0F, 1.0F) * 255.0F));
+		src += 4;
+		dst += 4;
+	}
+#endif
+}
+
+/**
+ * Filters one decoded source row horizontally with the Kaiser kernel.
+ */
+void FilterRowKaiser(const float* src, float* dst, uint32_t src_width, uint32_t dst_width)
+{
+	const auto& kaiser = GetTables().kaiser;
+	const auto last = int32_t(src_width) - 1;
+	for (uint32_t x = 0; x < dst_width; x++) {
+		const int32_t first = int32_t(x) * 2 - KAISER_OFFSET;
+		auto acc = Zero();
+		if (first >= 0 && first + KAISER_TAPS - 1 <= last) {
+			const float* s = src + size_t(first) * 4;
+			for (int32_t k = 0; k < KAISER_TAPS; k++) {
+				acc = Add(acc, Scale(Load(s + size_t(k) * 4), kaiser[k]));
+			}
+		}
+		else {
+			for (int32_t k = 0; k < KAISER_TAPS; k++) {
+				const auto sx = std::clamp(first + k, 0, last);
+				acc = Add(acc, Scale(Load(src + size_t(sx) * 4), kaiser[k]));
+			}
+		}
+		Store(dst + size_t(x) * 4, acc);
+	}
+}
+
+template <class Fn>
+void ForRows(utils::ThreadPool* thread_pool, uint32_t row_count, const Fn& fn)
+{
+	if (thread_pool == nullptr || row_count < 2 * MIN_ROWS_PER_TASK) {
+		fn(0, size_t(row_count));
+		return;
+	}
+	// More tiles than threads so that uneven tiles even out
+	const auto chunk_count = std::min(
+		thread_pool->GetThreadCount() * 4, size_t(row_count / MIN_ROWS_PER_TASK)
+	);
+	thread_pool->ParallelFor(
+		row_count, chunk_count,
+		[&fn](size_t begin, size_t end, size_t /*chunk*/) { fn(begin, end); }
+	);
+}
+
+} // namespace
+
+
+auto MipGenerator::GetMipCount(uint32_t width, uint32_t height) -> uint32_t
+{
+	uint32_t count = 1;
+	for (auto size = std::max(width, height); size > 1; size >>= 1U) {
+		count++;
+	}
+	return count;
+}
+
+
+void MipGenerator::Generate(
+	const Image& image, MipFilter filter, std::vector<Image>& mips,
+	utils::ThreadPool* thread_pool
+)
+{
+	const auto count = GetMipCount(image.width, image.height);
+	mips.resize(count - 1);
+
+	const Image* src = &image;
+	for (auto& mip : mips) {
+		Downsample(*src, mip, filter, thread_pool);
+		src = &mip;
+	}
+}
+
+
+void MipGenerator::Downsample(
+	const Image& src, Image& dst, MipFilter filter, utils::ThreadPool* thread_pool
+)
+{
+	dst.width = std::max(src.width >> 1U, 1U);
+	dst.height = std::max(src.height >> 1U, 1U);
+	dst.srgb = src.srgb;
+	dst.pixels.resize(size_t(dst.width) * dst.height * 4);
+
+	ForRows(thread_pool, dst.height, [&](size_t begin, size_t end) {
+		if (filter == MipFilter::Kaiser) {
+			DownsampleKaiser(src, dst, begin, end);
+		}
+		else {
+			DownsampleBox(src, dst, begin, end);
+		}
+	});
+}
+
+
+void MipGenerator::DownsampleBox(const Image& src, Image& dst, size_t begin, size_t end)
+{
+	const auto src_row = size_t(src.width) * 4;
+	const auto last_x = src.width - 1;
+	std::vector<float> top(src_row);
+	std::vector<float> bottom(src_row);
+	std::vector<float> out(size_t(dst.width) * 4);
+
+	for (size_t y = begin; y < end; y++) {
+		const auto y0 = std::min(size_t(y * 2), size_t(src.height - 1));
+		const auto y1 = std::min(size_t(y * 2 + 1), size_t(src.height - 1));
+		DecodeRow(src.pixels.data() + y0 * src_row, top.data(), src.width, src.srgb);
+		DecodeRow(src.pixels.data() + y1 * src_row, bottom.data(), src.width, src.srgb);
+
+		for (uint32_t x = 0; x < dst.width; x++) {
+			const auto x0 = size_t(std::min(x * 2, last_x)) * 4;
+			const auto x1 = size_t(std::min(x * 2 + 1, last_x)) * 4;
+			const auto sum = Add(
+				Add(Load(top.data() + x0), Load(top.data() + x1)),
+				Add(Load(bottom.data() + x0), Load(bottom.data() + x1))
+			);
+			Store(out.data() + size_t(x) * 4, Scale(sum, 0.25F));
+		}
+		EncodeRow(out.data(), dst.pixels.data() + y * dst.width * 4, dst.width, dst.srgb);
+	}
+}
+
+
+void MipGenerator::DownsampleKaiser(const Image& src, Image& dst, size_t begin, size_t end)
+{
+	const auto& kaiser = GetTables().kaiser;
+	const auto src_row = size_t(src.width) * 4;
+	const auto dst_row = size_t(dst.width) * 4;
+	const auto last_y = int32_t(src.height) - 1;
+
+	// Horizontally filtered source rows, one slot per vertical tap. The slot of a row is
+	// its unclamped index modulo the tap count, so every row is filtered only once.
+	std::vector<float> ring(dst_row * KAISER_TAPS);
+	std::vector<float> decoded(src_row);
+	std::vector<float> out(dst_row);
+
+	auto next_row = int32_t(begin) * 2 - KAISER_OFFSET;
+	for (size_t y = begin; y < end; y++) {
+		const int32_t first = int32_t(y) * 2 - KAISER_OFFSET;
+		for (; next_row < first + KAISER_TAPS; next_row++) {
+			const auto sy = size_t(std::clamp(next_row, 0, last_y));
+			DecodeRow(src.pixels.data() + sy * src_row, decoded.data(), src.width, src.srgb);
+			const auto slot = size_t((next_row + KAISER_TAPS) % KAISER_TAPS);
+			FilterRowKaiser(decoded.data(), ring.data() + slot * dst_row, src.width, dst.width);
+		}
+
+		for (size_t x = 0; x < dst_row; x += 4) {
+			auto acc = Zero();
+			for (int32_t k = 0; k < KAISER_TAPS; k++) {
+				const auto slot = size_t((first + k + KAISER_TAPS) % KAISER_TAPS);
+				acc = Add(acc, Scale(Load(ring.data() + slot * dst_row + x), kaiser[k]));
+			}
+			Store(out.data() + x, acc);
+		}
+		EncodeRow(out.data(), dst.pixels.data() + y * dst_row, dst.width, dst.srgb);
+	}
+}
+
+} // namespace io
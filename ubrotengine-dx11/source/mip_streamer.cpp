@@ -0,0 +1,261 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: mip_streamer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/mip_streamer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+
+namespace
+{
+
+// Eviction candidate: magnification after the eviction, texture and its current top level
+using Victim = std::tuple<float, uint32_t, uint32_t>;
+using VictimQueue = std::priority_queue<Victim, std::vector<Victim>, std::greater<>>;
+
+} // namespace
+
+
+void MipStreamer::Add(
+	size_t texture_idx, uint32_t size, std::vector<size_t> level_bytes, uint32_t tail_mip
+)
+{
+	if (texture_idx >= m_entries.size()) {
+		m_entries.resize(texture_idx + 1);
+	}
+	auto& entry = m_entries[texture_idx];
+	assert(!entry.added && "texture was added twice");
+	assert(tail_mip < level_bytes.size());
+
+	entry.level_bytes = std::move(level_bytes);
+	entry.size = size;
+	entry.tail_mip = tail_mip;
+	entry.resident_mip = tail_mip;
+	entry.added = true;
+
+	m_stats.resident_bytes += GetBytes(entry, tail_mip, uint32_t(entry.level_bytes.size()));
+	m_stats.textures++;
+}
+
+
+void MipStreamer::SetBudget(size_t bytes)
+{
+	m_stats.budget_bytes = bytes;
+}
+
+
+void MipStreamer::BeginFrame()
+{
+	m_frame++;
+}
+
+
+void MipStreamer::Request(size_t texture_idx, float screen_pixels)
+{
+	if (texture_idx >= m_entries.size() || !m_entries[texture_idx].added) {
+		return;
+	}
+	auto& entry = m_entries[texture_idx];
+	if (entry.last_frame != m_frame) {
+		entry.last_frame = m_frame;
+		entry.screen_pixels = 0.0F;
+	}
+	entry.screen_pixels = std::max(entry.screen_pixels, screen_pixels);
+}
+
+
+void MipStreamer::Update(
+	size_t max_load_bytes, std::vector<Change>& loads, std::vector<Change>& evictions
+)
+{
+	loads.clear();
+	evictions.clear();
+
+	// Textures that miss detail, the most magnified ones first
+	m_candidates.clear();
+	for (uint32_t i = 0; i < uint32_t(m_entries.size()); i++) {
+		const auto& entry = m_entries[i];
+		if (!entry.added || entry.loading_mip != NONE || entry.last_frame != m_frame) {
+			continue;
+		}
+		if (GetDesiredMip(entry.size, entry.tail_mip, entry.screen_pixels) < entry.resident_mip) {
+			m_candidates.push_back(i);
+		}
+	}
+	std::sort(m_candidates.begin(), m_candidates.end(), [this](uint32_t a, uint32_t b) {
+		const auto& ea = m_entries[a];
+		const auto& eb = m_entries[b];
+		return GetMagnification(ea, ea.resident_mip) > GetMagnification(eb, eb.resident_mip);
+	});
+
+	// A lowered budget is met right away, at the cost of any texture
+	MakeRoom(0, INFINITY);
+
+	size_t frame_bytes{ 0 };
+	for (const auto idx : m_candidates) {
+		if (frame_bytes >= max_load_bytes && !loads.empty()) {
+			break;
+		}
+		auto& entry = m_entries[idx];
+		const auto desired = GetDesiredMip(entry.size, entry.tail_mip, entry.screen_pixels);
+
+		// Load level by level towards the desired one while the frame allows it
+		auto target = entry.resident_mip - 1;
+		while (target > desired
+			&& frame_bytes + GetBytes(entry, target - 1, entry.resident_mip) <= max_load_bytes) {
+			target--;
+		}
+
+		// The texture must not evict its own levels while it makes room
+		const auto magnification = GetMagnification(entry, entry.resident_mip);
+		entry.loading_mip = target;
+		while (!MakeRoom(GetBytes(entry, target, entry.resident_mip), magnification)
+			&& target < entry.resident_mip - 1) {
+			target++;
+		}
+		const auto bytes = GetBytes(entry, target, entry.resident_mip);
+		if (m_stats.resident_bytes + m_stats.pending_bytes + bytes > m_stats.budget_bytes) {
+			entry.loading_mip = NONE;
+			continue;
+		}
+
+		entry.loading_mip = target;
+		m_stats.pending_bytes += bytes;
+		frame_bytes += bytes;
+		loads.push_back({ idx, target });
+	}
+
+	for (uint32_t i = 0; i < uint32_t(m_entries.size()); i++) {
+		if (m_entries[i].evicted) {
+			m_entries[i].evicted = false;
+			evictions.push_back({ i, m_entries[i].resident_mip });
+		}
+	}
+}
+
+
+void MipStreamer::Loaded(size_t texture_idx, bool success)
+{
+	auto& entry = m_entries[texture_idx];
+	assert(entry.loading_mip != NONE && "texture was not loading");
+
+	const auto bytes = GetBytes(entry, entry.loading_mip, entry.resident_mip);
+	m_stats.pending_bytes -= bytes;
+	if (success) {
+		m_stats.resident_bytes += bytes;
+		m_stats.loaded_mips += entry.resident_mip - entry.loading_mip;
+		entry.resident_mip = entry.loading_mip;
+	}
+	entry.loading_mip = NONE;
+}
+
+
+auto MipStreamer::GetDesiredMip(uint32_t size, uint32_t tail_mip, float screen_pixels)
+	-> uint32_t
+{
+	// Every level above the one that matches the screen size is minified
+	if (screen_pixels >= float(size)) {
+		return 0;
+	}
+	if (screen_pixels < 1.0F) {
+		return tail_mip;
+	}
+	const auto mip = uint32_t(std::floor(std::log2(float(size) / screen_pixels)));
+	return std::min(mip, tail_mip);
+}
+
+
+auto MipStreamer::GetResidentMip(size_t texture_idx) const -> uint32_t
+{
+	return m_entries[texture_idx].resident_mip;
+}
+
+
+auto MipStreamer::IsLoading(size_t texture_idx) const -> bool
+{
+	return m_entries[texture_idx].loading_mip != NONE;
+}
+
+
+auto MipStreamer::GetStats() const -> Stats
+{
+	return m_stats;
+}
+
+
+auto MipStreamer::GetMagnification(const Entry& entry, uint32_t mip) const -> float
+{
+	if (entry.last_frame != m_frame) {
+		return 0.0F;
+	}
+	return entry.screen_pixels / float(std::max(1U, entry.size >> mip));
+}
+
+
+auto MipStreamer::GetBytes(const Entry& entry, uint32_t first, uint32_t last) -> size_t
+{
+	size_t bytes{ 0 };
+	for (auto mip = first; mip < last; mip++) {
+		bytes += entry.level_bytes[mip];
+	}
+	return bytes;
+}
+
+
+auto MipStreamer::MakeRoom(size_t bytes, float max_magnification) -> bool
+{
+	const auto fits = [&]() {
+		return m_stats.resident_bytes + m_stats.pending_bytes + bytes <= m_stats.budget_bytes;
+	};
+	if (fits()) {
+		return true;
+	}
+
+	// Evicting the top level of a texture leaves the next level magnified, the levels whose
+	// loss is least visible go first
+	VictimQueue victims;
+	for (uint32_t i = 0; i < uint32_t(m_entries.size()); i++) {
+		const auto& entry = m_entries[i];
+		if (entry.added && entry.loading_mip == NONE && entry.resident_mip < entry.tail_mip) {
+			victims.emplace(GetMagnification(entry, entry.resident_mip + 1), i, entry.resident_mip);
+		}
+	}
+
+	while (!fits() && !victims.empty()) {
+		const auto [magnification, idx, mip] = victims.top();
+		if (magnification >= max_magnification) {
+			return false;
+		}
+		victims.pop();
+
+		auto& entry = m_entries[idx];
+		m_stats.resident_bytes -= entry.level_bytes[mip];
+		m_stats.evicted_mips++;
+		entry.resident_mip = mip + 1;
+		entry.evicted = true;
+
+		if (entry.resident_mip < entry.tail_mip) {
+			victims.emplace(GetMagnification(entry, entry.resident_mip + 1), idx, entry.resident_mip);
+		}
+	}
+	return fits();
+}
+
+} // namespace assets
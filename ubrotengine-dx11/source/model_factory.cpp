@@ -17,8 +17,6 @@
 namespace io
 {
 
-namespace dx = DirectX;
-
 template <class T>
 void ModelFactory::GenerateTriangle(
 	gv::Model& model, std::vector<T>& vertices, std::vector<uint32_t>& indices
@@ -35,37 +33,37 @@ void ModelFactory::GenerateTriangle(
 	indices.resize(indexCount);
 
 	const float TRIANGLE_SIZE = 1.0F;
-	const dx::XMFLOAT4 TRIANGLE_COLOR(0.0F, 1.0F, 0.0F, 1.0F);
+	const math::Float4 TRIANGLE_COLOR(0.0F, 1.0F, 0.0F, 1.0F);
 
 	// Fill the vertex array (triangle)
 	// Bottom left
 	vertices[0] = gv::Create(
-		dx::XMFLOAT3(-TRIANGLE_SIZE, -TRIANGLE_SIZE, 0.0F),
+		math::Float3(-TRIANGLE_SIZE, -TRIANGLE_SIZE, 0.0F),
 		TRIANGLE_COLOR,
-		dx::XMFLOAT2(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3()
+		math::Float2(),
+		math::Float3(),
+		math::Float3(),
+		math::Float3()
 	);
 
 	// Top middle
 	vertices[1] = gv::Create(
-		dx::XMFLOAT3(0.0F, TRIANGLE_SIZE, 0.0F),
+		math::Float3(0.0F, TRIANGLE_SIZE, 0.0F),
 		TRIANGLE_COLOR,
-		dx::XMFLOAT2(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3()
+		math::Float2(),
+		math::Float3(),
+		math::Float3(),
+		math::Float3()
 	);
 
 	// Bottom right
 	vertices[2] = gv::Create(
-		dx::XMFLOAT3(TRIANGLE_SIZE, -TRIANGLE_SIZE, 0.0F),
+		math::Float3(TRIANGLE_SIZE, -TRIANGLE_SIZE, 0.0F),
 		TRIANGLE_COLOR,
-		dx::XMFLOAT2(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3(),
-		dx::XMFLOAT3()
+		math::Float2(),
+		math::Float3(),
+		math::Float3(),
+		math::Float3()
 	);
 
 	// Fill the index array
@@ -91,38 +89,38 @@ void ModelFactory::GeneratePlane(
 	indices.resize(indexCount);
 
 	const float PLANE_SIZE = 0.5F;
-	const dx::XMFLOAT4 PLANE_COLOR(0.0F, 1.0F, 0.0F, 1.0F);
+	const math::Float4 PLANE_COLOR(0.0F, 1.0F, 0.0F, 1.0F);
 	// Fill the vertex array (triangle)
 	// Bottom left
 	vertices[0] = gv::Create(
-		dx::XMFLOAT3(-PLANE_SIZE, -PLANE_SIZE, 0.0F),
+		math::Float3(-PLANE_SIZE, -PLANE_SIZE, 0.0F),
 		PLANE_COLOR,
-		dx::XMFLOAT2(), dx::XMFLOAT3(),
-		dx::XMFLOAT3(), dx::XMFLOAT3()
+		math::Float2(), math::Float3(),
+		math::Float3(), math::Float3()
 	);
 
 	// Top left
 	vertices[1] = gv::Create(
-		dx::XMFLOAT3(-PLANE_SIZE, PLANE_SIZE, 0.0F),
+		math::Float3(-PLANE_SIZE, PLANE_SIZE, 0.0F),
 		PLANE_COLOR,
-		dx::XMFLOAT2(), dx::XMFLOAT3(),
-		dx::XMFLOAT3(), dx::XMFLOAT3()
+		math::Float2(), math::Float3(),
+		math::Float3(), math::Float3()
 	);
 
 	// Bottom right
 	vertices[2] = gv::Create(
-		dx::XMFLOAT3(PLANE_SIZE, -PLANE_SIZE, 0.0F),
+		math::Float3(PLANE_SIZE, -PLANE_SIZE, 0.0F),
 		PLANE_COLOR,
-		dx::XMFLOAT2(), dx::XMFLOAT3(),
-		dx::XMFLOAT3(), dx::XMFLOAT3()
+		math::Float2(), math::Float3(),
+		math::Float3(), math::Float3()
 	);
 
 	// Top right
 	vertices[3] = gv::Create(
-		dx::XMFLOAT3(PLANE_SIZE, PLANE_SIZE, 0.0F),
+		math::Float3(PLANE_SIZE, PLANE_SIZE, 0.0F),
 		PLANE_COLOR,
-		dx::XMFLOAT2(), dx::XMFLOAT3(),
-		dx::XMFLOAT3(), dx::XMFLOAT3()
+		math::Float2(), math::Float3(),
+		math::Float3(), math::Float3()
 	);
 
 	// Fill the index array
@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: null_command_backend.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/null_command_backend.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+void NullCommandBackend::SetProgram(uint32_t /*program_idx*/)
+{
+}
+
+
+void NullCommandBackend::SetModel(uint32_t /*model_idx*/)
+{
+}
+
+
+void NullCommandBackend::SetWorldMatrix(const math::Float4x4& /*world*/)
+{
+}
+
+
+void NullCommandBackend::SetTexture(uint32_t /*texture_idx*/)
+{
+}
+
+
+void NullCommandBackend::DrawIndexed(
+	uint32_t /*index_count*/, uint32_t /*start_index*/, int32_t /*base_vertex*/
+)
+{
+}
+
+
+void NullCommandBackend::SetView(uint32_t /*view_idx*/)
+{
+}
+
+
+void NullCommandBackend::ClearView(uint32_t /*view_idx*/)
+{
+}
+
+} // namespace graphics
@@ -0,0 +1,229 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: null_render_device.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/null_render_device.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "../header/dds_loader.h"
+
+
+namespace graphics
+{
+
+NullRenderDevice::NullRenderDevice(bool uses_bytecode) :
+	m_uses_bytecode(uses_bytecode)
+{
+}
+
+
+auto NullRenderDevice::Initialize(const HWND& /*hwnd*/, const GraphicSettings& settings)
+	-> HRESULT
+{
+	Handle back_buffer{ NO_RESOURCE };
+	const auto result = CreateRenderTarget(
+		settings.window_width, settings.window_height, back_buffer
+	);
+	m_back_buffer = back_buffer;
+	m_resolutions = { { settings.window_width, settings.window_height } };
+	return result;
+}
+
+
+void NullRenderDevice::Shutdown()
+{
+}
+
+
+auto NullRenderDevice::Refresh(const GraphicSettings& settings) -> HRESULT
+{
+	if (m_back_buffer == NO_RESOURCE) {
+		return E_FAIL;
+	}
+
+	// The back buffer keeps its handle and only changes its size
+	constexpr size_t B_PER_PIXEL = 4 + 4;
+	const auto bytes = size_t(settings.window_width) * settings.window_height * B_PER_PIXEL;
+	m_stats.resource_bytes = m_stats.resource_bytes - m_resource_bytes[m_back_buffer] + bytes;
+	m_resource_bytes[m_back_buffer] = bytes;
+	m_resolutions = { { settings.window_width, settings.window_height } };
+	return S_OK;
+}
+
+
+void NullRenderDevice::Present()
+{
+}
+
+
+auto NullRenderDevice::CreateBuffer(BufferUsage /*usage*/, uint32_t size, Handle& handle)
+	-> HRESULT
+{
+	handle = Allocate(size);
+	return S_OK;
+}
+
+
+void NullRenderDevice::UpdateBuffer(
+	Handle /*buffer*/, uint32_t /*offset*/, const void* /*data*/, uint32_t size
+)
+{
+	m_stats.uploaded_bytes += size;
+}
+
+
+void NullRenderDevice::CopyBuffer(
+	Handle /*dst*/, uint32_t /*dst_offset*/, Handle /*src*/, uint32_t /*src_offset*/,
+	uint32_t size
+)
+{
+	m_stats.copied_bytes += size;
+}
+
+
+auto NullRenderDevice::CreateTexture(
+	const TextureDesc& desc, const std::vector<SubresourceData>& subresources,
+	bool /*as_array*/, Handle& handle
+) -> HRESULT
+{
+	if (subresources.size() != size_t(desc.mip_count) * desc.array_size) {
+		return E_INVALIDARG;
+	}
+
+	size_t bytes{ 0 };
+	uint32_t width = desc.width;
+	uint32_t height = desc.height;
+	for (uint32_t mip = 0; mip < desc.mip_count; mip++) {
+		uint32_t row_pitch{ 0 };
+		uint32_t row_count{ 0 };
+		if (!io::DdsLoader::GetSurfaceInfo(width, height, desc.format, row_pitch, row_count)) {
+			return E_INVALIDARG;
+		}
+		bytes += size_t(row_pitch) * row_count * desc.array_size;
+		width = std::max(width / 2, 1U);
+		height = std::max(height / 2, 1U);
+	}
+
+	handle = Allocate(bytes);
+	m_stats.uploaded_bytes += bytes;
+	return S_OK;
+}
+
+
+auto NullRenderDevice::CreateRenderTarget(uint32_t width, uint32_t height, Handle& handle)
+	-> HRESULT
+{
+	// RGBA8 color and a 32 bit depth buffer
+	constexpr size_t B_PER_PIXEL = 4 + 4;
+	handle = Allocate(size_t(width) * height * B_PER_PIXEL);
+	return S_OK;
+}
+
+
+auto NullRenderDevice::CreateDepthArray(uint32_t size, uint32_t slices, Handle& handle)
+	-> HRESULT
+{
+	constexpr size_t B_PER_TEXEL = 4;
+	handle = Allocate(size_t(size) * size * slices * B_PER_TEXEL);
+	return S_OK;
+}
+
+
+auto NullRenderDevice::CreateShader(
+	ShaderStage /*stage*/, const std::vector<uint8_t>& bytecode, Handle& handle
+) -> HRESULT
+{
+	handle = Allocate(bytecode.size());
+	return S_OK;
+}
+
+
+auto NullRenderDevice::CreateInputLayout(
+	const std::vector<VertexElement>& /*elements*/, const std::vector<uint8_t>& /*bytecode*/,
+	Handle& handle
+) -> HRESULT
+{
+	handle = Allocate(0);
+	return S_OK;
+}
+
+
+void NullRenderDevice::Release(Handle handle)
+{
+	if (handle >= m_resource_bytes.size() || m_resource_bytes[handle] == NO_BYTES) {
+		return;
+	}
+	m_stats.resources--;
+	m_stats.resource_bytes -= m_resource_bytes[handle];
+	m_resource_bytes[handle] = NO_BYTES;
+	m_free_handles.push_back(handle);
+}
+
+
+auto NullRenderDevice::GetBackBuffer() const -> Handle
+{
+	return m_back_buffer;
+}
+
+
+auto NullRenderDevice::UsesBytecode() const -> bool
+{
+	return m_uses_bytecode;
+}
+
+
+auto NullRenderDevice::GetVideoMemory() const -> size_t
+{
+	return 0;
+}
+
+
+auto NullRenderDevice::GetSupportedResolutions() const
+	-> const std::vector<std::tuple<uint16_t, uint16_t>>&
+{
+	return m_resolutions;
+}
+
+
+auto NullRenderDevice::GetResourceBytes(Handle handle) const -> size_t
+{
+	if (handle >= m_resource_bytes.size() || m_resource_bytes[handle] == NO_BYTES) {
+		return 0;
+	}
+	return m_resource_bytes[handle];
+}
+
+
+auto NullRenderDevice::GetStats() const -> const Stats&
+{
+	return m_stats;
+}
+
+
+auto NullRenderDevice::Allocate(size_t bytes) -> Handle
+{
+	Handle handle{ NO_RESOURCE };
+	if (!m_free_handles.empty()) {
+		handle = m_free_handles.back();
+		m_free_handles.pop_back();
+		m_resource_bytes[handle] = bytes;
+	}
+	else {
+		handle = Handle(m_resource_bytes.size());
+		m_resource_bytes.push_back(bytes);
+	}
+	m_stats.resources++;
+	m_stats.resource_bytes += bytes;
+	m_stats.created++;
+	return handle;
+}
+
+} // namespace graphics
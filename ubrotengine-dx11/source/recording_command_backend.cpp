@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: recording_command_backend.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/recording_command_backend.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+RecordingCommandBackend::RecordingCommandBackend(CommandBuffer& log) :
+	m_log(log)
+{
+}
+
+
+void RecordingCommandBackend::SetProgram(uint32_t program_idx)
+{
+	m_log.SetProgram(program_idx);
+}
+
+
+void RecordingCommandBackend::SetModel(uint32_t model_idx)
+{
+	m_log.SetModel(model_idx);
+}
+
+
+void RecordingCommandBackend::SetWorldMatrix(const math::Float4x4& world)
+{
+	m_log.SetWorldMatrix(world);
+}
+
+
+void RecordingCommandBackend::SetTexture(uint32_t texture_idx)
+{
+	m_log.SetTexture(texture_idx);
+}
+
+
+void RecordingCommandBackend::DrawIndexed(
+	uint32_t index_count, uint32_t start_index, int32_t base_vertex
+)
+{
+	m_log.DrawIndexed(index_count, start_index, base_vertex);
+}
+
+
+void RecordingCommandBackend::SetView(uint32_t view_idx)
+{
+	m_log.SetView(view_idx);
+}
+
+
+void RecordingCommandBackend::ClearView(uint32_t view_idx)
+{
+	m_log.ClearView(view_idx);
+}
+
+} // namespace graphics
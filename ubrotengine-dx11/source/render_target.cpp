@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_target.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/render_target.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+auto RenderTarget::Initialize(RenderDevice& device, uint32_t width, uint32_t height) -> HRESULT
+{
+	device.Release(m_target);
+	m_target = RenderDevice::NO_RESOURCE;
+
+	auto result = device.CreateRenderTarget(width, height, m_target);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	m_viewport.x = 0.0F;
+	m_viewport.y = 0.0F;
+	m_viewport.width = float(width);
+	m_viewport.height = float(height);
+	m_viewport.min_depth = 0.0F;
+	m_viewport.max_depth = 1.0F;
+	return result;
+}
+
+
+auto RenderTarget::GetTarget() const -> RenderDevice::Handle
+{
+	return m_target;
+}
+
+
+auto RenderTarget::GetViewport() const -> const Viewport&
+{
+	return m_viewport;
+}
+
+} // namespace graphics
@@ -7,43 +7,113 @@
 //////////////
 // INCLUDES //
 //////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
+#include <numeric>
 
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
 #include "../header/asset_loader.h"
+#include "../header/null_render_device.h"
+#ifdef _WIN32
+#include "../header/d3d11_command_backend.h"
+#include "../header/d3d11_render_device.h"
+#endif
 
 
 namespace graphics
 {
+namespace
+{
+
+void ShowError(const HWND& hwnd, LPCWSTR message)
+{
+#ifdef _WIN32
+	MessageBox(hwnd, message, L"Error", MB_OK);
+#else
+	UNREFERENCED_PARAMETER(hwnd);
+	std::fprintf(stderr, "Error: %ls\n", message);
+#endif
+}
+
+} // namespace
+
 
 auto Renderer::Initialize(const HWND& hwnd, const GraphicSettings& settings) -> HRESULT
 {
 	auto result{ S_OK };
 
-	
-	// Create and initialize the Direct3D object.
-	m_direct3d = std::make_unique<Direct3D>();
-	result = m_direct3d->Initialize(hwnd, settings);
+	// Only the D3D11 backend draws on the GPU, the headless backends neither create a
+	// Direct3D device nor compile shaders
+	m_backend = settings.render_backend;
+	if (m_backend == RenderBackend::D3D11) {
+#ifdef _WIN32
+		auto d3d11_device = std::make_unique<D3D11RenderDevice>();
+		m_d3d11_device = d3d11_device.get();
+		m_device = std::move(d3d11_device);
+#else
+		ShowError(hwnd, L"The D3D11 backend is only available on Windows");
+		return E_NOTIMPL;
+#endif
+	}
+	else {
+		m_device = std::make_unique<NullRenderDevice>();
+	}
+	result = m_device->Initialize(hwnd, settings);
 	if (FAILED(result)) {
-		MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
+		ShowError(hwnd, L"Could not initialize the render device");
 		return result;
 	}
 
 
 	// Create and initialize the shader manager.
 	m_shader_manager = std::make_unique<ShaderManager>();
-	result = m_shader_manager->Initialize(m_direct3d->GetDevice(), hwnd);
+	result = m_shader_manager->Initialize(*m_device, hwnd);
 	if (FAILED(result)) {
-		MessageBox(hwnd, L"Could not initialize Shader Manager", L"Error", MB_OK);
+		ShowError(hwnd, L"Could not initialize Shader Manager");
 		return result;
 	}
 
-	m_view_matrix_handler = std::make_unique<ViewMatrixHandler>();
+	m_thread_pool = std::make_unique<utils::ThreadPool>();
 
-	m_asset_manager = std::make_unique<assets::AssetManager>();
+	m_asset_manager = std::make_unique<assets::AssetManager>(m_thread_pool.get());
+	// The software backend reads the geometry on the CPU
+	if (m_backend == RenderBackend::Software) {
+		m_asset_manager->KeepGeometryOnCpu();
+		m_software_target = std::make_unique<SoftwareRasterizer>(m_thread_pool.get());
+	}
+
+	m_reflection_camera = std::make_unique<Camera>();
+	m_reflection_target = std::make_unique<RenderTarget>();
+	m_shadow_map = std::make_unique<ShadowMap>();
+	result = UpdateViews(settings);
+	if (FAILED(result)) {
+		ShowError(hwnd, L"Could not create the reflection and shadow targets");
+		return result;
+	}
+	UpdateModelBudget(settings);
+	UpdateTextureStreaming(settings);
+
+	// One command buffer per thread that takes part in recording
+	const auto thread_count = m_thread_pool->GetThreadCount();
+	m_command_buffers.resize(thread_count);
+
+	// Deferred contexts are only worth it if the driver records command lists natively,
+	// otherwise the runtime emulates them and the immediate context is faster. Headless
+	// backends replay on the calling thread.
+#ifdef _WIN32
+	if (m_d3d11_device != nullptr && m_d3d11_device->SupportsCommandLists()) {
+		// Without deferred contexts the immediate context is used
+		if (FAILED(m_d3d11_device->CreateDeferredContexts(thread_count))) {
+			result = S_OK;
+		}
+	}
+#endif
 
 	return result;
 }
@@ -51,150 +121,888 @@ auto Renderer::Initialize(const HWND& hwnd, const GraphicSettings& settings) ->
 
 void Renderer::Shutdown()
 {
-	m_direct3d->Shutdown();
 	m_shader_manager->Shutdown();
+	m_device->Shutdown();
 }
 
 
 auto Renderer::Refresh(const GraphicSettings& settings) -> HRESULT
 {
-	return m_direct3d->Refresh(settings);
+	auto result = m_device->Refresh(settings);
+	const auto views_result = UpdateViews(settings);
+	if (SUCCEEDED(result)) {
+		result = views_result;
+	}
+	UpdateModelBudget(settings);
+	UpdateTextureStreaming(settings);
+	return result;
 }
 
 /*
 auto Renderer::RegisterShader(HWND hwnd, int shader_type) -> bool
 {
 	// if shader_type is not loaded load
-	return m_shader_manager->AddShader(m_direct3d->GetDevice(), hwnd, shader_type);
+	return m_shader_manager->AddShader(*m_device, hwnd, shader_type);
 }
 */
 
+auto Renderer::MountArchive(const std::string& filename) -> bool
+{
+	return m_asset_manager->MountArchive(filename);
+}
+
+
 auto Renderer::RegisterModel(const std::string& filename) -> size_t
 {
-	return m_asset_manager->AddModel(m_direct3d->GetDevice(), filename);
+	return m_asset_manager->AddModel(*m_device, filename);
 }
 
 
 auto Renderer::RegisterModelProcedural(const assets::Procedural num) -> size_t
 {
 	if (num < assets::Procedural::NUMBER) {
-		return m_asset_manager->AddModelProcedural(m_direct3d->GetDevice(), num);
+		return m_asset_manager->AddModelProcedural(*m_device, num);
 	}
-	return m_asset_manager->AddModelProcedural(m_direct3d->GetDevice(), assets::Procedural::Plane);
+	return m_asset_manager->AddModelProcedural(*m_device, assets::Procedural::Plane);
 }
 
 
 auto Renderer::RegisterTexture(const std::string& filename, uint8_t components) -> size_t
 {
-	return m_asset_manager->AddTexture(m_direct3d->GetDevice(), filename, components);
+	return m_asset_manager->AddTexture(filename, components);
+}
+
+
+auto Renderer::RegisterModels(const std::vector<std::string>& filenames) -> std::vector<size_t>
+{
+	return m_asset_manager->AddModels(*m_device, filenames);
+}
+
+
+auto Renderer::RegisterTextures(const std::vector<std::string>& filenames, uint8_t components)
+	-> std::vector<size_t>
+{
+	return m_asset_manager->AddTextures(filenames, components);
+}
+
+
+void Renderer::SetModelTexture(size_t model_idx, size_t texture_idx)
+{
+	m_asset_manager->SetModelTexture(model_idx, texture_idx);
 }
 
 
 auto Renderer::GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&
 {
-	return m_direct3d->GetSupportedResolutions();
+	return m_device->GetSupportedResolutions();
 }
 
 
-auto Renderer::Process(const Scene& scene) -> HRESULT
+void Renderer::SetReflectionPlane(float height)
 {
-	auto result{ S_OK };
+	m_reflection_enabled = true;
+	m_reflection_height = height;
+}
 
-	const auto& user = scene.GetUser(0);
-	const auto& pos = user.GetCamPos();
-	const auto& look_at = user.GetCamLookDir();
 
-	m_view_matrix_handler->RenderViewMatrix(
-		pos[0], pos[1], pos[2], look_at[0], look_at[1], look_at[2]
-	);
+void Renderer::DisableReflection()
+{
+	m_reflection_enabled = false;
+}
+
+
+auto Renderer::GetReflectionTexture() const -> RenderDevice::Handle
+{
+	return m_reflection_target->GetTarget();
+}
+
+
+auto Renderer::GetReflectionCamera() const -> const Camera&
+{
+	return *m_reflection_camera;
+}
+
+
+void Renderer::SetLightDirection(const math::Float3& direction)
+{
+	m_shadows_enabled = true;
+	m_shadow_cascades.SetLightDirection(direction);
+}
+
+
+void Renderer::DisableShadows()
+{
+	m_shadows_enabled = false;
+}
+
+
+auto Renderer::GetShadowMap() const -> RenderDevice::Handle
+{
+	return m_shadow_map->GetTarget();
+}
 
-	// Clear the buffers
-	m_direct3d->BeginScene(1.0F, 0.0F, 1.0F, 1.0F);
 
-	result = RenderScene(scene);
+auto Renderer::GetShadowCascades() const -> const ShadowCascades&
+{
+	return m_shadow_cascades;
+}
+
+
+auto Renderer::Process(const SceneInput& input, double read_ms) -> HRESULT
+{
+	auto result{ S_OK };
+
+	// Every view follows one user, the matrices and frustum planes of a view are only
+	// computed again if its camera moved
+	m_frame_stats.camera_changed = false;
+	for (size_t v = 0; v < std::min(m_cameras.size(), input.users.size()); v++) {
+		const auto& user = input.users[v];
+		auto& camera = *m_cameras[v];
+		camera.SetView(user.position, user.look_at);
+		if (camera.Update()) {
+			m_frame_stats.camera_changed = true;
+		}
+	}
+
+	// The reflection mirrors the view of the first user
+	if (m_reflection_enabled) {
+		m_reflection_camera->SetReflection(*m_cameras.front(), m_reflection_height);
+		if (m_reflection_camera->Update()) {
+			m_frame_stats.camera_changed = true;
+		}
+	}
+
+	// The targets are cleared by the backend, see SubmitScene
+	m_frame_stats.read_ms = read_ms;
+	result = RenderScene(input);
 
 	// Present the rendered scene to the screen.
-	m_direct3d->EndScene();
+	m_device->Present();
 
 	return result;
 }
 
-auto Renderer::RenderScene(const Scene& scene) -> HRESULT
+
+auto Renderer::GetViewCount() const -> size_t
+{
+	return m_cameras.size();
+}
+
+
+auto Renderer::GetModelCount() const -> size_t
+{
+	return m_asset_manager->GetModelCount();
+}
+
+
+void Renderer::SetDeterministic(bool deterministic)
+{
+	m_deterministic = deterministic;
+}
+
+
+auto Renderer::GetFrameStats() const -> const FrameStats&
+{
+	return m_frame_stats;
+}
+
+
+auto Renderer::GetRecordedCommands() const -> const CommandBuffer&
+{
+	return m_recorded_commands;
+}
+
+
+auto Renderer::GetSoftwareFrame(io::Image& image) const -> bool
 {
-	using DirectX::XMMatrixMultiply;
-	using DirectX::XMMatrixScaling;
-	using DirectX::XMMatrixRotationRollPitchYaw;
-	using DirectX::XMMatrixTranslation;
+	if (m_software_target == nullptr) {
+		return false;
+	}
+	m_software_target->ReadImage(image);
+	return true;
+}
+
 
+auto Renderer::RenderScene(const SceneInput& input) -> HRESULT
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	// Ranges move during defragmentation, so it has to happen before any draw is recorded
+	m_frame_stats.defrag_bytes = m_asset_manager->DefragmentGeometry(
+		*m_device, GEOMETRY_DEFRAG_BYTES
+	);
+	const auto geometry_stats = m_asset_manager->GetGeometryStats();
+	m_frame_stats.geometry_bytes = geometry_stats.used_bytes;
+	m_frame_stats.geometry_capacity_bytes = geometry_stats.capacity_bytes;
+	m_frame_stats.geometry_fragmentation = geometry_stats.fragmentation;
+
+	// Textures registered since the last frame are packed into new arrays
 	auto result{ S_OK };
+	if (m_asset_manager->HasPendingTextures()) {
+		result = m_asset_manager->PackTextures(*m_device);
+	}
+	const auto texture_stats = m_asset_manager->GetTextureStats();
+	m_frame_stats.textures = texture_stats.textures;
+	m_frame_stats.texture_arrays = texture_stats.arrays;
+	m_frame_stats.atlas_pages = texture_stats.atlas_pages;
+	m_frame_stats.atlas_occupancy = texture_stats.atlas_occupancy;
+
+	// Variants that finished compiling in the background are used from this frame on, a
+	// deterministic renderer uses all variants that were requested in the last frame
+	const auto shader_result = m_deterministic
+		? m_shader_manager->WaitForVariants()
+		: m_shader_manager->Update();
+	if (SUCCEEDED(result)) {
+		result = shader_result;
+	}
+	const auto shader_stats = m_shader_manager->GetShaderStats();
+	m_frame_stats.shader_objects = shader_stats.objects;
+	m_frame_stats.shared_shader_objects = shader_stats.references - shader_stats.objects;
+
+	// The loads of the last frame are only uploaded by the streaming below, so the wait
+	// stays out of the stage timings
+	if (m_deterministic) {
+		m_asset_manager->WaitForTextureLoads();
+	}
 
+	const auto gather_start = Clock::now();
+	GatherScene(input);
 
-	// Get the nessessary matrices from the camera and the direct3d object.
-	const auto& viewMatrix = m_view_matrix_handler->GetViewMatrix();
-	auto worldMatrix = m_direct3d->GetWorldMatrix();
-	const auto& projectionMatrix = m_direct3d->GetProjectionMatrix();
-	//auto orthoMatrix = m_direct3d->GetOrthoMatrix();
-
-	m_direct3d->TurnZBufferOn();
-	//m_direct3d->TurnCullingOn();
-	//m_direct3d->TurnWireframeOn();
-
-	// For all tiles in this scene
-	for (const auto& tile : scene.GetTiles()) {
-		// Get the tile coords to access the scene objects
-		for (const auto& o : scene.GetObjects(tile.first)) {
-
-			// Transform the Object.
-			/*
-			worldMatrix = XMMatrixMultiply(
-				XMMatrixMultiply(
-					XMMatrixScaling(cTransform.scale.x, cTransform.scale.y, cTransform.scale.z),
-					XMMatrixRotationRollPitchYaw(cTransform.rotation.x, cTransform.rotation.y + rot, cTransform.rotation.z)),
-				XMMatrixTranslation(cTransform.position.x, cTransform.position.y, cTransform.position.z)
-			);*/
-			const auto position = o.GetPosition();
-			worldMatrix = XMMatrixMultiply(
-				XMMatrixMultiply(
-					XMMatrixScaling(1.0F, 1.0F, 1.0F),
-					XMMatrixRotationRollPitchYaw(0.0F, 0.0F, 0.0F)),
-				XMMatrixTranslation(position[0], position.y, position.z)
-			);
+	const auto variant_stats = m_shader_manager->GetVariantStats();
+	m_frame_stats.shader_variants = variant_stats.variants;
+	m_frame_stats.pending_shader_variants = variant_stats.pending;
+	m_frame_stats.shader_fallback_draws = variant_stats.fallback_draws;
+	m_frame_stats.shader_skipped_draws = variant_stats.skipped_draws;
+	m_frame_stats.shader_hitches = variant_stats.hitches;
+
+	// Streaming needs the requests of the gather stage, new levels are used right away
+	const auto stream_result = m_asset_manager->StreamTextures(
+		*m_device, TEXTURE_STREAM_BYTES
+	);
+	if (SUCCEEDED(result)) {
+		result = stream_result;
+	}
+	const auto streaming = m_asset_manager->GetStreamingStats();
+	m_frame_stats.texture_budget_bytes = streaming.budget_bytes;
+	m_frame_stats.resident_texture_bytes = streaming.resident_bytes;
+	m_frame_stats.pending_texture_bytes = streaming.pending_bytes;
+	m_frame_stats.streamed_textures = streaming.textures;
+	m_frame_stats.loaded_mips = streaming.loaded_mips;
+	m_frame_stats.evicted_mips = streaming.evicted_mips;
+
+	const auto submit_start = Clock::now();
+	const auto submit_result = SubmitScene();
+	if (SUCCEEDED(result)) {
+		result = submit_result;
+	}
+	const auto submit_end = Clock::now();
+
+	m_frame_stats.gather_ms = Milliseconds(submit_start - gather_start).count();
+	m_frame_stats.submit_ms = Milliseconds(submit_end - submit_start).count();
+	m_frame_stats.draw_packets = m_draw_packets.Size();
+
+	return result;
+}
+
+
+void Renderer::UpdateModelBudget(const GraphicSettings& settings)
+{
+	constexpr size_t B_PER_MB = 1024 * 1024;
+
+	// Without a setting and without dedicated memory (e.g. software adapters) no budget is
+	// enforced
+	size_t budget = SIZE_MAX;
+	if (settings.model_memory_mb > 0) {
+		budget = size_t(settings.model_memory_mb) * B_PER_MB;
+	}
+	else if (m_device->GetVideoMemory() > 0) {
+		budget = size_t(float(m_device->GetVideoMemory()) * MODEL_MEMORY_SHARE) * B_PER_MB;
+	}
+	m_asset_manager->SetModelBudget(budget);
+}
+
+
+void Renderer::UpdateTextureStreaming(const GraphicSettings& settings)
+{
+	constexpr size_t B_PER_MB = 1024 * 1024;
+
+	size_t budget = SIZE_MAX;
+	if (settings.texture_memory_mb > 0) {
+		budget = size_t(settings.texture_memory_mb) * B_PER_MB;
+	}
+	else if (m_device->GetVideoMemory() > 0) {
+		budget = size_t(float(m_device->GetVideoMemory()) * TEXTURE_MEMORY_SHARE) * B_PER_MB;
+	}
+	m_asset_manager->SetTextureBudget(budget);
+
+	// The second row of the projection holds cot(fov / 2), at depth d one world unit covers
+	// height * cot(fov / 2) / (2 * d) pixels. All views have the same size and field of view.
+	const auto& view = m_views.front();
+	const float cot_half_fov = view.camera->GetProjectionMatrix().m[1][1];
+	m_texture_pixel_scale = view.viewport.height * cot_half_fov * 0.5F * TEXTURE_WORLD_SIZE;
+}
+
+
+auto Renderer::UpdateViews(const GraphicSettings& settings) -> HRESULT
+{
+	// Same as the projection of Direct3D, which a single view matches exactly
+	constexpr float FIELD_OF_VIEW = math::PI / 4.0F;
+	constexpr std::array<float, 4> CLEAR_COLOR = { 1.0F, 0.0F, 1.0F, 1.0F };
+
+	// Settings written before split screen existed read zero views
+	const auto view_count = std::clamp(settings.split_screen_views, 1U, MAX_SPLIT_SCREEN_VIEWS);
+	const uint32_t columns = view_count > 1 ? 2 : 1;
+	const uint32_t rows = view_count > 2 ? 2 : 1;
+	const float width = float(settings.window_width) / float(columns);
+	const float height = float(settings.window_height) / float(rows);
+	const auto projection = math::PerspectiveFovLH(
+		FIELD_OF_VIEW, width / height, settings.screen_near, settings.screen_depth
+	);
+
+	while (m_cameras.size() < view_count) {
+		m_cameras.push_back(std::make_unique<Camera>());
+	}
+	m_cameras.resize(view_count);
+	m_views.resize(view_count + 1 + ShadowCascades::CASCADE_COUNT);
+	m_screen_near = settings.screen_near;
+	m_screen_depth = settings.screen_depth;
+
+	for (uint32_t v = 0; v < view_count; v++) {
+		m_cameras[v]->SetProjection(projection);
+
+		auto& view = m_views[v];
+		view.camera = m_cameras[v].get();
+		view.viewport.x = width * float(v % columns);
+		view.viewport.y = height * float(v / columns);
+		view.viewport.width = width;
+		view.viewport.height = height;
+		view.viewport.min_depth = 0.0F;
+		view.viewport.max_depth = 1.0F;
+		view.target = m_device->GetBackBuffer();
+		view.clear_color = CLEAR_COLOR;
+	}
+
+	// Settings written before the reflection existed read a scale of zero
+	m_reflection_scale = settings.reflection_scale > 0.0F
+		? std::min(settings.reflection_scale, 1.0F)
+		: DEFAULT_REFLECTION_SCALE;
+	auto result = m_reflection_target->Initialize(
+		*m_device,
+		std::max(uint32_t(width * m_reflection_scale), 1U),
+		std::max(uint32_t(height * m_reflection_scale), 1U)
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	auto& reflection = m_views[view_count];
+	reflection.camera = m_reflection_camera.get();
+	reflection.viewport = m_reflection_target->GetViewport();
+	reflection.target = m_reflection_target->GetTarget();
+	reflection.clear_color = CLEAR_COLOR;
+
+	// Settings written before the shadows existed read a size of zero
+	const auto shadow_map_size = settings.shadow_map_size > 0
+		? settings.shadow_map_size
+		: DEFAULT_SHADOW_MAP_SIZE;
+	m_shadow_cascades.SetShadowMap(shadow_map_size, SHADOW_DISTANCE, SHADOW_CASTER_RANGE);
+	result = m_shadow_map->Initialize(
+		*m_device, shadow_map_size, uint32_t(ShadowCascades::CASCADE_COUNT)
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// The cascades only write depth
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		auto& shadow = m_views[view_count + 1 + c];
+		shadow.camera = &m_shadow_cascades.GetCamera(c);
+		shadow.viewport = m_shadow_map->GetViewport();
+		shadow.target = m_shadow_map->GetTarget();
+		shadow.depth_slice = uint32_t(c);
+	}
 
-			// TODO(rwarnking) ask the object for the shader
-			constexpr size_t shader_prog_idx = 0;
-			const auto& model = m_asset_manager->GetModel(o.GetModelIdx());
-			RenderModel<graphics::vertices::ColVertex>(m_direct3d->GetDeviceContext(), model);
-			result = m_shader_manager->GetShaderProgram(shader_prog_idx).Render(
-				m_direct3d->GetDeviceContext(),
-				worldMatrix, viewMatrix, projectionMatrix,
-				model.indexCount
+	// The reflection and the cascades have no target on the CPU, their draws are skipped
+	if (m_software_target != nullptr) {
+		m_software_target->Resize(settings.window_width, settings.window_height);
+		m_software_views.resize(m_views.size());
+		for (size_t v = 0; v < m_views.size(); v++) {
+			auto& view = m_software_views[v];
+			view.camera = m_views[v].camera;
+			view.viewport = m_views[v].viewport;
+			view.target = v < view_count ? m_software_target.get() : nullptr;
+			view.clear_color = m_views[v].clear_color;
+		}
+	}
+	return result;
+}
+
+
+void Renderer::GatherScene(const SceneInput& input)
+{
+	// The list keeps its memory, so after the first frame no allocations happen here
+	m_draw_packets.Clear();
+	m_asset_manager->BeginFrame();
+
+	// One traversal collects the bounding spheres of all objects, which are then tested
+	// against the frusta of all views at once. The reflection comes last and only shows
+	// what is above its mirror plane.
+	m_culler.Clear();
+	for (const auto& camera : m_cameras) {
+		m_culler.AddView(*camera);
+	}
+	const auto reflection_view = m_cameras.size();
+	if (m_reflection_enabled) {
+		m_culler.AddView(*m_reflection_camera, { 0.0F, 1.0F, 0.0F, -m_reflection_height });
+	}
+	const auto& models = input.models;
+	const auto& positions = input.positions;
+
+	// Evicted models keep their radius, so they can be culled without loading them
+	for (size_t i = 0; i < models.size(); i++) {
+		m_culler.AddSphere(
+			positions[i], m_asset_manager->GetModel(size_t(models[i])).boundingRadius
+		);
+	}
+	m_culler.Cull();
+	const auto& masks = m_culler.GetMasks();
+
+	// Objects are prepared when the first view or shadow cascade needs them, their world
+	// matrix is shared by the packets of all views and cascades
+	constexpr uint32_t NOT_PREPARED = UINT32_MAX;
+	constexpr uint32_t SKIPPED = UINT32_MAX - 1;
+	m_gathered_matrices.assign(models.size(), NOT_PREPARED);
+	m_gathered_programs.resize(models.size());
+	const auto prepare = [&](size_t i) {
+		auto& matrix_idx = m_gathered_matrices[i];
+		if (matrix_idx != NOT_PREPARED) {
+			return matrix_idx != SKIPPED;
+		}
+		matrix_idx = SKIPPED;
+
+		// Make sure the model is in GPU memory, skip the object if it can not be loaded
+		if (!m_asset_manager->UseModel(*m_device, size_t(models[i]))) {
+			return false;
+		}
+
+		// Skipped while neither its variant nor a fallback is compiled
+		const auto& model = m_asset_manager->GetModel(size_t(models[i]));
+		const auto shader_prog_idx = m_shader_manager->GetVariant(
+			model.shaderProgram, model.shaderFeatures
+		);
+		if (shader_prog_idx == ShaderManager::NO_PROGRAM) {
+			return false;
+		}
+		m_gathered_programs[i] = shader_prog_idx;
+
+		// Scene objects only have a position, which is also why the bounding radius of the
+		// model is used as it is
+		const auto& position = positions[i];
+		matrix_idx = m_draw_packets.AddWorldMatrix(
+			math::Translation(position.x, position.y, position.z)
+		);
+		return true;
+	};
+
+	// Packets that sample the same texture array are drawn together
+	const auto get_texture_array = [&](size_t model_idx) {
+		const auto texture_idx = m_asset_manager->GetModelTexture(model_idx);
+		if (texture_idx == assets::AssetManager::NO_TEXTURE) {
+			return assets::TextureLocation::NONE;
+		}
+		return m_asset_manager->GetTextureLocation(texture_idx).array_idx;
+	};
+
+	// The shadow cascades are drawn first, then the reflection, so the views can sample both
+	const auto reflection_order = ShadowCascades::CASCADE_COUNT;
+	size_t visible_objects{ 0 };
+	for (size_t i = 0; i < models.size(); i++) {
+		const auto mask = masks[i];
+		if (mask == 0 || !prepare(i)) {
+			continue;
+		}
+		visible_objects++;
+
+		const auto model_idx = size_t(models[i]);
+		const auto shader_prog_idx = m_gathered_programs[i];
+		const auto matrix_idx = m_gathered_matrices[i];
+		const auto texture_array = get_texture_array(model_idx);
+		const auto texture_idx = m_asset_manager->GetModelTexture(model_idx);
+		const auto& position = positions[i];
+
+		// One packet per view the object is visible in, the view in which the texture covers
+		// the most pixels decides which mip levels it needs
+		float texture_pixels{ 0.0F };
+		for (size_t v = 0; v < m_culler.GetViewCount(); v++) {
+			if ((mask & (1U << v)) == 0) {
+				continue;
+			}
+			const bool is_reflection = v == reflection_view;
+			const auto& cam_pos = m_views[v].camera->GetPosition();
+			const float dx = position.x - cam_pos.x;
+			const float dy = position.y - cam_pos.y;
+			const float dz = position.z - cam_pos.z;
+			const float depth = std::sqrt(dx * dx + dy * dy + dz * dz);
+			// Every level of the mip bias halves the pixels the reflection asks for
+			const float pixel_scale = is_reflection
+				? m_texture_pixel_scale * m_reflection_scale / std::exp2(REFLECTION_MIP_BIAS)
+				: m_texture_pixel_scale;
+			texture_pixels = std::max(texture_pixels, pixel_scale / std::max(depth, m_screen_near));
+
+			const auto view_order = is_reflection ? reflection_order : reflection_order + 1 + v;
+			m_draw_packets.Add(
+				uint8_t(v), model_idx, shader_prog_idx, matrix_idx,
+				DrawPacketList::MakeSortKey(
+					view_order, shader_prog_idx, texture_array, model_idx, depth
+				)
 			);
-			if (FAILED(result)) {
-				return result;
+		}
+
+		if (texture_idx != assets::AssetManager::NO_TEXTURE) {
+			m_asset_manager->RequestTexture(texture_idx, texture_pixels);
+		}
+	}
+
+	// Cascades whose cached shadow map is still valid get no packets
+	if (m_shadows_enabled) {
+		m_shadow_cascades.Update(*m_cameras.front(), m_screen_near, m_screen_depth);
+		m_shadow_cascades.Cull(m_culler, models, *m_thread_pool);
+	}
+	const auto shadow_view = reflection_view + 1;
+	for (size_t c = 0; m_shadows_enabled && c < ShadowCascades::CASCADE_COUNT; c++) {
+		if (!m_shadow_cascades.NeedsRender(c)) {
+			continue;
+		}
+		const auto& light_pos = m_shadow_cascades.GetCamera(c).GetPosition();
+		for (const auto i : m_shadow_cascades.GetCasters(c)) {
+			if (!prepare(i)) {
+				continue;
 			}
+			const auto model_idx = size_t(models[i]);
+			const auto shader_prog_idx = m_gathered_programs[i];
+			const auto& position = positions[i];
+			const float dx = position.x - light_pos.x;
+			const float dy = position.y - light_pos.y;
+			const float dz = position.z - light_pos.z;
+			const float depth = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+			m_draw_packets.Add(
+				uint8_t(shadow_view + c), model_idx, shader_prog_idx, m_gathered_matrices[i],
+				DrawPacketList::MakeSortKey(
+					c, shader_prog_idx, get_texture_array(model_idx), model_idx, depth
+				)
+			);
 		}
 	}
-	m_direct3d->TurnZBufferOff();
-	//m_direct3d->TurnCullingÓff();
+
+	m_draw_packets.Sort();
+
+	m_frame_stats.views = m_cameras.size();
+	m_frame_stats.gathered_objects = models.size();
+	m_frame_stats.visible_objects = visible_objects;
+	m_frame_stats.view_draw_packets.fill(0);
+	for (const auto view_idx : m_draw_packets.GetViewIndices()) {
+		m_frame_stats.view_draw_packets[view_idx]++;
+	}
+	m_frame_stats.reflection_draw_packets = m_frame_stats.view_draw_packets[reflection_view];
+	m_frame_stats.shadow_draw_packets = 0;
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		m_frame_stats.shadow_draw_packets += m_frame_stats.view_draw_packets[shadow_view + c];
+	}
+	m_frame_stats.main_draw_packets = m_draw_packets.Size()
+		- m_frame_stats.reflection_draw_packets - m_frame_stats.shadow_draw_packets;
+
+	const auto& shadow_stats = m_shadow_cascades.GetStats();
+	m_frame_stats.shadow_casters.fill(0);
+	m_frame_stats.shadow_rendered_cascades = 0;
+	if (m_shadows_enabled) {
+		m_frame_stats.shadow_casters = shadow_stats.casters;
+		m_frame_stats.shadow_rendered_cascades = shadow_stats.rendered_cascades;
+	}
+	m_frame_stats.shadow_cache_hits = shadow_stats.cache_hits;
+	m_frame_stats.shadow_cache_misses = shadow_stats.cache_misses;
+
+	// Only models that were not drawn in this frame are evicted
+	m_asset_manager->EnforceModelBudget();
+	const auto residency = m_asset_manager->GetResidencyStats();
+	m_frame_stats.model_budget_bytes = residency.budget_bytes;
+	m_frame_stats.resident_model_bytes = residency.resident_bytes;
+	m_frame_stats.resident_models = residency.resident_models;
+	m_frame_stats.evicted_models = residency.evicted_models;
+	m_frame_stats.reloaded_models = residency.reloaded_models;
+}
+
+
+auto Renderer::SubmitScene() -> HRESULT
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	const auto record_start = Clock::now();
+	RecordClears();
+	RecordCommands();
+	const auto replay_start = Clock::now();
+
+#ifdef _WIN32
+	if (m_d3d11_device != nullptr) {
+		m_d3d11_device->TurnZBufferOn();
+		//m_d3d11_device->TurnCullingOn();
+		//m_d3d11_device->TurnWireframeOn();
+	}
+	const bool deferred = m_d3d11_device != nullptr
+		&& m_d3d11_device->GetDeferredContextCount() > 0;
+#else
+	const bool deferred = false;
+#endif
+	auto result = S_OK;
+	switch (m_backend)
+	{
+		case RenderBackend::Null:
+			result = ReplayNull();
+			break;
+		case RenderBackend::Recording:
+			result = ReplayRecording();
+			break;
+		case RenderBackend::Software:
+			result = ReplaySoftware();
+			break;
+		default:
+#ifdef _WIN32
+			result = deferred ? ReplayDeferred() : ReplayImmediate();
+#else
+			result = E_NOTIMPL;
+#endif
+			break;
+	}
+
+#ifdef _WIN32
+	if (m_d3d11_device != nullptr) {
+		m_d3d11_device->TurnZBufferOff();
+		//m_d3d11_device->TurnCullingÓff();
+	}
+#endif
+	const auto replay_end = Clock::now();
+
+	size_t command_bytes{ 0 };
+	for (const auto& buffer : m_command_buffers) {
+		command_bytes += buffer.GetByteSize();
+	}
+
+	m_frame_stats.record_ms = Milliseconds(replay_start - record_start).count();
+	m_frame_stats.replay_ms = Milliseconds(replay_end - replay_start).count();
+	m_frame_stats.command_threads = m_command_buffers.size();
+	m_frame_stats.command_bytes = command_bytes;
+	m_frame_stats.deferred_contexts = deferred;
 
 	return result;
 }
 
 
-template <class T>
-void Renderer::RenderModel(ID3D11DeviceContext* device_context, const vertices::Model &model)
+void Renderer::RecordClears()
+{
+	// The split screen views share the back buffer, clearing the first one clears all
+	m_frame_commands.Clear();
+	m_frame_commands.BeginRecord(0);
+	m_frame_commands.ClearView(0);
+	const auto reflection_view = uint32_t(m_cameras.size());
+	if (m_reflection_enabled) {
+		m_frame_commands.ClearView(reflection_view);
+	}
+	// Cached cascades keep the depth of an earlier frame
+	for (size_t c = 0; m_shadows_enabled && c < ShadowCascades::CASCADE_COUNT; c++) {
+		if (m_shadow_cascades.NeedsRender(c)) {
+			m_frame_commands.ClearView(reflection_view + 1 + uint32_t(c));
+		}
+	}
+	m_frame_commands.EndRecord();
+}
+
+
+void Renderer::RecordCommands()
+{
+	for (auto& buffer : m_command_buffers) {
+		buffer.Clear();
+	}
+
+	const auto& order = m_draw_packets.GetOrder();
+	const auto& view_indices = m_draw_packets.GetViewIndices();
+	const auto& model_indices = m_draw_packets.GetModelIndices();
+	const auto& program_indices = m_draw_packets.GetProgramIndices();
+	const auto& matrix_indices = m_draw_packets.GetMatrixIndices();
+	const auto& sort_keys = m_draw_packets.GetSortKeys();
+	const auto& world_matrices = m_draw_packets.GetWorldMatrices();
+
+	// Every record sets its full state, the backends filter redundant binds on replay
+	m_thread_pool->ParallelFor(
+		order.size(), m_command_buffers.size(),
+		[&](size_t begin, size_t end, size_t chunk) {
+			auto& buffer = m_command_buffers[chunk];
+			for (size_t i = begin; i < end; i++) {
+				const auto p = order[i];
+				const auto& model = m_asset_manager->GetModel(model_indices[p]);
+				const auto texture_idx = m_asset_manager->GetModelTexture(model_indices[p]);
+
+				buffer.BeginRecord(sort_keys[p]);
+				buffer.SetView(uint32_t(view_indices[p]));
+				buffer.SetProgram(uint32_t(program_indices[p]));
+				buffer.SetModel(uint32_t(model_indices[p]));
+				if (texture_idx != assets::AssetManager::NO_TEXTURE) {
+					buffer.SetTexture(uint32_t(texture_idx));
+				}
+				buffer.SetWorldMatrix(world_matrices[matrix_indices[p]]);
+				buffer.DrawIndexed(model.indexCount, model.firstIndex, int32_t(model.baseVertex));
+				buffer.EndRecord();
+			}
+		}
+	);
+}
+
+
+auto Renderer::ReplayNull() -> HRESULT
 {
-	unsigned int stride = sizeof(T);
-	unsigned int offset = 0;
+	CommandBuffer::Merge(m_command_buffers, m_merged_commands);
 
-	// Pass the vertex buffer to the input assembler
-	device_context->IASetVertexBuffers(0, 1, model.vertexBuffer.GetAddressOf(), &stride, &offset);
+	NullCommandBackend backend;
+	m_frame_commands.Replay(backend);
+	CommandBuffer::Replay(m_command_buffers, m_merged_commands, backend);
+	return S_OK;
+}
+
+
+auto Renderer::ReplayRecording() -> HRESULT
+{
+	CommandBuffer::Merge(m_command_buffers, m_merged_commands);
+
+	// The log holds one record with the commands of the last frame
+	m_recorded_commands.Clear();
+	m_recorded_commands.BeginRecord(0);
+	RecordingCommandBackend backend(m_recorded_commands);
+	m_frame_commands.Replay(backend);
+	CommandBuffer::Replay(m_command_buffers, m_merged_commands, backend);
+	m_recorded_commands.EndRecord();
+	return S_OK;
+}
+
+
+auto Renderer::ReplaySoftware() -> HRESULT
+{
+	CommandBuffer::Merge(m_command_buffers, m_merged_commands);
+
+	m_software_target->ResetStats();
+	SoftwareCommandBackend backend(*m_asset_manager, m_software_views);
+	m_frame_commands.Replay(backend);
+	CommandBuffer::Replay(m_command_buffers, m_merged_commands, backend);
+	m_software_target->Flush();
+
+	const auto& stats = m_software_target->GetStats();
+	m_frame_stats.software_triangles = stats.triangles;
+	m_frame_stats.software_visible_triangles = stats.visible_triangles;
+	m_frame_stats.software_bin_entries = stats.bin_entries;
+	m_frame_stats.software_skipped_draws = backend.GetSkippedDraws();
+	m_frame_stats.software_setup_ms = stats.setup_ms;
+	m_frame_stats.software_raster_ms = stats.raster_ms;
+	return S_OK;
+}
+
+
+#ifdef _WIN32
+auto Renderer::ReplayImmediate() -> HRESULT
+{
+	CommandBuffer::Merge(m_command_buffers, m_merged_commands);
+
+	auto* device_context = m_d3d11_device->GetDeviceContext();
+	D3D11CommandBackend backend(
+		*m_d3d11_device, device_context, *m_shader_manager, *m_asset_manager, m_views
+	);
+	m_frame_commands.Replay(backend);
+	CommandBuffer::Replay(m_command_buffers, m_merged_commands, backend);
+	// The views changed the render target and the viewport
+	m_d3d11_device->ApplyRenderState(device_context);
+
+	m_frame_stats.buffer_binds = backend.GetBufferBinds();
+	m_frame_stats.buffer_binds_per_model = backend.GetBufferBindsPerModel();
+	m_frame_stats.texture_binds = backend.GetTextureBinds();
+	m_frame_stats.texture_binds_per_texture = backend.GetTextureBindsPerTexture();
+	m_frame_stats.shader_binds = backend.GetShaderBinds();
+	m_frame_stats.shader_binds_per_draw = backend.GetShaderBindsPerDraw();
+	return backend.GetResult();
+}
 
-	// Pass the inbdex buffer to the input assembler
-	device_context->IASetIndexBuffer(model.indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
-	// Set the rendering topology (triangle list)
-	device_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+auto Renderer::ReplayDeferred() -> HRESULT
+{
+	std::vector<HRESULT> results(m_command_buffers.size(), S_OK);
+	std::vector<size_t> buffer_binds(m_command_buffers.size(), 0);
+	std::vector<size_t> buffer_binds_per_model(m_command_buffers.size(), 0);
+	std::vector<size_t> texture_binds(m_command_buffers.size(), 0);
+	std::vector<size_t> texture_binds_per_texture(m_command_buffers.size(), 0);
+	std::vector<size_t> shader_binds(m_command_buffers.size(), 0);
+	std::vector<size_t> shader_binds_per_draw(m_command_buffers.size(), 0);
+
+	// The buffers hold contiguous ranges of the sorted packet list, so executing the command
+	// lists in buffer order equals the merged sort key order.
+	m_thread_pool->ParallelFor(
+		m_command_buffers.size(), m_command_buffers.size(),
+		[&](size_t begin, size_t end, size_t /*chunk*/) {
+			for (size_t i = begin; i < end; i++) {
+				auto* context = m_d3d11_device->GetDeferredContext(i);
+				m_d3d11_device->ApplyRenderState(context);
+
+				D3D11CommandBackend backend(
+					*m_d3d11_device, context, *m_shader_manager, *m_asset_manager, m_views
+				);
+				m_command_buffers[i].Replay(backend);
+
+				results[i] = backend.GetResult();
+				buffer_binds[i] = backend.GetBufferBinds();
+				buffer_binds_per_model[i] = backend.GetBufferBindsPerModel();
+				texture_binds[i] = backend.GetTextureBinds();
+				texture_binds_per_texture[i] = backend.GetTextureBindsPerTexture();
+				shader_binds[i] = backend.GetShaderBinds();
+				shader_binds_per_draw[i] = backend.GetShaderBindsPerDraw();
+				const auto finished = m_d3d11_device->FinishCommandList(i);
+				if (SUCCEEDED(results[i])) {
+					results[i] = finished;
+				}
+			}
+		}
+	);
+
+	// The targets are cleared before the first command list draws into them
+	auto* immediate_context = m_d3d11_device->GetDeviceContext();
+	D3D11CommandBackend clear_backend(
+		*m_d3d11_device, immediate_context, *m_shader_manager, *m_asset_manager, m_views
+	);
+	m_frame_commands.Replay(clear_backend);
+	m_d3d11_device->ExecuteCommandLists();
+	// Executing a command list without restoring resets the immediate context state
+	m_d3d11_device->ApplyRenderState(immediate_context);
+
+	m_frame_stats.buffer_binds = std::accumulate(buffer_binds.begin(), buffer_binds.end(), size_t(0));
+	m_frame_stats.buffer_binds_per_model = std::accumulate(
+		buffer_binds_per_model.begin(), buffer_binds_per_model.end(), size_t(0)
+	);
+	m_frame_stats.texture_binds = std::accumulate(
+		texture_binds.begin(), texture_binds.end(), size_t(0)
+	);
+	m_frame_stats.texture_binds_per_texture = std::accumulate(
+		texture_binds_per_texture.begin(), texture_binds_per_texture.end(), size_t(0)
+	);
+	m_frame_stats.shader_binds = std::accumulate(
+		shader_binds.begin(), shader_binds.end(), size_t(0)
+	);
+	m_frame_stats.shader_binds_per_draw = std::accumulate(
+		shader_binds_per_draw.begin(), shader_binds_per_draw.end(), size_t(0)
+	);
+
+	for (const auto result : results) {
+		if (FAILED(result)) {
+			return result;
+		}
+	}
+	return S_OK;
 }
+#endif
 
 } // namespace graphics
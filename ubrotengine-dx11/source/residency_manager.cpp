@@ -0,0 +1,158 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: residency_manager.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/residency_manager.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cassert>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+
+void ResidencyManager::Add(size_t model_idx, size_t bytes)
+{
+	if (model_idx >= m_entries.size()) {
+		m_entries.resize(model_idx + 1);
+	}
+	assert(!m_entries[model_idx].resident && "model was added twice");
+
+	m_entries[model_idx].bytes = bytes;
+	m_entries[model_idx].last_frame = m_frame;
+	m_entries[model_idx].resident = true;
+	PushFront(uint32_t(model_idx));
+
+	m_stats.resident_bytes += bytes;
+	m_stats.resident_models++;
+}
+
+
+void ResidencyManager::BeginFrame()
+{
+	m_frame++;
+}
+
+
+auto ResidencyManager::Touch(size_t model_idx) -> bool
+{
+	auto& entry = m_entries[model_idx];
+	if (!entry.resident) {
+		return false;
+	}
+
+	// Many objects share a model, only the first touch per frame has to reorder the list
+	if (entry.last_frame != m_frame) {
+		entry.last_frame = m_frame;
+		Unlink(uint32_t(model_idx));
+		PushFront(uint32_t(model_idx));
+	}
+	return true;
+}
+
+
+void ResidencyManager::Reloaded(size_t model_idx, size_t bytes)
+{
+	auto& entry = m_entries[model_idx];
+	assert(!entry.resident && "model is already resident");
+
+	entry.bytes = bytes;
+	entry.last_frame = m_frame;
+	entry.resident = true;
+	PushFront(uint32_t(model_idx));
+
+	m_stats.resident_bytes += bytes;
+	m_stats.resident_models++;
+	m_stats.reloaded_models++;
+}
+
+
+void ResidencyManager::SelectEvictions(std::vector<size_t>& evicted)
+{
+	evicted.clear();
+
+	while (m_stats.resident_bytes > m_stats.budget_bytes && m_tail != NONE) {
+		const auto model_idx = m_tail;
+		auto& entry = m_entries[model_idx];
+
+		// Everything in front of the tail was drawn at least as recently
+		if (entry.last_frame == m_frame) {
+			break;
+		}
+
+		Unlink(model_idx);
+		entry.resident = false;
+		m_stats.resident_bytes -= entry.bytes;
+		m_stats.resident_models--;
+		m_stats.evicted_models++;
+		evicted.push_back(model_idx);
+	}
+}
+
+
+void ResidencyManager::PushFront(uint32_t model_idx)
+{
+	auto& entry = m_entries[model_idx];
+	entry.prev = NONE;
+	entry.next = m_head;
+	if (m_head != NONE) {
+		m_entries[m_head].prev = model_idx;
+	}
+	else {
+		m_tail = model_idx;
+	}
+	m_head = model_idx;
+}
+
+
+void ResidencyManager::Unlink(uint32_t model_idx)
+{
+	auto& entry = m_entries[model_idx];
+	if (entry.prev != NONE) {
+		m_entries[entry.prev].next = entry.next;
+	}
+	else {
+		m_head = entry.next;
+	}
+	if (entry.next != NONE) {
+		m_entries[entry.next].prev = entry.prev;
+	}
+	else {
+		m_tail = entry.prev;
+	}
+	entry.prev = NONE;
+	entry.next = NONE;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto ResidencyManager::IsResident(size_t model_idx) const -> bool
+{
+	return model_idx < m_entries.size() && m_entries[model_idx].resident;
+}
+
+
+auto ResidencyManager::GetStats() const -> Stats
+{
+	return m_stats;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void ResidencyManager::SetBudget(size_t bytes)
+{
+	m_stats.budget_bytes = bytes;
+}
+
+} // namespace assets
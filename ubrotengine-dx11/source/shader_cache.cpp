@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_cache.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shader_cache.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <fstream>
+#include <map>
+#include <memory>
+#include <system_error>
+#ifdef _WIN32
+#include <d3dcompiler.h>
+#include <wrl\client.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+constexpr uint64_t FNV_BASIS = 0xCBF29CE484222325ULL;
+// Offset basis of the check hash, any value other than FNV_BASIS works
+constexpr uint64_t CHECK_BASIS = 0x84222325CBF29CE4ULL;
+
+/**
+ * Start of an entry file, followed by the includes, each one its hash, the size of its path
+ * and the UTF-8 path, and finally the bytecode.
+ */
+struct EntryHeader
+{
+	uint32_t magic{ 0 };
+	uint32_t version{ 0 };
+	uint64_t check{ 0 };
+	uint32_t include_count{ 0 };
+	uint32_t bytecode_size{ 0 };
+};
+
+/**
+ * 64 bit FNV-1a, continues from \p hash.
+ */
+auto Hash(const void* data, size_t size, uint64_t hash) -> uint64_t
+{
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+/**
+ * Hashes a string together with its size, so the parts of a key can not run into each other.
+ */
+auto HashString(const std::string& value, uint64_t hash) -> uint64_t
+{
+	const auto size = uint64_t(value.size());
+	hash = Hash(&size, sizeof(size), hash);
+	return Hash(value.data(), value.size(), hash);
+}
+
+auto ToUtf8(const fs::path& path) -> std::string
+{
+	const auto name = path.u8string();
+	return { name.begin(), name.end() };
+}
+
+auto FromUtf8(const std::string& name) -> fs::path
+{
+	return fs::path(std::u8string(name.begin(), name.end()));
+}
+
+auto ReadFile(const fs::path& path, std::string& content) -> bool
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (file.fail()) {
+		return false;
+	}
+	const auto size = std::streamoff(file.tellg());
+	if (size < 0) {
+		return false;
+	}
+	content.resize(size_t(size));
+	file.seekg(0);
+	file.read(content.data(), std::streamsize(size));
+	return !file.fail();
+}
+
+template <class T>
+auto ReadValue(std::istream& stream, T& value) -> bool
+{
+	return !stream.read(reinterpret_cast<char*>(&value), sizeof(T)).fail();
+}
+
+template <class T>
+void WriteValue(std::ostream& stream, const T& value)
+{
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+#ifdef _WIN32
+/**
+ * Include handler for \c D3DCompile that reads files relative to the file that includes
+ * them and remembers every file it opened.
+ */
+class IncludeRecorder : public ID3DInclude
+{
+
+public:
+	IncludeRecorder(const fs::path& path, std::vector<fs::path>& includes) :
+		m_root(path.parent_path()),
+		m_includes(includes)
+	{
+	}
+
+	auto __stdcall Open(
+		D3D_INCLUDE_TYPE type, LPCSTR filename, LPCVOID parent_data, LPCVOID* data, UINT* size
+	) -> HRESULT override
+	{
+		UNREFERENCED_PARAMETER(type);
+
+		// The main file is not opened through the handler, so it has no entry
+		const auto parent = m_directories.find(parent_data);
+		const auto& directory = parent != m_directories.end() ? parent->second : m_root;
+		auto path = (directory / fs::path(filename)).lexically_normal();
+
+		auto content = std::make_unique<std::string>();
+		if (!ReadFile(path, *content)) {
+			return E_FAIL;
+		}
+		*data = content->data();
+		*size = UINT(content->size());
+		m_directories.insert({ *data, path.parent_path() });
+		m_includes.push_back(std::move(path));
+		m_files.push_back(std::move(content));
+		return S_OK;
+	}
+
+	auto __stdcall Close(LPCVOID data) -> HRESULT override
+	{
+		// The content stays alive until the compile is done, nested includes still refer
+		// to the directory of their parent
+		UNREFERENCED_PARAMETER(data);
+		return S_OK;
+	}
+
+private:
+	fs::path m_root;
+	std::vector<fs::path>& m_includes;
+	std::vector<std::unique_ptr<std::string>> m_files{};
+	std::map<LPCVOID, fs::path> m_directories{};
+};
+#endif
+
+} // namespace
+
+
+ShaderCache::ShaderCache(fs::path directory, Compiler compiler) :
+	m_directory(std::move(directory)),
+	m_compiler(compiler != nullptr ? std::move(compiler) : Compiler(CompileD3D))
+{
+}
+
+
+auto ShaderCache::Get(
+	const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode, std::string& errors
+) -> HRESULT
+{
+	errors.clear();
+	std::string source;
+	if (!ReadFile(desc.path, source)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.failed++;
+		return E_FAIL;
+	}
+
+	const auto key = ComputeKey(desc, source);
+	bool outdated{ false };
+	if (Load(key, bytecode, outdated)) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.hits++;
+		return S_OK;
+	}
+
+	ShaderCompileOutput output;
+	const auto result = m_compiler(desc, source, output);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.misses++;
+		m_stats.invalidated += outdated ? 1 : 0;
+		m_stats.failed += FAILED(result) ? 1 : 0;
+	}
+	errors = std::move(output.errors);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	// A cache that can not be written only costs the next start its compile
+	Store(key, output);
+	bytecode = std::move(output.bytecode);
+	return S_OK;
+}
+
+
+void ShaderCache::Clear()
+{
+	std::error_code error;
+	fs::remove_all(m_directory, error);
+}
+
+
+auto ShaderCache::GetStats() const -> Stats
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+
+auto ShaderCache::GetDirectory() const -> const fs::path&
+{
+	return m_directory;
+}
+
+
+auto ShaderCache::CompileD3D(
+	const ShaderCompileDesc& desc, const std::string& source, ShaderCompileOutput& output
+) -> HRESULT
+{
+#ifdef _WIN32
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const auto& define : desc.defines) {
+		macros.push_back({ define.name.c_str(), define.value.c_str() });
+	}
+	macros.push_back({ nullptr, nullptr });
+
+	IncludeRecorder include(desc.path, output.includes);
+	Microsoft::WRL::ComPtr<ID3D10Blob> shader_buffer{ nullptr };
+	Microsoft::WRL::ComPtr<ID3D10Blob> error_message{ nullptr };
+	const auto name = desc.path.string();
+	const auto result = D3DCompile(
+		source.data(), source.size(), name.c_str(), macros.data(), &include,
+		desc.entry_point.c_str(), desc.target.c_str(), desc.flags, 0,
+		shader_buffer.GetAddressOf(), error_message.GetAddressOf()
+	);
+
+	if (error_message != nullptr) {
+		const auto* text = static_cast<const char*>(error_message->GetBufferPointer());
+		output.errors.assign(text, error_message->GetBufferSize());
+	}
+	if (FAILED(result)) {
+		return result;
+	}
+	const auto* bytes = static_cast<const uint8_t*>(shader_buffer->GetBufferPointer());
+	output.bytecode.assign(bytes, bytes + shader_buffer->GetBufferSize());
+	return result;
+#else
+	UNREFERENCED_PARAMETER(desc);
+	UNREFERENCED_PARAMETER(source);
+	output.errors = "D3DCompile is only available on Windows";
+	return E_NOTIMPL;
+#endif
+}
+
+
+auto ShaderCache::ComputeKey(const ShaderCompileDesc& desc, const std::string& source) -> Key
+{
+	// Includes are resolved relative to the file, so the same text in another directory
+	// may compile differently
+	// Normalized before the file name is removed, "a/b/.." would keep a trailing separator
+	const auto directory = ToUtf8(desc.path.lexically_normal().parent_path());
+	const auto flags = uint64_t(desc.flags);
+
+	const auto hash_all = [&](uint64_t hash) {
+		hash = Hash(&VERSION, sizeof(VERSION), hash);
+		hash = HashString(source, hash);
+		hash = HashString(directory, hash);
+		hash = HashString(desc.entry_point, hash);
+		hash = HashString(desc.target, hash);
+		hash = Hash(&flags, sizeof(flags), hash);
+		for (const auto& define : desc.defines) {
+			hash = HashString(define.name, hash);
+			hash = HashString(define.value, hash);
+		}
+		return hash;
+	};
+	return { hash_all(FNV_BASIS), hash_all(CHECK_BASIS) };
+}
+
+
+auto ShaderCache::HashFile(const fs::path& path, uint64_t& hash) -> bool
+{
+	std::string content;
+	if (!ReadFile(path, content)) {
+		return false;
+	}
+	hash = HashString(content, FNV_BASIS);
+	return true;
+}
+
+
+auto ShaderCache::GetEntryPath(const Key& key) const -> fs::path
+{
+	constexpr char DIGITS[] = "0123456789abcdef";
+	std::string name(16, '0');
+	for (size_t i = 0; i < name.size(); i++) {
+		name[name.size() - 1 - i] = DIGITS[(key.hash >> (4 * i)) & 15];
+	}
+	return m_directory / (name + ".cso");
+}
+
+
+auto ShaderCache::Load(const Key& key, std::vector<uint8_t>& bytecode, bool& outdated) const
+	-> bool
+{
+	std::ifstream file(GetEntryPath(key), std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+
+	// A broken or foreign entry is treated like an outdated one, the compile replaces it
+	outdated = true;
+	EntryHeader header;
+	if (!ReadValue(file, header) || header.magic != MAGIC || header.version != VERSION
+		|| header.check != key.check) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header.include_count; i++) {
+		uint64_t stored_hash{ 0 };
+		uint32_t path_size{ 0 };
+		if (!ReadValue(file, stored_hash) || !ReadValue(file, path_size)) {
+			return false;
+		}
+		std::string path(path_size, '\0');
+		if (file.read(path.data(), path_size).fail()) {
+			return false;
+		}
+		uint64_t hash{ 0 };
+		if (!HashFile(FromUtf8(path), hash) || hash != stored_hash) {
+			return false;
+		}
+	}
+
+	bytecode.resize(header.bytecode_size);
+	if (file.read(reinterpret_cast<char*>(bytecode.data()), header.bytecode_size).fail()) {
+		return false;
+	}
+	outdated = false;
+	return true;
+}
+
+
+auto ShaderCache::Store(const Key& key, const ShaderCompileOutput& output) -> bool
+{
+	std::error_code error;
+	fs::create_directories(m_directory, error);
+	if (error) {
+		return false;
+	}
+
+	// Written to a temporary file first, so a reader never sees half an entry
+	const auto path = GetEntryPath(key);
+	auto temp_path = path;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		temp_path += ".tmp" + std::to_string(m_store_count++);
+	}
+
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		EntryHeader header;
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.check = key.check;
+		header.include_count = uint32_t(output.includes.size());
+		header.bytecode_size = uint32_t(output.bytecode.size());
+		WriteValue(file, header);
+
+		for (const auto& include : output.includes) {
+			uint64_t hash{ 0 };
+			if (!HashFile(include, hash)) {
+				file.close();
+				fs::remove(temp_path, error);
+				return false;
+			}
+			const auto name = ToUtf8(include);
+			WriteValue(file, hash);
+			WriteValue(file, uint32_t(name.size()));
+			file.write(name.data(), std::streamsize(name.size()));
+		}
+		file.write(
+			reinterpret_cast<const char*>(output.bytecode.data()),
+			std::streamsize(output.bytecode.size())
+		);
+		if (file.fail()) {
+			file.close();
+			fs::remove(temp_path, error);
+			return false;
+		}
+	}
+
+	fs::rename(temp_path, path, error);
+	if (error) {
+		fs::remove(temp_path, error);
+		return false;
+	}
+	return true;
+}
+
+} // namespace graphics
@@ -6,114 +6,409 @@
 //////////////
 // INCLUDES //
 //////////////
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iterator>
 
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+// Written by the shaders command of the tools in the pre-build step of the release DLL, debug
+// builds always compile from the files. The device-free core of the CMake build has no
+// shader compiler and never embeds.
+#if !defined(_DEBUG) && defined(UBROTENGINEDX11_EXPORTS)
+#if !__has_include("../header/embedded_shader_data.h")
+#error "header/embedded_shader_data.h is missing, it is written by: ubrotengine-tools shaders"
+#endif
+#include "../header/embedded_shader_data.h"
+#define SHADER_MANAGER_EMBEDDED
+#endif
 
 
 namespace graphics
 {
 
-auto ShaderManager::Initialize(ID3D11Device* device, HWND hwnd) -> HRESULT
+namespace
 {
-	auto result{ S_OK };
 
-	size_t idx = 0;
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
 #if _DEBUG
-	LPCWSTR vs_path = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/color.vs";
-	LPCWSTR fs_path = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/color.fs";
-	LPCWSTR layout_path = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/layout.vs";
+const std::wstring SHADER_DIRECTORY = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/";
 #else
-	LPCWSTR vs_path = L"shader/color.vs";
-	LPCWSTR fs_path = L"shader/color.fs";
-	LPCWSTR layout_path = L"shader/layout.vs";
+const std::wstring SHADER_DIRECTORY = L"shader/";
 #endif
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddShader(device, hwnd, ShaderProgram::ShaderType::VertexShader, vs_path);
-	if (FAILED(result)) {
-		return result;
-	}
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddShader(device, hwnd, ShaderProgram::ShaderType::FragmentShader, fs_path);
-	if (FAILED(result)) {
-		return result;
+
+// Variants that are used right after the start, all others are compiled on first use
+constexpr std::array<std::tuple<ShaderProg, FeatureMask>, 2> PRECOMPILED_VARIANTS = { {
+	{ ShaderProg::SimShader, 0 },
+	{ ShaderProg::ColShader, 0 },
+} };
+
+} // namespace
+
+
+ShaderManager::ShaderManager(ShaderCache::Compiler compiler, size_t compile_threads) :
+	// The programs without features keep the indices of ShaderProg
+	m_shader_progs(size_t(ShaderProg::NUMBER)),
+#ifdef SHADER_MANAGER_EMBEDDED
+	m_embedded_shaders(EMBEDDED_SHADERS, std::size(EMBEDDED_SHADERS)),
+#endif
+	m_shader_cache(ShaderCache::DEFAULT_DIRECTORY, std::move(compiler)),
+	m_compile_threads(compile_threads)
+{
+	for (auto& program : m_variants) {
+		program.variants.fill(NOT_COMPILED);
 	}
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddLayout(device, hwnd, layout_path);
-	if (FAILED(result)) {
-		return result;
+}
+
+
+auto ShaderManager::Initialize(RenderDevice& device, HWND hwnd) -> HRESULT
+{
+	const auto start = Clock::now();
+	m_device = &device;
+	m_hwnd = hwnd;
+
+	for (const auto& entry : SHADER_MANIFEST) {
+		ShaderProgramDesc desc;
+		desc.vs_path = SHADER_DIRECTORY + entry.vs_file;
+		desc.fs_path = SHADER_DIRECTORY + entry.fs_file;
+		desc.layout_path = SHADER_DIRECTORY + entry.layout_file;
+		desc.features = entry.features;
+		DeclareShaderProgram(entry.program, std::move(desc));
 	}
-	std::get<0>(m_default_shader_progs.at(idx)).AddBuffer(device);
-	idx++;
-	if (FAILED(result)) {
-		return result;
+
+	for (const auto& [program, features] : PRECOMPILED_VARIANTS) {
+		PrecompileVariant(program, features);
 	}
+	const auto result = WaitForVariants();
+	m_stats.startup_ms = Milliseconds(Clock::now() - start).count();
+	return result;
+}
 
-	// TODO(rwarnking) save layout in the manager and give the shader only an index
-#if _DEBUG
-	vs_path = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/color.vs";
-	fs_path = L"../../engine/ubrotengine-dx11/ubrotengine-dx11/shader/color.fs";
-#else
-	vs_path = L"shader/color.vs";
-	fs_path = L"shader/color.fs";
-#endif
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddShader(device, hwnd, ShaderProgram::ShaderType::VertexShader, vs_path);
-	if (FAILED(result)) {
-		return result;
+
+void ShaderManager::Shutdown()
+{
+	m_compile_threads.Wait();
+	m_finished.clear();
+
+	for (auto& s : m_shader_progs) {
+		std::get<0>(s).Shutdown();
 	}
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddShader(device, hwnd, ShaderProgram::ShaderType::FragmentShader, fs_path);
-	if (FAILED(result)) {
-		return result;
+	for (auto& program : m_variants) {
+		program.variants.fill(NOT_COMPILED);
 	}
-	result = std::get<0>(m_default_shader_progs.at(idx)).AddLayout(device, hwnd, layout_path);
-	if (FAILED(result)) {
-		return result;
+	m_stats.variants = 0;
+	m_stats.pending = 0;
+}
+
+
+void ShaderManager::DeclareShaderProgram(ShaderProg program, ShaderProgramDesc desc)
+{
+	// Variants of the previous files are compiled again on their next use
+	auto& declaration = m_variants.at(size_t(program));
+	for (auto& idx : declaration.variants) {
+		if (idx == PENDING_VARIANT) {
+			m_stats.pending--;
+		}
+		else if (idx != NOT_COMPILED && idx != FAILED_VARIANT) {
+			std::get<0>(m_shader_progs.at(idx)).Shutdown();
+			m_stats.variants--;
+		}
+		idx = NOT_COMPILED;
 	}
-	std::get<0>(m_default_shader_progs.at(idx)).AddBuffer(device);
-	idx++;
-	if (FAILED(result)) {
-		return result;
+	declaration.desc = std::move(desc);
+	declaration.desc.features &= FeatureMask(VARIANT_COUNT - 1);
+	declaration.generation++;
+}
+
+
+void ShaderManager::PrecompileVariant(ShaderProg program, FeatureMask features)
+{
+	const auto& declaration = m_variants.at(size_t(program));
+	const auto mask = features & declaration.desc.features;
+	if (declaration.variants[mask] == NOT_COMPILED) {
+		StartCompile(program, mask);
 	}
-	
+}
+
+
+auto ShaderManager::WaitForVariants() -> HRESULT
+{
+	m_compile_threads.Wait();
+	return CreateFinishedVariants();
+}
+
+
+auto ShaderManager::Update() -> HRESULT
+{
+	const auto start = Clock::now();
+	const auto result = CreateFinishedVariants();
+	const auto update_ms = Milliseconds(Clock::now() - start).count();
+	m_stats.longest_update_ms = std::max(m_stats.longest_update_ms, update_ms);
+	m_stats.hitches += update_ms > HITCH_MS ? 1 : 0;
 	return result;
 }
 
 
-void ShaderManager::Shutdown()
+auto ShaderManager::GetVariant(ShaderProg program, FeatureMask features) -> size_t
 {
-	for (auto& s : m_default_shader_progs) {
-		std::get<0>(s).Shutdown();
+	const auto& declaration = m_variants[size_t(program)];
+	const auto mask = features & declaration.desc.features;
+	const auto idx = declaration.variants[mask];
+	if (idx < FAILED_VARIANT) {
+		return size_t(idx);
 	}
+
+	if (idx == NOT_COMPILED) {
+		// An embedded variant is ready right after the call
+		StartCompile(program, mask);
+		const auto created = declaration.variants[mask];
+		if (created < FAILED_VARIANT) {
+			return size_t(created);
+		}
+	}
+	return GetFallback(program);
 }
 
 
 auto ShaderManager::AddCustomShaderProgram() -> std::tuple<size_t, ShaderProgram&>
 {
-	m_custom_shader_progs.emplace_back();
-	auto& t = m_custom_shader_progs.back();
+	m_shader_progs.emplace_back();
+	auto& t = m_shader_progs.back();
 	std::get<1>(t)++;
-	return std::forward_as_tuple(m_custom_shader_progs.size(), std::get<0>(t));
+	return std::forward_as_tuple(m_shader_progs.size() - 1, std::get<0>(t));
 }
 
 
 auto ShaderManager::GetShaderProgram(size_t shader_prog_idx) -> ShaderProgram&
 {
-	if (shader_prog_idx >= size_t(ShaderProg::NUMBER)) {
-		auto idx = shader_prog_idx - size_t(ShaderProg::NUMBER);
-		return std::get<0>(m_custom_shader_progs.at(idx));
-	}
-	return std::get<0>(m_default_shader_progs.at(shader_prog_idx));
+	return std::get<0>(m_shader_progs.at(shader_prog_idx));
 }
 
 
 void ShaderManager::RemoveShaderProgram(size_t program_idx)
 {
-	assert(program_idx < m_default_shader_progs.size() && "RemoveShaderProgram oob");
+	assert(program_idx < m_shader_progs.size() && "RemoveShaderProgram oob");
 
-	auto& t = m_default_shader_progs.at(program_idx);
+	auto& t = m_shader_progs.at(program_idx);
 	if (std::get<1>(t) == 0) {
 		std::get<0>(t).Shutdown();
+		// A variant that is removed is compiled again if it is used
+		for (auto& program : m_variants) {
+			for (auto& idx : program.variants) {
+				if (idx == program_idx) {
+					idx = NOT_COMPILED;
+					m_stats.variants--;
+				}
+			}
+		}
 	}
 	std::get<1>(t)--;
 }
 
+
+auto ShaderManager::GetShaderRegistry() const -> const ShaderRegistry&
+{
+	return m_shader_registry;
+}
+
+
+auto ShaderManager::GetShaderStats() const -> ShaderRegistry::Stats
+{
+	return m_shader_registry.GetStats();
+}
+
+
+auto ShaderManager::GetVariantStats() const -> VariantStats
+{
+	return m_stats;
+}
+
+
+void ShaderManager::StartCompile(ShaderProg program, FeatureMask features)
+{
+	auto& declaration = m_variants.at(size_t(program));
+	const auto& desc = declaration.desc;
+	if (desc.vs_path.empty() || desc.fs_path.empty() || desc.layout_path.empty()) {
+		declaration.variants[features] = FAILED_VARIANT;
+		return;
+	}
+
+	declaration.variants[features] = PENDING_VARIANT;
+	m_stats.pending++;
+
+	CompiledVariant compiled;
+	compiled.program = program;
+	compiled.features = features;
+	compiled.generation = declaration.generation;
+
+	// Embedded bytecode needs neither the files nor a compile, so it is created right away
+	auto stages = GetStageDescs(desc, GetFeatureDefines(features));
+	if (LoadEmbedded(stages, compiled)) {
+		m_stats.embedded++;
+		CreateVariant(compiled);
+		return;
+	}
+
+	// A device that never runs the shaders takes the variant without its bytecode
+	if (!m_device->UsesBytecode()) {
+		CreateVariant(compiled);
+		return;
+	}
+
+	m_compile_threads.Submit([this, stages = std::move(stages), compiled]() mutable {
+		CompileVariant(stages, compiled);
+		std::lock_guard<std::mutex> lock(m_finished_mutex);
+		m_finished.push_back(std::move(compiled));
+	});
+}
+
+
+auto ShaderManager::GetStageDescs(
+	const ShaderProgramDesc& desc, const std::vector<ShaderDefine>& defines
+) -> StageDescs
+{
+	using ShaderType = ShaderProgram::ShaderType;
+	return { {
+		ShaderProgram::GetCompileDesc(ShaderType::VertexShader, desc.vs_path.c_str(), defines),
+		ShaderProgram::GetCompileDesc(ShaderType::FragmentShader, desc.fs_path.c_str(), defines),
+		ShaderProgram::GetLayoutCompileDesc(desc.layout_path.c_str(), defines),
+	} };
+}
+
+
+auto ShaderManager::LoadEmbedded(const StageDescs& stages, CompiledVariant& compiled) const
+	-> bool
+{
+	const std::array<std::vector<uint8_t>*, 3> bytecodes = {
+		&compiled.vs_bytecode, &compiled.fs_bytecode, &compiled.layout_bytecode
+	};
+
+	// A variant is only taken from the binary if all of its stages are embedded
+	std::array<const EmbeddedShader*, 3> shaders{};
+	for (size_t i = 0; i < stages.size(); i++) {
+		shaders[i] = m_embedded_shaders.Find(stages[i]);
+		if (shaders[i] == nullptr) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < shaders.size(); i++) {
+		bytecodes[i]->assign(shaders[i]->bytecode, shaders[i]->bytecode + shaders[i]->size);
+	}
+	compiled.result = S_OK;
+	return true;
+}
+
+
+void ShaderManager::CompileVariant(const StageDescs& stages, CompiledVariant& compiled)
+{
+	const std::array<std::vector<uint8_t>*, 3> bytecodes = {
+		&compiled.vs_bytecode, &compiled.fs_bytecode, &compiled.layout_bytecode
+	};
+
+	for (size_t i = 0; i < stages.size(); i++) {
+		compiled.result = m_shader_cache.Get(stages[i], *bytecodes[i], compiled.errors);
+		if (FAILED(compiled.result)) {
+			compiled.error_path = stages[i].path.wstring();
+			return;
+		}
+	}
+}
+
+
+auto ShaderManager::CreateFinishedVariants() -> HRESULT
+{
+	std::vector<CompiledVariant> finished;
+	{
+		std::lock_guard<std::mutex> lock(m_finished_mutex);
+		finished.swap(m_finished);
+	}
+
+	auto result{ S_OK };
+	for (const auto& compiled : finished) {
+		const auto r = CreateVariant(compiled);
+		if (FAILED(r) && SUCCEEDED(result)) {
+			result = r;
+		}
+	}
+	return result;
+}
+
+
+auto ShaderManager::CreateVariant(const CompiledVariant& compiled) -> HRESULT
+{
+	auto& declaration = m_variants.at(size_t(compiled.program));
+	auto& idx = declaration.variants[compiled.features];
+	// The program was declared again or shut down while it compiled
+	if (compiled.generation != declaration.generation || idx != PENDING_VARIANT) {
+		return S_OK;
+	}
+	m_stats.pending--;
+
+	// A failed variant is not compiled again, it would fail every frame
+	auto result = compiled.result;
+	if (FAILED(result)) {
+		ShaderProgram::ReportCompileError(m_hwnd, compiled.errors, compiled.error_path.c_str());
+		idx = FAILED_VARIANT;
+		m_stats.failed++;
+		return result;
+	}
+
+	// The program without features has its slot already, all other variants get a new one
+	const auto program_idx = compiled.features == 0
+		? size_t(compiled.program) : m_shader_progs.size();
+	if (compiled.features != 0) {
+		m_shader_progs.emplace_back();
+	}
+	auto& shader_program = std::get<0>(m_shader_progs.at(program_idx));
+
+	result = shader_program.AddShader(
+		*m_device, ShaderProgram::ShaderType::VertexShader, compiled.vs_bytecode,
+		m_shader_registry
+	);
+	if (SUCCEEDED(result)) {
+		result = shader_program.AddShader(
+			*m_device, ShaderProgram::ShaderType::FragmentShader, compiled.fs_bytecode,
+			m_shader_registry
+		);
+	}
+	if (SUCCEEDED(result)) {
+		result = shader_program.AddLayout(*m_device, compiled.layout_bytecode, m_shader_registry);
+	}
+	if (SUCCEEDED(result)) {
+		result = shader_program.AddBuffer(*m_device);
+	}
+
+	if (FAILED(result)) {
+		shader_program.Shutdown();
+		if (compiled.features != 0) {
+			m_shader_progs.pop_back();
+		}
+		idx = FAILED_VARIANT;
+		m_stats.failed++;
+		return result;
+	}
+	idx = uint32_t(program_idx);
+	m_stats.variants++;
+	return result;
+}
+
+
+auto ShaderManager::GetFallback(ShaderProg program) -> size_t
+{
+	for (const auto fallback : { program, FALLBACK_PROGRAM }) {
+		const auto idx = m_variants[size_t(fallback)].variants[0];
+		if (idx < FAILED_VARIANT) {
+			m_stats.fallback_draws++;
+			return size_t(idx);
+		}
+	}
+	m_stats.skipped_draws++;
+	return NO_PROGRAM;
+}
+
 } // namespace graphics
@@ -8,9 +8,10 @@
 // INCLUDES //
 //////////////
 #include <array>
-#include <d3dcompiler.h>
+#include <cstdio>
 #include <fstream>
 #include <memory>
+#include <utility>
 
 
 ///////////////////////
@@ -21,23 +22,83 @@
 namespace graphics
 {
 
+namespace
+{
+
+// D3DCOMPILE_ENABLE_STRICTNESS, the compiler header is only included by the cache
+constexpr uint32_t COMPILE_ENABLE_STRICTNESS = 1 << 11;
+
+} // namespace
+
+
+ShaderProgram::BindState::BindState()
+{
+	shaders.fill(ShaderRegistry::NO_HANDLE);
+}
+
+
+ShaderProgram::ShaderProgram()
+{
+	m_shaders.fill(ShaderRegistry::NO_HANDLE);
+}
+
+
+ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept :
+	m_device(other.m_device),
+	m_matrix_buffer(std::exchange(other.m_matrix_buffer, RenderDevice::NO_RESOURCE)),
+	m_texture_buffer(std::exchange(other.m_texture_buffer, RenderDevice::NO_RESOURCE)),
+	m_registry(other.m_registry),
+	m_layout(std::exchange(other.m_layout, ShaderRegistry::NO_HANDLE)),
+	m_shaders(other.m_shaders)
+{
+	// The handles belong to this program now, the other one must not release them
+	other.m_shaders.fill(ShaderRegistry::NO_HANDLE);
+}
+
+
 void ShaderProgram::Shutdown()
 {
-	for (auto& s : m_shaders) {
-		s.reset();
-		m_layout.Reset();
-		m_matrix_buffer.Reset();
+	if (m_device != nullptr) {
+		if (m_registry != nullptr) {
+			m_registry->Release(*m_device, m_layout);
+			for (const auto handle : m_shaders) {
+				m_registry->Release(*m_device, handle);
+			}
+		}
+		m_device->Release(m_matrix_buffer);
+		m_device->Release(m_texture_buffer);
 	}
+	m_layout = ShaderRegistry::NO_HANDLE;
+	m_shaders.fill(ShaderRegistry::NO_HANDLE);
+	m_matrix_buffer = RenderDevice::NO_RESOURCE;
+	m_texture_buffer = RenderDevice::NO_RESOURCE;
 }
 
 auto ShaderProgram::AddShader(
-	ID3D11Device* device, HWND hwnd, ShaderType shader_type, LPCWSTR path
+	RenderDevice& device, HWND hwnd, ShaderType shader_type, LPCWSTR path, ShaderCache& cache,
+	ShaderRegistry& registry, const std::vector<ShaderDefine>& defines
+) -> HRESULT
+{
+	std::vector<uint8_t> bytecode;
+	auto result = GetBytecode(
+		hwnd, cache, GetCompileDesc(shader_type, path, defines), bytecode
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+	return AddShader(device, shader_type, bytecode, registry);
+}
+
+
+auto ShaderProgram::AddShader(
+	RenderDevice& device, ShaderType shader_type, const std::vector<uint8_t>& bytecode,
+	ShaderRegistry& registry
 ) -> HRESULT
 {
 	switch (shader_type)
 	{
 		case ShaderType::VertexShader:
-			return CreateShader<ShaderProgram::VertexShader>(device, hwnd, path);
+			return CreateShader<ShaderProgram::VertexShader>(device, bytecode, registry);
 		//case ShaderType::GeometryShader:
 		//	return CreateShader<ShaderProgram::GeometryShader>(device, hwnd, path);
 		//case ShaderType::HullShader:
@@ -45,7 +106,7 @@ auto ShaderProgram::AddShader(
 		//case ShaderType::DomainShader:
 		//	return CreateShader<ShaderProgram::DomainShader>(device, hwnd, path);
 		case ShaderType::FragmentShader:
-			return CreateShader<ShaderProgram::PixelShader>(device, hwnd, path);
+			return CreateShader<ShaderProgram::PixelShader>(device, bytecode, registry);
 		//case ShaderType::ComputeShader:
 		//	return CreateShader<ShaderProgram::ComputeShader>(device, hwnd, path);
 		default:
@@ -54,189 +115,209 @@ auto ShaderProgram::AddShader(
 }
 
 
+auto ShaderProgram::GetCompileDesc(
+	ShaderType shader_type, LPCWSTR path, const std::vector<ShaderDefine>& defines
+) -> ShaderCompileDesc
+{
+	ShaderCompileDesc desc;
+	desc.path = path;
+	desc.defines = defines;
+	desc.flags = COMPILE_ENABLE_STRICTNESS;
+	switch (shader_type)
+	{
+		case ShaderType::VertexShader:
+			desc.entry_point = VertexShader::entry_point;
+			desc.target = VertexShader::type;
+			break;
+		case ShaderType::FragmentShader:
+			desc.entry_point = PixelShader::entry_point;
+			desc.target = PixelShader::type;
+			break;
+		default:
+			break;
+	}
+	return desc;
+}
+
+
+auto ShaderProgram::GetLayoutCompileDesc(
+	LPCWSTR vs_shader_path, const std::vector<ShaderDefine>& defines
+) -> ShaderCompileDesc
+{
+	auto desc = GetCompileDesc(ShaderType::VertexShader, vs_shader_path, defines);
+	desc.entry_point = "LVertexShader";
+	return desc;
+}
+
+
+void ShaderProgram::ReportCompileError(HWND hwnd, const std::string& errors, LPCWSTR path)
+{
+	if (!errors.empty()) {
+		OutputShaderErrorMessage(errors, hwnd, path);
+	}
+	else {
+#ifdef _WIN32
+		MessageBox(hwnd, path, L"Missing Shader File", MB_OK);
+#else
+		UNREFERENCED_PARAMETER(hwnd);
+		std::fprintf(stderr, "Missing shader file %ls\n", path);
+#endif
+	}
+}
+
+
 template <typename T>
 auto ShaderProgram::CreateShader(
-	ID3D11Device *device, HWND hwnd, LPCWSTR shader_path
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
 ) -> HRESULT
 {
-	HRESULT result{ TRUE };
-	Microsoft::WRL::ComPtr<ID3D10Blob> error_message{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D10Blob> shader_buffer{ nullptr };
-
-	// Try to compile the fragment shader code given by the file and print an error if it fails
-	result = D3DCompileFromFile(
-		shader_path, nullptr, nullptr, T::entry_point, T::type,
-		D3D10_SHADER_ENABLE_STRICTNESS, 0, shader_buffer.GetAddressOf(), error_message.GetAddressOf());
+	ShaderRegistry::Handle handle{ ShaderRegistry::NO_HANDLE };
+	auto result = T::Acquire(registry, device, bytecode, handle);
 	if (FAILED(result)) {
-		if (error_message != nullptr) {
-			OutputShaderErrorMessage(error_message.Get(), hwnd, shader_path);
-		}
-		else {
-			MessageBox(hwnd, shader_path, L"Missing Shader File", MB_OK);
-		}
-
 		return result;
 	}
+	// A stage that is added again replaces the previous shader
+	m_device = &device;
+	m_registry = &registry;
+	registry.Release(device, m_shaders[size_t(T::stage)]);
+	m_shaders[size_t(T::stage)] = handle;
+	return result;
+}
+
+
+auto ShaderProgram::GetBytecode(
+	HWND hwnd, ShaderCache& cache, const ShaderCompileDesc& desc, std::vector<uint8_t>& bytecode
+) -> HRESULT
+{
+	// Try to get the shader code given by the file and print an error if it fails
+	std::string error_message;
+	auto result = cache.Get(desc, bytecode, error_message);
+	if (FAILED(result)) {
+		ReportCompileError(hwnd, error_message, desc.path.wstring().c_str());
+	}
+	return result;
+}
+
 
-	m_shaders.push_back(std::make_unique<T>(T()));
-	return m_shaders.back()->Create(device, shader_buffer.Get());
+auto ShaderProgram::AddLayout(
+	RenderDevice& device, HWND hwnd, LPCWSTR vs_shader_path, ShaderCache& cache,
+	ShaderRegistry& registry, const std::vector<ShaderDefine>& defines
+) -> HRESULT
+{
+	std::vector<uint8_t> bytecode;
+	auto result = GetBytecode(
+		hwnd, cache, GetLayoutCompileDesc(vs_shader_path, defines), bytecode
+	);
+	if (FAILED(result)) {
+		return result;
+	}
+	return AddLayout(device, bytecode, registry);
 }
 
 
 auto ShaderProgram::AddLayout(
-	ID3D11Device* device, HWND hwnd, LPCWSTR vs_shader_path
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
 ) -> HRESULT
 {
 	auto result{ S_OK };
 
-	std::array<D3D11_INPUT_ELEMENT_DESC, 2> polygonLayout{};
 	// Prepare the layout to describe the structure of a vertex. Every attribute translates to
-	// a slot whose format and other characteristics have to be set manually.
-	// Uses D3D11_APPEND_ALIGNED_ELEMENT to ensure that data blocks are aligned sensibly.
-	// The structure here must conform to that in the shader file and the vertex struct.
-	polygonLayout[0].SemanticName = "POSITION";
-	polygonLayout[0].SemanticIndex = 0;
-	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[0].InputSlot = 0;
-	polygonLayout[0].AlignedByteOffset = 0;
-	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[0].InstanceDataStepRate = 0;
-
-	polygonLayout[1].SemanticName = "COLOR";
-	polygonLayout[1].SemanticIndex = 0;
-	polygonLayout[1].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	polygonLayout[1].InputSlot = 0;
-	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[1].InstanceDataStepRate = 0;
-
-	unsigned int numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
-
-	Microsoft::WRL::ComPtr<ID3D10Blob> error_message{ nullptr };
-	Microsoft::WRL::ComPtr<ID3D10Blob> shader_buffer{ nullptr };
-	// Try to compile the vertex shader code given by the file and print an error if it fails
-	result = D3DCompileFromFile(
-		vs_shader_path, nullptr, nullptr, "LVertexShader", "vs_5_0",
-		D3D10_SHADER_ENABLE_STRICTNESS, 0, shader_buffer.GetAddressOf(), error_message.GetAddressOf());
+	// a slot whose format has to be set manually. APPEND_ALIGNED ensures that data blocks are
+	// aligned sensibly. The structure here must conform to that in the shader file and the
+	// vertex struct.
+	const std::vector<VertexElement> polygonLayout = {
+		{ "POSITION", 0, TextureFormat::R32G32B32_FLOAT, 0 },
+		{ "COLOR", 0, TextureFormat::R32G32B32A32_FLOAT, VertexElement::APPEND_ALIGNED },
+	};
+
+	// Get the input layout for the previously filled description, programs with the same
+	// layout share it
+	ShaderRegistry::Handle handle{ ShaderRegistry::NO_HANDLE };
+	result = registry.AcquireLayout(device, polygonLayout, bytecode, handle);
 	if (FAILED(result)) {
-		if (error_message != nullptr) {
-			OutputShaderErrorMessage(error_message.Get(), hwnd, vs_shader_path);
-		}
-		else {
-			MessageBox(hwnd, vs_shader_path, L"Missing Shader File", MB_OK);
-		}
-
 		return result;
 	}
-
-	// Create the input layout and store it in m_layout, using the previously filled description
-	result = device->CreateInputLayout(
-		polygonLayout.data(), numElements,
-		shader_buffer->GetBufferPointer(),
-		shader_buffer->GetBufferSize(), m_layout.GetAddressOf()
-	);
+	m_device = &device;
+	m_registry = &registry;
+	registry.Release(device, m_layout);
+	m_layout = handle;
 	return result;
 }
 
 
 // TODO(rwarnking) change to variable buffer
-auto ShaderProgram::AddBuffer(ID3D11Device* device) -> HRESULT
+auto ShaderProgram::AddBuffer(RenderDevice& device) -> HRESULT
 {
-	D3D11_BUFFER_DESC buffer_desc;
-
-	buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
-	buffer_desc.ByteWidth = sizeof(MatrixBufferType);
-	buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	buffer_desc.MiscFlags = 0;
-	buffer_desc.StructureByteStride = 0;
-
-	return device->CreateBuffer(&buffer_desc, nullptr, m_matrix_buffer.GetAddressOf());
-}
+	m_device = &device;
+	device.Release(m_matrix_buffer);
+	device.Release(m_texture_buffer);
+	m_texture_buffer = RenderDevice::NO_RESOURCE;
 
-
-// in generell smarter attribute/buffer setup?
-auto XM_CALLCONV ShaderProgram::Render(
-	ID3D11DeviceContext *deviceContext,
-	const DirectX::FXMMATRIX& worldMatrix,
-	const DirectX::CXMMATRIX& viewMatrix,
-	const DirectX::CXMMATRIX& projectionMatrix,
-	unsigned int indexCount
-) -> HRESULT
-{
-	auto result{ S_OK };
-	D3D11_MAPPED_SUBRESOURCE mappedResource;
-
-	// Matrices must be transposed (because DirectX 11)
-	const DirectX::XMMATRIX worldMatrixTransposed = XMMatrixTranspose(worldMatrix);
-	const DirectX::XMMATRIX viewMatrixTransposed = XMMatrixTranspose(viewMatrix);
-	const DirectX::XMMATRIX projectionMatrixTransposed = XMMatrixTranspose(projectionMatrix);
-
-	// Lock the constant buffer so it can be written to.
-	result = deviceContext->Map(
-		m_matrix_buffer.Get(),
-		0, D3D11_MAP_WRITE_DISCARD,
-		0, &mappedResource
+	auto result = device.CreateBuffer(
+		BufferUsage::Constant, sizeof(MatrixBufferType), m_matrix_buffer
 	);
 	if (FAILED(result)) {
 		return result;
 	}
+	return device.CreateBuffer(
+		BufferUsage::Constant, sizeof(TextureBufferType), m_texture_buffer
+	);
+}
 
-	auto *data_ptr1 = static_cast<MatrixBufferType*>(mappedResource.pData);
-	data_ptr1->world = worldMatrixTransposed;
-	data_ptr1->view = viewMatrixTransposed;
-	data_ptr1->projection = projectionMatrixTransposed;
-
-	deviceContext->Unmap(m_matrix_buffer.Get(), 0);
-
-	// Choose the buffer number to be used in the shader and set the buffer
-	unsigned int bufferNumber = 0;
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, m_matrix_buffer.GetAddressOf());
 
+auto ShaderProgram::GetLayout() const -> ShaderRegistry::Handle
+{
+	return m_layout;
+}
 
-	// Call render to draw
-	RenderShader(deviceContext, indexCount);
 
-	return result;
+auto ShaderProgram::GetShaders() const
+	-> const std::array<ShaderRegistry::Handle, size_t(ShaderType::NUMBER)>&
+{
+	return m_shaders;
 }
 
 
-void ShaderProgram::RenderShader(ID3D11DeviceContext *deviceContext, unsigned int indexCount)
+auto ShaderProgram::GetMatrixBuffer() const -> RenderDevice::Handle
 {
-	deviceContext->IASetInputLayout(m_layout.Get());
+	return m_matrix_buffer;
+}
 
-	for (auto& s : m_shaders) {
-		s->Set(deviceContext);
-	}
 
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+auto ShaderProgram::GetTextureBuffer() const -> RenderDevice::Handle
+{
+	return m_texture_buffer;
 }
 
 
 void ShaderProgram::OutputShaderErrorMessage(
-	ID3D10Blob *errorMessage,
+	const std::string& errorMessage,
 	HWND hwnd,
 	const WCHAR *shaderFilename
 )
 {
-	// Prepare error messages
-	size_t buffer_size = errorMessage->GetBufferSize();
-	std::string err_string(static_cast<char*>(errorMessage->GetBufferPointer()), buffer_size);
-
 	// Open the file to write to
 	std::ofstream fout;
 	fout.open("shader-error.txt");
-	fout << err_string;
+	fout << errorMessage;
 	fout.close();
 
 	// Open a message box to signal to the user that an error has occurred and can be
 	// inspected in the previously written file.
+#ifdef _WIN32
 	MessageBox(
 		hwnd,
 		L"Error compiling shader.  Check shader-error.txt for message.",
 		shaderFilename,
 		MB_OK
 	);
+#else
+	UNREFERENCED_PARAMETER(hwnd);
+	std::fprintf(
+		stderr, "Error compiling shader %ls. Check shader-error.txt for message.\n",
+		shaderFilename
+	);
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -247,11 +328,11 @@ void ShaderProgram::OutputShaderErrorMessage(
 
 template HRESULT
 ShaderProgram::CreateShader<ShaderProgram::PixelShader>(
-	ID3D11Device* device, HWND hwnd, LPCWSTR shader_path
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
 );
 template HRESULT
 ShaderProgram::CreateShader<ShaderProgram::VertexShader>(
-	ID3D11Device* device, HWND hwnd, LPCWSTR shader_path
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, ShaderRegistry& registry
 );
 
 } // namespace graphics
@@ -0,0 +1,172 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_registry.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shader_registry.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cassert>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+/**
+ * 64 bit FNV-1a.
+ */
+auto Hash(const std::vector<uint8_t>& data) -> uint64_t
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (const auto byte : data) {
+		hash = (hash ^ byte) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+template <class T>
+void Append(std::vector<uint8_t>& key, const T& value)
+{
+	const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+	key.insert(key.end(), bytes, bytes + sizeof(T));
+}
+
+} // namespace
+
+
+auto ShaderRegistry::AcquireVertexShader(
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, Handle& handle
+) -> HRESULT
+{
+	auto key = bytecode;
+	return Acquire(Kind::VertexShader, std::move(key), handle, [&](RenderDevice::Handle& object) {
+		return device.CreateShader(ShaderStage::Vertex, bytecode, object);
+	});
+}
+
+
+auto ShaderRegistry::AcquirePixelShader(
+	RenderDevice& device, const std::vector<uint8_t>& bytecode, Handle& handle
+) -> HRESULT
+{
+	auto key = bytecode;
+	return Acquire(Kind::PixelShader, std::move(key), handle, [&](RenderDevice::Handle& object) {
+		return device.CreateShader(ShaderStage::Pixel, bytecode, object);
+	});
+}
+
+
+auto ShaderRegistry::AcquireLayout(
+	RenderDevice& device, const std::vector<VertexElement>& elements,
+	const std::vector<uint8_t>& bytecode, Handle& handle
+) -> HRESULT
+{
+	// The semantic names are pointers, so they are added as text
+	std::vector<uint8_t> key;
+	for (const auto& element : elements) {
+		const auto* name = reinterpret_cast<const uint8_t*>(element.semantic);
+		key.insert(key.end(), name, name + std::strlen(element.semantic) + 1);
+		Append(key, element.semantic_index);
+		Append(key, element.format);
+		Append(key, element.offset);
+	}
+	key.insert(key.end(), bytecode.begin(), bytecode.end());
+
+	return Acquire(Kind::InputLayout, std::move(key), handle, [&](RenderDevice::Handle& object) {
+		return device.CreateInputLayout(elements, bytecode, object);
+	});
+}
+
+
+void ShaderRegistry::Release(RenderDevice& device, Handle handle)
+{
+	if (handle == NO_HANDLE) {
+		return;
+	}
+	auto& entry = m_entries[handle];
+	assert(entry.references > 0 && "ShaderRegistry handle released too often");
+	m_stats.references--;
+	if (--entry.references > 0) {
+		return;
+	}
+
+	auto [begin, end] = m_lookup.equal_range(entry.hash);
+	for (auto it = begin; it != end; it++) {
+		if (it->second == handle) {
+			m_lookup.erase(it);
+			break;
+		}
+	}
+	device.Release(entry.object);
+	entry = Entry();
+	m_free_handles.push_back(handle);
+	m_stats.objects--;
+}
+
+
+auto ShaderRegistry::GetDeviceHandle(Handle handle) const -> RenderDevice::Handle
+{
+	return m_entries[handle].object;
+}
+
+
+auto ShaderRegistry::GetStats() const -> Stats
+{
+	return m_stats;
+}
+
+
+template <class F>
+auto ShaderRegistry::Acquire(Kind kind, std::vector<uint8_t>&& key, Handle& handle, F&& create)
+	-> HRESULT
+{
+	const auto hash = Hash(key);
+	auto [begin, end] = m_lookup.equal_range(hash);
+	for (auto it = begin; it != end; it++) {
+		auto& entry = m_entries[it->second];
+		if (entry.kind == kind && entry.key == key) {
+			entry.references++;
+			m_stats.references++;
+			m_stats.shared++;
+			handle = it->second;
+			return S_OK;
+		}
+	}
+
+	Entry entry;
+	entry.kind = kind;
+	entry.hash = hash;
+	entry.key = std::move(key);
+	entry.references = 1;
+	auto result = create(entry.object);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	if (!m_free_handles.empty()) {
+		handle = m_free_handles.back();
+		m_free_handles.pop_back();
+		m_entries[handle] = std::move(entry);
+	}
+	else {
+		handle = Handle(m_entries.size());
+		m_entries.push_back(std::move(entry));
+	}
+	m_lookup.insert({ hash, handle });
+	m_stats.objects++;
+	m_stats.references++;
+	m_stats.created++;
+	return result;
+}
+
+} // namespace graphics
@@ -0,0 +1,262 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shadow_cascades.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shadow_cascades.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cmath>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+constexpr uint64_t FNV_PRIME = 0x100000001B3ULL;
+constexpr uint64_t FNV_BASIS = 0xCBF29CE484222325ULL;
+
+/**
+ * 64 bit FNV-1a, continues from \p hash.
+ */
+auto Hash(const void* data, size_t size, uint64_t hash) -> uint64_t
+{
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash = (hash ^ bytes[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+auto Distance(const math::Float3& a, const math::Float3& b) -> float
+{
+	const float dx = a.x - b.x;
+	const float dy = a.y - b.y;
+	const float dz = a.z - b.z;
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
+
+
+void ShadowCascades::SetShadowMap(uint32_t resolution, float distance, float caster_range)
+{
+	if (resolution == m_resolution && distance == m_distance && caster_range == m_caster_range) {
+		return;
+	}
+	m_resolution = resolution;
+	m_distance = distance;
+	m_caster_range = caster_range;
+
+	// The cached maps were rendered for the old values
+	for (auto& cascade : m_cascades) {
+		cascade.valid = false;
+	}
+}
+
+
+void ShadowCascades::SetLightDirection(const math::Float3& direction)
+{
+	const float length = Distance(direction, { 0.0F, 0.0F, 0.0F });
+	const math::Float3 normalized(
+		direction.x / length, direction.y / length, direction.z / length
+	);
+	if (normalized.x == m_light_direction.x && normalized.y == m_light_direction.y
+		&& normalized.z == m_light_direction.z) {
+		return;
+	}
+	m_light_direction = normalized;
+
+	for (auto& cascade : m_cascades) {
+		cascade.valid = false;
+	}
+}
+
+
+void ShadowCascades::Update(const Camera& camera, float near_z, float far_z)
+{
+	// Radii are rounded up to this fraction of a world unit, so float noise while the camera
+	// turns does not change the size of a cascade
+	constexpr float RADIUS_STEP = 16.0F;
+	constexpr size_t CORNERS = 4;
+	constexpr std::array<float, CORNERS> CORNER_X = { -1.0F, 1.0F, -1.0F, 1.0F };
+	constexpr std::array<float, CORNERS> CORNER_Y = { -1.0F, -1.0F, 1.0F, 1.0F };
+
+	m_splits = ComputeSplits(near_z, std::min(m_distance, far_z), SPLIT_LAMBDA);
+
+	// The corners of a slice lie on the lines between the corners of the near and the far
+	// plane, the view depth changes linearly along them
+	const auto inverse = camera.GetInverseViewProjectionMatrix();
+	std::array<math::Float3, CORNERS> near_corners;
+	std::array<math::Float3, CORNERS> corner_rays;
+	for (size_t i = 0; i < CORNERS; i++) {
+		near_corners[i] = math::TransformCoord({ CORNER_X[i], CORNER_Y[i], 0.0F }, inverse);
+		const auto far_corner = math::TransformCoord({ CORNER_X[i], CORNER_Y[i], 1.0F }, inverse);
+		corner_rays[i] = far_corner - near_corners[i];
+	}
+
+	float slice_near = near_z;
+	for (size_t c = 0; c < CASCADE_COUNT; c++) {
+		const float t_near = (slice_near - near_z) / (far_z - near_z);
+		const float t_far = (m_splits[c] - near_z) / (far_z - near_z);
+		slice_near = m_splits[c];
+
+		std::array<math::Float3, CORNERS * 2> corners;
+		math::Float3 sum{ 0.0F, 0.0F, 0.0F };
+		for (size_t i = 0; i < CORNERS; i++) {
+			corners[i * 2] = near_corners[i] + corner_rays[i] * t_near;
+			corners[i * 2 + 1] = near_corners[i] + corner_rays[i] * t_far;
+			sum = sum + corners[i * 2];
+			sum = sum + corners[i * 2 + 1];
+		}
+		const auto center = sum * (1.0F / float(corners.size()));
+		float radius{ 0.0F };
+		for (const auto& corner : corners) {
+			radius = std::max(radius, math::Length(corner - center));
+		}
+		radius = std::ceil(radius * RADIUS_STEP) / RADIUS_STEP;
+
+		// Cached cascades only move once their slice leaves the region they cover
+		auto& cascade = m_cascades[c];
+		cascade.moved = c < FIRST_CACHED_CASCADE || !cascade.valid
+			|| Distance(center, cascade.center) + radius > cascade.radius;
+		if (!cascade.moved) {
+			continue;
+		}
+		cascade.radius = c < FIRST_CACHED_CASCADE ? radius : radius * CACHE_MARGIN;
+		cascade.center = SnapToTexels(center, cascade.radius);
+		PlaceCamera(c);
+	}
+}
+
+
+void ShadowCascades::Cull(
+	const ViewCuller& culler, const std::vector<uint32_t>& keys, utils::ThreadPool& pool
+)
+{
+	std::array<uint64_t, CASCADE_COUNT> hashes{};
+	pool.ParallelFor(CASCADE_COUNT, CASCADE_COUNT, [&](size_t begin, size_t end, size_t) {
+		for (size_t c = begin; c < end; c++) {
+			auto& casters = m_casters[c];
+			casters.clear();
+			culler.CullPlanes(ViewCuller::GetPlanes(m_cameras[c]), casters);
+
+			// The content of a shadow map only depends on its casters
+			uint64_t hash = FNV_BASIS;
+			for (const auto idx : casters) {
+				const auto sphere = culler.GetSphere(idx);
+				hash = Hash(&keys[idx], sizeof(uint32_t), hash);
+				hash = Hash(&sphere, sizeof(sphere), hash);
+			}
+			hashes[c] = hash;
+		}
+	});
+
+	m_stats.rendered_cascades = 0;
+	for (size_t c = 0; c < CASCADE_COUNT; c++) {
+		auto& cascade = m_cascades[c];
+		if (c < FIRST_CACHED_CASCADE) {
+			cascade.needs_render = true;
+		}
+		else {
+			cascade.needs_render = cascade.moved || hashes[c] != cascade.caster_hash;
+			m_stats.cache_misses += cascade.needs_render ? 1 : 0;
+			m_stats.cache_hits += cascade.needs_render ? 0 : 1;
+		}
+		cascade.caster_hash = hashes[c];
+		cascade.valid = true;
+		m_stats.casters[c] = m_casters[c].size();
+		m_stats.rendered_cascades += cascade.needs_render ? 1 : 0;
+	}
+}
+
+
+auto ShadowCascades::GetCamera(size_t cascade) const -> const Camera&
+{
+	return m_cameras[cascade];
+}
+
+
+auto ShadowCascades::GetSplit(size_t cascade) const -> float
+{
+	return m_splits[cascade];
+}
+
+
+auto ShadowCascades::GetCasters(size_t cascade) const -> const std::vector<uint32_t>&
+{
+	return m_casters[cascade];
+}
+
+
+auto ShadowCascades::NeedsRender(size_t cascade) const -> bool
+{
+	return m_cascades[cascade].needs_render;
+}
+
+
+auto ShadowCascades::GetStats() const -> const Stats&
+{
+	return m_stats;
+}
+
+
+auto ShadowCascades::ComputeSplits(float near_z, float far_z, float lambda)
+	-> std::array<float, CASCADE_COUNT>
+{
+	std::array<float, CASCADE_COUNT> splits{};
+	for (size_t i = 0; i < CASCADE_COUNT; i++) {
+		const float share = float(i + 1) / float(CASCADE_COUNT);
+		const float logarithmic = near_z * std::pow(far_z / near_z, share);
+		const float uniform = near_z + (far_z - near_z) * share;
+		splits[i] = lambda * logarithmic + (1.0F - lambda) * uniform;
+	}
+	splits.back() = far_z;
+	return splits;
+}
+
+
+auto ShadowCascades::SnapToTexels(const math::Float3& center, float radius) const
+	-> math::Float3
+{
+	// In light space the texels of the map form a grid in x and y
+	const auto rotation = Camera::ComputeViewMatrix({ 0.0F, 0.0F, 0.0F }, m_light_direction);
+	auto light_space = math::TransformCoord(center, rotation);
+	const float texel = radius * 2.0F / float(m_resolution);
+	light_space.x = std::floor(light_space.x / texel) * texel;
+	light_space.y = std::floor(light_space.y / texel) * texel;
+
+	return math::TransformCoord(light_space, math::Inverse(rotation));
+}
+
+
+void ShadowCascades::PlaceCamera(size_t cascade)
+{
+	// The camera sits far enough towards the light to see all casters in front of the region
+	const auto& region = m_cascades[cascade];
+	const auto& direction = m_light_direction;
+	const float back = region.radius + m_caster_range;
+	const math::Float3 position(
+		region.center.x - direction.x * back,
+		region.center.y - direction.y * back,
+		region.center.z - direction.z * back
+	);
+
+	auto& camera = m_cameras[cascade];
+	camera.SetView(position, direction);
+	camera.SetProjection(math::OrthographicLH(
+		region.radius * 2.0F, region.radius * 2.0F, 0.0F, back + region.radius
+	));
+	camera.Update();
+}
+
+} // namespace graphics
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shadow_map.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shadow_map.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+auto ShadowMap::Initialize(RenderDevice& device, uint32_t size, uint32_t slice_count) -> HRESULT
+{
+	device.Release(m_target);
+	m_target = RenderDevice::NO_RESOURCE;
+
+	auto result = device.CreateDepthArray(size, slice_count, m_target);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	m_viewport.x = 0.0F;
+	m_viewport.y = 0.0F;
+	m_viewport.width = float(size);
+	m_viewport.height = float(size);
+	m_viewport.min_depth = 0.0F;
+	m_viewport.max_depth = 1.0F;
+	return result;
+}
+
+
+auto ShadowMap::GetTarget() const -> RenderDevice::Handle
+{
+	return m_target;
+}
+
+
+auto ShadowMap::GetViewport() const -> const Viewport&
+{
+	return m_viewport;
+}
+
+} // namespace graphics
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: skyline_packer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/skyline_packer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+{
+	Reset(width, height);
+}
+
+
+void SkylinePacker::Reset(uint32_t width, uint32_t height)
+{
+	m_width = width;
+	m_height = height;
+	m_used_area = 0;
+	m_skyline.clear();
+	m_skyline.push_back({ 0, 0, width });
+}
+
+
+auto SkylinePacker::Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) -> bool
+{
+	if (width == 0 || height == 0 || width > m_width || height > m_height) {
+		return false;
+	}
+
+	size_t best_idx = SIZE_MAX;
+	uint32_t best_y = UINT32_MAX;
+	uint64_t best_waste = UINT64_MAX;
+
+	for (size_t i = 0; i < m_skyline.size(); i++) {
+		uint32_t fit_y{ 0 };
+		uint64_t waste{ 0 };
+		if (!Fit(i, width, height, fit_y, waste)) {
+			continue;
+		}
+		if (fit_y < best_y || (fit_y == best_y && waste < best_waste)) {
+			best_idx = i;
+			best_y = fit_y;
+			best_waste = waste;
+		}
+	}
+
+	if (best_idx == SIZE_MAX) {
+		return false;
+	}
+
+	x = m_skyline[best_idx].x;
+	y = best_y;
+	Place(best_idx, x, y, width, height);
+	m_used_area += uint64_t(width) * height;
+	return true;
+}
+
+
+auto SkylinePacker::GetWidth() const -> uint32_t
+{
+	return m_width;
+}
+
+
+auto SkylinePacker::GetHeight() const -> uint32_t
+{
+	return m_height;
+}
+
+
+auto SkylinePacker::GetUsedArea() const -> uint64_t
+{
+	return m_used_area;
+}
+
+
+auto SkylinePacker::GetUsedHeight() const -> uint32_t
+{
+	uint32_t height{ 0 };
+	for (const auto& segment : m_skyline) {
+		height = std::max(height, segment.y);
+	}
+	return height;
+}
+
+
+auto SkylinePacker::GetOccupancy() const -> float
+{
+	const auto area = uint64_t(m_width) * GetUsedHeight();
+	return area > 0 ? float(double(m_used_area) / double(area)) : 0.0F;
+}
+
+
+auto SkylinePacker::Fit(
+	size_t idx, uint32_t width, uint32_t height, uint32_t& y, uint64_t& waste
+) const -> bool
+{
+	const uint32_t x = m_skyline[idx].x;
+	if (x + width > m_width) {
+		return false;
+	}
+
+	// The rectangle rests on the highest segment it spans
+	y = 0;
+	uint32_t remaining = width;
+	for (size_t i = idx; remaining > 0; i++) {
+		y = std::max(y, m_skyline[i].y);
+		remaining -= std::min(remaining, m_skyline[i].width);
+	}
+	if (y + height > m_height) {
+		return false;
+	}
+
+	// Area between the segments and the bottom of the rectangle, it can never be used again
+	waste = 0;
+	remaining = width;
+	for (size_t i = idx; remaining > 0; i++) {
+		const auto span = std::min(remaining, m_skyline[i].width);
+		waste += uint64_t(y - m_skyline[i].y) * span;
+		remaining -= span;
+	}
+	return true;
+}
+
+
+void SkylinePacker::Place(size_t idx, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+	// Cut away the segments that are covered by the rectangle
+	const uint32_t right = x + width;
+	size_t end = idx;
+	while (end < m_skyline.size() && m_skyline[end].x + m_skyline[end].width <= right) {
+		end++;
+	}
+	if (end < m_skyline.size() && m_skyline[end].x < right) {
+		// Partially covered segment, keep the part to the right
+		auto& segment = m_skyline[end];
+		segment.width -= right - segment.x;
+		segment.x = right;
+	}
+	m_skyline.erase(m_skyline.begin() + ptrdiff_t(idx), m_skyline.begin() + ptrdiff_t(end));
+	m_skyline.insert(m_skyline.begin() + ptrdiff_t(idx), { x, y + height, width });
+
+	// Merge neighbours of equal height, this keeps the list short
+	for (size_t i = 0; i + 1 < m_skyline.size();) {
+		if (m_skyline[i].y == m_skyline[i + 1].y) {
+			m_skyline[i].width += m_skyline[i + 1].width;
+			m_skyline.erase(m_skyline.begin() + ptrdiff_t(i + 1));
+		}
+		else {
+			i++;
+		}
+	}
+}
+
+} // namespace utils
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: software_command_backend.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/software_command_backend.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+SoftwareCommandBackend::SoftwareCommandBackend(
+	assets::AssetManager& asset_manager, const std::vector<View>& views
+) :
+	m_asset_manager{ asset_manager },
+	m_views{ views }
+{
+}
+
+
+void SoftwareCommandBackend::SetProgram(uint32_t /*program_idx*/)
+{
+}
+
+
+void SoftwareCommandBackend::SetModel(uint32_t model_idx)
+{
+	if (model_idx == m_model_idx) {
+		return;
+	}
+	m_model_idx = model_idx;
+	m_model = &m_asset_manager.GetModel(model_idx);
+}
+
+
+void SoftwareCommandBackend::SetWorldMatrix(const math::Float4x4& world)
+{
+	m_world_matrix = world;
+}
+
+
+void SoftwareCommandBackend::SetTexture(uint32_t /*texture_idx*/)
+{
+}
+
+
+void SoftwareCommandBackend::DrawIndexed(
+	uint32_t index_count, uint32_t start_index, int32_t base_vertex
+)
+{
+	const auto* vertex_data = m_model != nullptr
+		? m_asset_manager.GetVertexData(m_model->vertexStride)
+		: nullptr;
+	const auto* index_data = m_asset_manager.GetIndexData();
+	if (m_target == nullptr || vertex_data == nullptr || index_data == nullptr
+		|| m_model->vertexStride != sizeof(vertices::ColVertex)) {
+		m_skipped_draws++;
+		return;
+	}
+
+	// The vertices of a model follow each other, the indices are relative to the first one
+	const auto* model_vertices = reinterpret_cast<const vertices::ColVertex*>(vertex_data)
+		+ base_vertex;
+	const auto transform = math::Multiply(m_world_matrix, m_view_projection);
+	m_target->DrawIndexed(
+		model_vertices, m_model->vertexCount, index_data + start_index, index_count, transform
+	);
+}
+
+
+void SoftwareCommandBackend::SetView(uint32_t view_idx)
+{
+	if (view_idx == m_view_idx || view_idx >= m_views.size()) {
+		return;
+	}
+	m_view_idx = view_idx;
+
+	const auto& view = m_views[view_idx];
+	m_target = view.target;
+	if (m_target != nullptr) {
+		m_target->SetViewport(view.viewport);
+	}
+	m_view_projection = view.camera->GetViewProjectionMatrix();
+}
+
+
+void SoftwareCommandBackend::ClearView(uint32_t view_idx)
+{
+	if (view_idx >= m_views.size()) {
+		return;
+	}
+	const auto& view = m_views[view_idx];
+	if (view.target != nullptr) {
+		view.target->Clear(view.clear_color, 1.0F);
+	}
+}
+
+
+auto SoftwareCommandBackend::GetSkippedDraws() const -> size_t
+{
+	return m_skipped_draws;
+}
+
+} // namespace graphics
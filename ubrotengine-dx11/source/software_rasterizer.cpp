@@ -0,0 +1,713 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: software_rasterizer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/software_rasterizer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SOFTWARE_RASTERIZER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+using Clock = std::chrono::high_resolution_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+// Pixels that are tested together
+constexpr int32_t BLOCK_SIZE = 8;
+
+// Planes a vertex can be outside of
+enum Outcode : uint8_t
+{
+	Near = 1,
+	Left = 2,
+	Right = 4,
+	Bottom = 8,
+	Top = 16
+};
+constexpr uint32_t PLANE_COUNT = 5;
+
+// A triangle gains at most one vertex per plane it is clipped against
+constexpr size_t MAX_CLIP_VERTICES = 3 + PLANE_COUNT;
+
+auto ToUnorm8(float value) -> uint32_t
+{
+	return uint32_t(std::clamp(value, 0.0F, 1.0F) * 255.0F + 0.5F);
+}
+
+auto PackColor(const std::array<float, 4>& color) -> uint32_t
+{
+	return ToUnorm8(color[0]) | (ToUnorm8(color[1]) << 8U) | (ToUnorm8(color[2]) << 16U)
+		| (ToUnorm8(color[3]) << 24U);
+}
+
+auto Snap(float value) -> float
+{
+	return std::nearbyint(value * SoftwareRasterizer::SUBPIXEL_STEPS)
+		* (1.0F / SoftwareRasterizer::SUBPIXEL_STEPS);
+}
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+auto ToUnorm8(__m128 value) -> __m128i
+{
+	value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0F));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0F)), _mm_set1_ps(0.5F)));
+}
+
+/**
+ * Coverage and edge function values of four pixels.
+ */
+struct Lanes
+{
+	__m128 covered;
+	__m128 edges[3];
+};
+
+auto Select(__m128i mask, __m128i a, __m128i b) -> __m128i
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Returns the lanes that are inside of an edge, or on it if it is a top or left edge.
+ */
+auto InsideEdge(__m128 value, bool top_left) -> __m128
+{
+	const auto inside = _mm_cmpgt_ps(value, _mm_setzero_ps());
+	if (!top_left) {
+		return inside;
+	}
+	return _mm_or_ps(inside, _mm_cmpeq_ps(value, _mm_setzero_ps()));
+}
+#endif
+
+} // namespace
+
+
+SoftwareRasterizer::SoftwareRasterizer(utils::ThreadPool* thread_pool) :
+	m_thread_pool{ thread_pool }
+{
+}
+
+
+void SoftwareRasterizer::Resize(uint32_t width, uint32_t height)
+{
+	m_width = width;
+	m_height = height;
+	m_pitch = (width + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+	m_color.assign(size_t(m_pitch) * height, 0);
+	m_depth.assign(size_t(m_pitch) * height, 1.0F);
+
+	m_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_bins.assign(size_t(m_tiles_x) * m_tiles_y, {});
+	m_triangles.clear();
+	m_active_tiles.clear();
+}
+
+
+void SoftwareRasterizer::SetViewport(const Viewport& viewport)
+{
+	m_viewport = viewport;
+	m_viewport_min_x = std::max(int32_t(viewport.x), 0);
+	m_viewport_min_y = std::max(int32_t(viewport.y), 0);
+	m_viewport_max_x = std::min(int32_t(viewport.x + viewport.width), int32_t(m_width)) - 1;
+	m_viewport_max_y = std::min(int32_t(viewport.y + viewport.height), int32_t(m_height)) - 1;
+
+	// Extent of the guard band in normalized device coordinates
+	m_guard_band[0] = 1.0F + 2.0F * GUARD_BAND_PIXELS / std::max(viewport.width, 1.0F);
+	m_guard_band[1] = 1.0F + 2.0F * GUARD_BAND_PIXELS / std::max(viewport.height, 1.0F);
+}
+
+
+void SoftwareRasterizer::Clear(const std::array<float, 4>& color, float depth)
+{
+	Flush();
+
+	const auto packed = PackColor(color);
+	auto clear_rows = [&](size_t begin, size_t end, size_t /*chunk*/) {
+		std::fill(m_color.begin() + begin * m_pitch, m_color.begin() + end * m_pitch, packed);
+		std::fill(m_depth.begin() + begin * m_pitch, m_depth.begin() + end * m_pitch, depth);
+	};
+	if (m_thread_pool != nullptr) {
+		m_thread_pool->ParallelFor(m_height, m_thread_pool->GetThreadCount(), clear_rows);
+	}
+	else {
+		clear_rows(0, m_height, 0);
+	}
+}
+
+
+void SoftwareRasterizer::DrawIndexed(
+	const vertices::ColVertex* vertices, uint32_t vertex_count,
+	const uint32_t* indices, uint32_t index_count,
+	const math::Float4x4& transform
+)
+{
+	if (m_viewport_min_x > m_viewport_max_x || m_viewport_min_y > m_viewport_max_y) {
+		return;
+	}
+	const auto start = Clock::now();
+	TransformVertices(vertices, vertex_count, transform);
+
+	for (uint32_t i = 0; i + 2 < index_count; i += 3) {
+		m_stats.triangles++;
+		const auto i0 = indices[i];
+		const auto i1 = indices[i + 1];
+		const auto i2 = indices[i + 2];
+		if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
+			continue;
+		}
+
+		// Outside of the same plane, e.g. behind the camera
+		const uint32_t c0 = m_outcodes[i0];
+		const uint32_t c1 = m_outcodes[i1];
+		const uint32_t c2 = m_outcodes[i2];
+		if ((c0 & c1 & c2) != 0) {
+			continue;
+		}
+		if ((c0 | c1 | c2) == 0) {
+			SetupTriangle(m_screen[i0], m_screen[i1], m_screen[i2]);
+			continue;
+		}
+
+		std::array<ClipVertex, 3> triangle;
+		const std::array<uint32_t, 3> corners = { i0, i1, i2 };
+		for (size_t v = 0; v < 3; v++) {
+			const auto& clip = m_clip[corners[v]];
+			triangle[v].position = { clip.x, clip.y, clip.z, clip.w };
+			triangle[v].color = m_screen[corners[v]].color;
+		}
+		ClipTriangle(triangle, c0 | c1 | c2);
+	}
+
+	m_stats.setup_ms += Milliseconds(Clock::now() - start).count();
+}
+
+
+void SoftwareRasterizer::Flush()
+{
+	if (m_triangles.empty()) {
+		return;
+	}
+	const auto start = Clock::now();
+
+	m_active_tiles.clear();
+	for (size_t tile = 0; tile < m_bins.size(); tile++) {
+		if (!m_bins[tile].empty()) {
+			m_active_tiles.push_back(tile);
+		}
+	}
+
+	// One chunk per tile, tiles differ a lot in cost
+	auto rasterize = [&](size_t begin, size_t end, size_t /*chunk*/) {
+		for (size_t i = begin; i < end; i++) {
+			RasterizeTile(m_active_tiles[i]);
+		}
+	};
+	if (m_thread_pool != nullptr) {
+		m_thread_pool->ParallelFor(m_active_tiles.size(), m_active_tiles.size(), rasterize);
+	}
+	else {
+		rasterize(0, m_active_tiles.size(), 0);
+	}
+
+	for (const auto tile : m_active_tiles) {
+		m_bins[tile].clear();
+	}
+	m_triangles.clear();
+	m_stats.raster_ms += Milliseconds(Clock::now() - start).count();
+}
+
+
+void SoftwareRasterizer::ReadImage(io::Image& image) const
+{
+	image.width = m_width;
+	image.height = m_height;
+	image.srgb = false;
+	image.pixels.resize(size_t(m_width) * m_height * sizeof(uint32_t));
+	// The pixels are stored as R8G8B8A8 in memory order
+	for (uint32_t y = 0; y < m_height; y++) {
+		std::memcpy(
+			image.pixels.data() + size_t(y) * m_width * sizeof(uint32_t),
+			m_color.data() + size_t(y) * m_pitch, size_t(m_width) * sizeof(uint32_t)
+		);
+	}
+}
+
+
+void SoftwareRasterizer::TransformVertices(
+	const vertices::ColVertex* vertices, uint32_t count, const math::Float4x4& transform
+)
+{
+	m_clip.resize(count);
+	m_screen.resize(count);
+	m_outcodes.resize(count);
+
+	const auto& m = transform;
+
+	const float half_width = m_viewport.width * 0.5F;
+	const float half_height = m_viewport.height * 0.5F;
+	const float center_x = m_viewport.x + half_width;
+	const float center_y = m_viewport.y + half_height;
+	const float depth_range = m_viewport.max_depth - m_viewport.min_depth;
+
+	uint32_t i = 0;
+#ifdef SOFTWARE_RASTERIZER_SSE2
+	// Four vertices per iteration, one lane each
+	for (; i + 4 <= count; i += 4) {
+		const auto& p0 = vertices[i].position;
+		const auto& p1 = vertices[i + 1].position;
+		const auto& p2 = vertices[i + 2].position;
+		const auto& p3 = vertices[i + 3].position;
+		const auto x = _mm_setr_ps(p0.x, p1.x, p2.x, p3.x);
+		const auto y = _mm_setr_ps(p0.y, p1.y, p2.y, p3.y);
+		const auto z = _mm_setr_ps(p0.z, p1.z, p2.z, p3.z);
+
+		auto column = [&](size_t c) {
+			return _mm_add_ps(
+				_mm_add_ps(
+					_mm_mul_ps(x, _mm_set1_ps(m.m[0][c])), _mm_mul_ps(y, _mm_set1_ps(m.m[1][c]))
+				),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(m.m[2][c])), _mm_set1_ps(m.m[3][c]))
+			);
+		};
+		const auto clip_x = column(0);
+		const auto clip_y = column(1);
+		const auto clip_z = column(2);
+		const auto w = column(3);
+
+		const auto guard_x = _mm_mul_ps(w, _mm_set1_ps(m_guard_band[0]));
+		const auto guard_y = _mm_mul_ps(w, _mm_set1_ps(m_guard_band[1]));
+		const std::array<int, PLANE_COUNT> outside = {
+			_mm_movemask_ps(_mm_cmplt_ps(clip_z, _mm_setzero_ps())),
+			_mm_movemask_ps(_mm_cmplt_ps(clip_x, _mm_sub_ps(_mm_setzero_ps(), guard_x))),
+			_mm_movemask_ps(_mm_cmpgt_ps(clip_x, guard_x)),
+			_mm_movemask_ps(_mm_cmplt_ps(clip_y, _mm_sub_ps(_mm_setzero_ps(), guard_y))),
+			_mm_movemask_ps(_mm_cmpgt_ps(clip_y, guard_y)),
+		};
+
+		// Lanes that are outside of a plane are never projected, their values do not matter
+		const auto inv_w = _mm_div_ps(_mm_set1_ps(1.0F), w);
+		const auto steps = _mm_set1_ps(SUBPIXEL_STEPS);
+		const auto step_size = _mm_set1_ps(1.0F / SUBPIXEL_STEPS);
+		auto screen_x = _mm_add_ps(
+			_mm_mul_ps(_mm_mul_ps(clip_x, inv_w), _mm_set1_ps(half_width)),
+			_mm_set1_ps(center_x)
+		);
+		auto screen_y = _mm_add_ps(
+			_mm_mul_ps(_mm_mul_ps(clip_y, inv_w), _mm_set1_ps(-half_height)),
+			_mm_set1_ps(center_y)
+		);
+		screen_x = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(screen_x, steps)));
+		screen_y = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(screen_y, steps)));
+		screen_x = _mm_mul_ps(screen_x, step_size);
+		screen_y = _mm_mul_ps(screen_y, step_size);
+		const auto screen_z = _mm_add_ps(
+			_mm_mul_ps(_mm_mul_ps(clip_z, inv_w), _mm_set1_ps(depth_range)),
+			_mm_set1_ps(m_viewport.min_depth)
+		);
+
+		alignas(16) std::array<std::array<float, 4>, 8> lanes;
+		_mm_store_ps(lanes[0].data(), clip_x);
+		_mm_store_ps(lanes[1].data(), clip_y);
+		_mm_store_ps(lanes[2].data(), clip_z);
+		_mm_store_ps(lanes[3].data(), w);
+		_mm_store_ps(lanes[4].data(), screen_x);
+		_mm_store_ps(lanes[5].data(), screen_y);
+		_mm_store_ps(lanes[6].data(), screen_z);
+		_mm_store_ps(lanes[7].data(), inv_w);
+
+		for (uint32_t lane = 0; lane < 4; lane++) {
+			m_clip[i + lane] = { lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane] };
+			auto& screen = m_screen[i + lane];
+			screen.x = lanes[4][lane];
+			screen.y = lanes[5][lane];
+			screen.z = lanes[6][lane];
+			screen.inv_w = lanes[7][lane];
+			const auto& color = vertices[i + lane].color;
+			screen.color = { color.x, color.y, color.z, color.w };
+
+			uint8_t outcode = 0;
+			for (uint32_t plane = 0; plane < PLANE_COUNT; plane++) {
+				outcode |= uint8_t(((uint32_t(outside[plane]) >> lane) & 1U) << plane);
+			}
+			m_outcodes[i + lane] = outcode;
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		const auto& p = vertices[i].position;
+		std::array<float, 4> clip;
+		for (size_t c = 0; c < 4; c++) {
+			clip[c] = (p.x * m.m[0][c] + p.y * m.m[1][c]) + (p.z * m.m[2][c] + m.m[3][c]);
+		}
+		m_clip[i] = { clip[0], clip[1], clip[2], clip[3] };
+
+		const float guard_x = clip[3] * m_guard_band[0];
+		const float guard_y = clip[3] * m_guard_band[1];
+		uint8_t outcode = 0;
+		outcode |= clip[2] < 0.0F ? Outcode::Near : 0;
+		outcode |= clip[0] < -guard_x ? Outcode::Left : 0;
+		outcode |= clip[0] > guard_x ? Outcode::Right : 0;
+		outcode |= clip[1] < -guard_y ? Outcode::Bottom : 0;
+		outcode |= clip[1] > guard_y ? Outcode::Top : 0;
+		m_outcodes[i] = outcode;
+
+		const auto& color = vertices[i].color;
+		ClipVertex vertex{ clip, { color.x, color.y, color.z, color.w } };
+		// Vertices outside of the guard band are only used through the clipper
+		m_screen[i] = outcode == 0
+			? Project(vertex)
+			: ScreenVertex{ 0.0F, 0.0F, 0.0F, 0.0F, vertex.color };
+	}
+}
+
+
+void SoftwareRasterizer::ClipTriangle(const std::array<ClipVertex, 3>& triangle, uint32_t outcodes)
+{
+	m_stats.clipped_triangles++;
+
+	// Signed distance to a plane, the inside is positive
+	auto distance = [&](const ClipVertex& v, uint32_t plane) {
+		const auto& p = v.position;
+		switch (plane)
+		{
+			case 0: return p[2];
+			case 1: return p[0] + p[3] * m_guard_band[0];
+			case 2: return p[3] * m_guard_band[0] - p[0];
+			case 3: return p[1] + p[3] * m_guard_band[1];
+			default: return p[3] * m_guard_band[1] - p[1];
+		}
+	};
+
+	std::array<std::array<ClipVertex, MAX_CLIP_VERTICES>, 2> polygons;
+	std::copy(triangle.begin(), triangle.end(), polygons[0].begin());
+	size_t count = 3;
+	size_t current = 0;
+
+	for (uint32_t plane = 0; plane < PLANE_COUNT && count >= 3; plane++) {
+		if ((outcodes & (1U << plane)) == 0) {
+			continue;
+		}
+		const auto& in = polygons[current];
+		auto& out = polygons[1 - current];
+		size_t out_count = 0;
+		for (size_t v = 0; v < count; v++) {
+			const auto& a = in[v];
+			const auto& b = in[(v + 1) % count];
+			const float da = distance(a, plane);
+			const float db = distance(b, plane);
+			if (da >= 0.0F) {
+				out[out_count++] = a;
+			}
+			if ((da >= 0.0F) != (db >= 0.0F)) {
+				const float t = da / (da - db);
+				auto& vertex = out[out_count++];
+				for (size_t c = 0; c < 4; c++) {
+					vertex.position[c] = a.position[c] + t * (b.position[c] - a.position[c]);
+					vertex.color[c] = a.color[c] + t * (b.color[c] - a.color[c]);
+				}
+			}
+		}
+		count = out_count;
+		current = 1 - current;
+	}
+	if (count < 3) {
+		return;
+	}
+
+	// The polygon is convex, a fan around its first vertex covers it
+	const auto& polygon = polygons[current];
+	const auto first = Project(polygon[0]);
+	auto previous = Project(polygon[1]);
+	for (size_t v = 2; v < count; v++) {
+		const auto next = Project(polygon[v]);
+		SetupTriangle(first, previous, next);
+		previous = next;
+	}
+}
+
+
+auto SoftwareRasterizer::Project(const ClipVertex& vertex) const -> ScreenVertex
+{
+	// Same operations as the vectorized transform
+	const auto& p = vertex.position;
+	const float half_width = m_viewport.width * 0.5F;
+	const float half_height = m_viewport.height * 0.5F;
+	const float inv_w = 1.0F / p[3];
+
+	ScreenVertex screen;
+	screen.x = Snap(p[0] * inv_w * half_width + (m_viewport.x + half_width));
+	screen.y = Snap(p[1] * inv_w * -half_height + (m_viewport.y + half_height));
+	screen.z =
+		p[2] * inv_w * (m_viewport.max_depth - m_viewport.min_depth) + m_viewport.min_depth;
+	screen.inv_w = inv_w;
+	screen.color = vertex.color;
+	return screen;
+}
+
+
+void SoftwareRasterizer::SetupTriangle(
+	const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2
+)
+{
+	// Positive for triangles that are clockwise on screen, the front faces of Direct3D.
+	// Snapped positions make all products exact in double precision.
+	const double area = (double(v1.x) - v0.x) * (double(v2.y) - v0.y)
+		- (double(v1.y) - v0.y) * (double(v2.x) - v0.x);
+	if (!(area > 0.0)) {
+		return;
+	}
+
+	Triangle triangle;
+	// Pixel centers sit at +0.5
+	const auto first = [](float a, float b, float c) {
+		return int32_t(std::ceil(std::min({ a, b, c }) - 0.5F));
+	};
+	const auto last = [](float a, float b, float c) {
+		return int32_t(std::floor(std::max({ a, b, c }) - 0.5F));
+	};
+	triangle.min_x = std::max(first(v0.x, v1.x, v2.x), m_viewport_min_x);
+	triangle.min_y = std::max(first(v0.y, v1.y, v2.y), m_viewport_min_y);
+	triangle.max_x = std::min(last(v0.x, v1.x, v2.x), m_viewport_max_x);
+	triangle.max_y = std::min(last(v0.y, v1.y, v2.y), m_viewport_max_y);
+	if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+		return;
+	}
+
+	const std::array<const ScreenVertex*, 3> v = { &v0, &v1, &v2 };
+	for (size_t k = 0; k < 3; k++) {
+		const auto& from = *v[(k + 1) % 3];
+		const auto& to = *v[(k + 2) % 3];
+		const double a = double(from.y) - to.y;
+		const double b = double(to.x) - from.x;
+		triangle.a[k] = float(a);
+		triangle.b[k] = float(b);
+		triangle.c[k] = -(a * from.x + b * from.y);
+		// Edges going up on screen are left edges, horizontal ones going right are top edges
+		triangle.top_left[k] = a > 0.0 || (a == 0.0 && b > 0.0);
+	}
+	triangle.inv_area = float(1.0 / area);
+
+	auto attributes = [](const ScreenVertex& vertex) {
+		return std::array<float, ATTRIBUTE_COUNT>{
+			vertex.z, vertex.inv_w,
+			vertex.color[0] * vertex.inv_w, vertex.color[1] * vertex.inv_w,
+			vertex.color[2] * vertex.inv_w, vertex.color[3] * vertex.inv_w
+		};
+	};
+	triangle.attributes = attributes(v0);
+	const auto attributes1 = attributes(v1);
+	const auto attributes2 = attributes(v2);
+	for (size_t i = 0; i < ATTRIBUTE_COUNT; i++) {
+		triangle.delta1[i] = attributes1[i] - triangle.attributes[i];
+		triangle.delta2[i] = attributes2[i] - triangle.attributes[i];
+	}
+
+	const auto index = uint32_t(m_triangles.size());
+	m_triangles.push_back(triangle);
+	m_stats.visible_triangles++;
+
+	for (int32_t y = triangle.min_y / TILE_SIZE; y <= triangle.max_y / TILE_SIZE; y++) {
+		for (int32_t x = triangle.min_x / TILE_SIZE; x <= triangle.max_x / TILE_SIZE; x++) {
+			m_bins[size_t(y) * m_tiles_x + size_t(x)].push_back(index);
+			m_stats.bin_entries++;
+		}
+	}
+}
+
+
+void SoftwareRasterizer::RasterizeTile(size_t tile)
+{
+	const auto tile_x = int32_t(tile % m_tiles_x) * TILE_SIZE;
+	const auto tile_y = int32_t(tile / m_tiles_x) * TILE_SIZE;
+
+	for (const auto index : m_bins[tile]) {
+		const auto& t = m_triangles[index];
+		const auto min_x = std::max(t.min_x, tile_x);
+		const auto min_y = std::max(t.min_y, tile_y);
+		const auto max_x = std::min(t.max_x, tile_x + TILE_SIZE - 1);
+		const auto max_y = std::min(t.max_y, tile_y + TILE_SIZE - 1);
+		if (min_x > max_x || min_y > max_y) {
+			continue;
+		}
+
+		// Edge functions at the first pixel center of the tile. Inside the tile they are
+		// evaluated in single precision relative to it, a neighbor that shares an edge
+		// computes exactly the negated values, so coverage never overlaps.
+		std::array<float, 3> origin;
+		for (size_t k = 0; k < 3; k++) {
+			origin[k] = float(
+				double(t.a[k]) * (tile_x + 0.5) + double(t.b[k]) * (tile_y + 0.5) + t.c[k]
+			);
+		}
+		const auto first_x = float(min_x - tile_x);
+		const auto last_x = float(max_x - tile_x);
+		std::array<float, 3> row;
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+		// Coverage of four pixels of the current row, x is relative to the tile
+		auto test = [&](__m128 x) {
+			Lanes lanes;
+			lanes.covered = _mm_and_ps(
+				_mm_cmpge_ps(x, _mm_set1_ps(first_x)), _mm_cmple_ps(x, _mm_set1_ps(last_x))
+			);
+			for (size_t k = 0; k < 3; k++) {
+				const auto edge = _mm_add_ps(
+					_mm_set1_ps(row[k]), _mm_mul_ps(_mm_set1_ps(t.a[k]), x)
+				);
+				lanes.covered = _mm_and_ps(lanes.covered, InsideEdge(edge, t.top_left[k]));
+				lanes.edges[k] = edge;
+			}
+			return lanes;
+		};
+
+		// Depth test and color output of four pixels
+		auto shade = [&](const Lanes& lanes, float* depth, uint32_t* color) {
+			if (_mm_movemask_ps(lanes.covered) == 0) {
+				return;
+			}
+			const auto b1 = _mm_mul_ps(lanes.edges[1], _mm_set1_ps(t.inv_area));
+			const auto b2 = _mm_mul_ps(lanes.edges[2], _mm_set1_ps(t.inv_area));
+			auto interpolate = [&](size_t i) {
+				return _mm_add_ps(
+					_mm_set1_ps(t.attributes[i]),
+					_mm_add_ps(
+						_mm_mul_ps(b1, _mm_set1_ps(t.delta1[i])),
+						_mm_mul_ps(b2, _mm_set1_ps(t.delta2[i]))
+					)
+				);
+			};
+
+			const auto z = interpolate(0);
+			const auto stored_z = _mm_loadu_ps(depth);
+			const auto pass = _mm_castps_si128(
+				_mm_and_ps(lanes.covered, _mm_cmplt_ps(z, stored_z))
+			);
+			if (_mm_movemask_epi8(pass) == 0) {
+				return;
+			}
+			_mm_storeu_ps(depth, _mm_castsi128_ps(
+				Select(pass, _mm_castps_si128(z), _mm_castps_si128(stored_z))
+			));
+
+			const auto w = _mm_div_ps(_mm_set1_ps(1.0F), interpolate(1));
+			const auto channel = [&](size_t attribute, int shift) {
+				return _mm_slli_epi32(ToUnorm8(_mm_mul_ps(interpolate(attribute), w)), shift);
+			};
+			auto packed = channel(2, 0);
+			packed = _mm_or_si128(packed, channel(3, 8));
+			packed = _mm_or_si128(packed, channel(4, 16));
+			packed = _mm_or_si128(packed, channel(5, 24));
+
+			auto* lanes_color = reinterpret_cast<__m128i*>(color);
+			_mm_storeu_si128(lanes_color, Select(pass, packed, _mm_loadu_si128(lanes_color)));
+		};
+#endif
+
+		for (int32_t y = min_y; y <= max_y; y++) {
+			const auto dy = float(y - tile_y);
+			for (size_t k = 0; k < 3; k++) {
+				row[k] = origin[k] + t.b[k] * dy;
+			}
+			const size_t row_start = size_t(y) * m_pitch + size_t(tile_x);
+
+			for (int32_t bx = (min_x - tile_x) & ~(BLOCK_SIZE - 1); bx <= max_x - tile_x;
+				bx += BLOCK_SIZE) {
+				auto* color = m_color.data() + row_start + size_t(bx);
+				auto* depth = m_depth.data() + row_start + size_t(bx);
+#ifdef SOFTWARE_RASTERIZER_SSE2
+				const auto block_x = _mm_set1_ps(float(bx));
+				const auto low = test(_mm_add_ps(block_x, _mm_setr_ps(0.0F, 1.0F, 2.0F, 3.0F)));
+				const auto high = test(_mm_add_ps(block_x, _mm_setr_ps(4.0F, 5.0F, 6.0F, 7.0F)));
+				if ((_mm_movemask_ps(low.covered) | _mm_movemask_ps(high.covered)) == 0) {
+					continue;
+				}
+				shade(low, depth, color);
+				shade(high, depth + 4, color + 4);
+#else
+				for (int32_t lane = 0; lane < BLOCK_SIZE; lane++) {
+					const auto x = float(bx + lane);
+					if (x < first_x || x > last_x) {
+						continue;
+					}
+					std::array<float, 3> e;
+					bool inside = true;
+					for (size_t k = 0; k < 3; k++) {
+						e[k] = row[k] + t.a[k] * x;
+						inside = inside && (e[k] > 0.0F || (e[k] == 0.0F && t.top_left[k]));
+					}
+					if (!inside) {
+						continue;
+					}
+					const float b1 = e[1] * t.inv_area;
+					const float b2 = e[2] * t.inv_area;
+					auto interpolate = [&](size_t i) {
+						return t.attributes[i] + (b1 * t.delta1[i] + b2 * t.delta2[i]);
+					};
+					const float z = interpolate(0);
+					if (!(z < depth[lane])) {
+						continue;
+					}
+					depth[lane] = z;
+					const float w = 1.0F / interpolate(1);
+					color[lane] = PackColor({
+						interpolate(2) * w, interpolate(3) * w,
+						interpolate(4) * w, interpolate(5) * w
+					});
+				}
+#endif
+			}
+		}
+	}
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto SoftwareRasterizer::GetWidth() const -> uint32_t
+{
+	return m_width;
+}
+
+
+auto SoftwareRasterizer::GetHeight() const -> uint32_t
+{
+	return m_height;
+}
+
+
+auto SoftwareRasterizer::GetStats() const -> const Stats&
+{
+	return m_stats;
+}
+
+
+void SoftwareRasterizer::ResetStats()
+{
+	m_stats = Stats();
+}
+
+} // namespace graphics
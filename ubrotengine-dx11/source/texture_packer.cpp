@@ -0,0 +1,354 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: texture_packer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/texture_packer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+
+namespace
+{
+
+auto AlignUp(uint32_t value, uint32_t alignment) -> uint32_t
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+/**
+ * Copies \p src to (x, y) of an RGBA image and repeats its border pixels \p padding times
+ * around it.
+ */
+void CopyPadded(
+	const io::Image& src, uint8_t* dst, uint32_t dst_width, uint32_t x, uint32_t y,
+	uint32_t padding
+)
+{
+	const size_t row_bytes = size_t(src.width) * 4;
+	const auto rows = int64_t(src.height);
+
+	for (int64_t row = -int64_t(padding); row < rows + padding; row++) {
+		const auto src_row = std::clamp<int64_t>(row, 0, rows - 1);
+		const uint8_t* s = src.pixels.data() + size_t(src_row) * row_bytes;
+		uint8_t* d = dst + (size_t(int64_t(y) + row) * dst_width + x) * 4;
+
+		for (uint32_t i = 1; i <= padding; i++) {
+			std::memcpy(d - size_t(i) * 4, s, 4);
+		}
+		std::memcpy(d, s, row_bytes);
+		for (uint32_t i = 0; i < padding; i++) {
+			std::memcpy(d + row_bytes + size_t(i) * 4, s + row_bytes - 4, 4);
+		}
+	}
+}
+
+} // namespace
+
+
+auto TexturePacker::Add(io::TextureData&& data) -> size_t
+{
+	const auto pos = m_locations.size();
+	m_locations.emplace_back();
+	m_pending.push_back({ pos, std::move(data) });
+	return pos;
+}
+
+
+auto TexturePacker::AddUnpacked() -> size_t
+{
+	const auto pos = m_locations.size();
+	m_locations.emplace_back();
+	return pos;
+}
+
+
+void TexturePacker::SetUnpacked(
+	graphics::RenderDevice& device, size_t texture_idx, graphics::RenderDevice::Handle texture
+)
+{
+	auto& location = m_locations[texture_idx];
+	if (location.array_idx == TextureLocation::NONE) {
+		location.array_idx = uint32_t(m_arrays.size());
+		m_arrays.push_back(texture);
+		return;
+	}
+	device.Release(m_arrays[location.array_idx]);
+	m_arrays[location.array_idx] = texture;
+}
+
+
+auto TexturePacker::HasPending() const -> bool
+{
+	return !m_pending.empty();
+}
+
+
+auto TexturePacker::Build(graphics::RenderDevice& device) -> HRESULT
+{
+	auto result{ S_OK };
+	const auto keep_error = [&result](HRESULT r) {
+		if (FAILED(r) && SUCCEEDED(result)) {
+			result = r;
+		}
+	};
+
+	using ArrayKey = std::tuple<graphics::TextureFormat, uint32_t, uint32_t, uint32_t>;
+	std::map<graphics::TextureFormat, std::vector<Pending*>> atlases;
+	std::map<ArrayKey, std::vector<Pending*>> arrays;
+
+	for (auto& pending : m_pending) {
+		const auto& info = pending.data.info;
+		if (pending.data.subresources.empty()) {
+			continue;
+		}
+
+		// Arrays and cubemaps from DDS files already are one binding
+		if (info.array_size != 1 || info.cubemap) {
+			graphics::RenderDevice::Handle texture{ graphics::RenderDevice::NO_RESOURCE };
+			const auto r = device.CreateTexture(info, pending.data.subresources, false, texture);
+			keep_error(r);
+			if (SUCCEEDED(r)) {
+				m_locations[pending.texture_idx].array_idx = uint32_t(m_arrays.size());
+				m_arrays.push_back(texture);
+			}
+			continue;
+		}
+
+		if (IsAtlasCandidate(pending.data)) {
+			atlases[info.format].push_back(&pending);
+		}
+		else {
+			arrays[{ info.format, info.width, info.height, info.mip_count }].push_back(&pending);
+		}
+	}
+
+	for (auto& [format, entries] : atlases) {
+		if (entries.size() > 1) {
+			keep_error(BuildAtlas(device, entries));
+			continue;
+		}
+		// A single texture keeps its full mip chain
+		const auto& info = entries[0]->data.info;
+		arrays[{ format, info.width, info.height, info.mip_count }].push_back(entries[0]);
+	}
+
+	for (auto& [key, entries] : arrays) {
+		for (size_t first = 0; first < entries.size(); first += MAX_SLICES) {
+			const auto last = std::min(entries.size(), first + MAX_SLICES);
+			const std::vector<Pending*> slices(
+				entries.begin() + ptrdiff_t(first), entries.begin() + ptrdiff_t(last)
+			);
+			keep_error(BuildArray(device, slices));
+		}
+	}
+
+	m_pending.clear();
+	return result;
+}
+
+
+auto TexturePacker::GetLocation(size_t texture_idx) const -> const TextureLocation&
+{
+	assert(texture_idx < m_locations.size());
+	return m_locations[texture_idx];
+}
+
+
+auto TexturePacker::GetArray(uint32_t array_idx) const -> graphics::RenderDevice::Handle
+{
+	if (array_idx >= m_arrays.size()) {
+		return graphics::RenderDevice::NO_RESOURCE;
+	}
+	return m_arrays[array_idx];
+}
+
+
+auto TexturePacker::GetStats() const -> Stats
+{
+	Stats stats;
+	stats.textures = m_locations.size();
+	stats.arrays = m_arrays.size();
+	stats.atlas_textures = m_atlas_textures;
+	stats.atlas_pages = m_atlas_pages;
+	if (m_atlas_page_area > 0) {
+		stats.atlas_occupancy = float(double(m_atlas_used_area) / double(m_atlas_page_area));
+	}
+	return stats;
+}
+
+
+auto TexturePacker::RemapUv(const TextureLocation& location, const math::Float2& uv)
+	-> math::Float2
+{
+	const auto& t = location.uv_transform;
+	return { uv.x * t.x + t.z, uv.y * t.y + t.w };
+}
+
+
+auto TexturePacker::IsAtlasCandidate(const io::TextureData& data) -> bool
+{
+	// Only decoded images are RGBA8, and the atlas mips are taken from the texture mips
+	return !data.images.empty()
+		&& data.info.width <= ATLAS_MAX_TEXTURE_SIZE
+		&& data.info.height <= ATLAS_MAX_TEXTURE_SIZE
+		&& data.info.mip_count >= ATLAS_MIP_COUNT;
+}
+
+
+auto TexturePacker::BuildAtlas(
+	graphics::RenderDevice& device, const std::vector<Pending*>& entries
+) -> HRESULT
+{
+	struct Placement
+	{
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	// Tallest textures first, that keeps the skyline flat
+	auto sorted = entries;
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Pending* a, const Pending* b) {
+		return std::tie(a->data.info.height, a->data.info.width)
+			> std::tie(b->data.info.height, b->data.info.width);
+	});
+
+	std::vector<utils::SkylinePacker> pages;
+	std::vector<Placement> placements(sorted.size());
+	// All slices of an array have the same size, so the pages are cut to the largest extent
+	uint32_t width{ 0 };
+	uint32_t height{ 0 };
+
+	for (size_t i = 0; i < sorted.size(); i++) {
+		const auto& info = sorted[i]->data.info;
+		const auto rect_width = AlignUp(info.width + 2 * ATLAS_PADDING, ATLAS_PADDING);
+		const auto rect_height = AlignUp(info.height + 2 * ATLAS_PADDING, ATLAS_PADDING);
+
+		auto& placement = placements[i];
+		bool placed{ false };
+		for (size_t page = 0; page < pages.size() && !placed; page++) {
+			placed = pages[page].Insert(rect_width, rect_height, placement.x, placement.y);
+			placement.page = uint32_t(page);
+		}
+		if (!placed) {
+			placement.page = uint32_t(pages.size());
+			pages.emplace_back(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+			pages.back().Insert(rect_width, rect_height, placement.x, placement.y);
+		}
+
+		width = std::max(width, placement.x + rect_width);
+		height = std::max(height, placement.y + rect_height);
+		placement.x += ATLAS_PADDING;
+		placement.y += ATLAS_PADDING;
+	}
+
+	// Every level of every page is filled with the matching mip of its textures
+	const auto page_count = uint32_t(pages.size());
+	std::vector<std::vector<uint8_t>> levels(size_t(page_count) * ATLAS_MIP_COUNT);
+	std::vector<graphics::SubresourceData> subresources(levels.size());
+	for (uint32_t page = 0; page < page_count; page++) {
+		for (uint32_t level = 0; level < ATLAS_MIP_COUNT; level++) {
+			const auto idx = size_t(page) * ATLAS_MIP_COUNT + level;
+			levels[idx].resize(size_t(width >> level) * (height >> level) * 4);
+			subresources[idx].data = levels[idx].data();
+			subresources[idx].row_pitch = (width >> level) * 4;
+			subresources[idx].slice_pitch = 0;
+		}
+	}
+
+	for (size_t i = 0; i < sorted.size(); i++) {
+		const auto& placement = placements[i];
+		for (uint32_t level = 0; level < ATLAS_MIP_COUNT; level++) {
+			CopyPadded(
+				sorted[i]->data.images[level],
+				levels[size_t(placement.page) * ATLAS_MIP_COUNT + level].data(),
+				width >> level, placement.x >> level, placement.y >> level,
+				ATLAS_PADDING >> level
+			);
+		}
+	}
+
+	io::DdsInfo info;
+	info.width = width;
+	info.height = height;
+	info.mip_count = ATLAS_MIP_COUNT;
+	info.array_size = page_count;
+	info.format = sorted[0]->data.info.format;
+
+	graphics::RenderDevice::Handle texture{ graphics::RenderDevice::NO_RESOURCE };
+	auto result = device.CreateTexture(info, subresources, true, texture);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	const auto array_idx = uint32_t(m_arrays.size());
+	m_arrays.push_back(texture);
+
+	for (size_t i = 0; i < sorted.size(); i++) {
+		const auto& texture = sorted[i]->data.info;
+		auto& location = m_locations[sorted[i]->texture_idx];
+		location.array_idx = array_idx;
+		location.slice = placements[i].page;
+		location.uv_transform = {
+			float(texture.width) / float(width), float(texture.height) / float(height),
+			float(placements[i].x) / float(width), float(placements[i].y) / float(height)
+		};
+		m_atlas_used_area += uint64_t(texture.width) * texture.height;
+	}
+
+	m_atlas_textures += sorted.size();
+	m_atlas_pages += page_count;
+	m_atlas_page_area += uint64_t(width) * height * page_count;
+	return S_OK;
+}
+
+
+auto TexturePacker::BuildArray(
+	graphics::RenderDevice& device, const std::vector<Pending*>& entries
+) -> HRESULT
+{
+	auto info = entries[0]->data.info;
+	info.array_size = uint32_t(entries.size());
+
+	// Direct3D expects all mips of the first slice, then all mips of the second and so on
+	std::vector<graphics::SubresourceData> subresources;
+	subresources.reserve(size_t(info.mip_count) * info.array_size);
+	for (const auto* entry : entries) {
+		subresources.insert(
+			subresources.end(), entry->data.subresources.begin(), entry->data.subresources.end()
+		);
+	}
+
+	graphics::RenderDevice::Handle texture{ graphics::RenderDevice::NO_RESOURCE };
+	auto result = device.CreateTexture(info, subresources, true, texture);
+	if (FAILED(result)) {
+		return result;
+	}
+
+	const auto array_idx = uint32_t(m_arrays.size());
+	m_arrays.push_back(texture);
+	for (size_t slice = 0; slice < entries.size(); slice++) {
+		auto& location = m_locations[entries[slice]->texture_idx];
+		location.array_idx = array_idx;
+		location.slice = uint32_t(slice);
+	}
+	return S_OK;
+}
+
+} // namespace assets
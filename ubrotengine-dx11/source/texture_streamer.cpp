@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: texture_streamer.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/texture_streamer.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cstring>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace assets
+{
+
+namespace
+{
+
+/**
+ * Returns the first level that is not larger than TAIL_SIZE.
+ */
+auto GetTailMip(const io::DdsInfo& info) -> uint32_t
+{
+	uint32_t mip{ 0 };
+	while (std::max(info.width, info.height) >> mip > TextureStreamer::TAIL_SIZE) {
+		mip++;
+	}
+	return mip;
+}
+
+} // namespace
+
+
+auto TextureStreamer::IsStreamable(const io::TextureData& data) -> bool
+{
+	// Decoded images are packed, only DDS levels are read from their file or archive
+	return data.images.empty()
+		&& data.info.array_size == 1 && !data.info.cubemap
+		&& GetTailMip(data.info) > 0 && GetTailMip(data.info) < data.info.mip_count;
+}
+
+
+void TextureStreamer::Add(size_t texture_idx, io::TextureData&& data)
+{
+	auto source = std::make_unique<Source>();
+	source->data = std::move(data);
+
+	const auto& info = source->data.info;
+	for (uint32_t mip = 0; mip < info.mip_count; mip++) {
+		uint32_t row_pitch{ 0 };
+		uint32_t row_count{ 0 };
+		io::DdsLoader::GetSurfaceInfo(
+			std::max(1U, info.width >> mip), std::max(1U, info.height >> mip), info.format,
+			row_pitch, row_count
+		);
+		source->level_bytes.push_back(size_t(row_pitch) * row_count);
+	}
+	m_mips.Add(
+		texture_idx, std::max(info.width, info.height), source->level_bytes, GetTailMip(info)
+	);
+
+	if (texture_idx >= m_sources.size()) {
+		m_sources.resize(texture_idx + 1);
+	}
+	m_sources[texture_idx] = std::move(source);
+	m_new_textures.push_back(texture_idx);
+}
+
+
+void TextureStreamer::SetBudget(size_t bytes)
+{
+	m_mips.SetBudget(bytes);
+}
+
+
+void TextureStreamer::BeginFrame()
+{
+	m_mips.BeginFrame();
+}
+
+
+void TextureStreamer::Request(size_t texture_idx, float screen_pixels)
+{
+	m_mips.Request(texture_idx, screen_pixels);
+}
+
+
+auto TextureStreamer::Update(
+	graphics::RenderDevice& device, TexturePacker& textures, size_t max_load_bytes
+) -> HRESULT
+{
+	auto result{ S_OK };
+	const auto keep_error = [&result](HRESULT r) {
+		if (FAILED(r) && SUCCEEDED(result)) {
+			result = r;
+		}
+	};
+
+	// New textures start with their tail, it is read directly from the mapping
+	for (const auto idx : m_new_textures) {
+		const auto& source = *m_sources[idx];
+		const auto mip = m_mips.GetResidentMip(idx);
+		keep_error(CreateTexture(
+			device, textures, source, idx, mip, source.data.subresources.data() + mip
+		));
+	}
+	m_new_textures.clear();
+
+	std::vector<Load> finished;
+	{
+		std::lock_guard<std::mutex> lock(m_finished_mutex);
+		finished.swap(m_finished);
+	}
+	for (const auto& load : finished) {
+		const auto r = CreateTexture(
+			device, textures, *m_sources[load.texture_idx], load.texture_idx, load.top_mip,
+			load.subresources.data()
+		);
+		keep_error(r);
+		m_mips.Loaded(load.texture_idx, SUCCEEDED(r));
+	}
+
+	m_mips.Update(max_load_bytes, m_loads, m_evictions);
+
+	// The remaining levels were resident before, so their pages are most likely still mapped
+	for (const auto& eviction : m_evictions) {
+		const auto& source = *m_sources[eviction.texture_idx];
+		keep_error(CreateTexture(
+			device, textures, source, eviction.texture_idx, eviction.top_mip,
+			source.data.subresources.data() + eviction.top_mip
+		));
+	}
+
+	for (const auto& load : m_loads) {
+		const auto* source = m_sources[load.texture_idx].get();
+		const auto resident_mip = m_mips.GetResidentMip(load.texture_idx);
+		m_io_thread.Submit([this, source, load, resident_mip]() {
+			ReadLevels(*source, load.texture_idx, load.top_mip, resident_mip);
+		});
+	}
+
+	return result;
+}
+
+
+void TextureStreamer::WaitForLoads()
+{
+	m_io_thread.Wait();
+}
+
+
+auto TextureStreamer::GetStats() const -> MipStreamer::Stats
+{
+	return m_mips.GetStats();
+}
+
+
+void TextureStreamer::ReadLevels(
+	const Source& source, size_t texture_idx, uint32_t top_mip, uint32_t resident_mip
+)
+{
+	Load load;
+	load.texture_idx = texture_idx;
+	load.top_mip = top_mip;
+
+	size_t bytes{ 0 };
+	for (auto mip = top_mip; mip < resident_mip; mip++) {
+		bytes += source.level_bytes[mip];
+	}
+	load.staging.resize(bytes);
+
+	// Levels are stored without padding, so every level is one block in the file
+	const auto& file_levels = source.data.subresources;
+	size_t offset{ 0 };
+	for (auto mip = top_mip; mip < source.data.info.mip_count; mip++) {
+		auto subresource = file_levels[mip];
+		if (mip < resident_mip) {
+			std::memcpy(
+				load.staging.data() + offset, subresource.data, source.level_bytes[mip]
+			);
+			subresource.data = load.staging.data() + offset;
+			offset += source.level_bytes[mip];
+		}
+		load.subresources.push_back(subresource);
+	}
+
+	std::lock_guard<std::mutex> lock(m_finished_mutex);
+	m_finished.push_back(std::move(load));
+}
+
+
+auto TextureStreamer::CreateTexture(
+	graphics::RenderDevice& device, TexturePacker& textures, const Source& source,
+	size_t texture_idx, uint32_t top_mip, const graphics::SubresourceData* subresources
+) -> HRESULT
+{
+	auto info = source.data.info;
+	info.width = std::max(1U, info.width >> top_mip);
+	info.height = std::max(1U, info.height >> top_mip);
+	info.mip_count -= top_mip;
+
+	const std::vector<graphics::SubresourceData> levels(
+		subresources, subresources + info.mip_count
+	);
+	graphics::RenderDevice::Handle texture{ graphics::RenderDevice::NO_RESOURCE };
+	auto result = device.CreateTexture(info, levels, true, texture);
+	if (FAILED(result)) {
+		return result;
+	}
+	textures.SetUnpacked(device, texture_idx, texture);
+	return S_OK;
+}
+
+} // namespace assets
@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: thread_pool.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/thread_pool.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+
+ThreadPool::ThreadPool(size_t worker_count)
+{
+	if (worker_count == 0) {
+		const size_t hw_threads = std::thread::hardware_concurrency();
+		worker_count = hw_threads > 1 ? hw_threads - 1 : 1;
+	}
+
+	m_workers.reserve(worker_count);
+	for (size_t i = 0; i < worker_count; i++) {
+		m_workers.emplace_back([this]() { WorkerLoop(); });
+	}
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_job_cv.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker.join();
+	}
+}
+
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(std::move(job));
+	}
+	m_job_cv.notify_one();
+}
+
+
+void ThreadPool::ParallelFor(
+	size_t count, size_t chunk_count,
+	const std::function<void(size_t, size_t, size_t)>& fn
+)
+{
+	if (count == 0) {
+		return;
+	}
+	chunk_count = std::clamp<size_t>(chunk_count, 1, count);
+
+	const size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+	size_t remaining = chunk_count - 1;
+	std::mutex done_mutex;
+	std::condition_variable done_cv;
+
+	// Chunk 0 is executed by the calling thread, all others are queued
+	for (size_t c = 1; c < chunk_count; c++) {
+		const size_t begin = std::min(c * chunk_size, count);
+		const size_t end = std::min(begin + chunk_size, count);
+		Submit([&, begin, end, c]() {
+			fn(begin, end, c);
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if (--remaining == 0) {
+				done_cv.notify_one();
+			}
+		});
+	}
+	fn(0, std::min(chunk_size, count), 0);
+
+	// Help with the queued jobs instead of idling until the own chunks are done
+	while (true) {
+		{
+			std::lock_guard<std::mutex> lock(done_mutex);
+			if (remaining == 0) {
+				return;
+			}
+		}
+		if (!TryRunJob()) {
+			std::unique_lock<std::mutex> lock(done_mutex);
+			done_cv.wait(lock, [&remaining]() { return remaining == 0; });
+			return;
+		}
+	}
+}
+
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done_cv.wait(lock, [this]() { return m_jobs.empty() && m_active == 0; });
+}
+
+
+auto ThreadPool::GetThreadCount() const -> size_t
+{
+	return m_workers.size() + 1;
+}
+
+
+void ThreadPool::WorkerLoop()
+{
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_job_cv.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+			if (m_stop && m_jobs.empty()) {
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_active++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_active--;
+		}
+		m_done_cv.notify_all();
+	}
+}
+
+
+auto ThreadPool::TryRunJob() -> bool
+{
+	std::function<void()> job;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_jobs.empty()) {
+			return false;
+		}
+		job = std::move(m_jobs.front());
+		m_jobs.pop_front();
+		m_active++;
+	}
+
+	job();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_active--;
+	}
+	m_done_cv.notify_all();
+	return true;
+}
+
+} // namespace utils
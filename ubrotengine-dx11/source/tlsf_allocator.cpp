@@ -0,0 +1,406 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsf_allocator.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/tlsf_allocator.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace utils
+{
+
+auto TlsfAllocator::Stats::GetFragmentation() const -> float
+{
+	const auto free = capacity - used;
+	if (free == 0) {
+		return 0.0F;
+	}
+	return 1.0F - float(largest_free_block) / float(free);
+}
+
+
+TlsfAllocator::TlsfAllocator(uint32_t capacity)
+{
+	for (auto& heads : m_free_heads) {
+		heads.fill(NONE);
+	}
+	Grow(capacity);
+}
+
+
+auto TlsfAllocator::Allocate(uint32_t size, uint32_t user_data) -> Handle
+{
+	if (size == 0) {
+		return INVALID_HANDLE;
+	}
+
+	const auto block_idx = FindFreeBlock(size);
+	if (block_idx == NONE) {
+		return INVALID_HANDLE;
+	}
+	RemoveFree(block_idx);
+	return UseBlock(block_idx, size, user_data);
+}
+
+
+void TlsfAllocator::Free(Handle handle)
+{
+	assert(handle < m_handles.size() && m_handles[handle] != NONE && "invalid handle");
+
+	const auto block_idx = m_handles[handle];
+	m_handles[handle] = NONE;
+	m_unused_handles.push_back(handle);
+
+	m_used -= m_blocks[block_idx].size;
+	m_allocations--;
+	ReleaseBlock(block_idx);
+}
+
+
+void TlsfAllocator::Grow(uint32_t capacity)
+{
+	if (capacity <= m_capacity) {
+		return;
+	}
+	const auto added = capacity - m_capacity;
+
+	// Extend a trailing free block instead of adding a second one next to it
+	if (m_last_block != NONE && m_blocks[m_last_block].handle == NONE) {
+		RemoveFree(m_last_block);
+		m_blocks[m_last_block].size += added;
+		InsertFree(m_last_block);
+	}
+	else {
+		const auto block_idx = NewBlock();
+		auto& block = m_blocks[block_idx];
+		block.offset = m_capacity;
+		block.size = added;
+		block.prev_phys = m_last_block;
+		if (m_last_block != NONE) {
+			m_blocks[m_last_block].next_phys = block_idx;
+		}
+		else {
+			m_first_block = block_idx;
+		}
+		m_last_block = block_idx;
+		InsertFree(block_idx);
+	}
+	m_capacity = capacity;
+}
+
+
+auto TlsfAllocator::PlanDefrag(uint32_t max_size, std::vector<Move>& moves) -> uint32_t
+{
+	moves.clear();
+	uint32_t moved{ 0 };
+
+	// Walk the allocations from the end of the block and move each into the first free block
+	// below it that is large enough. Free space thereby accumulates at the end. A moved
+	// allocation lands below the walk and would be reached again, so it is skipped then.
+	std::vector<bool> is_moved(m_handles.size(), false);
+	auto block_idx = m_last_block;
+	while (block_idx != NONE) {
+		const auto prev_idx = m_blocks[block_idx].prev_phys;
+		const auto block = m_blocks[block_idx];
+
+		if (block.handle != NONE && !is_moved[block.handle] && block.size <= max_size - moved) {
+			auto target_idx = m_first_block;
+			while (target_idx != NONE && m_blocks[target_idx].offset < block.offset) {
+				if (m_blocks[target_idx].handle == NONE && m_blocks[target_idx].size >= block.size) {
+					break;
+				}
+				target_idx = m_blocks[target_idx].next_phys;
+			}
+
+			if (target_idx != NONE && m_blocks[target_idx].offset < block.offset) {
+				RemoveFree(target_idx);
+				const auto new_handle = UseBlock(target_idx, block.size, block.user_data);
+
+				// Keep the handle of the moved allocation stable
+				m_handles[block.handle] = m_handles[new_handle];
+				m_blocks[m_handles[block.handle]].handle = block.handle;
+				m_handles[new_handle] = NONE;
+				m_unused_handles.push_back(new_handle);
+				m_used -= block.size;
+				m_allocations--;
+
+				moves.push_back({
+					block.handle, block.user_data, block.offset,
+					m_blocks[m_handles[block.handle]].offset, block.size
+				});
+				moved += block.size;
+				is_moved[block.handle] = true;
+				ReleaseBlock(block_idx);
+			}
+		}
+
+		if (moved == max_size) {
+			break;
+		}
+		block_idx = prev_idx;
+	}
+	return moved;
+}
+
+
+void TlsfAllocator::Mapping(uint32_t size, uint32_t& fl, uint32_t& sl)
+{
+	// Small sizes are stored linearly in the first list, everything else is split into
+	// SL_COUNT classes per power of two
+	if (size < SL_COUNT) {
+		fl = 0;
+		sl = size;
+	}
+	else {
+		const auto log2 = uint32_t(std::bit_width(size)) - 1;
+		fl = log2 - SL_BITS + 1;
+		sl = (size >> (log2 - SL_BITS)) ^ SL_COUNT;
+	}
+}
+
+
+auto TlsfAllocator::FindFreeBlock(uint32_t size) const -> uint32_t
+{
+	// Round the size up to the next class, so that every block in the found list is large
+	// enough and the head can be taken without searching the list
+	uint64_t rounded = size;
+	if (size >= SL_COUNT) {
+		const auto log2 = uint32_t(std::bit_width(size)) - 1;
+		rounded += (uint64_t(1) << (log2 - SL_BITS)) - 1;
+	}
+	if (rounded > UINT32_MAX) {
+		return NONE;
+	}
+
+	uint32_t fl{ 0 };
+	uint32_t sl{ 0 };
+	Mapping(uint32_t(rounded), fl, sl);
+
+	auto sl_map = m_sl_bitmap[fl] & (~0U << sl);
+	if (sl_map == 0) {
+		const auto fl_map = fl + 1 < 32 ? m_fl_bitmap & (~0U << (fl + 1)) : 0U;
+		if (fl_map == 0) {
+			return NONE;
+		}
+		fl = uint32_t(std::countr_zero(fl_map));
+		sl_map = m_sl_bitmap[fl];
+	}
+	sl = uint32_t(std::countr_zero(sl_map));
+	return m_free_heads[fl][sl];
+}
+
+
+void TlsfAllocator::InsertFree(uint32_t block_idx)
+{
+	uint32_t fl{ 0 };
+	uint32_t sl{ 0 };
+	Mapping(m_blocks[block_idx].size, fl, sl);
+
+	auto& block = m_blocks[block_idx];
+	block.handle = NONE;
+	block.prev_free = NONE;
+	block.next_free = m_free_heads[fl][sl];
+	if (block.next_free != NONE) {
+		m_blocks[block.next_free].prev_free = block_idx;
+	}
+	m_free_heads[fl][sl] = block_idx;
+
+	m_fl_bitmap |= 1U << fl;
+	m_sl_bitmap[fl] |= 1U << sl;
+	m_free_blocks++;
+}
+
+
+void TlsfAllocator::RemoveFree(uint32_t block_idx)
+{
+	uint32_t fl{ 0 };
+	uint32_t sl{ 0 };
+	Mapping(m_blocks[block_idx].size, fl, sl);
+
+	auto& block = m_blocks[block_idx];
+	if (block.prev_free != NONE) {
+		m_blocks[block.prev_free].next_free = block.next_free;
+	}
+	else {
+		m_free_heads[fl][sl] = block.next_free;
+	}
+	if (block.next_free != NONE) {
+		m_blocks[block.next_free].prev_free = block.prev_free;
+	}
+	block.prev_free = NONE;
+	block.next_free = NONE;
+
+	if (m_free_heads[fl][sl] == NONE) {
+		m_sl_bitmap[fl] &= ~(1U << sl);
+		if (m_sl_bitmap[fl] == 0) {
+			m_fl_bitmap &= ~(1U << fl);
+		}
+	}
+	m_free_blocks--;
+}
+
+
+auto TlsfAllocator::UseBlock(uint32_t block_idx, uint32_t size, uint32_t user_data) -> Handle
+{
+	// Split off the remainder
+	if (m_blocks[block_idx].size > size) {
+		const auto rest_idx = NewBlock();
+		auto& block = m_blocks[block_idx];
+		auto& rest = m_blocks[rest_idx];
+		rest.offset = block.offset + size;
+		rest.size = block.size - size;
+		rest.prev_phys = block_idx;
+		rest.next_phys = block.next_phys;
+		if (rest.next_phys != NONE) {
+			m_blocks[rest.next_phys].prev_phys = rest_idx;
+		}
+		else {
+			m_last_block = rest_idx;
+		}
+		block.next_phys = rest_idx;
+		block.size = size;
+		InsertFree(rest_idx);
+	}
+
+	Handle handle{ 0 };
+	if (!m_unused_handles.empty()) {
+		handle = m_unused_handles.back();
+		m_unused_handles.pop_back();
+		m_handles[handle] = block_idx;
+	}
+	else {
+		handle = Handle(m_handles.size());
+		m_handles.push_back(block_idx);
+	}
+
+	m_blocks[block_idx].handle = handle;
+	m_blocks[block_idx].user_data = user_data;
+	m_used += size;
+	m_allocations++;
+	return handle;
+}
+
+
+void TlsfAllocator::ReleaseBlock(uint32_t block_idx)
+{
+	m_blocks[block_idx].handle = NONE;
+
+	const auto next_idx = m_blocks[block_idx].next_phys;
+	if (next_idx != NONE && m_blocks[next_idx].handle == NONE) {
+		RemoveFree(next_idx);
+		MergeInto(block_idx, next_idx);
+	}
+
+	const auto prev_idx = m_blocks[block_idx].prev_phys;
+	if (prev_idx != NONE && m_blocks[prev_idx].handle == NONE) {
+		RemoveFree(prev_idx);
+		MergeInto(prev_idx, block_idx);
+		block_idx = prev_idx;
+	}
+
+	InsertFree(block_idx);
+}
+
+
+void TlsfAllocator::MergeInto(uint32_t block_idx, uint32_t next_idx)
+{
+	auto& block = m_blocks[block_idx];
+	const auto& next = m_blocks[next_idx];
+	block.size += next.size;
+	block.next_phys = next.next_phys;
+	if (block.next_phys != NONE) {
+		m_blocks[block.next_phys].prev_phys = block_idx;
+	}
+	else {
+		m_last_block = block_idx;
+	}
+	DeleteBlock(next_idx);
+}
+
+
+auto TlsfAllocator::NewBlock() -> uint32_t
+{
+	if (!m_unused_blocks.empty()) {
+		const auto block_idx = m_unused_blocks.back();
+		m_unused_blocks.pop_back();
+		m_blocks[block_idx] = Block();
+		return block_idx;
+	}
+	m_blocks.emplace_back();
+	return uint32_t(m_blocks.size() - 1);
+}
+
+
+void TlsfAllocator::DeleteBlock(uint32_t block_idx)
+{
+	m_unused_blocks.push_back(block_idx);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+auto TlsfAllocator::GetOffset(Handle handle) const -> uint32_t
+{
+	return m_blocks[m_handles[handle]].offset;
+}
+
+
+auto TlsfAllocator::GetSize(Handle handle) const -> uint32_t
+{
+	return m_blocks[m_handles[handle]].size;
+}
+
+
+auto TlsfAllocator::GetUserData(Handle handle) const -> uint32_t
+{
+	return m_blocks[m_handles[handle]].user_data;
+}
+
+
+auto TlsfAllocator::GetCapacity() const -> uint32_t
+{
+	return m_capacity;
+}
+
+
+auto TlsfAllocator::GetStats() const -> Stats
+{
+	Stats stats;
+	stats.capacity = m_capacity;
+	stats.used = m_used;
+	stats.allocations = m_allocations;
+	stats.free_blocks = m_free_blocks;
+
+	// The largest block is in the highest non-empty size class
+	if (m_fl_bitmap != 0) {
+		const auto fl = uint32_t(std::bit_width(m_fl_bitmap)) - 1;
+		const auto sl = uint32_t(std::bit_width(m_sl_bitmap[fl])) - 1;
+		for (auto idx = m_free_heads[fl][sl]; idx != NONE; idx = m_blocks[idx].next_free) {
+			stats.largest_free_block = std::max(stats.largest_free_block, m_blocks[idx].size);
+		}
+	}
+	return stats;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SETTER
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void TlsfAllocator::SetUserData(Handle handle, uint32_t user_data)
+{
+	m_blocks[m_handles[handle]].user_data = user_data;
+}
+
+} // namespace utils
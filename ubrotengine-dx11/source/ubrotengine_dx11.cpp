@@ -7,11 +7,13 @@
 //////////////
 // INCLUDES //
 //////////////
-
+#include <algorithm>
+#include <chrono>
 
 ///////////////////////
 // MY CLASS INCLUDES //
 ///////////////////////
+#include "../header/image_encoder.h"
 
 
 namespace graphics
@@ -27,12 +29,14 @@ auto Engine::RendererInit(const HWND& hwnd, const GraphicSettings& settings) ->
 {
 	// Create and initialize a renderer object used to render scenes
 	m_renderer = std::make_unique<Renderer>();
+	m_capture->AddSettings(settings);
 	return m_renderer->Initialize(hwnd, settings);
 }
 
 
 void Engine::Shutdown()
 {
+	m_capture->Close();
 	m_renderer->Shutdown();
 	m_renderer = nullptr;
 }
@@ -40,6 +44,7 @@ void Engine::Shutdown()
 
 auto Engine::Refresh(const GraphicSettings& settings) -> HRESULT
 {
+	m_capture->AddSettings(settings);
 	return m_renderer->Refresh(settings);
 }
 
@@ -50,24 +55,56 @@ auto Engine::RegisterShader(HWND hwnd, int shader_type) -> bool
 }*/
 
 
+auto Engine::MountArchive(const std::string& filename) -> bool
+{
+	m_capture->AddArchive(filename);
+	return m_renderer->MountArchive(filename);
+}
+
+
 auto Engine::RegisterModel(const std::string& filename) -> size_t
 {
+	m_capture->AddModel(filename);
 	return m_renderer->RegisterModel(filename);
 }
 
 
 auto Engine::RegisterModelProcedural(const uint8_t num) -> size_t
 {
+	m_capture->AddProceduralModel(num);
 	return m_renderer->RegisterModelProcedural(assets::Procedural(num));
 }
 
 
 auto Engine::RegisterTexture(const std::string& filename, uint8_t components) -> size_t
 {
+	m_capture->AddTexture(filename, components);
 	return m_renderer->RegisterTexture(filename, components);
 }
 
 
+auto Engine::RegisterModels(const std::vector<std::string>& filenames) -> std::vector<size_t>
+{
+	m_capture->AddModels(filenames);
+	return m_renderer->RegisterModels(filenames);
+}
+
+
+auto Engine::RegisterTextures(const std::vector<std::string>& filenames, uint8_t components)
+	-> std::vector<size_t>
+{
+	m_capture->AddTextures(filenames, components);
+	return m_renderer->RegisterTextures(filenames, components);
+}
+
+
+void Engine::SetModelTexture(size_t model_idx, size_t texture_idx)
+{
+	m_capture->AddModelTexture(model_idx, texture_idx);
+	m_renderer->SetModelTexture(model_idx, texture_idx);
+}
+
+
 auto Engine::GetSupportedResolutions() const -> const std::vector<std::tuple<uint16_t, uint16_t>>&
 {
 	return m_renderer->GetSupportedResolutions();
@@ -76,7 +113,107 @@ auto Engine::GetSupportedResolutions() const -> const std::vector<std::tuple<uin
 
 auto Engine::RenderScene(const Scene& scene) -> HRESULT
 {
-	return m_renderer->Process(scene);
+	using Clock = std::chrono::high_resolution_clock;
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+
+	const auto read_start = Clock::now();
+	ReadScene(scene);
+	const auto read_ms = Milliseconds(Clock::now() - read_start).count();
+
+	const auto result = m_renderer->Process(m_scene_input, read_ms);
+	// A capture that can not be written is stopped
+	if (!m_capture->AddFrame(m_scene_input)) {
+		m_capture->Close();
+	}
+	return result;
+}
+
+
+auto Engine::RenderScene(const SceneInput& input) -> HRESULT
+{
+	const auto result = m_renderer->Process(input);
+	if (!m_capture->AddFrame(input)) {
+		m_capture->Close();
+	}
+	return result;
+}
+
+
+auto Engine::BeginCapture(const std::string& filename) -> bool
+{
+	return m_capture->Open(filename);
+}
+
+
+void Engine::EndCapture()
+{
+	m_capture->Close();
+}
+
+
+auto Engine::GetCaptureStats() const -> CaptureWriter::Stats
+{
+	return m_capture->GetStats();
+}
+
+
+void Engine::SetDeterministic(bool deterministic)
+{
+	m_renderer->SetDeterministic(deterministic);
+}
+
+
+auto Engine::GetFrameStats() const -> const FrameStats&
+{
+	return m_renderer->GetFrameStats();
+}
+
+
+auto Engine::GetRecordedCommands() const -> const CommandBuffer&
+{
+	return m_renderer->GetRecordedCommands();
+}
+
+
+auto Engine::SaveSoftwareFrame(const std::string& filename) const -> bool
+{
+	io::Image image;
+	if (!m_renderer->GetSoftwareFrame(image)) {
+		return false;
+	}
+	return io::ImageEncoder::WriteFile(filename, image);
+}
+
+
+void Engine::ReadScene(const Scene& scene)
+{
+	m_scene_input.Clear();
+	// Scenes with less users than views keep the cameras of the views without a user
+	const auto user_count = std::min(m_renderer->GetViewCount(), scene.GetUserCount());
+	for (size_t v = 0; v < user_count; v++) {
+		const auto& user = scene.GetUser(v);
+		const auto& pos = user.GetCamPos();
+		const auto& look_at = user.GetCamLookDir();
+		m_scene_input.users.push_back(
+			{ { pos[0], pos[1], pos[2] }, { look_at[0], look_at[1], look_at[2] } }
+		);
+	}
+
+	// For all tiles in this scene, objects whose model could not be loaded are left out
+	const auto model_count = m_renderer->GetModelCount();
+	for (const auto& tile : scene.GetTiles()) {
+		// Get the tile coords to access the scene objects
+		const auto first = m_scene_input.models.size();
+		for (const auto& o : scene.GetObjects(tile.first)) {
+			if (size_t(o.GetModelIdx()) >= model_count) {
+				continue;
+			}
+			const auto position = o.GetPosition();
+			m_scene_input.models.push_back(uint32_t(o.GetModelIdx()));
+			m_scene_input.positions.push_back({ position[0], position.y, position.z });
+		}
+		m_scene_input.tile_objects.push_back(uint32_t(m_scene_input.models.size() - first));
+	}
 }
 
 } // namespace graphics
@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: view_culler.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/view_culler.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cassert>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define VIEW_CULLER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+
+
+namespace graphics
+{
+
+namespace
+{
+
+/**
+ * Returns false if the sphere is completely outside of one of the planes.
+ */
+auto TestSphere(
+	const ViewCuller::ViewPlanes& planes, float x, float y, float z, float radius
+) -> bool
+{
+	for (const auto& plane : planes) {
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#ifdef VIEW_CULLER_SSE2
+/**
+ * Returns a bit per lane that is set if the sphere of the lane is not completely outside
+ * of any plane.
+ */
+auto TestPlanes(
+	const ViewCuller::ViewPlanes& planes, __m128 x, __m128 y, __m128 z, __m128 neg_radius
+) -> int
+{
+	auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	for (const auto& plane : planes) {
+		auto distance = _mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)
+		);
+		distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+		distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+		inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, neg_radius));
+	}
+	return _mm_movemask_ps(inside);
+}
+#else
+auto TestPlanes(
+	const ViewCuller::ViewPlanes& planes, const float* x, const float* y, const float* z,
+	const float* radius
+) -> int
+{
+	int bits{ 0 };
+	for (size_t lane = 0; lane < 4; lane++) {
+		bits |= TestSphere(planes, x[lane], y[lane], z[lane], radius[lane]) ? 1 << lane : 0;
+	}
+	return bits;
+}
+#endif
+
+} // namespace
+
+
+void ViewCuller::Clear()
+{
+	m_planes.clear();
+	m_x.clear();
+	m_y.clear();
+	m_z.clear();
+	m_radius.clear();
+	m_masks.clear();
+	m_sphere_count = 0;
+}
+
+
+auto ViewCuller::AddView(const Camera& camera, const math::Float4& clip_plane) -> size_t
+{
+	assert(m_planes.size() < MAX_VIEWS && "ViewCuller has too many views");
+	m_planes.push_back(GetPlanes(camera, clip_plane));
+	return m_planes.size() - 1;
+}
+
+
+auto ViewCuller::GetPlanes(const Camera& camera, const math::Float4& clip_plane)
+	-> ViewPlanes
+{
+	const auto& frustum = camera.GetFrustumPlanes();
+	ViewPlanes planes;
+	std::copy(frustum.begin(), frustum.end(), planes.begin());
+	planes.back() = clip_plane;
+	return planes;
+}
+
+
+auto ViewCuller::AddSphere(const math::Float3& center, float radius) -> uint32_t
+{
+	m_x.push_back(center.x);
+	m_y.push_back(center.y);
+	m_z.push_back(center.z);
+	m_radius.push_back(radius);
+	return uint32_t(m_sphere_count++);
+}
+
+
+void ViewCuller::Cull()
+{
+	// Padded spheres sit at the origin with radius zero, their masks are cut off below
+	const auto padded = (m_sphere_count + LANES - 1) / LANES * LANES;
+	m_x.resize(padded, 0.0F);
+	m_y.resize(padded, 0.0F);
+	m_z.resize(padded, 0.0F);
+	m_radius.resize(padded, 0.0F);
+	m_masks.assign(padded, 0);
+
+	for (size_t i = 0; i < padded; i += LANES) {
+#ifdef VIEW_CULLER_SSE2
+		const auto x = _mm_loadu_ps(&m_x[i]);
+		const auto y = _mm_loadu_ps(&m_y[i]);
+		const auto z = _mm_loadu_ps(&m_z[i]);
+		const auto neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[i]));
+#endif
+		for (size_t view = 0; view < m_planes.size(); view++) {
+#ifdef VIEW_CULLER_SSE2
+			const auto bits = TestPlanes(m_planes[view], x, y, z, neg_radius);
+#else
+			const auto bits = TestPlanes(m_planes[view], &m_x[i], &m_y[i], &m_z[i], &m_radius[i]);
+#endif
+			for (size_t lane = 0; lane < LANES; lane++) {
+				if ((bits & (1 << lane)) != 0) {
+					m_masks[i + lane] |= ViewMask(1U << view);
+				}
+			}
+		}
+	}
+
+	// The padding is removed again, so spheres can be added after a cull
+	m_x.resize(m_sphere_count);
+	m_y.resize(m_sphere_count);
+	m_z.resize(m_sphere_count);
+	m_radius.resize(m_sphere_count);
+	m_masks.resize(m_sphere_count);
+}
+
+
+void ViewCuller::CullPlanes(const ViewPlanes& planes, std::vector<uint32_t>& visible) const
+{
+	// The arrays are only padded during Cull, the spheres after the last full group are
+	// tested one by one
+	size_t i = 0;
+#ifdef VIEW_CULLER_SSE2
+	const auto full = m_sphere_count / LANES * LANES;
+	for (; i < full; i += LANES) {
+		const auto neg_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[i]));
+		const auto bits = TestPlanes(
+			planes, _mm_loadu_ps(&m_x[i]), _mm_loadu_ps(&m_y[i]), _mm_loadu_ps(&m_z[i]),
+			neg_radius
+		);
+		for (size_t lane = 0; lane < LANES; lane++) {
+			if ((bits & (1 << lane)) != 0) {
+				visible.push_back(uint32_t(i + lane));
+			}
+		}
+	}
+#endif
+	for (; i < m_sphere_count; i++) {
+		if (TestSphere(planes, m_x[i], m_y[i], m_z[i], m_radius[i])) {
+			visible.push_back(uint32_t(i));
+		}
+	}
+}
+
+
+auto ViewCuller::GetViewCount() const -> size_t
+{
+	return m_planes.size();
+}
+
+
+auto ViewCuller::GetSphereCount() const -> size_t
+{
+	return m_sphere_count;
+}
+
+
+auto ViewCuller::GetSphere(uint32_t sphere_idx) const -> math::Float4
+{
+	return { m_x[sphere_idx], m_y[sphere_idx], m_z[sphere_idx], m_radius[sphere_idx] };
+}
+
+
+auto ViewCuller::GetMasks() const -> const std::vector<ViewMask>&
+{
+	return m_masks;
+}
+
+} // namespace graphics
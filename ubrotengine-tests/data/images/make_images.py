@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+Writes the PNG and TGA test images and their golden RGBA decodes.
+
+The encoders below set every filter type, bit depth and packet type explicitly, the golden
+files are computed from the same source samples, not by decoding the written files. Every
+golden file holds width * height RGBA pixels, rows top down.
+
+Run from this directory: python3 make_images.py
+"""
+import struct
+import zlib
+
+
+class Random:
+	"""Small LCG, so the images do not change between Python versions."""
+
+	def __init__(self, seed):
+		self.state = seed
+
+	def next(self, bound):
+		self.state = (self.state * 1103515245 + 12345) & 0x7FFFFFFF
+		return (self.state >> 8) % bound
+
+
+def samples(width, height, channels, maximum, seed):
+	"""Gradients with noise, so all filter types see both smooth and rough rows."""
+	random = Random(seed)
+	rows = []
+	for y in range(height):
+		row = []
+		for x in range(width):
+			for c in range(channels):
+				smooth = (x * (c + 1) * 7 + y * 5) % (maximum + 1)
+				noise = random.next(maximum + 1)
+				row.append(smooth if (x + y + c) % 3 else noise)
+		rows.append(row)
+	return rows
+
+
+def chunk(kind, data):
+	body = kind + data
+	return struct.pack('>I', len(data)) + body + struct.pack('>I', zlib.crc32(body))
+
+
+def pack_row(row, bit_depth):
+	if bit_depth == 16:
+		return b''.join(struct.pack('>H', v) for v in row)
+	if bit_depth == 8:
+		return bytes(row)
+	per_byte = 8 // bit_depth
+	out = bytearray((len(row) + per_byte - 1) // per_byte)
+	for i, v in enumerate(row):
+		out[i // per_byte] |= v << (8 - bit_depth * (i % per_byte + 1))
+	return bytes(out)
+
+
+def paeth(a, b, c):
+	p = a + b - c
+	pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+	if pa <= pb and pa <= pc:
+		return a
+	return b if pb <= pc else c
+
+
+def filter_row(kind, row, prior, bpp):
+	out = bytearray(len(row))
+	for i, x in enumerate(row):
+		a = row[i - bpp] if i >= bpp else 0
+		b = prior[i] if prior is not None else 0
+		c = prior[i - bpp] if prior is not None and i >= bpp else 0
+		predictor = [0, a, b, (a + b) // 2, paeth(a, b, c)][kind]
+		out[i] = (x - predictor) & 0xFF
+	return bytes(out)
+
+
+def write_png(path, width, height, bit_depth, color_type, rows, extra=b'', level=9,
+	idat_count=1):
+	channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+	bpp = max(channels * bit_depth // 8, 1)
+	raw = bytearray()
+	prior = None
+	for y, row in enumerate(rows):
+		packed = pack_row(row, bit_depth)
+		# Cycles through all five filter types
+		kind = y % 5
+		raw.append(kind)
+		raw += filter_row(kind, packed, prior, bpp)
+		prior = packed
+	compressed = zlib.compress(bytes(raw), level)
+	step = (len(compressed) + idat_count - 1) // idat_count
+	idat = b''.join(
+		chunk(b'IDAT', compressed[i:i + step]) for i in range(0, len(compressed), step)
+	)
+	header = struct.pack('>IIBBBBB', width, height, bit_depth, color_type, 0, 0, 0)
+	with open(path, 'wb') as f:
+		f.write(b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', header) + extra + idat
+			+ chunk(b'IEND', b''))
+
+
+def write_golden(path, pixels):
+	with open(path, 'wb') as f:
+		f.write(bytes(v for pixel in pixels for v in pixel))
+
+
+def rle_encode(pixels):
+	"""Run packets for repeated pixels, raw packets for the rest."""
+	out = bytearray()
+	i = 0
+	while i < len(pixels):
+		run = 1
+		while i + run < len(pixels) and run < 128 and pixels[i + run] == pixels[i]:
+			run += 1
+		if run > 1:
+			out.append(0x80 | (run - 1))
+			out += pixels[i]
+			i += run
+			continue
+		start = i
+		while i < len(pixels) and i - start < 128 and (
+			i + 1 >= len(pixels) or pixels[i + 1] != pixels[i]):
+			i += 1
+		out.append(i - start - 1)
+		out += b''.join(pixels[start:i])
+	return bytes(out)
+
+
+def write_tga(path, width, height, image_type, pixel_bits, descriptor, pixels, color_map=None):
+	"""pixels holds the stored bytes of every pixel in top down order."""
+	if descriptor & 0x20 == 0:
+		pixels = [p for y in reversed(range(height)) for p in pixels[y * width:(y + 1) * width]]
+	map_bytes = b''
+	map_spec = struct.pack('<HHB', 0, 0, 0)
+	if color_map is not None:
+		map_bytes = b''.join(color_map)
+		map_spec = struct.pack('<HHB', 0, len(color_map), len(color_map[0]) * 8)
+	header = struct.pack('<BB', 3, 1 if color_map is not None else 0) + bytes([image_type])
+	header += map_spec + struct.pack('<HHHHBB', 0, 0, width, height, pixel_bits, descriptor)
+	data = rle_encode(pixels) if image_type >= 9 else b''.join(pixels)
+	with open(path, 'wb') as f:
+		f.write(header + b'id!' + map_bytes + data)
+
+
+def to_rgba_gray(value, alpha=255):
+	return (value, value, value, alpha)
+
+
+def png_images():
+	w, h = 37, 29
+
+	rows = samples(w, h, 3, 255, 1)
+	write_png('rgb8.png', w, h, 8, 2, rows)
+	write_golden('rgb8.rgba', [
+		(r[x * 3], r[x * 3 + 1], r[x * 3 + 2], 255) for r in rows for x in range(w)
+	])
+
+	# Large enough for the color conversion to be split across threads, stored blocks and
+	# several IDAT chunks
+	rows = samples(45, 131, 4, 255, 2)
+	write_png('rgba8.png', 45, 131, 8, 6, rows, level=0, idat_count=7)
+	write_golden('rgba8.rgba', [tuple(r[x * 4:x * 4 + 4]) for r in rows for x in range(45)])
+
+	rows = samples(w, h, 1, 255, 3)
+	write_png('gray8.png', w, h, 8, 0, rows)
+	write_golden('gray8.rgba', [to_rgba_gray(v) for r in rows for v in r])
+
+	rows = samples(w, h, 2, 255, 4)
+	write_png('gray_alpha8.png', w, h, 8, 4, rows)
+	write_golden('gray_alpha8.rgba', [
+		to_rgba_gray(r[x * 2], r[x * 2 + 1]) for r in rows for x in range(w)
+	])
+
+	for depth in (1, 2, 4):
+		rows = samples(w, h, 1, (1 << depth) - 1, 4 + depth)
+		scale = 255 // ((1 << depth) - 1)
+		write_png('gray%d.png' % depth, w, h, depth, 0, rows)
+		write_golden('gray%d.rgba' % depth, [to_rgba_gray(v * scale) for r in rows for v in r])
+
+	# 16 bit samples keep their high byte, the color key compares all 16 bits
+	rows = samples(w, h, 3, 65535, 8)
+	key = tuple(rows[3][6:9])
+	rows[10][:3] = [key[0], key[1], key[2] ^ 1]
+	write_png('rgb16_key.png', w, h, 16, 2, rows, extra=chunk(b'tRNS', struct.pack('>HHH', *key)))
+	write_golden('rgb16_key.rgba', [
+		(r[x * 3] >> 8, r[x * 3 + 1] >> 8, r[x * 3 + 2] >> 8,
+			0 if tuple(r[x * 3:x * 3 + 3]) == key else 255)
+		for r in rows for x in range(w)
+	])
+
+	rows = samples(w, h, 4, 65535, 9)
+	write_png('rgba16.png', w, h, 16, 6, rows)
+	write_golden('rgba16.rgba', [
+		tuple(v >> 8 for v in r[x * 4:x * 4 + 4]) for r in rows for x in range(w)
+	])
+
+	# Palettes with fewer alpha entries than colors, linear gamma
+	for depth in (4, 8):
+		count = 1 << depth
+		rows = samples(w, h, 1, count - 1, 10 + depth)
+		palette = [((i * 37) % 256, (i * 91) % 256, (i * 13 + 7) % 256) for i in range(count)]
+		alpha = [(i * 53) % 256 for i in range(count // 2)]
+		extra = chunk(b'gAMA', struct.pack('>I', 100000)) + chunk(b'PLTE', bytes(
+			v for color in palette for v in color)) + chunk(b'tRNS', bytes(alpha))
+		write_png('palette%d.png' % depth, w, h, depth, 3, rows, extra=extra)
+		write_golden('palette%d.rgba' % depth, [
+			palette[v] + ((alpha[v] if v < len(alpha) else 255),) for r in rows for v in r
+		])
+
+
+def tga_images():
+	w, h = 33, 19
+
+	# True color, bottom up and uncompressed
+	rows = samples(w, h, 3, 255, 20)
+	pixels = [bytes((r[x * 3 + 2], r[x * 3 + 1], r[x * 3])) for r in rows for x in range(w)]
+	write_tga('bgr24.tga', w, h, 2, 24, 0x00, pixels)
+	write_golden('bgr24.rgba', [(p[2], p[1], p[0], 255) for p in pixels])
+
+	# Runs that cross row ends, top down
+	rows = samples(w, h, 4, 255, 21)
+	pixels = [bytes((r[x * 4 + 2], r[x * 4 + 1], r[x * 4], r[x * 4 + 3]))
+		for r in rows for x in range(w)]
+	pixels = [pixels[i // 5 * 5] if (i // 40) % 2 else pixels[i] for i in range(len(pixels))]
+	write_tga('bgra32_rle.tga', w, h, 10, 32, 0x28, pixels)
+	write_golden('bgra32_rle.rgba', [(p[2], p[1], p[0], p[3]) for p in pixels])
+
+	# Without alpha bits in the descriptor the fourth channel is ignored
+	write_tga('bgrx32.tga', w, h, 2, 32, 0x20, pixels)
+	write_golden('bgrx32.rgba', [(p[2], p[1], p[0], 255) for p in pixels])
+
+	rows = samples(w, h, 1, 255, 22)
+	pixels = [bytes((v,)) for r in rows for v in r]
+	write_tga('gray8_rle.tga', w, h, 11, 8, 0x00, pixels)
+	write_golden('gray8_rle.rgba', [to_rgba_gray(p[0]) for p in pixels])
+
+	rows = samples(w, h, 1, 255, 23)
+	color_map = [bytes(((i * 7) % 256, (i * 29) % 256, (i * 101) % 256, i)) for i in range(256)]
+	pixels = [bytes((v,)) for r in rows for v in r]
+	write_tga('mapped8.tga', w, h, 1, 8, 0x28, pixels, color_map)
+	write_golden('mapped8.rgba', [
+		(color_map[p[0]][2], color_map[p[0]][1], color_map[p[0]][0], color_map[p[0]][3])
+		for p in pixels
+	])
+
+
+if __name__ == '__main__':
+	png_images()
+	tga_images()
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: command_buffer_test.cpp
+/// Recording, merging and replaying command buffers against a mock backend.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/command_buffer.h"
+#include "header/recording_command_backend.h"
+#include "header/thread_pool.h"
+
+
+namespace
+{
+
+using graphics::CommandBuffer;
+
+/**
+ * Logs every command as text, so whole replays can be compared at once.
+ */
+class MockBackend
+{
+
+public:
+	void SetProgram(uint32_t program_idx)
+	{
+		log.push_back("program " + std::to_string(program_idx));
+	}
+
+	void SetModel(uint32_t model_idx)
+	{
+		log.push_back("model " + std::to_string(model_idx));
+	}
+
+	void SetWorldMatrix(const math::Float4x4& world)
+	{
+		log.push_back("world " + std::to_string(world.m[3][0]));
+	}
+
+	void SetTexture(uint32_t texture_idx)
+	{
+		log.push_back("texture " + std::to_string(texture_idx));
+	}
+
+	void DrawIndexed(uint32_t index_count, uint32_t start_index, int32_t base_vertex)
+	{
+		log.push_back(
+			"draw " + std::to_string(index_count) + " " + std::to_string(start_index) + " "
+			+ std::to_string(base_vertex)
+		);
+	}
+
+	void SetView(uint32_t view_idx)
+	{
+		log.push_back("view " + std::to_string(view_idx));
+	}
+
+	void ClearView(uint32_t view_idx)
+	{
+		log.push_back("clear " + std::to_string(view_idx));
+	}
+
+	std::vector<std::string> log{};
+};
+
+/**
+ * Records one draw, the model index doubles as the sort key and the translation.
+ */
+void RecordDraw(CommandBuffer& buffer, uint32_t key)
+{
+	buffer.BeginRecord(key);
+	buffer.SetView(0);
+	buffer.SetModel(key);
+	buffer.SetWorldMatrix(math::Translation(float(key), 0.0F, 0.0F));
+	buffer.DrawIndexed(36, key * 36, -int32_t(key));
+	buffer.EndRecord();
+}
+
+} // namespace
+
+
+TEST(CommandBuffer, ReplaysCommandsWithTheirArguments)
+{
+	CommandBuffer buffer;
+	buffer.BeginRecord(7);
+	buffer.ClearView(2);
+	buffer.SetView(1);
+	buffer.SetProgram(3);
+	buffer.SetModel(4);
+	buffer.SetTexture(5);
+	buffer.SetWorldMatrix(math::Translation(6.0F, 0.0F, 0.0F));
+	buffer.DrawIndexed(12, 24, -8);
+	buffer.EndRecord();
+
+	ASSERT_EQ(buffer.GetRecords().size(), 1U);
+	EXPECT_EQ(buffer.GetRecords().front().sort_key, 7U);
+	EXPECT_EQ(buffer.GetRecords().front().size, buffer.GetByteSize());
+
+	MockBackend backend;
+	buffer.Replay(backend);
+	const std::vector<std::string> expected = {
+		"clear 2", "view 1", "program 3", "model 4", "texture 5", "world 6.000000",
+		"draw 12 24 -8"
+	};
+	EXPECT_EQ(backend.log, expected);
+
+	buffer.Clear();
+	EXPECT_EQ(buffer.GetByteSize(), 0U);
+	EXPECT_TRUE(buffer.GetRecords().empty());
+}
+
+
+TEST(CommandBuffer, MergeOrdersRecordsBySortKey)
+{
+	std::vector<CommandBuffer> buffers(4);
+	for (const auto key : { 1U, 4U, 4U, 9U }) {
+		RecordDraw(buffers[0], key);
+	}
+	for (const auto key : { 2U, 4U, 8U }) {
+		RecordDraw(buffers[1], key);
+	}
+	// Buffers without records are skipped
+	for (const auto key : { 0U, 3U }) {
+		RecordDraw(buffers[3], key);
+	}
+
+	std::vector<CommandBuffer::RecordRef> merged = { { 5, 5 } };
+	CommandBuffer::Merge(buffers, merged);
+	ASSERT_EQ(merged.size(), 9U);
+
+	// Equal keys keep the order of the buffers
+	const std::vector<std::pair<uint32_t, uint32_t>> expected = {
+		{ 3, 0 }, { 0, 0 }, { 1, 0 }, { 3, 1 }, { 0, 1 }, { 0, 2 }, { 1, 1 }, { 1, 2 }, { 0, 3 }
+	};
+	for (size_t i = 0; i < merged.size(); i++) {
+		EXPECT_EQ(merged[i].buffer_idx, expected[i].first) << i;
+		EXPECT_EQ(merged[i].record_idx, expected[i].second) << i;
+	}
+
+	MockBackend backend;
+	CommandBuffer::Replay(buffers, merged, backend);
+	ASSERT_EQ(backend.log.size(), 9U * 4U);
+	EXPECT_EQ(backend.log[1], "model 0");
+	EXPECT_EQ(backend.log[3], "draw 36 0 0");
+	EXPECT_EQ(backend.log.back(), "draw 36 324 -9");
+}
+
+
+TEST(CommandBuffer, ParallelRecordingMatchesSerialOrder)
+{
+	constexpr uint32_t DRAWS = 1000;
+	utils::ThreadPool thread_pool(3);
+	std::vector<CommandBuffer> buffers(thread_pool.GetThreadCount());
+	thread_pool.ParallelFor(
+		DRAWS, buffers.size(),
+		[&](size_t begin, size_t end, size_t chunk) {
+			for (size_t i = begin; i < end; i++) {
+				RecordDraw(buffers[chunk], uint32_t(i));
+			}
+		}
+	);
+	std::vector<CommandBuffer::RecordRef> merged;
+	CommandBuffer::Merge(buffers, merged);
+
+	CommandBuffer serial;
+	for (uint32_t i = 0; i < DRAWS; i++) {
+		RecordDraw(serial, i);
+	}
+
+	MockBackend parallel_backend;
+	CommandBuffer::Replay(buffers, merged, parallel_backend);
+	MockBackend serial_backend;
+	serial.Replay(serial_backend);
+	EXPECT_EQ(parallel_backend.log, serial_backend.log);
+}
+
+
+TEST(RecordingCommandBackend, LogReplaysLikeTheOriginal)
+{
+	std::vector<CommandBuffer> buffers(2);
+	RecordDraw(buffers[0], 1);
+	RecordDraw(buffers[1], 2);
+	RecordDraw(buffers[0], 3);
+	std::vector<CommandBuffer::RecordRef> merged;
+	CommandBuffer::Merge(buffers, merged);
+
+	CommandBuffer log;
+	log.BeginRecord(0);
+	graphics::RecordingCommandBackend recording(log);
+	CommandBuffer::Replay(buffers, merged, recording);
+	log.EndRecord();
+
+	MockBackend original;
+	CommandBuffer::Replay(buffers, merged, original);
+	MockBackend replayed;
+	log.Replay(replayed);
+	EXPECT_EQ(replayed.log, original.log);
+}
@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: dds_loader_test.cpp
+/// Header parsing and subresource layout of DDS files that are built in memory, with the DX10
+/// header as well as with the legacy header.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/dds_loader.h"
+
+
+namespace
+{
+
+using graphics::TextureFormat;
+using io::DdsLoader;
+
+constexpr size_t DX10_HEADER_BYTES = 4 + 124 + 20;
+constexpr size_t LEGACY_HEADER_BYTES = 4 + 124;
+
+/**
+ * Returns the bytes of all subresources in file order.
+ */
+auto GetDataSize(const io::DdsInfo& info) -> size_t
+{
+	size_t size{ 0 };
+	for (uint32_t slice = 0; slice < info.array_size; slice++) {
+		for (uint32_t mip = 0; mip < info.mip_count; mip++) {
+			uint32_t row_pitch{ 0 };
+			uint32_t row_count{ 0 };
+			EXPECT_TRUE(DdsLoader::GetSurfaceInfo(
+				std::max(info.width >> mip, 1U), std::max(info.height >> mip, 1U), info.format,
+				row_pitch, row_count
+			));
+			size += size_t(row_pitch) * row_count;
+		}
+	}
+	return size;
+}
+
+/**
+ * Writes a file whose data bytes count up, so every subresource can be found by its content.
+ */
+auto WriteFile(const io::DdsInfo& info) -> std::vector<uint8_t>
+{
+	std::vector<uint8_t> data(GetDataSize(info));
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = uint8_t(i);
+	}
+	std::vector<uint8_t> file;
+	DdsLoader::Write(info, data.data(), data.size(), file);
+	return file;
+}
+
+/**
+ * Writes a legacy header without DX10 extension, the words are in the order of the DDS header.
+ */
+auto WriteLegacyFile(
+	uint32_t width, uint32_t height, uint32_t mip_count, uint32_t four_cc, uint32_t caps2,
+	size_t data_size
+) -> std::vector<uint8_t>
+{
+	uint32_t words[32] = {};
+	words[0] = 0x20534444; // "DDS "
+	words[1] = 124;
+	words[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+	words[3] = height;
+	words[4] = width;
+	words[7] = mip_count;
+	words[19] = 32;
+	words[20] = 0x4;
+	words[21] = four_cc;
+	words[27] = 0x1000;
+	words[28] = caps2;
+
+	std::vector<uint8_t> file(LEGACY_HEADER_BYTES + data_size, 0);
+	std::memcpy(file.data(), words, LEGACY_HEADER_BYTES);
+	return file;
+}
+
+constexpr uint32_t FOURCC_DXT1 = 0x31545844;
+constexpr uint32_t FOURCC_DXT5 = 0x35545844;
+
+} // namespace
+
+
+TEST(DdsLoader, SurfaceInfoRoundsToBlocks)
+{
+	uint32_t row_pitch{ 0 };
+	uint32_t row_count{ 0 };
+	ASSERT_TRUE(DdsLoader::GetSurfaceInfo(10, 6, TextureFormat::BC1_UNORM, row_pitch, row_count));
+	EXPECT_EQ(row_pitch, 3U * 8U);
+	EXPECT_EQ(row_count, 2U);
+
+	// Mips smaller than a block still take a whole block
+	ASSERT_TRUE(DdsLoader::GetSurfaceInfo(1, 2, TextureFormat::BC7_UNORM, row_pitch, row_count));
+	EXPECT_EQ(row_pitch, 16U);
+	EXPECT_EQ(row_count, 1U);
+
+	ASSERT_TRUE(
+		DdsLoader::GetSurfaceInfo(10, 6, TextureFormat::R8G8B8A8_UNORM, row_pitch, row_count)
+	);
+	EXPECT_EQ(row_pitch, 40U);
+	EXPECT_EQ(row_count, 6U);
+	ASSERT_TRUE(DdsLoader::GetSurfaceInfo(3, 1, TextureFormat::R8_UNORM, row_pitch, row_count));
+	EXPECT_EQ(row_pitch, 3U);
+
+	EXPECT_FALSE(DdsLoader::GetSurfaceInfo(4, 4, TextureFormat::UNKNOWN, row_pitch, row_count));
+}
+
+
+TEST(DdsLoader, ParsesWhatItWrites)
+{
+	io::DdsInfo written;
+	written.width = 20;
+	written.height = 12;
+	written.mip_count = 5;
+	written.array_size = 3;
+	written.format = TextureFormat::BC3_UNORM;
+	const auto file = WriteFile(written);
+
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	ASSERT_TRUE(DdsLoader::Parse(file.data(), file.size(), info, subresources));
+	EXPECT_EQ(info.width, 20U);
+	EXPECT_EQ(info.height, 12U);
+	EXPECT_EQ(info.mip_count, 5U);
+	EXPECT_EQ(info.array_size, 3U);
+	EXPECT_EQ(info.format, TextureFormat::BC3_UNORM);
+	EXPECT_FALSE(info.cubemap);
+
+	// 20x12, 10x6, 5x3, 2x1 and 1x1 in blocks of 16 bytes for every slice
+	const uint32_t blocks_x[] = { 5, 3, 2, 1, 1 };
+	const uint32_t blocks_y[] = { 3, 2, 1, 1, 1 };
+	ASSERT_EQ(subresources.size(), 15U);
+	size_t offset = DX10_HEADER_BYTES;
+	for (size_t i = 0; i < subresources.size(); i++) {
+		const auto mip = i % 5;
+		const auto& subresource = subresources[i];
+		EXPECT_EQ(subresource.data, file.data() + offset) << i;
+		EXPECT_EQ(subresource.row_pitch, blocks_x[mip] * 16U) << i;
+		EXPECT_EQ(subresource.slice_pitch, blocks_x[mip] * blocks_y[mip] * 16U) << i;
+		const auto first_byte = *static_cast<const uint8_t*>(subresource.data);
+		EXPECT_EQ(first_byte, uint8_t(offset - DX10_HEADER_BYTES)) << i;
+		offset += subresource.slice_pitch;
+	}
+	EXPECT_EQ(offset, file.size());
+}
+
+
+TEST(DdsLoader, CubemapsHaveSixSlices)
+{
+	io::DdsInfo written;
+	written.width = 8;
+	written.height = 8;
+	written.mip_count = 4;
+	written.array_size = 6;
+	written.cubemap = true;
+	written.format = TextureFormat::R8G8B8A8_UNORM;
+	const auto file = WriteFile(written);
+
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	ASSERT_TRUE(DdsLoader::Parse(file.data(), file.size(), info, subresources));
+	EXPECT_TRUE(info.cubemap);
+	EXPECT_EQ(info.array_size, 6U);
+	ASSERT_EQ(subresources.size(), 24U);
+	EXPECT_EQ(subresources[0].row_pitch, 32U);
+	EXPECT_EQ(subresources[3].row_pitch, 4U);
+	// The second face starts after the whole mip chain of the first
+	EXPECT_EQ(
+		static_cast<const uint8_t*>(subresources[4].data) - file.data(),
+		std::ptrdiff_t(DX10_HEADER_BYTES + (64 + 16 + 4 + 1) * 4)
+	);
+}
+
+
+TEST(DdsLoader, ParsesLegacyHeaders)
+{
+	// 16x8 DXT1 with 4 mips: 4x2, 2x1, 1x1 and 1x1 blocks of 8 bytes
+	const auto file = WriteLegacyFile(16, 8, 4, FOURCC_DXT1, 0, (8 + 2 + 1 + 1) * 8);
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	ASSERT_TRUE(DdsLoader::Parse(file.data(), file.size(), info, subresources));
+	EXPECT_EQ(info.format, TextureFormat::BC1_UNORM);
+	EXPECT_EQ(info.mip_count, 4U);
+	EXPECT_EQ(info.array_size, 1U);
+	ASSERT_EQ(subresources.size(), 4U);
+	EXPECT_EQ(subresources[0].data, file.data() + LEGACY_HEADER_BYTES);
+	EXPECT_EQ(subresources[0].slice_pitch, 64U);
+	EXPECT_EQ(subresources[1].slice_pitch, 16U);
+	EXPECT_EQ(subresources[3].data, file.data() + LEGACY_HEADER_BYTES + 88);
+
+	// Cubemaps need all six faces
+	const auto cube = WriteLegacyFile(4, 4, 1, FOURCC_DXT5, 0x200 | 0xFC00, 6 * 16);
+	ASSERT_TRUE(DdsLoader::Parse(cube.data(), cube.size(), info, subresources));
+	EXPECT_EQ(info.format, TextureFormat::BC3_UNORM);
+	EXPECT_TRUE(info.cubemap);
+	EXPECT_EQ(subresources.size(), 6U);
+	const auto partial = WriteLegacyFile(4, 4, 1, FOURCC_DXT5, 0x200 | 0x0C00, 6 * 16);
+	EXPECT_FALSE(DdsLoader::Parse(partial.data(), partial.size(), info, subresources));
+}
+
+
+TEST(DdsLoader, RejectsInvalidFiles)
+{
+	io::DdsInfo written;
+	written.width = 16;
+	written.height = 16;
+	written.mip_count = 5;
+	written.array_size = 1;
+	written.format = TextureFormat::BC1_UNORM;
+	const auto file = WriteFile(written);
+
+	io::DdsInfo info;
+	std::vector<graphics::SubresourceData> subresources;
+	ASSERT_TRUE(DdsLoader::Parse(file.data(), file.size(), info, subresources));
+
+	// The last mip is missing a byte
+	EXPECT_FALSE(DdsLoader::Parse(file.data(), file.size() - 1, info, subresources));
+	EXPECT_TRUE(subresources.empty());
+	EXPECT_FALSE(DdsLoader::Parse(file.data(), DX10_HEADER_BYTES - 1, info, subresources));
+	EXPECT_FALSE(DdsLoader::Parse(nullptr, file.size(), info, subresources));
+
+	auto bad_magic = file;
+	bad_magic[3] = 'X';
+	EXPECT_FALSE(DdsLoader::Parse(bad_magic.data(), bad_magic.size(), info, subresources));
+
+	// 16x16 has five levels, a sixth does not exist
+	const auto too_many_mips = WriteLegacyFile(16, 16, 6, FOURCC_DXT1, 0, 1024);
+	EXPECT_FALSE(
+		DdsLoader::Parse(too_many_mips.data(), too_many_mips.size(), info, subresources)
+	);
+	const auto empty = WriteLegacyFile(0, 16, 1, FOURCC_DXT1, 0, 1024);
+	EXPECT_FALSE(DdsLoader::Parse(empty.data(), empty.size(), info, subresources));
+	const auto unknown = WriteLegacyFile(16, 16, 1, 0x31313131, 0, 1024);
+	EXPECT_FALSE(DdsLoader::Parse(unknown.data(), unknown.size(), info, subresources));
+}
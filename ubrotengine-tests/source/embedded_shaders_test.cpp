@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: embedded_shaders_test.cpp
+/// Lookup of embedded bytecode, with tables written the way the shaders tool writes them.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/embedded_shaders.h"
+#include "header/shader_manifest.h"
+#include "header/shader_program.h"
+
+
+namespace
+{
+
+using graphics::EmbeddedShader;
+using graphics::EmbeddedShaderTable;
+using graphics::ShaderCompileDesc;
+
+/**
+ * Owns the strings of the rows, like the constant arrays of a generated header would.
+ */
+class TableWriter
+{
+
+public:
+	void Add(const ShaderCompileDesc& desc)
+	{
+		const auto& stored = m_descs.emplace_back(desc);
+		const auto name = stored.path.filename().u8string();
+		const auto& name_text = m_strings.emplace_back(name.begin(), name.end());
+		const auto& defines_text = m_strings.emplace_back(
+			EmbeddedShaderTable::JoinDefines(stored.defines)
+		);
+		// The bytecode of every row is its own index
+		const auto& bytecode = m_bytecode.emplace_back(uint8_t(m_bytecode.size()));
+		shaders.push_back({
+			name_text.c_str(), stored.entry_point.c_str(), stored.target.c_str(),
+			defines_text.c_str(), &bytecode, 1
+		});
+	}
+
+	std::vector<EmbeddedShader> shaders{};
+
+private:
+	std::deque<std::string> m_strings{};
+	std::deque<uint8_t> m_bytecode{};
+	std::deque<ShaderCompileDesc> m_descs{};
+};
+
+auto MakeDesc(
+	const char* path, const char* entry_point, const char* target,
+	std::vector<graphics::ShaderDefine> defines = {}
+) -> ShaderCompileDesc
+{
+	ShaderCompileDesc desc;
+	desc.path = path;
+	desc.entry_point = entry_point;
+	desc.target = target;
+	desc.defines = std::move(defines);
+	return desc;
+}
+
+} // namespace
+
+
+TEST(EmbeddedShaderTable, FindsShadersByNameEntryTargetAndDefines)
+{
+	const std::vector<ShaderCompileDesc> descs = {
+		MakeDesc("shaders/color.vs", "ColorVertexShader", "vs_5_0"),
+		MakeDesc("shaders/color.fs", "ColorPixelShader", "ps_5_0"),
+		MakeDesc("shaders/color.fs", "ColorPixelShader", "ps_5_0", { { "ALPHA_TEST", "1" } }),
+		MakeDesc("shaders/color.fs", "ColorPixelShader", "ps_4_0"),
+		MakeDesc("shaders/color.fs", "OtherPixelShader", "ps_5_0"),
+	};
+	TableWriter writer;
+	for (const auto& desc : descs) {
+		writer.Add(desc);
+	}
+	const EmbeddedShaderTable table(writer.shaders.data(), writer.shaders.size());
+	ASSERT_EQ(table.GetSize(), descs.size());
+
+	for (size_t i = 0; i < descs.size(); i++) {
+		const auto* shader = table.Find(descs[i]);
+		ASSERT_NE(shader, nullptr) << i;
+		EXPECT_EQ(shader->bytecode[0], i);
+	}
+
+	// The directory and the compile flags are not part of the key
+	auto moved = descs[2];
+	moved.path = "C:/game/data/shaders/color.fs";
+	moved.flags = 0x800;
+	ASSERT_NE(table.Find(moved), nullptr);
+	EXPECT_EQ(table.Find(moved)->bytecode[0], 2);
+
+	// Other define values, other define orders and unknown files are not embedded
+	const std::vector<ShaderCompileDesc> missing = {
+		MakeDesc("shaders/color.fs", "ColorPixelShader", "ps_5_0", { { "ALPHA_TEST", "0" } }),
+		MakeDesc(
+			"shaders/color.fs", "ColorPixelShader", "ps_5_0",
+			{ { "INSTANCING", "1" }, { "ALPHA_TEST", "1" } }
+		),
+		MakeDesc("shaders/texture.fs", "ColorPixelShader", "ps_5_0"),
+		MakeDesc("shaders/color.fs", "ColorPixelShader", "ps_5_1"),
+	};
+	for (const auto& desc : missing) {
+		EXPECT_EQ(table.Find(desc), nullptr) << EmbeddedShaderTable::GetKey(desc);
+	}
+
+	const EmbeddedShaderTable empty;
+	EXPECT_EQ(empty.GetSize(), 0U);
+	EXPECT_EQ(empty.Find(descs[0]), nullptr);
+}
+
+
+TEST(EmbeddedShaderTable, KeysDoNotRunIntoEachOther)
+{
+	EXPECT_EQ(EmbeddedShaderTable::JoinDefines({ { "A", "1" }, { "B", "" } }), "A=1;B=;");
+	EXPECT_NE(
+		EmbeddedShaderTable::GetKey(MakeDesc("a.fs", "main", "ps_5_0")),
+		EmbeddedShaderTable::GetKey(MakeDesc("a.f", "smain", "ps_5_0"))
+	);
+
+	const auto desc = MakeDesc("dir/a.fs", "main", "ps_5_0", { { "X", "2" } });
+	const EmbeddedShader shader = { "a.fs", "main", "ps_5_0", "X=2;", nullptr, 0 };
+	EXPECT_EQ(EmbeddedShaderTable::GetKey(desc), EmbeddedShaderTable::GetKey(shader));
+}
+
+
+TEST(EmbeddedShaderTable, CoversEveryVariantOfTheManifest)
+{
+	using graphics::ShaderProgram;
+	using ShaderType = ShaderProgram::ShaderType;
+
+	// The stages of every feature subset, as the engine asks for them
+	std::vector<ShaderCompileDesc> requested;
+	for (const auto& entry : graphics::SHADER_MANIFEST) {
+		graphics::FeatureMask mask{ 0 };
+		do {
+			const auto defines = graphics::GetFeatureDefines(mask);
+			requested.push_back(
+				ShaderProgram::GetCompileDesc(ShaderType::VertexShader, entry.vs_file, defines)
+			);
+			requested.push_back(
+				ShaderProgram::GetCompileDesc(ShaderType::FragmentShader, entry.fs_file, defines)
+			);
+			requested.push_back(ShaderProgram::GetLayoutCompileDesc(entry.layout_file, defines));
+			mask = (mask - entry.features) & entry.features;
+		} while (mask != 0);
+	}
+
+	// Programs share stages, the table keeps the first row of every key
+	TableWriter writer;
+	for (const auto& desc : requested) {
+		writer.Add(desc);
+	}
+	const EmbeddedShaderTable table(writer.shaders.data(), writer.shaders.size());
+	EXPECT_LT(table.GetSize(), requested.size());
+	for (const auto& desc : requested) {
+		const auto* shader = table.Find(desc);
+		ASSERT_NE(shader, nullptr) << EmbeddedShaderTable::GetKey(desc);
+		const auto first = std::find_if(
+			requested.begin(), requested.end(), [&](const ShaderCompileDesc& other) {
+				return EmbeddedShaderTable::GetKey(other) == EmbeddedShaderTable::GetKey(desc);
+			}
+		);
+		EXPECT_EQ(shader->bytecode[0], first - requested.begin());
+	}
+}
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: image_decoder_test.cpp
+/// PNG and TGA decodes compared with the golden images in data/images, which make_images.py
+/// computes from the source samples of every file.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/image_decoder.h"
+#include "header/thread_pool.h"
+
+
+namespace
+{
+
+using io::ImageDecoder;
+
+auto ReadFile(const std::string& name) -> std::vector<uint8_t>
+{
+	std::ifstream file(std::string(UBROTENGINE_TEST_DATA) + "/images/" + name, std::ios::binary);
+	EXPECT_TRUE(file.is_open()) << name;
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+struct GoldenImage
+{
+	const char* name;
+	const char* extension;
+	uint32_t width;
+	uint32_t height;
+	bool srgb;
+};
+
+// Every filter type, bit depth and color type of PNG, all supported TGA image types
+const GoldenImage GOLDEN_IMAGES[] = {
+	{ "rgb8", ".png", 37, 29, true },
+	{ "rgba8", ".png", 45, 131, true },
+	{ "gray8", ".png", 37, 29, true },
+	{ "gray_alpha8", ".png", 37, 29, true },
+	{ "gray1", ".png", 37, 29, true },
+	{ "gray2", ".png", 37, 29, true },
+	{ "gray4", ".png", 37, 29, true },
+	{ "rgb16_key", ".png", 37, 29, true },
+	{ "rgba16", ".png", 37, 29, true },
+	{ "palette4", ".png", 37, 29, false },
+	{ "palette8", ".png", 37, 29, false },
+	{ "bgr24", ".tga", 33, 19, true },
+	{ "bgra32_rle", ".tga", 33, 19, true },
+	{ "bgrx32", ".tga", 33, 19, true },
+	{ "gray8_rle", ".tga", 33, 19, true },
+	{ "mapped8", ".tga", 33, 19, true },
+};
+
+auto Decode(
+	const std::string& extension, const std::vector<uint8_t>& file, io::Image& image,
+	utils::ThreadPool* thread_pool
+) -> bool
+{
+	return extension == ".png"
+		? ImageDecoder::DecodePng(file.data(), file.size(), image, thread_pool)
+		: ImageDecoder::DecodeTga(file.data(), file.size(), image, thread_pool);
+}
+
+} // namespace
+
+
+TEST(ImageDecoder, MatchesGoldenImages)
+{
+	utils::ThreadPool thread_pool(4);
+	for (const auto& golden : GOLDEN_IMAGES) {
+		SCOPED_TRACE(std::string(golden.name) + golden.extension);
+		const auto file = ReadFile(std::string(golden.name) + golden.extension);
+		const auto expected = ReadFile(std::string(golden.name) + ".rgba");
+
+		// The split across threads must not change the result
+		for (auto* pool : { static_cast<utils::ThreadPool*>(nullptr), &thread_pool }) {
+			io::Image image;
+			ASSERT_TRUE(Decode(golden.extension, file, image, pool));
+			EXPECT_EQ(image.width, golden.width);
+			EXPECT_EQ(image.height, golden.height);
+			EXPECT_EQ(image.srgb, golden.srgb);
+			ASSERT_EQ(image.pixels.size(), expected.size());
+			for (size_t i = 0; i < expected.size(); i++) {
+				ASSERT_EQ(image.pixels[i], expected[i])
+					<< "pixel " << i / 4 << " channel " << i % 4;
+			}
+		}
+	}
+}
+
+
+TEST(ImageDecoder, RejectsDamagedFiles)
+{
+	io::Image image;
+	for (const auto& golden : GOLDEN_IMAGES) {
+		SCOPED_TRACE(std::string(golden.name) + golden.extension);
+		const auto file = ReadFile(std::string(golden.name) + golden.extension);
+		for (const auto size : { size_t(0), size_t(17), file.size() / 2 }) {
+			const std::vector<uint8_t> truncated(file.begin(), file.begin() + size);
+			EXPECT_FALSE(Decode(golden.extension, truncated, image, nullptr)) << size;
+		}
+	}
+
+	// A wrong CRC in a critical chunk, the byte is the height in the IHDR chunk
+	auto png = ReadFile("rgb8.png");
+	png[22] ^= 1U;
+	EXPECT_FALSE(ImageDecoder::DecodePng(png.data(), png.size(), image, nullptr));
+}
+
+
+TEST(ImageDecoder, VectorizedUnfilteringMatchesScalar)
+{
+	std::mt19937 random(32);
+	for (uint32_t bpp = 1; bpp <= 8; bpp++) {
+		for (const size_t pixels : { 1, 5, 17, 64 }) {
+			const size_t row_bytes = pixels * bpp;
+			std::vector<uint8_t> prior(row_bytes);
+			std::vector<uint8_t> row(row_bytes);
+			for (auto& value : prior) {
+				value = uint8_t(random());
+			}
+			for (auto& value : row) {
+				value = uint8_t(random());
+			}
+
+			for (uint8_t filter = 0; filter < 5; filter++) {
+				SCOPED_TRACE(
+					"bpp " + std::to_string(bpp) + " pixels " + std::to_string(pixels)
+					+ " filter " + std::to_string(filter)
+				);
+				const std::vector<const uint8_t*> prior_rows = { nullptr, prior.data() };
+				for (const auto* prior_row : prior_rows) {
+					auto vectorized = row;
+					auto scalar = row;
+					ASSERT_TRUE(ImageDecoder::UnfilterRow(
+						filter, vectorized.data(), prior_row, row_bytes, bpp
+					));
+					ASSERT_TRUE(ImageDecoder::UnfilterRowScalar(
+						filter, scalar.data(), prior_row, row_bytes, bpp
+					));
+					EXPECT_EQ(vectorized, scalar);
+				}
+			}
+		}
+	}
+	std::vector<uint8_t> row(8);
+	EXPECT_FALSE(ImageDecoder::UnfilterRow(5, row.data(), nullptr, row.size(), 4));
+}
+
+
+TEST(ImageDecoder, SwizzleAndExpandHandleTails)
+{
+	// Longer than one vector and not a multiple of it
+	constexpr size_t PIXELS = 37;
+	std::vector<uint8_t> bgra(PIXELS * 4);
+	std::vector<uint8_t> gray(PIXELS);
+	for (size_t i = 0; i < bgra.size(); i++) {
+		bgra[i] = uint8_t(i * 7);
+	}
+	for (size_t i = 0; i < gray.size(); i++) {
+		gray[i] = uint8_t(i * 11);
+	}
+
+	auto rgba = bgra;
+	ImageDecoder::SwizzleBgra(rgba.data(), rgba.data(), PIXELS);
+	auto scalar = bgra;
+	ImageDecoder::SwizzleBgraScalar(scalar.data(), scalar.data(), PIXELS);
+	EXPECT_EQ(rgba, scalar);
+	std::vector<uint8_t> expanded(PIXELS * 4);
+	ImageDecoder::ExpandGray(gray.data(), expanded.data(), PIXELS);
+	for (size_t i = 0; i < PIXELS; i++) {
+		EXPECT_EQ(rgba[i * 4 + 0], bgra[i * 4 + 2]) << i;
+		EXPECT_EQ(rgba[i * 4 + 1], bgra[i * 4 + 1]) << i;
+		EXPECT_EQ(rgba[i * 4 + 2], bgra[i * 4 + 0]) << i;
+		EXPECT_EQ(rgba[i * 4 + 3], bgra[i * 4 + 3]) << i;
+		for (size_t c = 0; c < 3; c++) {
+			EXPECT_EQ(expanded[i * 4 + c], gray[i]) << i;
+		}
+		EXPECT_EQ(expanded[i * 4 + 3], 255) << i;
+	}
+}
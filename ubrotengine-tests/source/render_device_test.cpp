@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: render_device_test.cpp
+/// The null device and the renderer on top of it, without a window or a GPU.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/null_render_device.h"
+#include "header/renderer.h"
+
+
+namespace
+{
+
+using graphics::NullRenderDevice;
+using graphics::RenderDevice;
+
+void InitializeHeadless(graphics::GraphicSettings& settings, graphics::RenderBackend backend)
+{
+	settings.window_width = 320;
+	settings.window_height = 240;
+	settings.shadow_map_size = 256;
+	settings.render_backend = backend;
+}
+
+} // namespace
+
+
+TEST(NullRenderDevice, ReleasedHandlesAreReused)
+{
+	graphics::GraphicSettings settings;
+	InitializeHeadless(settings, graphics::RenderBackend::Null);
+	NullRenderDevice device;
+	ASSERT_EQ(device.Initialize(nullptr, settings), S_OK);
+	const auto back_buffer = device.GetBackBuffer();
+	ASSERT_NE(back_buffer, RenderDevice::NO_RESOURCE);
+
+	RenderDevice::Handle first{ RenderDevice::NO_RESOURCE };
+	RenderDevice::Handle second{ RenderDevice::NO_RESOURCE };
+	ASSERT_EQ(device.CreateBuffer(graphics::BufferUsage::Vertex, 1024, first), S_OK);
+	ASSERT_EQ(device.CreateBuffer(graphics::BufferUsage::Index, 512, second), S_OK);
+	EXPECT_NE(first, second);
+	EXPECT_EQ(device.GetResourceBytes(first), 1024U);
+	EXPECT_EQ(device.GetStats().resources, 3U);
+
+	device.Release(first);
+	device.Release(first);
+	device.Release(RenderDevice::NO_RESOURCE);
+	EXPECT_EQ(device.GetResourceBytes(first), 0U);
+	EXPECT_EQ(device.GetStats().resources, 2U);
+
+	RenderDevice::Handle third{ RenderDevice::NO_RESOURCE };
+	ASSERT_EQ(device.CreateBuffer(graphics::BufferUsage::Constant, 64, third), S_OK);
+	EXPECT_EQ(third, first);
+	EXPECT_EQ(device.GetStats().created, 4U);
+}
+
+
+TEST(NullRenderDevice, CountsBytesWithoutKeepingThem)
+{
+	graphics::GraphicSettings settings;
+	InitializeHeadless(settings, graphics::RenderBackend::Null);
+	NullRenderDevice device;
+	ASSERT_EQ(device.Initialize(nullptr, settings), S_OK);
+	const auto back_buffer_bytes = device.GetStats().resource_bytes;
+	EXPECT_EQ(back_buffer_bytes, size_t(320) * 240 * 8);
+
+	// 8x8 BC1 with all mips: 4 + 1 + 1 + 1 blocks of 8 bytes
+	graphics::TextureDesc desc;
+	desc.width = 8;
+	desc.height = 8;
+	desc.mip_count = 4;
+	desc.array_size = 1;
+	desc.format = graphics::TextureFormat::BC1_UNORM;
+	const std::vector<graphics::SubresourceData> subresources(4);
+	RenderDevice::Handle texture{ RenderDevice::NO_RESOURCE };
+	ASSERT_EQ(device.CreateTexture(desc, subresources, false, texture), S_OK);
+	EXPECT_EQ(device.GetResourceBytes(texture), 7U * 8U);
+	EXPECT_EQ(device.GetStats().uploaded_bytes, 7U * 8U);
+
+	// Every mip of every slice needs its data
+	desc.array_size = 2;
+	RenderDevice::Handle invalid{ RenderDevice::NO_RESOURCE };
+	EXPECT_EQ(device.CreateTexture(desc, subresources, true, invalid), E_INVALIDARG);
+
+	RenderDevice::Handle buffer{ RenderDevice::NO_RESOURCE };
+	ASSERT_EQ(device.CreateBuffer(graphics::BufferUsage::Vertex, 256, buffer), S_OK);
+	const std::vector<uint8_t> data(64, 0);
+	device.UpdateBuffer(buffer, 16, data.data(), uint32_t(data.size()));
+	device.CopyBuffer(buffer, 128, buffer, 0, 32);
+	EXPECT_EQ(device.GetStats().uploaded_bytes, 7U * 8U + 64U);
+	EXPECT_EQ(device.GetStats().copied_bytes, 32U);
+
+	// The back buffer keeps its handle when the window is resized
+	const auto back_buffer = device.GetBackBuffer();
+	settings.window_width = 640;
+	ASSERT_EQ(device.Refresh(settings), S_OK);
+	EXPECT_EQ(device.GetBackBuffer(), back_buffer);
+	EXPECT_EQ(device.GetResourceBytes(back_buffer), size_t(640) * 240 * 8);
+	EXPECT_EQ(device.GetVideoMemory(), 0U);
+	EXPECT_FALSE(device.UsesBytecode());
+}
+
+
+TEST(Renderer, HeadlessBackendsRenderWithoutWindow)
+{
+	using graphics::RenderBackend;
+	for (const auto backend :
+		{ RenderBackend::Null, RenderBackend::Recording, RenderBackend::Software }) {
+		graphics::GraphicSettings settings;
+		InitializeHeadless(settings, backend);
+		graphics::Renderer renderer;
+		ASSERT_EQ(renderer.Initialize(nullptr, settings), S_OK);
+		EXPECT_EQ(renderer.GetViewCount(), 1U);
+
+		const auto cube = renderer.RegisterModelProcedural(assets::Procedural::Cube);
+		EXPECT_EQ(renderer.GetModelCount(), cube + 1);
+
+		// One cube in front of the camera and one behind it
+		graphics::SceneInput input;
+		input.users.push_back({ { 0.0F, 0.0F, -5.0F }, { 0.0F, 0.0F, 1.0F } });
+		input.tile_objects.push_back(2);
+		input.models = { uint32_t(cube), uint32_t(cube) };
+		input.positions = { { 0.0F, 0.0F, 0.0F }, { 0.0F, 0.0F, -20.0F } };
+		ASSERT_EQ(renderer.Process(input, 1.5), S_OK);
+
+		const auto& stats = renderer.GetFrameStats();
+		EXPECT_EQ(stats.read_ms, 1.5);
+		EXPECT_EQ(stats.gathered_objects, 2U);
+		EXPECT_EQ(stats.visible_objects, 1U);
+		EXPECT_EQ(stats.draw_packets, 1U);
+		EXPECT_FALSE(stats.deferred_contexts);
+
+		const bool recorded = renderer.GetRecordedCommands().GetByteSize() > 0;
+		EXPECT_EQ(recorded, backend == RenderBackend::Recording);
+
+		// Only the software backend draws, every draw of the main view lands in its image
+		io::Image image;
+		const bool software = backend == RenderBackend::Software;
+		EXPECT_EQ(renderer.GetSoftwareFrame(image), software);
+		EXPECT_EQ(stats.software_triangles > 0, software);
+		if (software) {
+			EXPECT_EQ(stats.software_skipped_draws, 0U);
+			EXPECT_EQ(image.width, settings.window_width);
+			EXPECT_EQ(image.height, settings.window_height);
+		}
+		renderer.Shutdown();
+	}
+}
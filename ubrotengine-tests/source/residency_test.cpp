@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: residency_test.cpp
+/// Least recently drawn eviction of the residency manager, and of the asset manager on a
+/// null device that counts what a GPU would have uploaded.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/asset_manager.h"
+#include "header/null_render_device.h"
+#include "header/residency_manager.h"
+
+
+TEST(ResidencyManager, EvictsLeastRecentlyDrawnFirst)
+{
+	assets::ResidencyManager residency;
+	for (size_t i = 0; i < 4; i++) {
+		residency.Add(i, 100);
+	}
+	residency.SetBudget(250);
+
+	// Models loaded in the current frame are protected
+	std::vector<size_t> evicted;
+	residency.SelectEvictions(evicted);
+	EXPECT_TRUE(evicted.empty());
+	EXPECT_EQ(residency.GetStats().resident_bytes, 400U);
+
+	residency.BeginFrame();
+	EXPECT_TRUE(residency.Touch(2));
+	EXPECT_TRUE(residency.Touch(0));
+	residency.BeginFrame();
+	EXPECT_TRUE(residency.Touch(3));
+	residency.SelectEvictions(evicted);
+
+	// 1 was drawn longest ago, 2 was drawn before 0 in the same frame
+	ASSERT_EQ(evicted.size(), 2U);
+	EXPECT_EQ(evicted[0], 1U);
+	EXPECT_EQ(evicted[1], 2U);
+	EXPECT_FALSE(residency.IsResident(1));
+	EXPECT_TRUE(residency.IsResident(3));
+	auto stats = residency.GetStats();
+	EXPECT_EQ(stats.resident_models, 2U);
+	EXPECT_EQ(stats.resident_bytes, 200U);
+	EXPECT_EQ(stats.evicted_models, 2U);
+
+	// An evicted model has to be reloaded before it is drawn
+	residency.BeginFrame();
+	EXPECT_FALSE(residency.Touch(1));
+	residency.Reloaded(1, 100);
+	EXPECT_TRUE(residency.IsResident(1));
+	stats = residency.GetStats();
+	EXPECT_EQ(stats.reloaded_models, 1U);
+	EXPECT_EQ(stats.resident_bytes, 300U);
+}
+
+
+TEST(ResidencyManager, ExceedsBudgetForModelsOfTheCurrentFrame)
+{
+	assets::ResidencyManager residency;
+	residency.SetBudget(150);
+	residency.Add(0, 100);
+	residency.Add(1, 100);
+	residency.BeginFrame();
+	EXPECT_TRUE(residency.Touch(0));
+	EXPECT_TRUE(residency.Touch(1));
+
+	std::vector<size_t> evicted;
+	residency.SelectEvictions(evicted);
+	EXPECT_TRUE(evicted.empty());
+	EXPECT_EQ(residency.GetStats().resident_bytes, 200U);
+}
+
+
+TEST(AssetManager, ReloadsEvictedModelsOnTheDevice)
+{
+	graphics::GraphicSettings settings;
+	graphics::NullRenderDevice device;
+	ASSERT_EQ(device.Initialize(nullptr, settings), S_OK);
+
+	assets::AssetManager asset_manager;
+	const auto sphere = asset_manager.AddModelProcedural(device, assets::Procedural::Sphere);
+	const auto cube = asset_manager.AddModelProcedural(device, assets::Procedural::Cube);
+	ASSERT_NE(sphere, assets::AssetManager::NO_MODEL);
+	ASSERT_NE(cube, assets::AssetManager::NO_MODEL);
+	const auto both_bytes = asset_manager.GetResidencyStats().resident_bytes;
+
+	// Only one of the models fits, whichever was drawn last stays
+	asset_manager.SetModelBudget(both_bytes - 1);
+	asset_manager.BeginFrame();
+	ASSERT_TRUE(asset_manager.UseModel(device, cube));
+	asset_manager.EnforceModelBudget();
+	auto stats = asset_manager.GetResidencyStats();
+	EXPECT_EQ(stats.resident_models, 1U);
+	EXPECT_EQ(stats.evicted_models, 1U);
+	EXPECT_LE(stats.resident_bytes, both_bytes - 1);
+
+	// Drawing the sphere again uploads its geometry again and evicts the cube afterwards
+	const auto uploaded_bytes = device.GetStats().uploaded_bytes;
+	asset_manager.BeginFrame();
+	ASSERT_TRUE(asset_manager.UseModel(device, sphere));
+	EXPECT_GT(device.GetStats().uploaded_bytes, uploaded_bytes);
+	EXPECT_GT(asset_manager.GetModel(sphere).indexCount, 0U);
+	asset_manager.EnforceModelBudget();
+	stats = asset_manager.GetResidencyStats();
+	EXPECT_EQ(stats.resident_models, 1U);
+	EXPECT_EQ(stats.evicted_models, 2U);
+	EXPECT_EQ(stats.reloaded_models, 1U);
+
+	// Resident models are not uploaded again
+	const auto resident_uploaded_bytes = device.GetStats().uploaded_bytes;
+	asset_manager.BeginFrame();
+	ASSERT_TRUE(asset_manager.UseModel(device, sphere));
+	EXPECT_EQ(device.GetStats().uploaded_bytes, resident_uploaded_bytes);
+}
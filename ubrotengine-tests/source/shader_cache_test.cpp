@@ -0,0 +1,328 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shader_cache_test.cpp
+/// Lookup and invalidation of the shader cache with a stand-in compiler, which resolves
+/// includes like D3DCompile and turns the preprocessed text into bytecode.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/shader_cache.h"
+
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+using graphics::ShaderCache;
+using graphics::ShaderCompileDesc;
+using graphics::ShaderCompileOutput;
+
+void WriteText(const fs::path& path, const std::string& text)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << text;
+}
+
+auto ReadText(const fs::path& path) -> std::string
+{
+	std::ifstream file(path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+/**
+ * Replaces every line '#include "name"' with the content of the file, relative to the file
+ * that includes it. Sources containing "error" fail to compile.
+ */
+class StandInCompiler
+{
+
+public:
+	auto operator()(
+		const ShaderCompileDesc& desc, const std::string& source, ShaderCompileOutput& output
+	) -> HRESULT
+	{
+		compiles++;
+		if (source.find("error") != std::string::npos) {
+			output.errors = desc.path.filename().string() + ": error";
+			return E_FAIL;
+		}
+
+		std::string text = desc.entry_point + " " + desc.target + " "
+			+ std::to_string(desc.flags);
+		for (const auto& define : desc.defines) {
+			text += " " + define.name + "=" + define.value;
+		}
+		text += "\n";
+		if (!Preprocess(desc.path.parent_path(), source, text, output.includes)) {
+			return E_FAIL;
+		}
+		output.bytecode.assign(text.begin(), text.end());
+		return S_OK;
+	}
+
+	std::atomic<int> compiles{ 0 };
+
+private:
+	static auto Preprocess(
+		const fs::path& directory, const std::string& source, std::string& text,
+		std::vector<fs::path>& includes
+	) -> bool
+	{
+		const std::string directive = "#include \"";
+		size_t begin = 0;
+		while (begin < source.size()) {
+			auto end = source.find('\n', begin);
+			end = end == std::string::npos ? source.size() : end + 1;
+			const auto line = source.substr(begin, end - begin);
+			begin = end;
+
+			if (line.rfind(directive, 0) != 0) {
+				text += line;
+				continue;
+			}
+			const auto name = line.substr(
+				directive.size(), line.find('"', directive.size()) - directive.size()
+			);
+			const auto path = (directory / name).lexically_normal();
+			if (!fs::exists(path)) {
+				return false;
+			}
+			includes.push_back(path);
+			if (!Preprocess(path.parent_path(), ReadText(path), text, includes)) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+/**
+ * A shader directory with a main file and an include in a subdirectory, and an empty cache
+ * directory next to it.
+ */
+class ShaderCacheTest : public testing::Test
+{
+
+protected:
+	void SetUp() override
+	{
+		const auto* info = testing::UnitTest::GetInstance()->current_test_info();
+		m_root = fs::temp_directory_path() / (std::string("ubrotengine_") + info->name());
+		fs::remove_all(m_root);
+		fs::create_directories(m_root / "shaders" / "common");
+		m_cache_directory = m_root / "cache";
+
+		WriteText(m_root / "shaders" / "common" / "lighting.hlsli", "float3 light;\n");
+		WriteText(
+			m_root / "shaders" / "color.hlsl",
+			"#include \"common/lighting.hlsli\"\nfloat4 main() { return light.xyzz; }\n"
+		);
+		m_desc.path = m_root / "shaders" / "color.hlsl";
+		m_desc.entry_point = "main";
+		m_desc.target = "ps_5_0";
+	}
+
+	void TearDown() override
+	{
+		std::error_code error;
+		fs::remove_all(m_root, error);
+	}
+
+	auto MakeCache() -> std::unique_ptr<ShaderCache>
+	{
+		return std::make_unique<ShaderCache>(
+			m_cache_directory,
+			[this](const auto& desc, const auto& source, auto& output) {
+				return m_compiler(desc, source, output);
+			}
+		);
+	}
+
+	auto Get(ShaderCache& cache, const ShaderCompileDesc& desc) -> std::string
+	{
+		std::vector<uint8_t> bytecode;
+		std::string errors;
+		EXPECT_EQ(cache.Get(desc, bytecode, errors), S_OK) << errors;
+		return { bytecode.begin(), bytecode.end() };
+	}
+
+	fs::path m_root{};
+	fs::path m_cache_directory{};
+	ShaderCompileDesc m_desc{};
+	StandInCompiler m_compiler{};
+};
+
+} // namespace
+
+
+TEST_F(ShaderCacheTest, CompilesOnceAndKeepsTheEntryOnDisk)
+{
+	auto cache = MakeCache();
+	const auto bytecode = Get(*cache, m_desc);
+	EXPECT_NE(bytecode.find("float3 light;"), std::string::npos);
+	EXPECT_EQ(Get(*cache, m_desc), bytecode);
+	EXPECT_EQ(m_compiler.compiles, 1);
+	EXPECT_EQ(cache->GetStats().hits, 1U);
+	EXPECT_EQ(cache->GetStats().misses, 1U);
+
+	// The next start finds the entry of the last one
+	cache = MakeCache();
+	EXPECT_EQ(Get(*cache, m_desc), bytecode);
+	EXPECT_EQ(m_compiler.compiles, 1);
+	EXPECT_EQ(cache->GetStats().hits, 1U);
+
+	cache->Clear();
+	EXPECT_FALSE(fs::exists(m_cache_directory));
+	EXPECT_EQ(Get(*cache, m_desc), bytecode);
+	EXPECT_EQ(m_compiler.compiles, 2);
+}
+
+
+TEST_F(ShaderCacheTest, EveryPartOfTheDescriptionIsPartOfTheKey)
+{
+	auto cache = MakeCache();
+	std::vector<ShaderCompileDesc> descs(6, m_desc);
+	descs[1].entry_point = "other";
+	descs[2].target = "ps_4_0";
+	descs[3].flags = 1;
+	descs[4].defines = { { "SHADOWS", "1" } };
+	descs[5].defines = { { "SHADOWS", "2" } };
+	for (const auto& desc : descs) {
+		Get(*cache, desc);
+	}
+	EXPECT_EQ(m_compiler.compiles, 6);
+	for (const auto& desc : descs) {
+		Get(*cache, desc);
+	}
+	EXPECT_EQ(m_compiler.compiles, 6);
+
+	// Another name for the same file is the same entry
+	auto desc = m_desc;
+	desc.path = m_root / "shaders" / "common" / ".." / "color.hlsl";
+	Get(*cache, desc);
+	EXPECT_EQ(m_compiler.compiles, 6);
+
+	// A change of the source is a new key, the old entry is not outdated
+	WriteText(m_desc.path, "float4 main() { return 1; }\n");
+	EXPECT_EQ(Get(*cache, m_desc).find("light"), std::string::npos);
+	EXPECT_EQ(m_compiler.compiles, 7);
+	EXPECT_EQ(cache->GetStats().invalidated, 0U);
+}
+
+
+TEST_F(ShaderCacheTest, ChangedIncludesInvalidateTheEntry)
+{
+	auto cache = MakeCache();
+	Get(*cache, m_desc);
+
+	const auto include = m_root / "shaders" / "common" / "lighting.hlsli";
+	WriteText(include, "float3 light2;\n");
+	EXPECT_NE(Get(*cache, m_desc).find("float3 light2;"), std::string::npos);
+	EXPECT_EQ(m_compiler.compiles, 2);
+	EXPECT_EQ(cache->GetStats().invalidated, 1U);
+	// The new entry replaced the old one
+	Get(*cache, m_desc);
+	EXPECT_EQ(m_compiler.compiles, 2);
+
+	// A removed include can not be checked, the compile reports it
+	fs::remove(include);
+	std::vector<uint8_t> bytecode;
+	std::string errors;
+	EXPECT_EQ(cache->Get(m_desc, bytecode, errors), E_FAIL);
+	EXPECT_EQ(m_compiler.compiles, 3);
+	EXPECT_EQ(cache->GetStats().invalidated, 2U);
+}
+
+
+TEST_F(ShaderCacheTest, DamagedEntriesAreCompiledAgain)
+{
+	auto cache = MakeCache();
+	const auto bytecode = Get(*cache, m_desc);
+	ASSERT_EQ(std::distance(fs::directory_iterator(m_cache_directory), {}), 1);
+	const auto entry = fs::directory_iterator(m_cache_directory)->path();
+	EXPECT_EQ(entry.extension(), ".cso");
+
+	for (const auto size : { fs::file_size(entry) - 1, uintmax_t(3) }) {
+		fs::resize_file(entry, size);
+		EXPECT_EQ(Get(*cache, m_desc), bytecode);
+	}
+	EXPECT_EQ(m_compiler.compiles, 3);
+	EXPECT_EQ(cache->GetStats().invalidated, 2U);
+	Get(*cache, m_desc);
+	EXPECT_EQ(m_compiler.compiles, 3);
+}
+
+
+TEST_F(ShaderCacheTest, FailedCompilesAreNotCached)
+{
+	auto cache = MakeCache();
+	WriteText(m_desc.path, "error\n");
+	std::vector<uint8_t> bytecode;
+	std::string errors;
+	for (int i = 0; i < 2; i++) {
+		EXPECT_EQ(cache->Get(m_desc, bytecode, errors), E_FAIL);
+		EXPECT_EQ(errors, "color.hlsl: error");
+	}
+	EXPECT_EQ(m_compiler.compiles, 2);
+	EXPECT_EQ(cache->GetStats().failed, 2U);
+	EXPECT_FALSE(fs::exists(m_cache_directory));
+
+	// A missing file never reaches the compiler
+	auto missing = m_desc;
+	missing.path = m_root / "shaders" / "missing.hlsl";
+	EXPECT_EQ(cache->Get(missing, bytecode, errors), E_FAIL);
+	EXPECT_TRUE(errors.empty());
+	EXPECT_EQ(m_compiler.compiles, 2);
+	EXPECT_EQ(cache->GetStats().failed, 3U);
+}
+
+
+TEST_F(ShaderCacheTest, ConcurrentLookupsAgree)
+{
+	auto cache = MakeCache();
+	const auto expected = Get(*MakeCache(), m_desc);
+	fs::remove_all(m_cache_directory);
+
+	// Threads that miss at the same time all compile, each stores its own entry
+	std::vector<std::thread> threads;
+	std::vector<std::string> results(8);
+	for (size_t i = 0; i < results.size(); i++) {
+		threads.emplace_back([&, i]() {
+			for (int repeat = 0; repeat < 20; repeat++) {
+				std::vector<uint8_t> bytecode;
+				std::string errors;
+				if (cache->Get(m_desc, bytecode, errors) == S_OK) {
+					results[i].assign(bytecode.begin(), bytecode.end());
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (const auto& result : results) {
+		EXPECT_EQ(result, expected);
+	}
+	const auto stats = cache->GetStats();
+	EXPECT_EQ(stats.hits + stats.misses, results.size() * 20);
+	EXPECT_GT(stats.hits, 0U);
+	EXPECT_EQ(stats.failed, 0U);
+	// Only the finished entry remains, no temporary files
+	EXPECT_EQ(std::distance(fs::directory_iterator(m_cache_directory), {}), 1);
+}
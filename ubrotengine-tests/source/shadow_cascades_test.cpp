@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shadow_cascades_test.cpp
+/// Split distances, placement, caster culling and caching of the shadow cascades.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/shadow_cascades.h"
+
+
+namespace
+{
+
+using graphics::Camera;
+using graphics::ShadowCascades;
+
+constexpr float NEAR_Z = 0.1F;
+constexpr float FAR_Z = 1000.0F;
+constexpr uint32_t RESOLUTION = 1024;
+
+void PlaceCamera(Camera& camera, const math::Float3& position, const math::Float3& direction)
+{
+	camera.SetView(position, direction);
+	camera.SetProjection(math::PerspectiveFovLH(1.0F, 16.0F / 9.0F, NEAR_Z, FAR_Z));
+	camera.Update();
+}
+
+/**
+ * Returns the corners of the part of the view frustum between two view depths.
+ */
+auto GetSliceCorners(const Camera& camera, float near_z, float far_z)
+	-> std::vector<math::Float3>
+{
+	std::vector<math::Float3> corners;
+	const auto inverse = camera.GetInverseViewProjectionMatrix();
+	for (const float x : { -1.0F, 1.0F }) {
+		for (const float y : { -1.0F, 1.0F }) {
+			const auto near_corner = math::TransformCoord({ x, y, 0.0F }, inverse);
+			const auto far_corner = math::TransformCoord({ x, y, 1.0F }, inverse);
+			for (const float depth : { near_z, far_z }) {
+				const float t = (depth - NEAR_Z) / (FAR_Z - NEAR_Z);
+				corners.push_back(near_corner + (far_corner - near_corner) * t);
+			}
+		}
+	}
+	return corners;
+}
+
+/**
+ * Returns the width of the area an orthographic cascade camera covers.
+ */
+auto GetWidth(const Camera& camera) -> float
+{
+	return 2.0F / camera.GetProjectionMatrix().m[0][0];
+}
+
+} // namespace
+
+
+TEST(ShadowCascades, SplitsBlendUniformAndLogarithmic)
+{
+	const auto uniform = ShadowCascades::ComputeSplits(1.0F, 81.0F, 0.0F);
+	const auto logarithmic = ShadowCascades::ComputeSplits(1.0F, 81.0F, 1.0F);
+	const auto blended = ShadowCascades::ComputeSplits(1.0F, 81.0F, 0.5F);
+	const float expected_uniform[] = { 21.0F, 41.0F, 61.0F, 81.0F };
+	const float expected_logarithmic[] = { 3.0F, 9.0F, 27.0F, 81.0F };
+	for (size_t i = 0; i < ShadowCascades::CASCADE_COUNT; i++) {
+		EXPECT_FLOAT_EQ(uniform[i], expected_uniform[i]) << i;
+		EXPECT_FLOAT_EQ(logarithmic[i], expected_logarithmic[i]) << i;
+		EXPECT_FLOAT_EQ(blended[i], (expected_uniform[i] + expected_logarithmic[i]) / 2) << i;
+	}
+
+	// Near cascades cover shorter slices than far ones
+	const auto splits = ShadowCascades::ComputeSplits(NEAR_Z, 100.0F, ShadowCascades::SPLIT_LAMBDA);
+	float last_near = NEAR_Z;
+	float last_length = 0.0F;
+	for (const auto split : splits) {
+		EXPECT_GT(split - last_near, last_length);
+		last_length = split - last_near;
+		last_near = split;
+	}
+	EXPECT_EQ(splits.back(), 100.0F);
+}
+
+
+TEST(ShadowCascades, CascadesCoverTheirSlices)
+{
+	ShadowCascades cascades;
+	cascades.SetShadowMap(RESOLUTION, 100.0F, 50.0F);
+	cascades.SetLightDirection({ 1.0F, -2.0F, 0.5F });
+	Camera camera;
+	PlaceCamera(camera, { 3.0F, 2.0F, -7.0F }, { 0.3F, -0.1F, 1.0F });
+	cascades.Update(camera, NEAR_Z, FAR_Z);
+
+	// The shadows end at the shadow distance, not at the far plane
+	const auto splits = ShadowCascades::ComputeSplits(NEAR_Z, 100.0F, ShadowCascades::SPLIT_LAMBDA);
+	float slice_near = NEAR_Z;
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		EXPECT_FLOAT_EQ(cascades.GetSplit(c), splits[c]);
+		const auto& cascade_camera = cascades.GetCamera(c);
+		for (const auto& corner : GetSliceCorners(camera, slice_near, splits[c])) {
+			EXPECT_TRUE(cascade_camera.IsSphereVisible(corner, 0.0F)) << "cascade " << c;
+		}
+		slice_near = splits[c];
+	}
+
+	// Cached cascades have a margin around their slice
+	EXPECT_LT(GetWidth(cascades.GetCamera(0)), GetWidth(cascades.GetCamera(1)));
+	EXPECT_LT(GetWidth(cascades.GetCamera(1)), GetWidth(cascades.GetCamera(2)));
+}
+
+
+TEST(ShadowCascades, MovesInWholeTexelsAndKeepsItsSize)
+{
+	const math::Float3 light(1.0F, -2.0F, 0.5F);
+	ShadowCascades cascades;
+	cascades.SetShadowMap(RESOLUTION, 100.0F, 50.0F);
+	cascades.SetLightDirection(light);
+	Camera camera;
+	PlaceCamera(camera, { 0.0F, 2.0F, 0.0F }, { 0.0F, 0.0F, 1.0F });
+	cascades.Update(camera, NEAR_Z, FAR_Z);
+	const auto width = GetWidth(cascades.GetCamera(0));
+	const auto position = cascades.GetCamera(0).GetPosition();
+
+	// Turning the camera in place does not change the size of a cascade
+	for (const float angle : { 0.1F, 0.7F, 2.0F, 4.0F }) {
+		PlaceCamera(camera, { 0.0F, 2.0F, 0.0F }, { std::sin(angle), 0.0F, std::cos(angle) });
+		cascades.Update(camera, NEAR_Z, FAR_Z);
+		EXPECT_EQ(GetWidth(cascades.GetCamera(0)), width) << angle;
+	}
+
+	// Moving the camera moves the cascade by whole texels across the light direction
+	PlaceCamera(camera, { 0.37F, 2.0F, 0.11F }, { 0.0F, 0.0F, 1.0F });
+	cascades.Update(camera, NEAR_Z, FAR_Z);
+	ASSERT_EQ(GetWidth(cascades.GetCamera(0)), width);
+	const auto rotation = Camera::ComputeViewMatrix({ 0.0F, 0.0F, 0.0F }, light);
+	const auto offset = math::TransformCoord(
+		cascades.GetCamera(0).GetPosition() - position, rotation
+	);
+	const float texel = width / float(RESOLUTION);
+	for (const float texels : { offset.x / texel, offset.y / texel }) {
+		EXPECT_NE(texels, 0.0F);
+		EXPECT_NEAR(texels, std::round(texels), 0.01F);
+	}
+}
+
+
+TEST(ShadowCascades, CullsCastersTowardsTheLight)
+{
+	ShadowCascades cascades;
+	cascades.SetShadowMap(RESOLUTION, 100.0F, 30.0F);
+	cascades.SetLightDirection({ 0.0F, -1.0F, 0.0F });
+	Camera camera;
+	PlaceCamera(camera, { 0.0F, 0.0F, 0.0F }, { 0.0F, 0.0F, 1.0F });
+	cascades.Update(camera, NEAR_Z, FAR_Z);
+	ASSERT_GT(cascades.GetSplit(0), 2.0F);
+
+	graphics::ViewCuller culler;
+	// In the first slice, above it within the caster range, below it, above it beyond the
+	// caster range, and beyond the shadow distance
+	const auto inside = culler.AddSphere({ 0.0F, 0.0F, 1.0F }, 0.2F);
+	const auto above = culler.AddSphere({ 0.0F, 25.0F, 1.0F }, 0.2F);
+	const auto below = culler.AddSphere({ 0.0F, -25.0F, 1.0F }, 0.2F);
+	const auto far_above = culler.AddSphere({ 0.0F, 90.0F, 1.0F }, 0.2F);
+	const auto beyond = culler.AddSphere({ 0.0F, 0.0F, 300.0F }, 0.2F);
+	const std::vector<uint32_t> keys(culler.GetSphereCount(), 0);
+	utils::ThreadPool pool(2);
+	cascades.Cull(culler, keys, pool);
+
+	const auto& casters = cascades.GetCasters(0);
+	const auto contains = [&](uint32_t idx) {
+		return std::find(casters.begin(), casters.end(), idx) != casters.end();
+	};
+	EXPECT_TRUE(contains(inside));
+	EXPECT_TRUE(contains(above));
+	EXPECT_FALSE(contains(below));
+	EXPECT_FALSE(contains(far_above));
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		const auto& cascade_casters = cascades.GetCasters(c);
+		EXPECT_EQ(std::count(cascade_casters.begin(), cascade_casters.end(), beyond), 0) << c;
+		EXPECT_EQ(cascades.GetStats().casters[c], cascade_casters.size());
+	}
+}
+
+
+TEST(ShadowCascades, CachedCascadesRenderOnlyAfterChanges)
+{
+	constexpr size_t CACHED = ShadowCascades::CASCADE_COUNT - ShadowCascades::FIRST_CACHED_CASCADE;
+	ShadowCascades cascades;
+	cascades.SetShadowMap(RESOLUTION, 100.0F, 30.0F);
+	cascades.SetLightDirection({ 0.5F, -1.0F, 0.2F });
+	Camera camera;
+	PlaceCamera(camera, { 0.0F, 0.0F, 0.0F }, { 0.0F, 0.0F, 1.0F });
+
+	// One caster in the middle of every slice
+	graphics::ViewCuller culler;
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		cascades.Update(camera, NEAR_Z, FAR_Z);
+		const float previous = c > 0 ? cascades.GetSplit(c - 1) : NEAR_Z;
+		culler.AddSphere({ 0.0F, 0.0F, (previous + cascades.GetSplit(c)) / 2 }, 0.5F);
+	}
+	std::vector<uint32_t> keys(culler.GetSphereCount(), 7);
+	utils::ThreadPool pool(2);
+
+	const auto frame = [&]() {
+		cascades.Update(camera, NEAR_Z, FAR_Z);
+		cascades.Cull(culler, keys, pool);
+		return cascades.GetStats().rendered_cascades;
+	};
+	EXPECT_EQ(frame(), ShadowCascades::CASCADE_COUNT);
+	EXPECT_EQ(cascades.GetStats().cache_misses, CACHED);
+
+	// A small step stays inside the margin, only the near cascades are rendered
+	PlaceCamera(camera, { 0.2F, 0.0F, 0.1F }, { 0.0F, 0.0F, 1.0F });
+	EXPECT_EQ(frame(), ShadowCascades::FIRST_CACHED_CASCADE);
+	for (size_t c = 0; c < ShadowCascades::CASCADE_COUNT; c++) {
+		EXPECT_EQ(cascades.NeedsRender(c), c < ShadowCascades::FIRST_CACHED_CASCADE) << c;
+	}
+	EXPECT_EQ(cascades.GetStats().cache_hits, CACHED);
+
+	// Another model for the last caster changes the content of the cascades it is in
+	const auto changed = uint32_t(keys.size() - 1);
+	keys.back() = 8;
+	EXPECT_GT(frame(), ShadowCascades::FIRST_CACHED_CASCADE);
+	size_t changed_cascades{ 0 };
+	for (size_t c = ShadowCascades::FIRST_CACHED_CASCADE; c < ShadowCascades::CASCADE_COUNT; c++) {
+		const auto& casters = cascades.GetCasters(c);
+		const bool contains = std::count(casters.begin(), casters.end(), changed) > 0;
+		EXPECT_EQ(cascades.NeedsRender(c), contains) << c;
+		changed_cascades += contains ? 1 : 0;
+	}
+	EXPECT_TRUE(cascades.NeedsRender(ShadowCascades::CASCADE_COUNT - 1));
+	EXPECT_EQ(
+		cascades.GetStats().rendered_cascades,
+		ShadowCascades::FIRST_CACHED_CASCADE + changed_cascades
+	);
+	EXPECT_EQ(frame(), ShadowCascades::FIRST_CACHED_CASCADE);
+
+	// A turned light and a large step invalidate every cascade
+	cascades.SetLightDirection({ 0.4F, -1.0F, 0.2F });
+	EXPECT_EQ(frame(), ShadowCascades::CASCADE_COUNT);
+	PlaceCamera(camera, { 0.0F, 0.0F, 200.0F }, { 0.0F, 0.0F, 1.0F });
+	EXPECT_EQ(frame(), ShadowCascades::CASCADE_COUNT);
+	EXPECT_EQ(cascades.GetStats().rendered_cascades, ShadowCascades::CASCADE_COUNT);
+	EXPECT_EQ(cascades.GetStats().cache_misses, 3 * CACHED + changed_cascades);
+}
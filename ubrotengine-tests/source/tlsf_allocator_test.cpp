@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: tlsf_allocator_test.cpp
+/// Allocation, merging and defragmentation planning of the TLSF allocator, checked against a
+/// simulated memory block that every allocation fills with its own handle.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/geometry_buffer.h"
+#include "header/null_render_device.h"
+#include "header/tlsf_allocator.h"
+
+
+namespace
+{
+
+using utils::TlsfAllocator;
+
+/**
+ * The managed block, every element holds the handle of its allocation plus one, free
+ * elements are zero.
+ */
+class SimulatedMemory
+{
+
+public:
+	explicit SimulatedMemory(TlsfAllocator& allocator) :
+		m_allocator(allocator),
+		m_memory(allocator.GetCapacity(), 0)
+	{
+	}
+
+	auto Allocate(uint32_t size) -> TlsfAllocator::Handle
+	{
+		const auto handle = m_allocator.Allocate(size, size);
+		if (handle != TlsfAllocator::INVALID_HANDLE) {
+			Fill(handle, handle + 1);
+			m_live.push_back(handle);
+		}
+		return handle;
+	}
+
+	void Free(size_t live_idx)
+	{
+		const auto handle = m_live[live_idx];
+		Fill(handle, 0);
+		m_allocator.Free(handle);
+		m_live.erase(m_live.begin() + std::ptrdiff_t(live_idx));
+	}
+
+	/**
+	 * Copies the memory like a GPU copy would, sources and destinations must not overlap.
+	 */
+	void Apply(const std::vector<TlsfAllocator::Move>& moves)
+	{
+		for (const auto& move : moves) {
+			const auto src = m_memory.begin() + move.src_offset;
+			const auto dst = m_memory.begin() + move.dst_offset;
+			ASSERT_TRUE(
+				move.src_offset + move.size <= move.dst_offset
+				|| move.dst_offset + move.size <= move.src_offset
+			);
+			std::copy(src, src + move.size, dst);
+			std::fill(src, src + move.size, 0U);
+		}
+	}
+
+	/**
+	 * Every allocation is where the allocator says, with its size and its content.
+	 */
+	void Verify() const
+	{
+		uint32_t used{ 0 };
+		for (const auto handle : m_live) {
+			const auto offset = m_allocator.GetOffset(handle);
+			const auto size = m_allocator.GetSize(handle);
+			ASSERT_EQ(size, m_allocator.GetUserData(handle));
+			ASSERT_LE(offset + size, m_memory.size());
+			for (uint32_t i = offset; i < offset + size; i++) {
+				ASSERT_EQ(m_memory[i], handle + 1) << "handle " << handle << " at " << i;
+			}
+			used += size;
+		}
+		const auto stats = m_allocator.GetStats();
+		EXPECT_EQ(stats.used, used);
+		EXPECT_EQ(stats.allocations, m_live.size());
+		EXPECT_LE(stats.largest_free_block, stats.capacity - stats.used);
+	}
+
+	[[nodiscard]] auto GetLiveCount() const -> size_t
+	{
+		return m_live.size();
+	}
+
+private:
+	void Fill(TlsfAllocator::Handle handle, uint32_t value)
+	{
+		const auto offset = m_allocator.GetOffset(handle);
+		std::fill_n(m_memory.begin() + offset, m_allocator.GetSize(handle), value);
+	}
+
+	TlsfAllocator& m_allocator;
+	std::vector<uint32_t> m_memory;
+	std::vector<TlsfAllocator::Handle> m_live{};
+};
+
+} // namespace
+
+
+TEST(TlsfAllocator, FreedNeighboursMerge)
+{
+	TlsfAllocator allocator(1000);
+	std::vector<TlsfAllocator::Handle> handles;
+	for (uint32_t i = 0; i < 10; i++) {
+		handles.push_back(allocator.Allocate(100));
+		ASSERT_NE(handles.back(), TlsfAllocator::INVALID_HANDLE);
+	}
+	EXPECT_EQ(allocator.Allocate(1), TlsfAllocator::INVALID_HANDLE);
+	EXPECT_EQ(allocator.Allocate(0), TlsfAllocator::INVALID_HANDLE);
+	EXPECT_EQ(allocator.GetStats().free_blocks, 0U);
+
+	// Every second block, nothing can merge
+	for (size_t i = 0; i < handles.size(); i += 2) {
+		allocator.Free(handles[i]);
+	}
+	auto stats = allocator.GetStats();
+	EXPECT_EQ(stats.free_blocks, 5U);
+	EXPECT_EQ(stats.largest_free_block, 100U);
+	EXPECT_GT(stats.GetFragmentation(), 0.5F);
+	EXPECT_EQ(allocator.Allocate(101), TlsfAllocator::INVALID_HANDLE);
+
+	// The rest merges everything back into one block
+	for (size_t i = 1; i < handles.size(); i += 2) {
+		allocator.Free(handles[i]);
+	}
+	stats = allocator.GetStats();
+	EXPECT_EQ(stats.free_blocks, 1U);
+	EXPECT_EQ(stats.largest_free_block, 1000U);
+	EXPECT_EQ(stats.GetFragmentation(), 0.0F);
+	// Requests are rounded up to the next size class, so 992 is the largest that fits
+	EXPECT_EQ(allocator.Allocate(993), TlsfAllocator::INVALID_HANDLE);
+	EXPECT_NE(allocator.Allocate(992), TlsfAllocator::INVALID_HANDLE);
+}
+
+
+TEST(TlsfAllocator, GrowKeepsAllocations)
+{
+	TlsfAllocator allocator(64);
+	const auto first = allocator.Allocate(64, 7);
+	ASSERT_NE(first, TlsfAllocator::INVALID_HANDLE);
+	EXPECT_EQ(allocator.Allocate(32), TlsfAllocator::INVALID_HANDLE);
+
+	allocator.Grow(256);
+	EXPECT_EQ(allocator.GetCapacity(), 256U);
+	EXPECT_EQ(allocator.GetOffset(first), 0U);
+	EXPECT_EQ(allocator.GetUserData(first), 7U);
+	const auto second = allocator.Allocate(192);
+	ASSERT_NE(second, TlsfAllocator::INVALID_HANDLE);
+	EXPECT_EQ(allocator.GetOffset(second), 64U);
+}
+
+
+TEST(TlsfAllocator, RandomAllocationsNeverOverlap)
+{
+	TlsfAllocator allocator(1 << 16);
+	SimulatedMemory memory(allocator);
+	std::mt19937 random(29);
+	std::uniform_int_distribution<uint32_t> sizes(1, 700);
+
+	for (int i = 0; i < 5000; i++) {
+		if (memory.GetLiveCount() > 0 && random() % 3 == 0) {
+			memory.Free(random() % memory.GetLiveCount());
+		}
+		else {
+			memory.Allocate(sizes(random));
+		}
+	}
+	memory.Verify();
+}
+
+
+TEST(TlsfAllocator, DefragPlanCompactsAndKeepsContent)
+{
+	TlsfAllocator allocator(1 << 14);
+	SimulatedMemory memory(allocator);
+	std::mt19937 random(31);
+	std::uniform_int_distribution<uint32_t> sizes(1, 200);
+	while (memory.Allocate(sizes(random)) != TlsfAllocator::INVALID_HANDLE) {
+	}
+	// Freeing shifts the later allocations down, so every second one is freed
+	for (size_t i = 0; i < memory.GetLiveCount(); i++) {
+		memory.Free(i);
+	}
+	const auto fragmented = allocator.GetStats();
+	ASSERT_GT(fragmented.GetFragmentation(), 0.5F);
+
+	// Small budgets move the allocations over several frames
+	constexpr uint32_t BUDGET = 1024;
+	std::vector<TlsfAllocator::Move> moves;
+	for (int frame = 0; frame < 1000; frame++) {
+		const auto moved = allocator.PlanDefrag(BUDGET, moves);
+		EXPECT_LE(moved, BUDGET);
+
+		uint32_t sum{ 0 };
+		std::vector<TlsfAllocator::Handle> moved_handles;
+		for (const auto& move : moves) {
+			EXPECT_LT(move.dst_offset, move.src_offset);
+			EXPECT_EQ(move.size, move.user_data);
+			EXPECT_EQ(allocator.GetOffset(move.handle), move.dst_offset);
+			moved_handles.push_back(move.handle);
+			sum += move.size;
+		}
+		EXPECT_EQ(sum, moved);
+		std::sort(moved_handles.begin(), moved_handles.end());
+		EXPECT_EQ(
+			std::adjacent_find(moved_handles.begin(), moved_handles.end()), moved_handles.end()
+		);
+
+		memory.Apply(moves);
+		memory.Verify();
+		if (moved == 0) {
+			break;
+		}
+	}
+
+	// Only holes that are too small for the allocations above them remain, most of the free
+	// space is at the end
+	const auto stats = allocator.GetStats();
+	EXPECT_LT(stats.GetFragmentation(), 0.1F);
+	EXPECT_LT(stats.free_blocks, fragmented.free_blocks / 2);
+	EXPECT_GT(stats.largest_free_block, 4 * fragmented.largest_free_block);
+}
+
+
+TEST(GeometryBuffer, DefragmentCopiesTheMovedRanges)
+{
+	graphics::GraphicSettings settings;
+	graphics::NullRenderDevice device;
+	ASSERT_EQ(device.Initialize(nullptr, settings), S_OK);
+	graphics::GeometryBuffer buffer(graphics::BufferUsage::Index, sizeof(uint32_t));
+	buffer.KeepCpuCopy();
+
+	// Range i holds i + 1 elements of value i
+	std::vector<graphics::GeometryBuffer::Handle> handles;
+	for (uint32_t i = 0; i < 64; i++) {
+		const std::vector<uint32_t> data(i + 1, i);
+		handles.emplace_back();
+		ASSERT_EQ(buffer.Allocate(device, data.data(), i + 1, i, handles.back()), S_OK);
+	}
+	// The first half leaves one hole at the start that the last ranges fit into
+	for (size_t i = 0; i < handles.size() / 2; i++) {
+		buffer.Free(handles[i]);
+	}
+	const auto copied_bytes = device.GetStats().copied_bytes;
+
+	std::vector<utils::TlsfAllocator::Move> moves;
+	buffer.Defragment(device, 256, moves);
+	ASSERT_FALSE(moves.empty());
+	size_t moved{ 0 };
+	for (const auto& move : moves) {
+		moved += move.size;
+	}
+	EXPECT_LE(moved, 256U);
+	EXPECT_EQ(device.GetStats().copied_bytes - copied_bytes, moved * sizeof(uint32_t));
+
+	const auto* data = reinterpret_cast<const uint32_t*>(buffer.GetCpuCopy());
+	for (uint32_t i = uint32_t(handles.size() / 2); i < handles.size(); i++) {
+		const auto offset = buffer.GetOffset(handles[i]);
+		for (uint32_t e = 0; e <= i; e++) {
+			ASSERT_EQ(data[offset + e], i) << "range " << i;
+		}
+	}
+	buffer.Release(device);
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: cook_command.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/bc_encoder.h"
+#include "header/image_decoder.h"
+#include "header/thread_pool.h"
+
+
+namespace tools
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: CookCommand
+/// Converts a PNG or TGA texture into a block-compressed DDS file with a full mip chain,
+/// which the engine loads without any further processing.
+///
+/// Usage: cook <input> <output.dds> [--format bc1|bc3|bc5|bc7] [--quality fast|high]
+///             [--linear] [--no-mips] [--threads <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CookCommand
+{
+
+public:
+	CookCommand() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string input;
+		std::string output;
+		io::BcFormat format{ io::BcFormat::BC7 };
+		io::BcQuality quality{ io::BcQuality::High };
+		// Treat the color channels as linear data, BC5 is always linear
+		bool linear{ false };
+		bool mips{ true };
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	static auto LoadImage(
+		const std::string& filename, io::Image& image, utils::ThreadPool* thread_pool
+	) -> bool;
+};
+
+} // namespace tools
@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: pack_command.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/asset_archive.h"
+
+
+namespace tools
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: PackCommand
+/// Packs files and directories into an archive which the engine mounts instead of opening
+/// every asset on its own. The files are stored with their path relative to the base
+/// directory, which has to be the directory the engine resolves its asset paths against.
+///
+/// Usage: pack <output> <input>... [--base <directory>] [--threads <count>]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PackCommand
+{
+
+public:
+	PackCommand() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string output;
+		std::vector<std::string> inputs;
+		// Directory the stored paths are relative to, the working directory if empty
+		std::string base;
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	/**
+	 * Collects all files of the inputs, directories are searched recursively.
+	 * @return false if an input does not exist
+	 */
+	static auto CollectFiles(const Options& options, std::vector<std::string>& files) -> bool;
+};
+
+} // namespace tools
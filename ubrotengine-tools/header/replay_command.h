@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: replay_command.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/frame_capture.h"
+#include "header/ubrotengine_dx11.h"
+
+
+namespace tools
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ReplayCommand
+/// Renders the frames of a capture written by \c Engine::BeginCapture again, as fast as
+/// possible and without the game. The setup records are repeated through the engine, so the
+/// assets get the same indices, and the renderer is deterministic, so every replay of a
+/// capture draws the same commands. The CPU stage timings of every frame are printed as CSV.
+///
+/// Asset paths are resolved like in the game, so the tool has to run in the same working
+/// directory. Replays always run in a window, the backend of the capture can be replaced by
+/// a headless one.
+///
+/// Usage: replay <capture> [--backend d3d11|null|recording|software] [--loops <count>]
+///               [--summary]
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ReplayCommand
+{
+
+public:
+	ReplayCommand() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string capture;
+		// Overrides the backend of the captured settings if set
+		bool override_backend{ false };
+		graphics::RenderBackend backend{ graphics::RenderBackend::D3D11 };
+		// The frames are rendered this many times, the setup only once
+		size_t loops{ 1 };
+		// Only print the totals
+		bool summary{ false };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	/**
+	 * Repeats a setup record, the first settings initialize the renderer.
+	 * @return false if the renderer could not be initialized
+	 */
+	static auto ApplySetup(
+		const graphics::CaptureEntry& entry, const Options& options, graphics::Engine& engine,
+		HWND& window
+	) -> bool;
+};
+
+} // namespace tools
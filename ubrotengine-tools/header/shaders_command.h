@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shaders_command.h
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/embedded_shaders.h"
+
+
+namespace tools
+{
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Class name: ShadersCommand
+/// Compiles every variant of the programs in \c graphics::SHADER_MANIFEST and writes their
+/// bytecode into a header, which release builds of the engine include to create the programs
+/// without compiling. Stages that several variants or programs share are written once.
+///
+/// Usage: shaders <output header> <shader directory> [--threads <count>]
+///
+/// The engine looks for the header at header/embedded_shader_data.h. The release build of the
+/// engine project writes it in a pre-build step, which runs from the engine directory:
+///     ubrotengine-tools shaders header/embedded_shader_data.h shader
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class ShadersCommand
+{
+
+public:
+	ShadersCommand() = delete;
+
+	/**
+	 * @param args the arguments after the command name
+	 * @return the exit code of the process
+	 */
+	static auto Run(const std::vector<std::string>& args) -> int;
+
+	static void PrintUsage();
+
+private:
+	struct Options
+	{
+		std::string output;
+		std::string shader_directory;
+		// 0 uses all hardware threads
+		size_t threads{ 0 };
+	};
+
+	static auto ParseOptions(const std::vector<std::string>& args, Options& options) -> bool;
+
+	/**
+	 * Returns the compile descriptions of all stages of all variants, without duplicates.
+	 */
+	static auto CollectShaders(const Options& options) -> std::vector<graphics::ShaderCompileDesc>;
+
+	static auto WriteHeader(
+		const std::string& output, const std::vector<graphics::ShaderCompileDesc>& descs,
+		const std::vector<std::vector<uint8_t>>& bytecodes
+	) -> bool;
+};
+
+} // namespace tools
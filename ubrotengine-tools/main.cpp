@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: main.cpp
+/// Command line tools that prepare assets for the engine and replay frame captures.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/cook_command.h"
+#include "header/pack_command.h"
+#include "header/replay_command.h"
+#include "header/shaders_command.h"
+
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::printf("ubrotengine-tools <command> [arguments]\n\ncommands:\n");
+	tools::CookCommand::PrintUsage();
+	tools::PackCommand::PrintUsage();
+	tools::ReplayCommand::PrintUsage();
+	tools::ShadersCommand::PrintUsage();
+}
+
+} // namespace
+
+
+auto main(int argc, char** argv) -> int
+{
+	if (argc < 2) {
+		PrintUsage();
+		return 1;
+	}
+
+	const std::string command = argv[1];
+	const std::vector<std::string> args(argv + 2, argv + argc);
+
+	if (command == "cook") {
+		return tools::CookCommand::Run(args);
+	}
+	if (command == "pack") {
+		return tools::PackCommand::Run(args);
+	}
+	if (command == "replay") {
+		return tools::ReplayCommand::Run(args);
+	}
+	if (command == "shaders") {
+		return tools::ShadersCommand::Run(args);
+	}
+
+	PrintUsage();
+	return 1;
+}
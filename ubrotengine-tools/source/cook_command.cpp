@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: cook_command.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/cook_command.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/dds_loader.h"
+#include "header/mapped_file.h"
+#include "header/mip_generator.h"
+
+
+namespace tools
+{
+
+namespace
+{
+
+constexpr std::array<const char*, size_t(io::BcFormat::NUMBER)> FORMAT_NAMES = {
+	"bc1", "bc3", "bc5", "bc7"
+};
+
+auto ToLower(std::string text) -> std::string
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](char c) {
+		return char(std::tolower(static_cast<unsigned char>(c)));
+	});
+	return text;
+}
+
+} // namespace
+
+
+auto CookCommand::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	utils::ThreadPool thread_pool(options.threads > 0 ? options.threads - 1 : 0);
+
+	io::Image image;
+	if (!LoadImage(options.input, image, &thread_pool)) {
+		std::fprintf(stderr, "Could not load %s\n", options.input.c_str());
+		return 1;
+	}
+	image.srgb = image.srgb && !options.linear && options.format != io::BcFormat::BC5;
+
+	std::vector<io::Image> mips;
+	if (options.mips) {
+		io::MipGenerator::Generate(image, io::MipFilter::Kaiser, mips, &thread_pool);
+	}
+
+	std::printf(
+		"%s: %ux%u, %s, %s quality, %zu threads\n", options.input.c_str(), image.width,
+		image.height, FORMAT_NAMES[size_t(options.format)],
+		options.quality == io::BcQuality::High ? "high" : "fast", thread_pool.GetThreadCount()
+	);
+
+	std::vector<uint8_t> data;
+	std::vector<uint8_t> blocks;
+	io::BcEncoder::Stats total;
+	double total_seconds = 0.0;
+	for (size_t level = 0; level <= mips.size(); level++) {
+		const auto& source = level == 0 ? image : mips[level - 1];
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto stats = io::BcEncoder::Compress(
+			source, options.format, options.quality, blocks, &thread_pool
+		);
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+		data.insert(data.end(), blocks.begin(), blocks.end());
+		total.blocks += stats.blocks;
+		total.samples += stats.samples;
+		total.squared_error += stats.squared_error;
+		total_seconds += seconds.count();
+
+		std::printf(
+			"  mip %2zu %5ux%-5u %8llu blocks  %6.2f dB  %10.0f blocks/s\n", level, source.width,
+			source.height, static_cast<unsigned long long>(stats.blocks), stats.GetPsnr(),
+			double(stats.blocks) / std::max(seconds.count(), 1e-9)
+		);
+	}
+	std::printf(
+		"  total %llu blocks  %6.2f dB  %10.0f blocks/s\n",
+		static_cast<unsigned long long>(total.blocks), total.GetPsnr(),
+		double(total.blocks) / std::max(total_seconds, 1e-9)
+	);
+
+	io::DdsInfo info;
+	info.width = image.width;
+	info.height = image.height;
+	info.mip_count = uint32_t(mips.size() + 1);
+	info.array_size = 1;
+	info.format = io::BcEncoder::GetTextureFormat(options.format, image.srgb);
+
+	std::vector<uint8_t> file;
+	io::DdsLoader::Write(info, data.data(), data.size(), file);
+
+	std::ofstream stream(options.output, std::ios::binary);
+	stream.write(reinterpret_cast<const char*>(file.data()), std::streamsize(file.size()));
+	if (!stream) {
+		std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+		return 1;
+	}
+	return 0;
+}
+
+
+void CookCommand::PrintUsage()
+{
+	std::printf(
+		"cook <input.png|tga> <output.dds> [options]\n"
+		"  --format bc1|bc3|bc5|bc7  block format (default bc7)\n"
+		"  --quality fast|high       endpoint search (default high)\n"
+		"  --linear                  store the colors as linear instead of sRGB\n"
+		"  --no-mips                 only store the base level\n"
+		"  --threads <count>         number of threads (default all)\n"
+	);
+}
+
+
+auto CookCommand::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	std::vector<std::string> positional;
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--format" && has_value) {
+			const auto value = ToLower(args[++i]);
+			const auto it = std::find(FORMAT_NAMES.begin(), FORMAT_NAMES.end(), value);
+			if (it == FORMAT_NAMES.end()) {
+				return false;
+			}
+			options.format = io::BcFormat(it - FORMAT_NAMES.begin());
+		}
+		else if (arg == "--quality" && has_value) {
+			const auto value = ToLower(args[++i]);
+			if (value != "fast" && value != "high") {
+				return false;
+			}
+			options.quality = value == "fast" ? io::BcQuality::Fast : io::BcQuality::High;
+		}
+		else if (arg == "--threads" && has_value) {
+			options.threads = size_t(std::max(std::atoi(args[++i].c_str()), 0));
+		}
+		else if (arg == "--linear") {
+			options.linear = true;
+		}
+		else if (arg == "--no-mips") {
+			options.mips = false;
+		}
+		else if (arg.rfind("--", 0) == 0) {
+			return false;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() != 2) {
+		return false;
+	}
+	options.input = positional[0];
+	options.output = positional[1];
+	return true;
+}
+
+
+auto CookCommand::LoadImage(
+	const std::string& filename, io::Image& image, utils::ThreadPool* thread_pool
+) -> bool
+{
+	io::MappedFile file;
+	if (!file.Open(filename)) {
+		return false;
+	}
+
+	const auto extension = ToLower(
+		filename.substr(std::min(filename.find_last_of('.'), filename.size()))
+	);
+	if (extension == ".png") {
+		return io::ImageDecoder::DecodePng(file.GetData(), file.GetSize(), image, thread_pool);
+	}
+	if (extension == ".tga") {
+		return io::ImageDecoder::DecodeTga(file.GetData(), file.GetSize(), image, thread_pool);
+	}
+	return false;
+}
+
+} // namespace tools
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: pack_command.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/pack_command.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/mapped_file.h"
+#include "header/thread_pool.h"
+
+
+namespace tools
+{
+
+namespace fs = std::filesystem;
+
+auto PackCommand::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<std::string> files;
+	if (!CollectFiles(options, files)) {
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	utils::ThreadPool thread_pool(options.threads > 0 ? options.threads - 1 : 0);
+	io::ArchiveWriter writer(&thread_pool);
+	if (!writer.Open(options.output)) {
+		std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+		return 1;
+	}
+
+	const auto base = options.base.empty() ? fs::current_path() : fs::absolute(options.base);
+	for (const auto& filename : files) {
+		const auto path = fs::absolute(filename).lexically_relative(base).generic_string();
+
+		// Empty files can not be mapped, they are still added so that they are found
+		io::MappedFile file;
+		const bool opened = file.Open(filename);
+		if (!opened && fs::file_size(filename) != 0) {
+			std::fprintf(stderr, "Could not read %s\n", filename.c_str());
+			return 1;
+		}
+		const auto* data = opened ? file.GetData() : nullptr;
+		if (!writer.Add(path, data, opened ? file.GetSize() : 0)) {
+			std::fprintf(stderr, "Could not add %s as %s\n", filename.c_str(), path.c_str());
+			return 1;
+		}
+	}
+
+	if (!writer.Finish()) {
+		std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+		return 1;
+	}
+
+	const auto stats = writer.GetStats();
+	const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	std::printf(
+		"%s: %zu files, %llu bytes -> %llu bytes (%.1f%%), %zu blocks (%zu stored), %.2f s\n",
+		options.output.c_str(), stats.files, static_cast<unsigned long long>(stats.data_bytes),
+		static_cast<unsigned long long>(stats.archive_bytes),
+		100.0 * double(stats.archive_bytes) / double(std::max<uint64_t>(stats.data_bytes, 1)),
+		stats.blocks, stats.stored_blocks, seconds.count()
+	);
+	return 0;
+}
+
+
+void PackCommand::PrintUsage()
+{
+	std::printf(
+		"pack <output> <input>... [options]\n"
+		"  --base <directory>        paths are stored relative to it (default working dir)\n"
+		"  --threads <count>         number of threads (default all)\n"
+	);
+}
+
+
+auto PackCommand::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	std::vector<std::string> positional;
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--base" && has_value) {
+			options.base = args[++i];
+		}
+		else if (arg == "--threads" && has_value) {
+			options.threads = size_t(std::max(std::atoi(args[++i].c_str()), 0));
+		}
+		else if (arg.rfind("--", 0) == 0) {
+			return false;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() < 2) {
+		return false;
+	}
+	options.output = positional[0];
+	options.inputs.assign(positional.begin() + 1, positional.end());
+	return true;
+}
+
+
+auto PackCommand::CollectFiles(const Options& options, std::vector<std::string>& files) -> bool
+{
+	for (const auto& input : options.inputs) {
+		std::error_code error;
+		if (fs::is_regular_file(input, error)) {
+			files.push_back(input);
+			continue;
+		}
+		if (!fs::is_directory(input, error)) {
+			std::fprintf(stderr, "Could not find %s\n", input.c_str());
+			return false;
+		}
+		for (const auto& entry : fs::recursive_directory_iterator(input)) {
+			if (entry.is_regular_file()) {
+				files.push_back(entry.path().string());
+			}
+		}
+	}
+
+	// Files of one directory end up next to each other and usually are loaded together
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+	return true;
+}
+
+} // namespace tools
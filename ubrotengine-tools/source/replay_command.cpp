@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: replay_command.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/replay_command.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/command_buffer.h"
+#include "header/command_hash.h"
+
+
+namespace tools
+{
+
+namespace
+{
+
+constexpr std::array<const char*, size_t(graphics::RenderBackend::NUMBER)> BACKEND_NAMES = {
+	"d3d11", "null", "recording", "software"
+};
+
+/**
+ * Strings and values every type of setup record needs at least, see CaptureHeader.
+ */
+struct Arguments
+{
+	size_t strings;
+	size_t values;
+};
+constexpr std::array<Arguments, size_t(graphics::CaptureRecordType::NUMBER)> SETUP_ARGUMENTS = {
+	Arguments{ 1, 0 }, Arguments{ 1, 0 }, Arguments{ 1, 0 }, Arguments{ 0, 1 },
+	Arguments{ 1, 1 }, Arguments{ 0, 0 }, Arguments{ 0, 1 }, Arguments{ 0, 2 },
+	Arguments{ 0, 0 }
+};
+
+/**
+ * Keeps the window responsive while frames are rendered.
+ */
+void PumpMessages()
+{
+	MSG message;
+	while (PeekMessage(&message, nullptr, 0, 0, PM_REMOVE)) {
+		TranslateMessage(&message);
+		DispatchMessage(&message);
+	}
+}
+
+struct Totals
+{
+	size_t frames{ 0 };
+	double frame_ms{ 0.0 };
+	double slowest_ms{ 0.0 };
+	double gather_ms{ 0.0 };
+	double submit_ms{ 0.0 };
+	double record_ms{ 0.0 };
+	double replay_ms{ 0.0 };
+};
+
+} // namespace
+
+
+auto ReplayCommand::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	graphics::CaptureReader reader;
+	if (!reader.Open(options.capture)) {
+		std::fprintf(stderr, "Could not read %s\n", options.capture.c_str());
+		return 1;
+	}
+
+	auto engine = graphics::createEngine();
+	HWND window{ nullptr };
+	graphics::CaptureEntry entry;
+	Totals totals;
+
+	if (!options.summary) {
+		std::printf(
+			"loop,frame,gather_ms,submit_ms,record_ms,replay_ms,frame_ms,draw_packets,"
+			"visible_objects,commands\n"
+		);
+	}
+	for (size_t loop = 0; loop < options.loops; loop++) {
+		reader.Rewind();
+		size_t frame{ 0 };
+		while (reader.Next(entry)) {
+			if (entry.type != graphics::CaptureRecordType::Frame) {
+				// The assets of the first loop are still registered
+				if (loop > 0) {
+					continue;
+				}
+				if (!ApplySetup(entry, options, *engine, window)) {
+					return 1;
+				}
+				continue;
+			}
+			if (window == nullptr) {
+				std::fprintf(stderr, "%s starts without settings\n", options.capture.c_str());
+				return 1;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			engine->RenderScene(entry.frame);
+			const std::chrono::duration<double, std::milli> frame_ms =
+				std::chrono::steady_clock::now() - start;
+			PumpMessages();
+
+			// Only the recording backend keeps the commands
+			graphics::CommandHash hash;
+			engine->GetRecordedCommands().Replay(hash);
+
+			const auto& stats = engine->GetFrameStats();
+			totals.frames++;
+			totals.frame_ms += frame_ms.count();
+			totals.slowest_ms = std::max(totals.slowest_ms, frame_ms.count());
+			totals.gather_ms += stats.gather_ms;
+			totals.submit_ms += stats.submit_ms;
+			totals.record_ms += stats.record_ms;
+			totals.replay_ms += stats.replay_ms;
+			if (!options.summary) {
+				std::printf(
+					"%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%zu,%zu,%016llx\n", loop, frame,
+					stats.gather_ms, stats.submit_ms, stats.record_ms, stats.replay_ms,
+					frame_ms.count(), stats.draw_packets, stats.visible_objects,
+					static_cast<unsigned long long>(hash.GetHash())
+				);
+			}
+			frame++;
+		}
+		if (!reader.AtEnd()) {
+			std::fprintf(
+				stderr, "%s is corrupt after %zu frames\n", options.capture.c_str(), frame
+			);
+			return 1;
+		}
+	}
+
+	const auto frames = double(std::max<size_t>(totals.frames, 1));
+	std::fprintf(
+		options.summary ? stdout : stderr,
+		"%s: %zu frames, %.3f ms per frame (gather %.3f, submit %.3f, record %.3f, "
+		"replay %.3f), slowest %.3f ms\n",
+		options.capture.c_str(), totals.frames, totals.frame_ms / frames,
+		totals.gather_ms / frames, totals.submit_ms / frames, totals.record_ms / frames,
+		totals.replay_ms / frames, totals.slowest_ms
+	);
+
+	if (window != nullptr) {
+		engine->Shutdown();
+		DestroyWindow(window);
+	}
+	return 0;
+}
+
+
+void ReplayCommand::PrintUsage()
+{
+	std::printf(
+		"replay <capture> [options]\n"
+		"  --backend d3d11|null|recording|software\n"
+		"                            backend to render with (default the captured one)\n"
+		"  --loops <count>           render the frames this many times (default 1)\n"
+		"  --summary                 only print the averages\n"
+	);
+}
+
+
+auto ReplayCommand::ParseOptions(const std::vector<std::string>& args, Options& options) -> bool
+{
+	std::vector<std::string> positional;
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--backend" && has_value) {
+			const auto& value = args[++i];
+			const auto it = std::find(BACKEND_NAMES.begin(), BACKEND_NAMES.end(), value);
+			if (it == BACKEND_NAMES.end()) {
+				return false;
+			}
+			options.override_backend = true;
+			options.backend = graphics::RenderBackend(it - BACKEND_NAMES.begin());
+		}
+		else if (arg == "--loops" && has_value) {
+			options.loops = size_t(std::max(std::atoi(args[++i].c_str()), 1));
+		}
+		else if (arg == "--summary") {
+			options.summary = true;
+		}
+		else if (arg.rfind("--", 0) == 0) {
+			return false;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() != 1) {
+		return false;
+	}
+	options.capture = positional[0];
+	return true;
+}
+
+
+auto ReplayCommand::ApplySetup(
+	const graphics::CaptureEntry& entry, const Options& options, graphics::Engine& engine,
+	HWND& window
+) -> bool
+{
+	using graphics::CaptureRecordType;
+
+	const auto& strings = entry.strings;
+	const auto& values = entry.values;
+	const auto& arguments = SETUP_ARGUMENTS[size_t(entry.type)];
+	if (strings.size() < arguments.strings || values.size() < arguments.values) {
+		std::fprintf(stderr, "Setup record %u misses arguments\n", uint32_t(entry.type));
+		return false;
+	}
+	// Every other call needs the renderer
+	if (window == nullptr && entry.type != CaptureRecordType::Settings) {
+		std::fprintf(stderr, "Setup record %u comes before the settings\n", uint32_t(entry.type));
+		return false;
+	}
+
+	switch (entry.type)
+	{
+		case CaptureRecordType::Settings: {
+			graphics::GraphicSettings settings;
+			std::istringstream text(strings[0]);
+			text >> settings;
+			settings.fullscreen = FALSE;
+			if (options.override_backend) {
+				settings.render_backend = options.backend;
+			}
+			if (window != nullptr) {
+				return SUCCEEDED(engine.Refresh(settings));
+			}
+
+			// The headless backends do not use the window, it only keeps the frames comparable
+			window = CreateWindowExA(
+				0, "STATIC", "ubrotengine replay", WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+				CW_USEDEFAULT, CW_USEDEFAULT, settings.window_width, settings.window_height,
+				nullptr, nullptr, GetModuleHandle(nullptr), nullptr
+			);
+			if (window == nullptr || FAILED(engine.RendererInit(window, settings))) {
+				std::fprintf(stderr, "Could not initialize the renderer\n");
+				return false;
+			}
+			engine.SetDeterministic(true);
+			return true;
+		}
+		case CaptureRecordType::MountArchive:
+			engine.MountArchive(strings[0]);
+			return true;
+		case CaptureRecordType::Model:
+			engine.RegisterModel(strings[0]);
+			return true;
+		case CaptureRecordType::ProceduralModel:
+			engine.RegisterModelProcedural(uint8_t(values[0]));
+			return true;
+		case CaptureRecordType::Texture:
+			engine.RegisterTexture(strings[0], uint8_t(values[0]));
+			return true;
+		case CaptureRecordType::Models:
+			engine.RegisterModels(strings);
+			return true;
+		case CaptureRecordType::Textures:
+			engine.RegisterTextures(strings, uint8_t(values[0]));
+			return true;
+		case CaptureRecordType::ModelTexture:
+			engine.SetModelTexture(size_t(values[0]), size_t(values[1]));
+			return true;
+		default:
+			return true;
+	}
+}
+
+} // namespace tools
@@ -0,0 +1,233 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Filename: shaders_command.cpp
+///////////////////////////////////////////////////////////////////////////////////////////////////
+#include "../header/shaders_command.h"
+
+
+//////////////
+// INCLUDES //
+//////////////
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+
+///////////////////////
+// MY CLASS INCLUDES //
+///////////////////////
+#include "header/shader_manifest.h"
+#include "header/shader_program.h"
+#include "header/thread_pool.h"
+
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+
+namespace tools
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// Bytes per line of the generated arrays
+constexpr size_t BYTES_PER_LINE = 16;
+
+auto ReadFile(const fs::path& path, std::string& content) -> bool
+{
+	std::ifstream file(path, std::ios::binary);
+	if (file.fail()) {
+		return false;
+	}
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	content = stream.str();
+	return true;
+}
+
+} // namespace
+
+
+auto ShadersCommand::Run(const std::vector<std::string>& args) -> int
+{
+	Options options;
+	if (!ParseOptions(args, options)) {
+		PrintUsage();
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto descs = CollectShaders(options);
+	utils::ThreadPool thread_pool(options.threads > 0 ? options.threads - 1 : 0);
+
+	std::vector<std::vector<uint8_t>> bytecodes(descs.size());
+	std::vector<HRESULT> results(descs.size(), S_OK);
+	std::vector<std::string> errors(descs.size());
+	thread_pool.ParallelFor(
+		descs.size(), descs.size(), [&](size_t begin, size_t end, size_t /*chunk_idx*/) {
+			for (size_t i = begin; i < end; i++) {
+				std::string source;
+				if (!ReadFile(descs[i].path, source)) {
+					results[i] = E_FAIL;
+					errors[i] = "Could not read the file\n";
+					continue;
+				}
+				graphics::ShaderCompileOutput output;
+				results[i] = graphics::ShaderCache::CompileD3D(descs[i], source, output);
+				bytecodes[i] = std::move(output.bytecode);
+				errors[i] = std::move(output.errors);
+			}
+		}
+	);
+
+	bool failed{ false };
+	for (size_t i = 0; i < descs.size(); i++) {
+		if (FAILED(results[i])) {
+			std::fprintf(
+				stderr, "%s (%s, %s):\n%s", descs[i].path.string().c_str(),
+				descs[i].entry_point.c_str(),
+				graphics::EmbeddedShaderTable::JoinDefines(descs[i].defines).c_str(),
+				errors[i].c_str()
+			);
+			failed = true;
+		}
+	}
+	if (failed) {
+		return 1;
+	}
+
+	if (!WriteHeader(options.output, descs, bytecodes)) {
+		std::fprintf(stderr, "Could not write %s\n", options.output.c_str());
+		return 1;
+	}
+
+	size_t bytes{ 0 };
+	for (const auto& bytecode : bytecodes) {
+		bytes += bytecode.size();
+	}
+	const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+	std::printf(
+		"%s: %zu shaders, %zu bytes, %zu threads, %.2f s\n", options.output.c_str(),
+		descs.size(), bytes, thread_pool.GetThreadCount(), seconds.count()
+	);
+	return 0;
+}
+
+
+void ShadersCommand::PrintUsage()
+{
+	std::printf(
+		"shaders <output header> <shader directory> [options]\n"
+		"  --threads <count>         number of threads (default all)\n"
+	);
+}
+
+
+auto ShadersCommand::ParseOptions(const std::vector<std::string>& args, Options& options)
+	-> bool
+{
+	std::vector<std::string> positional;
+	for (size_t i = 0; i < args.size(); i++) {
+		const auto& arg = args[i];
+		const bool has_value = i + 1 < args.size();
+		if (arg == "--threads" && has_value) {
+			options.threads = size_t(std::max(std::atoi(args[++i].c_str()), 0));
+		}
+		else if (arg.rfind("--", 0) == 0) {
+			return false;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() != 2) {
+		return false;
+	}
+	options.output = positional[0];
+	options.shader_directory = positional[1];
+	return true;
+}
+
+
+auto ShadersCommand::CollectShaders(const Options& options)
+	-> std::vector<graphics::ShaderCompileDesc>
+{
+	using graphics::ShaderProgram;
+	using ShaderType = ShaderProgram::ShaderType;
+
+	std::vector<graphics::ShaderCompileDesc> descs;
+	std::unordered_set<std::string> keys;
+	const auto add = [&](graphics::ShaderCompileDesc desc) {
+		if (keys.insert(graphics::EmbeddedShaderTable::GetKey(desc)).second) {
+			descs.push_back(std::move(desc));
+		}
+	};
+
+	const fs::path directory = options.shader_directory;
+	for (const auto& entry : graphics::SHADER_MANIFEST) {
+		const auto vs_path = (directory / entry.vs_file).wstring();
+		const auto fs_path = (directory / entry.fs_file).wstring();
+		const auto layout_path = (directory / entry.layout_file).wstring();
+
+		// Every subset of the features in ascending order, the same masks the engine asks for
+		graphics::FeatureMask mask{ 0 };
+		do {
+			const auto defines = graphics::GetFeatureDefines(mask);
+			add(ShaderProgram::GetCompileDesc(ShaderType::VertexShader, vs_path.c_str(), defines));
+			add(ShaderProgram::GetCompileDesc(
+				ShaderType::FragmentShader, fs_path.c_str(), defines
+			));
+			add(ShaderProgram::GetLayoutCompileDesc(layout_path.c_str(), defines));
+			mask = (mask - entry.features) & entry.features;
+		} while (mask != 0);
+	}
+	return descs;
+}
+
+
+auto ShadersCommand::WriteHeader(
+	const std::string& output, const std::vector<graphics::ShaderCompileDesc>& descs,
+	const std::vector<std::vector<uint8_t>>& bytecodes
+) -> bool
+{
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	if (file.fail()) {
+		return false;
+	}
+
+	file << "// Generated by \"ubrotengine-tools shaders\", do not edit.\n"
+		<< "#pragma once\n\n"
+		<< "#include \"embedded_shaders.h\"\n\n"
+		<< "namespace graphics\n{\n\n";
+
+	char hex[8];
+	for (size_t i = 0; i < bytecodes.size(); i++) {
+		file << "constexpr uint8_t SHADER_" << i << "[] = {";
+		for (size_t j = 0; j < bytecodes[i].size(); j++) {
+			file << (j % BYTES_PER_LINE == 0 ? "\n\t" : " ");
+			std::snprintf(hex, sizeof(hex), "0x%02x,", bytecodes[i][j]);
+			file << hex;
+		}
+		file << "\n};\n\n";
+	}
+
+	file << "constexpr EmbeddedShader EMBEDDED_SHADERS[] = {\n";
+	for (size_t i = 0; i < descs.size(); i++) {
+		const auto name = descs[i].path.filename().u8string();
+		file << "\t{ \"" << std::string(name.begin(), name.end()) << "\", \""
+			<< descs[i].entry_point << "\", \"" << descs[i].target << "\", \""
+			<< graphics::EmbeddedShaderTable::JoinDefines(descs[i].defines) << "\", SHADER_"
+			<< i << ", sizeof(SHADER_" << i << ") },\n";
+	}
+	file << "};\n\n} // namespace graphics\n";
+	return !file.fail();
+}
+
+} // namespace tools